@@ -11,8 +11,23 @@
 #include "hmac.h"
 #include "lt_hmac_sha256.h"
 
+_Static_assert(sizeof(HMAC_SHA256_CTX) <= sizeof(struct lt_crypto_hmac_sha256_ctx_t),
+               "struct lt_crypto_hmac_sha256_ctx_t is too small for HMAC_SHA256_CTX");
+
 void lt_hmac_sha256(const uint8_t *key, size_t keylen, const uint8_t *input, size_t ilen, uint8_t *output)
 {
     hmac_sha256(key, keylen, input, ilen, output);
 }
+
+void lt_hmac_sha256_init(void *ctx, const uint8_t *key, size_t keylen)
+{
+    hmac_sha256_Init((HMAC_SHA256_CTX *)ctx, key, (uint32_t)keylen);
+}
+
+void lt_hmac_sha256_update(void *ctx, const uint8_t *input, size_t ilen)
+{
+    hmac_sha256_Update((HMAC_SHA256_CTX *)ctx, input, (uint32_t)ilen);
+}
+
+void lt_hmac_sha256_finish(void *ctx, uint8_t *output) { hmac_sha256_Final((HMAC_SHA256_CTX *)ctx, output); }
 #endif
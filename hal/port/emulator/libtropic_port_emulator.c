@@ -0,0 +1,133 @@
+/**
+ * @file libtropic_port_emulator.c
+ * @author Tropic Square s.r.o.
+ * @brief Port talking to a TROPIC01 emulated in the same process, no model server or hardware is needed.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include "libtropic_port_emulator.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "libtropic_common.h"
+#include "libtropic_logging.h"
+#include "libtropic_macros.h"
+#include "libtropic_port.h"
+#include "lt_emu_chip.h"
+#include "lt_hmac_drbg.h"
+#include "lt_l1.h"
+
+lt_ret_t lt_port_init(lt_l2_state_t *s2)
+{
+    lt_dev_emulator_t *dev = (lt_dev_emulator_t *)(s2->device);
+
+    if (!dev->cfg || (dev->cfg->cert_store_len > LT_EMU_CERT_STORE_SIZE_MAX)) {
+        LT_LOG_ERROR("Emulated chip is not configured.");
+        return LT_FAIL;
+    }
+
+    if (!dev->provisioned) {
+        static const char personalization[] = "lt_port_emulator";
+        uint8_t seed[sizeof(dev->rng_seed)];
+
+        memcpy(seed, &dev->rng_seed, sizeof(dev->rng_seed));
+        lt_emu_chip_init(&dev->chip, dev->cfg, seed, sizeof(seed));
+        lt_hmac_drbg_instantiate(dev->drbg_key, dev->drbg_v, seed, sizeof(seed), NULL, 0,
+                                 (const uint8_t *)personalization, sizeof(personalization) - 1);
+        dev->provisioned = true;
+        LT_LOG_DEBUG("Emulated chip provisioned.");
+    }
+    dev->csn_low = false;
+    dev->pos = 0;
+
+    return LT_OK;
+}
+
+lt_ret_t lt_port_deinit(lt_l2_state_t *s2)
+{
+    lt_dev_emulator_t *dev = (lt_dev_emulator_t *)(s2->device);
+
+    dev->csn_low = false;
+
+    return LT_OK;
+}
+
+lt_ret_t lt_port_spi_csn_low(lt_l2_state_t *s2)
+{
+    lt_dev_emulator_t *dev = (lt_dev_emulator_t *)(s2->device);
+
+    dev->csn_low = true;
+    dev->pos = 0;
+
+    return LT_OK;
+}
+
+lt_ret_t lt_port_spi_csn_high(lt_l2_state_t *s2)
+{
+    lt_dev_emulator_t *dev = (lt_dev_emulator_t *)(s2->device);
+
+    if (dev->csn_low) {
+        dev->csn_low = false;
+        lt_emu_chip_end(&dev->chip, dev->mosi, dev->pos);
+    }
+
+    return LT_OK;
+}
+
+lt_ret_t lt_port_spi_transfer(lt_l2_state_t *s2, uint8_t offset, uint16_t tx_data_length, uint32_t timeout_ms)
+{
+    LT_UNUSED(timeout_ms);
+    lt_dev_emulator_t *dev = (lt_dev_emulator_t *)(s2->device);
+
+    if ((offset + tx_data_length > TR01_L1_LEN_MAX) || (dev->pos + tx_data_length > TR01_L1_LEN_MAX)) {
+        return LT_L1_DATA_LEN_ERROR;
+    }
+    if (!dev->csn_low) {
+        LT_LOG_ERROR("SPI transfer with chip select high.");
+        return LT_FAIL;
+    }
+
+    // Full duplex: the byte sent is replaced with the byte received
+    for (uint16_t i = 0; i < tx_data_length; i++, dev->pos++) {
+        uint8_t *byte = &s2->buff[offset + i];
+        dev->mosi[dev->pos] = *byte;
+
+        if (dev->pos == 0) {
+            *byte = lt_emu_chip_status(&dev->chip);
+            continue;
+        }
+        const uint8_t *rsp = lt_emu_chip_response(&dev->chip);
+        *byte = (rsp && (dev->mosi[0] == TR01_L1_GET_RESPONSE_REQ_ID)) ? rsp[dev->pos - 1] : 0xff;
+    }
+
+    return LT_OK;
+}
+
+lt_ret_t lt_port_delay(lt_l2_state_t *s2, uint32_t ms)
+{
+    lt_dev_emulator_t *dev = (lt_dev_emulator_t *)(s2->device);
+
+    dev->time_ms += ms;
+
+    return LT_OK;
+}
+
+#if LT_USE_INT_PIN
+lt_ret_t lt_port_delay_on_int(lt_l2_state_t *s2, uint32_t ms)
+{
+    // The emulated chip answers at once, so it is ready when asked again
+    return lt_port_delay(s2, ms);
+}
+#endif
+
+lt_ret_t lt_port_random_bytes(lt_l2_state_t *s2, void *buff, size_t count)
+{
+    lt_dev_emulator_t *dev = (lt_dev_emulator_t *)(s2->device);
+
+    lt_hmac_drbg_generate(dev->drbg_key, dev->drbg_v, NULL, 0, buff, count);
+
+    return LT_OK;
+}
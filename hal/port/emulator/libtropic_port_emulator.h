@@ -0,0 +1,59 @@
+#ifndef LIBTROPIC_PORT_EMULATOR_H
+#define LIBTROPIC_PORT_EMULATOR_H
+
+/**
+ * @file libtropic_port_emulator.h
+ * @author Tropic Square s.r.o.
+ * @brief Port talking to a TROPIC01 emulated in the same process, no model server or hardware is needed.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "libtropic_common.h"
+#include "lt_emu_chip.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Device structure for the emulator port.
+ *
+ * @note Public members are meant to be configured by the developer before passing the handle to
+ *       libtropic. The structure has to be zeroed before the first lt_init(), the emulated chip is provisioned
+ *       then and keeps its state across lt_deinit() and lt_init() until the structure is zeroed again.
+ * @note The structure holds the whole chip including its R memory, so it is rather big (~250 kB) to be placed on
+ *       the stack.
+ */
+typedef struct lt_dev_emulator_t {
+    /** @public @brief Provisioning of the emulated chip. */
+    const lt_emu_cfg_t *cfg;
+    /** @public @brief Seed for the random number generators of the platform and of the emulated chip. */
+    unsigned int rng_seed;
+
+    /** @private @brief Emulated chip. */
+    lt_emu_chip_t chip;
+    /** @private @brief The chip was provisioned by lt_port_init(). */
+    bool provisioned;
+    /** @private @brief Chip select is driven low. */
+    bool csn_low;
+    /** @private @brief Bytes sent by the host since chip select went low. */
+    uint8_t mosi[TR01_L1_LEN_MAX];
+    /** @private @brief Number of bytes transferred since chip select went low. */
+    uint16_t pos;
+    /** @private @brief Key of the platform's HMAC_DRBG. */
+    uint8_t drbg_key[32];
+    /** @private @brief Value of the platform's HMAC_DRBG. */
+    uint8_t drbg_v[32];
+    /** @private @brief Time spent in lt_port_delay(), the emulator does not sleep. */
+    uint64_t time_ms;
+} lt_dev_emulator_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LIBTROPIC_PORT_EMULATOR_H
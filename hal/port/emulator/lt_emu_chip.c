@@ -0,0 +1,1025 @@
+/**
+ * @file lt_emu_chip.c
+ * @author Tropic Square s.r.o.
+ * @brief Emulated TROPIC01: L2 frames, Secure Session and L3 commands processed in-process.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include "lt_emu_chip.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "ecdsa.h"
+#include "ed25519-donna/ed25519.h"
+#include "libtropic_common.h"
+#include "libtropic_macros.h"
+#include "lt_aesgcm.h"
+#include "lt_crc16.h"
+#include "lt_hkdf.h"
+#include "lt_hmac_drbg.h"
+#include "lt_hmac_sha256.h"
+#include "lt_l1.h"
+#include "lt_l2_api_structs.h"
+#include "lt_l2_frame_check.h"
+#include "lt_l3_api_structs.h"
+#include "lt_l3_process.h"
+#include "lt_sha256.h"
+#include "lt_x25519.h"
+#include "nist256p1.h"
+
+_Static_assert(sizeof(struct lt_crypto_aes_gcm_ctx_t) <= LT_MEMBER_SIZE(lt_emu_chip_t, encrypt),
+               "AES-GCM context does not fit into lt_emu_chip_t");
+
+/** @brief SPECT FW version reported by the bootloader. */
+static const uint8_t lt_emu_boot_spect_fw_ver[TR01_L2_GET_INFO_SPECT_FW_SIZE] = {0x00, 0x00, 0x00, 0x80};
+/** @brief Message returned by Get_Log_Req. */
+static const char lt_emu_log_msg[] = "TROPIC01 emulator";
+
+#ifdef ABAB
+/** @brief Bootloader version 1.0.1. */
+static const uint8_t lt_emu_boot_riscv_fw_ver[TR01_L2_GET_INFO_RISCV_FW_SIZE] = {0x00, 0x01, 0x00, 0x81};
+/** @brief Status of requests the bootloader or the application does not know. */
+#define LT_EMU_STATUS_UNSUPPORTED TR01_L2_STATUS_GEN_ERR
+#elif ACAB
+/** @brief Bootloader version 2.0.1. */
+static const uint8_t lt_emu_boot_riscv_fw_ver[TR01_L2_GET_INFO_RISCV_FW_SIZE] = {0x00, 0x01, 0x00, 0x82};
+/** @brief Status of requests the bootloader or the application does not know. */
+#define LT_EMU_STATUS_UNSUPPORTED TR01_L2_STATUS_UNKNOWN_ERR
+#else
+#error "Undefined silicon revision. Please define either ABAB or ACAB."
+#endif
+
+/** @brief Version of the firmware in all banks of a new chip, 1.0.0. */
+#define LT_EMU_FW_VERSION 0x01000000
+/** @brief Firmware type in bank headers and in Mutable_FW_Update_Req: RISC-V firmware. */
+#define LT_EMU_FW_TYPE_CPU 1
+/** @brief Firmware type in bank headers and in Mutable_FW_Update_Req: SPECT firmware. */
+#define LT_EMU_FW_TYPE_SPECT 2
+/** @brief Index of SPECT1 in lt_emu_chip_t.fw_banks, the RISC-V banks come first. */
+#define LT_EMU_FW_BANK_SPECT 2
+/** @brief Size of a firmware bank, the largest image of both revisions fits. */
+#define LT_EMU_FW_BANK_SIZE 0x8000
+#ifdef ABAB
+/** @brief Offset of the bank header in the image, it follows the signature. */
+#define LT_EMU_FW_HEADER_OFFSET 0x200
+/** @brief Offset of the firmware in the image, `size` in the bank header counts from here. */
+#define LT_EMU_FW_BODY_OFFSET 0x400
+#endif
+
+/** @brief Length of a certificate store block returned by Get_Info_Req. */
+#define LT_EMU_GET_INFO_BLOCK_LEN 128
+/** @brief Size of the L3 result chunks, the same as the chip uses. */
+#define LT_EMU_RES_CHUNK_SIZE 128
+/** @brief Offset of the first field after the padding in L3 commands and results with 16-byte aligned data. */
+#define LT_EMU_L3_DATA_OFFSET 16
+
+static uint16_t lt_emu_get_u16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+static uint32_t lt_emu_get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void lt_emu_put_u32(uint8_t *p, const uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/** @brief Increments an AES-GCM IV the same way the host does, as a little endian counter in its first 4 bytes. */
+static void lt_emu_iv_increase(uint8_t *iv) { lt_emu_put_u32(iv, lt_emu_get_u32(iv) + 1); }
+
+static void lt_emu_random(lt_emu_chip_t *chip, uint8_t *out, const size_t len)
+{
+    lt_hmac_drbg_generate(chip->drbg_key, chip->drbg_v, NULL, 0, out, len);
+}
+
+/** @brief Prepares a response frame, `data` may point into the frame being built. */
+static void lt_emu_respond(lt_emu_chip_t *chip, const uint8_t status, const uint8_t *data, const uint8_t len)
+{
+    chip->rsp[0] = status;
+    chip->rsp[1] = len;
+    if (len) {
+        memmove(chip->rsp + 2, data, len);
+    }
+    add_crc(chip->rsp);
+    chip->rsp_valid = true;
+}
+
+static void lt_emu_session_end(lt_emu_chip_t *chip)
+{
+    chip->session = false;
+    chip->l3_cmd_pending = false;
+    chip->l3_res_pending = false;
+    memset(chip->encrypt, 0, sizeof(chip->encrypt));
+    memset(chip->decrypt, 0, sizeof(chip->decrypt));
+}
+
+/** @brief Returns index of a bank in lt_emu_chip_t.fw_banks, LT_EMU_FW_BANK_CNT for an unknown bank ID. */
+static uint8_t lt_emu_fw_bank_index(const uint8_t bank_id)
+{
+    switch (bank_id) {
+        case TR01_FW_BANK_FW1:
+            return 0;
+        case TR01_FW_BANK_FW2:
+            return 1;
+        case TR01_FW_BANK_SPECT1:
+            return LT_EMU_FW_BANK_SPECT;
+        case TR01_FW_BANK_SPECT2:
+            return LT_EMU_FW_BANK_SPECT + 1;
+        default:
+            return LT_EMU_FW_BANK_CNT;
+    }
+}
+
+static uint8_t lt_emu_fw_bank_type(const uint8_t index)
+{
+    return (index < LT_EMU_FW_BANK_SPECT) ? LT_EMU_FW_TYPE_CPU : LT_EMU_FW_TYPE_SPECT;
+}
+
+static void lt_emu_fw_bank_erase(lt_emu_fw_bank_t *bank)
+{
+    memset(bank, 0, sizeof(*bank));
+    memset(bank->header, 0xff, sizeof(bank->header));
+}
+
+/** @brief Fills a bank with a whole image of the given version, as the chip leaves production. */
+static void lt_emu_fw_bank_fill(lt_emu_fw_bank_t *bank, const uint8_t type, const uint32_t version)
+{
+    lt_emu_fw_bank_erase(bank);
+#ifdef ABAB
+    struct lt_header_boot_v1_t *header = (struct lt_header_boot_v1_t *)bank->header;
+    memset(header, 0, sizeof(*header));
+    lt_emu_put_u32(header->type, type);
+    lt_emu_put_u32(header->version, version);
+    bank->size = LT_EMU_FW_BODY_OFFSET;
+#else
+    LT_UNUSED(type);
+    bank->size = TR01_L2_MUTABLE_FW_UPDATE_REQ_LEN + 1;
+#endif
+    bank->written = bank->size;
+    bank->version = version;
+    bank->complete = true;
+}
+
+/** @brief Writes a chunk of an image, only the bank header and the length written without a gap are kept. */
+static void lt_emu_fw_bank_write(lt_emu_fw_bank_t *bank, const uint8_t type, const uint32_t offset,
+                                 const uint8_t *data, const uint16_t len)
+{
+#ifdef ABAB
+    for (uint16_t i = 0; i < len; i++) {
+        if ((offset + i >= LT_EMU_FW_HEADER_OFFSET) && (offset + i < LT_EMU_FW_HEADER_OFFSET + sizeof(bank->header))) {
+            bank->header[offset + i - LT_EMU_FW_HEADER_OFFSET] = data[i];
+        }
+    }
+    const struct lt_header_boot_v1_t *header = (const struct lt_header_boot_v1_t *)bank->header;
+    bank->version = lt_emu_get_u32(header->version);
+    bank->size = LT_EMU_FW_BODY_OFFSET + lt_emu_get_u32(header->size);
+#else
+    LT_UNUSED(data);
+#endif
+    // A chunk written again after its acknowledgement was lost does not change the image
+    if ((offset <= bank->written) && (offset + len > bank->written)) {
+        bank->written = offset + len;
+    }
+#ifdef ABAB
+    bank->complete = (lt_emu_get_u32(header->type) == type) && (bank->written >= bank->size);
+#else
+    LT_UNUSED(type);
+    bank->complete = bank->size && (bank->written >= bank->size);
+#endif
+}
+
+/** @brief Returns index of the bank with the newest whole image of a firmware, LT_EMU_FW_BANK_CNT if there is none. */
+static uint8_t lt_emu_fw_bank_boot(const lt_emu_chip_t *chip, const uint8_t first)
+{
+    const lt_emu_fw_bank_t *banks = &chip->fw_banks[first];
+
+    if (!banks[0].complete) {
+        return banks[1].complete ? first + 1 : LT_EMU_FW_BANK_CNT;
+    }
+
+    return (banks[1].complete && (banks[1].version > banks[0].version)) ? first + 1 : first;
+}
+
+static void lt_emu_reboot(lt_emu_chip_t *chip, const uint8_t startup_id)
+{
+    lt_emu_session_end(chip);
+    chip->maintenance = (startup_id == TR01_MAINTENANCE_REBOOT);
+    chip->boot_polls = LT_EMU_BOOT_POLLS;
+    chip->rsp_valid = false;
+    chip->fw_update_bank = LT_EMU_FW_BANK_CNT;
+
+    if (!chip->maintenance) {
+        uint8_t riscv = lt_emu_fw_bank_boot(chip, 0), spect = lt_emu_fw_bank_boot(chip, LT_EMU_FW_BANK_SPECT);
+        if ((riscv == LT_EMU_FW_BANK_CNT) || (spect == LT_EMU_FW_BANK_CNT)) {
+            // Without a whole image of both firmwares the bootloader keeps running
+            chip->maintenance = true;
+            return;
+        }
+        chip->riscv_fw_ver = chip->fw_banks[riscv].version;
+        chip->spect_fw_ver = chip->fw_banks[spect].version;
+    }
+}
+
+static bool lt_emu_config_addr_valid(const uint16_t addr)
+{
+    return (addr % sizeof(uint32_t) == 0) && (addr / sizeof(uint32_t) < LT_EMU_CONFIG_WORD_CNT);
+}
+
+/**
+ * @brief Handles Get_Info_Req.
+ */
+static void lt_emu_get_info(lt_emu_chip_t *chip, const uint8_t object_id, const uint8_t block_index)
+{
+    uint8_t object[LT_EMU_GET_INFO_BLOCK_LEN] = {0};
+
+    switch (object_id) {
+        case TR01_L2_GET_INFO_REQ_OBJECT_ID_X509_CERTIFICATE: {
+            uint16_t offset = (uint16_t)(block_index * LT_EMU_GET_INFO_BLOCK_LEN);
+            if (offset >= LT_EMU_CERT_STORE_SIZE_MAX) {
+                lt_emu_respond(chip, TR01_L2_STATUS_GEN_ERR, NULL, 0);
+                return;
+            }
+            if (offset < chip->cfg->cert_store_len) {
+                uint16_t len = chip->cfg->cert_store_len - offset;
+                memcpy(object, chip->cfg->cert_store + offset,
+                       (len < LT_EMU_GET_INFO_BLOCK_LEN) ? len : LT_EMU_GET_INFO_BLOCK_LEN);
+            }
+            lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_OK, object, LT_EMU_GET_INFO_BLOCK_LEN);
+            return;
+        }
+        case TR01_L2_GET_INFO_REQ_OBJECT_ID_CHIP_ID:
+            lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_OK, chip->cfg->chip_id, TR01_L2_GET_INFO_CHIP_ID_SIZE);
+            return;
+        case TR01_L2_GET_INFO_REQ_OBJECT_ID_RISCV_FW_VERSION:
+            if (chip->maintenance) {
+                lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_OK, lt_emu_boot_riscv_fw_ver,
+                               TR01_L2_GET_INFO_RISCV_FW_SIZE);
+                return;
+            }
+            lt_emu_put_u32(object, chip->riscv_fw_ver);
+            lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_OK, object, TR01_L2_GET_INFO_RISCV_FW_SIZE);
+            return;
+        case TR01_L2_GET_INFO_REQ_OBJECT_ID_SPECT_FW_VERSION:
+            if (chip->maintenance) {
+                lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_OK, lt_emu_boot_spect_fw_ver,
+                               TR01_L2_GET_INFO_SPECT_FW_SIZE);
+                return;
+            }
+            lt_emu_put_u32(object, chip->spect_fw_ver);
+            lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_OK, object, TR01_L2_GET_INFO_SPECT_FW_SIZE);
+            return;
+        case TR01_L2_GET_INFO_REQ_OBJECT_ID_FW_BANK: {
+            if (!chip->maintenance) {
+                lt_emu_respond(chip, LT_EMU_STATUS_UNSUPPORTED, NULL, 0);
+                return;
+            }
+            uint8_t index = lt_emu_fw_bank_index(block_index);
+            if (index == LT_EMU_FW_BANK_CNT) {
+                lt_emu_respond(chip, TR01_L2_STATUS_GEN_ERR, NULL, 0);
+                return;
+            }
+            const lt_emu_fw_bank_t *bank = &chip->fw_banks[index];
+#ifdef ABAB
+            lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_OK, bank->header, TR01_L2_GET_INFO_FW_HEADER_SIZE_BOOT_V1);
+#else
+            if (!bank->complete) {
+                // Empty bank has no header
+                lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_OK, NULL, 0);
+                return;
+            }
+            struct lt_header_boot_v2_t *header = (struct lt_header_boot_v2_t *)object;
+            header->type = lt_emu_fw_bank_type(index);
+            header->header_version = 2;
+            header->ver = bank->version;
+            header->size = bank->size;
+            lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_OK, object, TR01_L2_GET_INFO_FW_HEADER_SIZE_BOOT_V2);
+#endif
+            return;
+        }
+        default:
+            lt_emu_respond(chip, TR01_L2_STATUS_GEN_ERR, NULL, 0);
+            return;
+    }
+}
+
+/**
+ * @brief Handles Handshake_Req, the chip's side of lt_in__session_start().
+ */
+static void lt_emu_handshake(lt_emu_chip_t *chip, const uint8_t *ehpub, const uint8_t pkey_index)
+{
+    uint8_t protocol_name[32] = {'N', 'o', 'i', 's', 'e', '_', 'K', 'K', '1', '_', '2', '5', '5', '1',  '9',  '_',
+                                 'A', 'E', 'S', 'G', 'C', 'M', '_', 'S', 'H', 'A', '2', '5', '6', 0x00, 0x00, 0x00};
+    struct lt_crypto_sha256_ctx_t hctx;
+    uint8_t hash[LT_SHA256_DIGEST_LENGTH];
+    uint8_t etpriv[TR01_X25519_KEY_LEN], rsp[TR01_L2_HANDSHAKE_RSP_LEN];
+    uint8_t *etpub = rsp, *tauth = rsp + TR01_ETPUB_LEN;
+
+    lt_emu_session_end(chip);
+    if ((pkey_index >= LT_EMU_PAIRING_KEY_CNT) || (chip->pairing_key_state[pkey_index] != LT_EMU_PAIRING_KEY_WRITTEN)) {
+        lt_emu_respond(chip, TR01_L2_STATUS_HSK_ERR, NULL, 0);
+        return;
+    }
+    const uint8_t *shipub = chip->pairing_keys[pkey_index];
+
+    lt_emu_random(chip, etpriv, sizeof(etpriv));
+    lt_X25519_scalarmult(etpriv, etpub);
+
+    lt_sha256_init(&hctx);
+    lt_sha256_start(&hctx);
+    lt_sha256_update(&hctx, protocol_name, sizeof(protocol_name));
+    lt_sha256_finish(&hctx, hash);
+    const uint8_t *parts[] = {shipub, chip->cfg->s_t_pub, ehpub, &pkey_index, etpub};
+    const size_t part_lens[] = {TR01_SHIPUB_LEN, TR01_STPUB_LEN, TR01_EHPUB_LEN, 1, TR01_ETPUB_LEN};
+    for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); i++) {
+        lt_sha256_start(&hctx);
+        lt_sha256_update(&hctx, hash, sizeof(hash));
+        lt_sha256_update(&hctx, parts[i], part_lens[i]);
+        lt_sha256_finish(&hctx, hash);
+    }
+
+    uint8_t ck[33] = {0}, unused[32], shared_secret[TR01_X25519_KEY_LEN];
+    uint8_t kauth[TR01_AES256_KEY_LEN], kcmd[TR01_AES256_KEY_LEN], kres[TR01_AES256_KEY_LEN];
+    lt_X25519(etpriv, ehpub, shared_secret);
+    lt_hkdf(protocol_name, sizeof(protocol_name), shared_secret, sizeof(shared_secret), 1, ck, unused);
+    lt_X25519(etpriv, shipub, shared_secret);
+    lt_hkdf(ck, sizeof(ck), shared_secret, sizeof(shared_secret), 1, ck, unused);
+    lt_X25519(chip->cfg->s_t_priv, ehpub, shared_secret);
+    lt_hkdf(ck, sizeof(ck), shared_secret, sizeof(shared_secret), 2, ck, kauth);
+    lt_hkdf(ck, sizeof(ck), (uint8_t *)"", 0, 2, kcmd, kres);
+
+    memset(chip->encryption_iv, 0, sizeof(chip->encryption_iv));
+    memset(chip->decryption_iv, 0, sizeof(chip->decryption_iv));
+    if ((lt_aesgcm_init_and_key(chip->encrypt, kauth, sizeof(kauth)) != LT_OK)
+        || (lt_aesgcm_encrypt(chip->encrypt, chip->encryption_iv, TR01_L3_IV_SIZE, hash, sizeof(hash), (uint8_t *)"",
+                              0, tauth, TR01_L3_TAG_SIZE)
+            != LT_OK)
+        || (lt_aesgcm_init_and_key(chip->decrypt, kcmd, sizeof(kcmd)) != LT_OK)
+        || (lt_aesgcm_init_and_key(chip->encrypt, kres, sizeof(kres)) != LT_OK)) {
+        lt_emu_session_end(chip);
+        lt_emu_respond(chip, TR01_L2_STATUS_HSK_ERR, NULL, 0);
+        return;
+    }
+
+    chip->session = true;
+    lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_OK, rsp, sizeof(rsp));
+}
+
+/** @brief Writes an error result, returns its size. */
+static uint16_t lt_emu_l3_error(uint8_t *res, const uint8_t result)
+{
+    res[0] = result;
+    return 1;
+}
+
+/**
+ * @brief Puts a key into an ECC key slot.
+ *
+ * @return  true if the key is valid for the curve
+ */
+static bool lt_emu_ecc_key_set(lt_emu_chip_t *chip, const uint16_t slot, const uint8_t curve, const uint8_t origin,
+                               const uint8_t *priv)
+{
+    lt_emu_ecc_slot_t *key = &chip->ecc[slot];
+    uint8_t pub65[65];
+
+    if (curve == TR01_CURVE_P256) {
+        if (ecdsa_get_public_key65(&nist256p1, priv, pub65) != 0) {
+            return false;
+        }
+        memcpy(key->pub, pub65 + 1, TR01_CURVE_P256_PUBKEY_LEN);
+    }
+    else {
+        ed25519_publickey(priv, key->pub);
+    }
+    memcpy(key->priv, priv, TR01_CURVE_PRIVKEY_LEN);
+    key->curve = curve;
+    key->origin = origin;
+
+    return true;
+}
+
+/**
+ * @brief Executes a decrypted L3 command and writes its result in place of it.
+ *
+ * @param chip      Chip
+ * @param cmd       Command, starting with CMD_ID, overwritten by the result starting with RESULT
+ * @param cmd_size  Size of the command
+ * @return          Size of the result
+ */
+static uint16_t lt_emu_l3_execute(lt_emu_chip_t *chip, uint8_t *cmd, const uint16_t cmd_size)
+{
+    uint8_t *res = cmd;
+    const uint8_t *data = cmd + LT_EMU_L3_DATA_OFFSET;
+    uint16_t index = (cmd_size >= 3) ? lt_emu_get_u16(cmd + 1) : 0;
+
+    switch (cmd[0]) {
+        case TR01_L3_PING_CMD_ID:
+            res[0] = TR01_L3_RESULT_OK;
+            return cmd_size;
+
+        case TR01_L3_PAIRING_KEY_WRITE_CMD_ID:
+            if ((cmd_size != TR01_L3_PAIRING_KEY_WRITE_CMD_SIZE) || (index >= LT_EMU_PAIRING_KEY_CNT)
+                || (chip->pairing_key_state[index] != LT_EMU_PAIRING_KEY_EMPTY)) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            memcpy(chip->pairing_keys[index], cmd + 4, TR01_SHIPUB_LEN);
+            chip->pairing_key_state[index] = LT_EMU_PAIRING_KEY_WRITTEN;
+            return lt_emu_l3_error(res, TR01_L3_RESULT_OK);
+
+        case TR01_L3_PAIRING_KEY_READ_CMD_ID:
+            if ((cmd_size != TR01_L3_PAIRING_KEY_READ_CMD_SIZE) || (index >= LT_EMU_PAIRING_KEY_CNT)) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            if (chip->pairing_key_state[index] == LT_EMU_PAIRING_KEY_EMPTY) {
+                return lt_emu_l3_error(res, TR01_L3_PAIRING_KEY_EMPTY);
+            }
+            if (chip->pairing_key_state[index] == LT_EMU_PAIRING_KEY_INVALID) {
+                return lt_emu_l3_error(res, TR01_L3_PAIRING_KEY_INVALID);
+            }
+            memset(res, 0, 4);
+            res[0] = TR01_L3_RESULT_OK;
+            memcpy(res + 4, chip->pairing_keys[index], TR01_SHIPUB_LEN);
+            return TR01_L3_PAIRING_KEY_READ_RES_SIZE;
+
+        case TR01_L3_PAIRING_KEY_INVALIDATE_CMD_ID:
+            if ((cmd_size != TR01_L3_PAIRING_KEY_INVALIDATE_CMD_SIZE) || (index >= LT_EMU_PAIRING_KEY_CNT)) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            memset(chip->pairing_keys[index], 0, TR01_SHIPUB_LEN);
+            chip->pairing_key_state[index] = LT_EMU_PAIRING_KEY_INVALID;
+            return lt_emu_l3_error(res, TR01_L3_RESULT_OK);
+
+        case TR01_L3_R_CONFIG_WRITE_CMD_ID: {
+            uint16_t word = index / sizeof(uint32_t);
+            if ((cmd_size != TR01_L3_R_CONFIG_WRITE_CMD_SIZE) || !lt_emu_config_addr_valid(index)
+                || (chip->r_config_written[word / 32] & (1u << (word % 32)))) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            chip->r_config[word] = lt_emu_get_u32(cmd + 4);
+            chip->r_config_written[word / 32] |= 1u << (word % 32);
+            return lt_emu_l3_error(res, TR01_L3_RESULT_OK);
+        }
+
+        case TR01_L3_R_CONFIG_READ_CMD_ID:
+        case TR01_L3_I_CONFIG_READ_CMD_ID: {
+            if ((cmd_size != TR01_L3_R_CONFIG_READ_CMD_SIZE) || !lt_emu_config_addr_valid(index)) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            const uint32_t *config = (cmd[0] == TR01_L3_R_CONFIG_READ_CMD_ID) ? chip->r_config : chip->i_config;
+            memset(res, 0, 4);
+            res[0] = TR01_L3_RESULT_OK;
+            lt_emu_put_u32(res + 4, config[index / sizeof(uint32_t)]);
+            return TR01_L3_R_CONFIG_READ_RES_SIZE;
+        }
+
+        case TR01_L3_R_CONFIG_ERASE_CMD_ID:
+            if (cmd_size != TR01_L3_R_CONFIG_ERASE_CMD_SIZE) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            memset(chip->r_config, 0xff, sizeof(chip->r_config));
+            memset(chip->r_config_written, 0, sizeof(chip->r_config_written));
+            return lt_emu_l3_error(res, TR01_L3_RESULT_OK);
+
+        case TR01_L3_I_CONFIG_WRITE_CMD_ID:
+            if ((cmd_size != TR01_L3_I_CONFIG_WRITE_CMD_SIZE) || !lt_emu_config_addr_valid(index) || (cmd[3] > 31)) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            chip->i_config[index / sizeof(uint32_t)] &= ~(1u << cmd[3]);
+            return lt_emu_l3_error(res, TR01_L3_RESULT_OK);
+
+        case TR01_L3_R_MEM_DATA_WRITE_CMD_ID: {
+            uint16_t len = (uint16_t)(cmd_size - 4);
+            if ((cmd_size < TR01_L3_R_MEM_DATA_WRITE_CMD_SIZE_MIN) || (len > TR01_R_MEM_DATA_SIZE_MAX)
+                || (index >= LT_EMU_R_MEM_SLOT_CNT)) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            if (chip->r_mem_len[index]) {
+                return lt_emu_l3_error(res, TR01_L3_R_MEM_DATA_WRITE_WRITE_FAIL);
+            }
+            memcpy(chip->r_mem[index], cmd + 4, len);
+            chip->r_mem_len[index] = len;
+            return lt_emu_l3_error(res, TR01_L3_RESULT_OK);
+        }
+
+        case TR01_L3_R_MEM_DATA_READ_CMD_ID:
+            if ((cmd_size != TR01_L3_R_MEM_DATA_READ_CMD_SIZE) || (index >= LT_EMU_R_MEM_SLOT_CNT)) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            memset(res, 0, 4);
+            res[0] = TR01_L3_RESULT_OK;
+            memcpy(res + 4, chip->r_mem[index], chip->r_mem_len[index]);
+            return (uint16_t)(TR01_L3_R_MEM_DATA_READ_RES_SIZE_MIN + chip->r_mem_len[index]);
+
+        case TR01_L3_R_MEM_DATA_ERASE_CMD_ID:
+            if ((cmd_size != TR01_L3_R_MEM_DATA_ERASE_CMD_SIZE) || (index >= LT_EMU_R_MEM_SLOT_CNT)) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            chip->r_mem_len[index] = 0;
+            return lt_emu_l3_error(res, TR01_L3_RESULT_OK);
+
+        case TR01_L3_RANDOM_VALUE_GET_CMD_ID: {
+            if (cmd_size != TR01_L3_RANDOM_VALUE_GET_CMD_SIZE) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            uint8_t n_bytes = cmd[1];
+            memset(res, 0, 4);
+            res[0] = TR01_L3_RESULT_OK;
+            lt_emu_random(chip, res + 4, n_bytes);
+            return (uint16_t)(TR01_L3_RANDOM_VALUE_GET_RES_SIZE_MIN + n_bytes);
+        }
+
+        case TR01_L3_ECC_KEY_GENERATE_CMD_ID:
+        case TR01_L3_ECC_KEY_STORE_CMD_ID: {
+            bool store = (cmd[0] == TR01_L3_ECC_KEY_STORE_CMD_ID);
+            uint8_t curve = cmd[3];
+            if ((cmd_size != (store ? TR01_L3_ECC_KEY_STORE_CMD_SIZE : TR01_L3_ECC_KEY_GENERATE_CMD_SIZE))
+                || (index >= LT_EMU_ECC_SLOT_CNT) || ((curve != TR01_CURVE_P256) && (curve != TR01_CURVE_ED25519))
+                || chip->ecc[index].curve) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            if (store) {
+                return lt_emu_l3_error(res, lt_emu_ecc_key_set(chip, index, curve, TR01_CURVE_STORED, data)
+                                                ? TR01_L3_RESULT_OK
+                                                : TR01_L3_RESULT_FAIL);
+            }
+            uint8_t priv[TR01_CURVE_PRIVKEY_LEN];
+            do {
+                lt_emu_random(chip, priv, sizeof(priv));
+            } while (!lt_emu_ecc_key_set(chip, index, curve, TR01_CURVE_GENERATED, priv));
+            return lt_emu_l3_error(res, TR01_L3_RESULT_OK);
+        }
+
+        case TR01_L3_ECC_KEY_READ_CMD_ID: {
+            if ((cmd_size != TR01_L3_ECC_KEY_READ_CMD_SIZE) || (index >= LT_EMU_ECC_SLOT_CNT)) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            const lt_emu_ecc_slot_t *key = &chip->ecc[index];
+            if (!key->curve) {
+                return lt_emu_l3_error(res, TR01_L3_ECC_INVALID_KEY);
+            }
+            uint16_t pub_len
+                = (key->curve == TR01_CURVE_P256) ? TR01_CURVE_P256_PUBKEY_LEN : TR01_CURVE_ED25519_PUBKEY_LEN;
+            memset(res, 0, LT_EMU_L3_DATA_OFFSET);
+            res[0] = TR01_L3_RESULT_OK;
+            res[1] = key->curve;
+            res[2] = key->origin;
+            memcpy(res + LT_EMU_L3_DATA_OFFSET, key->pub, pub_len);
+            return (uint16_t)(LT_EMU_L3_DATA_OFFSET + pub_len);
+        }
+
+        case TR01_L3_ECC_KEY_ERASE_CMD_ID:
+            if ((cmd_size != TR01_L3_ECC_KEY_ERASE_CMD_SIZE) || (index >= LT_EMU_ECC_SLOT_CNT)) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            memset(&chip->ecc[index], 0, sizeof(chip->ecc[index]));
+            return lt_emu_l3_error(res, TR01_L3_RESULT_OK);
+
+        case TR01_L3_ECDSA_SIGN_CMD_ID:
+        case TR01_L3_EDDSA_SIGN_CMD_ID: {
+            bool ecdsa = (cmd[0] == TR01_L3_ECDSA_SIGN_CMD_ID);
+            // TR01_L3_EDDSA_SIGN_CMD_SIZE_MIN counts one byte of the message, which may be empty
+            if ((ecdsa && (cmd_size != TR01_L3_ECDSA_SIGN_CMD_SIZE))
+                || (!ecdsa
+                    && ((cmd_size < TR01_L3_EDDSA_SIGN_CMD_SIZE_MIN - 1)
+                        || (cmd_size > LT_EMU_L3_DATA_OFFSET + TR01_L3_EDDSA_SIGN_CMD_MSG_LEN_MAX)))
+                || (index >= LT_EMU_ECC_SLOT_CNT)) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            const lt_emu_ecc_slot_t *key = &chip->ecc[index];
+            if (key->curve != (ecdsa ? TR01_CURVE_P256 : TR01_CURVE_ED25519)) {
+                return lt_emu_l3_error(res, TR01_L3_ECC_INVALID_KEY);
+            }
+            uint8_t rs[TR01_ECDSA_EDDSA_SIGNATURE_LENGTH];
+            if (ecdsa) {
+                if (ecdsa_sign_digest(&nist256p1, key->priv, data, rs, NULL, NULL) != 0) {
+                    return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+                }
+            }
+            else {
+                ed25519_sign(data, cmd_size - LT_EMU_L3_DATA_OFFSET, key->priv, rs);
+            }
+            memset(res, 0, LT_EMU_L3_DATA_OFFSET);
+            res[0] = TR01_L3_RESULT_OK;
+            memcpy(res + LT_EMU_L3_DATA_OFFSET, rs, sizeof(rs));
+            return TR01_L3_ECDSA_SIGN_RES_SIZE;
+        }
+
+        case TR01_L3_MCOUNTER_INIT_CMD_ID:
+            if ((cmd_size != TR01_L3_MCOUNTER_INIT_CMD_SIZE) || (index >= LT_EMU_MCOUNTER_CNT)) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            chip->mcounter[index] = lt_emu_get_u32(cmd + 4);
+            chip->mcounter_valid |= (uint16_t)(1u << index);
+            return lt_emu_l3_error(res, TR01_L3_RESULT_OK);
+
+        case TR01_L3_MCOUNTER_UPDATE_CMD_ID:
+        case TR01_L3_MCOUNTER_GET_CMD_ID:
+            if ((cmd_size != TR01_L3_MCOUNTER_GET_CMD_SIZE) || (index >= LT_EMU_MCOUNTER_CNT)) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            if (!(chip->mcounter_valid & (1u << index))) {
+                return lt_emu_l3_error(res, TR01_L3_MCOUNTER_COUNTER_INVALID);
+            }
+            if (cmd[0] == TR01_L3_MCOUNTER_UPDATE_CMD_ID) {
+                if (chip->mcounter[index] == 0) {
+                    return lt_emu_l3_error(res, TR01_L3_MCOUNTER_UPDATE_ERROR);
+                }
+                chip->mcounter[index]--;
+                return lt_emu_l3_error(res, TR01_L3_RESULT_OK);
+            }
+            memset(res, 0, 4);
+            res[0] = TR01_L3_RESULT_OK;
+            lt_emu_put_u32(res + 4, chip->mcounter[index]);
+            return TR01_L3_MCOUNTER_GET_RES_SIZE;
+
+        case TR01_L3_MAC_AND_DESTROY_CMD_ID: {
+            if ((cmd_size != TR01_L3_MAC_AND_DESTROY_CMD_SIZE) || (index >= LT_EMU_MACANDD_SLOT_CNT)) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            // The output is keyed by the slot, the slot is then replaced by a value derived from the input only,
+            // so the same input always restores the same slot
+            uint8_t data_in[TR01_MAC_AND_DESTROY_DATA_SIZE];
+            memcpy(data_in, cmd + 4, sizeof(data_in));
+            memset(res, 0, 4);
+            res[0] = TR01_L3_RESULT_OK;
+            lt_hmac_sha256(chip->macandd[index], TR01_MAC_AND_DESTROY_DATA_SIZE, data_in, sizeof(data_in), res + 4);
+            lt_hmac_sha256(chip->macandd_key, sizeof(chip->macandd_key), data_in, sizeof(data_in),
+                           chip->macandd[index]);
+            return TR01_L3_MAC_AND_DESTROY_RES_SIZE;
+        }
+
+        case TR01_L3_SERIAL_CODE_GET_CMD_ID: {
+            if (cmd_size != TR01_L3_SERIAL_CODE_GET_CMD_SIZE) {
+                return lt_emu_l3_error(res, TR01_L3_RESULT_FAIL);
+            }
+            struct lt_crypto_sha256_ctx_t hctx;
+            memset(res, 0, 4);
+            res[0] = TR01_L3_RESULT_OK;
+            lt_sha256_init(&hctx);
+            lt_sha256_start(&hctx);
+            lt_sha256_update(&hctx, chip->cfg->chip_id, sizeof(chip->cfg->chip_id));
+            lt_sha256_finish(&hctx, res + 4);
+            return TR01_L3_SERIAL_CODE_GET_RES_SIZE;
+        }
+
+        default:
+            return lt_emu_l3_error(res, TR01_L3_RESULT_INVALID_CMD);
+    }
+}
+
+/**
+ * @brief Decrypts the received L3 command packet, executes it and encrypts the result in its place.
+ *
+ * @return  L2 status of the response to the last chunk of the command
+ */
+static uint8_t lt_emu_l3_process(lt_emu_chip_t *chip)
+{
+    uint16_t cmd_size = lt_emu_get_u16(chip->l3);
+    uint8_t *cmd = chip->l3 + TR01_L3_CMD_SIZE_SIZE;
+
+    if (lt_aesgcm_decrypt(chip->decrypt, chip->decryption_iv, TR01_L3_IV_SIZE, (uint8_t *)"", 0, cmd, cmd_size,
+                          cmd + cmd_size, TR01_L3_TAG_SIZE)
+        != LT_OK) {
+        lt_emu_session_end(chip);
+        return TR01_L2_STATUS_TAG_ERR;
+    }
+    lt_emu_iv_increase(chip->decryption_iv);
+
+    uint16_t res_size = (cmd_size > 0) ? lt_emu_l3_execute(chip, cmd, cmd_size)
+                                       : lt_emu_l3_error(cmd, TR01_L3_RESULT_INVALID_CMD);
+    chip->l3[0] = (uint8_t)res_size;
+    chip->l3[1] = (uint8_t)(res_size >> 8);
+    if (lt_aesgcm_encrypt(chip->encrypt, chip->encryption_iv, TR01_L3_IV_SIZE, (uint8_t *)"", 0, cmd, res_size,
+                          cmd + res_size, TR01_L3_TAG_SIZE)
+        != LT_OK) {
+        lt_emu_session_end(chip);
+        return TR01_L2_STATUS_GEN_ERR;
+    }
+    lt_emu_iv_increase(chip->encryption_iv);
+
+    chip->l3_len = (uint16_t)(TR01_L3_RES_SIZE_SIZE + res_size + TR01_L3_TAG_SIZE);
+    chip->l3_res_offset = 0;
+    chip->l3_res_pending = true;
+
+    return TR01_L2_STATUS_REQUEST_OK;
+}
+
+/**
+ * @brief Handles a chunk of Encrypted_Cmd_Req.
+ */
+static void lt_emu_encrypted_cmd(lt_emu_chip_t *chip, const uint8_t *chunk, const uint8_t len)
+{
+    if (!chip->session) {
+        chip->l3_cmd_pending = false;
+        lt_emu_respond(chip, TR01_L2_STATUS_NO_SESSION, NULL, 0);
+        return;
+    }
+    if (!chip->l3_cmd_pending) {
+        chip->l3_cmd_pending = true;
+        chip->l3_res_pending = false;
+        chip->l3_len = 0;
+    }
+    if ((size_t)chip->l3_len + len > sizeof(chip->l3)) {
+        chip->l3_cmd_pending = false;
+        lt_emu_respond(chip, TR01_L2_STATUS_GEN_ERR, NULL, 0);
+        return;
+    }
+    memcpy(chip->l3 + chip->l3_len, chunk, len);
+    chip->l3_len += len;
+
+    if (chip->l3_len < TR01_L3_CMD_SIZE_SIZE) {
+        lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_CONT, NULL, 0);
+        return;
+    }
+    uint32_t packet_size = TR01_L3_CMD_SIZE_SIZE + lt_emu_get_u16(chip->l3) + TR01_L3_TAG_SIZE;
+    if (packet_size > sizeof(chip->l3) || chip->l3_len > packet_size) {
+        chip->l3_cmd_pending = false;
+        lt_emu_respond(chip, TR01_L2_STATUS_GEN_ERR, NULL, 0);
+        return;
+    }
+    if (chip->l3_len < packet_size) {
+        lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_CONT, NULL, 0);
+        return;
+    }
+
+    chip->l3_cmd_pending = false;
+    lt_emu_respond(chip, lt_emu_l3_process(chip), NULL, 0);
+}
+
+/**
+ * @brief Handles Get_Log_Req, the log is enabled by FW_LOG_EN in both I and R configuration.
+ */
+static void lt_emu_get_log(lt_emu_chip_t *chip)
+{
+    uint16_t word = TR01_CFG_DEBUG_ADDR / sizeof(uint32_t);
+    if (!(chip->i_config[word] & chip->r_config[word] & BOOTLOADER_CO_CFG_DEBUG_FW_LOG_EN_MASK)) {
+        lt_emu_respond(chip, TR01_L2_STATUS_RESP_DISABLED, NULL, 0);
+        return;
+    }
+    lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_OK, (const uint8_t *)lt_emu_log_msg, sizeof(lt_emu_log_msg) - 1);
+}
+
+/**
+ * @brief Handles Mutable_FW_Erase_Req and the firmware update requests of the silicon revision.
+ * @details Only the bank headers and the progress of the transfer are modelled, see lt_emu_fw_bank_t.
+ */
+static void lt_emu_mutable_fw(lt_emu_chip_t *chip, const uint8_t *req)
+{
+    uint8_t req_id = req[0], req_len = req[1];
+    const uint8_t *data = req + TR01_L2_REQ_ID_SIZE + TR01_L2_REQ_RSP_LEN_SIZE;
+
+    if (!chip->maintenance) {
+        lt_emu_respond(chip, LT_EMU_STATUS_UNSUPPORTED, NULL, 0);
+        return;
+    }
+
+    if (req_id == TR01_L2_MUTABLE_FW_ERASE_REQ_ID) {
+        uint8_t index = lt_emu_fw_bank_index(data[0]);
+        if ((req_len != TR01_L2_MUTABLE_FW_ERASE_REQ_LEN) || (index == LT_EMU_FW_BANK_CNT)) {
+            lt_emu_respond(chip, TR01_L2_STATUS_GEN_ERR, NULL, 0);
+            return;
+        }
+        lt_emu_fw_bank_erase(&chip->fw_banks[index]);
+        lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_OK, NULL, 0);
+        return;
+    }
+
+#ifdef ABAB
+    const struct lt_l2_mutable_fw_update_req_t *p_req = (const struct lt_l2_mutable_fw_update_req_t *)req;
+    uint8_t index = lt_emu_fw_bank_index(p_req->bank_id);
+    uint16_t len = req_len - TR01_L2_MUTABLE_FW_UPDATE_REQ_LEN_MIN;
+    if ((req_len < TR01_L2_MUTABLE_FW_UPDATE_REQ_LEN_MIN + TR01_L2_MUTABLE_FW_UPDATE_REQ_DATA_LEN_MIN)
+        || (index == LT_EMU_FW_BANK_CNT) || ((uint32_t)p_req->offset + len > LT_EMU_FW_BANK_SIZE)) {
+        lt_emu_respond(chip, TR01_L2_STATUS_GEN_ERR, NULL, 0);
+        return;
+    }
+    lt_emu_fw_bank_write(&chip->fw_banks[index], lt_emu_fw_bank_type(index), p_req->offset, p_req->data, len);
+#else
+    if (req_id == TR01_L2_MUTABLE_FW_UPDATE_REQ_ID) {
+        const struct lt_l2_mutable_fw_update_req_t *p_req = (const struct lt_l2_mutable_fw_update_req_t *)req;
+        if ((req_len != TR01_L2_MUTABLE_FW_UPDATE_REQ_LEN)
+            || ((p_req->type != LT_EMU_FW_TYPE_CPU) && (p_req->type != LT_EMU_FW_TYPE_SPECT))
+            || (p_req->version < ((p_req->type == LT_EMU_FW_TYPE_CPU) ? chip->riscv_fw_ver : chip->spect_fw_ver))) {
+            lt_emu_respond(chip, TR01_L2_STATUS_GEN_ERR, NULL, 0);
+            return;
+        }
+        // The chip picks a bank without a whole image, otherwise the one with the older firmware
+        uint8_t first = (p_req->type == LT_EMU_FW_TYPE_CPU) ? 0 : LT_EMU_FW_BANK_SPECT;
+        const lt_emu_fw_bank_t *banks = &chip->fw_banks[first];
+        bool second = banks[0].complete && (!banks[1].complete || (banks[1].version < banks[0].version));
+        chip->fw_update_bank = first + (second ? 1 : 0);
+        lt_emu_fw_bank_erase(&chip->fw_banks[chip->fw_update_bank]);
+        chip->fw_banks[chip->fw_update_bank].version = p_req->version;
+        lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_OK, NULL, 0);
+        return;
+    }
+
+    const struct lt_l2_mutable_fw_update_data_req_t *p_req = (const struct lt_l2_mutable_fw_update_data_req_t *)req;
+    const uint8_t hdr_len = sizeof(p_req->hash) + sizeof(p_req->offset);
+    if ((req_len <= hdr_len) || (chip->fw_update_bank == LT_EMU_FW_BANK_CNT)
+        || ((uint32_t)p_req->offset + req_len - hdr_len > LT_EMU_FW_BANK_SIZE)) {
+        lt_emu_respond(chip, TR01_L2_STATUS_GEN_ERR, NULL, 0);
+        return;
+    }
+    lt_emu_fw_bank_t *bank = &chip->fw_banks[chip->fw_update_bank];
+    uint16_t len = req_len - hdr_len;
+    // Hash of the next chunk is zero in the last one
+    bool last = true;
+    for (size_t i = 0; i < sizeof(p_req->hash); i++) {
+        last = last && (p_req->hash[i] == 0);
+    }
+    if (last) {
+        bank->size = p_req->offset + len;
+    }
+    lt_emu_fw_bank_write(bank, lt_emu_fw_bank_type(chip->fw_update_bank), p_req->offset, p_req->data, len);
+#endif
+    lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_OK, NULL, 0);
+}
+
+/**
+ * @brief Handles an L2 request frame.
+ */
+static void lt_emu_request(lt_emu_chip_t *chip, const uint8_t *req, const uint16_t len)
+{
+    if ((len < TR01_L2_REQ_ID_SIZE + TR01_L2_REQ_RSP_LEN_SIZE + TR01_L2_REQ_RSP_CRC_SIZE)
+        || (len < req[1] + TR01_L2_REQ_ID_SIZE + TR01_L2_REQ_RSP_LEN_SIZE + TR01_L2_REQ_RSP_CRC_SIZE)) {
+        lt_emu_respond(chip, TR01_L2_STATUS_CRC_ERR, NULL, 0);
+        return;
+    }
+    uint8_t req_id = req[0], req_len = req[1];
+    const uint8_t *data = req + TR01_L2_REQ_ID_SIZE + TR01_L2_REQ_RSP_LEN_SIZE;
+    uint16_t crc = crc16(req, req_len + TR01_L2_REQ_ID_SIZE + TR01_L2_REQ_RSP_LEN_SIZE);
+    if ((data[req_len] != (crc >> 8)) || (data[req_len + 1] != (crc & 0xff))) {
+        lt_emu_respond(chip, TR01_L2_STATUS_CRC_ERR, NULL, 0);
+        return;
+    }
+
+    if (req_id == TR01_L2_RESEND_REQ_ID) {
+        // A response the host did not clock out completely is still waiting, it is sent as it is
+        if (!chip->rsp_valid) {
+            memcpy(chip->rsp, chip->last_rsp, sizeof(chip->rsp));
+            chip->rsp_valid = true;
+        }
+        return;
+    }
+    if (req_id != TR01_L2_ENCRYPTED_CMD_REQ_ID) {
+        chip->l3_cmd_pending = false;
+        chip->l3_res_pending = false;
+    }
+
+    switch (req_id) {
+        case TR01_L2_GET_INFO_REQ_ID:
+            if (req_len != TR01_L2_GET_INFO_REQ_LEN) {
+                break;
+            }
+            lt_emu_get_info(chip, data[0], data[1]);
+            return;
+        case TR01_L2_STARTUP_REQ_ID:
+            if ((req_len != TR01_L2_STARTUP_REQ_LEN)
+                || ((data[0] != TR01_REBOOT) && (data[0] != TR01_MAINTENANCE_REBOOT))) {
+                break;
+            }
+            chip->pending_startup = data[0];
+            lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_OK, NULL, 0);
+            return;
+        case TR01_L2_GET_LOG_REQ_ID:
+            if (req_len != TR01_L2_GET_LOG_REQ_LEN) {
+                break;
+            }
+            lt_emu_get_log(chip);
+            return;
+        case TR01_L2_HANDSHAKE_REQ_ID:
+        case TR01_L2_ENCRYPTED_CMD_REQ_ID:
+        case TR01_L2_ENCRYPTED_SESSION_ABT_ID:
+        case TR01_L2_SLEEP_REQ_ID:
+            if (chip->maintenance) {
+                lt_emu_respond(chip, LT_EMU_STATUS_UNSUPPORTED, NULL, 0);
+                return;
+            }
+            if ((req_id == TR01_L2_HANDSHAKE_REQ_ID) && (req_len == TR01_L2_HANDSHAKE_REQ_LEN)) {
+                lt_emu_handshake(chip, data, data[TR01_EHPUB_LEN]);
+                return;
+            }
+            if ((req_id == TR01_L2_ENCRYPTED_CMD_REQ_ID) && (req_len > 0)) {
+                lt_emu_encrypted_cmd(chip, data, req_len);
+                return;
+            }
+            if ((req_id == TR01_L2_ENCRYPTED_SESSION_ABT_ID) && (req_len == TR01_L2_ENCRYPTED_SESSION_ABT_LEN)) {
+                lt_emu_session_end(chip);
+                lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_OK, NULL, 0);
+                return;
+            }
+            if ((req_id == TR01_L2_SLEEP_REQ_ID) && (req_len == TR01_L2_SLEEP_REQ_LEN)
+                && (data[0] == TR01_L2_SLEEP_KIND_SLEEP)) {
+                lt_emu_session_end(chip);
+                lt_emu_respond(chip, TR01_L2_STATUS_REQUEST_OK, NULL, 0);
+                return;
+            }
+            break;
+        case TR01_L2_MUTABLE_FW_UPDATE_REQ_ID:
+#ifdef ACAB
+        case TR01_L2_MUTABLE_FW_UPDATE_DATA_REQ:
+#endif
+        case TR01_L2_MUTABLE_FW_ERASE_REQ_ID:
+            lt_emu_mutable_fw(chip, req);
+            return;
+        default:
+            lt_emu_respond(chip, TR01_L2_STATUS_UNKNOWN_ERR, NULL, 0);
+            return;
+    }
+
+    lt_emu_respond(chip, TR01_L2_STATUS_GEN_ERR, NULL, 0);
+}
+
+/**
+ * @brief Called once the host read the whole response frame, prepares the next chunk of an L3 result or reboots.
+ */
+static void lt_emu_response_read(lt_emu_chip_t *chip)
+{
+    memcpy(chip->last_rsp, chip->rsp, sizeof(chip->last_rsp));
+    chip->rsp_valid = false;
+
+    if (chip->pending_startup) {
+        lt_emu_reboot(chip, chip->pending_startup);
+        chip->pending_startup = 0;
+        return;
+    }
+    if (!chip->l3_res_pending) {
+        return;
+    }
+
+    uint16_t len = chip->l3_len - chip->l3_res_offset;
+    if (len > LT_EMU_RES_CHUNK_SIZE) {
+        len = LT_EMU_RES_CHUNK_SIZE;
+    }
+    bool last = (chip->l3_res_offset + len == chip->l3_len);
+    lt_emu_respond(chip, last ? TR01_L2_STATUS_RESULT_OK : TR01_L2_STATUS_RESULT_CONT,
+                   chip->l3 + chip->l3_res_offset, (uint8_t)len);
+    chip->l3_res_offset += len;
+    chip->l3_res_pending = !last;
+}
+
+void lt_emu_chip_init(lt_emu_chip_t *chip, const lt_emu_cfg_t *cfg, const uint8_t *seed, const uint16_t seed_len)
+{
+    static const char personalization[] = "lt_emu_chip";
+
+    memset(chip, 0, sizeof(*chip));
+    chip->cfg = cfg;
+
+    lt_hmac_drbg_instantiate(chip->drbg_key, chip->drbg_v, seed, seed_len, NULL, 0, (const uint8_t *)personalization,
+                             sizeof(personalization) - 1);
+    lt_hmac_sha256(cfg->s_t_priv, sizeof(cfg->s_t_priv), (const uint8_t *)personalization,
+                   sizeof(personalization) - 1, chip->macandd_key);
+
+    memcpy(chip->pairing_keys, cfg->pairing_keys, sizeof(chip->pairing_keys));
+    memcpy(chip->pairing_key_state, cfg->pairing_key_state, sizeof(chip->pairing_key_state));
+    memset(chip->r_config, 0xff, sizeof(chip->r_config));
+    memset(chip->i_config, 0xff, sizeof(chip->i_config));
+
+    for (uint8_t i = 0; i < LT_EMU_FW_BANK_CNT; i++) {
+        lt_emu_fw_bank_fill(&chip->fw_banks[i], lt_emu_fw_bank_type(i), LT_EMU_FW_VERSION);
+    }
+    chip->riscv_fw_ver = LT_EMU_FW_VERSION;
+    chip->spect_fw_ver = LT_EMU_FW_VERSION;
+    chip->fw_update_bank = LT_EMU_FW_BANK_CNT;
+}
+
+uint8_t lt_emu_chip_status(lt_emu_chip_t *chip)
+{
+    if (chip->boot_polls) {
+        chip->boot_polls--;
+        return 0;
+    }
+
+    return TR01_L1_CHIP_MODE_READY_bit | (chip->maintenance ? TR01_L1_CHIP_MODE_STARTUP_bit : 0);
+}
+
+const uint8_t *lt_emu_chip_response(const lt_emu_chip_t *chip)
+{
+    return (chip->rsp_valid && !chip->boot_polls) ? chip->rsp : NULL;
+}
+
+void lt_emu_chip_end(lt_emu_chip_t *chip, const uint8_t *mosi, const uint16_t len)
+{
+    if (!len || chip->boot_polls) {
+        return;
+    }
+
+    if (mosi[0] == TR01_L1_GET_RESPONSE_REQ_ID) {
+        // The response is consumed once the host clocked out all of it including CRC
+        if (chip->rsp_valid
+            && (len >= TR01_L1_CHIP_STATUS_SIZE + TR01_L2_STATUS_SIZE + TR01_L2_REQ_RSP_LEN_SIZE + chip->rsp[1]
+                           + TR01_L2_REQ_RSP_CRC_SIZE)) {
+            lt_emu_response_read(chip);
+        }
+        return;
+    }
+
+    lt_emu_request(chip, mosi, len);
+}
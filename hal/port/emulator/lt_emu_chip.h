@@ -0,0 +1,222 @@
+#ifndef LT_EMU_CHIP_H
+#define LT_EMU_CHIP_H
+
+/**
+ * @file lt_emu_chip.h
+ * @author Tropic Square s.r.o.
+ * @brief Emulated TROPIC01: L2 frames, Secure Session and L3 commands processed in-process.
+ * @details The chip is driven one SPI transaction at a time: lt_emu_chip_status() gives CHIP_STATUS for the first
+ * byte of a transaction, lt_emu_chip_response() the bytes which follow it, and lt_emu_chip_end() passes everything
+ * the host sent when the chip select goes high. State of the chip lives in lt_emu_chip_t only, so several chips can
+ * be emulated in one process.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "libtropic_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Number of pairing key slots. */
+#define LT_EMU_PAIRING_KEY_CNT 4
+/** @brief Number of ECC key slots. */
+#define LT_EMU_ECC_SLOT_CNT 32
+/** @brief Number of R memory slots. */
+#define LT_EMU_R_MEM_SLOT_CNT (TR01_R_MEM_DATA_SLOT_MAX + 1)
+/** @brief Number of monotonic counters. */
+#define LT_EMU_MCOUNTER_CNT 16
+/** @brief Number of MAC-and-Destroy slots. */
+#define LT_EMU_MACANDD_SLOT_CNT 128
+/** @brief Number of 32-bit words of the configuration address space (addresses 0x000 - 0x1fc). */
+#define LT_EMU_CONFIG_WORD_CNT 128
+/** @brief Maximal size of the certificate store. */
+#define LT_EMU_CERT_STORE_SIZE_MAX TR01_L2_GET_INFO_REQ_CERT_SIZE_TOTAL
+/** @brief Number of CHIP_STATUS reads the chip stays not READY for after a reboot. */
+#define LT_EMU_BOOT_POLLS 2
+/** @brief Number of firmware banks: FW1, FW2, SPECT1 and SPECT2. */
+#define LT_EMU_FW_BANK_CNT 4
+
+/** @brief State of a pairing key slot. */
+typedef enum lt_emu_pairing_key_state_t {
+    LT_EMU_PAIRING_KEY_EMPTY = 0,
+    LT_EMU_PAIRING_KEY_WRITTEN,
+    LT_EMU_PAIRING_KEY_INVALID
+} lt_emu_pairing_key_state_t;
+
+/**
+ * @brief Provisioning of an emulated chip, usually generated from a lab batch package by
+ * tropic01_model/create_model_cfg.py.
+ */
+typedef struct lt_emu_cfg_t {
+    /** @brief Certificate store returned by Get_Info, including its header. */
+    const uint8_t *cert_store;
+    /** @brief Length of the certificate store, at most LT_EMU_CERT_STORE_SIZE_MAX. */
+    uint16_t cert_store_len;
+    /** @brief CHIP_ID object. */
+    uint8_t chip_id[TR01_L2_GET_INFO_CHIP_ID_SIZE];
+    /** @brief X25519 private key of the chip (STPRIV). */
+    uint8_t s_t_priv[TR01_STPUB_LEN];
+    /** @brief X25519 public key of the chip (STPUB), the one in the device certificate. */
+    uint8_t s_t_pub[TR01_STPUB_LEN];
+    /** @brief Pairing keys the chip is provisioned with. */
+    uint8_t pairing_keys[LT_EMU_PAIRING_KEY_CNT][TR01_SHIPUB_LEN];
+    /** @brief States of the pairing key slots. */
+    lt_emu_pairing_key_state_t pairing_key_state[LT_EMU_PAIRING_KEY_CNT];
+} lt_emu_cfg_t;
+
+/** @brief ECC key slot of the emulated chip. */
+typedef struct lt_emu_ecc_slot_t {
+    /** @brief TR01_CURVE_P256 or TR01_CURVE_ED25519, 0 if the slot is empty. */
+    uint8_t curve;
+    /** @brief TR01_CURVE_GENERATED or TR01_CURVE_STORED. */
+    uint8_t origin;
+    /** @brief Private key. */
+    uint8_t priv[TR01_CURVE_PRIVKEY_LEN];
+    /** @brief Public key, 32 bytes used for Ed25519. */
+    uint8_t pub[TR01_CURVE_P256_PUBKEY_LEN];
+} lt_emu_ecc_slot_t;
+
+/**
+ * @brief Firmware bank of the emulated chip.
+ * @details The firmware itself is not kept, only its header and how much of the image was written. Signatures and
+ * hashes of the image are not checked.
+ */
+typedef struct lt_emu_fw_bank_t {
+    /** @brief Bytes of the image where the bank header is, returned by Get_Info on ABAB (0xff once erased). */
+    uint8_t header[TR01_L2_GET_INFO_FW_HEADER_SIZE_BOOT_V1];
+    /** @brief Version of the firmware, the same number as Get_Info returns for the running firmware. */
+    uint32_t version;
+    /** @brief Length of the image, known once its last chunk was written (ACAB). */
+    uint32_t size;
+    /** @brief Number of bytes written without a gap from the start of the image. */
+    uint32_t written;
+    /** @brief The bank holds the whole image, the chip can boot from it. */
+    bool complete;
+} lt_emu_fw_bank_t;
+
+/** @brief State of an emulated chip, including its non-volatile memories. */
+typedef struct lt_emu_chip_t {
+    /** @brief Provisioning of the chip. */
+    const lt_emu_cfg_t *cfg;
+    /** @brief The chip runs its bootloader (maintenance mode). */
+    bool maintenance;
+    /** @brief CHIP_STATUS reads left until the chip is READY after a reboot. */
+    uint8_t boot_polls;
+    /** @brief Startup_Req ID to reboot with once its response is read, 0 if none. */
+    uint8_t pending_startup;
+    /** @brief Version of the RISC-V firmware the application was booted from. */
+    uint32_t riscv_fw_ver;
+    /** @brief Version of the SPECT firmware the application was booted from. */
+    uint32_t spect_fw_ver;
+    /** @brief Bank the image of the last Mutable_FW_Update_Req is written to (ACAB), LT_EMU_FW_BANK_CNT if none. */
+    uint8_t fw_update_bank;
+
+    /** @brief Response frame (STATUS, RSP_LEN, RSP_DATA, RSP_CRC) waiting to be read. */
+    uint8_t rsp[TR01_L2_MAX_FRAME_SIZE];
+    /** @brief A response is waiting to be read. */
+    bool rsp_valid;
+    /** @brief Last response read by the host, sent again on Resend_Req. */
+    uint8_t last_rsp[TR01_L2_MAX_FRAME_SIZE];
+
+    /** @brief L3 packet being received or sent. */
+    uint8_t l3[TR01_L3_PACKET_MAX_SIZE];
+    /** @brief Length of the L3 packet received so far or to be sent. */
+    uint16_t l3_len;
+    /** @brief Chunks of an L3 command are being received. */
+    bool l3_cmd_pending;
+    /** @brief Offset of the next L3 result chunk to be sent. */
+    uint16_t l3_res_offset;
+    /** @brief An L3 result is being sent. */
+    bool l3_res_pending;
+
+    /** @brief Secure Session is established. */
+    bool session;
+    /** @brief AES-GCM context decrypting L3 commands. */
+    uint8_t decrypt[352] __attribute__((aligned(16)));
+    /** @brief AES-GCM context encrypting L3 results. */
+    uint8_t encrypt[352] __attribute__((aligned(16)));
+    /** @brief IV of the next L3 command. */
+    uint8_t decryption_iv[TR01_L3_IV_SIZE];
+    /** @brief IV of the next L3 result. */
+    uint8_t encryption_iv[TR01_L3_IV_SIZE];
+
+    /** @brief Key of the chip's HMAC_DRBG. */
+    uint8_t drbg_key[32];
+    /** @brief Value of the chip's HMAC_DRBG. */
+    uint8_t drbg_v[32];
+    /** @brief Secret key MAC-and-Destroy slots are derived with. */
+    uint8_t macandd_key[32];
+
+    /** @brief Pairing key slots. */
+    uint8_t pairing_keys[LT_EMU_PAIRING_KEY_CNT][TR01_SHIPUB_LEN];
+    /** @brief States of the pairing key slots. */
+    lt_emu_pairing_key_state_t pairing_key_state[LT_EMU_PAIRING_KEY_CNT];
+    /** @brief R configuration. */
+    uint32_t r_config[LT_EMU_CONFIG_WORD_CNT];
+    /** @brief Bitmap of R configuration objects written since the last erase. */
+    uint32_t r_config_written[LT_EMU_CONFIG_WORD_CNT / 32];
+    /** @brief I configuration. */
+    uint32_t i_config[LT_EMU_CONFIG_WORD_CNT];
+    /** @brief ECC key slots. */
+    lt_emu_ecc_slot_t ecc[LT_EMU_ECC_SLOT_CNT];
+    /** @brief R memory slots. */
+    uint8_t r_mem[LT_EMU_R_MEM_SLOT_CNT][TR01_R_MEM_DATA_SIZE_MAX];
+    /** @brief Lengths of data in R memory slots, 0 for empty slots. */
+    uint16_t r_mem_len[LT_EMU_R_MEM_SLOT_CNT];
+    /** @brief Monotonic counters. */
+    uint32_t mcounter[LT_EMU_MCOUNTER_CNT];
+    /** @brief Bitmap of initialized monotonic counters. */
+    uint16_t mcounter_valid;
+    /** @brief MAC-and-Destroy slots. */
+    uint8_t macandd[LT_EMU_MACANDD_SLOT_CNT][TR01_MAC_AND_DESTROY_DATA_SIZE];
+    /** @brief Firmware banks FW1, FW2, SPECT1 and SPECT2. */
+    lt_emu_fw_bank_t fw_banks[LT_EMU_FW_BANK_CNT];
+} lt_emu_chip_t;
+
+/**
+ * @brief Provisions the chip: all memories are reset to the state given by the configuration, or erased.
+ * @details All firmware banks hold version 1.0.0 and the chip boots into the application.
+ *
+ * @param chip      Chip
+ * @param cfg       Provisioning, must stay valid while the chip is used
+ * @param seed      Seed of the chip's random number generator
+ * @param seed_len  Length of the seed, at most 32 bytes
+ */
+void lt_emu_chip_init(lt_emu_chip_t *chip, const lt_emu_cfg_t *cfg, const uint8_t *seed, const uint16_t seed_len);
+
+/**
+ * @brief Returns CHIP_STATUS sent as the first MISO byte of an SPI transaction.
+ * @details Counts the reads done while the chip is rebooting.
+ *
+ * @param chip  Chip
+ * @return      CHIP_STATUS byte
+ */
+uint8_t lt_emu_chip_status(lt_emu_chip_t *chip);
+
+/**
+ * @brief Returns the response frame sent after TR01_L1_GET_RESPONSE_REQ_ID.
+ *
+ * @param chip  Chip
+ * @return      Frame starting with the STATUS byte, NULL if there is nothing to send (MISO reads 0xFF)
+ */
+const uint8_t *lt_emu_chip_response(const lt_emu_chip_t *chip);
+
+/**
+ * @brief Ends an SPI transaction: processes an L2 request or, if the response was read, prepares the next one.
+ *
+ * @param chip  Chip
+ * @param mosi  All bytes sent by the host in the transaction
+ * @param len   Number of the bytes
+ */
+void lt_emu_chip_end(lt_emu_chip_t *chip, const uint8_t *mosi, const uint16_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LT_EMU_CHIP_H
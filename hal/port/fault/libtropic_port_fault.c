@@ -0,0 +1,263 @@
+/**
+ * @file libtropic_port_fault.c
+ * @author Tropic Square s.r.o.
+ * @brief Port injecting bus faults into another port, to test and benchmark recovery of the upper layers.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include "libtropic_port_fault.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libtropic_common.h"
+#include "libtropic_port.h"
+#include "lt_l1.h"
+
+/** @brief Bit of a fault in lt_dev_fault_t.pending. */
+#define LT_PORT_FAULT_BIT(type) (1u << (type))
+/** @brief First MISO byte after CHIP_STATUS, L2 STATUS and RSP_LEN. */
+#define LT_PORT_FAULT_DATA_POS 3
+
+/** @brief Returns the next number of the xorshift32 generator. */
+static uint32_t lt_port_fault_rand(lt_dev_fault_t *dev)
+{
+    uint32_t x = dev->rng ? dev->rng : (dev->seed ? dev->seed : 1);
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    dev->rng = x;
+
+    return x;
+}
+
+/** @brief Decides whether a fault occurs according to its rate. */
+static bool lt_port_fault_roll(lt_dev_fault_t *dev, const lt_port_fault_type_t type)
+{
+    return dev->rate[type] && ((lt_port_fault_rand(dev) % LT_PORT_FAULT_RATE_SCALE) < dev->rate[type]);
+}
+
+/** @brief Arms a fault for the current transaction, arg as in lt_port_fault_event_t (0 = random position). */
+static void lt_port_fault_arm(lt_dev_fault_t *dev, const lt_port_fault_type_t type, const uint16_t arg)
+{
+    switch (type) {
+        case LT_PORT_FAULT_BIT_FLIP:
+            // Flips drawn from the rate are decided byte by byte, a scripted one hits the given byte
+            dev->flip_pos = arg;
+            break;
+        case LT_PORT_FAULT_TRUNCATE:
+            dev->truncate_pos = arg;
+            break;
+        case LT_PORT_FAULT_BUSY:
+            dev->busy_left = arg ? arg : 1;
+            dev->stats.injected[type]++;
+            return;
+        case LT_PORT_FAULT_NO_RESPONSE:
+        case LT_PORT_FAULT_ALARM:
+        case LT_PORT_FAULT_TRANSPORT:
+            dev->stats.injected[type]++;
+            break;
+        default:
+            return;
+    }
+    dev->pending |= LT_PORT_FAULT_BIT(type);
+}
+
+/** @brief Decides faults of a transaction when its first byte is about to be sent. */
+static void lt_port_fault_start(lt_dev_fault_t *dev, const uint8_t first_mosi)
+{
+    const uint32_t transaction = dev->stats.transactions - 1;
+
+    dev->get_response = (first_mosi == TR01_L1_GET_RESPONSE_REQ_ID);
+
+    while (dev->schedule && (dev->schedule_pos < dev->schedule_len)
+           && (dev->schedule[dev->schedule_pos].transaction <= transaction)) {
+        const lt_port_fault_event_t *event = &dev->schedule[dev->schedule_pos++];
+        if ((event->transaction == transaction)
+            && (dev->get_response || (event->type == LT_PORT_FAULT_TRANSPORT))) {
+            lt_port_fault_arm(dev, event->type, event->arg);
+        }
+    }
+
+    if (lt_port_fault_roll(dev, LT_PORT_FAULT_TRANSPORT)) {
+        lt_port_fault_arm(dev, LT_PORT_FAULT_TRANSPORT, 0);
+    }
+    if (!dev->get_response) {
+        return;
+    }
+    if (!dev->busy_left && lt_port_fault_roll(dev, LT_PORT_FAULT_BUSY)) {
+        lt_port_fault_arm(dev, LT_PORT_FAULT_BUSY, dev->busy_streak_len);
+    }
+    if (dev->busy_left) {
+        dev->busy_left--;
+        dev->pending |= LT_PORT_FAULT_BIT(LT_PORT_FAULT_BUSY);
+    }
+    for (int type = LT_PORT_FAULT_TRUNCATE; type <= LT_PORT_FAULT_ALARM; type++) {
+        if ((type != LT_PORT_FAULT_BUSY) && lt_port_fault_roll(dev, (lt_port_fault_type_t)type)) {
+            lt_port_fault_arm(dev, (lt_port_fault_type_t)type, 0);
+        }
+    }
+}
+
+/** @brief Injects the faults of the current transaction into MISO bytes received by the inner port. */
+static void lt_port_fault_miso(lt_dev_fault_t *dev, uint8_t *miso, const uint16_t len)
+{
+    // A truncation without a position starts somewhere in the data part of the frame
+    if ((dev->pending & LT_PORT_FAULT_BIT(LT_PORT_FAULT_TRUNCATE)) && !dev->truncate_pos
+        && (dev->pos + len > LT_PORT_FAULT_DATA_POS)) {
+        uint16_t first = (dev->pos > LT_PORT_FAULT_DATA_POS) ? dev->pos : LT_PORT_FAULT_DATA_POS;
+        dev->truncate_pos = first + (uint16_t)(lt_port_fault_rand(dev) % (dev->pos + len - first));
+    }
+
+    for (uint16_t i = 0; i < len; i++) {
+        const uint16_t pos = dev->pos + i;
+
+        if (pos == 0) {
+            if (dev->pending & LT_PORT_FAULT_BIT(LT_PORT_FAULT_BUSY)) {
+                miso[i] &= (uint8_t)~TR01_L1_CHIP_MODE_READY_bit;
+            }
+            if (dev->pending & LT_PORT_FAULT_BIT(LT_PORT_FAULT_ALARM)) {
+                miso[i] |= TR01_L1_CHIP_MODE_ALARM_bit;
+            }
+        }
+        else if (dev->pending & LT_PORT_FAULT_BIT(LT_PORT_FAULT_NO_RESPONSE)) {
+            miso[i] = 0xff;
+        }
+        else if ((dev->pending & LT_PORT_FAULT_BIT(LT_PORT_FAULT_TRUNCATE)) && dev->truncate_pos
+                 && (pos >= dev->truncate_pos)) {
+            if (pos == dev->truncate_pos) {
+                dev->stats.injected[LT_PORT_FAULT_TRUNCATE]++;
+            }
+            miso[i] = 0xff;
+        }
+
+        if (((dev->pending & LT_PORT_FAULT_BIT(LT_PORT_FAULT_BIT_FLIP)) && (pos == dev->flip_pos))
+            || lt_port_fault_roll(dev, LT_PORT_FAULT_BIT_FLIP)) {
+            miso[i] ^= (uint8_t)(1u << (lt_port_fault_rand(dev) % 8));
+            dev->stats.injected[LT_PORT_FAULT_BIT_FLIP]++;
+        }
+    }
+}
+
+lt_ret_t lt_port_init(lt_l2_state_t *s2)
+{
+    lt_dev_fault_t *dev = (lt_dev_fault_t *)(s2->device);
+
+    dev->busy_left = 0;
+    dev->pending = 0;
+    dev->pos = 0;
+
+    s2->device = dev->inner;
+    lt_ret_t ret = lt_port_fault_inner_init(s2);
+    s2->device = dev;
+
+    return ret;
+}
+
+lt_ret_t lt_port_deinit(lt_l2_state_t *s2)
+{
+    lt_dev_fault_t *dev = (lt_dev_fault_t *)(s2->device);
+
+    s2->device = dev->inner;
+    lt_ret_t ret = lt_port_fault_inner_deinit(s2);
+    s2->device = dev;
+
+    return ret;
+}
+
+lt_ret_t lt_port_spi_csn_low(lt_l2_state_t *s2)
+{
+    lt_dev_fault_t *dev = (lt_dev_fault_t *)(s2->device);
+
+    dev->stats.transactions++;
+    dev->pending = 0;
+    dev->flip_pos = 0;
+    dev->truncate_pos = 0;
+    dev->get_response = false;
+    dev->pos = 0;
+
+    s2->device = dev->inner;
+    lt_ret_t ret = lt_port_fault_inner_spi_csn_low(s2);
+    s2->device = dev;
+
+    return ret;
+}
+
+lt_ret_t lt_port_spi_csn_high(lt_l2_state_t *s2)
+{
+    lt_dev_fault_t *dev = (lt_dev_fault_t *)(s2->device);
+
+    dev->pending = 0;
+
+    s2->device = dev->inner;
+    lt_ret_t ret = lt_port_fault_inner_spi_csn_high(s2);
+    s2->device = dev;
+
+    return ret;
+}
+
+lt_ret_t lt_port_spi_transfer(lt_l2_state_t *s2, uint8_t offset, uint16_t tx_data_length, uint32_t timeout_ms)
+{
+    lt_dev_fault_t *dev = (lt_dev_fault_t *)(s2->device);
+
+    if ((dev->pos == 0) && tx_data_length) {
+        lt_port_fault_start(dev, s2->buff[offset]);
+    }
+    if (dev->pending & LT_PORT_FAULT_BIT(LT_PORT_FAULT_TRANSPORT)) {
+        return LT_L1_SPI_ERROR;
+    }
+
+    s2->device = dev->inner;
+    lt_ret_t ret = lt_port_fault_inner_spi_transfer(s2, offset, tx_data_length, timeout_ms);
+    s2->device = dev;
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    if (dev->get_response) {
+        lt_port_fault_miso(dev, &s2->buff[offset], tx_data_length);
+    }
+    dev->pos += tx_data_length;
+
+    return LT_OK;
+}
+
+lt_ret_t lt_port_delay(lt_l2_state_t *s2, uint32_t ms)
+{
+    lt_dev_fault_t *dev = (lt_dev_fault_t *)(s2->device);
+
+    dev->stats.delay_ms += ms;
+
+    s2->device = dev->inner;
+    lt_ret_t ret = lt_port_fault_inner_delay(s2, ms);
+    s2->device = dev;
+
+    return ret;
+}
+
+#if LT_USE_INT_PIN
+lt_ret_t lt_port_delay_on_int(lt_l2_state_t *s2, uint32_t ms)
+{
+    lt_dev_fault_t *dev = (lt_dev_fault_t *)(s2->device);
+
+    s2->device = dev->inner;
+    lt_ret_t ret = lt_port_fault_inner_delay_on_int(s2, ms);
+    s2->device = dev;
+
+    return ret;
+}
+#endif
+
+lt_ret_t lt_port_random_bytes(lt_l2_state_t *s2, void *buff, size_t count)
+{
+    lt_dev_fault_t *dev = (lt_dev_fault_t *)(s2->device);
+
+    s2->device = dev->inner;
+    lt_ret_t ret = lt_port_fault_inner_random_bytes(s2, buff, count);
+    s2->device = dev;
+
+    return ret;
+}
@@ -0,0 +1,136 @@
+#ifndef LIBTROPIC_PORT_FAULT_H
+#define LIBTROPIC_PORT_FAULT_H
+
+/**
+ * @file libtropic_port_fault.h
+ * @author Tropic Square s.r.o.
+ * @brief Port injecting bus faults into another port, to test and benchmark recovery of the upper layers.
+ * @details The wrapped (inner) port is compiled with its lt_port_* functions renamed to lt_port_fault_inner_* by
+ * compile definitions (lt_port_init=lt_port_fault_inner_init, ...) and linked together with this port, so any port
+ * can be wrapped without changing it. tropic01_model/CMakeLists.txt keeps the definitions in
+ * LT_PORT_FAULT_INNER_RENAMES.
+ *
+ * Faults are injected into GET_RESPONSE transactions (the first MOSI byte is TR01_L1_GET_RESPONSE_REQ_ID) by changing
+ * MISO after the inner port received it, so the emulated or real chip sees the same bus traffic as without faults.
+ * Transport errors are injected into any transaction.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libtropic_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Rates of faults are given in occurrences per this many trials. */
+#define LT_PORT_FAULT_RATE_SCALE 1000000u
+
+/** @brief Faults the port can inject. */
+typedef enum lt_port_fault_type_t {
+    /** @brief One MISO bit is inverted. The rate is per MISO byte. */
+    LT_PORT_FAULT_BIT_FLIP = 0,
+    /** @brief MISO reads 0xFF from some byte of the frame on, as if the chip stopped sending. */
+    LT_PORT_FAULT_TRUNCATE,
+    /** @brief MISO reads 0xFF after CHIP_STATUS, which the host takes as "no response yet". */
+    LT_PORT_FAULT_NO_RESPONSE,
+    /** @brief CHIP_STATUS has the READY bit cleared in a streak of transactions. */
+    LT_PORT_FAULT_BUSY,
+    /** @brief CHIP_STATUS has the ALARM bit set. */
+    LT_PORT_FAULT_ALARM,
+    /** @brief The SPI transfer fails with LT_L1_SPI_ERROR without reaching the inner port. */
+    LT_PORT_FAULT_TRANSPORT,
+    /** @brief Number of fault types. */
+    LT_PORT_FAULT_TYPE_CNT
+} lt_port_fault_type_t;
+
+/** @brief Fault injected at a given transaction, independently of the rates. */
+typedef struct lt_port_fault_event_t {
+    /** @brief Index of the transaction (counted by lt_port_fault_stats_t.transactions) to inject the fault into. */
+    uint32_t transaction;
+    /** @brief Fault to inject. */
+    lt_port_fault_type_t type;
+    /**
+     * @brief Parameter of the fault: MISO byte of the transaction for LT_PORT_FAULT_BIT_FLIP (0 is CHIP_STATUS), first
+     * byte read as 0xFF for LT_PORT_FAULT_TRUNCATE, length of the streak for LT_PORT_FAULT_BUSY. Unused otherwise.
+     */
+    uint16_t arg;
+} lt_port_fault_event_t;
+
+/** @brief Counters of the injected faults. */
+typedef struct lt_port_fault_stats_t {
+    /** @brief Number of transactions (chip select low - high) seen so far. */
+    uint32_t transactions;
+    /** @brief Number of injected faults of each type, a busy streak counts once. */
+    uint32_t injected[LT_PORT_FAULT_TYPE_CNT];
+    /** @brief Sum of delays requested through lt_port_delay(), in milliseconds. */
+    uint64_t delay_ms;
+} lt_port_fault_stats_t;
+
+/**
+ * @brief Device structure for the fault injecting port.
+ *
+ * @note Public members are meant to be configured by the developer before passing the handle to libtropic and can
+ *       be changed between calls of libtropic functions, e.g. to sweep the rates.
+ */
+typedef struct lt_dev_fault_t {
+    /** @public @brief Device structure of the inner port. */
+    void *inner;
+    /** @public @brief Rates of the faults, in LT_PORT_FAULT_RATE_SCALE units, 0 disables the fault. */
+    uint32_t rate[LT_PORT_FAULT_TYPE_CNT];
+    /** @public @brief Length of busy streaks injected by the rate. */
+    uint16_t busy_streak_len;
+    /** @public @brief Scripted faults, sorted by lt_port_fault_event_t.transaction, or NULL. */
+    const lt_port_fault_event_t *schedule;
+    /** @public @brief Number of the scripted faults. */
+    size_t schedule_len;
+    /** @public @brief Index of the next scripted fault, to be zeroed together with setting a new schedule. */
+    size_t schedule_pos;
+    /** @public @brief Seed of the generator deciding which faults are injected, 0 is replaced by 1. */
+    uint32_t seed;
+    /** @public @brief Counters, may be zeroed by the developer at any time. */
+    lt_port_fault_stats_t stats;
+
+    /** @private @brief State of the xorshift32 generator, seeded on first use. */
+    uint32_t rng;
+    /** @private @brief Transactions left in the current busy streak. */
+    uint16_t busy_left;
+    /** @private @brief Bitmap of faults (1 << lt_port_fault_type_t) to inject into the current transaction. */
+    uint8_t pending;
+    /** @private @brief MISO byte to flip in the current transaction. */
+    uint16_t flip_pos;
+    /** @private @brief First MISO byte to read as 0xFF in the current transaction. */
+    uint16_t truncate_pos;
+    /** @private @brief Transaction is a GET_RESPONSE, so MISO faults may be injected into it. */
+    bool get_response;
+    /** @private @brief Number of bytes transferred in the current transaction. */
+    uint16_t pos;
+} lt_dev_fault_t;
+
+/**
+ * @defgroup group_port_fault_inner Inner port of the fault injecting port
+ * @brief lt_port_* functions of the wrapped port, renamed when it is compiled.
+ * @{
+ */
+lt_ret_t lt_port_fault_inner_init(lt_l2_state_t *s2);
+lt_ret_t lt_port_fault_inner_deinit(lt_l2_state_t *s2);
+lt_ret_t lt_port_fault_inner_spi_csn_low(lt_l2_state_t *s2);
+lt_ret_t lt_port_fault_inner_spi_csn_high(lt_l2_state_t *s2);
+lt_ret_t lt_port_fault_inner_spi_transfer(lt_l2_state_t *s2, uint8_t offset, uint16_t tx_data_length,
+                                          uint32_t timeout_ms);
+lt_ret_t lt_port_fault_inner_delay(lt_l2_state_t *s2, uint32_t ms);
+#if LT_USE_INT_PIN
+lt_ret_t lt_port_fault_inner_delay_on_int(lt_l2_state_t *s2, uint32_t ms);
+#endif
+lt_ret_t lt_port_fault_inner_random_bytes(lt_l2_state_t *s2, void *buff, size_t count);
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LIBTROPIC_PORT_FAULT_H
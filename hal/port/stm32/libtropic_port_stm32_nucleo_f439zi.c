@@ -165,7 +165,9 @@ lt_ret_t lt_port_spi_transfer(lt_l2_state_t *s2, uint8_t offset, uint16_t tx_dat
 
 lt_ret_t lt_port_delay(lt_l2_state_t *s2, uint32_t ms)
 {
-    LT_UNUSED(s2);
+    if (s2->clock.is_virtual) {
+        return LT_OK;
+    }
 
     HAL_Delay(ms);
 
@@ -179,6 +181,10 @@ lt_ret_t lt_port_delay_on_int(lt_l2_state_t *s2, uint32_t ms)
     uint32_t time_initial = HAL_GetTick();
     uint32_t time_actual;
 
+    if (s2->clock.is_virtual) {
+        return LT_OK;
+    }
+
     while ((HAL_GPIO_ReadPin(device->int_gpio_bank, device->int_gpio_pin) == 0)) {
         time_actual = HAL_GetTick();
         if ((time_actual - time_initial) > ms) {
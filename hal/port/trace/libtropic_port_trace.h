@@ -0,0 +1,128 @@
+#ifndef LIBTROPIC_PORT_TRACE_H
+#define LIBTROPIC_PORT_TRACE_H
+
+/**
+ * @file libtropic_port_trace.h
+ * @author Tropic Square s.r.o.
+ * @brief Ports recording calls of another port into a binary trace and replaying them without a chip.
+ * @details libtropic_port_trace_record.c wraps another port, compiled with its lt_port_* functions renamed to
+ * lt_port_trace_inner_* (tropic01_model/CMakeLists.txt keeps the compile definitions in LT_PORT_TRACE_INNER_RENAMES),
+ * and writes every call with its arguments, the data sent and received, its result and a timestamp.
+ * libtropic_port_trace_replay.c is a port of its own: it serves MISO bytes and random bytes from the trace and checks
+ * that libtropic makes exactly the recorded calls with the same MOSI bytes, so the same sequence of libtropic calls
+ * gives the same results as when recorded. MOSI bytes clocked out while reading a response are whatever the buffer
+ * held before and the chip ignores them, so only the first byte of those transactions is checked. Delays are checked
+ * but not slept.
+ *
+ * Trace format, integers are little endian, "varint" is unsigned LEB128:
+ * - header: LT_PORT_TRACE_MAGIC (8 bytes), version (1 byte, LT_PORT_TRACE_VERSION),
+ * - records: type (1 byte, lt_port_trace_rec_t), microseconds since the previous record (varint), result of the call
+ *   (1 byte, lt_ret_t), then by type:
+ *   - LT_PORT_TRACE_REC_TRANSFER: offset (1 byte), length (varint), timeout_ms (varint), MOSI and MISO (length bytes
+ *     each),
+ *   - LT_PORT_TRACE_REC_DELAY, LT_PORT_TRACE_REC_DELAY_ON_INT: ms (varint),
+ *   - LT_PORT_TRACE_REC_RANDOM: count (varint), random bytes (count bytes),
+ *   - nothing for the other types.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "libtropic_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Magic bytes starting a trace. */
+#define LT_PORT_TRACE_MAGIC "LTTRACE"
+/** @brief Length of the magic including its terminating zero. */
+#define LT_PORT_TRACE_MAGIC_LEN 8
+/** @brief Version of the trace format. */
+#define LT_PORT_TRACE_VERSION 1
+
+/** @brief Types of trace records, one per port function. */
+typedef enum lt_port_trace_rec_t {
+    LT_PORT_TRACE_REC_INIT = 1,
+    LT_PORT_TRACE_REC_DEINIT = 2,
+    LT_PORT_TRACE_REC_CSN_LOW = 3,
+    LT_PORT_TRACE_REC_CSN_HIGH = 4,
+    LT_PORT_TRACE_REC_TRANSFER = 5,
+    LT_PORT_TRACE_REC_DELAY = 6,
+    LT_PORT_TRACE_REC_DELAY_ON_INT = 7,
+    LT_PORT_TRACE_REC_RANDOM = 8
+} lt_port_trace_rec_t;
+
+/**
+ * @brief Device structure for the recording port.
+ *
+ * @note Public members are meant to be configured by the developer before passing the handle to libtropic. The
+ *       file is opened for writing and closed by the developer, the trace spans all lt_init() - lt_deinit() cycles.
+ */
+typedef struct lt_dev_trace_record_t {
+    /** @public @brief Device structure of the inner port. */
+    void *inner;
+    /** @public @brief File the trace is written to. */
+    FILE *file;
+
+    /** @private @brief The header was written. */
+    bool started;
+    /** @private @brief A write to the file failed, the trace is incomplete. */
+    bool write_err;
+    /** @private @brief Time of the previous record, in microseconds. */
+    uint64_t last_us;
+} lt_dev_trace_record_t;
+
+/**
+ * @brief Device structure for the replaying port.
+ *
+ * @note Public members are meant to be configured by the developer before passing the handle to libtropic. The
+ *       file is opened for reading and closed by the developer.
+ */
+typedef struct lt_dev_trace_replay_t {
+    /** @public @brief File the trace is read from. */
+    FILE *file;
+    /** @public @brief Number of records replayed so far. */
+    uint32_t records;
+    /** @public @brief Recorded time between the first and the last replayed record, in microseconds. */
+    uint64_t trace_us;
+    /** @public @brief Sum of the replayed delays (also delays on the INT pin), in ms. */
+    uint64_t delay_ms;
+    /** @public @brief Set when a call did not match the trace or the trace ended, lt_port_* then return LT_FAIL. */
+    bool mismatch;
+
+    /** @private @brief The header was read. */
+    bool started;
+    /** @private @brief The current transaction reads a response, its MOSI bytes after the first one are not checked. */
+    bool get_response;
+    /** @private @brief Number of bytes transferred in the current transaction. */
+    uint16_t pos;
+} lt_dev_trace_replay_t;
+
+/**
+ * @defgroup group_port_trace_inner Inner port of the recording port
+ * @brief lt_port_* functions of the wrapped port, renamed when it is compiled.
+ * @{
+ */
+lt_ret_t lt_port_trace_inner_init(lt_l2_state_t *s2);
+lt_ret_t lt_port_trace_inner_deinit(lt_l2_state_t *s2);
+lt_ret_t lt_port_trace_inner_spi_csn_low(lt_l2_state_t *s2);
+lt_ret_t lt_port_trace_inner_spi_csn_high(lt_l2_state_t *s2);
+lt_ret_t lt_port_trace_inner_spi_transfer(lt_l2_state_t *s2, uint8_t offset, uint16_t tx_data_length,
+                                          uint32_t timeout_ms);
+lt_ret_t lt_port_trace_inner_delay(lt_l2_state_t *s2, uint32_t ms);
+#if LT_USE_INT_PIN
+lt_ret_t lt_port_trace_inner_delay_on_int(lt_l2_state_t *s2, uint32_t ms);
+#endif
+lt_ret_t lt_port_trace_inner_random_bytes(lt_l2_state_t *s2, void *buff, size_t count);
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LIBTROPIC_PORT_TRACE_H
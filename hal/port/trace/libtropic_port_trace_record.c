@@ -0,0 +1,209 @@
+/**
+ * @file libtropic_port_trace_record.c
+ * @author Tropic Square s.r.o.
+ * @brief Port recording calls of another port into a binary trace, see libtropic_port_trace.h for the format.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "libtropic_common.h"
+#include "libtropic_logging.h"
+#include "libtropic_port.h"
+#include "libtropic_port_trace.h"
+
+static uint64_t lt_port_trace_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static void lt_port_trace_write(lt_dev_trace_record_t *dev, const void *data, const size_t len)
+{
+    if (len && !dev->write_err && (fwrite(data, 1, len, dev->file) != len)) {
+        LT_LOG_ERROR("Failed to write the trace, it is incomplete.");
+        dev->write_err = true;
+    }
+}
+
+static void lt_port_trace_write_varint(lt_dev_trace_record_t *dev, uint64_t value)
+{
+    uint8_t buff[10];
+    size_t len = 0;
+
+    do {
+        buff[len] = (uint8_t)(value & 0x7f);
+        value >>= 7;
+        if (value) {
+            buff[len] |= 0x80;
+        }
+        len++;
+    } while (value);
+
+    lt_port_trace_write(dev, buff, len);
+}
+
+/** @brief Writes the common part of a record: type, time since the previous record and result of the call. */
+static void lt_port_trace_write_rec(lt_dev_trace_record_t *dev, const lt_port_trace_rec_t type, const uint64_t start_us,
+                                    const lt_ret_t ret)
+{
+    const uint8_t type_byte = (uint8_t)type, ret_byte = (uint8_t)ret;
+
+    if (!dev->started) {
+        static const uint8_t version = LT_PORT_TRACE_VERSION;
+        lt_port_trace_write(dev, LT_PORT_TRACE_MAGIC, LT_PORT_TRACE_MAGIC_LEN);
+        lt_port_trace_write(dev, &version, sizeof(version));
+        dev->last_us = start_us;
+        dev->started = true;
+    }
+
+    lt_port_trace_write(dev, &type_byte, sizeof(type_byte));
+    lt_port_trace_write_varint(dev, start_us - dev->last_us);
+    lt_port_trace_write(dev, &ret_byte, sizeof(ret_byte));
+    dev->last_us = start_us;
+}
+
+lt_ret_t lt_port_init(lt_l2_state_t *s2)
+{
+    lt_dev_trace_record_t *dev = (lt_dev_trace_record_t *)(s2->device);
+
+    if (!dev->file) {
+        LT_LOG_ERROR("No trace file.");
+        return LT_FAIL;
+    }
+
+    const uint64_t start_us = lt_port_trace_now_us();
+    s2->device = dev->inner;
+    lt_ret_t ret = lt_port_trace_inner_init(s2);
+    s2->device = dev;
+
+    lt_port_trace_write_rec(dev, LT_PORT_TRACE_REC_INIT, start_us, ret);
+
+    return ret;
+}
+
+lt_ret_t lt_port_deinit(lt_l2_state_t *s2)
+{
+    lt_dev_trace_record_t *dev = (lt_dev_trace_record_t *)(s2->device);
+
+    const uint64_t start_us = lt_port_trace_now_us();
+    s2->device = dev->inner;
+    lt_ret_t ret = lt_port_trace_inner_deinit(s2);
+    s2->device = dev;
+
+    lt_port_trace_write_rec(dev, LT_PORT_TRACE_REC_DEINIT, start_us, ret);
+    fflush(dev->file);
+
+    return ret;
+}
+
+lt_ret_t lt_port_spi_csn_low(lt_l2_state_t *s2)
+{
+    lt_dev_trace_record_t *dev = (lt_dev_trace_record_t *)(s2->device);
+
+    const uint64_t start_us = lt_port_trace_now_us();
+    s2->device = dev->inner;
+    lt_ret_t ret = lt_port_trace_inner_spi_csn_low(s2);
+    s2->device = dev;
+
+    lt_port_trace_write_rec(dev, LT_PORT_TRACE_REC_CSN_LOW, start_us, ret);
+
+    return ret;
+}
+
+lt_ret_t lt_port_spi_csn_high(lt_l2_state_t *s2)
+{
+    lt_dev_trace_record_t *dev = (lt_dev_trace_record_t *)(s2->device);
+
+    const uint64_t start_us = lt_port_trace_now_us();
+    s2->device = dev->inner;
+    lt_ret_t ret = lt_port_trace_inner_spi_csn_high(s2);
+    s2->device = dev;
+
+    lt_port_trace_write_rec(dev, LT_PORT_TRACE_REC_CSN_HIGH, start_us, ret);
+
+    return ret;
+}
+
+lt_ret_t lt_port_spi_transfer(lt_l2_state_t *s2, uint8_t offset, uint16_t tx_data_length, uint32_t timeout_ms)
+{
+    lt_dev_trace_record_t *dev = (lt_dev_trace_record_t *)(s2->device);
+
+    if (offset + tx_data_length > TR01_L1_LEN_MAX) {
+        return LT_L1_DATA_LEN_ERROR;
+    }
+
+    // The transfer is done in place, MOSI is kept for the record
+    uint8_t mosi[TR01_L1_LEN_MAX];
+    for (uint16_t i = 0; i < tx_data_length; i++) {
+        mosi[i] = s2->buff[offset + i];
+    }
+
+    const uint64_t start_us = lt_port_trace_now_us();
+    s2->device = dev->inner;
+    lt_ret_t ret = lt_port_trace_inner_spi_transfer(s2, offset, tx_data_length, timeout_ms);
+    s2->device = dev;
+
+    lt_port_trace_write_rec(dev, LT_PORT_TRACE_REC_TRANSFER, start_us, ret);
+    lt_port_trace_write(dev, &offset, sizeof(offset));
+    lt_port_trace_write_varint(dev, tx_data_length);
+    lt_port_trace_write_varint(dev, timeout_ms);
+    lt_port_trace_write(dev, mosi, tx_data_length);
+    lt_port_trace_write(dev, &s2->buff[offset], tx_data_length);
+
+    return ret;
+}
+
+lt_ret_t lt_port_delay(lt_l2_state_t *s2, uint32_t ms)
+{
+    lt_dev_trace_record_t *dev = (lt_dev_trace_record_t *)(s2->device);
+
+    const uint64_t start_us = lt_port_trace_now_us();
+    s2->device = dev->inner;
+    lt_ret_t ret = lt_port_trace_inner_delay(s2, ms);
+    s2->device = dev;
+
+    lt_port_trace_write_rec(dev, LT_PORT_TRACE_REC_DELAY, start_us, ret);
+    lt_port_trace_write_varint(dev, ms);
+
+    return ret;
+}
+
+#if LT_USE_INT_PIN
+lt_ret_t lt_port_delay_on_int(lt_l2_state_t *s2, uint32_t ms)
+{
+    lt_dev_trace_record_t *dev = (lt_dev_trace_record_t *)(s2->device);
+
+    const uint64_t start_us = lt_port_trace_now_us();
+    s2->device = dev->inner;
+    lt_ret_t ret = lt_port_trace_inner_delay_on_int(s2, ms);
+    s2->device = dev;
+
+    lt_port_trace_write_rec(dev, LT_PORT_TRACE_REC_DELAY_ON_INT, start_us, ret);
+    lt_port_trace_write_varint(dev, ms);
+
+    return ret;
+}
+#endif
+
+lt_ret_t lt_port_random_bytes(lt_l2_state_t *s2, void *buff, size_t count)
+{
+    lt_dev_trace_record_t *dev = (lt_dev_trace_record_t *)(s2->device);
+
+    const uint64_t start_us = lt_port_trace_now_us();
+    s2->device = dev->inner;
+    lt_ret_t ret = lt_port_trace_inner_random_bytes(s2, buff, count);
+    s2->device = dev;
+
+    lt_port_trace_write_rec(dev, LT_PORT_TRACE_REC_RANDOM, start_us, ret);
+    lt_port_trace_write_varint(dev, count);
+    lt_port_trace_write(dev, buff, count);
+
+    return ret;
+}
@@ -0,0 +1,244 @@
+/**
+ * @file libtropic_port_trace_replay.c
+ * @author Tropic Square s.r.o.
+ * @brief Port replaying a trace recorded by libtropic_port_trace_record.c, see libtropic_port_trace.h for the format.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libtropic_common.h"
+#include "libtropic_logging.h"
+#include "libtropic_port.h"
+#include "libtropic_port_trace.h"
+#include "lt_l1.h"
+
+static const char *const lt_port_trace_rec_names[] = {
+    "?", "init", "deinit", "spi_csn_low", "spi_csn_high", "spi_transfer", "delay", "delay_on_int", "random_bytes"};
+
+/** @brief Marks the replay as failed, all following calls return LT_FAIL. */
+static lt_ret_t lt_port_trace_fail(lt_dev_trace_replay_t *dev, const char *what)
+{
+    LT_LOG_ERROR("Trace record %" PRIu32 ": %s.", dev->records, what);
+    dev->mismatch = true;
+
+    return LT_FAIL;
+}
+
+static bool lt_port_trace_read(lt_dev_trace_replay_t *dev, void *data, const size_t len)
+{
+    return !len || (fread(data, 1, len, dev->file) == len);
+}
+
+static bool lt_port_trace_read_varint(lt_dev_trace_replay_t *dev, uint64_t *value)
+{
+    uint8_t byte;
+
+    *value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (!lt_port_trace_read(dev, &byte, sizeof(byte))) {
+            return false;
+        }
+        *value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/** @brief Reads a varint that must be equal to the value passed to the port function. */
+static bool lt_port_trace_expect_varint(lt_dev_trace_replay_t *dev, const uint64_t expected, const char *what)
+{
+    uint64_t value;
+
+    if (!lt_port_trace_read_varint(dev, &value)) {
+        lt_port_trace_fail(dev, "trace truncated");
+        return false;
+    }
+    if (value != expected) {
+        LT_LOG_ERROR("Trace record %" PRIu32 ": %s %" PRIu64 " recorded, %" PRIu64 " requested.", dev->records, what,
+                     value, expected);
+        lt_port_trace_fail(dev, "call differs");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Reads the common part of the next record, which must be of the given type.
+ *
+ * @param dev   Device structure
+ * @param type  Type of the called port function
+ * @param ret   Result of the recorded call
+ * @return      true if the record matches, false if the replay failed
+ */
+static bool lt_port_trace_next(lt_dev_trace_replay_t *dev, const lt_port_trace_rec_t type, lt_ret_t *ret)
+{
+    uint8_t type_byte, ret_byte;
+    uint64_t dt_us;
+
+    if (dev->mismatch) {
+        return false;
+    }
+    if (!dev->file) {
+        lt_port_trace_fail(dev, "no trace file");
+        return false;
+    }
+    if (!dev->started) {
+        uint8_t magic[LT_PORT_TRACE_MAGIC_LEN], version;
+        if (!lt_port_trace_read(dev, magic, sizeof(magic)) || memcmp(magic, LT_PORT_TRACE_MAGIC, sizeof(magic))
+            || !lt_port_trace_read(dev, &version, sizeof(version)) || (version != LT_PORT_TRACE_VERSION)) {
+            lt_port_trace_fail(dev, "not a trace of a supported version");
+            return false;
+        }
+        dev->started = true;
+    }
+
+    if (!lt_port_trace_read(dev, &type_byte, sizeof(type_byte)) || !lt_port_trace_read_varint(dev, &dt_us)
+        || !lt_port_trace_read(dev, &ret_byte, sizeof(ret_byte))) {
+        lt_port_trace_fail(dev, "trace ended");
+        return false;
+    }
+    if (type_byte != (uint8_t)type) {
+        LT_LOG_ERROR("Trace record %" PRIu32 ": %s recorded, %s called.", dev->records,
+                     lt_port_trace_rec_names[(type_byte <= LT_PORT_TRACE_REC_RANDOM) ? type_byte : 0],
+                     lt_port_trace_rec_names[type]);
+        lt_port_trace_fail(dev, "call differs");
+        return false;
+    }
+
+    dev->records++;
+    dev->trace_us += dt_us;
+    *ret = (lt_ret_t)ret_byte;
+
+    return true;
+}
+
+lt_ret_t lt_port_init(lt_l2_state_t *s2)
+{
+    lt_dev_trace_replay_t *dev = (lt_dev_trace_replay_t *)(s2->device);
+    lt_ret_t ret;
+
+    return lt_port_trace_next(dev, LT_PORT_TRACE_REC_INIT, &ret) ? ret : LT_FAIL;
+}
+
+lt_ret_t lt_port_deinit(lt_l2_state_t *s2)
+{
+    lt_dev_trace_replay_t *dev = (lt_dev_trace_replay_t *)(s2->device);
+    lt_ret_t ret;
+
+    return lt_port_trace_next(dev, LT_PORT_TRACE_REC_DEINIT, &ret) ? ret : LT_FAIL;
+}
+
+lt_ret_t lt_port_spi_csn_low(lt_l2_state_t *s2)
+{
+    lt_dev_trace_replay_t *dev = (lt_dev_trace_replay_t *)(s2->device);
+    lt_ret_t ret;
+
+    dev->get_response = false;
+    dev->pos = 0;
+
+    return lt_port_trace_next(dev, LT_PORT_TRACE_REC_CSN_LOW, &ret) ? ret : LT_FAIL;
+}
+
+lt_ret_t lt_port_spi_csn_high(lt_l2_state_t *s2)
+{
+    lt_dev_trace_replay_t *dev = (lt_dev_trace_replay_t *)(s2->device);
+    lt_ret_t ret;
+
+    return lt_port_trace_next(dev, LT_PORT_TRACE_REC_CSN_HIGH, &ret) ? ret : LT_FAIL;
+}
+
+lt_ret_t lt_port_spi_transfer(lt_l2_state_t *s2, uint8_t offset, uint16_t tx_data_length, uint32_t timeout_ms)
+{
+    lt_dev_trace_replay_t *dev = (lt_dev_trace_replay_t *)(s2->device);
+    uint8_t mosi[TR01_L1_LEN_MAX], offset_rec;
+    lt_ret_t ret;
+
+    if (offset + tx_data_length > TR01_L1_LEN_MAX) {
+        return LT_L1_DATA_LEN_ERROR;
+    }
+    if (!lt_port_trace_next(dev, LT_PORT_TRACE_REC_TRANSFER, &ret)) {
+        return LT_FAIL;
+    }
+    if (!lt_port_trace_read(dev, &offset_rec, sizeof(offset_rec))) {
+        return lt_port_trace_fail(dev, "trace truncated");
+    }
+    if (offset_rec != offset) {
+        return lt_port_trace_fail(dev, "offset differs");
+    }
+    if (!lt_port_trace_expect_varint(dev, tx_data_length, "length")
+        || !lt_port_trace_expect_varint(dev, timeout_ms, "timeout")) {
+        return LT_FAIL;
+    }
+    if (!lt_port_trace_read(dev, mosi, tx_data_length)) {
+        return lt_port_trace_fail(dev, "trace truncated");
+    }
+    if ((dev->pos == 0) && tx_data_length) {
+        dev->get_response = (s2->buff[offset] == TR01_L1_GET_RESPONSE_REQ_ID);
+    }
+    const uint16_t checked = dev->get_response ? ((dev->pos == 0) && tx_data_length) : tx_data_length;
+    if (memcmp(mosi, &s2->buff[offset], checked)) {
+        return lt_port_trace_fail(dev, "MOSI differs");
+    }
+    dev->pos += tx_data_length;
+    if (!lt_port_trace_read(dev, &s2->buff[offset], tx_data_length)) {
+        return lt_port_trace_fail(dev, "trace truncated");
+    }
+
+    return ret;
+}
+
+lt_ret_t lt_port_delay(lt_l2_state_t *s2, uint32_t ms)
+{
+    lt_dev_trace_replay_t *dev = (lt_dev_trace_replay_t *)(s2->device);
+    lt_ret_t ret;
+
+    if (!lt_port_trace_next(dev, LT_PORT_TRACE_REC_DELAY, &ret) || !lt_port_trace_expect_varint(dev, ms, "delay")) {
+        return LT_FAIL;
+    }
+    dev->delay_ms += ms;
+
+    return ret;
+}
+
+#if LT_USE_INT_PIN
+lt_ret_t lt_port_delay_on_int(lt_l2_state_t *s2, uint32_t ms)
+{
+    lt_dev_trace_replay_t *dev = (lt_dev_trace_replay_t *)(s2->device);
+    lt_ret_t ret;
+
+    if (!lt_port_trace_next(dev, LT_PORT_TRACE_REC_DELAY_ON_INT, &ret)
+        || !lt_port_trace_expect_varint(dev, ms, "delay")) {
+        return LT_FAIL;
+    }
+    dev->delay_ms += ms;
+
+    return ret;
+}
+#endif
+
+lt_ret_t lt_port_random_bytes(lt_l2_state_t *s2, void *buff, size_t count)
+{
+    lt_dev_trace_replay_t *dev = (lt_dev_trace_replay_t *)(s2->device);
+    lt_ret_t ret;
+
+    if (!lt_port_trace_next(dev, LT_PORT_TRACE_REC_RANDOM, &ret)
+        || !lt_port_trace_expect_varint(dev, count, "random byte count")) {
+        return LT_FAIL;
+    }
+    if (!lt_port_trace_read(dev, buff, count)) {
+        return lt_port_trace_fail(dev, "trace truncated");
+    }
+
+    return ret;
+}
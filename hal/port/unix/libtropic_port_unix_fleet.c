@@ -0,0 +1,114 @@
+/**
+ * @file libtropic_port_unix_fleet.c
+ * @author Tropic Square s.r.o.
+ * @brief Parallel fleet firmware update using POSIX threads.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include "libtropic_port_unix_fleet.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libtropic_common.h"
+#include "libtropic_fleet.h"
+#include "libtropic_logging.h"
+
+/** @brief State shared by the worker threads. */
+typedef struct lt_unix_fleet_run_t {
+    const lt_fleet_t *fleet; /**< Fleet passed by the caller */
+    lt_fleet_t worker_fleet; /**< Copy of the fleet with serialized status callback */
+    lt_fleet_chip_t *chips;  /**< Chips */
+    uint16_t chip_cnt;       /**< Number of chips */
+    uint16_t next;           /**< Index of the next chip to be updated */
+    pthread_mutex_t lock;    /**< Protects `next` and calls of the status callback */
+} lt_unix_fleet_run_t;
+
+static void lt_unix_fleet_status(void *ctx, const lt_fleet_chip_t *chip)
+{
+    lt_unix_fleet_run_t *run = (lt_unix_fleet_run_t *)ctx;
+
+    pthread_mutex_lock(&run->lock);
+    run->fleet->status(run->fleet->ctx, chip);
+    pthread_mutex_unlock(&run->lock);
+}
+
+static void *lt_unix_fleet_worker(void *arg)
+{
+    lt_unix_fleet_run_t *run = (lt_unix_fleet_run_t *)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&run->lock);
+        uint16_t idx = run->next;
+        if (idx < run->chip_cnt) {
+            run->next++;
+        }
+        pthread_mutex_unlock(&run->lock);
+
+        if (idx >= run->chip_cnt) {
+            return NULL;
+        }
+        // Result is stored in the chip
+        lt_fleet_update_chip(&run->worker_fleet, &run->chips[idx]);
+    }
+}
+
+lt_ret_t lt_unix_fleet_update(const lt_fleet_t *fleet, lt_fleet_chip_t *chips, const uint16_t chip_cnt,
+                              const uint16_t max_parallel)
+{
+    if (!fleet || !chips || (chip_cnt == 0)) {
+        return LT_PARAM_ERR;
+    }
+
+    uint16_t thread_cnt = ((max_parallel == 0) || (max_parallel > chip_cnt)) ? chip_cnt : max_parallel;
+    pthread_t *threads = calloc(thread_cnt, sizeof(*threads));
+    if (!threads) {
+        return LT_FAIL;
+    }
+
+    lt_unix_fleet_run_t run;
+    memset(&run, 0, sizeof(run));
+    run.fleet = fleet;
+    run.worker_fleet = *fleet;
+    if (fleet->status) {
+        run.worker_fleet.status = lt_unix_fleet_status;
+        run.worker_fleet.ctx = &run;
+    }
+    run.chips = chips;
+    run.chip_cnt = chip_cnt;
+    pthread_mutex_init(&run.lock, NULL);
+
+    for (uint16_t i = 0; i < chip_cnt; i++) {
+        chips[i].stage = LT_FLEET_PENDING;
+        chips[i].ret = LT_OK;
+    }
+
+    uint16_t started = 0;
+    for (; started < thread_cnt; started++) {
+        if (pthread_create(&threads[started], NULL, lt_unix_fleet_worker, &run) != 0) {
+            LT_LOG_ERROR("Could not start fleet update thread %d.", (int)started);
+            break;
+        }
+    }
+    // Chips of threads which did not start are picked up by the running ones
+    if (started == 0) {
+        lt_unix_fleet_worker(&run);
+    }
+    for (uint16_t i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&run.lock);
+    free(threads);
+
+    for (uint16_t i = 0; i < chip_cnt; i++) {
+        if ((chips[i].stage != LT_FLEET_DONE) && (chips[i].stage != LT_FLEET_UP_TO_DATE)) {
+            return LT_FAIL;
+        }
+    }
+
+    return LT_OK;
+}
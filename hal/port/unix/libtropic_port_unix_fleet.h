@@ -0,0 +1,41 @@
+#ifndef LIBTROPIC_PORT_UNIX_FLEET_H
+#define LIBTROPIC_PORT_UNIX_FLEET_H
+
+/**
+ * @file libtropic_port_unix_fleet.h
+ * @author Tropic Square s.r.o.
+ * @brief Parallel fleet firmware update using POSIX threads.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdint.h>
+
+#include "libtropic_common.h"
+#include "libtropic_fleet.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Updates firmware of all chips, running lt_fleet_update_chip() for up to `max_parallel` chips at once.
+ * @details Calls of the fleet's `status` callback are serialized, so the callback does not need to be thread-safe.
+ * Result of each chip is in its `stage` and `ret`.
+ *
+ * @param fleet         Image set
+ * @param chips         Chips to be updated, each with its own handle
+ * @param chip_cnt      Number of chips
+ * @param max_parallel  Maximal number of chips updated at once, 0 updates all chips at once
+ *
+ * @retval              LT_OK All chips were updated or already up to date
+ * @retval              other Update of some chip failed or threads could not be started
+ */
+lt_ret_t lt_unix_fleet_update(const lt_fleet_t *fleet, lt_fleet_chip_t *chips, const uint16_t chip_cnt,
+                              const uint16_t max_parallel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LIBTROPIC_PORT_UNIX_FLEET_H
@@ -0,0 +1,100 @@
+/**
+ * @file libtropic_port_unix_fw_file.c
+ * @author Tropic Square s.r.o.
+ * @brief Source of firmware update images for lt_do_mutable_fw_update_stream() backed by a memory-mapped file.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include "libtropic_port_unix_fw_file.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "libtropic_common.h"
+#include "libtropic_logging.h"
+#include "libtropic_macros.h"
+
+static lt_ret_t lt_unix_fw_file_read(void *ctx, const uint32_t offset, uint8_t *buf, const uint16_t len)
+{
+    lt_unix_fw_file_t *file = (lt_unix_fw_file_t *)ctx;
+
+    if ((offset > file->size) || (len > file->size - offset)) {
+        return LT_PARAM_ERR;
+    }
+    memcpy(buf, file->data + offset, len);
+
+    return LT_OK;
+}
+
+static uint32_t lt_unix_fw_file_now_ms(void *ctx)
+{
+    LT_UNUSED(ctx);
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u);
+}
+
+lt_ret_t lt_unix_fw_file_open(lt_unix_fw_file_t *file, const char *path, lt_fw_update_stream_t *stream)
+{
+    if (!file || !path || !stream) {
+        return LT_PARAM_ERR;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        LT_LOG_ERROR("Could not open %s: %s (%d).", path, strerror(errno), errno);
+        return LT_FAIL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 || (uint64_t)st.st_size > UINT32_MAX) {
+        LT_LOG_ERROR("Invalid firmware update image %s.", path);
+        close(fd);
+        return LT_FAIL;
+    }
+
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // Mapping stays valid after the descriptor is closed
+    close(fd);
+    if (data == MAP_FAILED) {
+        LT_LOG_ERROR("Could not map %s: %s (%d).", path, strerror(errno), errno);
+        return LT_FAIL;
+    }
+
+    file->data = (const uint8_t *)data;
+    file->size = (size_t)st.st_size;
+
+    memset(stream, 0, sizeof(*stream));
+    stream->read = lt_unix_fw_file_read;
+    stream->now_ms = lt_unix_fw_file_now_ms;
+    stream->ctx = file;
+    stream->image_size = (uint32_t)file->size;
+
+    return LT_OK;
+}
+
+lt_ret_t lt_unix_fw_file_close(lt_unix_fw_file_t *file)
+{
+    if (!file || !file->data) {
+        return LT_PARAM_ERR;
+    }
+
+    if (munmap((void *)file->data, file->size) != 0) {
+        LT_LOG_ERROR("Could not unmap firmware update image: %s (%d).", strerror(errno), errno);
+        return LT_FAIL;
+    }
+    file->data = NULL;
+    file->size = 0;
+
+    return LT_OK;
+}
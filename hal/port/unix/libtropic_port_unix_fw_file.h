@@ -0,0 +1,57 @@
+#ifndef LIBTROPIC_PORT_UNIX_FW_FILE_H
+#define LIBTROPIC_PORT_UNIX_FW_FILE_H
+
+/**
+ * @file libtropic_port_unix_fw_file.h
+ * @author Tropic Square s.r.o.
+ * @brief Source of firmware update images for lt_do_mutable_fw_update_stream() backed by a memory-mapped file.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libtropic_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Memory-mapped firmware update image. */
+typedef struct lt_unix_fw_file_t {
+    const uint8_t *data; /**< Mapped content of the file */
+    size_t size;         /**< Size of the file */
+} lt_unix_fw_file_t;
+
+/**
+ * @brief Maps a firmware update image (`.bin` file from TROPIC01_fw_update_files) and sets up `stream` to read it.
+ * @details Sets `read`, `now_ms` (CLOCK_MONOTONIC), `ctx` (pointing to `file`) and `image_size` of the stream,
+ * `progress` callback is cleared and can be set by the caller afterwards.
+ *
+ * @param file    Image to be mapped
+ * @param path    Path to the `.bin` file
+ * @param stream  Stream to be set up
+ *
+ * @retval        LT_OK Function executed successfully
+ * @retval        other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_unix_fw_file_open(lt_unix_fw_file_t *file, const char *path, lt_fw_update_stream_t *stream);
+
+/**
+ * @brief Unmaps the firmware update image.
+ *
+ * @param file    Image mapped by lt_unix_fw_file_open()
+ *
+ * @retval        LT_OK Function executed successfully
+ * @retval        other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_unix_fw_file_close(lt_unix_fw_file_t *file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LIBTROPIC_PORT_UNIX_FW_FILE_H
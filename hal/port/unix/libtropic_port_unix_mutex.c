@@ -0,0 +1,65 @@
+/**
+ * @file libtropic_port_unix_mutex.c
+ * @author Tropic Square s.r.o.
+ * @brief Mutex functions of the port interface implemented with pthreads, compile together with a Unix port when
+ * libtropic is built with LT_THREAD_SAFE.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libtropic_common.h"
+#include "libtropic_logging.h"
+#include "libtropic_port.h"
+
+lt_ret_t lt_port_mutex_init(void **mutex)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutex_t *m = malloc(sizeof(pthread_mutex_t));
+    if (!m) {
+        LT_LOG_ERROR("Could not allocate mutex.");
+        return LT_FAIL;
+    }
+
+    // Functions of libtropic.h lock the handle and some of them call others
+    int err = pthread_mutexattr_init(&attr);
+    if (!err) {
+        err = pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+        if (!err) {
+            err = pthread_mutex_init(m, &attr);
+        }
+        pthread_mutexattr_destroy(&attr);
+    }
+    if (err) {
+        LT_LOG_ERROR("Could not create mutex: %s (%d).", strerror(err), err);
+        free(m);
+        return LT_FAIL;
+    }
+
+    *mutex = m;
+    return LT_OK;
+}
+
+lt_ret_t lt_port_mutex_deinit(void **mutex)
+{
+    if (*mutex) {
+        pthread_mutex_destroy(*mutex);
+        free(*mutex);
+        *mutex = NULL;
+    }
+
+    return LT_OK;
+}
+
+lt_ret_t lt_port_mutex_lock(void *mutex)
+{
+    return pthread_mutex_lock(mutex) ? LT_FAIL : LT_OK;
+}
+
+lt_ret_t lt_port_mutex_unlock(void *mutex)
+{
+    return pthread_mutex_unlock(mutex) ? LT_FAIL : LT_OK;
+}
@@ -131,9 +131,9 @@ static lt_ret_t communicate(lt_dev_unix_tcp_t *dev, int *tx_payload_length_ptr,
 
         for (int i = 0; i < LT_UNIX_TCP_RX_ATTEMPTS; i++) {
             LT_LOG_DEBUG("Attempting to receive remaining bytes: attempt #%d.", i);
-            nb_bytes_received = recv(dev->socket_fd, dev->rx_buffer.buff, LT_UNIX_TCP_MAX_RECV_SIZE, 0);
+            nb_bytes_received = recv(dev->socket_fd, rx_ptr, nb_bytes_to_receive - nb_bytes_received_total, 0);
 
-            if (nb_bytes_received < 0) {
+            if (nb_bytes_received <= 0) {
                 LT_LOG_ERROR("Receive failed: %s (%d).", strerror(errno), errno);
                 return LT_FAIL;
             }
@@ -200,6 +200,35 @@ static lt_ret_t server_disconnect(int socket_fd)
     return LT_OK;
 }
 
+lt_ret_t lt_unix_tcp_target_from_env(lt_dev_unix_tcp_t *dev)
+{
+    const char *addr = getenv(LT_UNIX_TCP_ENV_ADDR);
+    const char *port = getenv(LT_UNIX_TCP_ENV_PORT);
+    struct in_addr in;
+
+    if (!addr) {
+        addr = LT_UNIX_TCP_DEFAULT_ADDR;
+    }
+    if (inet_pton(AF_INET, addr, &in) != 1) {
+        LT_LOG_ERROR("%s=%s is not an IPv4 address.", LT_UNIX_TCP_ENV_ADDR, addr);
+        return LT_PARAM_ERR;
+    }
+    dev->addr = in.s_addr;
+
+    dev->port = LT_UNIX_TCP_DEFAULT_PORT;
+    if (port) {
+        char *end;
+        unsigned long value = strtoul(port, &end, 10);
+        if ((*port == '\0') || (*end != '\0') || (value == 0) || (value > UINT16_MAX)) {
+            LT_LOG_ERROR("%s=%s is not a port.", LT_UNIX_TCP_ENV_PORT, port);
+            return LT_PARAM_ERR;
+        }
+        dev->port = (in_port_t)value;
+    }
+
+    return LT_OK;
+}
+
 lt_ret_t lt_port_init(lt_l2_state_t *s2)
 {
     lt_dev_unix_tcp_t *dev = (lt_dev_unix_tcp_t *)(s2->device);
@@ -275,6 +304,9 @@ lt_ret_t lt_port_spi_transfer(lt_l2_state_t *s2, uint8_t offset, uint16_t tx_dat
 lt_ret_t lt_port_delay(lt_l2_state_t *s2, uint32_t ms)
 {
     lt_dev_unix_tcp_t *dev = (lt_dev_unix_tcp_t *)(s2->device);
+    if (s2->clock.is_virtual) {
+        return LT_OK;
+    }
     LT_LOG_DEBUG("-- Waiting for the target.");
 
     dev->tx_buffer.tag = LT_UNIX_TCP_TAG_WAIT;
@@ -25,6 +25,15 @@ extern "C" {
 #define LT_UNIX_TCP_RX_ATTEMPTS 3
 #define LT_UNIX_TCP_MAX_RECV_SIZE (LT_UNIX_TCP_MAX_PAYLOAD_LEN + LT_UNIX_TCP_TAG_AND_LENGTH_SIZE)
 
+/** @brief Address of the model server if LT_UNIX_TCP_ENV_ADDR is not set. */
+#define LT_UNIX_TCP_DEFAULT_ADDR "127.0.0.1"
+/** @brief Port of the model server if LT_UNIX_TCP_ENV_PORT is not set. */
+#define LT_UNIX_TCP_DEFAULT_PORT 28992
+/** @brief Environment variable with the IPv4 address of the model server. */
+#define LT_UNIX_TCP_ENV_ADDR "LT_MODEL_ADDR"
+/** @brief Environment variable with the port of the model server. */
+#define LT_UNIX_TCP_ENV_PORT "LT_MODEL_PORT"
+
 /** @brief Possible values for `tag` field of `lt_unix_tcp_buffer_t`. */
 typedef enum lt_unix_tcp_tag_t {
     LT_UNIX_TCP_TAG_SPI_DRIVE_CSN_LOW = 0x01,
@@ -72,6 +81,17 @@ typedef struct lt_dev_unix_tcp_t {
     struct lt_unix_tcp_buffer_t tx_buffer;
 } lt_dev_unix_tcp_t;
 
+/**
+ * @brief Sets address and port of the model server from environment variables LT_MODEL_ADDR and LT_MODEL_PORT.
+ * @details Unset variables give LT_UNIX_TCP_DEFAULT_ADDR and LT_UNIX_TCP_DEFAULT_PORT, so one executable can be pointed
+ * at any of several model instances without recompiling.
+ *
+ * @param dev     Device structure, only `addr` and `port` are set
+ * @retval        LT_OK Function executed successfully
+ * @retval        LT_PARAM_ERR A variable is not a valid IPv4 address or port
+ */
+lt_ret_t lt_unix_tcp_target_from_env(lt_dev_unix_tcp_t *dev);
+
 #ifdef __cplusplus
 }
 #endif
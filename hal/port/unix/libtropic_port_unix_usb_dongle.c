@@ -164,7 +164,9 @@ lt_ret_t lt_port_deinit(lt_l2_state_t *s2)
 
 lt_ret_t lt_port_delay(lt_l2_state_t *s2, uint32_t ms)
 {
-    LT_UNUSED(s2);
+    if (s2->clock.is_virtual) {
+        return LT_OK;
+    }
     int ret = usleep(ms * 1000);
     if (ret != 0) {
         LT_LOG_ERROR("usleep() failed: %s (%d)", strerror(errno), ret);
@@ -241,7 +243,8 @@ lt_ret_t lt_port_spi_transfer(lt_l2_state_t *s2, uint8_t offset, uint16_t tx_dat
         return LT_L1_SPI_ERROR;
     }
 
-    lt_port_delay(s2, LT_UNIX_USB_DONGLE_READ_WRITE_DELAY);
+    // Pacing required by the dongle, not a wait of libtropic, so it is done also with a virtual clock
+    usleep(LT_UNIX_USB_DONGLE_READ_WRITE_DELAY * 1000);
 
     int read_bytes = read_port(device->fd, buffered_chars, (2 * tx_data_length) + 2);
     if (read_bytes != ((2 * tx_data_length) + 2)) {
@@ -28,6 +28,9 @@ extern "C" {
 /**
  * @brief Initialize handle and transport layer
  *
+ * @note              With LT_THREAD_SAFE, the handle's mutex is created here. Other threads must not use the handle
+ *                    until this function returns.
+ *
  * @param h           Device's handle
  *
  * @retval            LT_OK Function executed successfully
@@ -53,6 +56,34 @@ lt_ret_t lt_init(lt_handle_t *h);
  */
 lt_ret_t lt_deinit(lt_handle_t *h);
 
+#if LT_THREAD_SAFE
+/**
+ * @brief Locks the handle for a sequence of calls.
+ * @details With LT_THREAD_SAFE, every function of this header which takes the handle locks its recursive mutex, so
+ * threads can share one handle and calls are executed one at a time. Different handles do not block each other.
+ * Locking the handle explicitly makes a sequence of calls atomic, e.g. several lt_r_mem_data_write() calls, or
+ * protects calls of the separate API (libtropic_l2.h, libtropic_l3.h), which does not lock the handle.
+ *
+ * @param h           Device's handle initialized by lt_init()
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_handle_lock(lt_handle_t *h);
+
+/**
+ * @brief Unlocks the handle locked by lt_handle_lock().
+ *
+ * @param h           Device's handle
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_handle_unlock(lt_handle_t *h);
+#endif
+
 /**
  * @brief Update mode variable in handle.
  * Reads one byte from SPI, checks `TR01_L1_CHIP_MODE_STARTUP_bit` and updates this information in `lt_l2_state_t` (part
@@ -440,6 +471,56 @@ lt_ret_t lt_r_mem_data_read(lt_handle_t *h, const uint16_t udata_slot, uint8_t *
  */
 lt_ret_t lt_r_mem_data_erase(lt_handle_t *h, const uint16_t udata_slot);
 
+/**
+ * @brief Reads consecutive slots of the User Partition in the R memory.
+ * @details Reads slots `first_slot` to `first_slot + slot_cnt - 1`. Commands are pipelined: the next command is
+ * encrypted while TROPIC01 executes the current one. Result of each slot is stored into its element of `rd`, empty
+ * slots are reported as LT_L3_R_MEM_DATA_READ_SLOT_EMPTY. When the function fails, every slot which was attempted
+ * still has its result; slots which were not attempted keep LT_FAIL.
+ *
+ * @param h           Device's handle
+ * @param first_slot  First slot to be read
+ * @param slot_cnt    Number of slots to be read
+ * @param rd          Scatter list with `slot_cnt` elements, one per slot
+ *
+ * @retval            LT_OK All slots were attempted, check `ret` of each element
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_r_mem_data_read_range(lt_handle_t *h, const uint16_t first_slot, const uint16_t slot_cnt,
+                                  lt_r_mem_data_rd_t *rd);
+
+/**
+ * @brief Writes data into arbitrary slots of the User Partition in the R memory.
+ * @details Commands are pipelined like in lt_r_mem_data_read_range(). Result of each write is stored into its
+ * element of `wr`.
+ *
+ * @param h           Device's handle
+ * @param wr          Array of (slot, data) pairs
+ * @param wr_cnt      Number of elements in `wr`
+ *
+ * @retval            LT_OK All slots were attempted, check `ret` of each element
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_r_mem_data_write_vec(lt_handle_t *h, lt_r_mem_data_wr_t *wr, const uint16_t wr_cnt);
+
+/**
+ * @brief Erases consecutive slots of the User Partition in the R memory.
+ * @details Commands are pipelined like in lt_r_mem_data_read_range().
+ *
+ * @param h           Device's handle
+ * @param first_slot  First slot to be erased
+ * @param slot_cnt    Number of slots to be erased
+ * @param results     Array with `slot_cnt` elements for result of each erase, can be NULL
+ *
+ * @retval            LT_OK All slots were attempted, check `results` (or all slots were erased when `results` is NULL)
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_r_mem_data_erase_range(lt_handle_t *h, const uint16_t first_slot, const uint16_t slot_cnt,
+                                   lt_ret_t *results);
+
 /**
  * @brief Gets random bytes from TROPIC01's Random Number Generator.
  *
@@ -453,6 +534,22 @@ lt_ret_t lt_r_mem_data_erase(lt_handle_t *h, const uint16_t udata_slot);
  */
 lt_ret_t lt_random_value_get(lt_handle_t *h, uint8_t *rnd_bytes, const uint16_t rnd_bytes_cnt);
 
+/**
+ * @brief Fills a buffer of any size with random bytes from TROPIC01's Random Number Generator.
+ * @details Uses as few Random_Value_Get commands as possible, each of them asking for up to
+ * TR01_RANDOM_VALUE_GET_LEN_MAX bytes. The next command is encrypted and sent before the previous response is
+ * decrypted, so host-side AES-GCM work overlaps with command execution on TROPIC01.
+ *
+ * @param h           Device's handle
+ * @param buff        Buffer for the random bytes
+ * @param len         Number of random bytes to get
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_random_fill(lt_handle_t *h, uint8_t *buff, const size_t len);
+
 /**
  * @brief Generates ECC key in the specified ECC key slot
  *
@@ -493,6 +590,9 @@ lt_ret_t lt_ecc_key_store(lt_handle_t *h, const lt_ecc_slot_t slot, const lt_ecc
  * @param origin         When the function executes successfully, the origin of the public key (generated/stored) will
  * be written
  *
+ * @note When compiled with LT_ECC_KEY_CACHE, a successfully read key is cached in the handle and subsequent reads of
+ * the same slot are served without communicating with TROPIC01.
+ *
  * @retval               LT_OK Function executed successfully
  * @retval               other Function did not execute successully, you might use lt_ret_verbose() to get verbose
  * encoding of returned value
@@ -512,6 +612,126 @@ lt_ret_t lt_ecc_key_read(lt_handle_t *h, const lt_ecc_slot_t ecc_slot, uint8_t *
  */
 lt_ret_t lt_ecc_key_erase(lt_handle_t *h, const lt_ecc_slot_t ecc_slot);
 
+#if LT_ECC_KEY_CACHE
+/**
+ * @brief Invalidates all entries of the host-side ECC public key cache.
+ * @details Keys changed through the same handle are invalidated automatically. Call this function when ECC slots
+ * might have been changed by other means (another host, another handle, a chip reset to a different state), so the
+ * next lt_ecc_key_read() fetches the key from TROPIC01 again.
+ *
+ * @param h           Device's handle
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_ecc_key_cache_invalidate(lt_handle_t *h);
+#endif
+
+#if LT_SLOT_INVENTORY
+/**
+ * @brief Builds the slot inventory: occupancy of all R memory slots and ECC key slots.
+ * @details R_Mem_Data_Read and ECC_Key_Read commands are pipelined (see lt_r_mem_data_read_range()) and only the
+ * result of each command is evaluated. The inventory is tied to the serial number of the chip and kept up to date by
+ * R_Mem_Data_* and ECC_Key_* functions called through the same handle. When compiled with LT_ECC_KEY_CACHE, read
+ * public keys are cached as well.
+ *
+ * @param h           Device's handle
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_slot_inventory_scan(lt_handle_t *h);
+
+/**
+ * @brief Stores the slot inventory into a blob, which can be kept by the application and passed to
+ * lt_slot_inventory_load() later.
+ *
+ * @param h              Device's handle
+ * @param blob           Buffer for the blob
+ * @param blob_max_size  Size of the buffer, at least LT_SLOT_INVENTORY_BLOB_SIZE
+ *
+ * @retval               LT_OK Function executed successfully
+ * @retval               LT_FAIL Inventory was not built yet
+ * @retval               other Function did not execute successully, you might use lt_ret_verbose() to get verbose
+ * encoding of returned value
+ */
+lt_ret_t lt_slot_inventory_save(lt_handle_t *h, uint8_t *blob, const size_t blob_max_size);
+
+/**
+ * @brief Restores the slot inventory from a blob made by lt_slot_inventory_save(), instead of scanning the slots.
+ * @details Serial number stored in the blob is compared with the serial number of the connected chip (Get_Info_Req).
+ * @warning Slots changed by other means since the blob was saved (another host, another handle) are not detected.
+ *
+ * @param h           Device's handle
+ * @param blob        Blob
+ * @param blob_len    Length of the blob, LT_SLOT_INVENTORY_BLOB_SIZE
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            LT_FAIL Blob is corrupted or belongs to another chip, call lt_slot_inventory_scan()
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_slot_inventory_load(lt_handle_t *h, const uint8_t *blob, const size_t blob_len);
+
+/**
+ * @brief Looks up whether an R memory slot holds data, without communicating with TROPIC01.
+ *
+ * @param h           Device's handle
+ * @param udata_slot  Memory's slot
+ * @param used        True when the slot holds data
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            LT_FAIL Inventory was not built yet
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_slot_inventory_r_mem_is_used(lt_handle_t *h, const uint16_t udata_slot, bool *used);
+
+/**
+ * @brief Looks up whether an ECC key slot holds a key, without communicating with TROPIC01.
+ *
+ * @param h           Device's handle
+ * @param ecc_slot    Slot number TR01_ECC_SLOT_0 - TR01_ECC_SLOT_31
+ * @param used        True when the slot holds a key
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            LT_FAIL Inventory was not built yet
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_slot_inventory_ecc_is_used(lt_handle_t *h, const lt_ecc_slot_t ecc_slot, bool *used);
+
+/**
+ * @brief Finds the lowest free R memory slot and marks it as used in the inventory.
+ * @details The slot stays reserved until it is erased through the same handle.
+ *
+ * @param h           Device's handle
+ * @param udata_slot  Allocated slot
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            LT_FAIL Inventory was not built yet or no slot is free
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_slot_inventory_r_mem_alloc(lt_handle_t *h, uint16_t *udata_slot);
+
+/**
+ * @brief Finds the lowest free ECC key slot and marks it as used in the inventory.
+ * @details The slot stays reserved until it is erased through the same handle.
+ *
+ * @param h           Device's handle
+ * @param ecc_slot    Allocated slot
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            LT_FAIL Inventory was not built yet or no slot is free
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_slot_inventory_ecc_alloc(lt_handle_t *h, lt_ecc_slot_t *ecc_slot);
+#endif
+
 /**
  * @brief Performs ECDSA sign of a message with a private ECC key stored in TROPIC01
  *
@@ -528,6 +748,21 @@ lt_ret_t lt_ecc_key_erase(lt_handle_t *h, const lt_ecc_slot_t ecc_slot);
 lt_ret_t lt_ecc_ecdsa_sign(lt_handle_t *h, const lt_ecc_slot_t ecc_slot, const uint8_t *msg, const uint32_t msg_len,
                            uint8_t *rs);
 
+/**
+ * @brief Performs ECDSA sign of an already computed message hash with a private ECC key stored in TROPIC01
+ * @details Use when the hash is computed elsewhere (e.g. by a TLS library), lt_ecc_ecdsa_sign() would hash it again.
+ *
+ * @param h           Device's handle
+ * @param ecc_slot    Slot containing a private key, TR01_ECC_SLOT_0 - TR01_ECC_SLOT_31
+ * @param msg_hash    SHA256 hash of the message (TR01_ECDSA_SIGN_HASH_LEN bytes)
+ * @param rs          Buffer for storing a signature in a form of R and S bytes (should always have length 64B)
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_ecc_ecdsa_sign_hash(lt_handle_t *h, const lt_ecc_slot_t ecc_slot, const uint8_t *msg_hash, uint8_t *rs);
+
 /**
  * @brief Verifies ECDSA signature. Host side only, does not require TROPIC01.
  *
@@ -628,6 +863,34 @@ lt_ret_t lt_mcounter_get(lt_handle_t *h, const enum lt_mcounter_index_t mcounter
 lt_ret_t lt_mac_and_destroy(lt_handle_t *h, const lt_mac_and_destroy_slot_t slot, const uint8_t *data_out,
                             uint8_t *data_in);
 
+/**
+ * @brief Executes a batch of L3 commands.
+ * @details Commands are pipelined: command N+1 is encrypted into `stage` while TROPIC01 executes command N, and its
+ * packet is copied into the L3 buffer once the response of command N is processed. All descriptors are validated before
+ * anything is sent; every `ret` is set to LT_BATCH_NOT_EXECUTED and then overwritten with the result of the command.
+ * Commands keep the side effects of the single-command functions (ECC key cache, slot inventory), but lt_ecc_key_read()
+ * requests are always sent to the chip.
+ *
+ * With `stop_on_error`, no further command is prepared after the first failure. The command which was already on the
+ * chip at that moment is still completed and its result is reported. Commands after it keep LT_BATCH_NOT_EXECUTED.
+ *
+ * @note Secure Session must be established.
+ *
+ * @param h              Device's handle
+ * @param cmds           Array of command descriptors
+ * @param cmd_cnt        Number of elements in `cmds`
+ * @param stage          Buffer for the next encrypted command, LT_SIZE_OF_L3_BUFF bytes fit any command
+ * @param stage_size     Size of `stage`
+ * @param stop_on_error  Stop preparing commands after the first failure
+ *
+ * @retval               LT_OK All commands were attempted, check `ret` of each element
+ * @retval               LT_PARAM_ERR Invalid descriptor, or a command does not fit into `stage`; nothing was sent
+ * @retval               other Result of the first failed command when `stop_on_error` is set, or an error which made
+ * further processing impossible; you might use lt_ret_verbose() to get verbose encoding of returned value
+ */
+lt_ret_t lt_batch_run(lt_handle_t *h, lt_batch_cmd_t *cmds, const uint16_t cmd_cnt, uint8_t *stage,
+                      const uint16_t stage_size, const bool stop_on_error);
+
 /** @} */  // end of libtropic_API group
 
 #ifdef LT_HELPERS
@@ -679,6 +942,92 @@ lt_ret_t lt_write_whole_R_config(lt_handle_t *h, const struct lt_config_t *confi
  */
 lt_ret_t lt_read_whole_R_config(lt_handle_t *h, struct lt_config_t *config);
 
+#if LT_R_CONFIG_MIRROR
+/**
+ * @brief Loads the whole R-Config into the host-side mirror kept in the handle.
+ * @details R_Config_Read commands are pipelined (see lt_r_mem_data_read_range()). lt_r_config_write(),
+ * lt_r_config_erase() and lt_batch_run() R-Config commands sent through the same handle unload the mirror, load it
+ * again afterwards.
+ *
+ * @param h           Device's handle
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_r_config_mirror_load(lt_handle_t *h);
+
+/**
+ * @brief Gets a configuration object from the mirror, without communicating with TROPIC01.
+ *
+ * @param h           Device's handle with a loaded mirror
+ * @param idx         Index of the configuration object
+ * @param obj         Requested value of the object (including uncommitted changes)
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_r_config_mirror_get(lt_handle_t *h, const enum lt_config_obj_idx_t idx, uint32_t *obj);
+
+/**
+ * @brief Sets a configuration object in the mirror. Nothing is written until lt_r_config_mirror_commit().
+ *
+ * @param h           Device's handle with a loaded mirror
+ * @param idx         Index of the configuration object
+ * @param obj         New value of the object
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_r_config_mirror_set(lt_handle_t *h, const enum lt_config_obj_idx_t idx, const uint32_t obj);
+
+/**
+ * @brief Gets a field of a configuration object from the mirror.
+ *
+ * @param h           Device's handle with a loaded mirror
+ * @param idx         Index of the configuration object
+ * @param mask        Mask of the field, e.g. APPLICATION_CO_CFG_SLEEP_MODE_SLEEP_MODE_EN_MASK
+ * @param value       Value of the field, shifted to bit 0
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_r_config_mirror_get_field(lt_handle_t *h, const enum lt_config_obj_idx_t idx, const uint32_t mask,
+                                      uint32_t *value);
+
+/**
+ * @brief Sets a field of a configuration object in the mirror, other bits of the object are kept.
+ *
+ * @param h           Device's handle with a loaded mirror
+ * @param idx         Index of the configuration object
+ * @param mask        Mask of the field, e.g. APPLICATION_CO_CFG_SLEEP_MODE_SLEEP_MODE_EN_MASK
+ * @param value       New value of the field, starting at bit 0
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_r_config_mirror_set_field(lt_handle_t *h, const enum lt_config_obj_idx_t idx, const uint32_t mask,
+                                      const uint32_t value);
+
+/**
+ * @brief Writes changed objects of the mirror to TROPIC01.
+ * @details When all changed objects are erased on TROPIC01, only the changed objects are written. TROPIC01 does
+ * not allow rewriting an already written object, so otherwise R-Config is erased and all objects which differ from
+ * the erased value are written. R_Config_Write commands are pipelined.
+ *
+ * @param h           Device's handle with a loaded mirror
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_r_config_mirror_commit(lt_handle_t *h);
+#endif
+
 /**
  * @brief Reads all of the I-Config objects into `config`.
  *
@@ -693,7 +1042,8 @@ lt_ret_t lt_read_whole_I_config(lt_handle_t *h, struct lt_config_t *config);
 
 /**
  * @brief Writes the whole I-Config with the passed `config`.
- * @details Only the zero bits in `config` are written.
+ * @details The current I-Config is read first and I_Config_Write is sent only for bits which are zero in `config`
+ * and still set on the chip. Bits which are already zero on the chip cannot be set back to one.
  *
  * @param h           Device's handle
  * @param config      Array into which objects are read
@@ -704,14 +1054,28 @@ lt_ret_t lt_read_whole_I_config(lt_handle_t *h, struct lt_config_t *config);
  */
 lt_ret_t lt_write_whole_I_config(lt_handle_t *h, const struct lt_config_t *config);
 
+/**
+ * @brief Computes how many I_Config_Write commands lt_write_whole_I_config() would send for the passed `config`.
+ * @details The current I-Config is read, nothing is written.
+ *
+ * @param h           Device's handle
+ * @param config      Requested I-Config
+ * @param write_cnt   Number of bits which would be cleared
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_write_whole_I_config_dry_run(lt_handle_t *h, const struct lt_config_t *config, uint16_t *write_cnt);
+
 /**
  * @brief Establishes a secure channel between host MCU and TROPIC01
  *
- * @warning This function currently DOES NOT validate/verify the whole certificate chain, it just parses out STPUB from
- * the device's certificate, because STPUB is used for handshake.
+ * @warning This function DOES NOT validate/verify the whole certificate chain, it just parses out STPUB from the
+ * device's certificate, because STPUB is used for handshake.
  *
- * To verify the whole certificate chain we recommend to download all certificates from chip by using
- * lt_get_info_cert_store() and use any apropriate third party tool to verify validity of certificate chain.
+ * To verify the whole certificate chain against a trust anchor, use lt_cert_verify_chip_and_start_secure_session()
+ * from libtropic_cert.h instead.
  *
  * @param h           Device's handle
  * @param shipriv     Host's private pairing key for the slot `pkey_index`
@@ -775,6 +1139,68 @@ lt_ret_t lt_print_fw_header(lt_handle_t *h, const lt_bank_id_t bank_id, int (*pr
 lt_ret_t lt_do_mutable_fw_update(lt_handle_t *h, const uint8_t *update_data, const uint16_t update_data_size,
                                  const lt_bank_id_t bank_id);
 
+/**
+ * @brief Performs mutable firmware update on ABAB and ACAB silicon revisions, reading the image from a stream.
+ * @details Chunks are read by `stream->read` directly into the L2 buffer of the handle, one chunk at a time. After
+ * every chunk acknowledged by TROPIC01, `progress` is updated and `stream->progress` is called.
+ *
+ * When the update is interrupted (e.g. by a communication error), calling this function again with the same `progress`
+ * resumes the update after the last acknowledged chunk. This works only while TROPIC01 stays in Maintenance mode (no
+ * reboot or power loss in between), otherwise `progress` has to be zeroed and the update started over.
+ *
+ * @param h         Device's handle
+ * @param stream    Source of the update image
+ * @param bank_id   Bank ID where the update should be applied, valid values are
+ *                     For ABAB: TR01_FW_BANK_FW1, TR01_FW_BANK_FW2, TR01_FW_BANK_SPECT1, TR01_FW_BANK_SPECT2
+ *                     For ACAB: Parameter is ignored, chip is handling firmware banks on its own
+ * @param progress  Progress of the update, zeroed for a new update
+ * @return          LT_OK if success, otherwise returns other error code.
+ */
+lt_ret_t lt_do_mutable_fw_update_stream(lt_handle_t *h, const lt_fw_update_stream_t *stream,
+                                        const lt_bank_id_t bank_id, lt_fw_update_progress_t *progress);
+
+/**
+ * @brief Seeds a host-side HMAC_DRBG (SHA256) with entropy from TROPIC01's Random Number Generator.
+ * @details The DRBG expands chip entropy locally, which is much faster than lt_random_fill() for large amounts of
+ * random data. It is reseeded from TROPIC01 each time it has produced `reseed_interval` bytes.
+ *
+ * @param h                 Device's handle
+ * @param drbg              DRBG state to initialize
+ * @param reseed_interval   Number of bytes generated between reseeds, 0 selects
+ * LT_RANDOM_DRBG_RESEED_INTERVAL_DEFAULT
+ *
+ * @retval                  LT_OK Function executed successfully
+ * @retval                  other Function did not execute successully, you might use lt_ret_verbose() to get verbose
+ * encoding of returned value
+ */
+lt_ret_t lt_random_drbg_init(lt_handle_t *h, lt_random_drbg_t *drbg, const uint32_t reseed_interval);
+
+/**
+ * @brief Fills a buffer with random bytes from the host-side DRBG seeded by lt_random_drbg_init().
+ * @note Secure Session is needed only when the DRBG has to be reseeded.
+ *
+ * @param h           Device's handle
+ * @param drbg        Initialized DRBG state
+ * @param buff        Buffer for the random bytes
+ * @param len         Number of random bytes to generate
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_random_drbg_fill(lt_handle_t *h, lt_random_drbg_t *drbg, uint8_t *buff, const size_t len);
+
+/**
+ * @brief Wipes the DRBG state.
+ *
+ * @param drbg        DRBG state
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_random_drbg_deinit(lt_random_drbg_t *drbg);
+
 /** @} */  // end of libtropic_API_helpers group
 #endif
 
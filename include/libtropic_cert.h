@@ -0,0 +1,142 @@
+#ifndef LIBTROPIC_CERT_H
+#define LIBTROPIC_CERT_H
+
+/**
+ * @defgroup libtropic_cert 1.6. Libtropic API: Certificate Chain Verification
+ * @brief Host-side verification of the certificate chain read from TROPIC01's Certificate Store
+ * @details lt_cert_verify_chain() checks that the Certificate Store forms a chain ending in a trust anchor supplied by
+ * the caller:
+ *  - every certificate parses and its issuer is the subject of the next certificate (device, XXXX, TROPIC01, root),
+ *  - the root certificate is byte-equal to the trust anchor,
+ *  - optionally, the current time lies within the validity of every certificate,
+ *  - the device, XXXX and TROPIC01 certificates are signed by the key of the next certificate.
+ *
+ * Signatures are verified with the crypto HAL for ecdsa-with-SHA256 over P-256 and for Ed25519. Other algorithms (the
+ * certificates of production chips are signed with P-384 and P-521 keys) are passed to a callback supplied by the
+ * caller, e.g. backed by OpenSSL or mbedTLS.
+ *
+ * Signature checks dominate the cost of the verification. A chain which was verified once is remembered in an optional
+ * cache (lt_cert_chain_cache_t) under the SHA256 digest of its certificates, so later verifications of the same chain,
+ * typically one per Secure Session start, only parse the certificates and compare names, anchor and validity.
+ * @{
+ */
+
+/**
+ * @file libtropic_cert.h
+ * @brief Certificate chain verification declarations
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdint.h>
+
+#include "libtropic_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef LT_CERT_CHAIN_CACHE_ENTRIES
+/** @brief Number of verified chains remembered by lt_cert_chain_cache_t. */
+#define LT_CERT_CHAIN_CACHE_ENTRIES 4
+#endif
+
+/** @brief Size of the digest identifying a chain in the cache. */
+#define LT_CERT_CHAIN_DIGEST_SIZE 32
+
+/** @brief Length of a time in GeneralizedTime format "YYYYMMDDHHMMSSZ", without the terminating zero. */
+#define LT_CERT_TIME_LEN 15
+
+/**
+ * @brief Cache of verified chains.
+ * @details Zero-initialize before the first use. Entries are replaced round-robin. Not synchronized, callers sharing
+ * a cache between threads have to serialize the verifications.
+ */
+typedef struct lt_cert_chain_cache_t {
+    uint8_t digests[LT_CERT_CHAIN_CACHE_ENTRIES][LT_CERT_CHAIN_DIGEST_SIZE]; /**< Digests of verified chains */
+    uint8_t count;                                                           /**< Number of valid entries */
+    uint8_t next;                                                            /**< Entry replaced next */
+    uint32_t hits;   /**< Verifications which skipped the signature checks */
+    uint32_t misses; /**< Verifications which checked the signatures */
+} lt_cert_chain_cache_t;
+
+/** @brief Certificate signed by the key of its issuer, passed to lt_cert_verify_sig_cb_t. */
+typedef struct lt_cert_signed_t {
+    const uint8_t *issuer_spki; /**< DER SubjectPublicKeyInfo of the issuer */
+    uint16_t issuer_spki_len;   /**< Length of `issuer_spki` */
+    const uint8_t *sig_alg;     /**< Contents of the signatureAlgorithm OBJECT IDENTIFIER */
+    uint16_t sig_alg_len;       /**< Length of `sig_alg` */
+    const uint8_t *tbs;         /**< DER TBSCertificate, the signed bytes */
+    uint16_t tbs_len;           /**< Length of `tbs` */
+    const uint8_t *sig;         /**< Signature, contents of the signatureValue BIT STRING */
+    uint16_t sig_len;           /**< Length of `sig` */
+} lt_cert_signed_t;
+
+/**
+ * @brief Verifies a signature made with an algorithm not supported by the crypto HAL.
+ *
+ * @param ctx     Context from lt_cert_verify_cfg_t
+ * @param cert    Signed certificate
+ *
+ * @retval        LT_OK The signature is valid
+ * @retval        LT_CERT_UNSUPPORTED The algorithm is not supported by the callback either
+ * @retval        LT_CERT_CHAIN_INVALID The signature is not valid
+ */
+typedef lt_ret_t (*lt_cert_verify_sig_cb_t)(void *ctx, const lt_cert_signed_t *cert);
+
+/** @brief Parameters of lt_cert_verify_chain(). */
+typedef struct lt_cert_verify_cfg_t {
+    const uint8_t *anchor; /**< DER certificate of the trusted root */
+    uint16_t anchor_len;   /**< Length of `anchor` */
+    /** Current time as GeneralizedTime "YYYYMMDDHHMMSSZ", NULL to skip the validity check (e.g. without a clock) */
+    const char *now;
+    lt_cert_verify_sig_cb_t verify_sig; /**< Verification of other algorithms, NULL if not used */
+    void *verify_sig_ctx;               /**< Context passed to `verify_sig` */
+    lt_cert_chain_cache_t *cache;       /**< Cache of verified chains, NULL to check the signatures every time */
+} lt_cert_verify_cfg_t;
+
+/**
+ * @brief Verifies the certificate chain of the Certificate Store against a trust anchor.
+ *
+ * @param store   Certificate Store read by lt_get_info_cert_store()
+ * @param cfg     Trust anchor, time, signature callback and cache
+ *
+ * @retval        LT_OK The chain is valid
+ * @retval        LT_CERT_CHAIN_INVALID Names do not chain, the root is not the anchor, a certificate is out of its
+ * validity, its signatureAlgorithm differs from the signature algorithm in its TBSCertificate or a signature is not
+ * valid
+ * @retval        LT_CERT_UNSUPPORTED A signature algorithm is supported neither by the crypto HAL nor by the callback
+ * @retval        other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_cert_verify_chain(const struct lt_cert_store_t *store, const lt_cert_verify_cfg_t *cfg)
+    __attribute__((warn_unused_result));
+
+/**
+ * @brief Reads the Certificate Store, verifies its chain and establishes a Secure Session.
+ * @details Same as lt_verify_chip_and_start_secure_session(), but the handshake uses STPUB only after
+ * lt_cert_verify_chain() accepted the chain. With a cache in `cfg`, only the first call for a chip checks the
+ * signatures.
+ *
+ * @param h           Device's handle
+ * @param cfg         Trust anchor, time, signature callback and cache
+ * @param shipriv     Host's private pairing key for the slot `pkey_index`
+ * @param shipub      Host's public pairing key for the slot `pkey_index`
+ * @param pkey_index  Pairing key index
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_cert_verify_chip_and_start_secure_session(lt_handle_t *h, const lt_cert_verify_cfg_t *cfg,
+                                                      const uint8_t *shipriv, const uint8_t *shipub,
+                                                      const lt_pkey_index_t pkey_index);
+
+/** @} */  // end of group libtropic_cert
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LIBTROPIC_CERT_H
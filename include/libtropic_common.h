@@ -122,12 +122,31 @@ typedef enum lt_tr01_mode_t {
     LT_TR01_MAINTENANCE_MODE /**< TROPIC01 is in Maintenance mode. */
 } lt_tr01_mode_t;
 
+/**
+ * @brief Clock of all waits of libtropic (polling, reboot, delays on the INT pin).
+ * @details Waits are done by lt_port_delay() and lt_port_delay_on_int(). With a virtual clock the ports return from
+ * them at once, which suits the emulator, the model and replayed traces, where TROPIC01 needs no time. Ports stacked on
+ * other ports (fault injection, trace recording) still see every wait. Either way the waited time is added to
+ * elapsed_ms, so latencies can be reported in the time a real chip would take.
+ */
+typedef struct lt_clock_t {
+    /** @brief Waits advance the clock and ports do not wait, set by the developer before lt_init(). */
+    bool is_virtual;
+    /** @brief Sum of all waits requested by libtropic since the handle was zeroed, in ms. */
+    uint64_t elapsed_ms;
+} lt_clock_t;
+
 //--------------------------------------------------------------------------------------------------------------------//
 typedef struct lt_l2_state_t {
     void *device;
     enum lt_tr01_mode_t mode;
     uint8_t buff[TR01_L1_CHIP_STATUS_SIZE + TR01_L2_MAX_FRAME_SIZE];
     bool startup_req_sent;
+    /** @brief Time from Startup_Req response until TROPIC01 was ready after the last lt_reboot(), in ms (resolution
+     * given by polling intervals). */
+    uint32_t reboot_time_ms;
+    /** @brief Clock of all waits, see lt_clock_t. */
+    lt_clock_t clock;
 } lt_l2_state_t;
 
 // #define LT_SIZE_OF_L3_BUFF (1000)
@@ -171,6 +190,74 @@ typedef struct lt_l3_state_t {
 /** @brief Length of key used by AES256. */
 #define TR01_AES256_KEY_LEN 32
 
+#if LT_ECC_KEY_CACHE
+/** @brief Number of ECC key slots mirrored by the public key cache (TR01_ECC_SLOT_0 - TR01_ECC_SLOT_31). */
+#define LT_ECC_KEY_CACHE_SLOT_CNT 32
+
+/** @brief One cached ECC key slot, as returned by ECC_Key_Read. */
+typedef struct lt_ecc_key_cache_entry_t {
+    bool valid;          /**< Entry holds data read from the chip */
+    uint8_t curve;       /**< Curve type of the key (lt_ecc_curve_type_t) */
+    uint8_t origin;      /**< Origin of the key (lt_ecc_key_origin_t) */
+    uint8_t pub_key[64]; /**< Public key, large enough for TR01_CURVE_P256_PUBKEY_LEN */
+} lt_ecc_key_cache_entry_t;
+
+/**
+ * @brief Host-side cache of ECC slot public keys.
+ * @details Populated by lt_ecc_key_read(), invalidated per slot by lt_ecc_key_generate(), lt_ecc_key_store() and
+ * lt_ecc_key_erase(), and as a whole by lt_ecc_key_cache_invalidate().
+ */
+typedef struct lt_ecc_key_cache_t {
+    lt_ecc_key_cache_entry_t slots[LT_ECC_KEY_CACHE_SLOT_CNT];
+} lt_ecc_key_cache_t;
+#endif
+
+#if LT_SLOT_INVENTORY
+/** @brief Number of R memory slots tracked by the slot inventory (TR01_R_MEM_DATA_SLOT_MAX + 1). */
+#define LT_SLOT_INVENTORY_R_MEM_SLOT_CNT 512
+/** @brief Number of ECC key slots tracked by the slot inventory (TR01_ECC_SLOT_0 - TR01_ECC_SLOT_31). */
+#define LT_SLOT_INVENTORY_ECC_SLOT_CNT 32
+/** @brief Length of the chip serial number stored in the slot inventory, sizeof(struct lt_ser_num_t). */
+#define LT_SLOT_INVENTORY_SER_NUM_LEN 16
+/** @brief Size of the blob produced by lt_slot_inventory_save(). */
+#define LT_SLOT_INVENTORY_BLOB_SIZE (2 + LT_SLOT_INVENTORY_SER_NUM_LEN + LT_SLOT_INVENTORY_R_MEM_SLOT_CNT / 8 + 4 + 2)
+
+/**
+ * @brief Host-side occupancy bitmaps of R memory and ECC key slots.
+ * @details Built by lt_slot_inventory_scan() or lt_slot_inventory_load() and kept up to date by R_Mem_Data_* and
+ * ECC_Key_* functions called through the same handle.
+ */
+typedef struct lt_slot_inventory_t {
+    bool valid;                                          /**< Bitmaps describe the chip with `ser_num` */
+    uint8_t ser_num[LT_SLOT_INVENTORY_SER_NUM_LEN];      /**< Serial number of the chip */
+    uint32_t r_mem[LT_SLOT_INVENTORY_R_MEM_SLOT_CNT / 32]; /**< Bit set when R memory slot holds data */
+    uint32_t ecc;                                        /**< Bit set when ECC slot holds a key */
+} lt_slot_inventory_t;
+#endif
+
+/** @brief Number of configuration objects in lt_config_t */
+#define LT_CONFIG_OBJ_CNT 27
+
+/** @brief Structure to hold all configuration objects */
+typedef struct lt_config_t {
+    uint32_t obj[LT_CONFIG_OBJ_CNT];
+} lt_config_t;
+
+#if LT_R_CONFIG_MIRROR
+/**
+ * @brief Host-side mirror of R-Config with dirty tracking, kept in the handle.
+ * @details Loaded once by lt_r_config_mirror_load(), modified in RAM by lt_r_config_mirror_set() and
+ * lt_r_config_mirror_set_field() and written to TROPIC01 by lt_r_config_mirror_commit(). Other R-Config writes and
+ * erases sent through the same handle unload it.
+ */
+typedef struct lt_r_config_mirror_t {
+    struct lt_config_t chip;   /**< R-Config as it is on TROPIC01 */
+    struct lt_config_t shadow; /**< R-Config as requested by the application */
+    uint32_t dirty;            /**< Bit i is set when shadow.obj[i] differs from chip.obj[i] */
+    bool loaded;               /**< Mirror was loaded from TROPIC01 */
+} lt_r_config_mirror_t;
+#endif
+
 /**
  * @details This structure holds data related to one physical chip.
  * Contains AESGCM contexts for encrypting and decrypting L3 commands, nonce and device void pointer, which can be used
@@ -179,6 +266,20 @@ typedef struct lt_l3_state_t {
 typedef struct lt_handle_t {
     lt_l2_state_t l2;
     lt_l3_state_t l3;
+#if LT_ECC_KEY_CACHE
+    lt_ecc_key_cache_t ecc_key_cache;
+#endif
+#if LT_SLOT_INVENTORY
+    lt_slot_inventory_t slot_inventory;
+#endif
+#if LT_R_CONFIG_MIRROR
+    lt_r_config_mirror_t r_config_mirror;
+#endif
+#if LT_THREAD_SAFE
+    /** @brief Recursive mutex serializing functions of libtropic.h, created by lt_init() with lt_port_mutex_init().
+     */
+    void *mutex;
+#endif
 } lt_handle_t;
 
 /**
@@ -281,10 +382,31 @@ typedef enum lt_ret_t {
     /** @brief The nonce has reached its maximum value. */
     LT_NONCE_OVERFLOW = 40,
 
+    // Key-value store related errors
+    /** @brief Key is not in the key-value store */
+    LT_KV_KEY_NOT_FOUND = 41,
+    /** @brief Key-value store has no free index entry or slot */
+    LT_KV_FULL = 42,
+
+    // MAC-and-Destroy PIN verification related errors
+    /** @brief Entered PIN is wrong */
+    LT_MACANDD_WRONG_PIN = 43,
+    /** @brief No PIN entry attempts are left */
+    LT_MACANDD_NO_ATTEMPTS = 44,
+    /** @brief R memory slot does not hold a valid MAC-and-Destroy record */
+    LT_MACANDD_RECORD_INVALID = 45,
+
+    /** @brief Command of a batch was not attempted, because an earlier command failed */
+    LT_BATCH_NOT_EXECUTED = 46,
+
+    /** @brief Certificate chain does not verify against the trust anchor */
+    LT_CERT_CHAIN_INVALID = 47,
+
     /** @brief Special helper value used to signalize the last enum value, used in lt_ret_verbose. */
-    LT_RET_T_LAST_VALUE = 41
+    LT_RET_T_LAST_VALUE = 48
 } lt_ret_t;
 
+/** @brief Maximal time lt_reboot() waits for TROPIC01 to become ready after Startup_Req. */
 #define LT_TR01_REBOOT_DELAY_MS 250
 
 //--------------------------------------------------------------------------------------------------------------------//
@@ -517,6 +639,36 @@ typedef enum lt_bank_id_t {
     TR01_FW_BANK_SPECT2 = 18,  // SPECT bank 2
 } lt_bank_id_t;
 
+/**
+ * @brief Progress of a mutable firmware update streamed by lt_do_mutable_fw_update_stream().
+ * @details Zero it before the first attempt. When an attempt fails, pass the same structure to the next attempt to
+ * resume after the last chunk acknowledged by TROPIC01.
+ */
+typedef struct lt_fw_update_progress_t {
+    uint32_t image_size;   /**< Size of the update image */
+    uint32_t acked_offset; /**< Offset in the image right after the last acknowledged chunk, 0 when nothing was sent */
+    uint32_t acked_chunks; /**< Number of acknowledged chunks (including the update request on ACAB) */
+    uint32_t elapsed_ms;   /**< Duration of the current attempt, 0 without `now_ms` callback */
+    uint32_t bytes_per_s;  /**< Throughput of the current attempt, 0 without `now_ms` callback */
+} lt_fw_update_progress_t;
+
+/**
+ * @brief Source of a mutable firmware update image for lt_do_mutable_fw_update_stream().
+ * @details The image has the same format as the one passed to lt_do_mutable_fw_update() (content of the `.bin` file
+ * from TROPIC01_fw_update_files), but it is read in small pieces, so it does not have to be held in RAM or flash of
+ * the host.
+ */
+typedef struct lt_fw_update_stream_t {
+    /** @brief Reads `len` bytes of the image starting at `offset` into `buf`. */
+    lt_ret_t (*read)(void *ctx, const uint32_t offset, uint8_t *buf, const uint16_t len);
+    /** @brief Optional, called after every acknowledged chunk. */
+    void (*progress)(void *ctx, const lt_fw_update_progress_t *progress);
+    /** @brief Optional monotonic time in milliseconds, used for throughput reporting. */
+    uint32_t (*now_ms)(void *ctx);
+    void *ctx;           /**< Passed to the callbacks */
+    uint32_t image_size; /**< Size of the update image */
+} lt_fw_update_stream_t;
+
 /**
  * @brief When in MAINTENANCE mode, it is possible to read firmware header from a firmware bank. Returned data differs
  * based on bootloader version. This header layout is returned by bootloader version v1.0.1
@@ -720,10 +872,41 @@ typedef enum lt_config_obj_idx_t {
 /** @brief Index of last data slot. TROPIC01 contains 512 slots indexed 0-511. */
 #define TR01_R_MEM_DATA_SLOT_MAX (511)
 
+/** @brief One element of the scatter list used by lt_r_mem_data_read_range(). */
+typedef struct lt_r_mem_data_rd_t {
+    uint8_t *data;           /**< Buffer for the content of the slot */
+    uint16_t data_max_size;  /**< Size of the buffer */
+    uint16_t data_read_size; /**< Number of bytes read from the slot */
+    lt_ret_t ret;            /**< Result of reading the slot */
+} lt_r_mem_data_rd_t;
+
+/** @brief One (slot, data) pair used by lt_r_mem_data_write_vec(). */
+typedef struct lt_r_mem_data_wr_t {
+    uint16_t slot;       /**< Slot to be written */
+    const uint8_t *data; /**< Data to be written */
+    uint16_t data_size;  /**< Size of the data */
+    lt_ret_t ret;        /**< Result of writing the slot */
+} lt_r_mem_data_wr_t;
+
 //--------------------------------------------------------------------------------------------------------------------//
 /** @brief Maximum number of random bytes requested at once */
 #define TR01_RANDOM_VALUE_GET_LEN_MAX 255
 
+/** @brief Default number of bytes the host DRBG produces before it is reseeded from TROPIC01's RNG. */
+#define LT_RANDOM_DRBG_RESEED_INTERVAL_DEFAULT (64u * 1024u)
+
+/**
+ * @brief State of the host-side HMAC_DRBG (SHA256) expanding entropy from TROPIC01's RNG.
+ * @details Initialized by lt_random_drbg_init(), used by lt_random_drbg_fill() and wiped by lt_random_drbg_deinit().
+ */
+typedef struct lt_random_drbg_t {
+    uint8_t key[32];             /**< DRBG key (K) */
+    uint8_t v[32];               /**< DRBG value (V) */
+    uint32_t reseed_interval;    /**< Number of bytes generated between two reseeds */
+    uint32_t bytes_since_reseed; /**< Number of bytes generated since the last (re)seed */
+    bool seeded;                 /**< DRBG was seeded from TROPIC01 */
+} lt_random_drbg_t;
+
 //--------------------------------------------------------------------------------------------------------------------//
 /** @brief ECC key slot indexes */
 typedef enum lt_ecc_slot_t {
@@ -777,6 +960,9 @@ typedef enum lt_ecc_key_origin_t { TR01_CURVE_GENERATED = 1, TR01_CURVE_STORED }
 /** @brief Length of the EC signature (RS) for both ECDSA and EDDSA. */
 #define TR01_ECDSA_EDDSA_SIGNATURE_LENGTH 64
 
+/** @brief Length of the message hash signed by ECDSA_Sign (SHA256). */
+#define TR01_ECDSA_SIGN_HASH_LEN 32
+
 //--------------------------------------------------------------------------------------------------------------------//
 /** @brief Maximal allowed value of the monotonic counter. */
 #define TR01_MCOUNTER_VALUE_MAX 0xFFFFFFFE
@@ -939,6 +1125,144 @@ typedef enum lt_mac_and_destroy_slot_t {
     TR01_MAC_AND_DESTROY_SLOT_127
 } lt_mac_and_destroy_slot_t;
 
+//--------------------------------------------------------------------------------------------------------------------//
+/** @brief L3 commands which can be executed by lt_batch_run(). */
+typedef enum lt_batch_cmd_id_t {
+    LT_BATCH_PING = 0,
+    LT_BATCH_PAIRING_KEY_WRITE,
+    LT_BATCH_PAIRING_KEY_READ,
+    LT_BATCH_PAIRING_KEY_INVALIDATE,
+    LT_BATCH_R_CONFIG_WRITE,
+    LT_BATCH_R_CONFIG_READ,
+    LT_BATCH_R_CONFIG_ERASE,
+    LT_BATCH_I_CONFIG_WRITE,
+    LT_BATCH_I_CONFIG_READ,
+    LT_BATCH_R_MEM_DATA_WRITE,
+    LT_BATCH_R_MEM_DATA_READ,
+    LT_BATCH_R_MEM_DATA_ERASE,
+    LT_BATCH_RANDOM_VALUE_GET,
+    LT_BATCH_ECC_KEY_GENERATE,
+    LT_BATCH_ECC_KEY_STORE,
+    LT_BATCH_ECC_KEY_READ,
+    LT_BATCH_ECC_KEY_ERASE,
+    LT_BATCH_ECDSA_SIGN,
+    LT_BATCH_EDDSA_SIGN,
+    LT_BATCH_MCOUNTER_INIT,
+    LT_BATCH_MCOUNTER_UPDATE,
+    LT_BATCH_MCOUNTER_GET,
+    LT_BATCH_MAC_AND_DESTROY
+} lt_batch_cmd_id_t;
+
+/**
+ * @brief Descriptor of one L3 command executed by lt_batch_run().
+ * @details Arguments have the same meaning as arguments of the respective libtropic.c function. Output buffers must
+ * stay valid until lt_batch_run() returns.
+ */
+typedef struct lt_batch_cmd_t {
+    lt_batch_cmd_id_t id; /**< Command */
+    /** Arguments, the member named after `id` is used */
+    union {
+        struct {
+            const uint8_t *msg_out;
+            uint8_t *msg_in;
+            uint16_t msg_len;
+        } ping;
+        struct {
+            const uint8_t *pairing_pub;
+            uint8_t slot;
+        } pairing_key_write;
+        struct {
+            uint8_t *pairing_pub;
+            uint8_t slot;
+        } pairing_key_read;
+        struct {
+            uint8_t slot;
+        } pairing_key_invalidate;
+        struct {
+            enum lt_config_obj_addr_t addr;
+            uint32_t obj;
+        } r_config_write;
+        struct {
+            enum lt_config_obj_addr_t addr;
+            uint32_t *obj;
+        } r_config_read;
+        struct {
+            enum lt_config_obj_addr_t addr;
+            uint8_t bit_index;
+        } i_config_write;
+        struct {
+            enum lt_config_obj_addr_t addr;
+            uint32_t *obj;
+        } i_config_read;
+        struct {
+            uint16_t udata_slot;
+            const uint8_t *data;
+            uint16_t data_size;
+        } r_mem_data_write;
+        struct {
+            uint16_t udata_slot;
+            uint8_t *data;
+            uint16_t data_max_size;
+            uint16_t *data_read_size;
+        } r_mem_data_read;
+        struct {
+            uint16_t udata_slot;
+        } r_mem_data_erase;
+        struct {
+            uint8_t *rnd_bytes;
+            uint16_t rnd_bytes_cnt;
+        } random_value_get;
+        struct {
+            lt_ecc_slot_t slot;
+            lt_ecc_curve_type_t curve;
+        } ecc_key_generate;
+        struct {
+            lt_ecc_slot_t slot;
+            lt_ecc_curve_type_t curve;
+            const uint8_t *key;
+        } ecc_key_store;
+        struct {
+            lt_ecc_slot_t slot;
+            uint8_t *key;
+            uint8_t key_max_size;
+            lt_ecc_curve_type_t *curve;
+            lt_ecc_key_origin_t *origin;
+        } ecc_key_read;
+        struct {
+            lt_ecc_slot_t slot;
+        } ecc_key_erase;
+        struct {
+            lt_ecc_slot_t slot;
+            const uint8_t *msg;
+            uint32_t msg_len;
+            uint8_t *rs;
+        } ecdsa_sign;
+        struct {
+            lt_ecc_slot_t slot;
+            const uint8_t *msg;
+            uint16_t msg_len;
+            uint8_t *rs;
+        } eddsa_sign;
+        struct {
+            enum lt_mcounter_index_t mcounter_index;
+            uint32_t mcounter_value;
+        } mcounter_init;
+        struct {
+            enum lt_mcounter_index_t mcounter_index;
+        } mcounter_update;
+        struct {
+            enum lt_mcounter_index_t mcounter_index;
+            uint32_t *mcounter_value;
+        } mcounter_get;
+        struct {
+            lt_mac_and_destroy_slot_t slot;
+            const uint8_t *data_out;
+            uint8_t *data_in;
+        } mac_and_destroy;
+    } args;
+    lt_ret_t ret; /**< Result of the command, LT_BATCH_NOT_EXECUTED when it was not attempted */
+} lt_batch_cmd_t;
+
 //--------------------------------------------------------------------------------------------------------------------//
 /** @brief Maximal size of returned serial code */
 #define TR01_SERIAL_CODE_SIZE 32u
@@ -996,14 +1320,6 @@ typedef struct lt_config_obj_desc_t {
     enum lt_config_obj_addr_t addr;
 } lt_config_obj_desc_t;
 
-/** @brief Number of configuration objects in lt_config_t */
-#define LT_CONFIG_OBJ_CNT 27
-
-/** @brief Structure to hold all configuration objects */
-typedef struct lt_config_t {
-    uint32_t obj[LT_CONFIG_OBJ_CNT];
-} lt_config_t;
-
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,115 @@
+#ifndef LIBTROPIC_FLEET_H
+#define LIBTROPIC_FLEET_H
+
+/**
+ * @defgroup libtropic_fleet 1.4. Libtropic API: Fleet Firmware Update
+ * @brief Firmware update of many TROPIC01 chips
+ * @details lt_fleet_update_chip() runs the whole update of one chip: reboot into Maintenance mode, check of the
+ * versions in all firmware banks, update of the banks which do not hold the target version, check of the bank headers
+ * and reboot back into Application mode with check of the running versions. Chips which already hold the target
+ * versions in all banks are only rebooted back.
+ *
+ * The function touches only the passed chip's handle, so updates of different chips can run in parallel, e.g. with
+ * lt_unix_fleet_update() from hal/port/unix/libtropic_port_unix_fleet.h, which runs them in a pool of threads.
+ *
+ * Requires LT_HELPERS.
+ * @{
+ */
+
+/**
+ * @file libtropic_fleet.h
+ * @brief Fleet firmware update declarations
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdint.h>
+
+#include "libtropic_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Stage of a chip's update. */
+typedef enum lt_fleet_stage_t {
+    LT_FLEET_PENDING = 0,        /**< Update did not start yet */
+    LT_FLEET_MAINTENANCE_REBOOT, /**< Rebooting into Maintenance mode */
+    LT_FLEET_VERSION_CHECK,      /**< Reading headers of firmware banks */
+    LT_FLEET_UPDATE_CPU,         /**< Writing RISC-V firmware */
+    LT_FLEET_UPDATE_SPECT,       /**< Writing SPECT firmware */
+    LT_FLEET_VERIFY,             /**< Checking bank headers and running versions */
+    LT_FLEET_DONE,               /**< Chip was updated */
+    LT_FLEET_UP_TO_DATE,         /**< All banks already held the target versions */
+    LT_FLEET_FAILED              /**< Update failed, see `ret` and `failed_stage` */
+} lt_fleet_stage_t;
+
+/** @brief One firmware image of the set. */
+typedef struct lt_fleet_image_t {
+    /** @brief Source of the image. Shared by all chips, so its `read` callback has to be thread-safe when chips are
+     * updated in parallel. Its `progress` callback is not used. */
+    lt_fw_update_stream_t stream;
+    /** @brief Version the image contains, as in the bank header. Zero disables skipping of up-to-date banks. */
+    uint32_t version;
+} lt_fleet_image_t;
+
+struct lt_fleet_chip_t;
+
+/** @brief Firmware image set and reporting shared by all chips of the fleet. */
+typedef struct lt_fleet_t {
+    lt_fleet_image_t cpu;   /**< RISC-V firmware */
+    lt_fleet_image_t spect; /**< SPECT firmware */
+    /** @brief Number of times an interrupted image transfer is resumed before the chip fails. */
+    uint8_t retries;
+    /** @brief Optional, called on every stage change of a chip. */
+    void (*status)(void *ctx, const struct lt_fleet_chip_t *chip);
+    /** @brief Passed to `status`. */
+    void *ctx;
+} lt_fleet_t;
+
+/** @brief Update state of one chip. */
+typedef struct lt_fleet_chip_t {
+    /** @brief Device's handle, initialized by lt_init(). */
+    lt_handle_t *h;
+    /** @brief Current stage. */
+    lt_fleet_stage_t stage;
+    /** @brief Stage in which the update failed. */
+    lt_fleet_stage_t failed_stage;
+    /** @brief Result of the update. */
+    lt_ret_t ret;
+    /** @brief Number of images written. */
+    uint8_t written_cnt;
+    /** @brief Progress of the image being written. */
+    lt_fw_update_progress_t progress;
+} lt_fleet_chip_t;
+
+/**
+ * @brief Updates firmware of one chip to the image set of the fleet.
+ * @details Bank 1 and bank 2 of both firmwares are updated in two Maintenance mode sessions, like in
+ * lt_ex_fw_update(). The result is also stored in `chip->ret` and `chip->stage`.
+ *
+ * @param fleet  Image set
+ * @param chip   Chip to be updated
+ *
+ * @retval       LT_OK Function executed successfully
+ * @retval       other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding of
+ * returned value
+ */
+lt_ret_t lt_fleet_update_chip(const lt_fleet_t *fleet, lt_fleet_chip_t *chip);
+
+/**
+ * @brief Returns name of a stage.
+ *
+ * @param stage  Stage
+ * @return       Name of the stage
+ */
+const char *lt_fleet_stage_str(const lt_fleet_stage_t stage);
+
+/** @} */  // end of group libtropic_fleet
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LIBTROPIC_FLEET_H
@@ -15,7 +15,9 @@
  * @license For the license see file LICENSE.txt file in the root directory of this source tree.
  */
 
+#include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include "libtropic_common.h"
 
@@ -76,6 +78,19 @@ void lt_assert_fail_handler(void);
         LT_LOG_INFO("TEST FINISHED!"); \
     }
 
+// Assertion for standalone host tests (tropic01_model/tests/, tools/*/tests/), whose test functions return bool.
+// Prints the failed condition and makes the calling function return false, the caller decides how to clean up.
+#define LT_TEST_TRUE(cond)                                            \
+    do {                                                              \
+        if (!(cond)) {                                                \
+            printf("FAIL [%4d] %s does not hold\n", __LINE__, #cond); \
+            return false;                                             \
+        }                                                             \
+    } while (0)
+
+// Seed of emulators and fault generators in standalone host tests, fixed so failures can be reproduced.
+#define LT_TEST_SEED 0x5eed
+
 #ifndef LT_EXAMPLE_TEST_KEYS_DECLARED
 #define LT_EXAMPLE_TEST_KEYS_DECLARED
 extern uint8_t sh0priv[];
@@ -236,12 +251,51 @@ void lt_test_rev_ping(lt_handle_t *h);
  *      - if the random length is 0, check that write fails.
  *  9. Read all slots and check if they were written.
  *      - if the random length is 0, check that read fails (slot empty).
- *  10. Erase all slots and check that reading fails.
+ *  10. Erase all slots using lt_r_mem_data_erase_range().
+ *      - with LT_SLOT_INVENTORY, scan the inventory, allocate, write and erase a slot and check the inventory.
+ *  11. Write several slots at once using lt_r_mem_data_write_vec().
+ *  12. Read them using lt_r_mem_data_read_range() and check if they were written.
+ *  13. Erase them using lt_r_mem_data_erase_range() and check that ranged read reports empty slots.
+ *  14. Erase all slots and check that reading fails.
  *
  * @param h     Device's handle
  */
 void lt_test_rev_r_mem(lt_handle_t *h);
 
+/**
+ * @brief Test key-value store over R memory (slots 0 - 15)
+ *
+ * Test steps:
+ *  1. Start Secure Session with pairing key slot 0.
+ *  2. Erase the slots and open an empty store, check that reading a key fails.
+ *  3. Store a short and a multi-slot value and read them back.
+ *  4. Update the short value, reopen the store and check both values.
+ *  5. Compact the store and check the number of stale slots.
+ *  6. Update the multi-slot value until the store wraps around, reopen it and check the value.
+ *  7. Delete the short value, reopen the store and check that it does not reappear.
+ *  8. Erase the slots.
+ *
+ * @param h     Device's handle
+ */
+void lt_test_rev_kv(lt_handle_t *h);
+
+/**
+ * @brief Test R memory write-back cache (slot 0)
+ *
+ * Test steps:
+ *  1. Start Secure Session with pairing key slot 0.
+ *  2. Erase the slot, initialize the cache and check that reading the slot through the cache fails.
+ *  3. Write the slot through the cache several times and read it back after each write.
+ *  4. Check that the slot in R memory is still empty.
+ *  5. Advance the cache clock to the flush interval and check that only one NVM write was done.
+ *  6. Read the slot directly and check its contents.
+ *  7. Erase the slot through the cache, sync and check that the slot is empty.
+ *  8. Erase the slot.
+ *
+ * @param h     Device's handle
+ */
+void lt_test_rev_r_mem_cache(lt_handle_t *h);
+
 /**
  * @brief Backs up R-Config, erases it and then restores it.
  *
@@ -328,8 +382,10 @@ void lt_test_rev_read_i_config(lt_handle_t *h);
  *
  * Test steps:
  *  1. Start Secure Session with pairing key slot 0.
- *  2. Write the whole I-Config with random data.
- *  3. Read the whole I-Config and check that it was written.
+ *  2. Get number of bits to be cleared with a dry run.
+ *  3. Write the whole I-Config with random data.
+ *  4. Check that a dry run reports no bits left to be cleared.
+ *  5. Read the whole I-Config and check that it was written.
  *
  * @param h     Device's handle
  */
@@ -404,7 +460,8 @@ void lt_test_rev_startup_req(lt_handle_t *h);
  *  3. Erase the R-config.
  *  4. Write the whole R-Config with random data and check it.
  *  5. Write the whole R-Config again and check for an error.
- *  6. Restore the R-Config and check it.
+ *  6. Load R-Config mirror, change one field, commit it and check R-Config.
+ *  7. Restore the R-Config and check it.
  *
  * @param h     Device's handle
  */
@@ -453,6 +510,8 @@ void lt_test_rev_ecc_key_store(lt_handle_t *h);
  *     used in the Random_Value_Get command.
  *  3. Get random count (from step 2) of random bytes from TROPIC01.
  *  4. Dump the random bytes from TROPIC01 into the log.
+ *  5. Get random count (up to 2000) of random bytes with lt_random_fill() and dump them into the log.
+ *  6. Seed host DRBG from TROPIC01 and generate random bytes with it, crossing several reseeds.
  *
  * @param h     Device's handle
  */
@@ -475,6 +534,55 @@ void lt_test_rev_random_value_get(lt_handle_t *h);
  */
 void lt_test_rev_mac_and_destroy(lt_handle_t *h);
 
+/**
+ * @brief Tests MAC-and-Destroy PIN verification module (R memory slot 0, MAC-and-Destroy slots 0-4).
+ *
+ * Test steps:
+ *  1. Start Secure Session with pairing key slot 0.
+ *  2. Erase the R memory slot and check that there is no record.
+ *  3. Set up a PIN with random master secret and additional data, check the number of attempts.
+ *  4. Check the correct PIN twice and compare the released keys with the one from the setup.
+ *  5. Check a wrong PIN and missing additional data, check that two attempts were consumed.
+ *  6. Check the correct PIN and check that all attempts were restored.
+ *  7. Use up all attempts with a wrong PIN and check that the correct PIN is refused.
+ *  8. Erase the R memory slot.
+ *
+ * @param h     Device's handle
+ */
+void lt_test_rev_macandd_pin(lt_handle_t *h);
+
+/**
+ * @brief Tests certificate chain verification.
+ *
+ * Test steps:
+ *  1. Verify a built-in test chain signed with P-256 and Ed25519 keys, without and with a cache.
+ *  2. Check that the test chain is refused outside its validity, against a different anchor and with a corrupted
+ *     signature of each certificate.
+ *  3. Read the Certificate Store and verify the chip's chain against its own root, passing signatures without support
+ *     in the crypto HAL to a stub callback.
+ *  4. Start Secure Session with the chain verification and check that the cache skipped the signature checks.
+ *  5. Ping TROPIC01 in the Secure Session.
+ *
+ * @param h     Device's handle
+ */
+void lt_test_rev_cert_chain(lt_handle_t *h);
+
+/**
+ * @brief Tests L3 command batch executor (R memory slot 0, ECC key slot 0, monotonic counter 0).
+ *
+ * Test steps:
+ *  1. Start Secure Session with pairing key slot 0.
+ *  2. Check that batches with a too small stage buffer, an invalid ECC slot or no stage buffer are refused and that
+ *     Secure Session is still usable.
+ *  3. Execute a batch of Ping, R memory, Random_Value_Get, monotonic counter and ECC commands and check all results.
+ *  4. Execute a batch with a failing R memory read, continuing on error, and check that all commands were executed.
+ *  5. Execute the same batch stopping on error and check that only the command already sent was completed.
+ *  6. Erase the slots and reset the monotonic counter.
+ *
+ * @param h     Device's handle
+ */
+void lt_test_rev_batch(lt_handle_t *h);
+
 /**
  * @brief Tests Get_Log_Req command in Application and Maintenance mode.
  *
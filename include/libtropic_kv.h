@@ -0,0 +1,175 @@
+#ifndef LIBTROPIC_KV_H
+#define LIBTROPIC_KV_H
+
+/**
+ * @defgroup libtropic_kv 1.2. Libtropic API: Key-Value Store
+ * @brief Key-value store on top of the User Partition of R memory
+ * @details Records are appended into R memory slots from a range given to lt_kv_open(). A record occupies a head slot
+ * (header, key, value length, list of other slots, first part of the value) and up to `LT_KV_FRAG_CNT_MAX - 1`
+ * continuation slots. Continuation slots are written first and the head slot last, so a record becomes visible
+ * atomically with its head. Every record carries a sequence number; the newest record of a key whose slots are all
+ * intact wins.
+ *
+ * Updating a key writes a new record and only marks the slots of the old one as stale. Stale slots are erased by
+ * lt_kv_compact(), which the application should call when it is idle, or by lt_kv_put() when no free slot is left.
+ * Slots are allocated round-robin starting after the newest record to spread wear, and slots reported as expired by
+ * TROPIC01 are skipped until the next lt_kv_open().
+ *
+ * The index of live records is kept in RAM (lt_kv_t) and is rebuilt by lt_kv_open() with one pipelined scan of the
+ * range.
+ * @{
+ */
+
+/**
+ * @file libtropic_kv.h
+ * @brief Key-value store over R memory declarations
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdint.h>
+
+#include "libtropic_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef LT_KV_KEY_SIZE_MAX
+/** @brief Maximal length of a key in bytes. */
+#define LT_KV_KEY_SIZE_MAX 16
+#endif
+
+#ifndef LT_KV_ENTRY_CNT_MAX
+/** @brief Maximal number of keys held by one store. */
+#define LT_KV_ENTRY_CNT_MAX 32
+#endif
+
+#ifndef LT_KV_FRAG_CNT_MAX
+/** @brief Maximal number of slots occupied by one record (head slot included). */
+#define LT_KV_FRAG_CNT_MAX 8
+#endif
+
+/** @brief Number of 32-bit words in a bitmap covering all R memory slots. */
+#define LT_KV_BITMAP_WORDS ((TR01_R_MEM_DATA_SLOT_MAX + 1 + 31) / 32)
+
+/** @brief One key in the RAM index. */
+typedef struct lt_kv_entry_t {
+    uint8_t key[LT_KV_KEY_SIZE_MAX];      /**< Key */
+    uint8_t key_len;                      /**< Length of the key, 0 when the entry is unused */
+    uint8_t frag_cnt;                     /**< Number of slots occupied by the record */
+    uint16_t value_len;                   /**< Length of the value */
+    uint32_t seq;                         /**< Sequence number of the record */
+    uint16_t slots[LT_KV_FRAG_CNT_MAX];   /**< Slots of the record, head slot first */
+} lt_kv_entry_t;
+
+/**
+ * @brief Key-value store state.
+ * @details Bitmaps are indexed by slot number relative to `first_slot`.
+ */
+typedef struct lt_kv_t {
+    lt_handle_t *h;                            /**< Device's handle */
+    uint16_t first_slot;                       /**< First R memory slot of the store */
+    uint16_t slot_cnt;                         /**< Number of R memory slots of the store */
+    uint16_t cursor;                           /**< Next slot to be considered by the allocator */
+    uint32_t seq;                              /**< Sequence number of the newest record */
+    uint32_t used[LT_KV_BITMAP_WORDS];         /**< Slot is not empty */
+    uint32_t live[LT_KV_BITMAP_WORDS];         /**< Slot belongs to a record in the index */
+    uint32_t head[LT_KV_BITMAP_WORDS];         /**< Slot holds a valid record head */
+    uint32_t expired[LT_KV_BITMAP_WORDS];      /**< Slot was reported as expired by TROPIC01 */
+    lt_kv_entry_t entries[LT_KV_ENTRY_CNT_MAX]; /**< Index of live records */
+} lt_kv_t;
+
+/**
+ * @brief Opens a store in R memory slots `first_slot` to `first_slot + slot_cnt - 1` and rebuilds its index.
+ * @details Slots in the range which do not hold a valid record are treated as stale and erased by lt_kv_compact().
+ * When a slot of the newest record of a key is missing, the newest older record of the key which is still intact is
+ * used.
+ * @note Secure Session must be established and kept for the whole lifetime of the store.
+ *
+ * @param kv          Store to be initialized
+ * @param h           Device's handle
+ * @param first_slot  First slot of the store
+ * @param slot_cnt    Number of slots of the store
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            LT_KV_FULL More keys are stored than `LT_KV_ENTRY_CNT_MAX`
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_kv_open(lt_kv_t *kv, lt_handle_t *h, const uint16_t first_slot, const uint16_t slot_cnt);
+
+/**
+ * @brief Reads value of a key.
+ *
+ * @param kv              Store
+ * @param key             Key
+ * @param key_len         Length of the key (1 - LT_KV_KEY_SIZE_MAX)
+ * @param value           Buffer for the value
+ * @param value_max_size  Size of the buffer
+ * @param value_len       Length of the value
+ *
+ * @retval                LT_OK Function executed successfully
+ * @retval                LT_KV_KEY_NOT_FOUND Key is not in the store
+ * @retval                other Function did not execute successully, you might use lt_ret_verbose() to get verbose
+ * encoding of returned value
+ */
+lt_ret_t lt_kv_get(lt_kv_t *kv, const uint8_t *key, const uint8_t key_len, uint8_t *value,
+                   const uint16_t value_max_size, uint16_t *value_len);
+
+/**
+ * @brief Stores value of a key, replacing the previous one.
+ * @details Slots of the previous value become stale, they are not erased.
+ *
+ * @param kv          Store
+ * @param key         Key
+ * @param key_len     Length of the key (1 - LT_KV_KEY_SIZE_MAX)
+ * @param value       Value, can be NULL when `value_len` is 0
+ * @param value_len   Length of the value, limited by `LT_KV_FRAG_CNT_MAX`
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            LT_KV_FULL No free index entry or not enough free slots even after compaction
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_kv_put(lt_kv_t *kv, const uint8_t *key, const uint8_t key_len, const uint8_t *value,
+                   const uint16_t value_len);
+
+/**
+ * @brief Removes a key from the store.
+ * @details Older heads of the key which were not compacted yet are erased first, so the key cannot reappear after the
+ * next lt_kv_open().
+ *
+ * @param kv          Store
+ * @param key         Key
+ * @param key_len     Length of the key (1 - LT_KV_KEY_SIZE_MAX)
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            LT_KV_KEY_NOT_FOUND Key is not in the store
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_kv_delete(lt_kv_t *kv, const uint8_t *key, const uint8_t key_len);
+
+/**
+ * @brief Erases stale slots, at most `max_erase_cnt` of them.
+ * @details Meant to be called repeatedly while the application is idle.
+ *
+ * @param kv             Store
+ * @param max_erase_cnt  Maximal number of slots erased by this call
+ * @param stale_cnt      Number of stale slots left, can be NULL
+ *
+ * @retval               LT_OK Function executed successfully
+ * @retval               other Function did not execute successully, you might use lt_ret_verbose() to get verbose
+ * encoding of returned value
+ */
+lt_ret_t lt_kv_compact(lt_kv_t *kv, const uint16_t max_erase_cnt, uint16_t *stale_cnt);
+
+/** @} */  // end of group libtropic_kv
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LIBTROPIC_KV_H
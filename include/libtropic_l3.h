@@ -152,6 +152,14 @@ lt_ret_t lt_out__pairing_key_invalidate(lt_handle_t *h, const uint8_t slot);
  */
 lt_ret_t lt_in__pairing_key_invalidate(lt_handle_t *h);
 
+/**
+ * @brief Checks that an address belongs to a configuration object, as lt_out__X() of config commands do.
+ *
+ * @param addr        Address of a config object
+ * @return            true if the address is valid, otherwise false.
+ */
+bool lt_conf_addr_valid(const enum lt_config_obj_addr_t addr);
+
 /**
  * @brief Encodes R_Config_Write command payload.
  * @note Used for separate L3 communication, for more information read info
@@ -461,6 +469,18 @@ lt_ret_t lt_in__ecc_key_erase(lt_handle_t *h);
  */
 lt_ret_t lt_out__ecc_ecdsa_sign(lt_handle_t *h, const lt_ecc_slot_t slot, const uint8_t *msg, const uint32_t msg_len);
 
+/**
+ * @brief Encodes ECDSA_Sign command payload from an already computed message hash.
+ * @note Used for separate L3 communication, for more information read info
+ * at the top of this file.
+ *
+ * @param h           Device's handle
+ * @param slot        ECC key slot to use for signing
+ * @param msg_hash    SHA256 hash of the message (TR01_ECDSA_SIGN_HASH_LEN bytes)
+ * @return            LT_OK if success, otherwise returns other error code.
+ */
+lt_ret_t lt_out__ecc_ecdsa_sign_hash(lt_handle_t *h, const lt_ecc_slot_t slot, const uint8_t *msg_hash);
+
 /**
  * @brief Decodes ECDSA_Sign result payload.
  * @note Used for separate L3 communication, for more information read info at
@@ -0,0 +1,145 @@
+#ifndef LIBTROPIC_MACANDD_H
+#define LIBTROPIC_MACANDD_H
+
+/**
+ * @defgroup libtropic_macandd 1.5. Libtropic API: MAC-and-Destroy PIN Verification
+ * @brief PIN verification engine built on TROPIC01's MAC_And_Destroy command
+ * @details Implements the scheme described in ODN_TR01_app_002_pin_verif.pdf. A PIN (optionally extended by additional
+ * data, e.g. a HW ID) protects a 32-byte master secret. One MAC-and-Destroy slot is consumed per PIN entry attempt;
+ * after `rounds` wrong attempts the master secret cannot be recovered anymore. A correct PIN restores all attempts.
+ *
+ * The host state is kept in a single R memory slot as a record with the following layout (multi-byte fields are little
+ * endian):
+ *
+ *   | Offset | Size       | Field                                                            |
+ *   |--------|------------|------------------------------------------------------------------|
+ *   | 0      | 2          | CRC16 over bytes 2..end                                          |
+ *   | 2      | 1          | Magic, `LT_MACANDD_RECORD_MAGIC`                                 |
+ *   | 3      | 1          | Format version, `LT_MACANDD_RECORD_VERSION`                      |
+ *   | 4      | 1          | Number of rounds n                                               |
+ *   | 5      | 1          | Attempts left i                                                  |
+ *   | 6      | 1          | First MAC-and-Destroy slot                                       |
+ *   | 7      | 1          | Reserved (0)                                                     |
+ *   | 8      | 32         | Tag t = HMAC(s, 0x00)                                            |
+ *   | 40     | 32 * n     | Ciphertexts c_0..c_(n-1), c_x = s XOR HMAC(w_x, PIN \|\| A)      |
+ *
+ * Derived values: u = HMAC(s, 0x01) initializes the slots, v = HMAC(0^32, PIN || A) is sent on PIN entry and the key
+ * released to the caller is HMAC(s, '2').
+ *
+ * With LT_THREAD_SAFE, each function holds the handle locked for its whole run, so commands of other threads cannot
+ * get between consuming an attempt and restoring the record.
+ * @{
+ */
+
+/**
+ * @file libtropic_macandd.h
+ * @brief MAC-and-Destroy PIN verification declarations
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdint.h>
+
+#include "libtropic_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Minimal size of the PIN. */
+#define LT_MACANDD_PIN_SIZE_MIN 4u
+/** @brief Maximal size of the PIN. */
+#define LT_MACANDD_PIN_SIZE_MAX 8u
+/** @brief Maximal size of the additional data. */
+#define LT_MACANDD_ADD_SIZE_MAX 128u
+/** @brief Size of the master secret. */
+#define LT_MACANDD_SECRET_SIZE TR01_MAC_AND_DESTROY_DATA_SIZE
+/** @brief Size of the key released after a successful setup or PIN check. */
+#define LT_MACANDD_KEY_SIZE 32u
+
+/** @brief Magic byte of the R memory record. */
+#define LT_MACANDD_RECORD_MAGIC 0x4D
+/** @brief Format version of the R memory record. */
+#define LT_MACANDD_RECORD_VERSION 1
+/** @brief Size of the record header (everything before the ciphertexts). */
+#define LT_MACANDD_RECORD_HDR_LEN 40
+/** @brief Size of the record for a given number of rounds. */
+#define LT_MACANDD_RECORD_SIZE(rounds) (LT_MACANDD_RECORD_HDR_LEN + (rounds) * TR01_MAC_AND_DESTROY_DATA_SIZE)
+/** @brief Maximal number of rounds, limited by the size of one R memory slot. */
+#define LT_MACANDD_ROUNDS_MAX ((TR01_R_MEM_DATA_SIZE_MAX - LT_MACANDD_RECORD_HDR_LEN) / TR01_MAC_AND_DESTROY_DATA_SIZE)
+
+/**
+ * @brief Sets up a new PIN.
+ * @details Initializes MAC-and-Destroy slots `first_slot` to `first_slot + rounds - 1` and stores the record into
+ * `r_mem_slot`, which is erased first. The 3 * `rounds` MAC_And_Destroy commands are sent as one pipelined batch, keys
+ * k_x are derived while TROPIC01 processes the next command.
+ * @note Secure Session must be established.
+ *
+ * @param h              Device's handle
+ * @param r_mem_slot     R memory slot for the record
+ * @param first_slot     First MAC-and-Destroy slot
+ * @param rounds         Number of PIN entry attempts (1 - LT_MACANDD_ROUNDS_MAX)
+ * @param master_secret  LT_MACANDD_SECRET_SIZE bytes of random data, determines `final_key`
+ * @param pin            PIN
+ * @param pin_size       Size of the PIN (LT_MACANDD_PIN_SIZE_MIN - LT_MACANDD_PIN_SIZE_MAX)
+ * @param add            Additional data, NULL if not used
+ * @param add_size       Size of the additional data (0 - LT_MACANDD_ADD_SIZE_MAX)
+ * @param final_key      Buffer for LT_MACANDD_KEY_SIZE bytes of the released key, zeroed on failure
+ *
+ * @retval               LT_OK Function executed successfully
+ * @retval               other Function did not execute successully, you might use lt_ret_verbose() to get verbose
+ * encoding of returned value
+ */
+lt_ret_t lt_macandd_setup(lt_handle_t *h, const uint16_t r_mem_slot, const lt_mac_and_destroy_slot_t first_slot,
+                          const uint8_t rounds, const uint8_t *master_secret, const uint8_t *pin,
+                          const uint8_t pin_size, const uint8_t *add, const uint8_t add_size, uint8_t *final_key);
+
+/**
+ * @brief Checks an entered PIN and releases the key on success.
+ * @details The decremented attempt counter is stored before the MAC_And_Destroy command is sent, so an interrupted
+ * check still consumes the attempt. On success all consumed slots are initialized again (as one pipelined batch) and
+ * the counter is restored.
+ * @note Secure Session must be established.
+ *
+ * @param h           Device's handle
+ * @param r_mem_slot  R memory slot with the record
+ * @param pin         PIN
+ * @param pin_size    Size of the PIN (LT_MACANDD_PIN_SIZE_MIN - LT_MACANDD_PIN_SIZE_MAX)
+ * @param add         Additional data, NULL if not used
+ * @param add_size    Size of the additional data (0 - LT_MACANDD_ADD_SIZE_MAX)
+ * @param final_key   Buffer for LT_MACANDD_KEY_SIZE bytes of the released key, zeroed on failure
+ *
+ * @retval            LT_OK PIN is correct
+ * @retval            LT_MACANDD_WRONG_PIN PIN is wrong, one attempt was consumed
+ * @retval            LT_MACANDD_NO_ATTEMPTS No attempts are left
+ * @retval            LT_MACANDD_RECORD_INVALID The slot does not hold a valid record
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_macandd_check(lt_handle_t *h, const uint16_t r_mem_slot, const uint8_t *pin, const uint8_t pin_size,
+                          const uint8_t *add, const uint8_t add_size, uint8_t *final_key);
+
+/**
+ * @brief Reads number of PIN entry attempts left.
+ * @note Secure Session must be established.
+ *
+ * @param h           Device's handle
+ * @param r_mem_slot  R memory slot with the record
+ * @param attempts    Number of attempts left
+ * @param rounds      Number of attempts after a successful check, can be NULL
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            LT_MACANDD_RECORD_INVALID The slot does not hold a valid record
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_macandd_attempts_get(lt_handle_t *h, const uint16_t r_mem_slot, uint8_t *attempts, uint8_t *rounds);
+
+/** @} */  // end of group libtropic_macandd
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LIBTROPIC_MACANDD_H
@@ -87,6 +87,7 @@ lt_ret_t lt_port_spi_transfer(lt_l2_state_t *s2, uint8_t offset, uint16_t tx_len
 /**
  * @brief Platform defined function for delay, specifies what host platform should do when libtropic's functions need
  * some delay.
+ * @details With a virtual clock (`s2->clock.is_virtual`), the function has to return at once without waiting.
  *
  * @param s2          Structure holding l2 state
  * @param ms          Time to wait in miliseconds
@@ -100,6 +101,7 @@ lt_ret_t lt_port_delay(lt_l2_state_t *s2, uint32_t ms);
 /**
  * @brief Platform defined function used to specify reading of an interrupt pin, used as a signal that chip has a
  * response.
+ * @details With a virtual clock (`s2->clock.is_virtual`), the function has to return at once without waiting.
  *
  * @param s2          Structure holding l2 state
  * @param ms          Max time to wait in miliseconds
@@ -121,6 +123,51 @@ lt_ret_t lt_port_delay_on_int(lt_l2_state_t *s2, uint32_t ms);
  */
 lt_ret_t lt_port_random_bytes(lt_l2_state_t *s2, void *buff, size_t count);
 
+#if LT_THREAD_SAFE
+/**
+ * @brief Creates a recursive mutex, platform defined function. Needed only with LT_THREAD_SAFE.
+ * @details The mutex has to be recursive: functions of libtropic.h lock it and some of them call others. On Unix,
+ * hal/port/unix/libtropic_port_unix_mutex.c implements the mutex functions with pthreads, on an RTOS they map e.g. to
+ * a recursive mutex of FreeRTOS.
+ *
+ * @param mutex       Created mutex
+ *
+ * @retval            LT_OK   Function executed successfully
+ * @retval            LT_FAIL Function did not execute successully
+ */
+lt_ret_t lt_port_mutex_init(void **mutex);
+
+/**
+ * @brief Destroys a mutex created by lt_port_mutex_init(), platform defined function.
+ *
+ * @param mutex       Mutex, set to NULL
+ *
+ * @retval            LT_OK   Function executed successfully
+ * @retval            LT_FAIL Function did not execute successully
+ */
+lt_ret_t lt_port_mutex_deinit(void **mutex);
+
+/**
+ * @brief Locks a mutex, waiting until it is available, platform defined function.
+ *
+ * @param mutex       Mutex
+ *
+ * @retval            LT_OK   Function executed successfully
+ * @retval            LT_FAIL Function did not execute successully
+ */
+lt_ret_t lt_port_mutex_lock(void *mutex);
+
+/**
+ * @brief Unlocks a mutex locked by lt_port_mutex_lock(), platform defined function.
+ *
+ * @param mutex       Mutex
+ *
+ * @retval            LT_OK   Function executed successfully
+ * @retval            LT_FAIL Function did not execute successully
+ */
+lt_ret_t lt_port_mutex_unlock(void *mutex);
+#endif
+
 /** @} */  // end of group_port_functions
 
 #ifdef __cplusplus
@@ -0,0 +1,176 @@
+#ifndef LIBTROPIC_R_MEM_CACHE_H
+#define LIBTROPIC_R_MEM_CACHE_H
+
+/**
+ * @defgroup libtropic_r_mem_cache 1.3. Libtropic API: R Memory Write-Back Cache
+ * @brief Write-back cache of User Partition slots of R memory
+ * @details The cache holds whole slots in lines provided by the application. Reads are served from RAM after the
+ * first load, writes only update the line and mark it dirty. Repeated writes to the same slot are coalesced into a
+ * single R_Mem_Data_Erase + R_Mem_Data_Write when the line is flushed, which happens:
+ *  - on lt_r_mem_cache_sync(),
+ *  - on lt_r_mem_cache_tick() for lines dirty for at least `flush_interval_ms`,
+ *  - when the number of dirty lines reaches `dirty_threshold`,
+ *  - when a dirty line has to be evicted to load another slot.
+ *
+ * Reads through the cache always return the latest data written through the cache (read-your-writes). Slots must not
+ * be accessed directly with lt_r_mem_data_* functions while they are cached, otherwise the cache gets stale.
+ * @{
+ */
+
+/**
+ * @file libtropic_r_mem_cache.h
+ * @brief R memory write-back cache declarations
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "libtropic_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief One cached slot. */
+typedef struct lt_r_mem_cache_line_t {
+    bool valid;                             /**< Line holds a slot */
+    bool dirty;                             /**< Content differs from R memory */
+    bool chip_empty;                        /**< Slot in R memory is known to be empty */
+    uint16_t slot;                          /**< Cached slot */
+    uint16_t len;                           /**< Length of data, 0 when the slot is empty */
+    uint32_t last_use;                      /**< Access counter value of the last access, for LRU eviction */
+    uint32_t dirty_since_ms;                /**< Time of the first write since the last flush */
+    uint8_t data[TR01_R_MEM_DATA_SIZE_MAX]; /**< Slot data */
+} lt_r_mem_cache_line_t;
+
+/** @brief Cache statistics. NVM writes saved by coalescing equal `writes - nvm_writes`. */
+typedef struct lt_r_mem_cache_stats_t {
+    uint32_t read_hits;   /**< Reads served from RAM */
+    uint32_t read_misses; /**< Reads which loaded the slot from R memory */
+    uint32_t writes;      /**< Writes and erases requested by the application */
+    uint32_t nvm_writes;  /**< R_Mem_Data_Write commands sent on flush */
+    uint32_t nvm_erases;  /**< R_Mem_Data_Erase commands sent on flush */
+} lt_r_mem_cache_stats_t;
+
+/** @brief Cache state. */
+typedef struct lt_r_mem_cache_t {
+    lt_handle_t *h;                 /**< Device's handle */
+    lt_r_mem_cache_line_t *lines;   /**< Lines provided by the application */
+    uint16_t line_cnt;              /**< Number of lines */
+    uint16_t dirty_cnt;             /**< Number of dirty lines */
+    uint16_t dirty_threshold;       /**< Flush all dirty lines when this many are dirty, 0 disables */
+    uint32_t flush_interval_ms;     /**< Flush lines dirty for this long in lt_r_mem_cache_tick(), 0 disables */
+    uint32_t now_ms;                /**< Time passed to the last lt_r_mem_cache_tick() */
+    uint32_t use_cnt;               /**< Access counter */
+    lt_r_mem_cache_stats_t stats;   /**< Statistics */
+} lt_r_mem_cache_t;
+
+/**
+ * @brief Initializes the cache.
+ *
+ * @param cache              Cache
+ * @param h                  Device's handle
+ * @param lines              Lines for the cache
+ * @param line_cnt           Number of lines
+ * @param dirty_threshold    Number of dirty lines which triggers flush of all dirty lines, 0 disables
+ * @param flush_interval_ms  Age of dirty lines flushed by lt_r_mem_cache_tick(), 0 disables
+ *
+ * @retval                   LT_OK Function executed successfully
+ * @retval                   other Function did not execute successully, you might use lt_ret_verbose() to get verbose
+ * encoding of returned value
+ */
+lt_ret_t lt_r_mem_cache_init(lt_r_mem_cache_t *cache, lt_handle_t *h, lt_r_mem_cache_line_t *lines,
+                             const uint16_t line_cnt, const uint16_t dirty_threshold,
+                             const uint32_t flush_interval_ms);
+
+/**
+ * @brief Reads a slot through the cache.
+ *
+ * @param cache           Cache
+ * @param udata_slot      Memory's slot
+ * @param data            Buffer for the data
+ * @param data_max_size   Size of the buffer
+ * @param data_read_size  Number of bytes read
+ *
+ * @retval                LT_OK Function executed successfully
+ * @retval                LT_L3_R_MEM_DATA_READ_SLOT_EMPTY Slot is empty
+ * @retval                other Function did not execute successully, you might use lt_ret_verbose() to get verbose
+ * encoding of returned value
+ */
+lt_ret_t lt_r_mem_cache_read(lt_r_mem_cache_t *cache, const uint16_t udata_slot, uint8_t *data,
+                             const uint16_t data_max_size, uint16_t *data_read_size);
+
+/**
+ * @brief Replaces content of a slot in the cache.
+ * @details Unlike lt_r_mem_data_write(), the slot does not have to be empty. Writing the data already cached does not
+ * make the line dirty.
+ *
+ * @param cache       Cache
+ * @param udata_slot  Memory's slot
+ * @param data        Data
+ * @param data_size   Size of data (TR01_R_MEM_DATA_SIZE_MIN - TR01_R_MEM_DATA_SIZE_MAX)
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_r_mem_cache_write(lt_r_mem_cache_t *cache, const uint16_t udata_slot, const uint8_t *data,
+                              const uint16_t data_size);
+
+/**
+ * @brief Erases a slot in the cache.
+ *
+ * @param cache       Cache
+ * @param udata_slot  Memory's slot
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_r_mem_cache_erase(lt_r_mem_cache_t *cache, const uint16_t udata_slot);
+
+/**
+ * @brief Flushes all dirty lines into R memory.
+ *
+ * @param cache       Cache
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_r_mem_cache_sync(lt_r_mem_cache_t *cache);
+
+/**
+ * @brief Advances the cache clock and flushes lines which are dirty for at least `flush_interval_ms`.
+ * @details Meant to be called periodically by the application with a monotonic millisecond time.
+ *
+ * @param cache       Cache
+ * @param now_ms      Current time in milliseconds
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_r_mem_cache_tick(lt_r_mem_cache_t *cache, const uint32_t now_ms);
+
+/**
+ * @brief Drops all lines without flushing them, e.g. after the slots were changed by other means.
+ *
+ * @param cache       Cache
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_r_mem_cache_invalidate(lt_r_mem_cache_t *cache);
+
+/** @} */  // end of group libtropic_r_mem_cache
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LIBTROPIC_R_MEM_CACHE_H
@@ -1,14 +1,25 @@
 import argparse
 import pathlib
 import subprocess
-import yaml
 import time
 import sys
 import socket
 import os
 
-def wait_for_server_start(host="127.0.0.1", port=28992, retry_interval=0.2, max_attempts=10) -> bool:
+# Host of the servers, a test finds its server through the LT_MODEL_PORT environment variable
+SERVER_HOST = "127.0.0.1"
+# Number of attempts to start a server, another process may take the chosen port first
+SERVER_START_ATTEMPTS = 3
+
+def free_port(host=SERVER_HOST) -> int:
+    with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as sock:
+        sock.bind((host, 0))
+        return sock.getsockname()[1]
+
+def wait_for_server_start(process, host=SERVER_HOST, port=28992, retry_interval=0.2, max_attempts=10) -> bool:
     for i in range(max_attempts):
+        if process.poll() is not None:
+            return False
         with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as sock:
             sock.settimeout(1.0)
             try:
@@ -22,7 +33,8 @@ def wait_for_server_start(host="127.0.0.1", port=28992, retry_interval=0.2, max_
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(
         prog = "test_runner.py",
-        description = "Runs the specified test against TROPIC01 model and saves all output to specified directory."
+        description = "Runs the specified test against its own instance of TROPIC01 model (or lt_emu_server) "
+                      "and saves all output to specified directory."
     )
 
     parser.add_argument(
@@ -39,6 +51,19 @@ if __name__ == "__main__":
         required=True
     )
 
+    parser.add_argument(
+        "--emulator",
+        help="Path to lt_emu_server, started instead of model_server.",
+        type=pathlib.Path
+    )
+
+    parser.add_argument(
+        "-p", "--port",
+        help="Port of the server, by default a free one is chosen, so several tests can run at once.",
+        type=int,
+        default=0
+    )
+
     parser.add_argument(
         "--use-valgrind",
         help="Runs the test with Valgrind.",
@@ -59,51 +84,72 @@ if __name__ == "__main__":
     model_cfg_path: pathlib.Path = args.model_cfg
     use_valgrind: bool = args.use_valgrind
     output_path: pathlib.Path = args.output_dir
+    emulator_path: pathlib.Path = args.emulator
     test_name = test_path.stem
 
     # Create destination directory if it doesn't exist yet
     output_path.mkdir(parents=True, exist_ok=True)
 
-    # Get the logging configuration from the model so we can modify it
-    dump_logging_cfg_res = subprocess.run(
-        ["model_server", "dump-logging-cfg"],
-        capture_output=True,
-        text=True,
-        check=True
-    )
-    # Transform the YAML output to a dictionary
-    model_log_cfg = yaml.safe_load(dump_logging_cfg_res.stdout)
-    # Change the default handler to a file
-    model_log_cfg["handlers"]["default"]["class"] = "logging.FileHandler"
-    model_log_cfg["handlers"]["default"]["filename"] = str(output_path.joinpath(f"{test_name}_model_response").with_suffix(".log"))
-    model_log_cfg["handlers"]["default"]["mode"] = "w"
-    model_log_cfg["handlers"]["default"]["encoding"] = "utf8"
-    # Change logging level to DEBUG
-    model_log_cfg["loggers"]["model"]["level"] = "DEBUG"
-    model_log_cfg["loggers"]["server"]["level"] = "DEBUG"
-    # Disable colors to prevent weird symbols in the .log file
-    model_log_cfg["formatters"]["default"]["use_colors"] = False
-
-    model_log_cfg_path = pathlib.Path("model_log_cfg_path.yml")
-    with model_log_cfg_path.open("w") as f:
-        yaml.dump(model_log_cfg, f, default_flow_style=False)
-    
-    # Start the model server
-    model_process = subprocess.Popen(
-        [
-            "model_server", "tcp",
-            "-c", f"{str(model_cfg_path)}",
-            "-l", f"{str(model_log_cfg_path)}"
-        ],
-        env=os.environ
-    )
+    server_log_path = output_path.joinpath(f"{test_name}_model_response").with_suffix(".log")
+    if emulator_path is None:
+        import yaml
+
+        # Get the logging configuration from the model so we can modify it
+        dump_logging_cfg_res = subprocess.run(
+            ["model_server", "dump-logging-cfg"],
+            capture_output=True,
+            text=True,
+            check=True
+        )
+        # Transform the YAML output to a dictionary
+        model_log_cfg = yaml.safe_load(dump_logging_cfg_res.stdout)
+        # Change the default handler to a file
+        model_log_cfg["handlers"]["default"]["class"] = "logging.FileHandler"
+        model_log_cfg["handlers"]["default"]["filename"] = str(server_log_path)
+        model_log_cfg["handlers"]["default"]["mode"] = "w"
+        model_log_cfg["handlers"]["default"]["encoding"] = "utf8"
+        # Change logging level to DEBUG
+        model_log_cfg["loggers"]["model"]["level"] = "DEBUG"
+        model_log_cfg["loggers"]["server"]["level"] = "DEBUG"
+        # Disable colors to prevent weird symbols in the .log file
+        model_log_cfg["formatters"]["default"]["use_colors"] = False
+
+        # One file per test, tests may run in parallel
+        model_log_cfg_path = output_path.joinpath(f"{test_name}_model_log_cfg").with_suffix(".yml")
+        with model_log_cfg_path.open("w") as f:
+            yaml.dump(model_log_cfg, f, default_flow_style=False)
 
-    # Wait for model server to start
-    if wait_for_server_start() == False:
-        print("Server did not start.")
+    # Start the server, every test gets its own one with a freshly provisioned chip
+    start_time = time.monotonic()
+    for attempt in range(SERVER_START_ATTEMPTS):
+        port = args.port if args.port else free_port()
+        if emulator_path is None:
+            server_cmd = ["model_server", "tcp",
+                          "-c", f"{str(model_cfg_path)}",
+                          "-l", f"{str(model_log_cfg_path)}",
+                          "-p", f"{port}"]
+            server_out = None
+        else:
+            server_cmd = [str(emulator_path), "-p", f"{port}"]
+            server_out = server_log_path.open("w")
+        model_process = subprocess.Popen(
+            server_cmd,
+            stdout=server_out, stderr=subprocess.STDOUT if server_out else None,
+            env=os.environ
+        )
+
+        # Wait for the server to start
+        if wait_for_server_start(model_process, port=port):
+            break
+        print(f"Server did not start on port {port}.")
+        model_process.kill()
+        model_process.wait()
+    else:
         sys.exit(1)
+    server_time = time.monotonic() - start_time
 
     # Execute the test
+    start_time = time.monotonic()
     ret = 0
     with output_path.joinpath(test_name).with_suffix(".log").open("w") as f:
         try: 
@@ -123,12 +169,20 @@ if __name__ == "__main__":
             subprocess.run(
                 args=test_cmd,
                 stdout=f, stderr=f,
-                env=os.environ,
+                env=dict(os.environ, LT_MODEL_ADDR=SERVER_HOST, LT_MODEL_PORT=str(port)),
                 check=True
             )
         except subprocess.CalledProcessError as e:
             ret = e.returncode
 
+    test_time = time.monotonic() - start_time
+
+    # Report the duration, also appended to a summary shared by all tests of the run
+    result = "passed" if ret == 0 else f"failed ({ret})"
+    print(f"{test_name}: {result}, server started in {server_time:.2f} s on port {port}, test took {test_time:.2f} s")
+    with output_path.joinpath("durations.csv").open("a") as f:
+        f.write(f"{test_name},{ret},{server_time:.3f},{test_time:.3f}\n")
+
     # Clean up
     model_process.terminate()
     try:
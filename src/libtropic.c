@@ -22,13 +22,17 @@
 #include "libtropic_port.h"
 #include "lt_aesgcm.h"
 #include "lt_asn1_der.h"
+#include "lt_crc16.h"
 #include "lt_ecdsa.h"
 #include "lt_ed25519.h"
+#include "lt_handle_lock.h"
 #include "lt_hkdf.h"
+#include "lt_hmac_drbg.h"
 #include "lt_l1.h"
 #include "lt_l1_port_wrap.h"
 #include "lt_l2_api_structs.h"
 #include "lt_l3_api_structs.h"
+#include "lt_l3_pipeline.h"
 #include "lt_l3_process.h"
 #include "lt_random.h"
 #include "lt_sha256.h"
@@ -36,21 +40,105 @@
 
 #define TR01_GET_INFO_BLOCK_LEN 128
 
+#if LT_ECC_KEY_CACHE
+static void lt_ecc_key_cache_invalidate_slot(lt_handle_t *h, const lt_ecc_slot_t slot)
+{
+    h->ecc_key_cache.slots[slot].valid = false;
+}
+
+static size_t lt_ecc_key_cache_pubkey_len(const uint8_t curve)
+{
+    return (curve == (uint8_t)TR01_CURVE_P256) ? TR01_CURVE_P256_PUBKEY_LEN : TR01_CURVE_ED25519_PUBKEY_LEN;
+}
+#endif
+
+#if LT_SLOT_INVENTORY
+static void lt_slot_inventory_r_mem_mark(lt_handle_t *h, const uint16_t slot, const bool used)
+{
+    if (used) {
+        h->slot_inventory.r_mem[slot / 32] |= 1u << (slot % 32);
+    }
+    else {
+        h->slot_inventory.r_mem[slot / 32] &= ~(1u << (slot % 32));
+    }
+}
+
+static void lt_slot_inventory_ecc_mark(lt_handle_t *h, const lt_ecc_slot_t slot, const bool used)
+{
+    if (used) {
+        h->slot_inventory.ecc |= 1u << slot;
+    }
+    else {
+        h->slot_inventory.ecc &= ~(1u << slot);
+    }
+}
+
+/** @brief Updates the inventory with result of R_Mem_Data_Read. */
+static void lt_slot_inventory_r_mem_on_read(lt_handle_t *h, const uint16_t slot, const lt_ret_t ret)
+{
+    if (ret == LT_OK || ret == LT_L3_R_MEM_DATA_READ_SLOT_EMPTY) {
+        lt_slot_inventory_r_mem_mark(h, slot, ret == LT_OK);
+    }
+}
+
+/** @brief Updates the inventory with result of R_Mem_Data_Write. Expired slots are reported as used. */
+static void lt_slot_inventory_r_mem_on_write(lt_handle_t *h, const uint16_t slot, const lt_ret_t ret)
+{
+    if (ret == LT_OK || ret == LT_L3_R_MEM_DATA_WRITE_WRITE_FAIL || ret == LT_L3_R_MEM_DATA_WRITE_SLOT_EXPIRED) {
+        lt_slot_inventory_r_mem_mark(h, slot, true);
+    }
+}
+
+/** @brief Updates the inventory with result of R_Mem_Data_Erase. */
+static void lt_slot_inventory_r_mem_on_erase(lt_handle_t *h, const uint16_t slot, const lt_ret_t ret)
+{
+    if (ret == LT_OK) {
+        lt_slot_inventory_r_mem_mark(h, slot, false);
+    }
+}
+
+/** @brief Updates the inventory with result of ECC_Key_Read. */
+static void lt_slot_inventory_ecc_on_read(lt_handle_t *h, const lt_ecc_slot_t slot, const lt_ret_t ret)
+{
+    if (ret == LT_OK || ret == LT_L3_ECC_INVALID_KEY) {
+        lt_slot_inventory_ecc_mark(h, slot, ret == LT_OK);
+    }
+}
+#endif
+
 lt_ret_t lt_init(lt_handle_t *h)
 {
     if (!h) {
         return LT_PARAM_ERR;
     }
 
+#if LT_THREAD_SAFE
+    if (lt_port_mutex_init(&h->mutex) != LT_OK) {
+        return LT_FAIL;
+    }
+#endif
+
     // When compiling libtropic with l3 buffer embedded into handle,
     // define buffer's length here (later used to prevent overflow during communication).
 #if !LT_SEPARATE_L3_BUFF
     h->l3.buff_len = LT_SIZE_OF_L3_BUFF;  // Size of l3 buffer is defined in libtropic_common.h
 #endif
     h->l3.session_status = LT_SECURE_SESSION_OFF;
+#if LT_ECC_KEY_CACHE
+    memset(&h->ecc_key_cache, 0, sizeof(h->ecc_key_cache));
+#endif
+#if LT_SLOT_INVENTORY
+    memset(&h->slot_inventory, 0, sizeof(h->slot_inventory));
+#endif
+#if LT_R_CONFIG_MIRROR
+    memset(&h->r_config_mirror, 0, sizeof(h->r_config_mirror));
+#endif
     lt_ret_t ret = lt_l1_init(&h->l2);
     h->l2.startup_req_sent = false;
     if (ret != LT_OK) {
+#if LT_THREAD_SAFE
+        lt_port_mutex_deinit(&h->mutex);
+#endif
         return ret;
     }
 
@@ -63,61 +151,73 @@ lt_ret_t lt_deinit(lt_handle_t *h)
         return LT_PARAM_ERR;
     }
 
+#if LT_THREAD_SAFE
+    // Waits for calls of other threads to finish, the mutex is destroyed below
+    if (h->mutex && lt_port_mutex_lock(h->mutex) != LT_OK) {
+        return LT_FAIL;
+    }
+#endif
+
     lt_l3_invalidate_host_session_data(&h->l3);
+#if LT_ECC_KEY_CACHE
+    memset(&h->ecc_key_cache, 0, sizeof(h->ecc_key_cache));
+#endif
+#if LT_SLOT_INVENTORY
+    memset(&h->slot_inventory, 0, sizeof(h->slot_inventory));
+#endif
+#if LT_R_CONFIG_MIRROR
+    memset(&h->r_config_mirror, 0, sizeof(h->r_config_mirror));
+#endif
 
     lt_ret_t ret = lt_l1_deinit(&h->l2);
-    if (ret != LT_OK) {
-        return ret;
+
+#if LT_THREAD_SAFE
+    if (h->mutex) {
+        lt_port_mutex_unlock(h->mutex);
+        lt_port_mutex_deinit(&h->mutex);
     }
+#endif
 
-    return LT_OK;
+    return ret;
 }
 
-lt_ret_t lt_update_mode(lt_handle_t *h)
+#if LT_THREAD_SAFE
+lt_ret_t lt_handle_lock(lt_handle_t *h)
 {
-    if (!h) {
+    if (!h || !h->mutex) {
         return LT_PARAM_ERR;
     }
 
-    lt_ret_t ret;
-
-    // The byte used here must not be ID byte of some request, otherwise chip would be confused
-    // and would return CRC error.
-    // GET_RESP 0xAA works fine.
-    h->l2.buff[0] = TR01_L1_GET_RESPONSE_REQ_ID;
+    return lt_port_mutex_lock(h->mutex);
+}
 
-    // Transfer just one byte to read CHIP_STATUS byte
-    ret = lt_l1_spi_csn_low(&h->l2);
-    if (ret != LT_OK) {
-        return ret;
+lt_ret_t lt_handle_unlock(lt_handle_t *h)
+{
+    if (!h || !h->mutex) {
+        return LT_PARAM_ERR;
     }
 
-    ret = lt_l1_spi_transfer(&h->l2, 0, 1, LT_L1_TIMEOUT_MS_DEFAULT);
-    if (ret != LT_OK) {
-        lt_ret_t ret_unused = lt_l1_spi_csn_high(&h->l2);
-        LT_UNUSED(ret_unused);  // We don't care about it, we return ret from SPI transfer anyway.
-        return ret;
-    }
+    return lt_port_mutex_unlock(h->mutex);
+}
+#endif
 
-    ret = lt_l1_spi_csn_high(&h->l2);
-    if (ret != LT_OK) {
-        return ret;
-    }
+lt_ret_t lt_update_mode(lt_handle_t *h)
+{
+    LT_HANDLE_LOCK(h);
 
-    // Buffer in handle now contains CHIP_STATUS byte,
-    // Save info about chip mode into 'mode' variable in handle
-    if (h->l2.buff[0] & TR01_L1_CHIP_MODE_STARTUP_bit) {
-        h->l2.mode = LT_TR01_MAINTENANCE_MODE;
-    }
-    else {
-        h->l2.mode = LT_TR01_APP_MODE;
+    if (!h) {
+        return LT_PARAM_ERR;
     }
 
-    return LT_OK;
+    uint8_t status;
+
+    return lt_l1_read_chip_status(&h->l2, &status);
 }
 
 lt_ret_t lt_get_info_cert_store(lt_handle_t *h, struct lt_cert_store_t *store)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !store) {
         return LT_PARAM_ERR;
     }
@@ -224,14 +324,29 @@ lt_ret_t lt_get_st_pub(const struct lt_cert_store_t *store, uint8_t *stpub)
         return LT_PARAM_ERR;
     }
 
-    uint8_t *head = store->certs[LT_CERT_KIND_DEVICE];
-    uint16_t len = store->cert_len[LT_CERT_KIND_DEVICE];
+    static const uint8_t oid_x25519[] = LT_ASN1DER_OID_X25519;
+    lt_asn1der_cert_t cert;
+
+    lt_ret_t ret
+        = lt_asn1der_parse_cert(store->certs[LT_CERT_KIND_DEVICE], store->cert_len[LT_CERT_KIND_DEVICE], &cert);
+    if (ret != LT_OK) {
+        return ret;
+    }
+    if (!lt_asn1der_span_eq(&cert.key_alg, oid_x25519, sizeof(oid_x25519))) {
+        return LT_CERT_ITEM_NOT_FOUND;
+    }
+    if (cert.pub_key.len != TR01_STPUB_LEN) {
+        return LT_CERT_UNSUPPORTED;
+    }
+    memcpy(stpub, cert.pub_key.ptr, TR01_STPUB_LEN);
 
-    return asn1der_find_object(head, len, LT_OBJ_ID_CURVEX25519, stpub, TR01_STPUB_LEN, LT_ASN1DER_CROP_PREFIX);
+    return LT_OK;
 }
 
 lt_ret_t lt_get_info_chip_id(lt_handle_t *h, struct lt_chip_id_t *chip_id)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !chip_id) {
         return LT_PARAM_ERR;
     }
@@ -267,6 +382,8 @@ lt_ret_t lt_get_info_chip_id(lt_handle_t *h, struct lt_chip_id_t *chip_id)
 
 lt_ret_t lt_get_info_riscv_fw_ver(lt_handle_t *h, uint8_t *ver)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !ver) {
         return LT_PARAM_ERR;
     }
@@ -302,6 +419,8 @@ lt_ret_t lt_get_info_riscv_fw_ver(lt_handle_t *h, uint8_t *ver)
 
 lt_ret_t lt_get_info_spect_fw_ver(lt_handle_t *h, uint8_t *ver)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !ver) {
         return LT_PARAM_ERR;
     }
@@ -338,6 +457,8 @@ lt_ret_t lt_get_info_spect_fw_ver(lt_handle_t *h, uint8_t *ver)
 lt_ret_t lt_get_info_fw_bank(lt_handle_t *h, const lt_bank_id_t bank_id, uint8_t *header,
                              const uint16_t header_max_size, uint16_t *header_read_size)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !header || !header_read_size
         || ((bank_id != TR01_FW_BANK_FW1) && (bank_id != TR01_FW_BANK_FW2) && (bank_id != TR01_FW_BANK_SPECT1)
             && (bank_id != TR01_FW_BANK_SPECT2))) {
@@ -385,6 +506,8 @@ lt_ret_t lt_get_info_fw_bank(lt_handle_t *h, const lt_bank_id_t bank_id, uint8_t
 lt_ret_t lt_session_start(lt_handle_t *h, const uint8_t *stpub, const lt_pkey_index_t pkey_index,
                           const uint8_t *shipriv, const uint8_t *shipub)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !stpub || (pkey_index > TR01_PAIRING_KEY_SLOT_INDEX_3) || !shipriv || !shipub) {
         return LT_PARAM_ERR;
     }
@@ -413,6 +536,8 @@ lt_ret_t lt_session_start(lt_handle_t *h, const uint8_t *stpub, const lt_pkey_in
 
 lt_ret_t lt_session_abort(lt_handle_t *h)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h) {
         return LT_PARAM_ERR;
     }
@@ -446,6 +571,8 @@ lt_ret_t lt_session_abort(lt_handle_t *h)
 
 lt_ret_t lt_sleep(lt_handle_t *h, const uint8_t sleep_kind)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || ((sleep_kind != TR01_L2_SLEEP_KIND_SLEEP))) {
         return LT_PARAM_ERR;
     }
@@ -478,6 +605,8 @@ lt_ret_t lt_sleep(lt_handle_t *h, const uint8_t sleep_kind)
 
 lt_ret_t lt_reboot(lt_handle_t *h, const lt_startup_id_t startup_id)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || ((startup_id != TR01_REBOOT) && (startup_id != TR01_MAINTENANCE_REBOOT))) {
         return LT_PARAM_ERR;
     }
@@ -508,8 +637,12 @@ lt_ret_t lt_reboot(lt_handle_t *h, const lt_startup_id_t startup_id)
         return LT_FAIL;
     }
 
-    ret = lt_l1_delay(&h->l2, LT_TR01_REBOOT_DELAY_MS);
-    if (ret != LT_OK) {
+    // Poll until the chip is ready in the requested mode, LT_TR01_REBOOT_DELAY_MS at most
+    lt_tr01_mode_t expected_mode
+        = (startup_id == TR01_MAINTENANCE_REBOOT) ? LT_TR01_MAINTENANCE_MODE : LT_TR01_APP_MODE;
+    ret = lt_l1_wait_ready(&h->l2, expected_mode, h->l2.mode == expected_mode, LT_TR01_REBOOT_DELAY_MS,
+                           &h->l2.reboot_time_ms);
+    if ((ret != LT_OK) && (ret != LT_L1_CHIP_BUSY)) {
         return ret;
     }
 
@@ -522,9 +655,38 @@ lt_ret_t lt_reboot(lt_handle_t *h, const lt_startup_id_t startup_id)
     return LT_OK;
 }
 
+/**
+ * @brief Sends a firmware update L2 request prepared in the L2 buffer and checks the response.
+ *
+ * @param h  Device's handle
+ * @return   LT_OK if success, otherwise returns other error code.
+ */
+static lt_ret_t lt_mutable_fw_update_transfer(lt_handle_t *h)
+{
+    // Setup a request pointer to l2 buffer with response data
+    struct lt_l2_mutable_fw_update_rsp_t *p_l2_resp = (struct lt_l2_mutable_fw_update_rsp_t *)h->l2.buff;
+
+    lt_ret_t ret = lt_l2_send(&h->l2);
+    if (ret != LT_OK) {
+        return ret;
+    }
+    ret = lt_l2_receive(&h->l2);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    if (TR01_L2_MUTABLE_FW_UPDATE_RSP_LEN != (p_l2_resp->rsp_len)) {
+        return LT_FAIL;
+    }
+
+    return LT_OK;
+}
+
 #ifdef ABAB
 lt_ret_t lt_mutable_fw_erase(lt_handle_t *h, const lt_bank_id_t bank_id)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h
         || ((bank_id != TR01_FW_BANK_FW1) && (bank_id != TR01_FW_BANK_FW2) && (bank_id != TR01_FW_BANK_SPECT1)
             && (bank_id != TR01_FW_BANK_SPECT2))) {
@@ -558,6 +720,8 @@ lt_ret_t lt_mutable_fw_erase(lt_handle_t *h, const lt_bank_id_t bank_id)
 
 lt_ret_t lt_mutable_fw_update(lt_handle_t *h, const uint8_t *fw_data, const uint16_t fw_data_size, lt_bank_id_t bank_id)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !fw_data || fw_data_size > TR01_MUTABLE_FW_UPDATE_SIZE_MAX
         || ((bank_id != TR01_FW_BANK_FW1) && (bank_id != TR01_FW_BANK_FW2) && (bank_id != TR01_FW_BANK_SPECT1)
             && (bank_id != TR01_FW_BANK_SPECT2))) {
@@ -566,52 +730,20 @@ lt_ret_t lt_mutable_fw_update(lt_handle_t *h, const uint8_t *fw_data, const uint
 
     // Setup a request pointer to l2 buffer, which is placed in handle
     struct lt_l2_mutable_fw_update_req_t *p_l2_req = (struct lt_l2_mutable_fw_update_req_t *)h->l2.buff;
-    // Setup a request pointer to l2 buffer with response data
-    struct lt_l2_mutable_fw_update_rsp_t *p_l2_resp = (struct lt_l2_mutable_fw_update_rsp_t *)h->l2.buff;
-
-    uint16_t loops = fw_data_size / 128;
-    uint16_t rest = fw_data_size % 128;
-
-    for (int16_t i = 0; i < loops; i++) {
-        p_l2_req->req_id = TR01_L2_MUTABLE_FW_UPDATE_REQ_ID;
-        p_l2_req->req_len = TR01_L2_MUTABLE_FW_UPDATE_REQ_LEN_MIN + 128;
-        p_l2_req->bank_id = bank_id;
-        p_l2_req->offset = i * 128;
-        memcpy(p_l2_req->data, fw_data + (i * 128), 128);
-
-        lt_ret_t ret = lt_l2_send(&h->l2);
-        if (ret != LT_OK) {
-            return ret;
-        }
-        ret = lt_l2_receive(&h->l2);
-        if (ret != LT_OK) {
-            return ret;
-        }
 
-        if (TR01_L2_MUTABLE_FW_UPDATE_RSP_LEN != (p_l2_resp->rsp_len)) {
-            return LT_FAIL;
-        }
-    }
+    for (uint16_t offset = 0; offset < fw_data_size; offset += 128) {
+        uint16_t len = (fw_data_size - offset) < 128 ? (fw_data_size - offset) : 128;
 
-    if (rest != 0) {
         p_l2_req->req_id = TR01_L2_MUTABLE_FW_UPDATE_REQ_ID;
-        p_l2_req->req_len = TR01_L2_MUTABLE_FW_UPDATE_REQ_LEN_MIN + rest;
+        p_l2_req->req_len = TR01_L2_MUTABLE_FW_UPDATE_REQ_LEN_MIN + len;
         p_l2_req->bank_id = bank_id;
-        p_l2_req->offset = loops * 128;
-        memcpy(p_l2_req->data, fw_data + (loops * 128), rest);
+        p_l2_req->offset = offset;
+        memcpy(p_l2_req->data, fw_data + offset, len);
 
-        lt_ret_t ret = lt_l2_send(&h->l2);
-        if (ret != LT_OK) {
-            return ret;
-        }
-        ret = lt_l2_receive(&h->l2);
+        lt_ret_t ret = lt_mutable_fw_update_transfer(h);
         if (ret != LT_OK) {
             return ret;
         }
-
-        if (TR01_L2_MUTABLE_FW_UPDATE_RSP_LEN != (p_l2_resp->rsp_len)) {
-            return LT_FAIL;
-        }
     }
 
     return LT_OK;
@@ -619,6 +751,8 @@ lt_ret_t lt_mutable_fw_update(lt_handle_t *h, const uint8_t *fw_data, const uint
 #elif ACAB
 lt_ret_t lt_mutable_fw_update(lt_handle_t *h, const uint8_t *update_request)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !update_request) {
         return LT_PARAM_ERR;
     }
@@ -636,8 +770,6 @@ lt_ret_t lt_mutable_fw_update(lt_handle_t *h, const uint8_t *update_request)
 
     // Setup a request pointer to l2 buffer, which is placed in handle
     struct lt_l2_mutable_fw_update_req_t *p_l2_req = (struct lt_l2_mutable_fw_update_req_t *)h->l2.buff;
-    // Setup a request pointer to l2 buffer with response data
-    struct lt_l2_mutable_fw_update_rsp_t *p_l2_resp = (struct lt_l2_mutable_fw_update_rsp_t *)h->l2.buff;
 
     // Setup a pointer to incomming data
     struct data_format_t *data_p = (struct data_format_t *)(update_request);
@@ -653,32 +785,19 @@ lt_ret_t lt_mutable_fw_update(lt_handle_t *h, const uint8_t *update_request)
     p_l2_req->header_version = data_p->header_version;
     p_l2_req->version = data_p->version;
 
-    lt_ret_t ret = lt_l2_send(&h->l2);
-    if (ret != LT_OK) {
-        return ret;
-    }
-    ret = lt_l2_receive(&h->l2);
-    if (ret != LT_OK) {
-        return ret;
-    }
-
-    if (TR01_L2_MUTABLE_FW_UPDATE_RSP_LEN != (p_l2_resp->rsp_len)) {
-        return LT_FAIL;
-    }
-
-    return LT_OK;
+    return lt_mutable_fw_update_transfer(h);
 }
 
 lt_ret_t lt_mutable_fw_update_data(lt_handle_t *h, const uint8_t *update_data, const uint16_t update_data_size)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !update_data || update_data_size > TR01_MUTABLE_FW_UPDATE_SIZE_MAX) {
         return LT_PARAM_ERR;
     }
 
     // Setup a request pointer to l2 buffer, which is placed in handle
     struct lt_l2_mutable_fw_update_data_req_t *p2_l2_req = (struct lt_l2_mutable_fw_update_data_req_t *)h->l2.buff;
-    // Setup a request pointer to l2 buffer with response data
-    struct lt_l2_mutable_fw_update_rsp_t *p_l2_resp = (struct lt_l2_mutable_fw_update_rsp_t *)h->l2.buff;
 
     // Data consist of "request" and "data" parts,
     // 'data' byte chunks are taken from following index:
@@ -689,19 +808,11 @@ lt_ret_t lt_mutable_fw_update_data(lt_handle_t *h, const uint8_t *update_data, c
         p2_l2_req->req_id = TR01_L2_MUTABLE_FW_UPDATE_DATA_REQ;
         memcpy((uint8_t *)&p2_l2_req->req_len, update_data + chunk_index, len + 1);
 
-        lt_ret_t ret = lt_l2_send(&h->l2);
-        if (ret != LT_OK) {
-            return ret;
-        }
-        ret = lt_l2_receive(&h->l2);
+        lt_ret_t ret = lt_mutable_fw_update_transfer(h);
         if (ret != LT_OK) {
             return ret;
         }
 
-        if (TR01_L2_MUTABLE_FW_UPDATE_RSP_LEN != (p_l2_resp->rsp_len)) {
-            return LT_FAIL;
-        }
-
         chunk_index += len + 1;
     } while ((chunk_index) < update_data_size);
 
@@ -713,6 +824,8 @@ lt_ret_t lt_mutable_fw_update_data(lt_handle_t *h, const uint8_t *update_data, c
 
 lt_ret_t lt_get_log_req(lt_handle_t *h, uint8_t *log_msg, const uint16_t log_msg_max_size, uint16_t *log_msg_read_size)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !log_msg || !log_msg_read_size) {
         return LT_PARAM_ERR;
     }
@@ -748,6 +861,8 @@ lt_ret_t lt_get_log_req(lt_handle_t *h, uint8_t *log_msg, const uint16_t log_msg
 
 lt_ret_t lt_ping(lt_handle_t *h, const uint8_t *msg_out, uint8_t *msg_in, const uint16_t msg_len)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !msg_out || !msg_in || (msg_len > TR01_PING_LEN_MAX)) {
         return LT_PARAM_ERR;
     }
@@ -775,6 +890,8 @@ lt_ret_t lt_ping(lt_handle_t *h, const uint8_t *msg_out, uint8_t *msg_in, const
 
 lt_ret_t lt_pairing_key_write(lt_handle_t *h, const uint8_t *pairing_pub, const uint8_t slot)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !pairing_pub || (slot > 3)) {
         return LT_PARAM_ERR;
     }
@@ -802,6 +919,8 @@ lt_ret_t lt_pairing_key_write(lt_handle_t *h, const uint8_t *pairing_pub, const
 
 lt_ret_t lt_pairing_key_read(lt_handle_t *h, uint8_t *pairing_pub, const uint8_t slot)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !pairing_pub || (slot > 3)) {
         return LT_PARAM_ERR;
     }
@@ -829,6 +948,8 @@ lt_ret_t lt_pairing_key_read(lt_handle_t *h, uint8_t *pairing_pub, const uint8_t
 
 lt_ret_t lt_pairing_key_invalidate(lt_handle_t *h, const uint8_t slot)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || (slot > 3)) {
         return LT_PARAM_ERR;
     }
@@ -856,6 +977,8 @@ lt_ret_t lt_pairing_key_invalidate(lt_handle_t *h, const uint8_t slot)
 
 lt_ret_t lt_r_config_write(lt_handle_t *h, const enum lt_config_obj_addr_t addr, const uint32_t obj)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h) {
         return LT_PARAM_ERR;
     }
@@ -863,6 +986,11 @@ lt_ret_t lt_r_config_write(lt_handle_t *h, const enum lt_config_obj_addr_t addr,
         return LT_HOST_NO_SESSION;
     }
 
+#if LT_R_CONFIG_MIRROR
+    // R-Config is unknown from now on, even if the command fails on the way
+    h->r_config_mirror.loaded = false;
+#endif
+
     lt_ret_t ret = lt_out__r_config_write(h, addr, obj);
     if (ret != LT_OK) {
         return ret;
@@ -883,6 +1011,8 @@ lt_ret_t lt_r_config_write(lt_handle_t *h, const enum lt_config_obj_addr_t addr,
 
 lt_ret_t lt_r_config_read(lt_handle_t *h, const enum lt_config_obj_addr_t addr, uint32_t *obj)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !obj) {
         return LT_PARAM_ERR;
     }
@@ -910,6 +1040,8 @@ lt_ret_t lt_r_config_read(lt_handle_t *h, const enum lt_config_obj_addr_t addr,
 
 lt_ret_t lt_r_config_erase(lt_handle_t *h)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h) {
         return LT_PARAM_ERR;
     }
@@ -917,6 +1049,11 @@ lt_ret_t lt_r_config_erase(lt_handle_t *h)
         return LT_HOST_NO_SESSION;
     }
 
+#if LT_R_CONFIG_MIRROR
+    // R-Config is unknown from now on, even if the command fails on the way
+    h->r_config_mirror.loaded = false;
+#endif
+
     lt_ret_t ret = lt_out__r_config_erase(h);
     if (ret != LT_OK) {
         return ret;
@@ -937,6 +1074,8 @@ lt_ret_t lt_r_config_erase(lt_handle_t *h)
 
 lt_ret_t lt_i_config_write(lt_handle_t *h, const enum lt_config_obj_addr_t addr, const uint8_t bit_index)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || (bit_index > 31)) {
         return LT_PARAM_ERR;
     }
@@ -964,6 +1103,8 @@ lt_ret_t lt_i_config_write(lt_handle_t *h, const enum lt_config_obj_addr_t addr,
 
 lt_ret_t lt_i_config_read(lt_handle_t *h, const enum lt_config_obj_addr_t addr, uint32_t *obj)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !obj) {
         return LT_PARAM_ERR;
     }
@@ -991,6 +1132,8 @@ lt_ret_t lt_i_config_read(lt_handle_t *h, const enum lt_config_obj_addr_t addr,
 
 lt_ret_t lt_r_mem_data_write(lt_handle_t *h, const uint16_t udata_slot, const uint8_t *data, const uint16_t data_size)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !data || data_size < TR01_R_MEM_DATA_SIZE_MIN || data_size > TR01_R_MEM_DATA_SIZE_MAX
         || (udata_slot > TR01_R_MEM_DATA_SLOT_MAX)) {
         return LT_PARAM_ERR;
@@ -1014,12 +1157,19 @@ lt_ret_t lt_r_mem_data_write(lt_handle_t *h, const uint16_t udata_slot, const ui
         return ret;
     }
 
-    return lt_in__r_mem_data_write(h);
+    ret = lt_in__r_mem_data_write(h);
+#if LT_SLOT_INVENTORY
+    lt_slot_inventory_r_mem_on_write(h, udata_slot, ret);
+#endif
+
+    return ret;
 }
 
 lt_ret_t lt_r_mem_data_read(lt_handle_t *h, const uint16_t udata_slot, uint8_t *data, const uint16_t data_max_size,
                             uint16_t *data_read_size)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !data || !data_read_size || (udata_slot > TR01_R_MEM_DATA_SLOT_MAX)) {
         return LT_PARAM_ERR;
     }
@@ -1042,11 +1192,18 @@ lt_ret_t lt_r_mem_data_read(lt_handle_t *h, const uint16_t udata_slot, uint8_t *
         return ret;
     }
 
-    return lt_in__r_mem_data_read(h, data, data_max_size, data_read_size);
+    ret = lt_in__r_mem_data_read(h, data, data_max_size, data_read_size);
+#if LT_SLOT_INVENTORY
+    lt_slot_inventory_r_mem_on_read(h, udata_slot, ret);
+#endif
+
+    return ret;
 }
 
 lt_ret_t lt_r_mem_data_erase(lt_handle_t *h, const uint16_t udata_slot)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || (udata_slot > TR01_R_MEM_DATA_SLOT_MAX)) {
         return LT_PARAM_ERR;
     }
@@ -1069,127 +1226,768 @@ lt_ret_t lt_r_mem_data_erase(lt_handle_t *h, const uint16_t udata_slot)
         return ret;
     }
 
-    return lt_in__r_mem_data_erase(h);
+    ret = lt_in__r_mem_data_erase(h);
+#if LT_SLOT_INVENTORY
+    lt_slot_inventory_r_mem_on_erase(h, udata_slot, ret);
+#endif
+
+    return ret;
 }
 
-lt_ret_t lt_random_value_get(lt_handle_t *h, uint8_t *rnd_bytes, const uint16_t rnd_bytes_cnt)
+/** @brief Context of lt_r_mem_data_read_range(), lt_r_mem_data_write_vec() and lt_r_mem_data_erase_range(). */
+struct lt_r_mem_data_range_ctx_t {
+    uint16_t first_slot;
+    lt_r_mem_data_rd_t *rd;
+    lt_r_mem_data_wr_t *wr;
+    lt_ret_t *results;
+    lt_ret_t first_err;
+};
+
+static void lt_r_mem_data_range_result(void *ctx, size_t idx, lt_ret_t ret)
 {
-    if (!h || !rnd_bytes || (rnd_bytes_cnt > TR01_RANDOM_VALUE_GET_LEN_MAX)) {
-        return LT_PARAM_ERR;
+    struct lt_r_mem_data_range_ctx_t *c = ctx;
+    if (c->rd) {
+        c->rd[idx].ret = ret;
     }
-    if (h->l3.session_status != LT_SECURE_SESSION_ON) {
-        return LT_HOST_NO_SESSION;
+    if (c->wr) {
+        c->wr[idx].ret = ret;
     }
-
-    lt_ret_t ret = lt_out__random_value_get(h, rnd_bytes_cnt);
-    if (ret != LT_OK) {
-        return ret;
+    if (c->results) {
+        c->results[idx] = ret;
     }
-
-    ret = lt_l2_send_encrypted_cmd(&h->l2, h->l3.buff, h->l3.buff_len);
-    if (ret != LT_OK) {
-        return ret;
+    if ((ret != LT_OK) && (c->first_err == LT_OK)) {
+        c->first_err = ret;
     }
+}
 
-    ret = lt_l2_recv_encrypted_res(&h->l2, h->l3.buff, h->l3.buff_len);
+/**
+ * @brief Runs a pipeline of R memory commands.
+ * @details With per-slot results, LT_OK means all slots were attempted. Without them, the caller has to learn about a
+ * failed slot from the return value, so the first error of a slot is returned.
+ */
+static lt_ret_t lt_r_mem_data_range_run(lt_handle_t *h, const lt_l3_pipeline_ops_t *ops,
+                                        struct lt_r_mem_data_range_ctx_t *c, const uint16_t cnt, uint8_t *stage,
+                                        const uint16_t stage_size)
+{
+    c->first_err = LT_OK;
+    lt_ret_t ret = lt_l3_pipeline_run(h, ops, c, cnt, stage, stage_size, false);
     if (ret != LT_OK) {
         return ret;
     }
 
-    return lt_in__random_value_get(h, rnd_bytes, rnd_bytes_cnt);
+    return (c->rd || c->wr || c->results) ? LT_OK : c->first_err;
 }
 
-lt_ret_t lt_ecc_key_generate(lt_handle_t *h, const lt_ecc_slot_t slot, const lt_ecc_curve_type_t curve)
+static lt_ret_t lt_r_mem_data_read_range_out(lt_handle_t *h, void *ctx, size_t idx)
 {
-    if (!h || (slot > TR01_ECC_SLOT_31) || ((curve != TR01_CURVE_P256) && (curve != TR01_CURVE_ED25519))) {
+    struct lt_r_mem_data_range_ctx_t *c = ctx;
+    return lt_out__r_mem_data_read(h, c->first_slot + idx);
+}
+
+static lt_ret_t lt_r_mem_data_read_range_in(lt_handle_t *h, void *ctx, size_t idx)
+{
+    struct lt_r_mem_data_range_ctx_t *c = ctx;
+    lt_ret_t ret = lt_in__r_mem_data_read(h, c->rd[idx].data, c->rd[idx].data_max_size, &c->rd[idx].data_read_size);
+#if LT_SLOT_INVENTORY
+    lt_slot_inventory_r_mem_on_read(h, c->first_slot + idx, ret);
+#endif
+    return ret;
+}
+
+lt_ret_t lt_r_mem_data_read_range(lt_handle_t *h, const uint16_t first_slot, const uint16_t slot_cnt,
+                                  lt_r_mem_data_rd_t *rd)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !rd || (slot_cnt == 0) || (first_slot + slot_cnt - 1 > TR01_R_MEM_DATA_SLOT_MAX)) {
         return LT_PARAM_ERR;
     }
     if (h->l3.session_status != LT_SECURE_SESSION_ON) {
         return LT_HOST_NO_SESSION;
     }
 
-    lt_ret_t ret = lt_out__ecc_key_generate(h, slot, curve);
-    if (ret != LT_OK) {
-        return ret;
-    }
-
-    ret = lt_l2_send_encrypted_cmd(&h->l2, h->l3.buff, h->l3.buff_len);
-    if (ret != LT_OK) {
-        return ret;
+    for (uint16_t i = 0; i < slot_cnt; i++) {
+        if (!rd[i].data) {
+            return LT_PARAM_ERR;
+        }
+        rd[i].data_read_size = 0;
+        rd[i].ret = LT_FAIL;
     }
 
-    ret = lt_l2_recv_encrypted_res(&h->l2, h->l3.buff, h->l3.buff_len);
-    if (ret != LT_OK) {
-        return ret;
-    }
+    static const lt_l3_pipeline_ops_t ops = {
+        .out = lt_r_mem_data_read_range_out, .in = lt_r_mem_data_read_range_in, .result = lt_r_mem_data_range_result};
+    struct lt_r_mem_data_range_ctx_t ctx = {.first_slot = first_slot, .rd = rd};
+    uint8_t stage[sizeof(struct lt_l3_r_mem_data_read_cmd_t)];
 
-    return lt_in__ecc_key_generate(h);
+    return lt_r_mem_data_range_run(h, &ops, &ctx, slot_cnt, stage, sizeof(stage));
 }
 
-lt_ret_t lt_ecc_key_store(lt_handle_t *h, const lt_ecc_slot_t slot, const lt_ecc_curve_type_t curve, const uint8_t *key)
+static lt_ret_t lt_r_mem_data_write_vec_out(lt_handle_t *h, void *ctx, size_t idx)
 {
-    if (!h || (slot > TR01_ECC_SLOT_31) || ((curve != TR01_CURVE_P256) && (curve != TR01_CURVE_ED25519)) || !key) {
+    struct lt_r_mem_data_range_ctx_t *c = ctx;
+    if (c->wr[idx].slot > TR01_R_MEM_DATA_SLOT_MAX) {
         return LT_PARAM_ERR;
     }
-    if (h->l3.session_status != LT_SECURE_SESSION_ON) {
-        return LT_HOST_NO_SESSION;
-    }
-    lt_ret_t ret = lt_out__ecc_key_store(h, slot, curve, key);
-    if (ret != LT_OK) {
-        return ret;
+    return lt_out__r_mem_data_write(h, c->wr[idx].slot, c->wr[idx].data, c->wr[idx].data_size);
+}
+
+static lt_ret_t lt_r_mem_data_write_vec_in(lt_handle_t *h, void *ctx, size_t idx)
+{
+    lt_ret_t ret = lt_in__r_mem_data_write(h);
+#if LT_SLOT_INVENTORY
+    struct lt_r_mem_data_range_ctx_t *c = ctx;
+    lt_slot_inventory_r_mem_on_write(h, c->wr[idx].slot, ret);
+#else
+    LT_UNUSED(ctx);
+    LT_UNUSED(idx);
+#endif
+    return ret;
+}
+
+lt_ret_t lt_r_mem_data_write_vec(lt_handle_t *h, lt_r_mem_data_wr_t *wr, const uint16_t wr_cnt)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !wr || (wr_cnt == 0)) {
+        return LT_PARAM_ERR;
+    }
+    if (h->l3.session_status != LT_SECURE_SESSION_ON) {
+        return LT_HOST_NO_SESSION;
+    }
+
+    for (uint16_t i = 0; i < wr_cnt; i++) {
+        wr[i].ret = LT_FAIL;
+    }
+
+    static const lt_l3_pipeline_ops_t ops = {
+        .out = lt_r_mem_data_write_vec_out, .in = lt_r_mem_data_write_vec_in, .result = lt_r_mem_data_range_result};
+    struct lt_r_mem_data_range_ctx_t ctx = {.wr = wr};
+    uint8_t stage[sizeof(struct lt_l3_r_mem_data_write_cmd_t)];
+
+    return lt_r_mem_data_range_run(h, &ops, &ctx, wr_cnt, stage, sizeof(stage));
+}
+
+static lt_ret_t lt_r_mem_data_erase_range_out(lt_handle_t *h, void *ctx, size_t idx)
+{
+    struct lt_r_mem_data_range_ctx_t *c = ctx;
+    return lt_out__r_mem_data_erase(h, c->first_slot + idx);
+}
+
+static lt_ret_t lt_r_mem_data_erase_range_in(lt_handle_t *h, void *ctx, size_t idx)
+{
+    lt_ret_t ret = lt_in__r_mem_data_erase(h);
+#if LT_SLOT_INVENTORY
+    struct lt_r_mem_data_range_ctx_t *c = ctx;
+    lt_slot_inventory_r_mem_on_erase(h, c->first_slot + idx, ret);
+#else
+    LT_UNUSED(ctx);
+    LT_UNUSED(idx);
+#endif
+    return ret;
+}
+
+lt_ret_t lt_r_mem_data_erase_range(lt_handle_t *h, const uint16_t first_slot, const uint16_t slot_cnt,
+                                   lt_ret_t *results)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || (slot_cnt == 0) || (first_slot + slot_cnt - 1 > TR01_R_MEM_DATA_SLOT_MAX)) {
+        return LT_PARAM_ERR;
+    }
+    if (h->l3.session_status != LT_SECURE_SESSION_ON) {
+        return LT_HOST_NO_SESSION;
+    }
+
+    if (results) {
+        for (uint16_t i = 0; i < slot_cnt; i++) {
+            results[i] = LT_FAIL;
+        }
+    }
+
+    static const lt_l3_pipeline_ops_t ops = {
+        .out = lt_r_mem_data_erase_range_out, .in = lt_r_mem_data_erase_range_in, .result = lt_r_mem_data_range_result};
+    struct lt_r_mem_data_range_ctx_t ctx = {.first_slot = first_slot, .results = results};
+    uint8_t stage[sizeof(struct lt_l3_r_mem_data_erase_cmd_t)];
+
+    return lt_r_mem_data_range_run(h, &ops, &ctx, slot_cnt, stage, sizeof(stage));
+}
+
+lt_ret_t lt_random_value_get(lt_handle_t *h, uint8_t *rnd_bytes, const uint16_t rnd_bytes_cnt)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !rnd_bytes || (rnd_bytes_cnt > TR01_RANDOM_VALUE_GET_LEN_MAX)) {
+        return LT_PARAM_ERR;
+    }
+    if (h->l3.session_status != LT_SECURE_SESSION_ON) {
+        return LT_HOST_NO_SESSION;
+    }
+
+    lt_ret_t ret = lt_out__random_value_get(h, rnd_bytes_cnt);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    ret = lt_l2_send_encrypted_cmd(&h->l2, h->l3.buff, h->l3.buff_len);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    ret = lt_l2_recv_encrypted_res(&h->l2, h->l3.buff, h->l3.buff_len);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    return lt_in__random_value_get(h, rnd_bytes, rnd_bytes_cnt);
+}
+
+/** @brief Context of lt_random_fill() pipeline. */
+struct lt_random_fill_ctx_t {
+    uint8_t *buff;
+    size_t len;
+};
+
+static uint16_t lt_random_fill_cnt(const struct lt_random_fill_ctx_t *c, const size_t idx)
+{
+    size_t remaining = c->len - idx * TR01_RANDOM_VALUE_GET_LEN_MAX;
+    return (remaining > TR01_RANDOM_VALUE_GET_LEN_MAX) ? TR01_RANDOM_VALUE_GET_LEN_MAX : remaining;
+}
+
+static lt_ret_t lt_random_fill_out(lt_handle_t *h, void *ctx, size_t idx)
+{
+    return lt_out__random_value_get(h, lt_random_fill_cnt(ctx, idx));
+}
+
+static lt_ret_t lt_random_fill_in(lt_handle_t *h, void *ctx, size_t idx)
+{
+    struct lt_random_fill_ctx_t *c = ctx;
+    return lt_in__random_value_get(h, c->buff + idx * TR01_RANDOM_VALUE_GET_LEN_MAX, lt_random_fill_cnt(c, idx));
+}
+
+static void lt_random_fill_result(void *ctx, size_t idx, lt_ret_t ret)
+{
+    // Pipeline stops on the first error and returns it
+    LT_UNUSED(ctx);
+    LT_UNUSED(idx);
+    LT_UNUSED(ret);
+}
+
+lt_ret_t lt_random_fill(lt_handle_t *h, uint8_t *buff, const size_t len)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !buff) {
+        return LT_PARAM_ERR;
+    }
+    if (h->l3.session_status != LT_SECURE_SESSION_ON) {
+        return LT_HOST_NO_SESSION;
+    }
+
+    static const lt_l3_pipeline_ops_t ops
+        = {.out = lt_random_fill_out, .in = lt_random_fill_in, .result = lt_random_fill_result};
+    struct lt_random_fill_ctx_t ctx = {.buff = buff, .len = len};
+    size_t cmd_cnt = (len + TR01_RANDOM_VALUE_GET_LEN_MAX - 1) / TR01_RANDOM_VALUE_GET_LEN_MAX;
+    uint8_t stage[sizeof(struct lt_l3_random_value_get_cmd_t)];
+
+    return lt_l3_pipeline_run(h, &ops, &ctx, cmd_cnt, stage, sizeof(stage), true);
+}
+
+lt_ret_t lt_ecc_key_generate(lt_handle_t *h, const lt_ecc_slot_t slot, const lt_ecc_curve_type_t curve)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || (slot > TR01_ECC_SLOT_31) || ((curve != TR01_CURVE_P256) && (curve != TR01_CURVE_ED25519))) {
+        return LT_PARAM_ERR;
+    }
+    if (h->l3.session_status != LT_SECURE_SESSION_ON) {
+        return LT_HOST_NO_SESSION;
+    }
+
+#if LT_ECC_KEY_CACHE
+    // Slot content is unknown from now on, even if the command fails on the way
+    lt_ecc_key_cache_invalidate_slot(h, slot);
+#endif
+
+    lt_ret_t ret = lt_out__ecc_key_generate(h, slot, curve);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    ret = lt_l2_send_encrypted_cmd(&h->l2, h->l3.buff, h->l3.buff_len);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    ret = lt_l2_recv_encrypted_res(&h->l2, h->l3.buff, h->l3.buff_len);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    ret = lt_in__ecc_key_generate(h);
+#if LT_SLOT_INVENTORY
+    if (ret == LT_OK) {
+        lt_slot_inventory_ecc_mark(h, slot, true);
+    }
+#endif
+
+    return ret;
+}
+
+lt_ret_t lt_ecc_key_store(lt_handle_t *h, const lt_ecc_slot_t slot, const lt_ecc_curve_type_t curve, const uint8_t *key)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || (slot > TR01_ECC_SLOT_31) || ((curve != TR01_CURVE_P256) && (curve != TR01_CURVE_ED25519)) || !key) {
+        return LT_PARAM_ERR;
+    }
+    if (h->l3.session_status != LT_SECURE_SESSION_ON) {
+        return LT_HOST_NO_SESSION;
+    }
+
+#if LT_ECC_KEY_CACHE
+    // Slot content is unknown from now on, even if the command fails on the way
+    lt_ecc_key_cache_invalidate_slot(h, slot);
+#endif
+
+    lt_ret_t ret = lt_out__ecc_key_store(h, slot, curve, key);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    ret = lt_l2_send_encrypted_cmd(&h->l2, h->l3.buff, h->l3.buff_len);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    ret = lt_l2_recv_encrypted_res(&h->l2, h->l3.buff, h->l3.buff_len);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    ret = lt_in__ecc_key_store(h);
+#if LT_SLOT_INVENTORY
+    if (ret == LT_OK) {
+        lt_slot_inventory_ecc_mark(h, slot, true);
+    }
+#endif
+
+    return ret;
+}
+
+lt_ret_t lt_ecc_key_read(lt_handle_t *h, const lt_ecc_slot_t ecc_slot, uint8_t *key, const uint8_t key_max_size,
+                         lt_ecc_curve_type_t *curve, lt_ecc_key_origin_t *origin)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || (ecc_slot > TR01_ECC_SLOT_31) || !key || !curve || !origin) {
+        return LT_PARAM_ERR;
+    }
+    if (h->l3.session_status != LT_SECURE_SESSION_ON) {
+        return LT_HOST_NO_SESSION;
+    }
+
+#if LT_ECC_KEY_CACHE
+    lt_ecc_key_cache_entry_t *entry = &h->ecc_key_cache.slots[ecc_slot];
+    if (entry->valid) {
+        size_t pubkey_len = lt_ecc_key_cache_pubkey_len(entry->curve);
+        if (key_max_size < pubkey_len) {
+            return LT_PARAM_ERR;
+        }
+        memcpy(key, entry->pub_key, pubkey_len);
+        *curve = (lt_ecc_curve_type_t)entry->curve;
+        *origin = (lt_ecc_key_origin_t)entry->origin;
+        return LT_OK;
+    }
+#endif
+
+    lt_ret_t ret = lt_out__ecc_key_read(h, ecc_slot);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    ret = lt_l2_send_encrypted_cmd(&h->l2, h->l3.buff, h->l3.buff_len);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    ret = lt_l2_recv_encrypted_res(&h->l2, h->l3.buff, h->l3.buff_len);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    ret = lt_in__ecc_key_read(h, key, key_max_size, curve, origin);
+#if LT_SLOT_INVENTORY
+    lt_slot_inventory_ecc_on_read(h, ecc_slot, ret);
+#endif
+#if LT_ECC_KEY_CACHE
+    if (ret == LT_OK) {
+        entry->curve = (uint8_t)*curve;
+        entry->origin = (uint8_t)*origin;
+        memcpy(entry->pub_key, key, lt_ecc_key_cache_pubkey_len(entry->curve));
+        entry->valid = true;
+    }
+#endif
+
+    return ret;
+}
+
+lt_ret_t lt_ecc_key_erase(lt_handle_t *h, const lt_ecc_slot_t ecc_slot)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || (ecc_slot > TR01_ECC_SLOT_31)) {
+        return LT_PARAM_ERR;
+    }
+    if (h->l3.session_status != LT_SECURE_SESSION_ON) {
+        return LT_HOST_NO_SESSION;
+    }
+
+#if LT_ECC_KEY_CACHE
+    // Slot content is unknown from now on, even if the command fails on the way
+    lt_ecc_key_cache_invalidate_slot(h, ecc_slot);
+#endif
+
+    lt_ret_t ret = lt_out__ecc_key_erase(h, ecc_slot);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    ret = lt_l2_send_encrypted_cmd(&h->l2, h->l3.buff, h->l3.buff_len);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    ret = lt_l2_recv_encrypted_res(&h->l2, h->l3.buff, h->l3.buff_len);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    ret = lt_in__ecc_key_erase(h);
+#if LT_SLOT_INVENTORY
+    if (ret == LT_OK) {
+        lt_slot_inventory_ecc_mark(h, ecc_slot, false);
+    }
+#endif
+
+    return ret;
+}
+
+#if LT_ECC_KEY_CACHE
+lt_ret_t lt_ecc_key_cache_invalidate(lt_handle_t *h)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h) {
+        return LT_PARAM_ERR;
+    }
+
+    for (int i = 0; i < LT_ECC_KEY_CACHE_SLOT_CNT; i++) {
+        lt_ecc_key_cache_invalidate_slot(h, (lt_ecc_slot_t)i);
+    }
+
+    return LT_OK;
+}
+#endif
+
+#if LT_SLOT_INVENTORY
+/** @brief Version of the blob produced by lt_slot_inventory_save(). */
+#define LT_SLOT_INVENTORY_BLOB_VERSION 1
+
+/** @brief Context of lt_slot_inventory_scan() pipelines. */
+struct lt_slot_inventory_scan_ctx_t {
+    lt_ret_t first_err;
+    uint8_t pub_key[TR01_CURVE_P256_PUBKEY_LEN];
+};
+
+static lt_ret_t lt_slot_inventory_r_mem_scan_out(lt_handle_t *h, void *ctx, size_t idx)
+{
+    LT_UNUSED(ctx);
+    return lt_out__r_mem_data_read(h, (uint16_t)idx);
+}
+
+static lt_ret_t lt_slot_inventory_r_mem_scan_in(lt_handle_t *h, void *ctx, size_t idx)
+{
+    LT_UNUSED(ctx);
+
+    // Only the length of the response matters, data stay in the L3 buffer
+    struct lt_l3_r_mem_data_read_res_t *p_l3_res = (struct lt_l3_r_mem_data_read_res_t *)h->l3.buff;
+
+    lt_ret_t ret = lt_l3_decrypt_response(&h->l3);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    if ((p_l3_res->res_size < TR01_L3_R_MEM_DATA_READ_RES_SIZE_MIN)
+        || p_l3_res->res_size > TR01_L3_R_MEM_DATA_READ_RES_SIZE_MAX) {
+        return LT_FAIL;
+    }
+
+    ret = (p_l3_res->res_size == sizeof(p_l3_res->result) + sizeof(p_l3_res->padding))
+              ? LT_L3_R_MEM_DATA_READ_SLOT_EMPTY
+              : LT_OK;
+    lt_slot_inventory_r_mem_on_read(h, (uint16_t)idx, ret);
+
+    return ret;
+}
+
+static lt_ret_t lt_slot_inventory_ecc_scan_out(lt_handle_t *h, void *ctx, size_t idx)
+{
+    LT_UNUSED(ctx);
+    return lt_out__ecc_key_read(h, (lt_ecc_slot_t)idx);
+}
+
+static lt_ret_t lt_slot_inventory_ecc_scan_in(lt_handle_t *h, void *ctx, size_t idx)
+{
+    struct lt_slot_inventory_scan_ctx_t *c = ctx;
+    lt_ecc_curve_type_t curve;
+    lt_ecc_key_origin_t origin;
+
+    lt_ret_t ret = lt_in__ecc_key_read(h, c->pub_key, sizeof(c->pub_key), &curve, &origin);
+    lt_slot_inventory_ecc_on_read(h, (lt_ecc_slot_t)idx, ret);
+#if LT_ECC_KEY_CACHE
+    if (ret == LT_OK) {
+        lt_ecc_key_cache_entry_t *entry = &h->ecc_key_cache.slots[idx];
+        entry->curve = (uint8_t)curve;
+        entry->origin = (uint8_t)origin;
+        memcpy(entry->pub_key, c->pub_key, lt_ecc_key_cache_pubkey_len(entry->curve));
+        entry->valid = true;
+    }
+#endif
+
+    return ret;
+}
+
+static void lt_slot_inventory_r_mem_scan_result(void *ctx, size_t idx, lt_ret_t ret)
+{
+    struct lt_slot_inventory_scan_ctx_t *c = ctx;
+    LT_UNUSED(idx);
+    if ((ret != LT_OK) && (ret != LT_L3_R_MEM_DATA_READ_SLOT_EMPTY) && (c->first_err == LT_OK)) {
+        c->first_err = ret;
+    }
+}
+
+static void lt_slot_inventory_ecc_scan_result(void *ctx, size_t idx, lt_ret_t ret)
+{
+    struct lt_slot_inventory_scan_ctx_t *c = ctx;
+    LT_UNUSED(idx);
+    if ((ret != LT_OK) && (ret != LT_L3_ECC_INVALID_KEY) && (c->first_err == LT_OK)) {
+        c->first_err = ret;
+    }
+}
+
+lt_ret_t lt_slot_inventory_scan(lt_handle_t *h)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h) {
+        return LT_PARAM_ERR;
+    }
+    if (h->l3.session_status != LT_SECURE_SESSION_ON) {
+        return LT_HOST_NO_SESSION;
+    }
+
+    h->slot_inventory.valid = false;
+
+    struct lt_chip_id_t chip_id;
+    lt_ret_t ret = lt_get_info_chip_id(h, &chip_id);
+    if (ret != LT_OK) {
+        return ret;
+    }
+    memcpy(h->slot_inventory.ser_num, &chip_id.ser_num, sizeof(h->slot_inventory.ser_num));
+
+    static const lt_l3_pipeline_ops_t r_mem_ops = {.out = lt_slot_inventory_r_mem_scan_out,
+                                                   .in = lt_slot_inventory_r_mem_scan_in,
+                                                   .result = lt_slot_inventory_r_mem_scan_result};
+    static const lt_l3_pipeline_ops_t ecc_ops = {.out = lt_slot_inventory_ecc_scan_out,
+                                                 .in = lt_slot_inventory_ecc_scan_in,
+                                                 .result = lt_slot_inventory_ecc_scan_result};
+    struct lt_slot_inventory_scan_ctx_t ctx = {.first_err = LT_OK};
+    // R_Mem_Data_Read and ECC_Key_Read commands have the same size
+    uint8_t stage[sizeof(struct lt_l3_r_mem_data_read_cmd_t)];
+
+    ret = lt_l3_pipeline_run(h, &r_mem_ops, &ctx, LT_SLOT_INVENTORY_R_MEM_SLOT_CNT, stage, sizeof(stage), false);
+    if (ret != LT_OK) {
+        return ret;
+    }
+    ret = lt_l3_pipeline_run(h, &ecc_ops, &ctx, LT_SLOT_INVENTORY_ECC_SLOT_CNT, stage, sizeof(stage), false);
+    if (ret != LT_OK) {
+        return ret;
+    }
+    if (ctx.first_err != LT_OK) {
+        return ctx.first_err;
+    }
+
+    h->slot_inventory.valid = true;
+
+    return LT_OK;
+}
+
+lt_ret_t lt_slot_inventory_save(lt_handle_t *h, uint8_t *blob, const size_t blob_max_size)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !blob || (blob_max_size < LT_SLOT_INVENTORY_BLOB_SIZE)) {
+        return LT_PARAM_ERR;
+    }
+    if (!h->slot_inventory.valid) {
+        return LT_FAIL;
+    }
+
+    uint8_t *p = blob;
+    *p++ = LT_SLOT_INVENTORY_BLOB_VERSION;
+    *p++ = 0;
+    memcpy(p, h->slot_inventory.ser_num, LT_SLOT_INVENTORY_SER_NUM_LEN);
+    p += LT_SLOT_INVENTORY_SER_NUM_LEN;
+    for (size_t i = 0; i < LT_SLOT_INVENTORY_R_MEM_SLOT_CNT / 32; i++) {
+        for (int b = 0; b < 4; b++) {
+            *p++ = (uint8_t)(h->slot_inventory.r_mem[i] >> (8 * b));
+        }
+    }
+    for (int b = 0; b < 4; b++) {
+        *p++ = (uint8_t)(h->slot_inventory.ecc >> (8 * b));
+    }
+    uint16_t crc = crc16(blob, (int16_t)(p - blob));
+    *p++ = (uint8_t)crc;
+    *p++ = (uint8_t)(crc >> 8);
+
+    return LT_OK;
+}
+
+lt_ret_t lt_slot_inventory_load(lt_handle_t *h, const uint8_t *blob, const size_t blob_len)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !blob || (blob_len != LT_SLOT_INVENTORY_BLOB_SIZE)) {
+        return LT_PARAM_ERR;
+    }
+
+    h->slot_inventory.valid = false;
+
+    uint16_t crc = crc16(blob, LT_SLOT_INVENTORY_BLOB_SIZE - 2);
+    if ((blob[0] != LT_SLOT_INVENTORY_BLOB_VERSION) || (blob[LT_SLOT_INVENTORY_BLOB_SIZE - 2] != (uint8_t)crc)
+        || (blob[LT_SLOT_INVENTORY_BLOB_SIZE - 1] != (uint8_t)(crc >> 8))) {
+        return LT_FAIL;
+    }
+
+    struct lt_chip_id_t chip_id;
+    lt_ret_t ret = lt_get_info_chip_id(h, &chip_id);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    const uint8_t *p = blob + 2;
+    if (memcmp(p, &chip_id.ser_num, LT_SLOT_INVENTORY_SER_NUM_LEN)) {
+        return LT_FAIL;
+    }
+    memcpy(h->slot_inventory.ser_num, p, LT_SLOT_INVENTORY_SER_NUM_LEN);
+    p += LT_SLOT_INVENTORY_SER_NUM_LEN;
+
+    for (size_t i = 0; i < LT_SLOT_INVENTORY_R_MEM_SLOT_CNT / 32; i++) {
+        h->slot_inventory.r_mem[i] = 0;
+        for (int b = 0; b < 4; b++) {
+            h->slot_inventory.r_mem[i] |= (uint32_t)*p++ << (8 * b);
+        }
+    }
+    h->slot_inventory.ecc = 0;
+    for (int b = 0; b < 4; b++) {
+        h->slot_inventory.ecc |= (uint32_t)*p++ << (8 * b);
+    }
+
+    h->slot_inventory.valid = true;
+
+    return LT_OK;
+}
+
+lt_ret_t lt_slot_inventory_r_mem_is_used(lt_handle_t *h, const uint16_t udata_slot, bool *used)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !used || (udata_slot > TR01_R_MEM_DATA_SLOT_MAX)) {
+        return LT_PARAM_ERR;
+    }
+    if (!h->slot_inventory.valid) {
+        return LT_FAIL;
     }
 
-    ret = lt_l2_send_encrypted_cmd(&h->l2, h->l3.buff, h->l3.buff_len);
-    if (ret != LT_OK) {
-        return ret;
-    }
+    *used = (h->slot_inventory.r_mem[udata_slot / 32] >> (udata_slot % 32)) & 1u;
 
-    ret = lt_l2_recv_encrypted_res(&h->l2, h->l3.buff, h->l3.buff_len);
-    if (ret != LT_OK) {
-        return ret;
+    return LT_OK;
+}
+
+lt_ret_t lt_slot_inventory_ecc_is_used(lt_handle_t *h, const lt_ecc_slot_t ecc_slot, bool *used)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !used || (ecc_slot > TR01_ECC_SLOT_31)) {
+        return LT_PARAM_ERR;
+    }
+    if (!h->slot_inventory.valid) {
+        return LT_FAIL;
     }
 
-    return lt_in__ecc_key_store(h);
+    *used = (h->slot_inventory.ecc >> ecc_slot) & 1u;
+
+    return LT_OK;
 }
 
-lt_ret_t lt_ecc_key_read(lt_handle_t *h, const lt_ecc_slot_t ecc_slot, uint8_t *key, const uint8_t key_max_size,
-                         lt_ecc_curve_type_t *curve, lt_ecc_key_origin_t *origin)
+lt_ret_t lt_slot_inventory_r_mem_alloc(lt_handle_t *h, uint16_t *udata_slot)
 {
-    if (!h || (ecc_slot > TR01_ECC_SLOT_31) || !key || !curve || !origin) {
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !udata_slot) {
         return LT_PARAM_ERR;
     }
-    if (h->l3.session_status != LT_SECURE_SESSION_ON) {
-        return LT_HOST_NO_SESSION;
+    if (!h->slot_inventory.valid) {
+        return LT_FAIL;
     }
 
-    lt_ret_t ret = lt_out__ecc_key_read(h, ecc_slot);
-    if (ret != LT_OK) {
-        return ret;
+    for (uint16_t i = 0; i < LT_SLOT_INVENTORY_R_MEM_SLOT_CNT; i++) {
+        if (!((h->slot_inventory.r_mem[i / 32] >> (i % 32)) & 1u)) {
+            lt_slot_inventory_r_mem_mark(h, i, true);
+            *udata_slot = i;
+            return LT_OK;
+        }
     }
 
-    ret = lt_l2_send_encrypted_cmd(&h->l2, h->l3.buff, h->l3.buff_len);
-    if (ret != LT_OK) {
-        return ret;
+    return LT_FAIL;
+}
+
+lt_ret_t lt_slot_inventory_ecc_alloc(lt_handle_t *h, lt_ecc_slot_t *ecc_slot)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !ecc_slot) {
+        return LT_PARAM_ERR;
+    }
+    if (!h->slot_inventory.valid) {
+        return LT_FAIL;
     }
 
-    ret = lt_l2_recv_encrypted_res(&h->l2, h->l3.buff, h->l3.buff_len);
-    if (ret != LT_OK) {
-        return ret;
+    for (int i = 0; i < LT_SLOT_INVENTORY_ECC_SLOT_CNT; i++) {
+        if (!((h->slot_inventory.ecc >> i) & 1u)) {
+            lt_slot_inventory_ecc_mark(h, (lt_ecc_slot_t)i, true);
+            *ecc_slot = (lt_ecc_slot_t)i;
+            return LT_OK;
+        }
     }
 
-    return lt_in__ecc_key_read(h, key, key_max_size, curve, origin);
+    return LT_FAIL;
 }
+#endif
 
-lt_ret_t lt_ecc_key_erase(lt_handle_t *h, const lt_ecc_slot_t ecc_slot)
+lt_ret_t lt_ecc_ecdsa_sign(lt_handle_t *h, const lt_ecc_slot_t ecc_slot, const uint8_t *msg, const uint32_t msg_len,
+                           uint8_t *rs)
 {
-    if (!h || (ecc_slot > TR01_ECC_SLOT_31)) {
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !msg || !rs || (ecc_slot > TR01_ECC_SLOT_31)) {
         return LT_PARAM_ERR;
     }
     if (h->l3.session_status != LT_SECURE_SESSION_ON) {
         return LT_HOST_NO_SESSION;
     }
 
-    lt_ret_t ret = lt_out__ecc_key_erase(h, ecc_slot);
+    lt_ret_t ret = lt_out__ecc_ecdsa_sign(h, ecc_slot, msg, msg_len);
     if (ret != LT_OK) {
         return ret;
     }
@@ -1204,20 +2002,21 @@ lt_ret_t lt_ecc_key_erase(lt_handle_t *h, const lt_ecc_slot_t ecc_slot)
         return ret;
     }
 
-    return lt_in__ecc_key_erase(h);
+    return lt_in__ecc_ecdsa_sign(h, rs);
 }
 
-lt_ret_t lt_ecc_ecdsa_sign(lt_handle_t *h, const lt_ecc_slot_t ecc_slot, const uint8_t *msg, const uint32_t msg_len,
-                           uint8_t *rs)
+lt_ret_t lt_ecc_ecdsa_sign_hash(lt_handle_t *h, const lt_ecc_slot_t ecc_slot, const uint8_t *msg_hash, uint8_t *rs)
 {
-    if (!h || !msg || !rs || (ecc_slot > TR01_ECC_SLOT_31)) {
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !msg_hash || !rs || (ecc_slot > TR01_ECC_SLOT_31)) {
         return LT_PARAM_ERR;
     }
     if (h->l3.session_status != LT_SECURE_SESSION_ON) {
         return LT_HOST_NO_SESSION;
     }
 
-    lt_ret_t ret = lt_out__ecc_ecdsa_sign(h, ecc_slot, msg, msg_len);
+    lt_ret_t ret = lt_out__ecc_ecdsa_sign_hash(h, ecc_slot, msg_hash);
     if (ret != LT_OK) {
         return ret;
     }
@@ -1251,6 +2050,8 @@ lt_ret_t lt_ecc_ecdsa_sig_verify(const uint8_t *msg, const uint32_t msg_len, con
 lt_ret_t lt_ecc_eddsa_sign(lt_handle_t *h, const lt_ecc_slot_t ecc_slot, const uint8_t *msg, const uint16_t msg_len,
                            uint8_t *rs)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !msg || !rs || (msg_len > TR01_L3_EDDSA_SIGN_CMD_MSG_LEN_MAX) || (ecc_slot > TR01_ECC_SLOT_31)) {
         return LT_PARAM_ERR;
     }
@@ -1291,6 +2092,8 @@ lt_ret_t lt_ecc_eddsa_sig_verify(const uint8_t *msg, const uint16_t msg_len, con
 
 lt_ret_t lt_mcounter_init(lt_handle_t *h, const enum lt_mcounter_index_t mcounter_index, const uint32_t mcounter_value)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || (mcounter_index > TR01_MCOUNTER_INDEX_15) || mcounter_value > TR01_MCOUNTER_VALUE_MAX) {
         return LT_PARAM_ERR;
     }
@@ -1318,6 +2121,8 @@ lt_ret_t lt_mcounter_init(lt_handle_t *h, const enum lt_mcounter_index_t mcounte
 
 lt_ret_t lt_mcounter_update(lt_handle_t *h, const enum lt_mcounter_index_t mcounter_index)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || (mcounter_index > TR01_MCOUNTER_INDEX_15)) {
         return LT_PARAM_ERR;
     }
@@ -1345,6 +2150,8 @@ lt_ret_t lt_mcounter_update(lt_handle_t *h, const enum lt_mcounter_index_t mcoun
 
 lt_ret_t lt_mcounter_get(lt_handle_t *h, const enum lt_mcounter_index_t mcounter_index, uint32_t *mcounter_value)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || (mcounter_index > TR01_MCOUNTER_INDEX_15) || !mcounter_value) {
         return LT_PARAM_ERR;
     }
@@ -1373,6 +2180,8 @@ lt_ret_t lt_mcounter_get(lt_handle_t *h, const enum lt_mcounter_index_t mcounter
 lt_ret_t lt_mac_and_destroy(lt_handle_t *h, const lt_mac_and_destroy_slot_t slot, const uint8_t *data_out,
                             uint8_t *data_in)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !data_out || !data_in || slot > TR01_MAC_AND_DESTROY_SLOT_127) {
         return LT_PARAM_ERR;
     }
@@ -1398,6 +2207,344 @@ lt_ret_t lt_mac_and_destroy(lt_handle_t *h, const lt_mac_and_destroy_slot_t slot
     return lt_in__mac_and_destroy(h, data_in);
 }
 
+/**
+ * @brief Checks all arguments of a batch command and gets the size of its encrypted packet.
+ * @details Input arguments are checked against the same limits as lt_out__X() checks them when the command is
+ * prepared, so lt_batch_run() can reject a batch before anything is sent.
+ */
+static lt_ret_t lt_batch_cmd_check(const lt_batch_cmd_t *cmd, uint16_t *packet_size)
+{
+    const uint16_t tail = TR01_L3_TAG_SIZE;
+    bool ok = true;
+
+    switch (cmd->id) {
+        case LT_BATCH_PING:
+            ok = cmd->args.ping.msg_out && cmd->args.ping.msg_in && (cmd->args.ping.msg_len <= TR01_PING_LEN_MAX);
+            *packet_size = TR01_L3_CMD_SIZE_SIZE + TR01_L3_CMD_ID_SIZE + cmd->args.ping.msg_len + tail;
+            break;
+        case LT_BATCH_PAIRING_KEY_WRITE:
+            ok = cmd->args.pairing_key_write.pairing_pub && (cmd->args.pairing_key_write.slot <= 3);
+            *packet_size = sizeof(struct lt_l3_pairing_key_write_cmd_t);
+            break;
+        case LT_BATCH_PAIRING_KEY_READ:
+            ok = cmd->args.pairing_key_read.pairing_pub && (cmd->args.pairing_key_read.slot <= 3);
+            *packet_size = sizeof(struct lt_l3_pairing_key_read_cmd_t);
+            break;
+        case LT_BATCH_PAIRING_KEY_INVALIDATE:
+            ok = (cmd->args.pairing_key_invalidate.slot <= 3);
+            *packet_size = sizeof(struct lt_l3_pairing_key_invalidate_cmd_t);
+            break;
+        case LT_BATCH_R_CONFIG_WRITE:
+            ok = lt_conf_addr_valid(cmd->args.r_config_write.addr);
+            *packet_size = sizeof(struct lt_l3_r_config_write_cmd_t);
+            break;
+        case LT_BATCH_R_CONFIG_READ:
+            ok = cmd->args.r_config_read.obj && lt_conf_addr_valid(cmd->args.r_config_read.addr);
+            *packet_size = sizeof(struct lt_l3_r_config_read_cmd_t);
+            break;
+        case LT_BATCH_R_CONFIG_ERASE:
+            *packet_size = sizeof(struct lt_l3_r_config_erase_cmd_t);
+            break;
+        case LT_BATCH_I_CONFIG_WRITE:
+            ok = lt_conf_addr_valid(cmd->args.i_config_write.addr) && (cmd->args.i_config_write.bit_index <= 31);
+            *packet_size = sizeof(struct lt_l3_i_config_write_cmd_t);
+            break;
+        case LT_BATCH_I_CONFIG_READ:
+            ok = cmd->args.i_config_read.obj && lt_conf_addr_valid(cmd->args.i_config_read.addr);
+            *packet_size = sizeof(struct lt_l3_i_config_read_cmd_t);
+            break;
+        case LT_BATCH_R_MEM_DATA_WRITE:
+            ok = cmd->args.r_mem_data_write.data && (cmd->args.r_mem_data_write.data_size >= TR01_R_MEM_DATA_SIZE_MIN)
+                 && (cmd->args.r_mem_data_write.data_size <= TR01_R_MEM_DATA_SIZE_MAX)
+                 && (cmd->args.r_mem_data_write.udata_slot <= TR01_R_MEM_DATA_SLOT_MAX);
+            *packet_size
+                = offsetof(struct lt_l3_r_mem_data_write_cmd_t, data) + cmd->args.r_mem_data_write.data_size + tail;
+            break;
+        case LT_BATCH_R_MEM_DATA_READ:
+            ok = cmd->args.r_mem_data_read.data && cmd->args.r_mem_data_read.data_read_size
+                 && (cmd->args.r_mem_data_read.udata_slot <= TR01_R_MEM_DATA_SLOT_MAX);
+            *packet_size = sizeof(struct lt_l3_r_mem_data_read_cmd_t);
+            break;
+        case LT_BATCH_R_MEM_DATA_ERASE:
+            ok = (cmd->args.r_mem_data_erase.udata_slot <= TR01_R_MEM_DATA_SLOT_MAX);
+            *packet_size = sizeof(struct lt_l3_r_mem_data_erase_cmd_t);
+            break;
+        case LT_BATCH_RANDOM_VALUE_GET:
+            ok = cmd->args.random_value_get.rnd_bytes
+                 && (cmd->args.random_value_get.rnd_bytes_cnt <= TR01_RANDOM_VALUE_GET_LEN_MAX);
+            *packet_size = sizeof(struct lt_l3_random_value_get_cmd_t);
+            break;
+        case LT_BATCH_ECC_KEY_GENERATE:
+            ok = (cmd->args.ecc_key_generate.slot <= TR01_ECC_SLOT_31)
+                 && ((cmd->args.ecc_key_generate.curve == TR01_CURVE_P256)
+                     || (cmd->args.ecc_key_generate.curve == TR01_CURVE_ED25519));
+            *packet_size = sizeof(struct lt_l3_ecc_key_generate_cmd_t);
+            break;
+        case LT_BATCH_ECC_KEY_STORE:
+            ok = cmd->args.ecc_key_store.key && (cmd->args.ecc_key_store.slot <= TR01_ECC_SLOT_31)
+                 && ((cmd->args.ecc_key_store.curve == TR01_CURVE_P256)
+                     || (cmd->args.ecc_key_store.curve == TR01_CURVE_ED25519));
+            *packet_size = sizeof(struct lt_l3_ecc_key_store_cmd_t);
+            break;
+        case LT_BATCH_ECC_KEY_READ:
+            ok = (cmd->args.ecc_key_read.slot <= TR01_ECC_SLOT_31) && cmd->args.ecc_key_read.key
+                 && cmd->args.ecc_key_read.curve && cmd->args.ecc_key_read.origin;
+            *packet_size = sizeof(struct lt_l3_ecc_key_read_cmd_t);
+            break;
+        case LT_BATCH_ECC_KEY_ERASE:
+            ok = (cmd->args.ecc_key_erase.slot <= TR01_ECC_SLOT_31);
+            *packet_size = sizeof(struct lt_l3_ecc_key_erase_cmd_t);
+            break;
+        case LT_BATCH_ECDSA_SIGN:
+            ok = cmd->args.ecdsa_sign.msg && cmd->args.ecdsa_sign.rs && (cmd->args.ecdsa_sign.slot <= TR01_ECC_SLOT_31);
+            *packet_size = sizeof(struct lt_l3_ecdsa_sign_cmd_t);
+            break;
+        case LT_BATCH_EDDSA_SIGN:
+            ok = cmd->args.eddsa_sign.msg && cmd->args.eddsa_sign.rs
+                 && (cmd->args.eddsa_sign.msg_len <= TR01_L3_EDDSA_SIGN_CMD_MSG_LEN_MAX)
+                 && (cmd->args.eddsa_sign.slot <= TR01_ECC_SLOT_31);
+            *packet_size = offsetof(struct lt_l3_eddsa_sign_cmd_t, msg) + cmd->args.eddsa_sign.msg_len + tail;
+            break;
+        case LT_BATCH_MCOUNTER_INIT:
+            ok = (cmd->args.mcounter_init.mcounter_index <= TR01_MCOUNTER_INDEX_15);
+            *packet_size = sizeof(struct lt_l3_mcounter_init_cmd_t);
+            break;
+        case LT_BATCH_MCOUNTER_UPDATE:
+            ok = (cmd->args.mcounter_update.mcounter_index <= TR01_MCOUNTER_INDEX_15);
+            *packet_size = sizeof(struct lt_l3_mcounter_update_cmd_t);
+            break;
+        case LT_BATCH_MCOUNTER_GET:
+            ok = cmd->args.mcounter_get.mcounter_value
+                 && (cmd->args.mcounter_get.mcounter_index <= TR01_MCOUNTER_INDEX_15);
+            *packet_size = sizeof(struct lt_l3_mcounter_get_cmd_t);
+            break;
+        case LT_BATCH_MAC_AND_DESTROY:
+            ok = cmd->args.mac_and_destroy.data_out && cmd->args.mac_and_destroy.data_in
+                 && (cmd->args.mac_and_destroy.slot <= TR01_MAC_AND_DESTROY_SLOT_127);
+            *packet_size = sizeof(struct lt_l3_mac_and_destroy_cmd_t);
+            break;
+        default:
+            return LT_PARAM_ERR;
+    }
+
+    return ok ? LT_OK : LT_PARAM_ERR;
+}
+
+static lt_ret_t lt_batch_out(lt_handle_t *h, void *ctx, size_t idx)
+{
+    lt_batch_cmd_t *cmd = &((lt_batch_cmd_t *)ctx)[idx];
+
+    switch (cmd->id) {
+        case LT_BATCH_PING:
+            return lt_out__ping(h, cmd->args.ping.msg_out, cmd->args.ping.msg_len);
+        case LT_BATCH_PAIRING_KEY_WRITE:
+            return lt_out__pairing_key_write(h, cmd->args.pairing_key_write.pairing_pub,
+                                             cmd->args.pairing_key_write.slot);
+        case LT_BATCH_PAIRING_KEY_READ:
+            return lt_out__pairing_key_read(h, cmd->args.pairing_key_read.slot);
+        case LT_BATCH_PAIRING_KEY_INVALIDATE:
+            return lt_out__pairing_key_invalidate(h, cmd->args.pairing_key_invalidate.slot);
+        case LT_BATCH_R_CONFIG_WRITE:
+#if LT_R_CONFIG_MIRROR
+            h->r_config_mirror.loaded = false;
+#endif
+            return lt_out__r_config_write(h, cmd->args.r_config_write.addr, cmd->args.r_config_write.obj);
+        case LT_BATCH_R_CONFIG_READ:
+            return lt_out__r_config_read(h, cmd->args.r_config_read.addr);
+        case LT_BATCH_R_CONFIG_ERASE:
+#if LT_R_CONFIG_MIRROR
+            h->r_config_mirror.loaded = false;
+#endif
+            return lt_out__r_config_erase(h);
+        case LT_BATCH_I_CONFIG_WRITE:
+            return lt_out__i_config_write(h, cmd->args.i_config_write.addr, cmd->args.i_config_write.bit_index);
+        case LT_BATCH_I_CONFIG_READ:
+            return lt_out__i_config_read(h, cmd->args.i_config_read.addr);
+        case LT_BATCH_R_MEM_DATA_WRITE:
+            return lt_out__r_mem_data_write(h, cmd->args.r_mem_data_write.udata_slot, cmd->args.r_mem_data_write.data,
+                                            cmd->args.r_mem_data_write.data_size);
+        case LT_BATCH_R_MEM_DATA_READ:
+            return lt_out__r_mem_data_read(h, cmd->args.r_mem_data_read.udata_slot);
+        case LT_BATCH_R_MEM_DATA_ERASE:
+            return lt_out__r_mem_data_erase(h, cmd->args.r_mem_data_erase.udata_slot);
+        case LT_BATCH_RANDOM_VALUE_GET:
+            return lt_out__random_value_get(h, cmd->args.random_value_get.rnd_bytes_cnt);
+        case LT_BATCH_ECC_KEY_GENERATE:
+#if LT_ECC_KEY_CACHE
+            // Slot content is unknown from now on, even if the command fails on the way
+            lt_ecc_key_cache_invalidate_slot(h, cmd->args.ecc_key_generate.slot);
+#endif
+            return lt_out__ecc_key_generate(h, cmd->args.ecc_key_generate.slot, cmd->args.ecc_key_generate.curve);
+        case LT_BATCH_ECC_KEY_STORE:
+#if LT_ECC_KEY_CACHE
+            lt_ecc_key_cache_invalidate_slot(h, cmd->args.ecc_key_store.slot);
+#endif
+            return lt_out__ecc_key_store(h, cmd->args.ecc_key_store.slot, cmd->args.ecc_key_store.curve,
+                                         cmd->args.ecc_key_store.key);
+        case LT_BATCH_ECC_KEY_READ:
+            return lt_out__ecc_key_read(h, cmd->args.ecc_key_read.slot);
+        case LT_BATCH_ECC_KEY_ERASE:
+#if LT_ECC_KEY_CACHE
+            lt_ecc_key_cache_invalidate_slot(h, cmd->args.ecc_key_erase.slot);
+#endif
+            return lt_out__ecc_key_erase(h, cmd->args.ecc_key_erase.slot);
+        case LT_BATCH_ECDSA_SIGN:
+            return lt_out__ecc_ecdsa_sign(h, cmd->args.ecdsa_sign.slot, cmd->args.ecdsa_sign.msg,
+                                          cmd->args.ecdsa_sign.msg_len);
+        case LT_BATCH_EDDSA_SIGN:
+            return lt_out__ecc_eddsa_sign(h, cmd->args.eddsa_sign.slot, cmd->args.eddsa_sign.msg,
+                                          cmd->args.eddsa_sign.msg_len);
+        case LT_BATCH_MCOUNTER_INIT:
+            return lt_out__mcounter_init(h, cmd->args.mcounter_init.mcounter_index,
+                                         cmd->args.mcounter_init.mcounter_value);
+        case LT_BATCH_MCOUNTER_UPDATE:
+            return lt_out__mcounter_update(h, cmd->args.mcounter_update.mcounter_index);
+        case LT_BATCH_MCOUNTER_GET:
+            return lt_out__mcounter_get(h, cmd->args.mcounter_get.mcounter_index);
+        case LT_BATCH_MAC_AND_DESTROY:
+            return lt_out__mac_and_destroy(h, cmd->args.mac_and_destroy.slot, cmd->args.mac_and_destroy.data_out);
+        default:
+            return LT_PARAM_ERR;
+    }
+}
+
+static lt_ret_t lt_batch_in(lt_handle_t *h, void *ctx, size_t idx)
+{
+    lt_batch_cmd_t *cmd = &((lt_batch_cmd_t *)ctx)[idx];
+    lt_ret_t ret;
+
+    switch (cmd->id) {
+        case LT_BATCH_PING:
+            return lt_in__ping(h, cmd->args.ping.msg_in, cmd->args.ping.msg_len);
+        case LT_BATCH_PAIRING_KEY_WRITE:
+            return lt_in__pairing_key_write(h);
+        case LT_BATCH_PAIRING_KEY_READ:
+            return lt_in__pairing_key_read(h, cmd->args.pairing_key_read.pairing_pub);
+        case LT_BATCH_PAIRING_KEY_INVALIDATE:
+            return lt_in__pairing_key_invalidate(h);
+        case LT_BATCH_R_CONFIG_WRITE:
+            return lt_in__r_config_write(h);
+        case LT_BATCH_R_CONFIG_READ:
+            return lt_in__r_config_read(h, cmd->args.r_config_read.obj);
+        case LT_BATCH_R_CONFIG_ERASE:
+            return lt_in__r_config_erase(h);
+        case LT_BATCH_I_CONFIG_WRITE:
+            return lt_in__i_config_write(h);
+        case LT_BATCH_I_CONFIG_READ:
+            return lt_in__i_config_read(h, cmd->args.i_config_read.obj);
+        case LT_BATCH_R_MEM_DATA_WRITE:
+            ret = lt_in__r_mem_data_write(h);
+#if LT_SLOT_INVENTORY
+            lt_slot_inventory_r_mem_on_write(h, cmd->args.r_mem_data_write.udata_slot, ret);
+#endif
+            return ret;
+        case LT_BATCH_R_MEM_DATA_READ:
+            ret = lt_in__r_mem_data_read(h, cmd->args.r_mem_data_read.data, cmd->args.r_mem_data_read.data_max_size,
+                                         cmd->args.r_mem_data_read.data_read_size);
+#if LT_SLOT_INVENTORY
+            lt_slot_inventory_r_mem_on_read(h, cmd->args.r_mem_data_read.udata_slot, ret);
+#endif
+            return ret;
+        case LT_BATCH_R_MEM_DATA_ERASE:
+            ret = lt_in__r_mem_data_erase(h);
+#if LT_SLOT_INVENTORY
+            lt_slot_inventory_r_mem_on_erase(h, cmd->args.r_mem_data_erase.udata_slot, ret);
+#endif
+            return ret;
+        case LT_BATCH_RANDOM_VALUE_GET:
+            return lt_in__random_value_get(h, cmd->args.random_value_get.rnd_bytes,
+                                           cmd->args.random_value_get.rnd_bytes_cnt);
+        case LT_BATCH_ECC_KEY_GENERATE:
+            ret = lt_in__ecc_key_generate(h);
+#if LT_SLOT_INVENTORY
+            if (ret == LT_OK) {
+                lt_slot_inventory_ecc_mark(h, cmd->args.ecc_key_generate.slot, true);
+            }
+#endif
+            return ret;
+        case LT_BATCH_ECC_KEY_STORE:
+            ret = lt_in__ecc_key_store(h);
+#if LT_SLOT_INVENTORY
+            if (ret == LT_OK) {
+                lt_slot_inventory_ecc_mark(h, cmd->args.ecc_key_store.slot, true);
+            }
+#endif
+            return ret;
+        case LT_BATCH_ECC_KEY_READ:
+            ret = lt_in__ecc_key_read(h, cmd->args.ecc_key_read.key, cmd->args.ecc_key_read.key_max_size,
+                                      cmd->args.ecc_key_read.curve, cmd->args.ecc_key_read.origin);
+#if LT_SLOT_INVENTORY
+            lt_slot_inventory_ecc_on_read(h, cmd->args.ecc_key_read.slot, ret);
+#endif
+#if LT_ECC_KEY_CACHE
+            if (ret == LT_OK) {
+                lt_ecc_key_cache_entry_t *entry = &h->ecc_key_cache.slots[cmd->args.ecc_key_read.slot];
+                entry->curve = (uint8_t)*cmd->args.ecc_key_read.curve;
+                entry->origin = (uint8_t)*cmd->args.ecc_key_read.origin;
+                memcpy(entry->pub_key, cmd->args.ecc_key_read.key, lt_ecc_key_cache_pubkey_len(entry->curve));
+                entry->valid = true;
+            }
+#endif
+            return ret;
+        case LT_BATCH_ECC_KEY_ERASE:
+            ret = lt_in__ecc_key_erase(h);
+#if LT_SLOT_INVENTORY
+            if (ret == LT_OK) {
+                lt_slot_inventory_ecc_mark(h, cmd->args.ecc_key_erase.slot, false);
+            }
+#endif
+            return ret;
+        case LT_BATCH_ECDSA_SIGN:
+            return lt_in__ecc_ecdsa_sign(h, cmd->args.ecdsa_sign.rs);
+        case LT_BATCH_EDDSA_SIGN:
+            return lt_in__ecc_eddsa_sign(h, cmd->args.eddsa_sign.rs);
+        case LT_BATCH_MCOUNTER_INIT:
+            return lt_in__mcounter_init(h);
+        case LT_BATCH_MCOUNTER_UPDATE:
+            return lt_in__mcounter_update(h);
+        case LT_BATCH_MCOUNTER_GET:
+            return lt_in__mcounter_get(h, cmd->args.mcounter_get.mcounter_value);
+        case LT_BATCH_MAC_AND_DESTROY:
+            return lt_in__mac_and_destroy(h, cmd->args.mac_and_destroy.data_in);
+        default:
+            return LT_PARAM_ERR;
+    }
+}
+
+static void lt_batch_result(void *ctx, size_t idx, lt_ret_t ret)
+{
+    lt_batch_cmd_t *cmds = ctx;
+    cmds[idx].ret = ret;
+}
+
+lt_ret_t lt_batch_run(lt_handle_t *h, lt_batch_cmd_t *cmds, const uint16_t cmd_cnt, uint8_t *stage,
+                      const uint16_t stage_size, const bool stop_on_error)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !cmds || (cmd_cnt == 0) || !stage) {
+        return LT_PARAM_ERR;
+    }
+    if (h->l3.session_status != LT_SECURE_SESSION_ON) {
+        return LT_HOST_NO_SESSION;
+    }
+
+    // Nothing is sent unless every command fits into the stage buffer and has its output buffers
+    for (uint16_t i = 0; i < cmd_cnt; i++) {
+        uint16_t packet_size;
+        if ((lt_batch_cmd_check(&cmds[i], &packet_size) != LT_OK) || (packet_size > stage_size)) {
+            return LT_PARAM_ERR;
+        }
+    }
+    for (uint16_t i = 0; i < cmd_cnt; i++) {
+        cmds[i].ret = LT_BATCH_NOT_EXECUTED;
+    }
+
+    static const lt_l3_pipeline_ops_t ops = {.out = lt_batch_out, .in = lt_batch_in, .result = lt_batch_result};
+
+    return lt_l3_pipeline_run(h, &ops, cmds, cmd_cnt, stage, stage_size, stop_on_error);
+}
+
 static const char *lt_ret_strs[] = {"LT_OK",
                                     "LT_FAIL",
                                     "LT_HOST_NO_SESSION",
@@ -1438,85 +2585,314 @@ static const char *lt_ret_strs[] = {"LT_OK",
                                     "LT_CERT_STORE_INVALID",
                                     "LT_CERT_UNSUPPORTED",
                                     "LT_CERT_ITEM_NOT_FOUND",
-                                    "LT_NONCE_OVERFLOW"};
+                                    "LT_NONCE_OVERFLOW",
+                                    "LT_KV_KEY_NOT_FOUND",
+                                    "LT_KV_FULL",
+                                    "LT_MACANDD_WRONG_PIN",
+                                    "LT_MACANDD_NO_ATTEMPTS",
+                                    "LT_MACANDD_RECORD_INVALID",
+                                    "LT_BATCH_NOT_EXECUTED",
+                                    "LT_CERT_CHAIN_INVALID"};
+
+const char *lt_ret_verbose(lt_ret_t ret)
+{
+    if (ret < LT_RET_T_LAST_VALUE) return lt_ret_strs[ret];
+
+    return "FATAL ERROR, unknown return value";
+}
+
+//--------------------------------------------------------------------------------------------------------//
+#ifdef LT_HELPERS
+
+struct lt_config_obj_desc_t cfg_desc_table[LT_CONFIG_OBJ_CNT]
+    = {{"TR01_CFG_START_UP                   ", TR01_CFG_START_UP_ADDR},
+       {"TR01_CFG_SENSORS                    ", TR01_CFG_SENSORS_ADDR},
+       {"TR01_CFG_DEBUG                      ", TR01_CFG_DEBUG_ADDR},
+       {"TR01_CFG_GPO_ADDR                   ", TR01_CFG_GPO_ADDR},
+       {"TR01_CFG_SLEEP_MODE                 ", TR01_CFG_SLEEP_MODE_ADDR},
+       {"TR01_CFG_UAP_PAIRING_KEY_WRITE      ", TR01_CFG_UAP_PAIRING_KEY_WRITE_ADDR},
+       {"TR01_CFG_UAP_PAIRING_KEY_READ       ", TR01_CFG_UAP_PAIRING_KEY_READ_ADDR},
+       {"TR01_CFG_UAP_PAIRING_KEY_INVALIDATE ", TR01_CFG_UAP_PAIRING_KEY_INVALIDATE_ADDR},
+       {"TR01_CFG_UAP_R_CONFIG_WRITE_ERASE   ", TR01_CFG_UAP_R_CONFIG_WRITE_ERASE_ADDR},
+       {"TR01_CFG_UAP_R_CONFIG_READ          ", TR01_CFG_UAP_R_CONFIG_READ_ADDR},
+       {"TR01_CFG_UAP_I_CONFIG_WRITE         ", TR01_CFG_UAP_I_CONFIG_WRITE_ADDR},
+       {"TR01_CFG_UAP_I_CONFIG_READ          ", TR01_CFG_UAP_I_CONFIG_READ_ADDR},
+       {"TR01_CFG_UAP_PING                   ", TR01_CFG_UAP_PING_ADDR},
+       {"TR01_CFG_UAP_R_MEM_DATA_WRITE       ", TR01_CFG_UAP_R_MEM_DATA_WRITE_ADDR},
+       {"TR01_CFG_UAP_R_MEM_DATA_READ        ", TR01_CFG_UAP_R_MEM_DATA_READ_ADDR},
+       {"TR01_CFG_UAP_R_MEM_DATA_ERASE       ", TR01_CFG_UAP_R_MEM_DATA_ERASE_ADDR},
+       {"TR01_CFG_UAP_RANDOM_VALUE_GET       ", TR01_CFG_UAP_RANDOM_VALUE_GET_ADDR},
+       {"TR01_CFG_UAP_ECC_KEY_GENERATE       ", TR01_CFG_UAP_ECC_KEY_GENERATE_ADDR},
+       {"TR01_CFG_UAP_ECC_KEY_STORE          ", TR01_CFG_UAP_ECC_KEY_STORE_ADDR},
+       {"TR01_CFG_UAP_ECC_KEY_READ           ", TR01_CFG_UAP_ECC_KEY_READ_ADDR},
+       {"TR01_CFG_UAP_ECC_KEY_ERASE          ", TR01_CFG_UAP_ECC_KEY_ERASE_ADDR},
+       {"TR01_CFG_UAP_ECDSA_SIGN             ", TR01_CFG_UAP_ECDSA_SIGN_ADDR},
+       {"TR01_CFG_UAP_EDDSA_SIGN             ", TR01_CFG_UAP_EDDSA_SIGN_ADDR},
+       {"TR01_CFG_UAP_MCOUNTER_INIT          ", TR01_CFG_UAP_MCOUNTER_INIT_ADDR},
+       {"TR01_CFG_UAP_MCOUNTER_GET           ", TR01_CFG_UAP_MCOUNTER_GET_ADDR},
+       {"TR01_CFG_UAP_MCOUNTER_UPDATE        ", TR01_CFG_UAP_MCOUNTER_UPDATE_ADDR},
+       {"TR01_CFG_UAP_MAC_AND_DESTROY        ", TR01_CFG_UAP_MAC_AND_DESTROY_ADDR}};
+
+static lt_ret_t lt_r_config_read_all_out(lt_handle_t *h, void *ctx, size_t idx)
+{
+    LT_UNUSED(ctx);
+    return lt_out__r_config_read(h, cfg_desc_table[idx].addr);
+}
+
+static lt_ret_t lt_r_config_read_all_in(lt_handle_t *h, void *ctx, size_t idx)
+{
+    struct lt_config_t *config = ctx;
+    return lt_in__r_config_read(h, &config->obj[idx]);
+}
+
+static void lt_r_config_pipeline_result(void *ctx, size_t idx, lt_ret_t ret)
+{
+    // The first failure is returned by lt_l3_pipeline_run()
+    LT_UNUSED(ctx);
+    LT_UNUSED(idx);
+    LT_UNUSED(ret);
+}
+
+/** @brief Reads all R-Config objects with pipelined R_Config_Read commands. */
+static lt_ret_t lt_r_config_read_all(lt_handle_t *h, struct lt_config_t *config)
+{
+    static const lt_l3_pipeline_ops_t ops
+        = {.out = lt_r_config_read_all_out, .in = lt_r_config_read_all_in, .result = lt_r_config_pipeline_result};
+    uint8_t stage[sizeof(struct lt_l3_r_config_read_cmd_t)];
+
+    return lt_l3_pipeline_run(h, &ops, config, LT_CONFIG_OBJ_CNT, stage, sizeof(stage), true);
+}
+
+lt_ret_t lt_read_whole_R_config(lt_handle_t *h, struct lt_config_t *config)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !config) {
+        return LT_PARAM_ERR;
+    }
+
+    return lt_r_config_read_all(h, config);
+}
+
+lt_ret_t lt_write_whole_R_config(lt_handle_t *h, const struct lt_config_t *config)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !config) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_ret_t ret;
+
+    for (uint8_t i = 0; i < LT_CONFIG_OBJ_CNT; i++) {
+        ret = lt_r_config_write(h, cfg_desc_table[i].addr, config->obj[i]);
+        if (ret != LT_OK) {
+            return ret;
+        }
+    }
+
+    return LT_OK;
+}
+
+#if LT_R_CONFIG_MIRROR
+/** @brief Value of each R-Config object after R_Config_Erase. */
+#define LT_R_CONFIG_OBJ_ERASED 0xFFFFFFFF
+
+// Dirty flags of all objects have to fit into lt_r_config_mirror_t.dirty
+LT_STATIC_ASSERT(LT_CONFIG_OBJ_CNT <= 32)
+
+static void lt_r_config_mirror_update_dirty(lt_r_config_mirror_t *mirror, const enum lt_config_obj_idx_t idx)
+{
+    if (mirror->shadow.obj[idx] != mirror->chip.obj[idx]) {
+        mirror->dirty |= BIT(idx);
+    }
+    else {
+        mirror->dirty &= ~BIT(idx);
+    }
+}
+
+lt_ret_t lt_r_config_mirror_load(lt_handle_t *h)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_r_config_mirror_t *mirror = &h->r_config_mirror;
+    mirror->loaded = false;
+
+    lt_ret_t ret = lt_r_config_read_all(h, &mirror->chip);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    memcpy(&mirror->shadow, &mirror->chip, sizeof(mirror->shadow));
+    mirror->dirty = 0;
+    mirror->loaded = true;
+
+    return LT_OK;
+}
+
+lt_ret_t lt_r_config_mirror_get(lt_handle_t *h, const enum lt_config_obj_idx_t idx, uint32_t *obj)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !h->r_config_mirror.loaded || (idx >= LT_CONFIG_OBJ_CNT) || !obj) {
+        return LT_PARAM_ERR;
+    }
 
-const char *lt_ret_verbose(lt_ret_t ret)
+    *obj = h->r_config_mirror.shadow.obj[idx];
+
+    return LT_OK;
+}
+
+lt_ret_t lt_r_config_mirror_set(lt_handle_t *h, const enum lt_config_obj_idx_t idx, const uint32_t obj)
 {
-    if (ret < LT_RET_T_LAST_VALUE) return lt_ret_strs[ret];
+    LT_HANDLE_LOCK(h);
 
-    return "FATAL ERROR, unknown return value";
+    if (!h || !h->r_config_mirror.loaded || (idx >= LT_CONFIG_OBJ_CNT)) {
+        return LT_PARAM_ERR;
+    }
+
+    h->r_config_mirror.shadow.obj[idx] = obj;
+    lt_r_config_mirror_update_dirty(&h->r_config_mirror, idx);
+
+    return LT_OK;
 }
 
-//--------------------------------------------------------------------------------------------------------//
-#ifdef LT_HELPERS
+lt_ret_t lt_r_config_mirror_get_field(lt_handle_t *h, const enum lt_config_obj_idx_t idx, const uint32_t mask,
+                                      uint32_t *value)
+{
+    LT_HANDLE_LOCK(h);
 
-struct lt_config_obj_desc_t cfg_desc_table[LT_CONFIG_OBJ_CNT]
-    = {{"TR01_CFG_START_UP                   ", TR01_CFG_START_UP_ADDR},
-       {"TR01_CFG_SENSORS                    ", TR01_CFG_SENSORS_ADDR},
-       {"TR01_CFG_DEBUG                      ", TR01_CFG_DEBUG_ADDR},
-       {"TR01_CFG_GPO_ADDR                   ", TR01_CFG_GPO_ADDR},
-       {"TR01_CFG_SLEEP_MODE                 ", TR01_CFG_SLEEP_MODE_ADDR},
-       {"TR01_CFG_UAP_PAIRING_KEY_WRITE      ", TR01_CFG_UAP_PAIRING_KEY_WRITE_ADDR},
-       {"TR01_CFG_UAP_PAIRING_KEY_READ       ", TR01_CFG_UAP_PAIRING_KEY_READ_ADDR},
-       {"TR01_CFG_UAP_PAIRING_KEY_INVALIDATE ", TR01_CFG_UAP_PAIRING_KEY_INVALIDATE_ADDR},
-       {"TR01_CFG_UAP_R_CONFIG_WRITE_ERASE   ", TR01_CFG_UAP_R_CONFIG_WRITE_ERASE_ADDR},
-       {"TR01_CFG_UAP_R_CONFIG_READ          ", TR01_CFG_UAP_R_CONFIG_READ_ADDR},
-       {"TR01_CFG_UAP_I_CONFIG_WRITE         ", TR01_CFG_UAP_I_CONFIG_WRITE_ADDR},
-       {"TR01_CFG_UAP_I_CONFIG_READ          ", TR01_CFG_UAP_I_CONFIG_READ_ADDR},
-       {"TR01_CFG_UAP_PING                   ", TR01_CFG_UAP_PING_ADDR},
-       {"TR01_CFG_UAP_R_MEM_DATA_WRITE       ", TR01_CFG_UAP_R_MEM_DATA_WRITE_ADDR},
-       {"TR01_CFG_UAP_R_MEM_DATA_READ        ", TR01_CFG_UAP_R_MEM_DATA_READ_ADDR},
-       {"TR01_CFG_UAP_R_MEM_DATA_ERASE       ", TR01_CFG_UAP_R_MEM_DATA_ERASE_ADDR},
-       {"TR01_CFG_UAP_RANDOM_VALUE_GET       ", TR01_CFG_UAP_RANDOM_VALUE_GET_ADDR},
-       {"TR01_CFG_UAP_ECC_KEY_GENERATE       ", TR01_CFG_UAP_ECC_KEY_GENERATE_ADDR},
-       {"TR01_CFG_UAP_ECC_KEY_STORE          ", TR01_CFG_UAP_ECC_KEY_STORE_ADDR},
-       {"TR01_CFG_UAP_ECC_KEY_READ           ", TR01_CFG_UAP_ECC_KEY_READ_ADDR},
-       {"TR01_CFG_UAP_ECC_KEY_ERASE          ", TR01_CFG_UAP_ECC_KEY_ERASE_ADDR},
-       {"TR01_CFG_UAP_ECDSA_SIGN             ", TR01_CFG_UAP_ECDSA_SIGN_ADDR},
-       {"TR01_CFG_UAP_EDDSA_SIGN             ", TR01_CFG_UAP_EDDSA_SIGN_ADDR},
-       {"TR01_CFG_UAP_MCOUNTER_INIT          ", TR01_CFG_UAP_MCOUNTER_INIT_ADDR},
-       {"TR01_CFG_UAP_MCOUNTER_GET           ", TR01_CFG_UAP_MCOUNTER_GET_ADDR},
-       {"TR01_CFG_UAP_MCOUNTER_UPDATE        ", TR01_CFG_UAP_MCOUNTER_UPDATE_ADDR},
-       {"TR01_CFG_UAP_MAC_AND_DESTROY        ", TR01_CFG_UAP_MAC_AND_DESTROY_ADDR}};
+    if (!h || !h->r_config_mirror.loaded || (idx >= LT_CONFIG_OBJ_CNT) || !mask || !value) {
+        return LT_PARAM_ERR;
+    }
 
-lt_ret_t lt_read_whole_R_config(lt_handle_t *h, struct lt_config_t *config)
+    *value = FIELD_GET(mask, h->r_config_mirror.shadow.obj[idx]);
+
+    return LT_OK;
+}
+
+lt_ret_t lt_r_config_mirror_set_field(lt_handle_t *h, const enum lt_config_obj_idx_t idx, const uint32_t mask,
+                                      const uint32_t value)
 {
-    if (!h || !config) {
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !h->r_config_mirror.loaded || (idx >= LT_CONFIG_OBJ_CNT) || !mask) {
+        return LT_PARAM_ERR;
+    }
+    // Value must fit into the field
+    if (FIELD_GET(mask, FIELD_PREP(mask, value)) != value) {
         return LT_PARAM_ERR;
     }
 
-    lt_ret_t ret;
+    lt_r_config_mirror_t *mirror = &h->r_config_mirror;
+    mirror->shadow.obj[idx] = (mirror->shadow.obj[idx] & ~mask) | FIELD_PREP(mask, value);
+    lt_r_config_mirror_update_dirty(mirror, idx);
+
+    return LT_OK;
+}
+
+/** @brief Context of the pipeline writing dirty objects of the mirror. */
+struct lt_r_config_mirror_write_ctx_t {
+    lt_r_config_mirror_t *mirror;
+    uint8_t idx[LT_CONFIG_OBJ_CNT]; /**< Indexes of the dirty objects, in the order they are written */
+};
+
+static lt_ret_t lt_r_config_mirror_write_out(lt_handle_t *h, void *ctx, size_t idx)
+{
+    struct lt_r_config_mirror_write_ctx_t *c = ctx;
+    uint8_t i = c->idx[idx];
+    return lt_out__r_config_write(h, cfg_desc_table[i].addr, c->mirror->shadow.obj[i]);
+}
+
+static lt_ret_t lt_r_config_mirror_write_in(lt_handle_t *h, void *ctx, size_t idx)
+{
+    struct lt_r_config_mirror_write_ctx_t *c = ctx;
+    uint8_t i = c->idx[idx];
+
+    lt_ret_t ret = lt_in__r_config_write(h);
+    if (ret == LT_OK) {
+        c->mirror->chip.obj[i] = c->mirror->shadow.obj[i];
+        c->mirror->dirty &= ~BIT(i);
+    }
+
+    return ret;
+}
+
+static lt_ret_t lt_r_config_mirror_write_dirty(lt_handle_t *h, lt_r_config_mirror_t *mirror)
+{
+    static const lt_l3_pipeline_ops_t ops = {.out = lt_r_config_mirror_write_out,
+                                             .in = lt_r_config_mirror_write_in,
+                                             .result = lt_r_config_pipeline_result};
+    struct lt_r_config_mirror_write_ctx_t ctx = {.mirror = mirror};
+    uint8_t stage[sizeof(struct lt_l3_r_config_write_cmd_t)];
+    size_t cnt = 0;
 
     for (uint8_t i = 0; i < LT_CONFIG_OBJ_CNT; i++) {
-        ret = lt_r_config_read(h, cfg_desc_table[i].addr, &config->obj[i]);
-        if (ret != LT_OK) {
-            return ret;
+        if (mirror->dirty & BIT(i)) {
+            ctx.idx[cnt++] = i;
         }
     }
 
-    return LT_OK;
+    return lt_l3_pipeline_run(h, &ops, &ctx, cnt, stage, sizeof(stage), true);
 }
 
-lt_ret_t lt_write_whole_R_config(lt_handle_t *h, const struct lt_config_t *config)
+static lt_ret_t lt_r_config_mirror_erase_and_write(lt_handle_t *h, lt_r_config_mirror_t *mirror)
 {
-    if (!h || !config) {
+    lt_ret_t ret = lt_r_config_erase(h);
+    if (ret != LT_OK) {
+        return ret;
+    }
+    // lt_r_config_erase() unloaded the mirror, it is brought in line with the erased R-Config below
+    mirror->loaded = true;
+
+    // Objects which are requested to stay erased need not be written
+    for (uint8_t i = 0; i < LT_CONFIG_OBJ_CNT; i++) {
+        mirror->chip.obj[i] = LT_R_CONFIG_OBJ_ERASED;
+        lt_r_config_mirror_update_dirty(mirror, i);
+    }
+
+    return lt_r_config_mirror_write_dirty(h, mirror);
+}
+
+lt_ret_t lt_r_config_mirror_commit(lt_handle_t *h)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !h->r_config_mirror.loaded) {
         return LT_PARAM_ERR;
     }
 
-    lt_ret_t ret;
+    lt_r_config_mirror_t *mirror = &h->r_config_mirror;
+    if (!mirror->dirty) {
+        return LT_OK;
+    }
 
+    // TROPIC01 accepts R_Config_Write only for an erased object, so changing an already written object
+    // requires erasing the whole R-Config
     for (uint8_t i = 0; i < LT_CONFIG_OBJ_CNT; i++) {
-        ret = lt_r_config_write(h, cfg_desc_table[i].addr, config->obj[i]);
-        if (ret != LT_OK) {
-            return ret;
+        if ((mirror->dirty & BIT(i)) && (mirror->chip.obj[i] != LT_R_CONFIG_OBJ_ERASED)) {
+            return lt_r_config_mirror_erase_and_write(h, mirror);
         }
     }
 
-    return LT_OK;
+    lt_ret_t ret = lt_r_config_mirror_write_dirty(h, mirror);
+    if (ret == LT_L3_FAIL) {
+        // Object reads as erased, but was written with all ones before
+        return lt_r_config_mirror_erase_and_write(h, mirror);
+    }
+
+    return ret;
 }
+#endif
 
 lt_ret_t lt_read_whole_I_config(lt_handle_t *h, struct lt_config_t *config)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !config) {
         return LT_PARAM_ERR;
     }
@@ -1533,35 +2909,83 @@ lt_ret_t lt_read_whole_I_config(lt_handle_t *h, struct lt_config_t *config)
     return LT_OK;
 }
 
-lt_ret_t lt_write_whole_I_config(lt_handle_t *h, const struct lt_config_t *config)
+/**
+ * @brief Clears only those I-Config bits which are set on the chip and zero in `config`.
+ *
+ * @param h           Device's handle
+ * @param config      Requested I-Config
+ * @param dry_run     When true, nothing is written, only the commands are counted
+ * @param write_cnt   Number of I_Config_Write commands sent (or to be sent in dry run), can be NULL
+ *
+ * @retval            LT_OK Function executed successfully
+ * @retval            other Function did not execute successully
+ */
+static lt_ret_t lt_write_I_config_diff(lt_handle_t *h, const struct lt_config_t *config, const bool dry_run,
+                                       uint16_t *write_cnt)
 {
-    if (!h || !config) {
-        return LT_PARAM_ERR;
-    }
+    struct lt_config_t current;
+    uint16_t cnt = 0;
 
-    lt_ret_t ret;
-    uint32_t cfg_obj;
-    enum lt_config_obj_addr_t addr;
+    // I-Config bits can only go from 1 to 0, so the bits already cleared on the chip are skipped
+    lt_ret_t ret = lt_read_whole_I_config(h, &current);
+    if (ret != LT_OK) {
+        return ret;
+    }
 
     for (uint8_t i = 0; i < LT_CONFIG_OBJ_CNT; i++) {
-        cfg_obj = config->obj[i];
-        addr = cfg_desc_table[i].addr;
+        uint32_t to_clear = current.obj[i] & ~config->obj[i];
+        enum lt_config_obj_addr_t addr = cfg_desc_table[i].addr;
         for (uint8_t j = 0; j <= 31; j++) {
-            if (!FIELD_GET(BIT(j), cfg_obj)) {
+            if (!FIELD_GET(BIT(j), to_clear)) {
+                continue;
+            }
+            if (!dry_run) {
                 ret = lt_i_config_write(h, addr, j);
                 if (ret != LT_OK) {
+                    if (write_cnt) {
+                        *write_cnt = cnt;
+                    }
                     return ret;
                 }
             }
+            cnt++;
         }
     }
 
+    if (write_cnt) {
+        *write_cnt = cnt;
+    }
+
     return LT_OK;
 }
 
+lt_ret_t lt_write_whole_I_config(lt_handle_t *h, const struct lt_config_t *config)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !config) {
+        return LT_PARAM_ERR;
+    }
+
+    return lt_write_I_config_diff(h, config, false, NULL);
+}
+
+lt_ret_t lt_write_whole_I_config_dry_run(lt_handle_t *h, const struct lt_config_t *config, uint16_t *write_cnt)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !config || !write_cnt) {
+        return LT_PARAM_ERR;
+    }
+
+    return lt_write_I_config_diff(h, config, true, write_cnt);
+}
+
 lt_ret_t lt_verify_chip_and_start_secure_session(lt_handle_t *h, const uint8_t *shipriv, const uint8_t *shipub,
                                                  const lt_pkey_index_t pkey_index)
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !shipriv || !shipub || (pkey_index > TR01_PAIRING_KEY_SLOT_INDEX_3)) {
         return LT_PARAM_ERR;
     }
@@ -1815,6 +3239,8 @@ lt_ret_t lt_print_chip_id(const struct lt_chip_id_t *chip_id, int (*print_func)(
 lt_ret_t lt_do_mutable_fw_update(lt_handle_t *h, const uint8_t *update_data, const uint16_t update_data_size,
                                  const lt_bank_id_t bank_id)
 {
+    LT_HANDLE_LOCK(h);
+
 #ifdef ABAB
     if (!h || !update_data || update_data_size > TR01_MUTABLE_FW_UPDATE_SIZE_MAX
         || ((bank_id != TR01_FW_BANK_FW1) && (bank_id != TR01_FW_BANK_FW2) && (bank_id != TR01_FW_BANK_SPECT1)
@@ -1856,8 +3282,162 @@ lt_ret_t lt_do_mutable_fw_update(lt_handle_t *h, const uint8_t *update_data, con
     return LT_OK;
 }
 
+/**
+ * @brief Records a chunk acknowledged by TROPIC01 and reports progress of the streamed update.
+ *
+ * @param stream        Source of the update image
+ * @param progress      Progress of the update
+ * @param next_offset   Offset in the image right after the acknowledged chunk
+ * @param start_offset  Offset at which the current attempt started
+ * @param start_ms      Time at which the current attempt started
+ */
+static void lt_fw_update_stream_ack(const lt_fw_update_stream_t *stream, lt_fw_update_progress_t *progress,
+                                    const uint32_t next_offset, const uint32_t start_offset, const uint32_t start_ms)
+{
+    progress->acked_offset = next_offset;
+    progress->acked_chunks++;
+
+    if (stream->now_ms) {
+        progress->elapsed_ms = stream->now_ms(stream->ctx) - start_ms;
+        if (progress->elapsed_ms) {
+            progress->bytes_per_s
+                = (uint32_t)(((uint64_t)(next_offset - start_offset) * 1000u) / progress->elapsed_ms);
+        }
+    }
+
+    if (stream->progress) {
+        stream->progress(stream->ctx, progress);
+    }
+}
+
+lt_ret_t lt_do_mutable_fw_update_stream(lt_handle_t *h, const lt_fw_update_stream_t *stream,
+                                        const lt_bank_id_t bank_id, lt_fw_update_progress_t *progress)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !stream || !stream->read || !progress || (stream->image_size == 0)
+        || (stream->image_size > TR01_MUTABLE_FW_UPDATE_SIZE_MAX)) {
+        return LT_PARAM_ERR;
+    }
+#ifdef ABAB
+    if ((bank_id != TR01_FW_BANK_FW1) && (bank_id != TR01_FW_BANK_FW2) && (bank_id != TR01_FW_BANK_SPECT1)
+        && (bank_id != TR01_FW_BANK_SPECT2)) {
+        return LT_PARAM_ERR;
+    }
+#elif ACAB
+    LT_UNUSED(bank_id);  // bank_id is not used with ACAB, chip handles banks on its own
+    if (stream->image_size <= TR01_L2_MUTABLE_FW_UPDATE_REQ_LEN + 1) {
+        return LT_PARAM_ERR;
+    }
+#else
+#error "Undefined silicon revision. Please define either ABAB or ACAB."
+#endif
+
+    if (progress->acked_offset == 0) {
+        memset(progress, 0, sizeof(*progress));
+        progress->image_size = stream->image_size;
+    }
+    else if ((progress->image_size != stream->image_size) || (progress->acked_offset > stream->image_size)) {
+        // Progress of a different image
+        return LT_PARAM_ERR;
+    }
+
+    const uint32_t start_offset = progress->acked_offset;
+    const uint32_t start_ms = stream->now_ms ? stream->now_ms(stream->ctx) : 0;
+    progress->elapsed_ms = 0;
+    progress->bytes_per_s = 0;
+    lt_ret_t ret;
+
+#ifdef ABAB
+    // Setup a request pointer to l2 buffer, which is placed in handle
+    struct lt_l2_mutable_fw_update_req_t *p_l2_req = (struct lt_l2_mutable_fw_update_req_t *)h->l2.buff;
+
+    if (progress->acked_offset == 0) {
+        ret = lt_mutable_fw_erase(h, bank_id);
+        if (ret != LT_OK) {
+            return ret;
+        }
+    }
+
+    while (progress->acked_offset < progress->image_size) {
+        uint32_t offset = progress->acked_offset;
+        uint16_t len = (progress->image_size - offset) < 128 ? (uint16_t)(progress->image_size - offset) : 128;
+
+        // Chunk is read directly into the l2 buffer
+        ret = stream->read(stream->ctx, offset, p_l2_req->data, len);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        p_l2_req->req_id = TR01_L2_MUTABLE_FW_UPDATE_REQ_ID;
+        p_l2_req->req_len = TR01_L2_MUTABLE_FW_UPDATE_REQ_LEN_MIN + len;
+        p_l2_req->bank_id = bank_id;
+        p_l2_req->offset = (uint16_t)offset;
+
+        ret = lt_mutable_fw_update_transfer(h);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        lt_fw_update_stream_ack(stream, progress, offset + len, start_offset, start_ms);
+    }
+
+#elif ACAB
+    // Setup request pointers to l2 buffer, which is placed in handle
+    struct lt_l2_mutable_fw_update_req_t *p_l2_req = (struct lt_l2_mutable_fw_update_req_t *)h->l2.buff;
+    struct lt_l2_mutable_fw_update_data_req_t *p_l2_data_req = (struct lt_l2_mutable_fw_update_data_req_t *)h->l2.buff;
+
+    // Image starts with the update 'request', its layout matches the l2 frame from the length byte on
+    if (progress->acked_offset == 0) {
+        ret = stream->read(stream->ctx, 0, &p_l2_req->req_len, TR01_L2_MUTABLE_FW_UPDATE_REQ_LEN + 1);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        p_l2_req->req_id = TR01_L2_MUTABLE_FW_UPDATE_REQ_ID;
+        p_l2_req->req_len = TR01_L2_MUTABLE_FW_UPDATE_REQ_LEN;
+
+        ret = lt_mutable_fw_update_transfer(h);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        lt_fw_update_stream_ack(stream, progress, TR01_L2_MUTABLE_FW_UPDATE_REQ_LEN + 1, start_offset, start_ms);
+    }
+
+    // The rest are 'data' chunks, each prefixed with its length byte
+    while (progress->acked_offset < progress->image_size) {
+        uint32_t offset = progress->acked_offset;
+
+        ret = stream->read(stream->ctx, offset, &p_l2_data_req->req_len, 1);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        uint8_t len = p_l2_data_req->req_len;
+        if ((len > sizeof(p_l2_data_req->hash) + sizeof(p_l2_data_req->offset) + sizeof(p_l2_data_req->data))
+            || (offset + 1 + len > progress->image_size)) {
+            // Malformed image
+            return LT_FAIL;
+        }
+
+        ret = stream->read(stream->ctx, offset + 1, p_l2_data_req->hash, len);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        p_l2_data_req->req_id = TR01_L2_MUTABLE_FW_UPDATE_DATA_REQ;
+
+        ret = lt_mutable_fw_update_transfer(h);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        lt_fw_update_stream_ack(stream, progress, offset + 1 + len, start_offset, start_ms);
+    }
+
+#endif
+
+    return LT_OK;
+}
+
 lt_ret_t lt_print_fw_header(lt_handle_t *h, const lt_bank_id_t bank_id, int (*print_func)(const char *format, ...))
 {
+    LT_HANDLE_LOCK(h);
+
     if (!h || !print_func) {
         return LT_PARAM_ERR;
     }
@@ -1932,4 +3512,78 @@ lt_ret_t lt_print_fw_header(lt_handle_t *h, const lt_bank_id_t bank_id, int (*pr
 
     return LT_OK;
 }
+
+lt_ret_t lt_random_drbg_init(lt_handle_t *h, lt_random_drbg_t *drbg, const uint32_t reseed_interval)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !drbg) {
+        return LT_PARAM_ERR;
+    }
+
+    // Entropy input and nonce, both taken from TROPIC01's RNG
+    uint8_t seed[LT_HMAC_SHA256_HASH_LEN + LT_HMAC_SHA256_HASH_LEN / 2];
+    lt_ret_t ret = lt_random_value_get(h, seed, sizeof(seed));
+    if (ret != LT_OK) {
+        memset(seed, 0, sizeof(seed));
+        return ret;
+    }
+
+    lt_hmac_drbg_instantiate(drbg->key, drbg->v, seed, LT_HMAC_SHA256_HASH_LEN, seed + LT_HMAC_SHA256_HASH_LEN,
+                             sizeof(seed) - LT_HMAC_SHA256_HASH_LEN, NULL, 0);
+    memset(seed, 0, sizeof(seed));
+
+    drbg->reseed_interval = reseed_interval ? reseed_interval : LT_RANDOM_DRBG_RESEED_INTERVAL_DEFAULT;
+    drbg->bytes_since_reseed = 0;
+    drbg->seeded = true;
+
+    return LT_OK;
+}
+
+lt_ret_t lt_random_drbg_fill(lt_handle_t *h, lt_random_drbg_t *drbg, uint8_t *buff, const size_t len)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !drbg || !buff || !drbg->seeded) {
+        return LT_PARAM_ERR;
+    }
+
+    size_t remaining = len;
+    while (remaining) {
+        if (drbg->bytes_since_reseed >= drbg->reseed_interval) {
+            uint8_t seed[LT_HMAC_SHA256_HASH_LEN];
+            lt_ret_t ret = lt_random_value_get(h, seed, sizeof(seed));
+            if (ret != LT_OK) {
+                memset(seed, 0, sizeof(seed));
+                return ret;
+            }
+            lt_hmac_drbg_reseed(drbg->key, drbg->v, seed, sizeof(seed), NULL, 0);
+            memset(seed, 0, sizeof(seed));
+            drbg->bytes_since_reseed = 0;
+        }
+
+        size_t chunk = drbg->reseed_interval - drbg->bytes_since_reseed;
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+
+        lt_hmac_drbg_generate(drbg->key, drbg->v, NULL, 0, buff, chunk);
+        drbg->bytes_since_reseed += chunk;
+        buff += chunk;
+        remaining -= chunk;
+    }
+
+    return LT_OK;
+}
+
+lt_ret_t lt_random_drbg_deinit(lt_random_drbg_t *drbg)
+{
+    if (!drbg) {
+        return LT_PARAM_ERR;
+    }
+
+    memset(drbg, 0, sizeof(lt_random_drbg_t));
+
+    return LT_OK;
+}
 #endif
@@ -0,0 +1,334 @@
+/**
+ * @file libtropic_cert.c
+ * @brief Certificate chain verification
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include "libtropic_cert.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_logging.h"
+#include "lt_asn1_der.h"
+#include "lt_ecdsa.h"
+#include "lt_ed25519.h"
+#include "lt_sha256.h"
+
+/** @brief Content of OBJECT_IDENTIFIER 1.2.840.10045.2.1 (id-ecPublicKey). */
+static const uint8_t lt_cert_oid_ec_pubkey[] = {0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x02, 0x01};
+/** @brief Content of OBJECT_IDENTIFIER 1.2.840.10045.3.1.7 (prime256v1). */
+static const uint8_t lt_cert_oid_p256[] = {0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x03, 0x01, 0x07};
+/** @brief Content of OBJECT_IDENTIFIER 1.2.840.10045.4.3.2 (ecdsa-with-SHA256). */
+static const uint8_t lt_cert_oid_ecdsa_sha256[] = {0x2A, 0x86, 0x48, 0xCE, 0x3D, 0x04, 0x03, 0x02};
+/** @brief Content of OBJECT_IDENTIFIER 1.3.101.112 (Ed25519), used both for keys and signatures. */
+static const uint8_t lt_cert_oid_ed25519[] = {0x2B, 0x65, 0x70};
+
+/** @brief Size of an uncompressed P-256 public key (0x04 || X || Y). */
+#define LT_CERT_P256_PUBKEY_LEN 65
+/** @brief Size of one P-256 signature component. */
+#define LT_CERT_P256_SCALAR_LEN 32
+/** @brief Size of an Ed25519 public key. */
+#define LT_CERT_ED25519_PUBKEY_LEN 32
+/** @brief Size of an Ed25519 signature. */
+#define LT_CERT_ED25519_SIG_LEN 64
+/** @brief Length of a UTCTime "YYMMDDHHMMSSZ". */
+#define LT_CERT_UTC_TIME_LEN 13
+
+/**
+ * @brief Converts validity time of a certificate to GeneralizedTime.
+ *
+ * @param when    UTCTime or GeneralizedTime element
+ * @param out     LT_CERT_TIME_LEN characters of GeneralizedTime
+ * @return        LT_OK if successful, LT_CERT_UNSUPPORTED for times not in UTC or with fractions of seconds
+ */
+static lt_ret_t lt_cert_time(const lt_asn1der_tlv_t *when, char *out)
+{
+    if ((when->tag == LT_ASN1DER_GENERALIZED_TIME) && (when->value.len == LT_CERT_TIME_LEN)) {
+        memcpy(out, when->value.ptr, LT_CERT_TIME_LEN);
+    }
+    else if ((when->tag == LT_ASN1DER_UTC_TIME) && (when->value.len == LT_CERT_UTC_TIME_LEN)) {
+        // RFC 5280: YY >= 50 means 19YY, YY < 50 means 20YY
+        const bool c19 = when->value.ptr[0] >= '5';
+        out[0] = c19 ? '1' : '2';
+        out[1] = c19 ? '9' : '0';
+        memcpy(&out[2], when->value.ptr, LT_CERT_UTC_TIME_LEN);
+    }
+    else {
+        return LT_CERT_UNSUPPORTED;
+    }
+
+    return (out[LT_CERT_TIME_LEN - 1] == 'Z') ? LT_OK : LT_CERT_UNSUPPORTED;
+}
+
+/** @brief Checks that `now` lies within the validity of the certificate. */
+static lt_ret_t lt_cert_check_validity(const lt_asn1der_cert_t *cert, const char *now)
+{
+    char not_before[LT_CERT_TIME_LEN], not_after[LT_CERT_TIME_LEN];
+
+    lt_ret_t ret = lt_cert_time(&cert->not_before, not_before);
+    if (ret == LT_OK) {
+        ret = lt_cert_time(&cert->not_after, not_after);
+    }
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    // Fixed-width GeneralizedTime compares chronologically as a string
+    if ((memcmp(now, not_before, LT_CERT_TIME_LEN) < 0) || (memcmp(now, not_after, LT_CERT_TIME_LEN) > 0)) {
+        LT_LOG_ERROR("Certificate is not valid at %.*s", LT_CERT_TIME_LEN, now);
+        return LT_CERT_CHAIN_INVALID;
+    }
+
+    return LT_OK;
+}
+
+/**
+ * @brief Converts an ECDSA-Sig-Value ::= SEQUENCE { r INTEGER, s INTEGER } to fixed-size R || S.
+ *
+ * @param sig     DER signature
+ * @param rs      2 * LT_CERT_P256_SCALAR_LEN bytes of R and S
+ * @return        LT_OK if successful, LT_CERT_CHAIN_INVALID if the signature is malformed
+ */
+static lt_ret_t lt_cert_ecdsa_rs(const lt_asn1der_span_t *sig, uint8_t *rs)
+{
+    lt_asn1der_cursor_t cur, seq;
+    lt_asn1der_tlv_t tlv;
+
+    lt_asn1der_cursor_init(&cur, sig->ptr, sig->len);
+    if (lt_asn1der_expect(&cur, LT_ASN1DER_SEQUENCE, &tlv) != LT_OK) {
+        return LT_CERT_CHAIN_INVALID;
+    }
+    lt_asn1der_enter(&cur, &tlv, &seq);
+
+    memset(rs, 0, 2 * LT_CERT_P256_SCALAR_LEN);
+    for (int i = 0; i < 2; i++) {
+        if (lt_asn1der_expect(&seq, LT_ASN1DER_INTEGER, &tlv) != LT_OK) {
+            return LT_CERT_CHAIN_INVALID;
+        }
+        const uint8_t *p = tlv.value.ptr;
+        uint32_t len = tlv.value.len;
+        while ((len > 0) && (*p == 0)) {
+            p++;
+            len--;
+        }
+        if (len > LT_CERT_P256_SCALAR_LEN) {
+            return LT_CERT_CHAIN_INVALID;
+        }
+        memcpy(&rs[(i + 1) * LT_CERT_P256_SCALAR_LEN - len], p, len);
+    }
+
+    return LT_OK;
+}
+
+/**
+ * @brief Verifies the signature of a certificate with the crypto HAL.
+ *
+ * @param cert    Certificate
+ * @param issuer  Certificate of its issuer
+ * @return        LT_OK if the signature is valid, LT_CERT_CHAIN_INVALID if not, LT_CERT_UNSUPPORTED if the HAL does
+ *                not support the algorithm
+ */
+static lt_ret_t lt_cert_verify_sig_builtin(const lt_asn1der_cert_t *cert, const lt_asn1der_cert_t *issuer)
+{
+    if (lt_asn1der_span_eq(&cert->sig_alg, lt_cert_oid_ecdsa_sha256, sizeof(lt_cert_oid_ecdsa_sha256))
+        && lt_asn1der_span_eq(&issuer->key_alg, lt_cert_oid_ec_pubkey, sizeof(lt_cert_oid_ec_pubkey))
+        && lt_asn1der_span_eq(&issuer->key_params, lt_cert_oid_p256, sizeof(lt_cert_oid_p256))) {
+        uint8_t rs[2 * LT_CERT_P256_SCALAR_LEN];
+
+        if ((issuer->pub_key.len != LT_CERT_P256_PUBKEY_LEN) || (issuer->pub_key.ptr[0] != 0x04)) {
+            return LT_CERT_UNSUPPORTED;
+        }
+        lt_ret_t ret = lt_cert_ecdsa_rs(&cert->signature, rs);
+        if (ret != LT_OK) {
+            return ret;
+        }
+
+        return lt_ecdsa_verify(cert->tbs.ptr, cert->tbs.len, &issuer->pub_key.ptr[1], rs) ? LT_CERT_CHAIN_INVALID
+                                                                                          : LT_OK;
+    }
+
+    if (lt_asn1der_span_eq(&cert->sig_alg, lt_cert_oid_ed25519, sizeof(lt_cert_oid_ed25519))
+        && lt_asn1der_span_eq(&issuer->key_alg, lt_cert_oid_ed25519, sizeof(lt_cert_oid_ed25519))) {
+        if ((issuer->pub_key.len != LT_CERT_ED25519_PUBKEY_LEN) || (cert->signature.len != LT_CERT_ED25519_SIG_LEN)
+            || (cert->tbs.len > UINT16_MAX)) {
+            return LT_CERT_CHAIN_INVALID;
+        }
+
+        return lt_ed25519_sign_open(cert->tbs.ptr, (uint16_t)cert->tbs.len, issuer->pub_key.ptr, cert->signature.ptr)
+                   ? LT_CERT_CHAIN_INVALID
+                   : LT_OK;
+    }
+
+    return LT_CERT_UNSUPPORTED;
+}
+
+/** @brief Verifies the signature of a certificate with the crypto HAL or with the callback. */
+static lt_ret_t lt_cert_verify_sig(const lt_cert_verify_cfg_t *cfg, const lt_asn1der_cert_t *cert,
+                                   const lt_asn1der_cert_t *issuer)
+{
+    lt_ret_t ret = lt_cert_verify_sig_builtin(cert, issuer);
+    if ((ret != LT_CERT_UNSUPPORTED) || !cfg->verify_sig) {
+        return ret;
+    }
+
+    // Lengths fit, certificates come from the Certificate Store with 16-bit lengths
+    const lt_cert_signed_t signed_cert = {.issuer_spki = issuer->spki.ptr,
+                                          .issuer_spki_len = (uint16_t)issuer->spki.len,
+                                          .sig_alg = cert->sig_alg.ptr,
+                                          .sig_alg_len = (uint16_t)cert->sig_alg.len,
+                                          .tbs = cert->tbs.ptr,
+                                          .tbs_len = (uint16_t)cert->tbs.len,
+                                          .sig = cert->signature.ptr,
+                                          .sig_len = (uint16_t)cert->signature.len};
+
+    return cfg->verify_sig(cfg->verify_sig_ctx, &signed_cert);
+}
+
+/** @brief Computes the digest identifying the chain in the cache. */
+static void lt_cert_chain_digest(const struct lt_cert_store_t *store, uint8_t *digest)
+{
+    struct lt_crypto_sha256_ctx_t hctx;
+
+    lt_sha256_init(&hctx);
+    lt_sha256_start(&hctx);
+    for (int i = 0; i < LT_NUM_CERTIFICATES; i++) {
+        const uint8_t len[2] = {(uint8_t)(store->cert_len[i] >> 8), (uint8_t)store->cert_len[i]};
+        lt_sha256_update(&hctx, len, sizeof(len));
+        lt_sha256_update(&hctx, store->certs[i], store->cert_len[i]);
+    }
+    lt_sha256_finish(&hctx, digest);
+}
+
+static bool lt_cert_chain_cache_find(const lt_cert_chain_cache_t *cache, const uint8_t *digest)
+{
+    for (uint8_t i = 0; i < cache->count; i++) {
+        if (!memcmp(cache->digests[i], digest, LT_CERT_CHAIN_DIGEST_SIZE)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void lt_cert_chain_cache_add(lt_cert_chain_cache_t *cache, const uint8_t *digest)
+{
+    if (cache->next >= LT_CERT_CHAIN_CACHE_ENTRIES) {
+        cache->next = 0;
+    }
+    memcpy(cache->digests[cache->next], digest, LT_CERT_CHAIN_DIGEST_SIZE);
+    cache->next = (uint8_t)((cache->next + 1) % LT_CERT_CHAIN_CACHE_ENTRIES);
+    if (cache->count < LT_CERT_CHAIN_CACHE_ENTRIES) {
+        cache->count++;
+    }
+}
+
+lt_ret_t lt_cert_verify_chain(const struct lt_cert_store_t *store, const lt_cert_verify_cfg_t *cfg)
+{
+    if (!store || !cfg || !cfg->anchor || (cfg->now && (strlen(cfg->now) != LT_CERT_TIME_LEN))) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_asn1der_cert_t certs[LT_NUM_CERTIFICATES];
+    lt_ret_t ret;
+
+    // Cheap checks are done every time, so a cached digest only stands for the signatures
+    for (int i = 0; i < LT_NUM_CERTIFICATES; i++) {
+        ret = lt_asn1der_parse_cert(store->certs[i], store->cert_len[i], &certs[i]);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        // Only the signed one is protected by the signature, RFC 5280 requires both to be the same
+        if (!lt_asn1der_span_eq(&certs[i].sig_id, certs[i].tbs_sig_id.ptr, certs[i].tbs_sig_id.len)) {
+            LT_LOG_ERROR("Signature algorithm of certificate %d differs from the one in its TBSCertificate", i);
+            return LT_CERT_CHAIN_INVALID;
+        }
+        if (cfg->now) {
+            ret = lt_cert_check_validity(&certs[i], cfg->now);
+            if (ret != LT_OK) {
+                return ret;
+            }
+        }
+    }
+    for (int i = 0; i < LT_NUM_CERTIFICATES - 1; i++) {
+        if ((certs[i].issuer.len != certs[i + 1].subject.len)
+            || memcmp(certs[i].issuer.ptr, certs[i + 1].subject.ptr, certs[i].issuer.len)) {
+            LT_LOG_ERROR("Issuer of certificate %d is not the subject of certificate %d", i, i + 1);
+            return LT_CERT_CHAIN_INVALID;
+        }
+    }
+    if ((store->cert_len[LT_CERT_KIND_TROPIC_ROOT] != cfg->anchor_len)
+        || memcmp(store->certs[LT_CERT_KIND_TROPIC_ROOT], cfg->anchor, cfg->anchor_len)) {
+        LT_LOG_ERROR("Root certificate is not the trust anchor");
+        return LT_CERT_CHAIN_INVALID;
+    }
+
+    uint8_t digest[LT_CERT_CHAIN_DIGEST_SIZE];
+    if (cfg->cache) {
+        lt_cert_chain_digest(store, digest);
+        if (lt_cert_chain_cache_find(cfg->cache, digest)) {
+            cfg->cache->hits++;
+            return LT_OK;
+        }
+        cfg->cache->misses++;
+    }
+
+    // The root is trusted as the anchor, its self-signature adds nothing
+    for (int i = 0; i < LT_NUM_CERTIFICATES - 1; i++) {
+        ret = lt_cert_verify_sig(cfg, &certs[i], &certs[i + 1]);
+        if (ret != LT_OK) {
+            LT_LOG_ERROR("Signature of certificate %d not verified, ret=%d", i, ret);
+            return ret;
+        }
+    }
+
+    if (cfg->cache) {
+        lt_cert_chain_cache_add(cfg->cache, digest);
+    }
+
+    return LT_OK;
+}
+
+lt_ret_t lt_cert_verify_chip_and_start_secure_session(lt_handle_t *h, const lt_cert_verify_cfg_t *cfg,
+                                                      const uint8_t *shipriv, const uint8_t *shipub,
+                                                      const lt_pkey_index_t pkey_index)
+{
+    if (!h || !cfg || !shipriv || !shipub || (pkey_index > TR01_PAIRING_KEY_SLOT_INDEX_3)) {
+        return LT_PARAM_ERR;
+    }
+
+    uint8_t cert_ese[TR01_L2_GET_INFO_REQ_CERT_SIZE_SINGLE] = {0};
+    uint8_t cert_xxxx[TR01_L2_GET_INFO_REQ_CERT_SIZE_SINGLE] = {0};
+    uint8_t cert_tr01[TR01_L2_GET_INFO_REQ_CERT_SIZE_SINGLE] = {0};
+    uint8_t cert_root[TR01_L2_GET_INFO_REQ_CERT_SIZE_SINGLE] = {0};
+
+    struct lt_cert_store_t cert_store
+        = {.cert_len = {0, 0, 0, 0},
+           .buf_len = {TR01_L2_GET_INFO_REQ_CERT_SIZE_SINGLE, TR01_L2_GET_INFO_REQ_CERT_SIZE_SINGLE,
+                       TR01_L2_GET_INFO_REQ_CERT_SIZE_SINGLE, TR01_L2_GET_INFO_REQ_CERT_SIZE_SINGLE},
+           .certs = {cert_ese, cert_xxxx, cert_tr01, cert_root}};
+
+    lt_ret_t ret = lt_get_info_cert_store(h, &cert_store);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    ret = lt_cert_verify_chain(&cert_store, cfg);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    uint8_t stpub[TR01_STPUB_LEN] = {0};
+    ret = lt_get_st_pub(&cert_store, stpub);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    return lt_session_start(h, stpub, pkey_index, shipriv, shipub);
+}
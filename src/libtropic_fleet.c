@@ -0,0 +1,309 @@
+/**
+ * @file libtropic_fleet.c
+ * @brief Fleet firmware update
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include "libtropic_fleet.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+
+#ifdef LT_HELPERS
+
+/** @brief Number of banks of each firmware. */
+#define LT_FLEET_BANK_CNT 2
+
+static const lt_bank_id_t lt_fleet_cpu_banks[LT_FLEET_BANK_CNT] = {TR01_FW_BANK_FW1, TR01_FW_BANK_FW2};
+static const lt_bank_id_t lt_fleet_spect_banks[LT_FLEET_BANK_CNT] = {TR01_FW_BANK_SPECT1, TR01_FW_BANK_SPECT2};
+
+static void lt_fleet_set_stage(const lt_fleet_t *fleet, lt_fleet_chip_t *chip, const lt_fleet_stage_t stage)
+{
+    chip->stage = stage;
+    if (fleet->status) {
+        fleet->status(fleet->ctx, chip);
+    }
+}
+
+static lt_ret_t lt_fleet_fail(const lt_fleet_t *fleet, lt_fleet_chip_t *chip, const lt_ret_t ret)
+{
+    chip->failed_stage = chip->stage;
+    chip->ret = ret;
+    lt_fleet_set_stage(fleet, chip, LT_FLEET_FAILED);
+
+    return ret;
+}
+
+static lt_ret_t lt_fleet_reboot(lt_handle_t *h, const lt_startup_id_t startup_id)
+{
+    lt_ret_t ret = lt_reboot(h, startup_id);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    lt_tr01_mode_t expected = (startup_id == TR01_MAINTENANCE_REBOOT) ? LT_TR01_MAINTENANCE_MODE : LT_TR01_APP_MODE;
+    if (h->l2.mode != expected) {
+        return LT_FAIL;
+    }
+
+    return LT_OK;
+}
+
+/**
+ * @brief Reads version of firmware in a bank, 0 for an empty bank.
+ *
+ * @param h        Device's handle
+ * @param bank_id  Bank
+ * @param version  Version from the bank header
+ */
+static lt_ret_t lt_fleet_bank_version(lt_handle_t *h, const lt_bank_id_t bank_id, uint32_t *version)
+{
+    uint8_t header[TR01_L2_GET_INFO_FW_HEADER_SIZE];
+    uint16_t header_size;
+
+    lt_ret_t ret = lt_get_info_fw_bank(h, bank_id, header, sizeof(header), &header_size);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    if (header_size == TR01_L2_GET_INFO_FW_HEADER_SIZE_BOOT_V1) {
+        const struct lt_header_boot_v1_t *p_h = (const struct lt_header_boot_v1_t *)header;
+        *version = (uint32_t)p_h->version[0] | ((uint32_t)p_h->version[1] << 8) | ((uint32_t)p_h->version[2] << 16)
+                   | ((uint32_t)p_h->version[3] << 24);
+    }
+    else if (header_size == TR01_L2_GET_INFO_FW_HEADER_SIZE_BOOT_V2) {
+        struct lt_header_boot_v2_t p_h;
+        memcpy(&p_h, header, sizeof(p_h));
+        *version = p_h.ver;
+    }
+    else if (header_size == TR01_L2_GET_INFO_FW_HEADER_SIZE_BOOT_V2_EMPTY_BANK) {
+        *version = 0;
+    }
+    else {
+        return LT_FAIL;
+    }
+
+    return LT_OK;
+}
+
+/**
+ * @brief Returns bit mask of banks which do not hold the version of the image.
+ *
+ * @param h      Device's handle
+ * @param image  Image
+ * @param banks  Banks of the image's firmware
+ * @param stale  Bit `i` is set when `banks[i]` has to be updated
+ */
+static lt_ret_t lt_fleet_stale_banks(lt_handle_t *h, const lt_fleet_image_t *image, const lt_bank_id_t *banks,
+                                     uint8_t *stale)
+{
+    *stale = 0;
+    for (uint8_t i = 0; i < LT_FLEET_BANK_CNT; i++) {
+        uint32_t version;
+        lt_ret_t ret = lt_fleet_bank_version(h, banks[i], &version);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        if ((image->version == 0) || (version != image->version)) {
+            *stale |= (uint8_t)(1u << i);
+        }
+    }
+
+    return LT_OK;
+}
+
+/** @brief Tells whether the image is written in the given Maintenance mode session. */
+static bool lt_fleet_write_in_round(const uint8_t stale, const uint8_t round)
+{
+#ifdef ABAB
+    return (stale >> round) & 1u;
+#elif ACAB
+    // Chip selects the bank on its own, only the number of stale banks matters
+    return round < ((stale & 1u) + ((stale >> 1) & 1u));
+#else
+#error "Undefined silicon revision. Please define either ABAB or ACAB."
+#endif
+}
+
+static lt_ret_t lt_fleet_write(const lt_fleet_t *fleet, lt_fleet_chip_t *chip, const lt_fleet_image_t *image,
+                               const lt_bank_id_t bank_id)
+{
+    lt_fw_update_stream_t stream = image->stream;
+    stream.progress = NULL;
+
+    memset(&chip->progress, 0, sizeof(chip->progress));
+
+    lt_ret_t ret;
+    uint8_t attempt = 0;
+    do {
+        // Resumes after the last acknowledged chunk on retries
+        ret = lt_do_mutable_fw_update_stream(chip->h, &stream, bank_id, &chip->progress);
+    } while ((ret != LT_OK) && (attempt++ < fleet->retries));
+
+    if (ret == LT_OK) {
+        chip->written_cnt++;
+    }
+
+    return ret;
+}
+
+static lt_ret_t lt_fleet_check_running_version(lt_handle_t *h, const lt_fleet_image_t *image, const bool cpu)
+{
+    uint8_t ver[TR01_L2_GET_INFO_RISCV_FW_SIZE];
+
+    if (image->version == 0) {
+        return LT_OK;
+    }
+
+    lt_ret_t ret = cpu ? lt_get_info_riscv_fw_ver(h, ver) : lt_get_info_spect_fw_ver(h, ver);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    uint32_t version
+        = (uint32_t)ver[0] | ((uint32_t)ver[1] << 8) | ((uint32_t)ver[2] << 16) | ((uint32_t)ver[3] << 24);
+    if (version != image->version) {
+        return LT_FAIL;
+    }
+
+    return LT_OK;
+}
+
+lt_ret_t lt_fleet_update_chip(const lt_fleet_t *fleet, lt_fleet_chip_t *chip)
+{
+    if (!fleet || !chip || !chip->h) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_handle_t *h = chip->h;
+    uint8_t cpu_stale, spect_stale;
+    lt_ret_t ret;
+
+    chip->ret = LT_OK;
+    chip->written_cnt = 0;
+    memset(&chip->progress, 0, sizeof(chip->progress));
+
+    lt_fleet_set_stage(fleet, chip, LT_FLEET_MAINTENANCE_REBOOT);
+    ret = lt_fleet_reboot(h, TR01_MAINTENANCE_REBOOT);
+    if (ret != LT_OK) {
+        return lt_fleet_fail(fleet, chip, ret);
+    }
+
+    lt_fleet_set_stage(fleet, chip, LT_FLEET_VERSION_CHECK);
+    ret = lt_fleet_stale_banks(h, &fleet->cpu, lt_fleet_cpu_banks, &cpu_stale);
+    if (ret != LT_OK) {
+        return lt_fleet_fail(fleet, chip, ret);
+    }
+    ret = lt_fleet_stale_banks(h, &fleet->spect, lt_fleet_spect_banks, &spect_stale);
+    if (ret != LT_OK) {
+        return lt_fleet_fail(fleet, chip, ret);
+    }
+
+    if (!cpu_stale && !spect_stale) {
+        ret = lt_fleet_reboot(h, TR01_REBOOT);
+        if (ret != LT_OK) {
+            return lt_fleet_fail(fleet, chip, ret);
+        }
+        lt_fleet_set_stage(fleet, chip, LT_FLEET_UP_TO_DATE);
+        return LT_OK;
+    }
+
+    // Each bank of a firmware is written in its own Maintenance mode session
+    bool in_session = true;
+    for (uint8_t round = 0; round < LT_FLEET_BANK_CNT; round++) {
+        bool write_cpu = lt_fleet_write_in_round(cpu_stale, round);
+        bool write_spect = lt_fleet_write_in_round(spect_stale, round);
+        if (!write_cpu && !write_spect) {
+            continue;
+        }
+
+        if (!in_session) {
+            lt_fleet_set_stage(fleet, chip, LT_FLEET_MAINTENANCE_REBOOT);
+            ret = lt_fleet_reboot(h, TR01_MAINTENANCE_REBOOT);
+            if (ret != LT_OK) {
+                return lt_fleet_fail(fleet, chip, ret);
+            }
+        }
+        in_session = false;
+
+        if (write_cpu) {
+            lt_fleet_set_stage(fleet, chip, LT_FLEET_UPDATE_CPU);
+            ret = lt_fleet_write(fleet, chip, &fleet->cpu, lt_fleet_cpu_banks[round]);
+            if (ret != LT_OK) {
+                return lt_fleet_fail(fleet, chip, ret);
+            }
+        }
+        if (write_spect) {
+            lt_fleet_set_stage(fleet, chip, LT_FLEET_UPDATE_SPECT);
+            ret = lt_fleet_write(fleet, chip, &fleet->spect, lt_fleet_spect_banks[round]);
+            if (ret != LT_OK) {
+                return lt_fleet_fail(fleet, chip, ret);
+            }
+        }
+    }
+
+    lt_fleet_set_stage(fleet, chip, LT_FLEET_VERIFY);
+    // Bank headers can be read only in Maintenance mode, the last session is still open
+    ret = lt_fleet_stale_banks(h, &fleet->cpu, lt_fleet_cpu_banks, &cpu_stale);
+    if (ret != LT_OK) {
+        return lt_fleet_fail(fleet, chip, ret);
+    }
+    ret = lt_fleet_stale_banks(h, &fleet->spect, lt_fleet_spect_banks, &spect_stale);
+    if (ret != LT_OK) {
+        return lt_fleet_fail(fleet, chip, ret);
+    }
+    if ((fleet->cpu.version && cpu_stale) || (fleet->spect.version && spect_stale)) {
+        return lt_fleet_fail(fleet, chip, LT_FAIL);
+    }
+
+    ret = lt_fleet_reboot(h, TR01_REBOOT);
+    if (ret != LT_OK) {
+        return lt_fleet_fail(fleet, chip, ret);
+    }
+    ret = lt_fleet_check_running_version(h, &fleet->cpu, true);
+    if (ret != LT_OK) {
+        return lt_fleet_fail(fleet, chip, ret);
+    }
+    ret = lt_fleet_check_running_version(h, &fleet->spect, false);
+    if (ret != LT_OK) {
+        return lt_fleet_fail(fleet, chip, ret);
+    }
+
+    lt_fleet_set_stage(fleet, chip, LT_FLEET_DONE);
+
+    return LT_OK;
+}
+
+#endif  // LT_HELPERS
+
+const char *lt_fleet_stage_str(const lt_fleet_stage_t stage)
+{
+    switch (stage) {
+        case LT_FLEET_PENDING:
+            return "PENDING";
+        case LT_FLEET_MAINTENANCE_REBOOT:
+            return "MAINTENANCE_REBOOT";
+        case LT_FLEET_VERSION_CHECK:
+            return "VERSION_CHECK";
+        case LT_FLEET_UPDATE_CPU:
+            return "UPDATE_CPU";
+        case LT_FLEET_UPDATE_SPECT:
+            return "UPDATE_SPECT";
+        case LT_FLEET_VERIFY:
+            return "VERIFY";
+        case LT_FLEET_DONE:
+            return "DONE";
+        case LT_FLEET_UP_TO_DATE:
+            return "UP_TO_DATE";
+        case LT_FLEET_FAILED:
+            return "FAILED";
+        default:
+            return "UNKNOWN";
+    }
+}
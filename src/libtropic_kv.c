@@ -0,0 +1,676 @@
+/**
+ * @file libtropic_kv.c
+ * @brief Key-value store over R memory
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include "libtropic_kv.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_l3.h"
+#include "libtropic_macros.h"
+#include "lt_crc16.h"
+#include "lt_handle_lock.h"
+#include "lt_l3_api_structs.h"
+#include "lt_l3_pipeline.h"
+
+/*
+ * Layout of one slot (multi-byte fields are little endian):
+ *
+ *   0  crc16 over bytes 2..end
+ *   2  magic
+ *   3  fragment index (0 = head)
+ *   4  fragment count
+ *   5  reserved (0)
+ *   6  sequence number (4 B)
+ *  10  payload
+ *
+ * Payload of the head: key length (1 B), key, value length (2 B), slots of fragments 1..count-1 (2 B each), first part
+ * of the value. Payload of other fragments: next part of the value.
+ */
+#define LT_KV_MAGIC 0x6B
+#define LT_KV_OFFSET_CRC 0
+#define LT_KV_OFFSET_MAGIC 2
+#define LT_KV_OFFSET_FRAG_IDX 3
+#define LT_KV_OFFSET_FRAG_CNT 4
+#define LT_KV_OFFSET_RFU 5
+#define LT_KV_OFFSET_SEQ 6
+#define LT_KV_HDR_LEN 10
+
+/** @brief Payload capacity of a continuation slot. */
+#define LT_KV_CONT_CAP (TR01_R_MEM_DATA_SIZE_MAX - LT_KV_HDR_LEN)
+
+static bool lt_kv_bit_get(const uint32_t *bm, const uint16_t i) { return (bm[i / 32] >> (i % 32)) & 1u; }
+
+static void lt_kv_bit_set(uint32_t *bm, const uint16_t i) { bm[i / 32] |= 1u << (i % 32); }
+
+static void lt_kv_bit_clr(uint32_t *bm, const uint16_t i) { bm[i / 32] &= ~(1u << (i % 32)); }
+
+static void lt_kv_put_u16(uint8_t *p, const uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static uint16_t lt_kv_get_u16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+static void lt_kv_put_u32(uint8_t *p, const uint32_t v)
+{
+    lt_kv_put_u16(p, (uint16_t)v);
+    lt_kv_put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint32_t lt_kv_get_u32(const uint8_t *p)
+{
+    return (uint32_t)lt_kv_get_u16(p) | ((uint32_t)lt_kv_get_u16(p + 2) << 16);
+}
+
+/** @brief Length of head payload preceding the value. */
+static uint16_t lt_kv_head_meta_len(const uint8_t key_len, const uint8_t frag_cnt)
+{
+    return (uint16_t)(1 + key_len + 2 + 2 * (frag_cnt - 1));
+}
+
+/** @brief Number of value bytes stored in the head slot. */
+static uint16_t lt_kv_head_part_len(const uint8_t key_len, const uint8_t frag_cnt, const uint16_t value_len)
+{
+    uint16_t cap = TR01_R_MEM_DATA_SIZE_MAX - LT_KV_HDR_LEN - lt_kv_head_meta_len(key_len, frag_cnt);
+    return (value_len < cap) ? value_len : cap;
+}
+
+/** @brief Returns number of slots needed for a record, 0 if the value does not fit into LT_KV_FRAG_CNT_MAX slots. */
+static uint8_t lt_kv_frag_cnt(const uint8_t key_len, const uint16_t value_len)
+{
+    for (uint8_t n = 1; n <= LT_KV_FRAG_CNT_MAX; n++) {
+        uint32_t cap = (uint32_t)(TR01_R_MEM_DATA_SIZE_MAX - LT_KV_HDR_LEN - lt_kv_head_meta_len(key_len, n))
+                       + (uint32_t)(n - 1) * LT_KV_CONT_CAP;
+        if (value_len <= cap) {
+            return n;
+        }
+    }
+    return 0;
+}
+
+static void lt_kv_hdr_fill(uint8_t *buf, const uint8_t frag_idx, const uint8_t frag_cnt, const uint32_t seq)
+{
+    buf[LT_KV_OFFSET_MAGIC] = LT_KV_MAGIC;
+    buf[LT_KV_OFFSET_FRAG_IDX] = frag_idx;
+    buf[LT_KV_OFFSET_FRAG_CNT] = frag_cnt;
+    buf[LT_KV_OFFSET_RFU] = 0;
+    lt_kv_put_u32(buf + LT_KV_OFFSET_SEQ, seq);
+}
+
+static void lt_kv_seal(uint8_t *buf, const uint16_t len)
+{
+    lt_kv_put_u16(buf + LT_KV_OFFSET_CRC, crc16(buf + LT_KV_OFFSET_MAGIC, (int16_t)(len - LT_KV_OFFSET_MAGIC)));
+}
+
+/** @brief Checks that slot data is a fragment written by this module. */
+static bool lt_kv_frag_valid(const uint8_t *buf, const uint16_t len)
+{
+    if (len < LT_KV_HDR_LEN || buf[LT_KV_OFFSET_MAGIC] != LT_KV_MAGIC) {
+        return false;
+    }
+    if (buf[LT_KV_OFFSET_FRAG_CNT] == 0 || buf[LT_KV_OFFSET_FRAG_CNT] > LT_KV_FRAG_CNT_MAX
+        || buf[LT_KV_OFFSET_FRAG_IDX] >= buf[LT_KV_OFFSET_FRAG_CNT]) {
+        return false;
+    }
+    return lt_kv_get_u16(buf + LT_KV_OFFSET_CRC)
+           == crc16(buf + LT_KV_OFFSET_MAGIC, (int16_t)(len - LT_KV_OFFSET_MAGIC));
+}
+
+static lt_kv_entry_t *lt_kv_find(lt_kv_t *kv, const uint8_t *key, const uint8_t key_len)
+{
+    for (uint16_t i = 0; i < LT_KV_ENTRY_CNT_MAX; i++) {
+        lt_kv_entry_t *e = &kv->entries[i];
+        if (e->key_len == key_len && !memcmp(e->key, key, key_len)) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static lt_kv_entry_t *lt_kv_find_free(lt_kv_t *kv)
+{
+    for (uint16_t i = 0; i < LT_KV_ENTRY_CNT_MAX; i++) {
+        if (kv->entries[i].key_len == 0) {
+            return &kv->entries[i];
+        }
+    }
+    return NULL;
+}
+
+static bool lt_kv_in_range(const lt_kv_t *kv, const uint16_t slot)
+{
+    return (slot >= kv->first_slot) && (slot - kv->first_slot < kv->slot_cnt);
+}
+
+/** @brief Parses a head in slot `idx` into `e`, returns false for a malformed head. */
+static bool lt_kv_head_parse(const lt_kv_t *kv, const uint16_t idx, const uint8_t *buf, const uint16_t len,
+                             lt_kv_entry_t *e)
+{
+    uint8_t frag_cnt = buf[LT_KV_OFFSET_FRAG_CNT];
+    const uint8_t *p = buf + LT_KV_HDR_LEN;
+    uint8_t key_len = p[0];
+
+    if (key_len == 0 || key_len > LT_KV_KEY_SIZE_MAX || len < LT_KV_HDR_LEN + lt_kv_head_meta_len(key_len, frag_cnt)) {
+        return false;
+    }
+    uint16_t value_len = lt_kv_get_u16(p + 1 + key_len);
+    const uint8_t *slots = p + 1 + key_len + 2;
+    if (lt_kv_frag_cnt(key_len, value_len) != frag_cnt
+        || len - LT_KV_HDR_LEN - lt_kv_head_meta_len(key_len, frag_cnt)
+               != lt_kv_head_part_len(key_len, frag_cnt, value_len)) {
+        return false;
+    }
+    for (uint8_t j = 1; j < frag_cnt; j++) {
+        if (!lt_kv_in_range(kv, lt_kv_get_u16(slots + 2 * (j - 1)))) {
+            return false;
+        }
+    }
+
+    memcpy(e->key, p + 1, key_len);
+    e->key_len = key_len;
+    e->frag_cnt = frag_cnt;
+    e->value_len = value_len;
+    e->seq = lt_kv_get_u32(buf + LT_KV_OFFSET_SEQ);
+    e->slots[0] = kv->first_slot + idx;
+    for (uint8_t j = 1; j < frag_cnt; j++) {
+        e->slots[j] = lt_kv_get_u16(slots + 2 * (j - 1));
+    }
+
+    return true;
+}
+
+/**
+ * @brief Adds a head found by lt_kv_open() into the index, if it is newer than the indexed record of its key.
+ * @details Malformed heads are ignored and their slot stays stale.
+ */
+static lt_ret_t lt_kv_index_head(lt_kv_t *kv, const uint16_t idx, const uint8_t *buf, const uint16_t len)
+{
+    lt_kv_entry_t head;
+
+    if (!lt_kv_head_parse(kv, idx, buf, len, &head)) {
+        return LT_OK;
+    }
+
+    lt_kv_bit_set(kv->head, idx);
+
+    lt_kv_entry_t *e = lt_kv_find(kv, head.key, head.key_len);
+    if (e && e->seq > head.seq) {
+        return LT_OK;
+    }
+    if (!e) {
+        e = lt_kv_find_free(kv);
+        if (!e) {
+            return LT_KV_FULL;
+        }
+    }
+    *e = head;
+
+    return LT_OK;
+}
+
+/**
+ * @brief Checks that the continuation slots of a record still hold its fragments.
+ * @details Slots of an older record may have been compacted and reused, so they are read again.
+ */
+static lt_ret_t lt_kv_frags_intact(lt_kv_t *kv, const lt_kv_entry_t *e, uint8_t *buf, bool *intact)
+{
+    uint16_t len;
+
+    *intact = false;
+    for (uint8_t j = 1; j < e->frag_cnt; j++) {
+        lt_ret_t ret = lt_r_mem_data_read(kv->h, e->slots[j], buf, TR01_R_MEM_DATA_SIZE_MAX, &len);
+        if (ret == LT_L3_R_MEM_DATA_READ_SLOT_EMPTY) {
+            return LT_OK;
+        }
+        if (ret != LT_OK) {
+            return ret;
+        }
+        if (!lt_kv_frag_valid(buf, len) || buf[LT_KV_OFFSET_FRAG_IDX] != j || buf[LT_KV_OFFSET_FRAG_CNT] != e->frag_cnt
+            || lt_kv_get_u32(buf + LT_KV_OFFSET_SEQ) != e->seq) {
+            return LT_OK;
+        }
+    }
+    *intact = true;
+
+    return LT_OK;
+}
+
+/**
+ * @brief Replaces an indexed record with a missing fragment by the newest older intact record of its key.
+ * @details Only done by lt_kv_open() for a damaged record, so the heads are read again instead of being kept from the
+ * scan. The entry is cleared when no older intact record exists.
+ */
+static lt_ret_t lt_kv_index_older(lt_kv_t *kv, lt_kv_entry_t *e)
+{
+    lt_kv_entry_t best, cand;
+    uint8_t buf[TR01_R_MEM_DATA_SIZE_MAX];
+    uint16_t len;
+    bool intact;
+
+    memset(&best, 0, sizeof(best));
+    for (uint16_t i = 0; i < kv->slot_cnt; i++) {
+        if (!lt_kv_bit_get(kv->head, i)) {
+            continue;
+        }
+        lt_ret_t ret = lt_r_mem_data_read(kv->h, kv->first_slot + i, buf, sizeof(buf), &len);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        if (!lt_kv_frag_valid(buf, len) || (buf[LT_KV_OFFSET_FRAG_IDX] != 0)
+            || !lt_kv_head_parse(kv, i, buf, len, &cand)) {
+            continue;
+        }
+        if (cand.key_len != e->key_len || memcmp(cand.key, e->key, e->key_len) || cand.seq >= e->seq
+            || (best.key_len && cand.seq <= best.seq)) {
+            continue;
+        }
+        ret = lt_kv_frags_intact(kv, &cand, buf, &intact);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        if (intact) {
+            best = cand;
+        }
+    }
+    *e = best;
+
+    return LT_OK;
+}
+
+/** @brief Picks the next free slot after the cursor. */
+static bool lt_kv_alloc(lt_kv_t *kv, uint16_t *idx)
+{
+    for (uint16_t k = 0; k < kv->slot_cnt; k++) {
+        uint16_t i = (uint16_t)((kv->cursor + k) % kv->slot_cnt);
+        if (!lt_kv_bit_get(kv->used, i) && !lt_kv_bit_get(kv->expired, i)) {
+            *idx = i;
+            kv->cursor = (uint16_t)((i + 1) % kv->slot_cnt);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Writes one fragment into a newly allocated slot and marks it live.
+ * @details Expired slots are skipped. When no free slot is left, all stale slots are erased once.
+ */
+static lt_ret_t lt_kv_write_frag(lt_kv_t *kv, const uint8_t *buf, const uint16_t len, uint16_t *slot)
+{
+    bool compacted = false;
+    uint16_t idx;
+    lt_ret_t ret;
+
+    for (;;) {
+        if (!lt_kv_alloc(kv, &idx)) {
+            if (compacted) {
+                return LT_KV_FULL;
+            }
+            ret = lt_kv_compact(kv, kv->slot_cnt, NULL);
+            if (ret != LT_OK) {
+                return ret;
+            }
+            compacted = true;
+            continue;
+        }
+
+        ret = lt_r_mem_data_write(kv->h, kv->first_slot + idx, buf, len);
+        if (ret == LT_L3_R_MEM_DATA_WRITE_SLOT_EXPIRED) {
+            lt_kv_bit_set(kv->expired, idx);
+            continue;
+        }
+        if (ret == LT_L3_R_MEM_DATA_WRITE_WRITE_FAIL) {
+            // Not empty although we did not know about it, leave it to compaction.
+            lt_kv_bit_set(kv->used, idx);
+            continue;
+        }
+        if (ret != LT_OK) {
+            return ret;
+        }
+
+        lt_kv_bit_set(kv->used, idx);
+        lt_kv_bit_set(kv->live, idx);
+        *slot = kv->first_slot + idx;
+        return LT_OK;
+    }
+}
+
+static lt_ret_t lt_kv_erase_slot(lt_kv_t *kv, const uint16_t idx)
+{
+    lt_ret_t ret = lt_r_mem_data_erase(kv->h, kv->first_slot + idx);
+    if (ret != LT_OK) {
+        return ret;
+    }
+    lt_kv_bit_clr(kv->used, idx);
+    lt_kv_bit_clr(kv->live, idx);
+    lt_kv_bit_clr(kv->head, idx);
+    return LT_OK;
+}
+
+/** @brief Context of the scan done by lt_kv_open(). */
+struct lt_kv_scan_ctx_t {
+    lt_kv_t *kv;
+    uint32_t frag[LT_KV_BITMAP_WORDS];       /**< Slot holds a valid continuation fragment */
+    uint16_t newest;                         /**< Slot with the highest sequence number */
+    lt_ret_t first_err;                      /**< No slot is indexed after an error */
+    uint8_t data[TR01_R_MEM_DATA_SIZE_MAX];  /**< Content of the slot being indexed */
+};
+
+static lt_ret_t lt_kv_scan_out(lt_handle_t *h, void *ctx, size_t idx)
+{
+    struct lt_kv_scan_ctx_t *c = ctx;
+    return lt_out__r_mem_data_read(h, (uint16_t)(c->kv->first_slot + idx));
+}
+
+/** @brief Indexes slot `idx` while TROPIC01 already reads the next one. */
+static lt_ret_t lt_kv_scan_in(lt_handle_t *h, void *ctx, size_t idx)
+{
+    struct lt_kv_scan_ctx_t *c = ctx;
+    lt_kv_t *kv = c->kv;
+    uint16_t len;
+
+    lt_ret_t ret = lt_in__r_mem_data_read(h, c->data, sizeof(c->data), &len);
+    if ((ret == LT_L3_R_MEM_DATA_READ_SLOT_EMPTY) || (c->first_err != LT_OK)) {
+        return LT_OK;
+    }
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    lt_kv_bit_set(kv->used, (uint16_t)idx);
+    if (!lt_kv_frag_valid(c->data, len)) {
+        return LT_OK;
+    }
+
+    uint32_t seq = lt_kv_get_u32(c->data + LT_KV_OFFSET_SEQ);
+    if (seq > kv->seq) {
+        kv->seq = seq;
+        c->newest = (uint16_t)idx;
+    }
+
+    if (c->data[LT_KV_OFFSET_FRAG_IDX] != 0) {
+        lt_kv_bit_set(c->frag, (uint16_t)idx);
+        return LT_OK;
+    }
+
+    return lt_kv_index_head(kv, (uint16_t)idx, c->data, len);
+}
+
+static void lt_kv_scan_result(void *ctx, size_t idx, lt_ret_t ret)
+{
+    LT_UNUSED(idx);
+    struct lt_kv_scan_ctx_t *c = ctx;
+    if ((ret != LT_OK) && (c->first_err == LT_OK)) {
+        c->first_err = ret;
+    }
+}
+
+lt_ret_t lt_kv_open(lt_kv_t *kv, lt_handle_t *h, const uint16_t first_slot, const uint16_t slot_cnt)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!kv || !h || (slot_cnt == 0) || (first_slot + slot_cnt - 1 > TR01_R_MEM_DATA_SLOT_MAX)) {
+        return LT_PARAM_ERR;
+    }
+
+    memset(kv, 0, sizeof(*kv));
+    kv->h = h;
+    kv->first_slot = first_slot;
+    kv->slot_cnt = slot_cnt;
+
+    // The whole range is one pipeline run, each slot is indexed as soon as its response is decrypted
+    static const lt_l3_pipeline_ops_t ops = {.out = lt_kv_scan_out, .in = lt_kv_scan_in, .result = lt_kv_scan_result};
+    struct lt_kv_scan_ctx_t ctx;
+    uint8_t stage[sizeof(struct lt_l3_r_mem_data_read_cmd_t)];
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.kv = kv;
+    ctx.newest = slot_cnt - 1;
+    lt_ret_t ret = lt_l3_pipeline_run(h, &ops, &ctx, slot_cnt, stage, sizeof(stage), true);
+    if (ret != LT_OK) {
+        return ret;
+    }
+    if (ctx.first_err != LT_OK) {
+        return ctx.first_err;
+    }
+
+    // A record with a missing fragment cannot be read, the previous value of its key is used instead. Everything else
+    // not referenced is stale.
+    for (uint16_t i = 0; i < LT_KV_ENTRY_CNT_MAX; i++) {
+        lt_kv_entry_t *e = &kv->entries[i];
+        if (e->key_len == 0) {
+            continue;
+        }
+        for (uint8_t j = 1; j < e->frag_cnt; j++) {
+            if (!lt_kv_bit_get(ctx.frag, e->slots[j] - first_slot)) {
+                ret = lt_kv_index_older(kv, e);
+                if (ret != LT_OK) {
+                    return ret;
+                }
+                break;
+            }
+        }
+        for (uint8_t j = 0; j < e->frag_cnt; j++) {
+            lt_kv_bit_set(kv->live, e->slots[j] - first_slot);
+        }
+    }
+
+    kv->cursor = (uint16_t)((ctx.newest + 1) % slot_cnt);
+
+    return LT_OK;
+}
+
+lt_ret_t lt_kv_get(lt_kv_t *kv, const uint8_t *key, const uint8_t key_len, uint8_t *value,
+                   const uint16_t value_max_size, uint16_t *value_len)
+{
+    if (!kv || !key || (key_len == 0) || (key_len > LT_KV_KEY_SIZE_MAX) || !value || !value_len) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_kv_entry_t *e = lt_kv_find(kv, key, key_len);
+    if (!e) {
+        return LT_KV_KEY_NOT_FOUND;
+    }
+    if (value_max_size < e->value_len) {
+        return LT_PARAM_ERR;
+    }
+
+    uint8_t buf[TR01_R_MEM_DATA_SIZE_MAX];
+    uint16_t len, off = 0;
+
+    for (uint8_t j = 0; j < e->frag_cnt; j++) {
+        lt_ret_t ret = lt_r_mem_data_read(kv->h, e->slots[j], buf, sizeof(buf), &len);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        if (!lt_kv_frag_valid(buf, len) || buf[LT_KV_OFFSET_FRAG_IDX] != j || buf[LT_KV_OFFSET_FRAG_CNT] != e->frag_cnt
+            || lt_kv_get_u32(buf + LT_KV_OFFSET_SEQ) != e->seq) {
+            return LT_FAIL;
+        }
+
+        uint16_t hdr_len = LT_KV_HDR_LEN;
+        if (j == 0) {
+            hdr_len += lt_kv_head_meta_len(key_len, e->frag_cnt);
+        }
+        uint16_t part = len - hdr_len;
+        if (part > e->value_len - off) {
+            return LT_FAIL;
+        }
+        memcpy(value + off, buf + hdr_len, part);
+        off += part;
+    }
+
+    if (off != e->value_len) {
+        return LT_FAIL;
+    }
+    *value_len = e->value_len;
+
+    return LT_OK;
+}
+
+lt_ret_t lt_kv_put(lt_kv_t *kv, const uint8_t *key, const uint8_t key_len, const uint8_t *value,
+                   const uint16_t value_len)
+{
+    if (!kv || !key || (key_len == 0) || (key_len > LT_KV_KEY_SIZE_MAX) || (!value && value_len)) {
+        return LT_PARAM_ERR;
+    }
+
+    uint8_t frag_cnt = lt_kv_frag_cnt(key_len, value_len);
+    if (frag_cnt == 0) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_kv_entry_t *e = lt_kv_find(kv, key, key_len);
+    if (!e) {
+        e = lt_kv_find_free(kv);
+        if (!e) {
+            return LT_KV_FULL;
+        }
+    }
+
+    uint8_t buf[TR01_R_MEM_DATA_SIZE_MAX];
+    uint16_t slots[LT_KV_FRAG_CNT_MAX];
+    uint32_t seq = ++kv->seq;
+    uint16_t head_part = lt_kv_head_part_len(key_len, frag_cnt, value_len);
+    uint16_t off = head_part;
+    uint8_t written = 0;
+    lt_ret_t ret;
+
+    // Continuations go first, the record exists only once its head is written.
+    for (uint8_t j = 1; j < frag_cnt; j++) {
+        uint16_t part = value_len - off;
+        if (part > LT_KV_CONT_CAP) {
+            part = LT_KV_CONT_CAP;
+        }
+        lt_kv_hdr_fill(buf, j, frag_cnt, seq);
+        memcpy(buf + LT_KV_HDR_LEN, value + off, part);
+        lt_kv_seal(buf, LT_KV_HDR_LEN + part);
+
+        ret = lt_kv_write_frag(kv, buf, LT_KV_HDR_LEN + part, &slots[j]);
+        if (ret != LT_OK) {
+            goto err;
+        }
+        written++;
+        off += part;
+    }
+
+    uint8_t *p = buf + LT_KV_HDR_LEN;
+    lt_kv_hdr_fill(buf, 0, frag_cnt, seq);
+    *p++ = key_len;
+    memcpy(p, key, key_len);
+    p += key_len;
+    lt_kv_put_u16(p, value_len);
+    p += 2;
+    for (uint8_t j = 1; j < frag_cnt; j++) {
+        lt_kv_put_u16(p, slots[j]);
+        p += 2;
+    }
+    if (head_part) {
+        memcpy(p, value, head_part);
+        p += head_part;
+    }
+    lt_kv_seal(buf, (uint16_t)(p - buf));
+
+    ret = lt_kv_write_frag(kv, buf, (uint16_t)(p - buf), &slots[0]);
+    if (ret != LT_OK) {
+        goto err;
+    }
+    lt_kv_bit_set(kv->head, slots[0] - kv->first_slot);
+
+    // Slots of the previous record become stale.
+    if (e->key_len) {
+        for (uint8_t j = 0; j < e->frag_cnt; j++) {
+            lt_kv_bit_clr(kv->live, e->slots[j] - kv->first_slot);
+        }
+    }
+
+    memcpy(e->key, key, key_len);
+    e->key_len = key_len;
+    e->frag_cnt = frag_cnt;
+    e->value_len = value_len;
+    e->seq = seq;
+    memcpy(e->slots, slots, frag_cnt * sizeof(slots[0]));
+
+    return LT_OK;
+
+err:
+    for (uint8_t j = 1; j <= written; j++) {
+        lt_kv_bit_clr(kv->live, slots[j] - kv->first_slot);
+    }
+    return ret;
+}
+
+lt_ret_t lt_kv_delete(lt_kv_t *kv, const uint8_t *key, const uint8_t key_len)
+{
+    if (!kv || !key || (key_len == 0) || (key_len > LT_KV_KEY_SIZE_MAX)) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_kv_entry_t *e = lt_kv_find(kv, key, key_len);
+    if (!e) {
+        return LT_KV_KEY_NOT_FOUND;
+    }
+
+    lt_ret_t ret;
+    for (uint16_t i = 0; i < kv->slot_cnt; i++) {
+        if (lt_kv_bit_get(kv->head, i) && !lt_kv_bit_get(kv->live, i)) {
+            ret = lt_kv_erase_slot(kv, i);
+            if (ret != LT_OK) {
+                return ret;
+            }
+        }
+    }
+
+    ret = lt_kv_erase_slot(kv, e->slots[0] - kv->first_slot);
+    if (ret != LT_OK) {
+        return ret;
+    }
+    for (uint8_t j = 1; j < e->frag_cnt; j++) {
+        lt_kv_bit_clr(kv->live, e->slots[j] - kv->first_slot);
+    }
+    memset(e, 0, sizeof(*e));
+
+    return LT_OK;
+}
+
+lt_ret_t lt_kv_compact(lt_kv_t *kv, const uint16_t max_erase_cnt, uint16_t *stale_cnt)
+{
+    if (!kv) {
+        return LT_PARAM_ERR;
+    }
+
+    uint16_t erased = 0, stale = 0;
+
+    for (uint16_t i = 0; i < kv->slot_cnt; i++) {
+        if (!lt_kv_bit_get(kv->used, i) || lt_kv_bit_get(kv->live, i)) {
+            continue;
+        }
+        if (erased < max_erase_cnt) {
+            lt_ret_t ret = lt_kv_erase_slot(kv, i);
+            if (ret != LT_OK) {
+                return ret;
+            }
+            erased++;
+        }
+        else {
+            stale++;
+        }
+    }
+
+    if (stale_cnt) {
+        *stale_cnt = stale;
+    }
+
+    return LT_OK;
+}
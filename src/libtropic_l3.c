@@ -340,7 +340,7 @@ lt_ret_t lt_in__pairing_key_invalidate(lt_handle_t *h)
     return LT_OK;
 }
 
-static bool conf_addr_valid(enum lt_config_obj_addr_t addr)
+bool lt_conf_addr_valid(const enum lt_config_obj_addr_t addr)
 {
     bool valid = false;
 
@@ -379,7 +379,7 @@ static bool conf_addr_valid(enum lt_config_obj_addr_t addr)
 
 lt_ret_t lt_out__r_config_write(lt_handle_t *h, const enum lt_config_obj_addr_t addr, const uint32_t obj)
 {
-    if (!h || !conf_addr_valid(addr)) {
+    if (!h || !lt_conf_addr_valid(addr)) {
         return LT_PARAM_ERR;
     }
     if (h->l3.session_status != LT_SECURE_SESSION_ON) {
@@ -425,7 +425,7 @@ lt_ret_t lt_in__r_config_write(lt_handle_t *h)
 
 lt_ret_t lt_out__r_config_read(lt_handle_t *h, const enum lt_config_obj_addr_t addr)
 {
-    if (!h || !conf_addr_valid(addr)) {
+    if (!h || !lt_conf_addr_valid(addr)) {
         return LT_PARAM_ERR;
     }
     if (h->l3.session_status != LT_SECURE_SESSION_ON) {
@@ -516,7 +516,7 @@ lt_ret_t lt_in__r_config_erase(lt_handle_t *h)
 
 lt_ret_t lt_out__i_config_write(lt_handle_t *h, const enum lt_config_obj_addr_t addr, const uint8_t bit_index)
 {
-    if (!h || !conf_addr_valid(addr) || (bit_index > 31)) {
+    if (!h || !lt_conf_addr_valid(addr) || (bit_index > 31)) {
         return LT_PARAM_ERR;
     }
     if (h->l3.session_status != LT_SECURE_SESSION_ON) {
@@ -562,7 +562,7 @@ lt_ret_t lt_in__i_config_write(lt_handle_t *h)
 
 lt_ret_t lt_out__i_config_read(lt_handle_t *h, const enum lt_config_obj_addr_t addr)
 {
-    if (!h || !conf_addr_valid(addr)) {
+    if (!h || !lt_conf_addr_valid(addr)) {
         return LT_PARAM_ERR;
     }
     if (h->l3.session_status != LT_SECURE_SESSION_ON) {
@@ -1039,13 +1039,25 @@ lt_ret_t lt_out__ecc_ecdsa_sign(lt_handle_t *h, const lt_ecc_slot_t slot, const
     }
 
     // Prepare hash of a message
-    uint8_t msg_hash[32] = {0};
+    uint8_t msg_hash[TR01_ECDSA_SIGN_HASH_LEN] = {0};
     struct lt_crypto_sha256_ctx_t hctx = {0};
     lt_sha256_init(&hctx);
     lt_sha256_start(&hctx);
     lt_sha256_update(&hctx, (uint8_t *)msg, msg_len);
     lt_sha256_finish(&hctx, msg_hash);
 
+    return lt_out__ecc_ecdsa_sign_hash(h, slot, msg_hash);
+}
+
+lt_ret_t lt_out__ecc_ecdsa_sign_hash(lt_handle_t *h, const lt_ecc_slot_t slot, const uint8_t *msg_hash)
+{
+    if (!h || (slot > TR01_ECC_SLOT_31) || !msg_hash) {
+        return LT_PARAM_ERR;
+    }
+    if (h->l3.session_status != LT_SECURE_SESSION_ON) {
+        return LT_HOST_NO_SESSION;
+    }
+
     // Pointer to access l3 buffer when it contains command data
     struct lt_l3_ecdsa_sign_cmd_t *p_l3_cmd = (struct lt_l3_ecdsa_sign_cmd_t *)h->l3.buff;
 
@@ -0,0 +1,406 @@
+/**
+ * @file libtropic_macandd.c
+ * @brief MAC-and-Destroy PIN verification
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include "libtropic_macandd.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_l3.h"
+#include "libtropic_macros.h"
+#include "lt_crc16.h"
+#include "lt_handle_lock.h"
+#include "lt_hmac_sha256.h"
+#include "lt_l3_api_structs.h"
+#include "lt_l3_pipeline.h"
+
+#define LT_MACANDD_OFFSET_CRC 0
+#define LT_MACANDD_OFFSET_MAGIC 2
+#define LT_MACANDD_OFFSET_VERSION 3
+#define LT_MACANDD_OFFSET_ROUNDS 4
+#define LT_MACANDD_OFFSET_ATTEMPTS 5
+#define LT_MACANDD_OFFSET_FIRST_SLOT 6
+#define LT_MACANDD_OFFSET_RFU 7
+#define LT_MACANDD_OFFSET_TAG 8
+#define LT_MACANDD_OFFSET_CT LT_MACANDD_RECORD_HDR_LEN
+
+/** @brief KDF labels, compatible with the MAC-and-Destroy example. */
+static const uint8_t lt_macandd_label_tag = 0x00;
+static const uint8_t lt_macandd_label_init = 0x01;
+static const uint8_t lt_macandd_label_key = '2';
+
+/** @brief Context of the pipelined MAC_And_Destroy batches. */
+struct lt_macandd_batch_ctx_t {
+    uint8_t first_slot;
+    /** Slot initialization value u */
+    const uint8_t *u;
+    /** PIN value v, NULL when the batch only initializes slots */
+    const uint8_t *v;
+    const uint8_t *pin;
+    uint8_t pin_size;
+    const uint8_t *add;
+    uint8_t add_size;
+    const uint8_t *master_secret;
+    /** Record receiving the ciphertexts */
+    uint8_t *record;
+    lt_ret_t first_err;
+};
+
+static uint8_t *lt_macandd_ct(uint8_t *record, const uint8_t idx)
+{
+    return record + LT_MACANDD_OFFSET_CT + (size_t)idx * TR01_MAC_AND_DESTROY_DATA_SIZE;
+}
+
+static void lt_macandd_seal(uint8_t *record, const uint16_t len)
+{
+    uint16_t crc = crc16(record + LT_MACANDD_OFFSET_MAGIC, (int16_t)(len - LT_MACANDD_OFFSET_MAGIC));
+    record[LT_MACANDD_OFFSET_CRC] = (uint8_t)crc;
+    record[LT_MACANDD_OFFSET_CRC + 1] = (uint8_t)(crc >> 8);
+}
+
+static bool lt_macandd_record_valid(const uint8_t *record, const uint16_t len)
+{
+    if ((len < LT_MACANDD_RECORD_HDR_LEN) || (record[LT_MACANDD_OFFSET_MAGIC] != LT_MACANDD_RECORD_MAGIC)
+        || (record[LT_MACANDD_OFFSET_VERSION] != LT_MACANDD_RECORD_VERSION)) {
+        return false;
+    }
+    uint8_t rounds = record[LT_MACANDD_OFFSET_ROUNDS];
+    if ((rounds == 0) || (rounds > LT_MACANDD_ROUNDS_MAX) || (len != LT_MACANDD_RECORD_SIZE(rounds))
+        || (record[LT_MACANDD_OFFSET_ATTEMPTS] > rounds)
+        || (record[LT_MACANDD_OFFSET_FIRST_SLOT] + rounds - 1 > TR01_MAC_AND_DESTROY_SLOT_127)) {
+        return false;
+    }
+    uint16_t crc = crc16(record + LT_MACANDD_OFFSET_MAGIC, (int16_t)(len - LT_MACANDD_OFFSET_MAGIC));
+    return (record[LT_MACANDD_OFFSET_CRC] == (uint8_t)crc) && (record[LT_MACANDD_OFFSET_CRC + 1] == (uint8_t)(crc >> 8));
+}
+
+static lt_ret_t lt_macandd_record_read(lt_handle_t *h, const uint16_t r_mem_slot, uint8_t *record, uint16_t *len)
+{
+    lt_ret_t ret = lt_r_mem_data_read(h, r_mem_slot, record, TR01_R_MEM_DATA_SIZE_MAX, len);
+    if (ret == LT_L3_R_MEM_DATA_READ_SLOT_EMPTY) {
+        return LT_MACANDD_RECORD_INVALID;
+    }
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    return lt_macandd_record_valid(record, *len) ? LT_OK : LT_MACANDD_RECORD_INVALID;
+}
+
+static lt_ret_t lt_macandd_record_write(lt_handle_t *h, const uint16_t r_mem_slot, uint8_t *record,
+                                        const uint16_t len)
+{
+    lt_macandd_seal(record, len);
+
+    lt_ret_t ret = lt_r_mem_data_erase(h, r_mem_slot);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    return lt_r_mem_data_write(h, r_mem_slot, record, len);
+}
+
+/** @brief Computes HMAC(key, PIN || A) without concatenating PIN and A into a buffer. */
+static void lt_macandd_kdf_pin(const uint8_t *key, const uint8_t *pin, const uint8_t pin_size, const uint8_t *add,
+                               const uint8_t add_size, uint8_t *output)
+{
+    struct lt_crypto_hmac_sha256_ctx_t hmac_ctx;
+
+    lt_hmac_sha256_init(&hmac_ctx, key, TR01_MAC_AND_DESTROY_DATA_SIZE);
+    lt_hmac_sha256_update(&hmac_ctx, pin, pin_size);
+    if (add_size) {
+        lt_hmac_sha256_update(&hmac_ctx, add, add_size);
+    }
+    lt_hmac_sha256_finish(&hmac_ctx, output);
+}
+
+/** @brief Computes HMAC(s, label) from a context keyed with s, leaving the keyed context untouched. */
+static void lt_macandd_kdf_label(const struct lt_crypto_hmac_sha256_ctx_t *keyed, const uint8_t label,
+                                 uint8_t *output)
+{
+    struct lt_crypto_hmac_sha256_ctx_t hmac_ctx = *keyed;
+
+    lt_hmac_sha256_update(&hmac_ctx, &label, 1);
+    lt_hmac_sha256_finish(&hmac_ctx, output);
+}
+
+static void lt_macandd_xor(const uint8_t *a, const uint8_t *b, uint8_t *out)
+{
+    for (uint8_t i = 0; i < TR01_MAC_AND_DESTROY_DATA_SIZE; i++) {
+        out[i] = a[i] ^ b[i];
+    }
+}
+
+static bool lt_macandd_equal(const uint8_t *a, const uint8_t *b, const size_t len)
+{
+    uint8_t diff = 0;
+    for (size_t i = 0; i < len; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+/*
+ * Setup batch: for every slot x, commands 3x, 3x+1 and 3x+2 send u, v and u. Response to 3x+1 is w_x, which is turned
+ * into the ciphertext c_x while TROPIC01 already processes command 3x+2.
+ * Re-initialization batch (v == NULL): command x sends u to slot first_slot + x.
+ */
+static lt_ret_t lt_macandd_batch_out(lt_handle_t *h, void *ctx, size_t idx)
+{
+    struct lt_macandd_batch_ctx_t *c = ctx;
+
+    if (!c->v) {
+        return lt_out__mac_and_destroy(h, c->first_slot + idx, c->u);
+    }
+
+    return lt_out__mac_and_destroy(h, c->first_slot + idx / 3, (idx % 3 == 1) ? c->v : c->u);
+}
+
+static lt_ret_t lt_macandd_batch_in(lt_handle_t *h, void *ctx, size_t idx)
+{
+    struct lt_macandd_batch_ctx_t *c = ctx;
+    uint8_t w[TR01_MAC_AND_DESTROY_DATA_SIZE];
+    uint8_t k[LT_HMAC_SHA256_HASH_LEN];
+
+    lt_ret_t ret = lt_in__mac_and_destroy(h, w);
+    if ((ret == LT_OK) && c->v && (idx % 3 == 1)) {
+        // c_x = s XOR KDF(w_x, PIN || A)
+        lt_macandd_kdf_pin(w, c->pin, c->pin_size, c->add, c->add_size, k);
+        lt_macandd_xor(c->master_secret, k, lt_macandd_ct(c->record, (uint8_t)(idx / 3)));
+    }
+
+    memset(w, 0, sizeof(w));
+    memset(k, 0, sizeof(k));
+    // Response contains w_x in plaintext
+    memset(h->l3.buff, 0, sizeof(struct lt_l3_mac_and_destroy_res_t));
+
+    return ret;
+}
+
+static void lt_macandd_batch_result(void *ctx, size_t idx, lt_ret_t ret)
+{
+    LT_UNUSED(idx);
+    struct lt_macandd_batch_ctx_t *c = ctx;
+    if ((ret != LT_OK) && (c->first_err == LT_OK)) {
+        c->first_err = ret;
+    }
+}
+
+static lt_ret_t lt_macandd_batch_run(lt_handle_t *h, struct lt_macandd_batch_ctx_t *c, const size_t cnt)
+{
+    static const lt_l3_pipeline_ops_t ops
+        = {.out = lt_macandd_batch_out, .in = lt_macandd_batch_in, .result = lt_macandd_batch_result};
+    uint8_t stage[sizeof(struct lt_l3_mac_and_destroy_cmd_t)];
+
+    c->first_err = LT_OK;
+    lt_ret_t ret = lt_l3_pipeline_run(h, &ops, c, cnt, stage, sizeof(stage), true);
+    memset(stage, 0, sizeof(stage));
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    return c->first_err;
+}
+
+static bool lt_macandd_pin_params_valid(const uint8_t *pin, const uint8_t pin_size, const uint8_t *add,
+                                        const uint8_t add_size)
+{
+    return pin && (pin_size >= LT_MACANDD_PIN_SIZE_MIN) && (pin_size <= LT_MACANDD_PIN_SIZE_MAX)
+           && (add_size <= LT_MACANDD_ADD_SIZE_MAX) && (add || (add_size == 0));
+}
+
+lt_ret_t lt_macandd_setup(lt_handle_t *h, const uint16_t r_mem_slot, const lt_mac_and_destroy_slot_t first_slot,
+                          const uint8_t rounds, const uint8_t *master_secret, const uint8_t *pin,
+                          const uint8_t pin_size, const uint8_t *add, const uint8_t add_size, uint8_t *final_key)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !master_secret || !final_key || !lt_macandd_pin_params_valid(pin, pin_size, add, add_size)
+        || (r_mem_slot > TR01_R_MEM_DATA_SLOT_MAX) || (rounds == 0) || (rounds > LT_MACANDD_ROUNDS_MAX)
+        || ((uint16_t)first_slot + rounds - 1 > TR01_MAC_AND_DESTROY_SLOT_127)) {
+        return LT_PARAM_ERR;
+    }
+    if (h->l3.session_status != LT_SECURE_SESSION_ON) {
+        return LT_HOST_NO_SESSION;
+    }
+
+    memset(final_key, 0, LT_MACANDD_KEY_SIZE);
+
+    uint8_t record[LT_MACANDD_RECORD_SIZE(LT_MACANDD_ROUNDS_MAX)] = {0};
+    uint16_t record_len = LT_MACANDD_RECORD_SIZE(rounds);
+    uint8_t u[LT_HMAC_SHA256_HASH_LEN], v[LT_HMAC_SHA256_HASH_LEN];
+    const uint8_t zeros[TR01_MAC_AND_DESTROY_DATA_SIZE] = {0};
+    struct lt_crypto_hmac_sha256_ctx_t keyed;
+
+    record[LT_MACANDD_OFFSET_MAGIC] = LT_MACANDD_RECORD_MAGIC;
+    record[LT_MACANDD_OFFSET_VERSION] = LT_MACANDD_RECORD_VERSION;
+    record[LT_MACANDD_OFFSET_ROUNDS] = rounds;
+    record[LT_MACANDD_OFFSET_ATTEMPTS] = rounds;
+    record[LT_MACANDD_OFFSET_FIRST_SLOT] = (uint8_t)first_slot;
+
+    // t = KDF(s, 0x00) and u = KDF(s, 0x01) share one keyed context
+    lt_hmac_sha256_init(&keyed, master_secret, LT_MACANDD_SECRET_SIZE);
+    lt_macandd_kdf_label(&keyed, lt_macandd_label_tag, record + LT_MACANDD_OFFSET_TAG);
+    lt_macandd_kdf_label(&keyed, lt_macandd_label_init, u);
+    // v = KDF(0, PIN || A)
+    lt_macandd_kdf_pin(zeros, pin, pin_size, add, add_size, v);
+
+    // Old record is invalid from now on, its slots are going to be overwritten
+    lt_ret_t ret = lt_r_mem_data_erase(h, r_mem_slot);
+    if (ret != LT_OK) {
+        goto exit;
+    }
+
+    struct lt_macandd_batch_ctx_t ctx = {.first_slot = (uint8_t)first_slot,
+                                         .u = u,
+                                         .v = v,
+                                         .pin = pin,
+                                         .pin_size = pin_size,
+                                         .add = add,
+                                         .add_size = add_size,
+                                         .master_secret = master_secret,
+                                         .record = record};
+    ret = lt_macandd_batch_run(h, &ctx, (size_t)rounds * 3);
+    if (ret != LT_OK) {
+        goto exit;
+    }
+
+    lt_macandd_seal(record, record_len);
+    ret = lt_r_mem_data_write(h, r_mem_slot, record, record_len);
+    if (ret != LT_OK) {
+        goto exit;
+    }
+
+    lt_macandd_kdf_label(&keyed, lt_macandd_label_key, final_key);
+
+exit:
+    memset(&keyed, 0, sizeof(keyed));
+    memset(u, 0, sizeof(u));
+    memset(v, 0, sizeof(v));
+
+    return ret;
+}
+
+lt_ret_t lt_macandd_check(lt_handle_t *h, const uint16_t r_mem_slot, const uint8_t *pin, const uint8_t pin_size,
+                          const uint8_t *add, const uint8_t add_size, uint8_t *final_key)
+{
+    // Held across consuming the attempt, the batch and restoring the record, so no other caller gets in between
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !final_key || !lt_macandd_pin_params_valid(pin, pin_size, add, add_size)
+        || (r_mem_slot > TR01_R_MEM_DATA_SLOT_MAX)) {
+        return LT_PARAM_ERR;
+    }
+    if (h->l3.session_status != LT_SECURE_SESSION_ON) {
+        return LT_HOST_NO_SESSION;
+    }
+
+    memset(final_key, 0, LT_MACANDD_KEY_SIZE);
+
+    uint8_t record[TR01_R_MEM_DATA_SIZE_MAX];
+    uint16_t record_len;
+    uint8_t v[LT_HMAC_SHA256_HASH_LEN], w[TR01_MAC_AND_DESTROY_DATA_SIZE], k[LT_HMAC_SHA256_HASH_LEN];
+    uint8_t s[TR01_MAC_AND_DESTROY_DATA_SIZE], t[LT_HMAC_SHA256_HASH_LEN], u[LT_HMAC_SHA256_HASH_LEN];
+    const uint8_t zeros[TR01_MAC_AND_DESTROY_DATA_SIZE] = {0};
+    struct lt_crypto_hmac_sha256_ctx_t keyed;
+
+    lt_ret_t ret = lt_macandd_record_read(h, r_mem_slot, record, &record_len);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    uint8_t rounds = record[LT_MACANDD_OFFSET_ROUNDS];
+    uint8_t first_slot = record[LT_MACANDD_OFFSET_FIRST_SLOT];
+    uint8_t i = record[LT_MACANDD_OFFSET_ATTEMPTS];
+    if (i == 0) {
+        return LT_MACANDD_NO_ATTEMPTS;
+    }
+
+    // The attempt is consumed before slot i - 1 is touched
+    i--;
+    record[LT_MACANDD_OFFSET_ATTEMPTS] = i;
+    ret = lt_macandd_record_write(h, r_mem_slot, record, record_len);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    // v' = KDF(0, PIN' || A), w' = MACANDD(i, v'), k' = KDF(w', PIN' || A), s' = c_i XOR k'
+    lt_macandd_kdf_pin(zeros, pin, pin_size, add, add_size, v);
+    ret = lt_mac_and_destroy(h, first_slot + i, v, w);
+    memset(h->l3.buff, 0, sizeof(struct lt_l3_mac_and_destroy_res_t));
+    if (ret != LT_OK) {
+        goto exit;
+    }
+    lt_macandd_kdf_pin(w, pin, pin_size, add, add_size, k);
+    lt_macandd_xor(lt_macandd_ct(record, i), k, s);
+
+    // t' = KDF(s', 0x00) must match t
+    lt_hmac_sha256_init(&keyed, s, sizeof(s));
+    lt_macandd_kdf_label(&keyed, lt_macandd_label_tag, t);
+    if (!lt_macandd_equal(t, record + LT_MACANDD_OFFSET_TAG, sizeof(t))) {
+        ret = LT_MACANDD_WRONG_PIN;
+        goto exit;
+    }
+
+    // Initialize slots consumed since the last successful check (i..rounds - 1) with u = KDF(s', 0x01)
+    lt_macandd_kdf_label(&keyed, lt_macandd_label_init, u);
+    struct lt_macandd_batch_ctx_t ctx = {.first_slot = (uint8_t)(first_slot + i), .u = u};
+    ret = lt_macandd_batch_run(h, &ctx, (size_t)(rounds - i));
+    if (ret != LT_OK) {
+        goto exit;
+    }
+
+    record[LT_MACANDD_OFFSET_ATTEMPTS] = rounds;
+    ret = lt_macandd_record_write(h, r_mem_slot, record, record_len);
+    if (ret != LT_OK) {
+        goto exit;
+    }
+
+    lt_macandd_kdf_label(&keyed, lt_macandd_label_key, final_key);
+
+exit:
+    memset(&keyed, 0, sizeof(keyed));
+    memset(v, 0, sizeof(v));
+    memset(w, 0, sizeof(w));
+    memset(k, 0, sizeof(k));
+    memset(s, 0, sizeof(s));
+    memset(u, 0, sizeof(u));
+
+    return ret;
+}
+
+lt_ret_t lt_macandd_attempts_get(lt_handle_t *h, const uint16_t r_mem_slot, uint8_t *attempts, uint8_t *rounds)
+{
+    LT_HANDLE_LOCK(h);
+
+    if (!h || !attempts || (r_mem_slot > TR01_R_MEM_DATA_SLOT_MAX)) {
+        return LT_PARAM_ERR;
+    }
+    if (h->l3.session_status != LT_SECURE_SESSION_ON) {
+        return LT_HOST_NO_SESSION;
+    }
+
+    uint8_t record[TR01_R_MEM_DATA_SIZE_MAX];
+    uint16_t record_len;
+
+    lt_ret_t ret = lt_macandd_record_read(h, r_mem_slot, record, &record_len);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    *attempts = record[LT_MACANDD_OFFSET_ATTEMPTS];
+    if (rounds) {
+        *rounds = record[LT_MACANDD_OFFSET_ROUNDS];
+    }
+
+    return LT_OK;
+}
@@ -0,0 +1,281 @@
+/**
+ * @file libtropic_r_mem_cache.c
+ * @brief R memory write-back cache
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include "libtropic_r_mem_cache.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+
+static void lt_r_mem_cache_mark_dirty(lt_r_mem_cache_t *cache, lt_r_mem_cache_line_t *line)
+{
+    if (!line->dirty) {
+        line->dirty = true;
+        line->dirty_since_ms = cache->now_ms;
+        cache->dirty_cnt++;
+    }
+}
+
+static lt_ret_t lt_r_mem_cache_flush_line(lt_r_mem_cache_t *cache, lt_r_mem_cache_line_t *line)
+{
+    lt_ret_t ret;
+
+    if (!line->dirty) {
+        return LT_OK;
+    }
+
+    if (!line->chip_empty) {
+        ret = lt_r_mem_data_erase(cache->h, line->slot);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        cache->stats.nvm_erases++;
+        line->chip_empty = true;
+    }
+
+    if (line->len) {
+        ret = lt_r_mem_data_write(cache->h, line->slot, line->data, line->len);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        cache->stats.nvm_writes++;
+        line->chip_empty = false;
+    }
+
+    line->dirty = false;
+    cache->dirty_cnt--;
+
+    return LT_OK;
+}
+
+/**
+ * @brief Returns line holding `slot`, evicting the least recently used line when the slot is not cached.
+ *
+ * @param cache  Cache
+ * @param slot   Slot
+ * @param load   Load content of the slot from R memory on a miss
+ * @param line   Line holding the slot
+ * @param hit    True when the slot was already cached
+ */
+static lt_ret_t lt_r_mem_cache_get_line(lt_r_mem_cache_t *cache, const uint16_t slot, const bool load,
+                                        lt_r_mem_cache_line_t **line, bool *hit)
+{
+    lt_r_mem_cache_line_t *victim = NULL;
+    lt_ret_t ret;
+
+    for (uint16_t i = 0; i < cache->line_cnt; i++) {
+        lt_r_mem_cache_line_t *l = &cache->lines[i];
+        if (l->valid && l->slot == slot) {
+            l->last_use = ++cache->use_cnt;
+            *line = l;
+            *hit = true;
+            return LT_OK;
+        }
+        // Prefer unused lines, then clean lines, then the least recently used one
+        if (!victim || (victim->valid
+                        && (!l->valid || (victim->dirty && !l->dirty)
+                            || (victim->dirty == l->dirty && l->last_use < victim->last_use)))) {
+            victim = l;
+        }
+    }
+
+    if (victim->valid) {
+        ret = lt_r_mem_cache_flush_line(cache, victim);
+        if (ret != LT_OK) {
+            return ret;
+        }
+    }
+
+    memset(victim, 0, sizeof(*victim));
+    victim->slot = slot;
+
+    if (load) {
+        ret = lt_r_mem_data_read(cache->h, slot, victim->data, sizeof(victim->data), &victim->len);
+        if (ret == LT_L3_R_MEM_DATA_READ_SLOT_EMPTY) {
+            victim->len = 0;
+            victim->chip_empty = true;
+        }
+        else if (ret != LT_OK) {
+            return ret;
+        }
+    }
+
+    victim->valid = true;
+    victim->last_use = ++cache->use_cnt;
+    *line = victim;
+    *hit = false;
+
+    return LT_OK;
+}
+
+static lt_ret_t lt_r_mem_cache_check_threshold(lt_r_mem_cache_t *cache)
+{
+    if (cache->dirty_threshold && (cache->dirty_cnt >= cache->dirty_threshold)) {
+        return lt_r_mem_cache_sync(cache);
+    }
+    return LT_OK;
+}
+
+lt_ret_t lt_r_mem_cache_init(lt_r_mem_cache_t *cache, lt_handle_t *h, lt_r_mem_cache_line_t *lines,
+                             const uint16_t line_cnt, const uint16_t dirty_threshold,
+                             const uint32_t flush_interval_ms)
+{
+    if (!cache || !h || !lines || (line_cnt == 0)) {
+        return LT_PARAM_ERR;
+    }
+
+    memset(cache, 0, sizeof(*cache));
+    memset(lines, 0, line_cnt * sizeof(*lines));
+    cache->h = h;
+    cache->lines = lines;
+    cache->line_cnt = line_cnt;
+    cache->dirty_threshold = dirty_threshold;
+    cache->flush_interval_ms = flush_interval_ms;
+
+    return LT_OK;
+}
+
+lt_ret_t lt_r_mem_cache_read(lt_r_mem_cache_t *cache, const uint16_t udata_slot, uint8_t *data,
+                             const uint16_t data_max_size, uint16_t *data_read_size)
+{
+    if (!cache || !data || !data_read_size || (udata_slot > TR01_R_MEM_DATA_SLOT_MAX)) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_r_mem_cache_line_t *line;
+    bool hit;
+    lt_ret_t ret = lt_r_mem_cache_get_line(cache, udata_slot, true, &line, &hit);
+    if (ret != LT_OK) {
+        return ret;
+    }
+    if (hit) {
+        cache->stats.read_hits++;
+    }
+    else {
+        cache->stats.read_misses++;
+    }
+
+    *data_read_size = line->len;
+    if (line->len == 0) {
+        return LT_L3_R_MEM_DATA_READ_SLOT_EMPTY;
+    }
+    if (data_max_size < line->len) {
+        return LT_PARAM_ERR;
+    }
+    memcpy(data, line->data, line->len);
+
+    return LT_OK;
+}
+
+lt_ret_t lt_r_mem_cache_write(lt_r_mem_cache_t *cache, const uint16_t udata_slot, const uint8_t *data,
+                              const uint16_t data_size)
+{
+    if (!cache || !data || (data_size < TR01_R_MEM_DATA_SIZE_MIN) || (data_size > TR01_R_MEM_DATA_SIZE_MAX)
+        || (udata_slot > TR01_R_MEM_DATA_SLOT_MAX)) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_r_mem_cache_line_t *line;
+    bool hit;
+    lt_ret_t ret = lt_r_mem_cache_get_line(cache, udata_slot, false, &line, &hit);
+    if (ret != LT_OK) {
+        return ret;
+    }
+    cache->stats.writes++;
+
+    // Content of a slot which was not cached is unknown, it has to be written.
+    if (hit && (line->len == data_size) && !memcmp(line->data, data, data_size)) {
+        return LT_OK;
+    }
+
+    memcpy(line->data, data, data_size);
+    line->len = data_size;
+    lt_r_mem_cache_mark_dirty(cache, line);
+
+    return lt_r_mem_cache_check_threshold(cache);
+}
+
+lt_ret_t lt_r_mem_cache_erase(lt_r_mem_cache_t *cache, const uint16_t udata_slot)
+{
+    if (!cache || (udata_slot > TR01_R_MEM_DATA_SLOT_MAX)) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_r_mem_cache_line_t *line;
+    bool hit;
+    lt_ret_t ret = lt_r_mem_cache_get_line(cache, udata_slot, false, &line, &hit);
+    if (ret != LT_OK) {
+        return ret;
+    }
+    cache->stats.writes++;
+
+    if (hit && (line->len == 0)) {
+        return LT_OK;
+    }
+
+    line->len = 0;
+    lt_r_mem_cache_mark_dirty(cache, line);
+
+    return lt_r_mem_cache_check_threshold(cache);
+}
+
+lt_ret_t lt_r_mem_cache_sync(lt_r_mem_cache_t *cache)
+{
+    if (!cache) {
+        return LT_PARAM_ERR;
+    }
+
+    for (uint16_t i = 0; i < cache->line_cnt; i++) {
+        lt_ret_t ret = lt_r_mem_cache_flush_line(cache, &cache->lines[i]);
+        if (ret != LT_OK) {
+            return ret;
+        }
+    }
+
+    return LT_OK;
+}
+
+lt_ret_t lt_r_mem_cache_tick(lt_r_mem_cache_t *cache, const uint32_t now_ms)
+{
+    if (!cache) {
+        return LT_PARAM_ERR;
+    }
+
+    cache->now_ms = now_ms;
+    if (cache->flush_interval_ms == 0) {
+        return LT_OK;
+    }
+
+    for (uint16_t i = 0; i < cache->line_cnt; i++) {
+        lt_r_mem_cache_line_t *line = &cache->lines[i];
+        if (line->dirty && (uint32_t)(now_ms - line->dirty_since_ms) >= cache->flush_interval_ms) {
+            lt_ret_t ret = lt_r_mem_cache_flush_line(cache, line);
+            if (ret != LT_OK) {
+                return ret;
+            }
+        }
+    }
+
+    return LT_OK;
+}
+
+lt_ret_t lt_r_mem_cache_invalidate(lt_r_mem_cache_t *cache)
+{
+    if (!cache) {
+        return LT_PARAM_ERR;
+    }
+
+    memset(cache->lines, 0, cache->line_cnt * sizeof(*cache->lines));
+    cache->dirty_cnt = 0;
+
+    return LT_OK;
+}
@@ -1,7 +1,7 @@
 /**
  * @file asn1_der.c
  * @brief ASN1 DER parser
- * @note Implements subset of ASN1 DER parsing needed to extract STPub from
+ * @note Implements subset of ASN1 DER parsing needed to extract fields of X509 certificates in the Certificate Store
  * @author Tropic Square s.r.o.
  *
  * @license For the license see file LICENSE.txt file in the root directory of this source tree.
@@ -11,278 +11,244 @@
 #include <lt_asn1_der.h>
 #include <stdbool.h>
 #include <stdint.h>
-#include <stdio.h>
 #include <string.h>
 
 #include "libtropic_logging.h"
 
-/**
- * @brief ASN1 DER parsing context
- *
- * @details Holds state of the parser and parsing results
- */
-struct parse_ctx_t {
-    uint8_t *head;                         /** Next byte to be parse */
-    uint16_t len;                          /** Length of the byte stream */
-    uint16_t past;                         /** Index of last processed byte */
-    uint32_t obj_id;                       /** Target OBJECT_IDENTIFIER (3-byte) to be searched */
-    uint8_t *sbuf;                         /** Buffer (and its length) where to copy data after
-                                               OBJECT_IDENTIFIER match */
-    int sbuf_len;                          /** Length of Buffer pointed to by sbuf. */
-    enum lt_asn1der_crop_kind_t crop_kind; /** How to treat objects larger than provided buffer */
-    bool sample_next;                      /** Internal context ->
-                                               Next ASN1 object is the one to be sampled */
-    bool found;                            /** Searched OBJECT_IDENTIFIER was found */
-    bool cropped;                          /** Searched object was cropped */
-};
-
-#define LT_ASN1_DER_PARSE_ERR(ctx, msg, ...)                           \
-    do {                                                               \
-        LT_LOG_ERROR("ASN1 DER Parsing error:");                       \
-        LT_LOG_ERROR("    Byte position:    %" PRIu16, ctx->past);     \
-        LT_LOG_ERROR("    Byte value:       0x%" PRIx8, *(ctx->head)); \
-        LT_LOG_ERROR("    Error:            " msg, ##__VA_ARGS__);     \
-    } while (0);
+/** @brief Maximal number of bytes of a long form length. */
+#define LT_ASN1DER_LEN_BYTES_MAX 4
 
-/**
- * @brief Process bytes from byte stream being parsed
- *
- * @param ctx       Parsing context
- * @param buf       Result buffer
- * @param n         Number of bytes to copy
- * @param copy      If true, copy the consumed bytes to "buf"
- *
- * @returns LT_OK if sucessfully, error code otherwise
- */
-static lt_ret_t consume_bytes(struct parse_ctx_t *ctx, uint8_t *buf, uint16_t n, bool copy)
+#define LT_ASN1_DER_PARSE_ERR(cur, msg, ...)                                                    \
+    do {                                                                                        \
+        LT_LOG_ERROR("ASN1 DER Parsing error:");                                                \
+        LT_LOG_ERROR("    Byte position:    %" PRIu32, (uint32_t)((cur)->pos - (cur)->stream)); \
+        LT_LOG_ERROR("    Error:            " msg, ##__VA_ARGS__);                              \
+    } while (0)
+
+#define LT_ASN1_DER_CHECK(expr)         \
+    do {                                \
+        lt_ret_t _rv_ = (expr);         \
+        if (_rv_ != LT_OK) return _rv_; \
+    } while (0)
+
+void lt_asn1der_cursor_init(lt_asn1der_cursor_t *cur, const uint8_t *stream, const uint32_t len)
+{
+    cur->stream = stream;
+    cur->pos = stream;
+    cur->end = stream + len;
+}
+
+lt_ret_t lt_asn1der_next(lt_asn1der_cursor_t *cur, lt_asn1der_tlv_t *tlv)
 {
-    if (ctx->past + n > ctx->len) {
-        LT_ASN1_DER_PARSE_ERR(ctx, "Incomplete byte stream. Past: %" PRIu16 ", n: %" PRIu16 ", len: %" PRIu16,
-                              ctx->past, n, ctx->len);
+    const uint8_t *p = cur->pos;
+
+    if (p >= cur->end) {
+        return LT_CERT_ITEM_NOT_FOUND;
+    }
+    if (cur->end - p < 2) {
+        LT_ASN1_DER_PARSE_ERR(cur, "Incomplete element header");
         return LT_CERT_STORE_INVALID;
     }
 
-    if (copy) {
-        if (n == 1) {
-            *buf = *(ctx->head);
+    const uint8_t tag = *p++;
+    if ((tag & 0x1f) == 0x1f) {
+        LT_ASN1_DER_PARSE_ERR(cur, "Unsupported tag: Multi-byte tag 0x%" PRIx8, tag);
+        return LT_CERT_UNSUPPORTED;
+    }
+
+    uint32_t len = *p++;
+    if (len & 0x80) {
+        const uint8_t n_bytes = (uint8_t)(len & 0x7f);
+        if (n_bytes == 0) {
+            LT_ASN1_DER_PARSE_ERR(cur, "Indefinite length is not allowed in DER");
+            return LT_CERT_STORE_INVALID;
         }
-        else {
-            memcpy(buf, ctx->head, n);
+        if (n_bytes > LT_ASN1DER_LEN_BYTES_MAX) {
+            LT_ASN1_DER_PARSE_ERR(cur, "Unsupported length: More than %d bytes", LT_ASN1DER_LEN_BYTES_MAX);
+            return LT_CERT_UNSUPPORTED;
+        }
+        if (cur->end - p < n_bytes) {
+            LT_ASN1_DER_PARSE_ERR(cur, "Incomplete length");
+            return LT_CERT_STORE_INVALID;
+        }
+        if (*p == 0) {
+            LT_ASN1_DER_PARSE_ERR(cur, "Non-minimal length: Leading zero byte");
+            return LT_CERT_STORE_INVALID;
+        }
+        len = 0;
+        for (uint8_t i = 0; i < n_bytes; i++) {
+            len = (len << 8) | *p++;
         }
+        if (len < 0x80) {
+            LT_ASN1_DER_PARSE_ERR(cur, "Non-minimal length: Long form of length %" PRIu32, len);
+            return LT_CERT_STORE_INVALID;
+        }
+    }
+
+    if ((uint32_t)(cur->end - p) < len) {
+        LT_ASN1_DER_PARSE_ERR(cur, "Element of length %" PRIu32 " exceeds its parent by %" PRIu32 " bytes", len,
+                              len - (uint32_t)(cur->end - p));
+        return LT_CERT_STORE_INVALID;
     }
 
-    ctx->head += n;
-    ctx->past += n;
+    tlv->tag = tag;
+    tlv->value.ptr = p;
+    tlv->value.len = len;
+    tlv->raw.ptr = cur->pos;
+    tlv->raw.len = (uint32_t)(p + len - cur->pos);
+    cur->pos = p + len;
 
     return LT_OK;
 }
 
-#define LT_ASN1_DER_GET_BYTES(ctx, buf, n)                \
-    do {                                                  \
-        lt_ret_t _rv_ = consume_bytes(ctx, buf, n, true); \
-        if (_rv_ != LT_OK) return _rv_;                   \
-    } while (0);
+lt_ret_t lt_asn1der_expect(lt_asn1der_cursor_t *cur, const uint8_t tag, lt_asn1der_tlv_t *tlv)
+{
+    const lt_asn1der_cursor_t start = *cur;
+    lt_ret_t ret = lt_asn1der_next(cur, tlv);
+
+    if (ret == LT_CERT_ITEM_NOT_FOUND) {
+        LT_ASN1_DER_PARSE_ERR(cur, "Expected element 0x%" PRIx8 " is missing", tag);
+        return LT_CERT_STORE_INVALID;
+    }
+    if ((ret == LT_OK) && (tlv->tag != tag)) {
+        LT_ASN1_DER_PARSE_ERR(&start, "Expected element 0x%" PRIx8 ", found 0x%" PRIx8, tag, tlv->tag);
+        return LT_CERT_STORE_INVALID;
+    }
+
+    return ret;
+}
 
-#define LT_ASN1_DER_GET_NEXT_BYTE(ctx, buf) LT_ASN1_DER_GET_BYTES(ctx, buf, 1)
+void lt_asn1der_enter(const lt_asn1der_cursor_t *parent, const lt_asn1der_tlv_t *tlv, lt_asn1der_cursor_t *inner)
+{
+    inner->stream = parent->stream;
+    inner->pos = tlv->value.ptr;
+    inner->end = tlv->value.ptr + tlv->value.len;
+}
 
-#define LT_ASN1_DER_DROP_BYTES(ctx, n)                      \
-    do {                                                    \
-        lt_ret_t _rv_ = consume_bytes(ctx, NULL, n, false); \
-        if (_rv_ != LT_OK) return _rv_;                     \
-    } while (0);
+bool lt_asn1der_span_eq(const lt_asn1der_span_t *span, const uint8_t *bytes, const uint32_t len)
+{
+    return (span->len == len) && !memcmp(span->ptr, bytes, len);
+}
 
 /**
- * @brief Parse ASN1 DER length encoding
+ * @brief Reads an AlgorithmIdentifier: SEQUENCE { algorithm OBJECT IDENTIFIER, parameters ANY OPTIONAL }.
  *
- * @param ctx       Parsing context
- * @param len       Pointer to integer where length is returned
- *
- * @returns LT_OK if sucessfully, error code otherwise
+ * @param cur     Cursor at the AlgorithmIdentifier
+ * @param whole   Whole AlgorithmIdentifier
+ * @param alg     Contents of the algorithm OBJECT IDENTIFIER
+ * @param params  Contents of the parameters if they are an OBJECT IDENTIFIER, empty otherwise
+ * @return        LT_OK if successful, error code otherwise
  */
-static lt_ret_t parse_length(struct parse_ctx_t *ctx, uint16_t *len)
+static lt_ret_t lt_asn1der_alg_id(lt_asn1der_cursor_t *cur, lt_asn1der_span_t *whole, lt_asn1der_span_t *alg,
+                                  lt_asn1der_span_t *params)
 {
-    uint8_t b;
-    LT_ASN1_DER_GET_NEXT_BYTE(ctx, &b);
-
-    if (b < 127) {
-        *len = (uint16_t)b;
+    lt_asn1der_cursor_t seq;
+    lt_asn1der_tlv_t tlv;
+
+    LT_ASN1_DER_CHECK(lt_asn1der_expect(cur, LT_ASN1DER_SEQUENCE, &tlv));
+    *whole = tlv.raw;
+    lt_asn1der_enter(cur, &tlv, &seq);
+    LT_ASN1_DER_CHECK(lt_asn1der_expect(&seq, LT_ASN1DER_OBJECT_IDENTIFIER, &tlv));
+    *alg = tlv.value;
+
+    params->ptr = NULL;
+    params->len = 0;
+    lt_ret_t ret = lt_asn1der_next(&seq, &tlv);
+    if (ret == LT_CERT_ITEM_NOT_FOUND) {
+        return LT_OK;
     }
-    else {
-        uint8_t n_bytes = b ^ 0x80;
-
-        if (n_bytes > 2) {
-            LT_ASN1_DER_PARSE_ERR(ctx, "Unsupported length: More than 2 bytes");
-            return LT_CERT_UNSUPPORTED;
-        }
-
-        *len = 0;
-        for (int i = 0; i < n_bytes; i++) {
-            (*len) <<= 8;
-            LT_ASN1_DER_GET_NEXT_BYTE(ctx, &b);
-            *len |= b;
-        }
+    if ((ret == LT_OK) && (tlv.tag == LT_ASN1DER_OBJECT_IDENTIFIER)) {
+        *params = tlv.value;
     }
 
-    return LT_OK;
+    return ret;
 }
 
 /**
- * @brief Parse ASN1 object.
+ * @brief Reads a BIT STRING holding whole bytes (a key or a signature).
  *
- * @details Recursively parses the ASN1/DER stream and searches for Object with
- *          ctx->obj_id 3 byte identifier. If found, samples the follow-up item
- *          in the sequence that shall be of primitive type into ctx.
- *
- * @param   ctx     Parsing context
- * @returns LT_OK if successful, false otherwise
+ * @param cur     Cursor at the BIT STRING
+ * @param bits    Contents without the unused bits byte
+ * @return        LT_OK if successful, error code otherwise
  */
-static lt_ret_t parse_object(struct parse_ctx_t *ctx)
+static lt_ret_t lt_asn1der_bytes(lt_asn1der_cursor_t *cur, lt_asn1der_span_t *bits)
 {
-    uint8_t b = 0;
-    uint16_t len = 0;
-    lt_ret_t rv = LT_OK;
-
-    LT_ASN1_DER_GET_NEXT_BYTE(ctx, &b);
-
-    rv = parse_length(ctx, &len);
-    if (rv != LT_OK) return rv;
-
-    uint16_t start = ctx->past;
-
-#ifdef ASNDER_LOG_EN
-    LT_LOG("parse_object:");
-    LT_LOG("    Start: %" PRIu16, start);
-    LT_LOG("    Object type: 0x%" PRIx8, b);
-    LT_LOG("    Object len: %" PRIu16, len);
-#endif
-
-    switch (b) {
-        case LT_ASN1DER_SEQUENCE:
-            while (ctx->past < start + len - 1) {
-                rv = parse_object(ctx);
-                if (rv != LT_OK) return rv;
-            }
-
-            if (start + len != ctx->past) {
-                LT_ASN1_DER_PARSE_ERR(ctx,
-                                      "Invalid Sequence length. "
-                                      "Sequence start: %" PRIu16
-                                      ". "
-                                      "Expected length: %" PRIu16
-                                      ". "
-                                      "Expected end: %" PRIu16
-                                      ". "
-                                      "Real end: %" PRIu16,
-                                      start, len, start + len - 1, ctx->past);
-                return LT_CERT_STORE_INVALID;
-            }
-            break;
-
-        case LT_ASN1DER_OBJECT_IDENTIFIER: {
-            if (len < 3) {
-#ifdef ASNDER_LOG_EN
-                LT_LOG("Length too short (< 3), skipping.");
-#endif  // ASNDER_LOG_EN
-                break;
-            }
-
-            uint8_t buf[len];
-            LT_ASN1_DER_GET_BYTES(ctx, buf, len);
-
-            // We skip this step if the len is shorter than 3, so this is OK.
-            uint32_t obj_id = (((uint32_t)buf[0]) << 16) | (((uint32_t)buf[1]) << 8) | (((uint32_t)buf[2]));
-
-            if (ctx->obj_id == obj_id) {
-#ifdef ASNDER_LOG_EN
-                LT_LOG("Found searched object: 0x%" PRIx32 ". Next object will be sampled!", ctx->obj_id);
-#endif
-                ctx->sample_next = true;
-            }
-            break;
-        }
-
-        /* These object types can be searched for */
-        case LT_ASN1DER_BOOLEAN:
-        case LT_ASN1DER_INTEGER:
-        case LT_ASN1DER_STRING_BIT:
-        case LT_ASN1DER_STRING_OCTET:
-        case LT_ASN1DER_STRING_NULL:
-        case LT_ASN1DER_STRING_UTF8:
-        case LT_ASN1DER_STRING_PRINTABLE:
-        case LT_ASN1DER_UTC_TIME: {
-            if (ctx->sample_next & !ctx->found) {
-#ifdef ASNDER_LOG_EN
-                LT_LOG("Sampling this object!", ctx->obj_id);
-#endif
-                uint8_t sample_len = len;
-
-                if (ctx->sbuf_len < sample_len) {
-                    uint16_t n_crop_bytes = sample_len - ctx->sbuf_len;
-                    bool crop_prefix = ctx->crop_kind == LT_ASN1DER_CROP_PREFIX;
-                    ctx->cropped = true;
-
-#ifdef ASNDER_LOG_EN
-                    LT_LOG("Sample buffer (%d) is smaller than size of the object to be sampled (%" PRIu8
-                           "). "
-                           "Cropping %" PRIu16 " bytes from %s of the searched object",
-                           ctx->sbuf_len, sample_len, n_crop_bytes, crop_prefix ? "prefix" : "suffix");
-#endif
-
-                    if (crop_prefix) {
-                        LT_ASN1_DER_DROP_BYTES(ctx, n_crop_bytes)
-                    }
-
-                    sample_len = ctx->sbuf_len;
-                    LT_ASN1_DER_GET_BYTES(ctx, ctx->sbuf, sample_len);
-
-                    if (!crop_prefix) {
-                        LT_ASN1_DER_DROP_BYTES(ctx, n_crop_bytes)
-                    }
-                }
-                else {
-                    LT_ASN1_DER_GET_BYTES(ctx, ctx->sbuf, sample_len);
-                }
-
-                ctx->sample_next = false;
-                ctx->found = true;
-            }
-            else {
-                LT_ASN1_DER_DROP_BYTES(ctx, len);
-            }
-            break;
-        }
+    lt_asn1der_tlv_t tlv;
 
-        default:
-            LT_ASN1_DER_DROP_BYTES(ctx, len);
+    LT_ASN1_DER_CHECK(lt_asn1der_expect(cur, LT_ASN1DER_STRING_BIT, &tlv));
+    if ((tlv.value.len < 1) || (tlv.value.ptr[0] != 0)) {
+        LT_ASN1_DER_PARSE_ERR(cur, "BIT STRING does not hold whole bytes");
+        return LT_CERT_UNSUPPORTED;
     }
+    bits->ptr = tlv.value.ptr + 1;
+    bits->len = tlv.value.len - 1;
 
-    return rv;
+    return LT_OK;
 }
 
-/*******************************************************************************
- * Public API
- *******************************************************************************/
+/** @brief Reads a UTCTime or a GeneralizedTime. */
+static lt_ret_t lt_asn1der_time(lt_asn1der_cursor_t *cur, lt_asn1der_tlv_t *when)
+{
+    LT_ASN1_DER_CHECK(lt_asn1der_next(cur, when));
+    if ((when->tag != LT_ASN1DER_UTC_TIME) && (when->tag != LT_ASN1DER_GENERALIZED_TIME)) {
+        LT_ASN1_DER_PARSE_ERR(cur, "Expected time, found 0x%" PRIx8, when->tag);
+        return LT_CERT_STORE_INVALID;
+    }
+
+    return LT_OK;
+}
 
-lt_ret_t asn1der_find_object(const uint8_t *stream, uint16_t len, int32_t obj_id, uint8_t *buf, int buf_len,
-                             enum lt_asn1der_crop_kind_t crop_kind)
+lt_ret_t lt_asn1der_parse_cert(const uint8_t *der, const uint32_t len, lt_asn1der_cert_t *cert)
 {
-    struct parse_ctx_t ctx = {.head = (uint8_t *)stream,
-                              .len = len,
-                              .past = 0,
-                              .obj_id = obj_id,
-                              .sbuf = buf,
-                              .sbuf_len = buf_len,
-                              .crop_kind = crop_kind,
-                              .sample_next = false,
-                              .found = false,
-                              .cropped = false};
-
-    while (ctx.past < ctx.len - 1) {
-        lt_ret_t rv = parse_object(&ctx);
-        if (rv != LT_OK) return rv;
-    };
-
-    if (!ctx.found) return LT_CERT_ITEM_NOT_FOUND;
+    lt_asn1der_cursor_t top, crt, tbs, inner;
+    lt_asn1der_tlv_t tlv;
+    lt_asn1der_span_t unused;
+
+    memset(cert, 0, sizeof(*cert));
+    lt_asn1der_cursor_init(&top, der, len);
+
+    // Certificate ::= SEQUENCE { tbsCertificate, signatureAlgorithm, signatureValue }
+    LT_ASN1_DER_CHECK(lt_asn1der_expect(&top, LT_ASN1DER_SEQUENCE, &tlv));
+    lt_asn1der_enter(&top, &tlv, &crt);
+    LT_ASN1_DER_CHECK(lt_asn1der_expect(&crt, LT_ASN1DER_SEQUENCE, &tlv));
+    cert->tbs = tlv.raw;
+    lt_asn1der_enter(&crt, &tlv, &tbs);
+
+    // TBSCertificate ::= SEQUENCE { [0] version OPTIONAL, serialNumber, signature, issuer, validity, subject,
+    //                               subjectPublicKeyInfo, ... }
+    LT_ASN1_DER_CHECK(lt_asn1der_next(&tbs, &tlv));
+    if (tlv.tag == LT_ASN1DER_CONTEXT_0) {
+        LT_ASN1_DER_CHECK(lt_asn1der_next(&tbs, &tlv));
+    }
+    if (tlv.tag != LT_ASN1DER_INTEGER) {
+        LT_ASN1_DER_PARSE_ERR(&tbs, "Expected serial number, found 0x%" PRIx8, tlv.tag);
+        return LT_CERT_STORE_INVALID;
+    }
+    cert->serial = tlv.value;
+
+    LT_ASN1_DER_CHECK(lt_asn1der_alg_id(&tbs, &cert->tbs_sig_id, &unused, &unused));
+
+    LT_ASN1_DER_CHECK(lt_asn1der_expect(&tbs, LT_ASN1DER_SEQUENCE, &tlv));
+    cert->issuer = tlv.raw;
+
+    LT_ASN1_DER_CHECK(lt_asn1der_expect(&tbs, LT_ASN1DER_SEQUENCE, &tlv));
+    lt_asn1der_enter(&tbs, &tlv, &inner);
+    LT_ASN1_DER_CHECK(lt_asn1der_time(&inner, &cert->not_before));
+    LT_ASN1_DER_CHECK(lt_asn1der_time(&inner, &cert->not_after));
+
+    LT_ASN1_DER_CHECK(lt_asn1der_expect(&tbs, LT_ASN1DER_SEQUENCE, &tlv));
+    cert->subject = tlv.raw;
+
+    // SubjectPublicKeyInfo ::= SEQUENCE { algorithm AlgorithmIdentifier, subjectPublicKey BIT STRING }
+    LT_ASN1_DER_CHECK(lt_asn1der_expect(&tbs, LT_ASN1DER_SEQUENCE, &tlv));
+    cert->spki = tlv.raw;
+    lt_asn1der_enter(&tbs, &tlv, &inner);
+    LT_ASN1_DER_CHECK(lt_asn1der_alg_id(&inner, &unused, &cert->key_alg, &cert->key_params));
+    LT_ASN1_DER_CHECK(lt_asn1der_bytes(&inner, &cert->pub_key));
+
+    // Unique identifiers and extensions are not needed
+    LT_ASN1_DER_CHECK(lt_asn1der_alg_id(&crt, &cert->sig_id, &cert->sig_alg, &unused));
+    LT_ASN1_DER_CHECK(lt_asn1der_bytes(&crt, &cert->signature));
 
     return LT_OK;
 }
@@ -4,11 +4,17 @@
 /**
  * @file lt_asn1_der.h
  * @brief ASN1 DER parser
+ * @details Iterative cursor over a DER stream: elements are read one by one at a level and entered explicitly, so the
+ * parser does not recurse and its stack use does not depend on the input. Nothing is copied, parsed elements are
+ * spans pointing into the stream, which has to outlive them.
  * @author Tropic Square s.r.o.
  *
  * @license For the license see file LICENSE.txt file in the root directory of this source tree.
  */
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include "libtropic_common.h"
 
 #ifdef __cplusplus
@@ -25,38 +31,124 @@ typedef enum lt_asn1der_obj_kind_t {
     LT_ASN1DER_STRING_UTF8 = 0x0C,
     LT_ASN1DER_STRING_PRINTABLE = 0x13,
     LT_ASN1DER_UTC_TIME = 0x17,
+    LT_ASN1DER_GENERALIZED_TIME = 0x18,
     LT_ASN1DER_SEQUENCE = 0x30,
+    LT_ASN1DER_SET = 0x31,
+    LT_ASN1DER_CONTEXT_0 = 0xA0, /**< [0] EXPLICIT, e.g. version of a X509 certificate */
+    LT_ASN1DER_CONTEXT_3 = 0xA3, /**< [3] EXPLICIT, e.g. extensions of a X509 certificate */
 } lt_asn1der_obj_kind_t;
 
-typedef enum lt_asn1der_crop_kind_t { LT_ASN1DER_CROP_SUFFIX, LT_ASN1DER_CROP_PREFIX } lt_asn1der_crop_kind_t;
+/** @brief Content of OBJECT_IDENTIFIER 1.3.101.110 (X25519). */
+#define LT_ASN1DER_OID_X25519 {0x2B, 0x65, 0x6E}
+
+/** @brief Bytes within the parsed stream. */
+typedef struct lt_asn1der_span_t {
+    const uint8_t *ptr; /**< First byte, NULL for an empty span */
+    uint32_t len;       /**< Number of bytes */
+} lt_asn1der_span_t;
+
+/** @brief One element (tag, length, value) read by the cursor. */
+typedef struct lt_asn1der_tlv_t {
+    uint8_t tag;             /**< Tag, lt_asn1der_obj_kind_t for the supported ones */
+    lt_asn1der_span_t value; /**< Contents of the element */
+    lt_asn1der_span_t raw;   /**< Whole element including its tag and length */
+} lt_asn1der_tlv_t;
+
+/** @brief Cursor over the elements of one level of a DER stream. */
+typedef struct lt_asn1der_cursor_t {
+    const uint8_t *stream; /**< Start of the whole stream, for positions in error messages */
+    const uint8_t *pos;    /**< Next element */
+    const uint8_t *end;    /**< End of the level */
+} lt_asn1der_cursor_t;
+
+/**
+ * @brief Fields of a X509 certificate extracted in one pass by lt_asn1der_parse_cert().
+ * @note Spans point into the parsed certificate.
+ */
+typedef struct lt_asn1der_cert_t {
+    lt_asn1der_span_t tbs;        /**< Whole TBSCertificate, the signed bytes */
+    lt_asn1der_span_t serial;     /**< Contents of serialNumber INTEGER */
+    lt_asn1der_span_t tbs_sig_id; /**< Whole signature AlgorithmIdentifier of the TBSCertificate */
+    lt_asn1der_span_t issuer;     /**< Whole issuer Name */
+    lt_asn1der_tlv_t not_before;  /**< UTCTime or GeneralizedTime */
+    lt_asn1der_tlv_t not_after;   /**< UTCTime or GeneralizedTime */
+    lt_asn1der_span_t subject;    /**< Whole subject Name */
+    lt_asn1der_span_t spki;       /**< Whole SubjectPublicKeyInfo */
+    lt_asn1der_span_t key_alg;    /**< OBJECT_IDENTIFIER contents of the key algorithm */
+    lt_asn1der_span_t key_params; /**< OBJECT_IDENTIFIER contents of the key parameters (curve), empty if absent */
+    lt_asn1der_span_t pub_key;    /**< Public key, contents of the BIT STRING without the unused bits byte */
+    lt_asn1der_span_t sig_alg;    /**< OBJECT_IDENTIFIER contents of signatureAlgorithm */
+    lt_asn1der_span_t sig_id;     /**< Whole signatureAlgorithm AlgorithmIdentifier */
+    lt_asn1der_span_t signature;  /**< Signature, contents of the BIT STRING without the unused bits byte */
+} lt_asn1der_cert_t;
+
+/**
+ * @brief Initializes a cursor over a DER stream.
+ *
+ * @param cur     Cursor
+ * @param stream  DER stream
+ * @param len     Length of the stream
+ */
+void lt_asn1der_cursor_init(lt_asn1der_cursor_t *cur, const uint8_t *stream, const uint32_t len);
 
-#define LT_OBJ_ID_CURVEX25519 0x2B656E
+/**
+ * @brief Reads the next element at the level of the cursor and moves the cursor past it.
+ *
+ * @param cur     Cursor
+ * @param tlv     Read element
+ * @return        LT_OK if successful
+ *                LT_CERT_ITEM_NOT_FOUND if there is no element left at this level
+ *                LT_CERT_STORE_INVALID if the element is not valid DER (including a length not in the shortest
+ *                form) or does not fit into the level
+ *                LT_CERT_UNSUPPORTED for multi-byte tags and lengths over 4 bytes
+ */
+lt_ret_t lt_asn1der_next(lt_asn1der_cursor_t *cur, lt_asn1der_tlv_t *tlv) __attribute__((warn_unused_result));
 
 /**
- * @brief Parse ASN1 DER encoded stream and find certain OBJECT. Return data from primitve type
- *        right after the OBJECT_IDENTIFIER. If multiple objects of the searched OBJECT_KIND are
- *        present, return only first one.
+ * @brief Reads the next element, which must have the given tag.
  *
- * @param stream        Byte stream with X509 certificate to be parsed
- * @param len           Length of the certificate in the byte-stream
- * @param obj_id        3-byte OBJECT_IDENTIFIER to be searched for
- * @param buf           Buffer where to copy the found object value
- * @param buf_len       Size of the buffer pointed to by "buf"
- * @param crop_kind     If size of the found object is bigger than "buf" buffer, the only
- *                      part of the object is copied to "buf".
- *                          LT_ASN1DER_CROP_SUFFIX - Crop Suffix , copy to "buf" from 0 to "buf_len" - 1
- *                          LT_ASN1DER_CROP_PREFIX - Crop Prefix, copy to "buf" from N - buf_len to N - 1
- *                                                where N is length of the object being sampled.
- * @return lt_ret_t     LT_OK if sucessfull (and the object was found)
- *                      LT_CERT_STORE_INVALID if the stream does not contain valid ASN1 syntax
- *                      LT_CERT_UNSUPPORTED if the ASN1 stream contains features unsupported by this parser
- *                      LT_CERT_ITEM_NOT_FOUND if OBJECT_IDENTIFIER with "obj_id" value was not found!
- */
-lt_ret_t asn1der_find_object(const uint8_t *stream, uint16_t len, int32_t obj_id, uint8_t *buf, int buf_len,
-                             enum lt_asn1der_crop_kind_t crop_kind) __attribute__((warn_unused_result));
+ * @param cur     Cursor
+ * @param tag     Expected tag
+ * @param tlv     Read element
+ * @return        LT_OK if successful, LT_CERT_STORE_INVALID if the tag differs, otherwise as lt_asn1der_next()
+ */
+lt_ret_t lt_asn1der_expect(lt_asn1der_cursor_t *cur, const uint8_t tag, lt_asn1der_tlv_t *tlv)
+    __attribute__((warn_unused_result));
+
+/**
+ * @brief Initializes a cursor over the contents of a constructed element read by another cursor.
+ *
+ * @param parent  Cursor which read the element
+ * @param tlv     The element
+ * @param inner   Cursor over its contents
+ */
+void lt_asn1der_enter(const lt_asn1der_cursor_t *parent, const lt_asn1der_tlv_t *tlv, lt_asn1der_cursor_t *inner);
+
+/**
+ * @brief Extracts fields of a X509 certificate in one pass, without copying.
+ *
+ * @param der     DER encoded certificate
+ * @param len     Length of the certificate
+ * @param cert    Extracted fields
+ * @return        LT_OK if successful
+ *                LT_CERT_STORE_INVALID if the certificate is not valid DER or not a X509 certificate
+ *                LT_CERT_UNSUPPORTED if it uses DER features unsupported by the parser
+ */
+lt_ret_t lt_asn1der_parse_cert(const uint8_t *der, const uint32_t len, lt_asn1der_cert_t *cert)
+    __attribute__((warn_unused_result));
+
+/**
+ * @brief Compares a span with the given bytes.
+ *
+ * @param span    Span
+ * @param bytes   Bytes, e.g. OBJECT_IDENTIFIER contents
+ * @param len     Number of bytes
+ * @return        true if the span has the same length and contents
+ */
+bool lt_asn1der_span_eq(const lt_asn1der_span_t *span, const uint8_t *bytes, const uint32_t len);
 
 #ifdef __cplusplus
 }
 #endif
 
-#endif  // LT_ASN1_DER_H
\ No newline at end of file
+#endif  // LT_ASN1_DER_H
@@ -0,0 +1,40 @@
+#ifndef LT_HANDLE_LOCK_H
+#define LT_HANDLE_LOCK_H
+
+/**
+ * @file lt_handle_lock.h
+ * @brief Locking of the handle by functions taking it, used with LT_THREAD_SAFE
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include "libtropic_common.h"
+#include "libtropic_port.h"
+
+#if LT_THREAD_SAFE
+/** @brief Unlocks the handle locked by LT_HANDLE_LOCK() when the locking function returns. */
+static inline void lt_handle_unlock_on_return(lt_handle_t **h)
+{
+    if (*h) {
+        lt_port_mutex_unlock((*h)->mutex);
+    }
+}
+
+/**
+ * @brief Locks the handle until the calling function returns. Makes the function return LT_FAIL if the mutex cannot
+ * be locked. A handle without a mutex (lt_init() was not called) is not locked.
+ */
+#define LT_HANDLE_LOCK(h)                                                                      \
+    lt_handle_t *lt_locked_handle __attribute__((cleanup(lt_handle_unlock_on_return))) = NULL; \
+    if ((h) && (h)->mutex) {                                                                   \
+        if (lt_port_mutex_lock((h)->mutex) != LT_OK) {                                         \
+            return LT_FAIL;                                                                    \
+        }                                                                                      \
+        lt_locked_handle = (h);                                                                \
+    }
+#else
+#define LT_HANDLE_LOCK(h)
+#endif
+
+#endif  // LT_HANDLE_LOCK_H
@@ -0,0 +1,105 @@
+/**
+ * @file   lt_hmac_drbg.c
+ * @brief  HMAC_DRBG (SHA256) function definitions
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include "lt_hmac_drbg.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "lt_hmac_sha256.h"
+
+/**
+ * @brief HMAC_DRBG_Update from NIST SP 800-90A, section 10.1.2.2, with the provided data given in up to three parts.
+ *
+ * @param key       DRBG key (K)
+ * @param v         DRBG value (V)
+ * @param data      Parts of the provided data, NULL for an empty part
+ * @param data_len  Lengths of the parts
+ */
+static void lt_hmac_drbg_update(uint8_t *key, uint8_t *v, const uint8_t *data[3], const size_t data_len[3])
+{
+    struct lt_crypto_hmac_sha256_ctx_t ctx;
+    uint8_t tmp[LT_HMAC_SHA256_HASH_LEN];
+    bool provided = false;
+
+    for (int i = 0; i < 3; i++) {
+        provided |= (data[i] != NULL) && (data_len[i] != 0);
+    }
+
+    for (uint8_t round = 0x00; round <= 0x01; round++) {
+        // K = HMAC(K, V || 0x00/0x01 || provided_data)
+        lt_hmac_sha256_init(&ctx, key, LT_HMAC_SHA256_HASH_LEN);
+        lt_hmac_sha256_update(&ctx, v, LT_HMAC_SHA256_HASH_LEN);
+        lt_hmac_sha256_update(&ctx, &round, 1);
+        for (int i = 0; i < 3; i++) {
+            if (data[i] && data_len[i]) {
+                lt_hmac_sha256_update(&ctx, data[i], data_len[i]);
+            }
+        }
+        lt_hmac_sha256_finish(&ctx, tmp);
+        memcpy(key, tmp, LT_HMAC_SHA256_HASH_LEN);
+        // V = HMAC(K, V)
+        lt_hmac_sha256(key, LT_HMAC_SHA256_HASH_LEN, v, LT_HMAC_SHA256_HASH_LEN, tmp);
+        memcpy(v, tmp, LT_HMAC_SHA256_HASH_LEN);
+
+        // Second round is done only when there is provided data
+        if (!provided) {
+            break;
+        }
+    }
+
+    memset(tmp, 0, sizeof(tmp));
+}
+
+void lt_hmac_drbg_instantiate(uint8_t *key, uint8_t *v, const uint8_t *entropy, size_t entropy_len,
+                              const uint8_t *nonce, size_t nonce_len, const uint8_t *pers, size_t pers_len)
+{
+    const uint8_t *data[3] = {entropy, nonce, pers};
+    const size_t data_len[3] = {entropy_len, nonce_len, pers_len};
+
+    memset(key, 0x00, LT_HMAC_SHA256_HASH_LEN);
+    memset(v, 0x01, LT_HMAC_SHA256_HASH_LEN);
+
+    lt_hmac_drbg_update(key, v, data, data_len);
+}
+
+void lt_hmac_drbg_reseed(uint8_t *key, uint8_t *v, const uint8_t *entropy, size_t entropy_len, const uint8_t *addin,
+                         size_t addin_len)
+{
+    const uint8_t *data[3] = {entropy, addin, NULL};
+    const size_t data_len[3] = {entropy_len, addin_len, 0};
+
+    lt_hmac_drbg_update(key, v, data, data_len);
+}
+
+void lt_hmac_drbg_generate(uint8_t *key, uint8_t *v, const uint8_t *addin, size_t addin_len, uint8_t *output,
+                           size_t len)
+{
+    const uint8_t *data[3] = {addin, NULL, NULL};
+    const size_t data_len[3] = {addin_len, 0, 0};
+    uint8_t tmp[LT_HMAC_SHA256_HASH_LEN];
+
+    if (addin && addin_len) {
+        lt_hmac_drbg_update(key, v, data, data_len);
+    }
+
+    while (len) {
+        size_t block_len = (len < LT_HMAC_SHA256_HASH_LEN) ? len : LT_HMAC_SHA256_HASH_LEN;
+
+        lt_hmac_sha256(key, LT_HMAC_SHA256_HASH_LEN, v, LT_HMAC_SHA256_HASH_LEN, tmp);
+        memcpy(v, tmp, LT_HMAC_SHA256_HASH_LEN);
+        memcpy(output, v, block_len);
+
+        output += block_len;
+        len -= block_len;
+    }
+
+    lt_hmac_drbg_update(key, v, data, data_len);
+    memset(tmp, 0, sizeof(tmp));
+}
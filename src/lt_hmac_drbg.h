@@ -0,0 +1,67 @@
+#ifndef LT_HMAC_DRBG_H
+#define LT_HMAC_DRBG_H
+
+/**
+ * @file   lt_hmac_drbg.h
+ * @brief  HMAC_DRBG (SHA256) function declarations
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lt_hmac_sha256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @details Instantiates HMAC_DRBG as described in NIST SP 800-90A, section 10.1.2.3. The seed material is the
+ *          concatenation of entropy input, nonce and personalization string.
+ *
+ * @param key       DRBG key (K), LT_HMAC_SHA256_HASH_LEN bytes, overwritten
+ * @param v         DRBG value (V), LT_HMAC_SHA256_HASH_LEN bytes, overwritten
+ * @param entropy     Entropy input
+ * @param entropy_len Length of the entropy input
+ * @param nonce     Nonce, may be NULL
+ * @param nonce_len Length of the nonce
+ * @param pers      Personalization string, may be NULL
+ * @param pers_len  Length of the personalization string
+ */
+void lt_hmac_drbg_instantiate(uint8_t *key, uint8_t *v, const uint8_t *entropy, size_t entropy_len,
+                              const uint8_t *nonce, size_t nonce_len, const uint8_t *pers, size_t pers_len);
+
+/**
+ * @details Reseeds HMAC_DRBG as described in NIST SP 800-90A, section 10.1.2.4.
+ *
+ * @param key       DRBG key (K), LT_HMAC_SHA256_HASH_LEN bytes
+ * @param v         DRBG value (V), LT_HMAC_SHA256_HASH_LEN bytes
+ * @param entropy     Fresh entropy input
+ * @param entropy_len Length of the entropy input
+ * @param addin     Additional input, may be NULL
+ * @param addin_len Length of the additional input
+ */
+void lt_hmac_drbg_reseed(uint8_t *key, uint8_t *v, const uint8_t *entropy, size_t entropy_len, const uint8_t *addin,
+                         size_t addin_len);
+
+/**
+ * @details Generates pseudorandom bytes as described in NIST SP 800-90A, section 10.1.2.5.
+ *
+ * @param key       DRBG key (K), LT_HMAC_SHA256_HASH_LEN bytes
+ * @param v         DRBG value (V), LT_HMAC_SHA256_HASH_LEN bytes
+ * @param addin     Additional input, may be NULL
+ * @param addin_len Length of the additional input
+ * @param output    Output buffer
+ * @param len       Number of bytes to generate
+ */
+void lt_hmac_drbg_generate(uint8_t *key, uint8_t *v, const uint8_t *addin, size_t addin_len, uint8_t *output,
+                           size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LT_HMAC_DRBG_H
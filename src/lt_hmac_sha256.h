@@ -21,6 +21,19 @@ extern "C" {
  */
 #define LT_HMAC_SHA256_HASH_LEN 32
 
+/**
+ * @brief HMAC SHA256 context structure
+ * @details A context can be copied after lt_hmac_sha256_init() to compute several MACs under the same key without
+ * processing the key again.
+ */
+struct lt_crypto_hmac_sha256_ctx_t {
+#if LT_CRYPTO_TREZOR
+    uint64_t space[32];
+#else
+#error "Incremental HMAC SHA256 is implemented only for trezor_crypto, add it to the crypto HAL of this provider"
+#endif
+};
+
 /**
  * @details This function computes HMAC SHA256 algorithm
  *
@@ -32,6 +45,32 @@ extern "C" {
  */
 void lt_hmac_sha256(const uint8_t *key, size_t keylen, const uint8_t *input, size_t ilen, uint8_t *output);
 
+/**
+ * @details This function initializes HMAC context with a key
+ *
+ * @param ctx     HMAC context
+ * @param key     Key data buffer
+ * @param keylen  Length of data in key data buffer
+ */
+void lt_hmac_sha256_init(void *ctx, const uint8_t *key, size_t keylen);
+
+/**
+ * @details This function adds data to HMAC context
+ *
+ * @param ctx    HMAC context
+ * @param input  Input data buffer
+ * @param ilen   Length of data in input data buffer
+ */
+void lt_hmac_sha256_update(void *ctx, const uint8_t *input, size_t ilen);
+
+/**
+ * @brief This function finalizes HMAC computation, outputs the MAC and wipes the context
+ *
+ * @param ctx     HMAC context
+ * @param output  Output buffer
+ */
+void lt_hmac_sha256_finish(void *ctx, uint8_t *output);
+
 #ifdef __cplusplus
 }
 #endif
@@ -37,6 +37,35 @@ static void print_hex_chunks(const uint8_t *data, uint8_t len, uint8_t dir)
 }
 #endif
 
+/**
+ * @brief Waits before the next GET_INFO retry.
+ * @details Retries start with a short delay, which is doubled up to LT_L1_READ_RETRY_DELAY, so responses which are
+ * ready early are not delayed by the full retry delay. Shorter retries do not count into LT_L1_READ_MAX_TRIES, so the
+ * overall timeout is not shortened.
+ *
+ * @param s2           Structure holding l2 state
+ * @param retry_delay  Delay of this retry, updated for the next one
+ * @param max_tries    Remaining number of tries
+ * @return             LT_OK if success, otherwise returns other error code.
+ */
+static lt_ret_t lt_l1_read_retry_delay(lt_l2_state_t *s2, uint32_t *retry_delay, int *max_tries)
+{
+    lt_ret_t ret = lt_l1_delay(s2, *retry_delay);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    if (*retry_delay < LT_L1_READ_RETRY_DELAY) {
+        (*max_tries)++;
+        *retry_delay *= 2;
+        if (*retry_delay > LT_L1_READ_RETRY_DELAY) {
+            *retry_delay = LT_L1_READ_RETRY_DELAY;
+        }
+    }
+
+    return LT_OK;
+}
+
 lt_ret_t lt_l1_read(lt_l2_state_t *s2, const uint32_t max_len, const uint32_t timeout_ms)
 {
 #ifdef LT_REDUNDANT_ARG_CHECK
@@ -55,6 +84,7 @@ lt_ret_t lt_l1_read(lt_l2_state_t *s2, const uint32_t max_len, const uint32_t ti
 
     lt_ret_t ret;
     int max_tries = LT_L1_READ_MAX_TRIES;
+    uint32_t retry_delay = LT_L1_READ_RETRY_DELAY_MIN;
 
     while (max_tries > 0) {
         max_tries--;
@@ -108,7 +138,7 @@ lt_ret_t lt_l1_read(lt_l2_state_t *s2, const uint32_t max_len, const uint32_t ti
                 if (ret != LT_OK) {
                     return ret;
                 }
-                ret = lt_l1_delay(s2, LT_L1_READ_RETRY_DELAY);
+                ret = lt_l1_read_retry_delay(s2, &retry_delay, &max_tries);
                 if (ret != LT_OK) {
                     return ret;
                 }
@@ -149,8 +179,7 @@ lt_ret_t lt_l1_read(lt_l2_state_t *s2, const uint32_t max_len, const uint32_t ti
             if (s2->mode == LT_TR01_MAINTENANCE_MODE) {
                 // Chip is in bootloader mode and INT pin is not implemented in bootloader mode
                 // So we wait a bit before we poll again for CHIP_STATUS
-                // printf("x\n");
-                ret = lt_l1_delay(s2, LT_L1_READ_RETRY_DELAY);
+                ret = lt_l1_read_retry_delay(s2, &retry_delay, &max_tries);
                 if (ret != LT_OK) {
                     return ret;
                 }
@@ -158,12 +187,12 @@ lt_ret_t lt_l1_read(lt_l2_state_t *s2, const uint32_t max_len, const uint32_t ti
             else {
                 // We are in application. IF INT pin is enabled, wait for it to go low
 #if LT_USE_INT_PIN
-                ret = lt_l1_delay_on_int(h, LT_L1_TIMEOUT_MS_MAX);
+                ret = lt_l1_delay_on_int(s2, LT_L1_TIMEOUT_MS_MAX);
                 if (ret != LT_OK) {
                     return ret;
                 }
 #else
-                ret = lt_l1_delay(s2, LT_L1_READ_RETRY_DELAY);
+                ret = lt_l1_read_retry_delay(s2, &retry_delay, &max_tries);
                 if (ret != LT_OK) {
                     return ret;
                 }
@@ -175,6 +204,90 @@ lt_ret_t lt_l1_read(lt_l2_state_t *s2, const uint32_t max_len, const uint32_t ti
     return LT_L1_CHIP_BUSY;
 }
 
+lt_ret_t lt_l1_read_chip_status(lt_l2_state_t *s2, uint8_t *status)
+{
+#ifdef LT_REDUNDANT_ARG_CHECK
+    if (!s2 || !status) {
+        return LT_PARAM_ERR;
+    }
+#endif
+
+    // The byte used here must not be ID byte of some request, otherwise chip would be confused
+    // and would return CRC error.
+    // GET_RESP 0xAA works fine.
+    s2->buff[0] = TR01_L1_GET_RESPONSE_REQ_ID;
+
+    // Transfer just one byte to read CHIP_STATUS byte
+    lt_ret_t ret = lt_l1_spi_csn_low(s2);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    ret = lt_l1_spi_transfer(s2, 0, 1, LT_L1_TIMEOUT_MS_DEFAULT);
+    if (ret != LT_OK) {
+        lt_ret_t ret_unused = lt_l1_spi_csn_high(s2);
+        LT_UNUSED(ret_unused);  // We don't care about it, we return ret from SPI transfer anyway.
+        return ret;
+    }
+
+    ret = lt_l1_spi_csn_high(s2);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    *status = s2->buff[0];
+    // Save info about chip mode into 'mode' variable
+    if (*status & TR01_L1_CHIP_MODE_STARTUP_bit) {
+        s2->mode = LT_TR01_MAINTENANCE_MODE;
+    }
+    else {
+        s2->mode = LT_TR01_APP_MODE;
+    }
+
+    return LT_OK;
+}
+
+lt_ret_t lt_l1_wait_ready(lt_l2_state_t *s2, const lt_tr01_mode_t mode, const bool require_down,
+                          const uint32_t max_wait_ms, uint32_t *waited_ms)
+{
+#ifdef LT_REDUNDANT_ARG_CHECK
+    if (!s2 || !waited_ms) {
+        return LT_PARAM_ERR;
+    }
+#endif
+
+    uint32_t delay = LT_L1_READY_POLL_DELAY_MIN;
+    bool down = !require_down;
+    *waited_ms = 0;
+
+    while (*waited_ms < max_wait_ms) {
+        uint32_t wait = (delay < max_wait_ms - *waited_ms) ? delay : (max_wait_ms - *waited_ms);
+        lt_ret_t ret = lt_l1_delay(s2, wait);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        *waited_ms += wait;
+        delay = (2 * delay < LT_L1_READY_POLL_DELAY_MAX) ? 2 * delay : LT_L1_READY_POLL_DELAY_MAX;
+
+        uint8_t status;
+        ret = lt_l1_read_chip_status(s2, &status);
+        if (ret != LT_OK) {
+            return ret;
+        }
+
+        // A rebooting chip reads as not READY or, with MISO not driven, as 0xFF (ALARM bit set)
+        if ((status & TR01_L1_CHIP_MODE_ALARM_bit) || !(status & TR01_L1_CHIP_MODE_READY_bit)) {
+            down = true;
+            continue;
+        }
+        if (down && (s2->mode == mode)) {
+            return LT_OK;
+        }
+    }
+
+    return LT_L1_CHIP_BUSY;
+}
+
 lt_ret_t lt_l1_write(lt_l2_state_t *s2, const uint16_t len, const uint32_t timeout_ms)
 {
 #ifdef LT_REDUNDANT_ARG_CHECK
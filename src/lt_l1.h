@@ -33,6 +33,13 @@ extern "C" {
 #define LT_L1_READ_MAX_TRIES 50
 /** Number of ms to wait between each GET_INFO request */
 #define LT_L1_READ_RETRY_DELAY 25
+/** Number of ms to wait before the first GET_INFO retry, doubled on every retry up to LT_L1_READ_RETRY_DELAY */
+#define LT_L1_READ_RETRY_DELAY_MIN 1
+
+/** Number of ms to wait before the first CHIP_STATUS poll after reboot */
+#define LT_L1_READY_POLL_DELAY_MIN 1
+/** Maximal number of ms between two CHIP_STATUS polls after reboot */
+#define LT_L1_READY_POLL_DELAY_MAX 16
 
 /** Minimal timeout when waiting for activity on SPI bus */
 #define LT_L1_TIMEOUT_MS_MIN 5
@@ -55,6 +62,31 @@ extern "C" {
 lt_ret_t lt_l1_read(lt_l2_state_t *s2, const uint32_t max_len, const uint32_t timeout_ms)
     __attribute__((warn_unused_result));
 
+/**
+ * @brief Reads CHIP_STATUS byte and updates mode in l2 state according to its STARTUP bit
+ *
+ * @param s2          Structure holding l2 state
+ * @param status      CHIP_STATUS byte
+ * @return            LT_OK if success, otherwise returns other error code.
+ */
+lt_ret_t lt_l1_read_chip_status(lt_l2_state_t *s2, uint8_t *status) __attribute__((warn_unused_result));
+
+/**
+ * @brief Polls CHIP_STATUS with growing intervals until TROPIC01 is ready in the expected mode
+ * @details Used after Startup_Req. When the chip reboots into the mode it was already in, a CHIP_STATUS without READY
+ * bit has to be seen first, so the chip is not mistaken as ready before it actually rebooted.
+ *
+ * @param s2            Structure holding l2 state
+ * @param mode          Expected mode
+ * @param require_down  Wait for a CHIP_STATUS without READY bit before accepting READY
+ * @param max_wait_ms   Maximal total time of waiting
+ * @param waited_ms     Total time waited
+ * @return              LT_OK if the chip is ready, LT_L1_CHIP_BUSY if `max_wait_ms` elapsed, otherwise returns
+ *                      other error code.
+ */
+lt_ret_t lt_l1_wait_ready(lt_l2_state_t *s2, const lt_tr01_mode_t mode, const bool require_down,
+                          const uint32_t max_wait_ms, uint32_t *waited_ms) __attribute__((warn_unused_result));
+
 /**
  * @brief Writes data from host platform into TROPIC01
  *
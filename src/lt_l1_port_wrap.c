@@ -72,6 +72,9 @@ lt_ret_t lt_l1_delay(lt_l2_state_t *s2, uint32_t ms)
         return LT_PARAM_ERR;
     }
 #endif
+    // The port is called also with a virtual clock, so ports stacked on other ports see the wait
+    s2->clock.elapsed_ms += ms;
+
     return lt_port_delay(s2, ms);
 }
 
@@ -84,6 +87,8 @@ lt_ret_t lt_l1_delay_on_int(lt_l2_state_t *s2, uint32_t ms)
         return LT_PARAM_ERR;
     }
 #endif
+    s2->clock.elapsed_ms += ms;
+
     return lt_port_delay_on_int(s2, ms);
 }
 #endif
@@ -70,7 +70,7 @@ lt_ret_t lt_l1_spi_transfer(lt_l2_state_t *s2, uint8_t offset, uint16_t tx_len,
 /**
  * @brief Platform's definition for delay, specifies what host
  *        platform should do when libtropic's functions need some delay.
- *        This is wrapper for platform defined function.
+ *        This is wrapper for platform defined function, which returns at once with a virtual clock (lt_clock_t).
  *
  * @param s2          Structure holding l2 state
  * @param ms          Time to wait in miliseconds
@@ -81,6 +81,7 @@ lt_ret_t lt_l1_delay(lt_l2_state_t *s2, uint32_t ms) __attribute__((warn_unused_
 #if LT_USE_INT_PIN
 /**
  * @brief Specifies what platform should do when waiting for signal from interrupt pin
+ * @note With a virtual clock (lt_clock_t), the signal is taken as arriving after the whole ms.
  *
  * @param s2          Structure holding l2 state
  * @param ms          Maximal time to wait in miliseconds
@@ -0,0 +1,157 @@
+/**
+ * @file lt_l3_pipeline.c
+ * @brief Execution of a sequence of L3 commands with host and TROPIC01 work overlapped
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include "lt_l3_pipeline.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "libtropic_common.h"
+#include "libtropic_l2.h"
+#include "libtropic_macros.h"
+#include "lt_l3_process.h"
+
+/**
+ * @brief Prepares the next command which can be sent, skipping commands which fail to be prepared.
+ *
+ * @param h              Device's handle
+ * @param ops            Callbacks describing the commands
+ * @param ctx            Context passed to the callbacks
+ * @param cnt            Number of commands
+ * @param idx            Index of the first command to try, updated to the index after the last tried command
+ * @param stop_on_error  Do not try further commands after a failure
+ * @param prepared       Set to true when a command was prepared in `h->l3.buff`
+ * @param prepared_idx   Index of the prepared command
+ *
+ * @return               LT_OK, or the error of a failed command when `stop_on_error` is set
+ */
+static lt_ret_t lt_l3_pipeline_prepare(lt_handle_t *h, const lt_l3_pipeline_ops_t *ops, void *ctx, const size_t cnt,
+                                       size_t *idx, const bool stop_on_error, bool *prepared, size_t *prepared_idx)
+{
+    *prepared = false;
+
+    while (*idx < cnt) {
+        size_t i = (*idx)++;
+        lt_ret_t ret = ops->out(h, ctx, i);
+        if (ret == LT_OK) {
+            *prepared = true;
+            *prepared_idx = i;
+            return LT_OK;
+        }
+
+        ops->result(ctx, i, ret);
+        if (stop_on_error) {
+            return ret;
+        }
+    }
+
+    return LT_OK;
+}
+
+lt_ret_t lt_l3_pipeline_run(lt_handle_t *h, const lt_l3_pipeline_ops_t *ops, void *ctx, const size_t cnt,
+                            uint8_t *stage, const uint16_t stage_size, const bool stop_on_error)
+{
+    if (!h || !ops || !ops->out || !ops->in || !ops->result || !stage) {
+        return LT_PARAM_ERR;
+    }
+    if (h->l3.session_status != LT_SECURE_SESSION_ON) {
+        return LT_HOST_NO_SESSION;
+    }
+
+    size_t idx = 0;
+    size_t cur_idx = 0, next_idx = 0;
+    bool cur_valid, next_valid;
+
+    // Start the first command directly from the L3 buffer
+    lt_ret_t ret = lt_l3_pipeline_prepare(h, ops, ctx, cnt, &idx, stop_on_error, &cur_valid, &cur_idx);
+    if (ret != LT_OK) {
+        return ret;
+    }
+    if (cur_valid) {
+        ret = lt_l2_send_encrypted_cmd(&h->l2, h->l3.buff, h->l3.buff_len);
+        if (ret != LT_OK) {
+            ops->result(ctx, cur_idx, ret);
+            return ret;
+        }
+    }
+
+    lt_ret_t stop_ret = LT_OK;
+    while (cur_valid) {
+        // L3 buffer is free while the current command is executed, prepare the next one and put it aside
+        next_valid = false;
+        if (stop_ret == LT_OK) {
+            stop_ret = lt_l3_pipeline_prepare(h, ops, ctx, cnt, &idx, stop_on_error, &next_valid, &next_idx);
+        }
+        if (next_valid) {
+            struct lt_l3_gen_frame_t *p_frame = (struct lt_l3_gen_frame_t *)h->l3.buff;
+            uint16_t packet_size = TR01_L3_CMD_SIZE_SIZE + p_frame->cmd_size + TR01_L3_TAG_SIZE;
+            if (packet_size > stage_size) {
+                // Encryption nonce was already used for this command, so the session cannot continue in order
+                lt_ret_t ret_unused = lt_l2_recv_encrypted_res(&h->l2, h->l3.buff, h->l3.buff_len);
+                LT_UNUSED(ret_unused);
+                lt_l3_invalidate_host_session_data(&h->l3);
+                ops->result(ctx, cur_idx, LT_PARAM_ERR);
+                ops->result(ctx, next_idx, LT_PARAM_ERR);
+                return LT_PARAM_ERR;
+            }
+            memcpy(stage, h->l3.buff, packet_size);
+        }
+
+        ret = lt_l2_recv_encrypted_res(&h->l2, h->l3.buff, h->l3.buff_len);
+        if (ret != LT_OK) {
+            // Neither the command in flight nor the one put aside can be completed
+            ops->result(ctx, cur_idx, ret);
+            if (next_valid) {
+                ops->result(ctx, next_idx, ret);
+            }
+            return ret;
+        }
+
+        // Keep TROPIC01 busy with the next command while the received response is processed
+        lt_ret_t send_ret = LT_OK;
+        if (next_valid) {
+            send_ret = lt_l2_send_encrypted_cmd(&h->l2, stage, stage_size);
+        }
+
+        ret = ops->in(h, ctx, cur_idx);
+        ops->result(ctx, cur_idx, ret);
+
+        if (send_ret != LT_OK) {
+            ops->result(ctx, next_idx, send_ret);
+            return send_ret;
+        }
+
+        if (h->l3.session_status != LT_SECURE_SESSION_ON) {
+            // Response could not be decrypted, read out the one in flight and give up
+            if (next_valid) {
+                lt_ret_t ret_unused = lt_l2_recv_encrypted_res(&h->l2, h->l3.buff, h->l3.buff_len);
+                LT_UNUSED(ret_unused);
+            }
+            return (ret != LT_OK) ? ret : LT_HOST_NO_SESSION;
+        }
+
+        if ((ret != LT_OK) && stop_on_error) {
+            if (next_valid) {
+                // The next command was already sent, its result is reported as well
+                lt_ret_t ret_next = lt_l2_recv_encrypted_res(&h->l2, h->l3.buff, h->l3.buff_len);
+                if (ret_next == LT_OK) {
+                    ret_next = ops->in(h, ctx, next_idx);
+                }
+                ops->result(ctx, next_idx, ret_next);
+            }
+            return ret;
+        }
+
+        cur_valid = next_valid;
+        cur_idx = next_idx;
+    }
+
+    return stop_ret;
+}
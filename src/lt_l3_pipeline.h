@@ -0,0 +1,64 @@
+#ifndef LT_L3_PIPELINE_H
+#define LT_L3_PIPELINE_H
+
+/**
+ * @file lt_l3_pipeline.h
+ * @brief Execution of a sequence of L3 commands with host and TROPIC01 work overlapped
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libtropic_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Callbacks describing a sequence of L3 commands.
+ */
+typedef struct lt_l3_pipeline_ops_t {
+    /** Prepares and encrypts command `idx` into `h->l3.buff`, usually by calling lt_out__X(). */
+    lt_ret_t (*out)(lt_handle_t *h, void *ctx, size_t idx);
+    /** Decrypts and processes the response to command `idx` in `h->l3.buff`, usually by calling lt_in__X(). */
+    lt_ret_t (*in)(lt_handle_t *h, void *ctx, size_t idx);
+    /**
+     * Stores result of command `idx`, called exactly once for each command which was attempted, also when the
+     * sequence is aborted by an error.
+     */
+    void (*result)(void *ctx, size_t idx, lt_ret_t ret);
+} lt_l3_pipeline_ops_t;
+
+/**
+ * @brief Executes `cnt` L3 commands back to back.
+ * @details While TROPIC01 executes command N, command N+1 is encrypted and put aside into `stage`. As soon as the
+ * response to N is received, N+1 is sent and only then the response to N is decrypted. Host-side AES-GCM work thus
+ * overlaps with command execution on TROPIC01. Encryption and decryption nonces advance in command order, as TROPIC01
+ * expects.
+ *
+ * @param h              Device's handle
+ * @param ops            Callbacks describing the commands
+ * @param ctx            Context passed to the callbacks
+ * @param cnt            Number of commands
+ * @param stage          Buffer for one encrypted command waiting to be sent
+ * @param stage_size     Size of `stage`, must fit the biggest command of the sequence
+ * @param stop_on_error  When true, no further command is started after the first command which did not return LT_OK
+ *
+ * @retval LT_OK         All commands were attempted, see their results reported through `ops->result`
+ * @retval other         The first failed command when `stop_on_error` is set, or an error (L2 communication, lost
+ * Secure Session) which made further processing impossible
+ */
+lt_ret_t lt_l3_pipeline_run(lt_handle_t *h, const lt_l3_pipeline_ops_t *ops, void *ctx, const size_t cnt,
+                            uint8_t *stage, const uint16_t stage_size, const bool stop_on_error)
+    __attribute__((warn_unused_result));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LT_L3_PIPELINE_H
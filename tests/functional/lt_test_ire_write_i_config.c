@@ -33,10 +33,22 @@ void lt_test_ire_write_i_config(lt_handle_t *h)
     LT_TEST_ASSERT(LT_OK, lt_verify_chip_and_start_secure_session(h, sh0priv, sh0pub, TR01_PAIRING_KEY_SLOT_INDEX_0));
     LT_LOG_LINE();
 
+    uint16_t write_cnt;
+
+    LT_LOG_INFO("Planning write of the whole I config (dry run)");
+    LT_TEST_ASSERT(LT_OK, lt_write_whole_I_config_dry_run(h, &i_config_random, &write_cnt));
+    LT_LOG_INFO("Bits to be cleared: %" PRIu16, write_cnt);
+    LT_LOG_LINE();
+
     LT_LOG_INFO("Writing the whole I config");
     LT_TEST_ASSERT(LT_OK, lt_write_whole_I_config(h, &i_config_random));
     LT_LOG_LINE();
 
+    LT_LOG_INFO("Checking that nothing is left to be written");
+    LT_TEST_ASSERT(LT_OK, lt_write_whole_I_config_dry_run(h, &i_config_random, &write_cnt));
+    LT_TEST_ASSERT(0, write_cnt);
+    LT_LOG_LINE();
+
     LT_LOG_INFO("Reading the whole I config");
     LT_TEST_ASSERT(LT_OK, lt_read_whole_I_config(h, &i_config));
     for (uint8_t i = 0; i < LT_CONFIG_OBJ_CNT; i++) {
@@ -0,0 +1,186 @@
+/**
+ * @file lt_test_rev_batch.c
+ * @brief Tests L3 command batch executor - lt_batch_run.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <inttypes.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_functional_tests.h"
+#include "libtropic_logging.h"
+#include "lt_random.h"
+#include "string.h"
+
+/** @brief R memory slot used by the test. */
+#define BATCH_R_MEM_SLOT 0
+/** @brief ECC key slot used by the test. */
+#define BATCH_ECC_SLOT TR01_ECC_SLOT_0
+/** @brief Monotonic counter used by the test. */
+#define BATCH_MCOUNTER TR01_MCOUNTER_INDEX_0
+/** @brief Initial value of the monotonic counter. */
+#define BATCH_MCOUNTER_INIT_VAL 10
+
+// Shared with cleanup function
+static lt_handle_t *g_h;
+
+static lt_ret_t lt_test_rev_batch_cleanup(void)
+{
+    lt_ret_t ret;
+
+    LT_LOG_INFO("Erasing R memory slot %d", BATCH_R_MEM_SLOT);
+    ret = lt_r_mem_data_erase(g_h, BATCH_R_MEM_SLOT);
+    if (LT_OK != ret) {
+        LT_LOG_ERROR("Failed to erase R memory slot.");
+        return ret;
+    }
+
+    LT_LOG_INFO("Erasing ECC key slot %d", (int)BATCH_ECC_SLOT);
+    ret = lt_ecc_key_erase(g_h, BATCH_ECC_SLOT);
+    if (LT_OK != ret) {
+        LT_LOG_ERROR("Failed to erase ECC key slot.");
+        return ret;
+    }
+
+    LT_LOG_INFO("Initializing monotonic counter %d to zero", (int)BATCH_MCOUNTER);
+    ret = lt_mcounter_init(g_h, BATCH_MCOUNTER, 0);
+    if (LT_OK != ret) {
+        LT_LOG_ERROR("Failed to initialize monotonic counter.");
+        return ret;
+    }
+
+    LT_LOG_INFO("Aborting secure session");
+    ret = lt_session_abort(g_h);
+    if (LT_OK != ret) {
+        LT_LOG_ERROR("Failed to abort secure session.");
+        return ret;
+    }
+
+    LT_LOG_INFO("Deinitializing handle");
+    ret = lt_deinit(g_h);
+    if (LT_OK != ret) {
+        LT_LOG_ERROR("Failed to deinitialize handle.");
+        return ret;
+    }
+
+    return LT_OK;
+}
+
+void lt_test_rev_batch(lt_handle_t *h)
+{
+    LT_LOG_INFO("----------------------------------------------");
+    LT_LOG_INFO("lt_test_rev_batch()");
+    LT_LOG_INFO("----------------------------------------------");
+
+    // Making the handle accessible to the cleanup function.
+    g_h = h;
+
+    // Not on stack, might be too big for embedded targets
+    static uint8_t stage[LT_SIZE_OF_L3_BUFF] __attribute__((aligned(16)));
+    uint8_t ping_out[64], ping_in[64], r_mem_out[TR01_R_MEM_DATA_SIZE_MAX], r_mem_in[TR01_R_MEM_DATA_SIZE_MAX];
+    uint8_t rnd[32], msg[32], rs[TR01_ECDSA_EDDSA_SIGNATURE_LENGTH], pub_key[TR01_CURVE_P256_PUBKEY_LEN];
+    uint16_t r_mem_read_size = 0;
+    uint32_t mcounter_val = 0;
+    lt_ecc_curve_type_t curve;
+    lt_ecc_key_origin_t origin;
+
+    LT_LOG_INFO("Initializing handle");
+    LT_TEST_ASSERT(LT_OK, lt_init(h));
+
+    LT_LOG_INFO("Starting Secure Session with key %d", (int)TR01_PAIRING_KEY_SLOT_INDEX_0);
+    LT_TEST_ASSERT(LT_OK, lt_verify_chip_and_start_secure_session(h, sh0priv, sh0pub, TR01_PAIRING_KEY_SLOT_INDEX_0));
+    LT_LOG_LINE();
+
+    // Slots and counter have to be reset if fail occurs in the following code.
+    lt_test_cleanup_function = &lt_test_rev_batch_cleanup;
+
+    LT_TEST_ASSERT(LT_OK, lt_random_bytes(h, ping_out, sizeof(ping_out)));
+    LT_TEST_ASSERT(LT_OK, lt_random_bytes(h, r_mem_out, sizeof(r_mem_out)));
+    LT_TEST_ASSERT(LT_OK, lt_random_bytes(h, msg, sizeof(msg)));
+
+    // clang-format off
+    lt_batch_cmd_t cmds[] = {
+        {.id = LT_BATCH_PING, .args.ping = {ping_out, ping_in, sizeof(ping_out)}},
+        {.id = LT_BATCH_R_MEM_DATA_ERASE, .args.r_mem_data_erase = {BATCH_R_MEM_SLOT}},
+        {.id = LT_BATCH_R_MEM_DATA_WRITE, .args.r_mem_data_write = {BATCH_R_MEM_SLOT, r_mem_out, sizeof(r_mem_out)}},
+        {.id = LT_BATCH_R_MEM_DATA_READ,
+         .args.r_mem_data_read = {BATCH_R_MEM_SLOT, r_mem_in, sizeof(r_mem_in), &r_mem_read_size}},
+        {.id = LT_BATCH_RANDOM_VALUE_GET, .args.random_value_get = {rnd, sizeof(rnd)}},
+        {.id = LT_BATCH_MCOUNTER_INIT, .args.mcounter_init = {BATCH_MCOUNTER, BATCH_MCOUNTER_INIT_VAL}},
+        {.id = LT_BATCH_MCOUNTER_UPDATE, .args.mcounter_update = {BATCH_MCOUNTER}},
+        {.id = LT_BATCH_MCOUNTER_GET, .args.mcounter_get = {BATCH_MCOUNTER, &mcounter_val}},
+        {.id = LT_BATCH_ECC_KEY_ERASE, .args.ecc_key_erase = {BATCH_ECC_SLOT}},
+        {.id = LT_BATCH_ECC_KEY_GENERATE, .args.ecc_key_generate = {BATCH_ECC_SLOT, TR01_CURVE_P256}},
+        {.id = LT_BATCH_ECC_KEY_READ,
+         .args.ecc_key_read = {BATCH_ECC_SLOT, pub_key, sizeof(pub_key), &curve, &origin}},
+        {.id = LT_BATCH_ECDSA_SIGN, .args.ecdsa_sign = {BATCH_ECC_SLOT, msg, sizeof(msg), rs}},
+    };
+    // clang-format on
+    const uint16_t cmd_cnt = sizeof(cmds) / sizeof(cmds[0]);
+
+    LT_LOG_INFO("Checking that invalid batches are refused before anything is sent");
+    LT_TEST_ASSERT(LT_PARAM_ERR, lt_batch_run(h, cmds, cmd_cnt, stage, TR01_R_MEM_DATA_SIZE_MAX, false));
+    cmds[10].args.ecc_key_read.slot = TR01_ECC_SLOT_31 + 1;
+    LT_TEST_ASSERT(LT_PARAM_ERR, lt_batch_run(h, cmds, cmd_cnt, stage, sizeof(stage), false));
+    cmds[10].args.ecc_key_read.slot = BATCH_ECC_SLOT;
+    cmds[7].args.mcounter_get.mcounter_index = TR01_MCOUNTER_INDEX_15 + 1;
+    LT_TEST_ASSERT(LT_PARAM_ERR, lt_batch_run(h, cmds, cmd_cnt, stage, sizeof(stage), false));
+    cmds[7].args.mcounter_get.mcounter_index = BATCH_MCOUNTER;
+    cmds[2].args.r_mem_data_write.data_size = TR01_R_MEM_DATA_SIZE_MIN - 1;
+    LT_TEST_ASSERT(LT_PARAM_ERR, lt_batch_run(h, cmds, cmd_cnt, stage, sizeof(stage), false));
+    cmds[2].args.r_mem_data_write.data_size = sizeof(r_mem_out);
+    LT_TEST_ASSERT(LT_PARAM_ERR, lt_batch_run(h, cmds, cmd_cnt, NULL, sizeof(stage), false));
+    LT_TEST_ASSERT(LT_OK, lt_ping(h, ping_out, ping_in, sizeof(ping_out)));
+    LT_LOG_LINE();
+
+    LT_LOG_INFO("Executing batch of %" PRIu16 " commands", cmd_cnt);
+    LT_TEST_ASSERT(LT_OK, lt_batch_run(h, cmds, cmd_cnt, stage, sizeof(stage), false));
+    for (uint16_t i = 0; i < cmd_cnt; i++) {
+        LT_LOG_INFO("Command %" PRIu16 ": %s", i, lt_ret_verbose(cmds[i].ret));
+        LT_TEST_ASSERT(LT_OK, cmds[i].ret);
+    }
+    LT_TEST_ASSERT(0, memcmp(ping_out, ping_in, sizeof(ping_out)));
+    LT_TEST_ASSERT(sizeof(r_mem_out), r_mem_read_size);
+    LT_TEST_ASSERT(0, memcmp(r_mem_out, r_mem_in, sizeof(r_mem_out)));
+    LT_TEST_ASSERT(BATCH_MCOUNTER_INIT_VAL - 1, mcounter_val);
+    LT_TEST_ASSERT(TR01_CURVE_P256, curve);
+    LT_TEST_ASSERT(TR01_CURVE_GENERATED, origin);
+    LT_LOG_LINE();
+
+    // Ping is already on the chip when the read of the erased slot fails
+    lt_batch_cmd_t fail_cmds[] = {
+        {.id = LT_BATCH_R_MEM_DATA_ERASE, .args.r_mem_data_erase = {BATCH_R_MEM_SLOT}},
+        {.id = LT_BATCH_R_MEM_DATA_READ,
+         .args.r_mem_data_read = {BATCH_R_MEM_SLOT, r_mem_in, sizeof(r_mem_in), &r_mem_read_size}},
+        {.id = LT_BATCH_PING, .args.ping = {ping_out, ping_in, sizeof(ping_out)}},
+        {.id = LT_BATCH_PING, .args.ping = {ping_out, ping_in, sizeof(ping_out)}},
+    };
+    const uint16_t fail_cnt = sizeof(fail_cmds) / sizeof(fail_cmds[0]);
+
+    LT_LOG_INFO("Executing batch with a failing command, continuing on error");
+    LT_TEST_ASSERT(LT_OK, lt_batch_run(h, fail_cmds, fail_cnt, stage, sizeof(stage), false));
+    LT_TEST_ASSERT(LT_OK, fail_cmds[0].ret);
+    LT_TEST_ASSERT(LT_L3_R_MEM_DATA_READ_SLOT_EMPTY, fail_cmds[1].ret);
+    LT_TEST_ASSERT(LT_OK, fail_cmds[2].ret);
+    LT_TEST_ASSERT(LT_OK, fail_cmds[3].ret);
+
+    LT_LOG_INFO("Executing batch with a failing command, stopping on error");
+    LT_TEST_ASSERT(LT_L3_R_MEM_DATA_READ_SLOT_EMPTY, lt_batch_run(h, fail_cmds, fail_cnt, stage, sizeof(stage), true));
+    LT_TEST_ASSERT(LT_OK, fail_cmds[0].ret);
+    LT_TEST_ASSERT(LT_L3_R_MEM_DATA_READ_SLOT_EMPTY, fail_cmds[1].ret);
+    LT_TEST_ASSERT(LT_OK, fail_cmds[2].ret);
+    LT_TEST_ASSERT(LT_BATCH_NOT_EXECUTED, fail_cmds[3].ret);
+
+    LT_LOG_INFO("Checking that Secure Session is still usable");
+    LT_TEST_ASSERT(LT_OK, lt_ping(h, ping_out, ping_in, sizeof(ping_out)));
+    LT_LOG_LINE();
+
+    // Call cleanup function, but don't call it from LT_TEST_ASSERT anymore.
+    lt_test_cleanup_function = NULL;
+    LT_LOG_INFO("Starting post-test cleanup");
+    LT_TEST_ASSERT(LT_OK, lt_test_rev_batch_cleanup());
+    LT_LOG_INFO("Post-test cleanup was successful");
+}
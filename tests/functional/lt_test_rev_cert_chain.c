@@ -0,0 +1,259 @@
+/**
+ * @file lt_test_rev_cert_chain.c
+ * @brief Tests certificate chain verification.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <inttypes.h>
+
+#include "libtropic.h"
+#include "libtropic_cert.h"
+#include "libtropic_common.h"
+#include "libtropic_functional_tests.h"
+#include "libtropic_logging.h"
+#include "string.h"
+
+/** @brief Time within the validity of the test chain. */
+#define CERT_CHAIN_NOW "20300101000000Z"
+/** @brief Time before the validity of the test chain. */
+#define CERT_CHAIN_PAST "20200101000000Z"
+
+// Test chain in the layout of the Certificate Store, with algorithms supported by the crypto HAL:
+//  - root and TROPIC01 certificates have P-256 keys and are signed with ecdsa-with-SHA256,
+//  - XXXX certificate has an Ed25519 key and is signed with ecdsa-with-SHA256,
+//  - device certificate has a X25519 key and is signed with Ed25519.
+static const uint8_t chain_device[214] = {
+    0x30, 0x81, 0xd3, 0x30, 0x81, 0x86, 0x02, 0x01, 0x04, 0x30, 0x05, 0x06, 0x03, 0x2b, 0x65, 0x70,
+    0x30, 0x14, 0x31, 0x12, 0x30, 0x10, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x09, 0x54, 0x65, 0x73,
+    0x74, 0x20, 0x58, 0x58, 0x58, 0x58, 0x30, 0x20, 0x17, 0x0d, 0x32, 0x36, 0x31, 0x30, 0x31, 0x38,
+    0x31, 0x32, 0x34, 0x31, 0x33, 0x32, 0x5a, 0x18, 0x0f, 0x32, 0x31, 0x32, 0x36, 0x30, 0x39, 0x32,
+    0x34, 0x31, 0x32, 0x34, 0x31, 0x33, 0x32, 0x5a, 0x30, 0x16, 0x31, 0x14, 0x30, 0x12, 0x06, 0x03,
+    0x55, 0x04, 0x03, 0x0c, 0x0b, 0x54, 0x65, 0x73, 0x74, 0x20, 0x44, 0x65, 0x76, 0x69, 0x63, 0x65,
+    0x30, 0x2a, 0x30, 0x05, 0x06, 0x03, 0x2b, 0x65, 0x6e, 0x03, 0x21, 0x00, 0x1b, 0x72, 0x50, 0x58,
+    0x9b, 0x66, 0x2d, 0xfa, 0x72, 0x5b, 0x62, 0x9f, 0x61, 0x77, 0xf4, 0x8a, 0x07, 0xb4, 0xa6, 0x72,
+    0x5c, 0x09, 0xfc, 0x0c, 0xfd, 0xab, 0xd2, 0x75, 0x10, 0xfa, 0x65, 0x14, 0x30, 0x05, 0x06, 0x03,
+    0x2b, 0x65, 0x70, 0x03, 0x41, 0x00, 0x44, 0x95, 0xf7, 0x71, 0x79, 0xef, 0xf6, 0x39, 0xbd, 0xac,
+    0xba, 0x82, 0x03, 0xba, 0x79, 0xf8, 0x79, 0x88, 0x2b, 0x58, 0xcd, 0x54, 0x55, 0xfb, 0xd1, 0x9c,
+    0xb9, 0xab, 0xca, 0xf1, 0x72, 0x12, 0x8e, 0xa1, 0xcd, 0x95, 0x3a, 0x01, 0x77, 0xf2, 0xdc, 0x76,
+    0xbb, 0x66, 0xfa, 0x80, 0xf6, 0xfd, 0xde, 0x0f, 0xe8, 0x8c, 0x60, 0x08, 0x22, 0xd6, 0x70, 0xea,
+    0xd4, 0x59, 0x5b, 0xe9, 0x23, 0x0d,
+};
+static const uint8_t chain_xxxx[227] = {
+    0x30, 0x81, 0xe0, 0x30, 0x81, 0x87, 0x02, 0x01, 0x03, 0x30, 0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48,
+    0xce, 0x3d, 0x04, 0x03, 0x02, 0x30, 0x12, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x03,
+    0x0c, 0x07, 0x54, 0x65, 0x73, 0x74, 0x20, 0x43, 0x41, 0x30, 0x20, 0x17, 0x0d, 0x32, 0x36, 0x31,
+    0x30, 0x31, 0x38, 0x31, 0x32, 0x34, 0x31, 0x33, 0x32, 0x5a, 0x18, 0x0f, 0x32, 0x31, 0x32, 0x36,
+    0x30, 0x39, 0x32, 0x34, 0x31, 0x32, 0x34, 0x31, 0x33, 0x32, 0x5a, 0x30, 0x14, 0x31, 0x12, 0x30,
+    0x10, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x09, 0x54, 0x65, 0x73, 0x74, 0x20, 0x58, 0x58, 0x58,
+    0x58, 0x30, 0x2a, 0x30, 0x05, 0x06, 0x03, 0x2b, 0x65, 0x70, 0x03, 0x21, 0x00, 0x57, 0x9b, 0x70,
+    0xe6, 0xf5, 0x90, 0x6c, 0x5c, 0xac, 0x63, 0xc0, 0x04, 0x94, 0x60, 0xd3, 0x10, 0x9b, 0xdb, 0xd0,
+    0x04, 0x77, 0xe5, 0xe3, 0xfe, 0x28, 0x19, 0x43, 0x38, 0x68, 0xbd, 0xb8, 0xa3, 0x30, 0x0a, 0x06,
+    0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x02, 0x03, 0x48, 0x00, 0x30, 0x45, 0x02, 0x21,
+    0x00, 0xf6, 0xff, 0xea, 0xb1, 0xfc, 0x3f, 0x1d, 0x90, 0x1b, 0x30, 0xe4, 0xed, 0x4a, 0xbf, 0x63,
+    0xfa, 0x49, 0xa4, 0x43, 0x3f, 0xa0, 0x0c, 0x36, 0x47, 0x7b, 0x5f, 0x0f, 0x43, 0x7d, 0xc7, 0xbc,
+    0x3f, 0x02, 0x20, 0x4e, 0x90, 0x2b, 0x97, 0x78, 0xe5, 0x9b, 0x2a, 0xc2, 0x73, 0xac, 0x1d, 0x02,
+    0x07, 0xf4, 0x61, 0x6c, 0xbc, 0x83, 0x97, 0xa9, 0x93, 0xd9, 0x5f, 0xe5, 0xe7, 0x51, 0xe4, 0x4e,
+    0x0c, 0xd9, 0x96,
+};
+static const uint8_t chain_tropic01[274] = {
+    0x30, 0x82, 0x01, 0x0e, 0x30, 0x81, 0xb6, 0x02, 0x01, 0x02, 0x30, 0x0a, 0x06, 0x08, 0x2a, 0x86,
+    0x48, 0xce, 0x3d, 0x04, 0x03, 0x02, 0x30, 0x14, 0x31, 0x12, 0x30, 0x10, 0x06, 0x03, 0x55, 0x04,
+    0x03, 0x0c, 0x09, 0x54, 0x65, 0x73, 0x74, 0x20, 0x52, 0x6f, 0x6f, 0x74, 0x30, 0x20, 0x17, 0x0d,
+    0x32, 0x36, 0x31, 0x30, 0x31, 0x38, 0x31, 0x32, 0x34, 0x31, 0x33, 0x32, 0x5a, 0x18, 0x0f, 0x32,
+    0x31, 0x32, 0x36, 0x30, 0x39, 0x32, 0x34, 0x31, 0x32, 0x34, 0x31, 0x33, 0x32, 0x5a, 0x30, 0x12,
+    0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x07, 0x54, 0x65, 0x73, 0x74, 0x20,
+    0x43, 0x41, 0x30, 0x59, 0x30, 0x13, 0x06, 0x07, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x02, 0x01, 0x06,
+    0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x03, 0x01, 0x07, 0x03, 0x42, 0x00, 0x04, 0xbd, 0x7c, 0xc0,
+    0x24, 0x24, 0xa1, 0x3e, 0x9e, 0x9f, 0xb3, 0x11, 0x16, 0x18, 0x59, 0xa1, 0x6e, 0x3b, 0x95, 0x0c,
+    0x59, 0xca, 0xa0, 0xb2, 0xe0, 0xd3, 0x5c, 0x20, 0x4f, 0xe9, 0x6a, 0xeb, 0x63, 0x48, 0xed, 0xa1,
+    0x66, 0x64, 0x26, 0x0f, 0x6d, 0xa0, 0x59, 0xf0, 0xe0, 0xe2, 0xf1, 0xa1, 0x91, 0xb0, 0xd7, 0xc1,
+    0x32, 0x78, 0xd3, 0xaf, 0x14, 0x16, 0x94, 0xe4, 0xbb, 0x60, 0x3c, 0x04, 0xaf, 0x30, 0x0a, 0x06,
+    0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x02, 0x03, 0x47, 0x00, 0x30, 0x44, 0x02, 0x20,
+    0x23, 0xe6, 0xcf, 0x6f, 0xcd, 0x03, 0x32, 0x27, 0x12, 0x63, 0xc5, 0x96, 0x16, 0x6f, 0xfa, 0x0f,
+    0x54, 0x80, 0x49, 0x99, 0x14, 0x09, 0x6a, 0xe2, 0xb4, 0xd7, 0x15, 0x62, 0xf0, 0xaa, 0x8e, 0x7b,
+    0x02, 0x20, 0x47, 0x67, 0x30, 0x69, 0x0e, 0xcf, 0x34, 0x63, 0x43, 0x71, 0x3c, 0xe4, 0x24, 0x94,
+    0x13, 0xc8, 0xc7, 0x85, 0xe1, 0xd2, 0x04, 0x5c, 0xe3, 0xc3, 0x3f, 0xfc, 0xc8, 0x03, 0x6a, 0x64,
+    0xd5, 0x11,
+};
+static const uint8_t chain_root[276] = {
+    0x30, 0x82, 0x01, 0x10, 0x30, 0x81, 0xb8, 0x02, 0x01, 0x01, 0x30, 0x0a, 0x06, 0x08, 0x2a, 0x86,
+    0x48, 0xce, 0x3d, 0x04, 0x03, 0x02, 0x30, 0x14, 0x31, 0x12, 0x30, 0x10, 0x06, 0x03, 0x55, 0x04,
+    0x03, 0x0c, 0x09, 0x54, 0x65, 0x73, 0x74, 0x20, 0x52, 0x6f, 0x6f, 0x74, 0x30, 0x20, 0x17, 0x0d,
+    0x32, 0x36, 0x31, 0x30, 0x31, 0x38, 0x31, 0x32, 0x34, 0x31, 0x33, 0x32, 0x5a, 0x18, 0x0f, 0x32,
+    0x31, 0x32, 0x36, 0x30, 0x39, 0x32, 0x34, 0x31, 0x32, 0x34, 0x31, 0x33, 0x32, 0x5a, 0x30, 0x14,
+    0x31, 0x12, 0x30, 0x10, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x09, 0x54, 0x65, 0x73, 0x74, 0x20,
+    0x52, 0x6f, 0x6f, 0x74, 0x30, 0x59, 0x30, 0x13, 0x06, 0x07, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x02,
+    0x01, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x03, 0x01, 0x07, 0x03, 0x42, 0x00, 0x04, 0x4d,
+    0x61, 0x9d, 0x3c, 0x00, 0xf4, 0x71, 0xb2, 0x3d, 0xca, 0xa4, 0xd5, 0x15, 0xfd, 0x72, 0x6a, 0x41,
+    0xfa, 0x43, 0x84, 0xbc, 0x87, 0x86, 0x48, 0x7c, 0xef, 0x3b, 0xc1, 0x67, 0xb1, 0xa3, 0xd3, 0x87,
+    0x2c, 0xf5, 0x64, 0x3b, 0x74, 0x8b, 0x5f, 0xdf, 0x60, 0x52, 0xe5, 0xfd, 0x71, 0x99, 0x9c, 0x75,
+    0x88, 0x39, 0x28, 0x09, 0x45, 0xe6, 0x68, 0xd0, 0x89, 0x3e, 0x64, 0x2b, 0x07, 0x27, 0x67, 0x30,
+    0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x02, 0x03, 0x47, 0x00, 0x30, 0x44,
+    0x02, 0x20, 0x74, 0x24, 0x2d, 0x12, 0xe2, 0x47, 0xf1, 0x0e, 0xa7, 0x8f, 0x5c, 0x57, 0x2a, 0xdf,
+    0x0e, 0xfd, 0xff, 0x12, 0xd4, 0xa2, 0xe4, 0xed, 0x02, 0x86, 0xf0, 0x61, 0xed, 0x94, 0x27, 0x41,
+    0x7f, 0xf6, 0x02, 0x20, 0x53, 0x37, 0xbd, 0xeb, 0xc3, 0xba, 0x58, 0x2a, 0x44, 0x02, 0x24, 0x88,
+    0x9c, 0xca, 0x2a, 0x59, 0xef, 0x6e, 0x0f, 0x4c, 0xb7, 0x7c, 0x5d, 0x4a, 0xb6, 0xe7, 0x50, 0x5c,
+    0xe2, 0xa5, 0x57, 0x6b,
+};
+
+/** @brief OBJECT IDENTIFIER ecdsa-with-SHA256 (1.2.840.10045.4.3.2) including its tag and length. */
+static const uint8_t oid_ecdsa_sha256[] = {0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x02};
+
+// Shared with cleanup function
+static lt_handle_t *g_h;
+
+/** @brief Number of signatures passed to lt_test_rev_cert_chain_verify_sig(). */
+static int sig_cb_calls;
+
+/**
+ * @brief Stands in for a verifier of the algorithms without support in the crypto HAL (P-384 and P-521 keys of the
+ * chip's chain). Accepts every signature, so only counts the calls.
+ */
+static lt_ret_t lt_test_rev_cert_chain_verify_sig(void *ctx, const lt_cert_signed_t *cert)
+{
+    (void)ctx;
+    if (!cert->issuer_spki_len || !cert->sig_alg_len || !cert->tbs_len || !cert->sig_len) {
+        return LT_CERT_CHAIN_INVALID;
+    }
+    sig_cb_calls++;
+
+    return LT_OK;
+}
+
+static lt_ret_t lt_test_rev_cert_chain_cleanup(void)
+{
+    lt_ret_t ret;
+
+    LT_LOG_INFO("Aborting secure session");
+    ret = lt_session_abort(g_h);
+    if (LT_OK != ret) {
+        LT_LOG_ERROR("Failed to abort secure session.");
+        return ret;
+    }
+
+    LT_LOG_INFO("Deinitializing handle");
+    ret = lt_deinit(g_h);
+    if (LT_OK != ret) {
+        LT_LOG_ERROR("Failed to deinitialize handle.");
+        return ret;
+    }
+
+    return LT_OK;
+}
+
+void lt_test_rev_cert_chain(lt_handle_t *h)
+{
+    LT_LOG_INFO("----------------------------------------------");
+    LT_LOG_INFO("lt_test_rev_cert_chain()");
+    LT_LOG_INFO("----------------------------------------------");
+
+    // Making the handle accessible to the cleanup function.
+    g_h = h;
+
+    static uint8_t certs[LT_NUM_CERTIFICATES][TR01_L2_GET_INFO_REQ_CERT_SIZE_SINGLE];
+    static uint8_t anchor[TR01_L2_GET_INFO_REQ_CERT_SIZE_SINGLE];
+    static lt_cert_chain_cache_t cache;
+    struct lt_cert_store_t store = {.certs = {certs[0], certs[1], certs[2], certs[3]},
+                                    .buf_len = {sizeof(certs[0]), sizeof(certs[1]), sizeof(certs[2]),
+                                                sizeof(certs[3])}};
+    const uint8_t *test_chain[LT_NUM_CERTIFICATES] = {chain_device, chain_xxxx, chain_tropic01, chain_root};
+    const uint16_t test_chain_len[LT_NUM_CERTIFICATES]
+        = {sizeof(chain_device), sizeof(chain_xxxx), sizeof(chain_tropic01), sizeof(chain_root)};
+    lt_cert_verify_cfg_t cfg = {.anchor = chain_root, .anchor_len = sizeof(chain_root), .now = CERT_CHAIN_NOW};
+
+    memset(&cache, 0, sizeof(cache));
+    for (int i = 0; i < LT_NUM_CERTIFICATES; i++) {
+        memcpy(certs[i], test_chain[i], test_chain_len[i]);
+        store.cert_len[i] = test_chain_len[i];
+    }
+
+    LT_LOG_INFO("Verifying test chain without cache");
+    LT_TEST_ASSERT(LT_OK, lt_cert_verify_chain(&store, &cfg));
+
+    LT_LOG_INFO("Verifying test chain twice with cache, second verification has to hit");
+    cfg.cache = &cache;
+    LT_TEST_ASSERT(LT_OK, lt_cert_verify_chain(&store, &cfg));
+    LT_TEST_ASSERT(LT_OK, lt_cert_verify_chain(&store, &cfg));
+    LT_TEST_ASSERT(1, (cache.misses == 1) && (cache.hits == 1));
+
+    LT_LOG_INFO("Verifying test chain outside of its validity (checked also on cache hit)");
+    cfg.now = CERT_CHAIN_PAST;
+    LT_TEST_ASSERT(LT_CERT_CHAIN_INVALID, lt_cert_verify_chain(&store, &cfg));
+    cfg.now = CERT_CHAIN_NOW;
+
+    LT_LOG_INFO("Verifying test chain against a different anchor");
+    cfg.anchor = chain_tropic01;
+    cfg.anchor_len = sizeof(chain_tropic01);
+    LT_TEST_ASSERT(LT_CERT_CHAIN_INVALID, lt_cert_verify_chain(&store, &cfg));
+    cfg.anchor = chain_root;
+    cfg.anchor_len = sizeof(chain_root);
+
+    LT_LOG_INFO("Verifying test chain with a corrupted signature of each certificate");
+    for (int i = 0; i < LT_NUM_CERTIFICATES - 1; i++) {
+        certs[i][store.cert_len[i] - 1] ^= 0x01;
+        LT_TEST_ASSERT(LT_CERT_CHAIN_INVALID, lt_cert_verify_chain(&store, &cfg));
+        certs[i][store.cert_len[i] - 1] ^= 0x01;
+    }
+    LT_TEST_ASSERT(1, (cache.misses == 1 + LT_NUM_CERTIFICATES - 1));
+
+    LT_LOG_INFO("Verifying test chain with signatureAlgorithm differing from the signed one");
+    // Outer signatureAlgorithm of the ecdsa-with-SHA256 certificate is the last occurrence of the OID. It is not
+    // signed, so changed to ecdsa-with-SHA384 it would go to the callback, which accepts every signature.
+    uint8_t *sig_alg = NULL;
+    for (uint16_t j = 0; j + sizeof(oid_ecdsa_sha256) <= store.cert_len[1]; j++) {
+        if (!memcmp(&certs[1][j], oid_ecdsa_sha256, sizeof(oid_ecdsa_sha256))) {
+            sig_alg = &certs[1][j];
+        }
+    }
+    LT_TEST_ASSERT(1, (sig_alg != NULL));
+    sig_alg[sizeof(oid_ecdsa_sha256) - 1] = 0x03;
+    cfg.verify_sig = lt_test_rev_cert_chain_verify_sig;
+    const int sig_cb_calls_before = sig_cb_calls;
+    LT_TEST_ASSERT(LT_CERT_CHAIN_INVALID, lt_cert_verify_chain(&store, &cfg));
+    LT_TEST_ASSERT(1, (sig_cb_calls == sig_cb_calls_before));
+    sig_alg[sizeof(oid_ecdsa_sha256) - 1] = 0x02;
+    cfg.verify_sig = NULL;
+    LT_TEST_ASSERT(LT_OK, lt_cert_verify_chain(&store, &cfg));
+    LT_LOG_LINE();
+
+    LT_LOG_INFO("Initializing handle");
+    LT_TEST_ASSERT(LT_OK, lt_init(h));
+
+    LT_LOG_INFO("Reading Certificate Store");
+    for (int i = 0; i < LT_NUM_CERTIFICATES; i++) {
+        store.cert_len[i] = 0;
+    }
+    LT_TEST_ASSERT(LT_OK, lt_get_info_cert_store(h, &store));
+    memcpy(anchor, certs[LT_CERT_KIND_TROPIC_ROOT], store.cert_len[LT_CERT_KIND_TROPIC_ROOT]);
+
+    memset(&cache, 0, sizeof(cache));
+    cfg = (lt_cert_verify_cfg_t){.anchor = anchor,
+                                 .anchor_len = store.cert_len[LT_CERT_KIND_TROPIC_ROOT],
+                                 .verify_sig = lt_test_rev_cert_chain_verify_sig,
+                                 .cache = &cache};
+
+    LT_LOG_INFO("Verifying chip's chain, signatures without support in the crypto HAL go to the callback");
+    LT_TEST_ASSERT(LT_OK, lt_cert_verify_chain(&store, &cfg));
+    LT_TEST_ASSERT(1, (cache.misses == 1));
+    const int sig_cb_calls_first = sig_cb_calls;
+
+    LT_LOG_INFO("Starting Secure Session with key %d and verified chain", (int)TR01_PAIRING_KEY_SLOT_INDEX_0);
+    LT_TEST_ASSERT(LT_OK, lt_cert_verify_chip_and_start_secure_session(h, &cfg, sh0priv, sh0pub,
+                                                                       TR01_PAIRING_KEY_SLOT_INDEX_0));
+    lt_test_cleanup_function = &lt_test_rev_cert_chain_cleanup;
+    LT_TEST_ASSERT(1, (cache.hits == 1) && (sig_cb_calls == sig_cb_calls_first));
+
+    LT_LOG_INFO("Pinging TROPIC01 in the Secure Session");
+    uint8_t ping_out[] = "cert chain", ping_in[sizeof(ping_out)];
+    LT_TEST_ASSERT(LT_OK, lt_ping(h, ping_out, ping_in, sizeof(ping_out)));
+    LT_TEST_ASSERT(0, memcmp(ping_out, ping_in, sizeof(ping_out)));
+    LT_LOG_LINE();
+
+    // Call cleanup function, but don't call it from LT_TEST_ASSERT anymore.
+    lt_test_cleanup_function = NULL;
+    LT_LOG_INFO("Starting post-test cleanup");
+    LT_TEST_ASSERT(LT_OK, lt_test_rev_cert_chain_cleanup());
+    LT_LOG_INFO("Post-test cleanup was successful");
+}
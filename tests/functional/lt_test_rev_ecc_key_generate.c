@@ -161,6 +161,53 @@ void lt_test_rev_ecc_key_generate(lt_handle_t *h)
     }
     LT_LOG_LINE();
 
+#if LT_ECC_KEY_CACHE
+    lt_ecc_key_cache_entry_t *cache_entry = &h->ecc_key_cache.slots[TR01_ECC_SLOT_0];
+    uint8_t chip_pub_key[TR01_CURVE_P256_PUBKEY_LEN];
+    const uint8_t priv_key[TR01_CURVE_PRIVKEY_LEN] = {0x01};
+
+    LT_LOG_INFO("Testing ECC public key cache on slot #%d...", (int)TR01_ECC_SLOT_0);
+    LT_TEST_ASSERT(LT_OK, lt_ecc_key_generate(h, TR01_ECC_SLOT_0, TR01_CURVE_P256));
+    LT_TEST_ASSERT(0, cache_entry->valid);
+    LT_TEST_ASSERT(LT_OK, lt_ecc_key_read(h, TR01_ECC_SLOT_0, chip_pub_key, sizeof(chip_pub_key), &curve, &origin));
+    LT_TEST_ASSERT(1, cache_entry->valid);
+
+    LT_LOG_INFO("Reading the key again, it has to be served from the cache...");
+    // Only a cache hit can return the modified key
+    cache_entry->pub_key[0] ^= 0xff;
+    LT_TEST_ASSERT(LT_OK, lt_ecc_key_read(h, TR01_ECC_SLOT_0, read_pub_key, sizeof(read_pub_key), &curve, &origin));
+    LT_TEST_ASSERT(1, (read_pub_key[0] != chip_pub_key[0]));
+    LT_TEST_ASSERT(1, (curve == TR01_CURVE_P256));
+    LT_TEST_ASSERT(1, (origin == TR01_CURVE_GENERATED));
+
+    LT_LOG_INFO("Invalidating the cache, the key has to be read from TROPIC01...");
+    LT_TEST_ASSERT(LT_OK, lt_ecc_key_cache_invalidate(h));
+    LT_TEST_ASSERT(0, cache_entry->valid);
+    LT_TEST_ASSERT(LT_OK, lt_ecc_key_read(h, TR01_ECC_SLOT_0, read_pub_key, sizeof(read_pub_key), &curve, &origin));
+    LT_TEST_ASSERT(0, memcmp(read_pub_key, chip_pub_key, sizeof(chip_pub_key)));
+    LT_TEST_ASSERT(1, cache_entry->valid);
+
+    LT_LOG_INFO("Generating into the occupied slot (should fail), the cached key has to be invalidated...");
+    LT_TEST_ASSERT(LT_L3_FAIL, lt_ecc_key_generate(h, TR01_ECC_SLOT_0, TR01_CURVE_P256));
+    LT_TEST_ASSERT(0, cache_entry->valid);
+    LT_TEST_ASSERT(LT_OK, lt_ecc_key_read(h, TR01_ECC_SLOT_0, read_pub_key, sizeof(read_pub_key), &curve, &origin));
+    LT_TEST_ASSERT(1, cache_entry->valid);
+
+    LT_LOG_INFO("Storing into the occupied slot (should fail), the cached key has to be invalidated...");
+    LT_TEST_ASSERT(LT_L3_FAIL, lt_ecc_key_store(h, TR01_ECC_SLOT_0, TR01_CURVE_ED25519, priv_key));
+    LT_TEST_ASSERT(0, cache_entry->valid);
+    LT_TEST_ASSERT(LT_OK, lt_ecc_key_read(h, TR01_ECC_SLOT_0, read_pub_key, sizeof(read_pub_key), &curve, &origin));
+    LT_TEST_ASSERT(1, cache_entry->valid);
+
+    LT_LOG_INFO("Erasing the slot, the cached key has to be invalidated...");
+    LT_TEST_ASSERT(LT_OK, lt_ecc_key_erase(h, TR01_ECC_SLOT_0));
+    LT_TEST_ASSERT(0, cache_entry->valid);
+    LT_TEST_ASSERT(LT_L3_ECC_INVALID_KEY,
+                   lt_ecc_key_read(h, TR01_ECC_SLOT_0, read_pub_key, sizeof(read_pub_key), &curve, &origin));
+    LT_TEST_ASSERT(0, cache_entry->valid);
+    LT_LOG_LINE();
+#endif
+
     // Cleanup not needed anymore
     lt_test_cleanup_function = NULL;
 
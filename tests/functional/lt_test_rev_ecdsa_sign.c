@@ -14,6 +14,7 @@
 #include "libtropic_logging.h"
 #include "lt_l3_api_structs.h"
 #include "lt_random.h"
+#include "lt_sha256.h"
 #include "string.h"
 
 #define MSG_TO_SIGN_LEN_MAX 4096
@@ -88,7 +89,8 @@ void lt_test_rev_ecdsa_sign(lt_handle_t *h)
     g_h = h;
 
     uint8_t read_pub_key[TR01_CURVE_P256_PUBKEY_LEN], msg_to_sign[MSG_TO_SIGN_LEN_MAX],
-        rs[TR01_ECDSA_EDDSA_SIGNATURE_LENGTH];
+        rs[TR01_ECDSA_EDDSA_SIGNATURE_LENGTH], msg_hash[TR01_ECDSA_SIGN_HASH_LEN];
+    struct lt_crypto_sha256_ctx_t hctx;
     lt_ecc_curve_type_t curve;
     lt_ecc_key_origin_t origin;
     uint32_t msg_to_sign_len;
@@ -164,6 +166,16 @@ void lt_test_rev_ecdsa_sign(lt_handle_t *h)
         LT_LOG_INFO("Verifying signature...");
         LT_TEST_ASSERT(LT_OK, lt_ecc_ecdsa_sig_verify(msg_to_sign, msg_to_sign_len, read_pub_key, rs));
 
+        LT_LOG_INFO("Signing hash of the message...");
+        lt_sha256_init(&hctx);
+        lt_sha256_start(&hctx);
+        lt_sha256_update(&hctx, msg_to_sign, msg_to_sign_len);
+        lt_sha256_finish(&hctx, msg_hash);
+        LT_TEST_ASSERT(LT_OK, lt_ecc_ecdsa_sign_hash(h, i, msg_hash, rs));
+
+        LT_LOG_INFO("Verifying signature...");
+        LT_TEST_ASSERT(LT_OK, lt_ecc_ecdsa_sig_verify(msg_to_sign, msg_to_sign_len, read_pub_key, rs));
+
         LT_LOG_INFO("Erasing the slot...");
         LT_TEST_ASSERT(LT_OK, lt_ecc_key_erase(h, i));
 
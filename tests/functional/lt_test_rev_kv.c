@@ -0,0 +1,182 @@
+/**
+ * @file lt_test_rev_kv.c
+ * @brief Tests key-value store over R memory.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <inttypes.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_functional_tests.h"
+#include "libtropic_kv.h"
+#include "libtropic_logging.h"
+#include "string.h"
+
+/** @brief First R memory slot used by the test store. */
+#define KV_FIRST_SLOT 0
+/** @brief Number of R memory slots used by the test store. */
+#define KV_SLOT_CNT 16
+/** @brief Length of the multi-slot value (needs 4 slots). */
+#define KV_LONG_VALUE_LEN 1500
+/** @brief Number of updates done to force the store to wrap around and compact. */
+#define KV_UPDATE_LOOPS 20
+
+// Shared with cleanup function
+static lt_handle_t *g_h;
+
+static lt_ret_t lt_test_rev_kv_cleanup(void)
+{
+    lt_ret_t ret;
+
+    LT_LOG_INFO("Erasing slots %d - %d", KV_FIRST_SLOT, KV_FIRST_SLOT + KV_SLOT_CNT - 1);
+    ret = lt_r_mem_data_erase_range(g_h, KV_FIRST_SLOT, KV_SLOT_CNT, NULL);
+    if (LT_OK != ret) {
+        LT_LOG_ERROR("Failed to erase slots.");
+        return ret;
+    }
+
+    LT_LOG_INFO("Aborting secure session");
+    ret = lt_session_abort(g_h);
+    if (LT_OK != ret) {
+        LT_LOG_ERROR("Failed to abort secure session.");
+        return ret;
+    }
+
+    LT_LOG_INFO("Deinitializing handle");
+    ret = lt_deinit(g_h);
+    if (LT_OK != ret) {
+        LT_LOG_ERROR("Failed to deinitialize handle.");
+        return ret;
+    }
+
+    return LT_OK;
+}
+
+void lt_test_rev_kv(lt_handle_t *h)
+{
+    LT_LOG_INFO("----------------------------------------------");
+    LT_LOG_INFO("lt_test_rev_kv()");
+    LT_LOG_INFO("----------------------------------------------");
+
+    // Making the handle accessible to the cleanup function.
+    g_h = h;
+
+    static lt_kv_t kv;
+    static uint8_t cred_prev[KV_LONG_VALUE_LEN];
+    const uint8_t key_policy[] = "policy", key_cred[] = "cred";
+    uint8_t policy[32], cred[KV_LONG_VALUE_LEN], read_value[KV_LONG_VALUE_LEN];
+    uint16_t read_value_len, stale_cnt;
+
+    LT_LOG_INFO("Initializing handle");
+    LT_TEST_ASSERT(LT_OK, lt_init(h));
+
+    LT_LOG_INFO("Starting Secure Session with key %d", (int)TR01_PAIRING_KEY_SLOT_INDEX_0);
+    LT_TEST_ASSERT(LT_OK, lt_verify_chip_and_start_secure_session(h, sh0priv, sh0pub, TR01_PAIRING_KEY_SLOT_INDEX_0));
+    LT_LOG_LINE();
+
+    // Slots have to be erased if fail occurs in the following code.
+    lt_test_cleanup_function = &lt_test_rev_kv_cleanup;
+
+    LT_LOG_INFO("Erasing slots %d - %d", KV_FIRST_SLOT, KV_FIRST_SLOT + KV_SLOT_CNT - 1);
+    LT_TEST_ASSERT(LT_OK, lt_r_mem_data_erase_range(h, KV_FIRST_SLOT, KV_SLOT_CNT, NULL));
+
+    LT_LOG_INFO("Opening empty store");
+    LT_TEST_ASSERT(LT_OK, lt_kv_open(&kv, h, KV_FIRST_SLOT, KV_SLOT_CNT));
+
+    LT_LOG_INFO("Reading a key from the empty store (should fail)");
+    LT_TEST_ASSERT(LT_KV_KEY_NOT_FOUND,
+                   lt_kv_get(&kv, key_cred, sizeof(key_cred), read_value, sizeof(read_value), &read_value_len));
+    LT_LOG_LINE();
+
+    LT_LOG_INFO("Storing %d B value and %d B value", (int)sizeof(policy), KV_LONG_VALUE_LEN);
+    LT_TEST_ASSERT(LT_OK, lt_random_fill(h, policy, sizeof(policy)));
+    LT_TEST_ASSERT(LT_OK, lt_random_fill(h, cred, sizeof(cred)));
+    LT_TEST_ASSERT(LT_OK, lt_kv_put(&kv, key_policy, sizeof(key_policy), policy, sizeof(policy)));
+    LT_TEST_ASSERT(LT_OK, lt_kv_put(&kv, key_cred, sizeof(key_cred), cred, sizeof(cred)));
+
+    LT_LOG_INFO("Reading both values back and checking contents");
+    LT_TEST_ASSERT(LT_OK,
+                   lt_kv_get(&kv, key_policy, sizeof(key_policy), read_value, sizeof(read_value), &read_value_len));
+    LT_TEST_ASSERT(1, (read_value_len == sizeof(policy)));
+    LT_TEST_ASSERT(0, memcmp(read_value, policy, sizeof(policy)));
+    LT_TEST_ASSERT(LT_OK, lt_kv_get(&kv, key_cred, sizeof(key_cred), read_value, sizeof(read_value), &read_value_len));
+    LT_TEST_ASSERT(1, (read_value_len == sizeof(cred)));
+    LT_TEST_ASSERT(0, memcmp(read_value, cred, sizeof(cred)));
+    LT_LOG_LINE();
+
+    LT_LOG_INFO("Updating the short value");
+    LT_TEST_ASSERT(LT_OK, lt_random_fill(h, policy, sizeof(policy)));
+    LT_TEST_ASSERT(LT_OK, lt_kv_put(&kv, key_policy, sizeof(key_policy), policy, sizeof(policy)));
+
+    LT_LOG_INFO("Reopening the store and checking both values");
+    LT_TEST_ASSERT(LT_OK, lt_kv_open(&kv, h, KV_FIRST_SLOT, KV_SLOT_CNT));
+    LT_TEST_ASSERT(LT_OK,
+                   lt_kv_get(&kv, key_policy, sizeof(key_policy), read_value, sizeof(read_value), &read_value_len));
+    LT_TEST_ASSERT(1, (read_value_len == sizeof(policy)));
+    LT_TEST_ASSERT(0, memcmp(read_value, policy, sizeof(policy)));
+    LT_TEST_ASSERT(LT_OK, lt_kv_get(&kv, key_cred, sizeof(key_cred), read_value, sizeof(read_value), &read_value_len));
+    LT_TEST_ASSERT(1, (read_value_len == sizeof(cred)));
+    LT_TEST_ASSERT(0, memcmp(read_value, cred, sizeof(cred)));
+
+    LT_LOG_INFO("Compacting one slot (one stale slot should be left)");
+    LT_TEST_ASSERT(LT_OK, lt_kv_compact(&kv, 0, &stale_cnt));
+    LT_TEST_ASSERT(1, (stale_cnt == 1));
+    LT_TEST_ASSERT(LT_OK, lt_kv_compact(&kv, 1, &stale_cnt));
+    LT_TEST_ASSERT(1, (stale_cnt == 0));
+    LT_LOG_LINE();
+
+    LT_LOG_INFO("Updating the long value %d times (store has to wrap around and compact)", KV_UPDATE_LOOPS);
+    for (uint16_t i = 0; i < KV_UPDATE_LOOPS; i++) {
+        LT_TEST_ASSERT(LT_OK, lt_random_fill(h, cred, sizeof(cred)));
+        LT_TEST_ASSERT(LT_OK, lt_kv_put(&kv, key_cred, sizeof(key_cred), cred, sizeof(cred)));
+    }
+
+    LT_LOG_INFO("Reopening the store and checking the long value");
+    LT_TEST_ASSERT(LT_OK, lt_kv_open(&kv, h, KV_FIRST_SLOT, KV_SLOT_CNT));
+    LT_TEST_ASSERT(LT_OK, lt_kv_get(&kv, key_cred, sizeof(key_cred), read_value, sizeof(read_value), &read_value_len));
+    LT_TEST_ASSERT(1, (read_value_len == sizeof(cred)));
+    LT_TEST_ASSERT(0, memcmp(read_value, cred, sizeof(cred)));
+    LT_LOG_LINE();
+
+    LT_LOG_INFO("Updating the long value and erasing a continuation slot of the new record");
+    LT_TEST_ASSERT(LT_OK, lt_kv_compact(&kv, KV_SLOT_CNT, NULL));
+    memcpy(cred_prev, cred, sizeof(cred));
+    LT_TEST_ASSERT(LT_OK, lt_random_fill(h, cred, sizeof(cred)));
+    LT_TEST_ASSERT(LT_OK, lt_kv_put(&kv, key_cred, sizeof(key_cred), cred, sizeof(cred)));
+    uint16_t cont_slot = 0;
+    for (uint16_t i = 0; i < LT_KV_ENTRY_CNT_MAX; i++) {
+        if ((kv.entries[i].key_len == sizeof(key_cred)) && !memcmp(kv.entries[i].key, key_cred, sizeof(key_cred))) {
+            cont_slot = kv.entries[i].slots[1];
+        }
+    }
+    LT_TEST_ASSERT(LT_OK, lt_r_mem_data_erase(h, cont_slot));
+
+    LT_LOG_INFO("Reopening the store (the previous long value should be read)");
+    LT_TEST_ASSERT(LT_OK, lt_kv_open(&kv, h, KV_FIRST_SLOT, KV_SLOT_CNT));
+    LT_TEST_ASSERT(LT_OK, lt_kv_get(&kv, key_cred, sizeof(key_cred), read_value, sizeof(read_value), &read_value_len));
+    LT_TEST_ASSERT(1, (read_value_len == sizeof(cred_prev)));
+    LT_TEST_ASSERT(0, memcmp(read_value, cred_prev, sizeof(cred_prev)));
+    memcpy(cred, cred_prev, sizeof(cred));
+    LT_LOG_LINE();
+
+    LT_LOG_INFO("Deleting the short value");
+    LT_TEST_ASSERT(LT_OK, lt_kv_delete(&kv, key_policy, sizeof(key_policy)));
+    LT_TEST_ASSERT(LT_KV_KEY_NOT_FOUND, lt_kv_delete(&kv, key_policy, sizeof(key_policy)));
+
+    LT_LOG_INFO("Reopening the store (deleted key should not reappear)");
+    LT_TEST_ASSERT(LT_OK, lt_kv_open(&kv, h, KV_FIRST_SLOT, KV_SLOT_CNT));
+    LT_TEST_ASSERT(LT_KV_KEY_NOT_FOUND,
+                   lt_kv_get(&kv, key_policy, sizeof(key_policy), read_value, sizeof(read_value), &read_value_len));
+    LT_TEST_ASSERT(LT_OK, lt_kv_get(&kv, key_cred, sizeof(key_cred), read_value, sizeof(read_value), &read_value_len));
+    LT_TEST_ASSERT(0, memcmp(read_value, cred, sizeof(cred)));
+    LT_LOG_LINE();
+
+    // Call cleanup function, but don't call it from LT_TEST_ASSERT anymore.
+    lt_test_cleanup_function = NULL;
+    LT_LOG_INFO("Starting post-test cleanup");
+    LT_TEST_ASSERT(LT_OK, lt_test_rev_kv_cleanup());
+    LT_LOG_INFO("Post-test cleanup was successful");
+}
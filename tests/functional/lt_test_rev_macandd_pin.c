@@ -0,0 +1,136 @@
+/**
+ * @file lt_test_rev_macandd_pin.c
+ * @brief Tests MAC-and-Destroy PIN verification module.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <inttypes.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_functional_tests.h"
+#include "libtropic_logging.h"
+#include "libtropic_macandd.h"
+#include "string.h"
+
+/** @brief R memory slot used for the record. */
+#define MACANDD_PIN_R_MEM_SLOT 0
+/** @brief First MAC-and-Destroy slot used by the test. */
+#define MACANDD_PIN_FIRST_SLOT TR01_MAC_AND_DESTROY_SLOT_0
+/** @brief Number of PIN entry attempts. */
+#define MACANDD_PIN_ROUNDS 5
+
+// Shared with cleanup function
+static lt_handle_t *g_h;
+
+static lt_ret_t lt_test_rev_macandd_pin_cleanup(void)
+{
+    lt_ret_t ret;
+
+    LT_LOG_INFO("Erasing R memory slot %d", MACANDD_PIN_R_MEM_SLOT);
+    ret = lt_r_mem_data_erase(g_h, MACANDD_PIN_R_MEM_SLOT);
+    if (LT_OK != ret) {
+        LT_LOG_ERROR("Failed to erase slot.");
+        return ret;
+    }
+
+    LT_LOG_INFO("Aborting secure session");
+    ret = lt_session_abort(g_h);
+    if (LT_OK != ret) {
+        LT_LOG_ERROR("Failed to abort secure session.");
+        return ret;
+    }
+
+    LT_LOG_INFO("Deinitializing handle");
+    ret = lt_deinit(g_h);
+    if (LT_OK != ret) {
+        LT_LOG_ERROR("Failed to deinitialize handle.");
+        return ret;
+    }
+
+    return LT_OK;
+}
+
+void lt_test_rev_macandd_pin(lt_handle_t *h)
+{
+    LT_LOG_INFO("----------------------------------------------");
+    LT_LOG_INFO("lt_test_rev_macandd_pin()");
+    LT_LOG_INFO("----------------------------------------------");
+
+    // Making the handle accessible to the cleanup function.
+    g_h = h;
+
+    uint8_t master_secret[LT_MACANDD_SECRET_SIZE], key_setup[LT_MACANDD_KEY_SIZE], key_check[LT_MACANDD_KEY_SIZE];
+    uint8_t add[16];
+    const uint8_t pin[] = {1, 2, 3, 4, 5, 6}, pin_wrong[] = {1, 2, 3, 4, 5, 7};
+    uint8_t attempts, rounds;
+
+    LT_LOG_INFO("Initializing handle");
+    LT_TEST_ASSERT(LT_OK, lt_init(h));
+
+    LT_LOG_INFO("Starting Secure Session with key %d", (int)TR01_PAIRING_KEY_SLOT_INDEX_0);
+    LT_TEST_ASSERT(LT_OK, lt_verify_chip_and_start_secure_session(h, sh0priv, sh0pub, TR01_PAIRING_KEY_SLOT_INDEX_0));
+    LT_LOG_LINE();
+
+    // Slot has to be erased if fail occurs in the following code.
+    lt_test_cleanup_function = &lt_test_rev_macandd_pin_cleanup;
+
+    LT_LOG_INFO("Erasing R memory slot %d and checking that there is no record", MACANDD_PIN_R_MEM_SLOT);
+    LT_TEST_ASSERT(LT_OK, lt_r_mem_data_erase(h, MACANDD_PIN_R_MEM_SLOT));
+    LT_TEST_ASSERT(LT_MACANDD_RECORD_INVALID, lt_macandd_attempts_get(h, MACANDD_PIN_R_MEM_SLOT, &attempts, NULL));
+    LT_TEST_ASSERT(LT_MACANDD_RECORD_INVALID,
+                   lt_macandd_check(h, MACANDD_PIN_R_MEM_SLOT, pin, sizeof(pin), NULL, 0, key_check));
+    LT_LOG_LINE();
+
+    LT_LOG_INFO("Setting up PIN with %d attempts", MACANDD_PIN_ROUNDS);
+    LT_TEST_ASSERT(LT_OK, lt_random_fill(h, master_secret, sizeof(master_secret)));
+    LT_TEST_ASSERT(LT_OK, lt_random_fill(h, add, sizeof(add)));
+    LT_TEST_ASSERT(LT_OK, lt_macandd_setup(h, MACANDD_PIN_R_MEM_SLOT, MACANDD_PIN_FIRST_SLOT, MACANDD_PIN_ROUNDS,
+                                           master_secret, pin, sizeof(pin), add, sizeof(add), key_setup));
+    LT_TEST_ASSERT(LT_OK, lt_macandd_attempts_get(h, MACANDD_PIN_R_MEM_SLOT, &attempts, &rounds));
+    LT_TEST_ASSERT(1, (attempts == MACANDD_PIN_ROUNDS));
+    LT_TEST_ASSERT(1, (rounds == MACANDD_PIN_ROUNDS));
+    LT_LOG_LINE();
+
+    LT_LOG_INFO("Checking correct PIN twice (all slots have to be restored after each check)");
+    for (int i = 0; i < 2; i++) {
+        LT_TEST_ASSERT(LT_OK,
+                       lt_macandd_check(h, MACANDD_PIN_R_MEM_SLOT, pin, sizeof(pin), add, sizeof(add), key_check));
+        LT_TEST_ASSERT(0, memcmp(key_setup, key_check, sizeof(key_setup)));
+    }
+    LT_LOG_LINE();
+
+    LT_LOG_INFO("Checking wrong PIN and wrong additional data");
+    LT_TEST_ASSERT(LT_MACANDD_WRONG_PIN, lt_macandd_check(h, MACANDD_PIN_R_MEM_SLOT, pin_wrong, sizeof(pin_wrong),
+                                                          add, sizeof(add), key_check));
+    LT_TEST_ASSERT(LT_MACANDD_WRONG_PIN,
+                   lt_macandd_check(h, MACANDD_PIN_R_MEM_SLOT, pin, sizeof(pin), NULL, 0, key_check));
+    LT_TEST_ASSERT(LT_OK, lt_macandd_attempts_get(h, MACANDD_PIN_R_MEM_SLOT, &attempts, NULL));
+    LT_TEST_ASSERT(1, (attempts == MACANDD_PIN_ROUNDS - 2));
+
+    LT_LOG_INFO("Checking correct PIN (attempts have to be restored)");
+    LT_TEST_ASSERT(LT_OK, lt_macandd_check(h, MACANDD_PIN_R_MEM_SLOT, pin, sizeof(pin), add, sizeof(add), key_check));
+    LT_TEST_ASSERT(0, memcmp(key_setup, key_check, sizeof(key_setup)));
+    LT_TEST_ASSERT(LT_OK, lt_macandd_attempts_get(h, MACANDD_PIN_R_MEM_SLOT, &attempts, NULL));
+    LT_TEST_ASSERT(1, (attempts == MACANDD_PIN_ROUNDS));
+    LT_LOG_LINE();
+
+    LT_LOG_INFO("Using up all %d attempts with wrong PIN", MACANDD_PIN_ROUNDS);
+    for (int i = 0; i < MACANDD_PIN_ROUNDS; i++) {
+        LT_TEST_ASSERT(LT_MACANDD_WRONG_PIN, lt_macandd_check(h, MACANDD_PIN_R_MEM_SLOT, pin_wrong, sizeof(pin_wrong),
+                                                              add, sizeof(add), key_check));
+    }
+
+    LT_LOG_INFO("Checking correct PIN (no attempts should be left)");
+    LT_TEST_ASSERT(LT_MACANDD_NO_ATTEMPTS,
+                   lt_macandd_check(h, MACANDD_PIN_R_MEM_SLOT, pin, sizeof(pin), add, sizeof(add), key_check));
+    LT_LOG_LINE();
+
+    // Call cleanup function, but don't call it from LT_TEST_ASSERT anymore.
+    lt_test_cleanup_function = NULL;
+    LT_LOG_INFO("Starting post-test cleanup");
+    LT_TEST_ASSERT(LT_OK, lt_test_rev_macandd_pin_cleanup());
+    LT_LOG_INFO("Post-test cleanup was successful");
+}
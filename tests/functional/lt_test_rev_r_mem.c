@@ -15,6 +15,9 @@
 #include "lt_random.h"
 #include "string.h"
 
+/** @brief Number of slots used to test ranged and vectored R memory access. */
+#define LT_TEST_R_MEM_VEC_CNT 4
+
 // Shared with cleanup function
 lt_handle_t *g_h;
 
@@ -84,6 +87,13 @@ void lt_test_rev_r_mem(lt_handle_t *h)
     uint8_t r_mem_data[TR01_R_MEM_DATA_SIZE_MAX], write_data[TR01_R_MEM_DATA_SIZE_MAX],
         zeros[TR01_R_MEM_DATA_SIZE_MAX] = {0};
     uint16_t read_data_size, write_data_len;
+    uint8_t vec_write_data[LT_TEST_R_MEM_VEC_CNT][TR01_R_MEM_DATA_SIZE_MAX],
+        vec_read_data[LT_TEST_R_MEM_VEC_CNT][TR01_R_MEM_DATA_SIZE_MAX];
+    lt_r_mem_data_wr_t vec_wr[LT_TEST_R_MEM_VEC_CNT];
+    lt_r_mem_data_rd_t vec_rd[LT_TEST_R_MEM_VEC_CNT];
+    lt_ret_t vec_erase_res[LT_TEST_R_MEM_VEC_CNT];
+    // Use slots at the end of the partition, so the range does not start at 0.
+    const uint16_t vec_first_slot = TR01_R_MEM_DATA_SLOT_MAX + 1 - LT_TEST_R_MEM_VEC_CNT;
 
     LT_LOG_INFO("Initializing handle");
     LT_TEST_ASSERT(LT_OK, lt_init(h));
@@ -185,6 +195,83 @@ void lt_test_rev_r_mem(lt_handle_t *h)
     }
     LT_LOG_LINE();
 
+    LT_LOG_INFO("Erasing all slots using lt_r_mem_data_erase_range()...");
+    LT_TEST_ASSERT(LT_OK, lt_r_mem_data_erase_range(h, 0, TR01_R_MEM_DATA_SLOT_MAX + 1, NULL));
+    LT_LOG_LINE();
+
+#if LT_SLOT_INVENTORY
+    uint8_t inventory_blob[LT_SLOT_INVENTORY_BLOB_SIZE];
+    uint16_t free_slot;
+    bool slot_used;
+
+    LT_LOG_INFO("Scanning slot inventory...");
+    LT_TEST_ASSERT(LT_OK, lt_slot_inventory_scan(h));
+
+    LT_LOG_INFO("Checking that all slots are free...");
+    for (uint16_t i = 0; i <= TR01_R_MEM_DATA_SLOT_MAX; i++) {
+        LT_TEST_ASSERT(LT_OK, lt_slot_inventory_r_mem_is_used(h, i, &slot_used));
+        LT_TEST_ASSERT(0, slot_used);
+    }
+
+    LT_LOG_INFO("Allocating a slot and writing to it...");
+    LT_TEST_ASSERT(LT_OK, lt_slot_inventory_r_mem_alloc(h, &free_slot));
+    LT_TEST_ASSERT(1, (free_slot == 0));
+    LT_TEST_ASSERT(LT_OK, lt_r_mem_data_write(h, free_slot, zeros, sizeof(zeros)));
+
+    LT_LOG_INFO("Saving and loading slot inventory...");
+    LT_TEST_ASSERT(LT_OK, lt_slot_inventory_save(h, inventory_blob, sizeof(inventory_blob)));
+    LT_TEST_ASSERT(LT_OK, lt_slot_inventory_load(h, inventory_blob, sizeof(inventory_blob)));
+    LT_TEST_ASSERT(LT_OK, lt_slot_inventory_r_mem_is_used(h, free_slot, &slot_used));
+    LT_TEST_ASSERT(1, slot_used);
+
+    LT_LOG_INFO("Erasing the slot and checking that it is free...");
+    LT_TEST_ASSERT(LT_OK, lt_r_mem_data_erase(h, free_slot));
+    LT_TEST_ASSERT(LT_OK, lt_slot_inventory_r_mem_is_used(h, free_slot, &slot_used));
+    LT_TEST_ASSERT(0, slot_used);
+    LT_LOG_LINE();
+#endif
+
+    LT_LOG_INFO("Testing ranged and vectored access on %d slots...", (int)LT_TEST_R_MEM_VEC_CNT);
+    for (uint16_t i = 0; i < LT_TEST_R_MEM_VEC_CNT; i++) {
+        LT_LOG_INFO("Generating random data for slot #%" PRIu16 "...", vec_first_slot + i);
+        LT_TEST_ASSERT(LT_OK, lt_random_bytes(h, vec_write_data[i], sizeof(vec_write_data[i])));
+        vec_wr[i].slot = vec_first_slot + i;
+        vec_wr[i].data = vec_write_data[i];
+        vec_wr[i].data_size = TR01_R_MEM_DATA_SIZE_MAX;
+        vec_rd[i].data = vec_read_data[i];
+        vec_rd[i].data_max_size = TR01_R_MEM_DATA_SIZE_MAX;
+    }
+
+    LT_LOG_INFO("Writing slots using lt_r_mem_data_write_vec()...");
+    LT_TEST_ASSERT(LT_OK, lt_r_mem_data_write_vec(h, vec_wr, LT_TEST_R_MEM_VEC_CNT));
+    for (uint16_t i = 0; i < LT_TEST_R_MEM_VEC_CNT; i++) {
+        LT_TEST_ASSERT(LT_OK, vec_wr[i].ret);
+    }
+
+    LT_LOG_INFO("Reading slots using lt_r_mem_data_read_range()...");
+    LT_TEST_ASSERT(LT_OK, lt_r_mem_data_read_range(h, vec_first_slot, LT_TEST_R_MEM_VEC_CNT, vec_rd));
+
+    LT_LOG_INFO("Checking results, number of read bytes and contents...");
+    for (uint16_t i = 0; i < LT_TEST_R_MEM_VEC_CNT; i++) {
+        LT_TEST_ASSERT(LT_OK, vec_rd[i].ret);
+        LT_TEST_ASSERT(1, (vec_rd[i].data_read_size == TR01_R_MEM_DATA_SIZE_MAX));
+        LT_TEST_ASSERT(0, memcmp(vec_read_data[i], vec_write_data[i], TR01_R_MEM_DATA_SIZE_MAX));
+    }
+
+    LT_LOG_INFO("Erasing slots using lt_r_mem_data_erase_range()...");
+    LT_TEST_ASSERT(LT_OK, lt_r_mem_data_erase_range(h, vec_first_slot, LT_TEST_R_MEM_VEC_CNT, vec_erase_res));
+    for (uint16_t i = 0; i < LT_TEST_R_MEM_VEC_CNT; i++) {
+        LT_TEST_ASSERT(LT_OK, vec_erase_res[i]);
+    }
+
+    LT_LOG_INFO("Reading slots using lt_r_mem_data_read_range() (all should be empty)...");
+    LT_TEST_ASSERT(LT_OK, lt_r_mem_data_read_range(h, vec_first_slot, LT_TEST_R_MEM_VEC_CNT, vec_rd));
+    for (uint16_t i = 0; i < LT_TEST_R_MEM_VEC_CNT; i++) {
+        LT_TEST_ASSERT(LT_L3_R_MEM_DATA_READ_SLOT_EMPTY, vec_rd[i].ret);
+        LT_TEST_ASSERT(1, (vec_rd[i].data_read_size == 0));
+    }
+    LT_LOG_LINE();
+
     // Call cleanup function, but don't call it from LT_TEST_ASSERT anymore.
     lt_test_cleanup_function = NULL;
     LT_LOG_INFO("Starting post-test cleanup");
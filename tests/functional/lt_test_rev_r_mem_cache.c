@@ -0,0 +1,137 @@
+/**
+ * @file lt_test_rev_r_mem_cache.c
+ * @brief Tests R memory write-back cache.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <inttypes.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_functional_tests.h"
+#include "libtropic_logging.h"
+#include "libtropic_r_mem_cache.h"
+#include "lt_random.h"
+#include "string.h"
+
+/** @brief Slot used by the test. */
+#define R_MEM_CACHE_SLOT 0
+/** @brief Number of writes coalesced into one flush. */
+#define R_MEM_CACHE_WRITE_LOOPS 10
+/** @brief Number of lines of the test cache. */
+#define R_MEM_CACHE_LINE_CNT 2
+/** @brief Flush interval of the test cache. */
+#define R_MEM_CACHE_FLUSH_INTERVAL_MS 1000
+
+// Shared with cleanup function
+static lt_handle_t *g_h;
+
+static lt_ret_t lt_test_rev_r_mem_cache_cleanup(void)
+{
+    lt_ret_t ret;
+
+    LT_LOG_INFO("Erasing slot #%d", R_MEM_CACHE_SLOT);
+    ret = lt_r_mem_data_erase(g_h, R_MEM_CACHE_SLOT);
+    if (LT_OK != ret) {
+        LT_LOG_ERROR("Failed to erase slot.");
+        return ret;
+    }
+
+    LT_LOG_INFO("Aborting secure session");
+    ret = lt_session_abort(g_h);
+    if (LT_OK != ret) {
+        LT_LOG_ERROR("Failed to abort secure session.");
+        return ret;
+    }
+
+    LT_LOG_INFO("Deinitializing handle");
+    ret = lt_deinit(g_h);
+    if (LT_OK != ret) {
+        LT_LOG_ERROR("Failed to deinitialize handle.");
+        return ret;
+    }
+
+    return LT_OK;
+}
+
+void lt_test_rev_r_mem_cache(lt_handle_t *h)
+{
+    LT_LOG_INFO("----------------------------------------------");
+    LT_LOG_INFO("lt_test_rev_r_mem_cache()");
+    LT_LOG_INFO("----------------------------------------------");
+
+    // Making the handle accessible to the cleanup function.
+    g_h = h;
+
+    static lt_r_mem_cache_line_t lines[R_MEM_CACHE_LINE_CNT];
+    lt_r_mem_cache_t cache;
+    uint8_t write_data[TR01_R_MEM_DATA_SIZE_MAX], read_data[TR01_R_MEM_DATA_SIZE_MAX];
+    uint16_t read_data_size;
+
+    LT_LOG_INFO("Initializing handle");
+    LT_TEST_ASSERT(LT_OK, lt_init(h));
+
+    LT_LOG_INFO("Starting Secure Session with key %d", (int)TR01_PAIRING_KEY_SLOT_INDEX_0);
+    LT_TEST_ASSERT(LT_OK, lt_verify_chip_and_start_secure_session(h, sh0priv, sh0pub, TR01_PAIRING_KEY_SLOT_INDEX_0));
+    LT_LOG_LINE();
+
+    // Slot has to be erased if fail occurs in the following code.
+    lt_test_cleanup_function = &lt_test_rev_r_mem_cache_cleanup;
+
+    LT_LOG_INFO("Erasing slot #%d", R_MEM_CACHE_SLOT);
+    LT_TEST_ASSERT(LT_OK, lt_r_mem_data_erase(h, R_MEM_CACHE_SLOT));
+
+    LT_LOG_INFO("Initializing cache with %d lines", R_MEM_CACHE_LINE_CNT);
+    LT_TEST_ASSERT(LT_OK, lt_r_mem_cache_init(&cache, h, lines, R_MEM_CACHE_LINE_CNT, 0, R_MEM_CACHE_FLUSH_INTERVAL_MS));
+
+    LT_LOG_INFO("Reading empty slot through the cache (should fail)");
+    LT_TEST_ASSERT(LT_L3_R_MEM_DATA_READ_SLOT_EMPTY,
+                   lt_r_mem_cache_read(&cache, R_MEM_CACHE_SLOT, read_data, sizeof(read_data), &read_data_size));
+    LT_LOG_LINE();
+
+    LT_LOG_INFO("Writing slot %d times through the cache, reading back after each write", R_MEM_CACHE_WRITE_LOOPS);
+    for (uint16_t i = 0; i < R_MEM_CACHE_WRITE_LOOPS; i++) {
+        LT_TEST_ASSERT(LT_OK, lt_random_bytes(h, write_data, sizeof(write_data)));
+        LT_TEST_ASSERT(LT_OK, lt_r_mem_cache_write(&cache, R_MEM_CACHE_SLOT, write_data, sizeof(write_data)));
+        LT_TEST_ASSERT(LT_OK,
+                       lt_r_mem_cache_read(&cache, R_MEM_CACHE_SLOT, read_data, sizeof(read_data), &read_data_size));
+        LT_TEST_ASSERT(1, (read_data_size == sizeof(write_data)));
+        LT_TEST_ASSERT(0, memcmp(read_data, write_data, sizeof(write_data)));
+    }
+
+    LT_LOG_INFO("Checking that slot in R memory is still empty");
+    LT_TEST_ASSERT(LT_L3_R_MEM_DATA_READ_SLOT_EMPTY,
+                   lt_r_mem_data_read(h, R_MEM_CACHE_SLOT, read_data, sizeof(read_data), &read_data_size));
+
+    LT_LOG_INFO("Advancing cache clock below the flush interval (nothing should be written)");
+    LT_TEST_ASSERT(LT_OK, lt_r_mem_cache_tick(&cache, R_MEM_CACHE_FLUSH_INTERVAL_MS - 1));
+    LT_TEST_ASSERT(1, (cache.stats.nvm_writes == 0));
+
+    LT_LOG_INFO("Advancing cache clock to the flush interval");
+    LT_TEST_ASSERT(LT_OK, lt_r_mem_cache_tick(&cache, R_MEM_CACHE_FLUSH_INTERVAL_MS));
+
+    LT_LOG_INFO("Checking statistics (one NVM write for %d writes)", R_MEM_CACHE_WRITE_LOOPS);
+    LT_TEST_ASSERT(1, (cache.stats.writes == R_MEM_CACHE_WRITE_LOOPS));
+    LT_TEST_ASSERT(1, (cache.stats.nvm_writes == 1));
+
+    LT_LOG_INFO("Reading slot directly from R memory and checking contents");
+    LT_TEST_ASSERT(LT_OK, lt_r_mem_data_read(h, R_MEM_CACHE_SLOT, read_data, sizeof(read_data), &read_data_size));
+    LT_TEST_ASSERT(1, (read_data_size == sizeof(write_data)));
+    LT_TEST_ASSERT(0, memcmp(read_data, write_data, sizeof(write_data)));
+    LT_LOG_LINE();
+
+    LT_LOG_INFO("Erasing slot through the cache and syncing");
+    LT_TEST_ASSERT(LT_OK, lt_r_mem_cache_erase(&cache, R_MEM_CACHE_SLOT));
+    LT_TEST_ASSERT(LT_OK, lt_r_mem_cache_sync(&cache));
+    LT_TEST_ASSERT(LT_L3_R_MEM_DATA_READ_SLOT_EMPTY,
+                   lt_r_mem_data_read(h, R_MEM_CACHE_SLOT, read_data, sizeof(read_data), &read_data_size));
+    LT_LOG_LINE();
+
+    // Call cleanup function, but don't call it from LT_TEST_ASSERT anymore.
+    lt_test_cleanup_function = NULL;
+    LT_LOG_INFO("Starting post-test cleanup");
+    LT_TEST_ASSERT(LT_OK, lt_test_rev_r_mem_cache_cleanup());
+    LT_LOG_INFO("Post-test cleanup was successful");
+}
@@ -16,6 +16,8 @@
 #include "string.h"
 
 #define RANDOM_VALUE_GET_LOOPS 300
+#define RANDOM_FILL_LEN 2000
+#define RANDOM_DRBG_RESEED_INTERVAL 512
 
 void lt_test_rev_random_value_get(lt_handle_t *h)
 {
@@ -48,6 +50,35 @@ void lt_test_rev_random_value_get(lt_handle_t *h)
     }
     LT_LOG_LINE();
 
+    uint8_t random_fill_data[RANDOM_FILL_LEN];
+    uint16_t random_fill_len;
+
+    LT_LOG_INFO("Generating random data length <= %d (with lt_random_bytes())...", RANDOM_FILL_LEN);
+    LT_TEST_ASSERT(LT_OK, lt_random_bytes(h, &random_fill_len, sizeof(random_fill_len)));
+    random_fill_len %= RANDOM_FILL_LEN + 1;
+
+    LT_LOG_INFO("Getting %" PRIu16 " random bytes from TROPIC01 with lt_random_fill()...", random_fill_len);
+    LT_TEST_ASSERT(LT_OK, lt_random_fill(h, random_fill_data, random_fill_len));
+    LT_LOG_INFO("Random data from TROPIC01:");
+    hexdump_8byte(random_fill_data, random_fill_len);
+    LT_LOG_LINE();
+
+#ifdef LT_HELPERS
+    lt_random_drbg_t drbg;
+
+    LT_LOG_INFO("Seeding host DRBG from TROPIC01, reseed interval %d bytes...", RANDOM_DRBG_RESEED_INTERVAL);
+    LT_TEST_ASSERT(LT_OK, lt_random_drbg_init(h, &drbg, RANDOM_DRBG_RESEED_INTERVAL));
+
+    LT_LOG_INFO("Generating %d bytes with the host DRBG (includes reseeds)...", RANDOM_FILL_LEN);
+    LT_TEST_ASSERT(LT_OK, lt_random_drbg_fill(h, &drbg, random_fill_data, sizeof(random_fill_data)));
+    LT_TEST_ASSERT(1, drbg.bytes_since_reseed <= RANDOM_DRBG_RESEED_INTERVAL);
+    hexdump_8byte(random_fill_data, 64);
+
+    LT_LOG_INFO("Wiping host DRBG");
+    LT_TEST_ASSERT(LT_OK, lt_random_drbg_deinit(&drbg));
+    LT_LOG_LINE();
+#endif
+
     LT_LOG_INFO("Aborting Secure Session");
     LT_TEST_ASSERT(LT_OK, lt_session_abort(h));
 
@@ -6,6 +6,7 @@
  * @license For the license see file LICENSE.txt file in the root directory of this source tree.
  */
 
+#include <inttypes.h>
 #include <string.h>
 
 #include "libtropic.h"
@@ -95,6 +96,8 @@ void lt_test_rev_startup_req(lt_handle_t *h)
     for (int i = 0; i < 2; i++) {
         LT_LOG_INFO("Rebooting to the app mode...");
         LT_TEST_ASSERT(LT_OK, lt_reboot(h, TR01_REBOOT));
+        LT_LOG_INFO("Chip was ready after %" PRIu32 " ms", h->l2.reboot_time_ms);
+        LT_TEST_ASSERT(1, (h->l2.reboot_time_ms <= LT_TR01_REBOOT_DELAY_MS));
         LT_LOG_INFO("Checking the chip is in the normal mode...");
         LT_TEST_ASSERT(APPLICATION_MODE, check_current_state());
     }
@@ -103,6 +106,8 @@ void lt_test_rev_startup_req(lt_handle_t *h)
     for (int i = 0; i < 2; i++) {
         LT_LOG_INFO("Rebooting to the maintenance mode (maintenance reboot)...");
         LT_TEST_ASSERT(LT_OK, lt_reboot(h, TR01_MAINTENANCE_REBOOT));
+        LT_LOG_INFO("Chip was ready after %" PRIu32 " ms", h->l2.reboot_time_ms);
+        LT_TEST_ASSERT(1, (h->l2.reboot_time_ms <= LT_TR01_REBOOT_DELAY_MS));
         LT_LOG_INFO("Checking the chip is in the maintenance mode...");
         LT_TEST_ASSERT(MAINTENANCE_MODE, check_current_state());
         LT_LOG_INFO("Checking that the handshake does not work...");
@@ -137,6 +137,40 @@ void lt_test_rev_write_r_config(lt_handle_t *h)
     }
     LT_LOG_LINE();
 
+#if LT_R_CONFIG_MIRROR
+    const lt_r_config_mirror_t *r_config_mirror = &h->r_config_mirror;
+    uint32_t sleep_mode_en;
+
+    LT_LOG_INFO("Loading R config mirror");
+    LT_TEST_ASSERT(LT_OK, lt_r_config_mirror_load(h));
+    LT_TEST_ASSERT(0, r_config_mirror->dirty);
+
+    LT_LOG_INFO("Flipping sleep mode enable bit in the mirror");
+    LT_TEST_ASSERT(LT_OK, lt_r_config_mirror_get_field(h, TR01_CFG_SLEEP_MODE_IDX,
+                                                       APPLICATION_CO_CFG_SLEEP_MODE_SLEEP_MODE_EN_MASK,
+                                                       &sleep_mode_en));
+    LT_TEST_ASSERT(LT_OK, lt_r_config_mirror_set_field(h, TR01_CFG_SLEEP_MODE_IDX,
+                                                       APPLICATION_CO_CFG_SLEEP_MODE_SLEEP_MODE_EN_MASK,
+                                                       !sleep_mode_en));
+    LT_TEST_ASSERT(1, (r_config_mirror->dirty == BIT(TR01_CFG_SLEEP_MODE_IDX)));
+
+    LT_LOG_INFO("Committing R config mirror");
+    LT_TEST_ASSERT(LT_OK, lt_r_config_mirror_commit(h));
+    LT_TEST_ASSERT(0, r_config_mirror->dirty);
+
+    LT_LOG_INFO("Reading the whole R config and comparing it with the mirror");
+    LT_TEST_ASSERT(LT_OK, lt_read_whole_R_config(h, &r_config));
+    for (int i = 0; i < LT_CONFIG_OBJ_CNT; i++) {
+        LT_LOG_INFO("%s: 0x%08" PRIx32, cfg_desc_table[i].desc, r_config.obj[i]);
+        LT_TEST_ASSERT(1, (r_config.obj[i] == r_config_mirror->shadow.obj[i]));
+    }
+
+    LT_LOG_INFO("Checking that R config write through the handle unloads the mirror");
+    LT_TEST_ASSERT(LT_L3_FAIL, lt_r_config_write(h, cfg_desc_table[0].addr, r_config_backup.obj[0]));
+    LT_TEST_ASSERT(LT_PARAM_ERR, lt_r_config_mirror_get(h, TR01_CFG_SLEEP_MODE_IDX, &sleep_mode_en));
+    LT_LOG_LINE();
+#endif
+
     // Call cleanup function, but don't call it from LT_TEST_ASSERT anymore.
     lt_test_cleanup_function = NULL;
     LT_LOG_INFO("Starting post-test cleanup");
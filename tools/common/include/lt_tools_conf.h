@@ -0,0 +1,69 @@
+#ifndef LT_TOOLS_CONF_H
+#define LT_TOOLS_CONF_H
+
+/**
+ * @file lt_tools_conf.h
+ * @brief Chips listed in configuration files of tools loaded into applications (lt_pkcs11, lt_ossl_provider)
+ * @details One chip per line, `#` starts a comment:
+ * @code
+ * <chip> <pairing_priv_file> <pairing_pub_file> <pairing_key_slot> [<label>]
+ * @endcode
+ * The chip is given in the LT_TOOLS_DEV_SPEC format, pairing keys are raw TR01_X25519_KEY_LEN byte files.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "libtropic_common.h"
+#include "lt_tools_dev.h"
+#include "lt_tools_session.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Maximal length of a configuration file line. */
+#define LT_TOOLS_CONF_LINE_MAX 512
+/** @brief Maximal length of a chip label. */
+#define LT_TOOLS_CONF_LABEL_MAX 32
+
+/** @brief Chip read from a configuration file. Must not be moved, the members point to each other. */
+typedef struct lt_tools_chip_t {
+    lt_tools_dev_t dev;                      /**< Device of the port */
+    lt_handle_t h;                           /**< Device's handle */
+    uint8_t sh_keys[2][TR01_X25519_KEY_LEN]; /**< Pairing private and public key */
+    lt_tools_session_t ses;                  /**< Secure Session, set up to be opened */
+    char label[LT_TOOLS_CONF_LABEL_MAX + 1]; /**< Label, "TROPIC01 #<n>" if not given */
+} lt_tools_chip_t;
+
+/**
+ * @brief Returns the place for the chip at index `idx`.
+ *
+ * @param arg  Argument given to lt_tools_conf_load()
+ * @param idx  Index of the chip
+ *
+ * @return     Zeroed chip
+ */
+typedef lt_tools_chip_t *(*lt_tools_chip_get_t)(void *arg, const uint8_t idx);
+
+/**
+ * @brief Reads chips from a configuration file. Errors are logged.
+ *
+ * @param path     Path of the file
+ * @param chip_get Returns places for the chips
+ * @param arg      Argument of `chip_get`
+ * @param max      Maximal number of chips
+ * @param cnt      Number of chips read
+ *
+ * @return         true if all lines are valid and there is at least one chip
+ */
+bool lt_tools_conf_load(const char *path, lt_tools_chip_get_t chip_get, void *arg, const uint8_t max, uint8_t *cnt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LT_TOOLS_CONF_H
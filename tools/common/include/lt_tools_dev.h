@@ -0,0 +1,64 @@
+#ifndef LT_TOOLS_DEV_H
+#define LT_TOOLS_DEV_H
+
+/**
+ * @file lt_tools_dev.h
+ * @brief Chip specifications and pairing keys given to tools on the command line or in configuration files
+ * @details The Unix port is selected at build time by defining one of LT_TOOLS_PORT_TCP, LT_TOOLS_PORT_SPI or
+ * LT_TOOLS_PORT_USB_DONGLE (see tools/common/lt_tools_common.cmake).
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if LT_TOOLS_PORT_TCP
+#include "libtropic_port_unix_tcp.h"
+typedef lt_dev_unix_tcp_t lt_tools_dev_t;
+/** @brief Format of the chip specification accepted by lt_tools_dev_parse(). */
+#define LT_TOOLS_DEV_SPEC "<host>:<port>"
+#elif LT_TOOLS_PORT_SPI
+#include "libtropic_port_unix_spi.h"
+typedef lt_dev_unix_spi_t lt_tools_dev_t;
+/** @brief Format of the chip specification accepted by lt_tools_dev_parse(). */
+#define LT_TOOLS_DEV_SPEC "<spi_dev>,<gpio_dev>,<cs_gpio>[,<speed_hz>]"
+#elif LT_TOOLS_PORT_USB_DONGLE
+#include "libtropic_port_unix_usb_dongle.h"
+typedef lt_dev_unix_usb_dongle_t lt_tools_dev_t;
+/** @brief Format of the chip specification accepted by lt_tools_dev_parse(). */
+#define LT_TOOLS_DEV_SPEC "<tty_dev>[,<baud_rate>]"
+#else
+#error "Define one of LT_TOOLS_PORT_TCP, LT_TOOLS_PORT_SPI, LT_TOOLS_PORT_USB_DONGLE"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Fills the device structure from a chip specification in the LT_TOOLS_DEV_SPEC format.
+ *
+ * @param spec  Chip specification, modified by the function
+ * @param dev   Device structure to fill
+ *
+ * @return      true if the specification is valid
+ */
+bool lt_tools_dev_parse(char *spec, lt_tools_dev_t *dev);
+
+/**
+ * @brief Reads a pairing key stored as raw bytes.
+ *
+ * @param path  Path of the file
+ * @param key   Buffer for TR01_X25519_KEY_LEN bytes
+ *
+ * @return      true if the file holds exactly TR01_X25519_KEY_LEN bytes
+ */
+bool lt_tools_key_read(const char *path, uint8_t *key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LT_TOOLS_DEV_H
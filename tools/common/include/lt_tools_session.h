@@ -0,0 +1,66 @@
+#ifndef LT_TOOLS_SESSION_H
+#define LT_TOOLS_SESSION_H
+
+/**
+ * @file lt_tools_session.h
+ * @brief Secure Session kept open by long-running tools
+ * @details Tools in tools/ serve many requests with one Secure Session. lt_tools_session_open() is called before each
+ * use and starts the session only when it is not running, lt_tools_session_check() is called with the result of each
+ * command and makes the next lt_tools_session_open() start a new session after errors which leave the session out of
+ * sync (e.g. the chip was reset).
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "libtropic_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Secure Session with one chip. */
+typedef struct lt_tools_session_t {
+    lt_handle_t *h;             /**< Device's handle with the device set up */
+    const uint8_t *sh_priv;     /**< Pairing private key */
+    const uint8_t *sh_pub;      /**< Pairing public key */
+    lt_pkey_index_t pkey_index; /**< Pairing key slot */
+    bool ready;                 /**< lt_init() succeeded */
+    bool restart;               /**< Session has to be started again */
+} lt_tools_session_t;
+
+/**
+ * @brief Initializes the handle and starts the Secure Session, unless it is already running.
+ * @details When starting the session fails, the handle is deinitialized and initialized again once.
+ *
+ * @param s  Session with `h`, keys and `pkey_index` set, other members zeroed before the first call
+ *
+ * @retval   LT_OK Session is running
+ * @retval   other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding of
+ * returned value
+ */
+lt_ret_t lt_tools_session_open(lt_tools_session_t *s);
+
+/**
+ * @brief Marks the session for restart, if `ret` means it cannot be trusted anymore.
+ *
+ * @param s    Session
+ * @param ret  Result of a command sent in the session
+ */
+void lt_tools_session_check(lt_tools_session_t *s, const lt_ret_t ret);
+
+/**
+ * @brief Aborts the session and deinitializes the handle.
+ *
+ * @param s  Session
+ */
+void lt_tools_session_close(lt_tools_session_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LT_TOOLS_SESSION_H
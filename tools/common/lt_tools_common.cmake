@@ -0,0 +1,57 @@
+# Helpers shared by the tools in tools/, include this file from a tool's CMakeLists.txt after libtropic was added.
+#
+# Defines:
+#   lt_tools_session - Secure Session kept open across requests, does not depend on the port
+#   lt_tools_dev     - Chip specification and configuration file parsing and the Unix port selected by LT_TOOLS_PORT,
+#                      an object library, so the port is linked in even though only libtropic references it
+include_guard(GLOBAL)
+
+# LT_TOOLS_PORT - Unix port the tools talk to the chips through.
+set(LT_TOOLS_PORT "tcp" CACHE STRING "Port used by the tools (tcp, spi, usb_dongle)")
+set_property(CACHE LT_TOOLS_PORT PROPERTY STRINGS tcp spi usb_dongle)
+
+get_filename_component(LT_TOOLS_LIBTROPIC_DIR "${CMAKE_CURRENT_LIST_DIR}/../.." ABSOLUTE)
+
+# Sessions are started with lt_verify_chip_and_start_secure_session()
+if(NOT LT_HELPERS)
+    message(FATAL_ERROR "Tools require LT_HELPERS")
+endif()
+
+if(LT_TOOLS_PORT STREQUAL "tcp")
+    set(LT_TOOLS_PORT_SRC ${LT_TOOLS_LIBTROPIC_DIR}/hal/port/unix/libtropic_port_unix_tcp.c)
+    set(LT_TOOLS_PORT_DEF LT_TOOLS_PORT_TCP=1)
+elseif(LT_TOOLS_PORT STREQUAL "spi")
+    set(LT_TOOLS_PORT_SRC ${LT_TOOLS_LIBTROPIC_DIR}/hal/port/unix/libtropic_port_unix_spi.c)
+    set(LT_TOOLS_PORT_DEF LT_TOOLS_PORT_SPI=1)
+elseif(LT_TOOLS_PORT STREQUAL "usb_dongle")
+    set(LT_TOOLS_PORT_SRC ${LT_TOOLS_LIBTROPIC_DIR}/hal/port/unix/libtropic_port_unix_usb_dongle.c)
+    set(LT_TOOLS_PORT_DEF LT_TOOLS_PORT_USB_DONGLE=1)
+else()
+    message(FATAL_ERROR "Unsupported LT_TOOLS_PORT '${LT_TOOLS_PORT}'")
+endif()
+if(LT_THREAD_SAFE)
+    list(APPEND LT_TOOLS_PORT_SRC ${LT_TOOLS_LIBTROPIC_DIR}/hal/port/unix/libtropic_port_unix_mutex.c)
+endif()
+
+# Tools may be shared libraries (e.g. the PKCS#11 module), so everything linked into them is position independent
+set_target_properties(tropic PROPERTIES POSITION_INDEPENDENT_CODE ON)
+if(TARGET trezor_crypto)
+    set_target_properties(trezor_crypto PROPERTIES POSITION_INDEPENDENT_CODE ON)
+endif()
+
+add_library(lt_tools_session STATIC ${CMAKE_CURRENT_LIST_DIR}/src/lt_tools_session.c)
+target_include_directories(lt_tools_session PUBLIC ${CMAKE_CURRENT_LIST_DIR}/include)
+target_link_libraries(lt_tools_session PUBLIC tropic)
+
+add_library(lt_tools_dev OBJECT ${CMAKE_CURRENT_LIST_DIR}/src/lt_tools_dev.c ${CMAKE_CURRENT_LIST_DIR}/src/lt_tools_conf.c
+                               ${LT_TOOLS_PORT_SRC})
+target_include_directories(lt_tools_dev PUBLIC ${CMAKE_CURRENT_LIST_DIR}/include ${LT_TOOLS_LIBTROPIC_DIR}/hal/port/unix)
+target_compile_definitions(lt_tools_dev PUBLIC ${LT_TOOLS_PORT_DEF})
+target_link_libraries(lt_tools_dev PUBLIC tropic)
+
+set_target_properties(lt_tools_session lt_tools_dev PROPERTIES POSITION_INDEPENDENT_CODE ON)
+
+if(TARGET libtropic::strict_comp_flags)
+    target_link_libraries(lt_tools_session PRIVATE libtropic::strict_comp_flags)
+    target_link_libraries(lt_tools_dev PRIVATE libtropic::strict_comp_flags)
+endif()
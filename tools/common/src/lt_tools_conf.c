@@ -0,0 +1,93 @@
+/**
+ * @file lt_tools_conf.c
+ * @brief Chips listed in configuration files of tools loaded into applications
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // strtok_r()
+#endif
+
+#include "lt_tools_conf.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libtropic_common.h"
+#include "libtropic_logging.h"
+#include "lt_tools_dev.h"
+
+/** @brief Parses the arguments of a line, returns false if they are invalid. */
+static bool lt_tools_conf_chip(char *spec, char *save, lt_tools_chip_t *chip, const uint8_t idx)
+{
+    char *priv = strtok_r(NULL, " \t\r\n", &save);
+    char *pub = strtok_r(NULL, " \t\r\n", &save);
+    char *slot = strtok_r(NULL, " \t\r\n", &save);
+    char *label = strtok_r(NULL, " \t\r\n", &save);
+
+    if (!priv || !pub || !slot || slot[0] < '0' || slot[0] > '0' + TR01_PAIRING_KEY_SLOT_INDEX_3 || slot[1] != '\0'
+        || strtok_r(NULL, " \t\r\n", &save) || !lt_tools_dev_parse(spec, &chip->dev)
+        || !lt_tools_key_read(priv, chip->sh_keys[0]) || !lt_tools_key_read(pub, chip->sh_keys[1])) {
+        return false;
+    }
+
+    if (label) {
+        snprintf(chip->label, sizeof(chip->label), "%s", label);
+    }
+    else {
+        snprintf(chip->label, sizeof(chip->label), "TROPIC01 #%u", idx);
+    }
+    chip->h.l2.device = &chip->dev;
+    chip->ses.h = &chip->h;
+    chip->ses.sh_priv = chip->sh_keys[0];
+    chip->ses.sh_pub = chip->sh_keys[1];
+    chip->ses.pkey_index = (lt_pkey_index_t)(slot[0] - '0');
+
+    return true;
+}
+
+bool lt_tools_conf_load(const char *path, lt_tools_chip_get_t chip_get, void *arg, const uint8_t max, uint8_t *cnt)
+{
+    if (!path || !chip_get || !cnt) {
+        return false;
+    }
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        LT_LOG_ERROR("Cannot open %s", path);
+        return false;
+    }
+
+    char line[LT_TOOLS_CONF_LINE_MAX];
+    unsigned line_no = 0;
+    bool ok = true;
+    *cnt = 0;
+    while (ok && fgets(line, sizeof(line), f)) {
+        line_no++;
+        char *comment = strchr(line, '#');
+        if (comment) {
+            *comment = '\0';
+        }
+        char *save;
+        char *spec = strtok_r(line, " \t\r\n", &save);
+        if (!spec) {
+            continue;
+        }
+        if (*cnt == max || !lt_tools_conf_chip(spec, save, chip_get(arg, *cnt), *cnt)) {
+            LT_LOG_ERROR("%s:%u: invalid chip", path, line_no);
+            ok = false;
+            break;
+        }
+        (*cnt)++;
+    }
+    fclose(f);
+
+    if (ok && *cnt == 0) {
+        LT_LOG_ERROR("%s: no chips", path);
+        ok = false;
+    }
+    return ok;
+}
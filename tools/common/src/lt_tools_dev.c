@@ -0,0 +1,103 @@
+/**
+ * @file lt_tools_dev.c
+ * @brief Chip specifications and pairing keys given to tools on the command line or in configuration files
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // strtok_r()
+#endif
+
+#include "lt_tools_dev.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "libtropic_common.h"
+
+static bool lt_tools_parse_uint(const char *str, const unsigned long max, unsigned long *value)
+{
+    char *end;
+    errno = 0;
+    *value = strtoul(str, &end, 0);
+    return errno == 0 && end != str && *end == '\0' && *value <= max;
+}
+
+bool lt_tools_dev_parse(char *spec, lt_tools_dev_t *dev)
+{
+    unsigned long value;
+
+    if (!spec || !dev) {
+        return false;
+    }
+    dev->rng_seed = (unsigned int)time(NULL);
+
+#if LT_TOOLS_PORT_TCP
+    char *port = strrchr(spec, ':');
+    if (!port) {
+        return false;
+    }
+    *port++ = '\0';
+    if (!lt_tools_parse_uint(port, UINT16_MAX, &value) || inet_pton(AF_INET, spec, &dev->addr) != 1) {
+        return false;
+    }
+    dev->port = (in_port_t)value;
+#elif LT_TOOLS_PORT_SPI
+    char *save;
+    char *spi_dev = strtok_r(spec, ",", &save);
+    char *gpio_dev = strtok_r(NULL, ",", &save);
+    char *cs = strtok_r(NULL, ",", &save);
+    char *speed = strtok_r(NULL, ",", &save);
+    if (!spi_dev || !gpio_dev || !cs || !lt_tools_parse_uint(cs, INT32_MAX, &value)) {
+        return false;
+    }
+    dev->gpio_cs_num = (int)value;
+    dev->spi_speed = 5000000;
+    if (speed) {
+        if (!lt_tools_parse_uint(speed, INT32_MAX, &value)) {
+            return false;
+        }
+        dev->spi_speed = (int)value;
+    }
+    snprintf(dev->spi_dev, sizeof(dev->spi_dev), "%s", spi_dev);
+    snprintf(dev->gpio_dev, sizeof(dev->gpio_dev), "%s", gpio_dev);
+#elif LT_TOOLS_PORT_USB_DONGLE
+    char *save;
+    char *tty = strtok_r(spec, ",", &save);
+    char *baud = strtok_r(NULL, ",", &save);
+    if (!tty) {
+        return false;
+    }
+    dev->baud_rate = 115200;
+    if (baud) {
+        if (!lt_tools_parse_uint(baud, UINT32_MAX, &value)) {
+            return false;
+        }
+        dev->baud_rate = (uint32_t)value;
+    }
+    snprintf(dev->dev_path, sizeof(dev->dev_path), "%s", tty);
+#endif
+
+    return true;
+}
+
+bool lt_tools_key_read(const char *path, uint8_t *key)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    uint8_t extra;
+    bool ok = fread(key, 1, TR01_X25519_KEY_LEN, f) == TR01_X25519_KEY_LEN && fread(&extra, 1, 1, f) == 0;
+    fclose(f);
+
+    return ok;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file lt_tools_session.c
+ * @brief Secure Session kept open by long-running tools
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include "lt_tools_session.h"
+
+#include <stdbool.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_logging.h"
+
+/** @brief Returns true for errors after which the Secure Session cannot be trusted to be in sync. */
+static bool lt_tools_session_broken(const lt_ret_t ret)
+{
+    return (ret >= LT_L1_SPI_ERROR && ret <= LT_L1_INT_TIMEOUT) || ret == LT_L3_FAIL || ret == LT_L2_HSK_ERR
+           || ret == LT_L2_NO_SESSION || ret == LT_L2_TAG_ERR || ret == LT_CRYPTO_ERR || ret == LT_HOST_NO_SESSION
+           || ret == LT_NONCE_OVERFLOW;
+}
+
+lt_ret_t lt_tools_session_open(lt_tools_session_t *s)
+{
+    if (!s || !s->h || !s->sh_priv || !s->sh_pub) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_ret_t ret;
+    if (!s->ready) {
+        ret = lt_init(s->h);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        s->ready = true;
+        s->restart = true;
+    }
+    if (!s->restart && s->h->l3.session_status == LT_SECURE_SESSION_ON) {
+        return LT_OK;
+    }
+
+    if (s->h->l3.session_status == LT_SECURE_SESSION_ON) {
+        lt_session_abort(s->h);
+    }
+    ret = lt_verify_chip_and_start_secure_session(s->h, s->sh_priv, s->sh_pub, s->pkey_index);
+    if (ret != LT_OK) {
+        // Chip might have been reset or the bus glitched, try once more from scratch
+        LT_LOG_WARN("Session start failed (%s), reinitializing", lt_ret_verbose(ret));
+        lt_deinit(s->h);
+        s->ready = false;
+        ret = lt_init(s->h);
+        if (ret == LT_OK) {
+            s->ready = true;
+            ret = lt_verify_chip_and_start_secure_session(s->h, s->sh_priv, s->sh_pub, s->pkey_index);
+        }
+    }
+
+    s->restart = (ret != LT_OK);
+    return ret;
+}
+
+void lt_tools_session_check(lt_tools_session_t *s, const lt_ret_t ret)
+{
+    if (lt_tools_session_broken(ret)) {
+        s->restart = true;
+    }
+}
+
+void lt_tools_session_close(lt_tools_session_t *s)
+{
+    if (!s || !s->ready) {
+        return;
+    }
+
+    if (s->h->l3.session_status == LT_SECURE_SESSION_ON) {
+        lt_session_abort(s->h);
+    }
+    lt_deinit(s->h);
+    s->ready = false;
+}
@@ -0,0 +1,46 @@
+#ifndef LT_OSSL_PROVIDER_H
+#define LT_OSSL_PROVIDER_H
+
+/**
+ * @file lt_ossl_provider.h
+ * @brief OpenSSL 3 provider backed by TROPIC01 chips
+ * @details The provider makes keys in ECC key slots usable as EVP_PKEYs, e.g. as TLS server keys, without the
+ * application calling libtropic. It implements:
+ * - a store loader for URIs `tropic:slot=<n>[;chip=<n>]` (chip 0 if not given), which reads the public key from the
+ *   slot and returns an opaque EVP_PKEY (key type "EC" on P-256 or "ED25519"),
+ * - key management for both key types, public keys can be exported, so the keys can be compared with certificates
+ *   and encoded (signatures are verified with the certificate's key, which other providers hold),
+ * - "ECDSA" signatures (EVP_PKEY_sign() of a hash and EVP_DigestSign*() with any digest, the hash is signed with
+ *   lt_ecc_ecdsa_sign_hash()) and "ED25519" signatures (one-shot EVP_DigestSign(), lt_ecc_eddsa_sign()).
+ * Everything else, including verification and key exchange, is left to other providers, e.g. the default one.
+ * Load the default provider before this one: libssl takes the TLS 1.2 key exchange groups from the provider whose
+ * "EC" key management is found first, so with this provider first ECDHE-ECDSA cipher suites are not offered.
+ *
+ * A Secure Session with each chip is started when the provider is loaded and kept open, a broken session is started
+ * again on the next use. Signing threads wait for a chip in a FIFO queue, so concurrent TLS handshakes are served
+ * in the order they asked for the chip.
+ *
+ * Chips are listed in a file in the format of lt_tools_conf.h (the chip format depends on the port the provider was
+ * built with, LT_TOOLS_DEV_SPEC). Its path is taken from parameter LT_OSSL_PROVIDER_CONF_PARAM of the provider's
+ * section in openssl.cnf, or from environment variable LT_OSSL_PROVIDER_CONF_ENV.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+/** @brief Name of the provider, also its property `provider=` */
+#define LT_OSSL_PROVIDER_NAME "lt_ossl_provider"
+/** @brief Scheme of the URIs of keys. */
+#define LT_OSSL_PROVIDER_SCHEME "tropic"
+/** @brief Parameter of the provider's configuration section with the path of the chip list. */
+#define LT_OSSL_PROVIDER_CONF_PARAM "lt_conf"
+/** @brief Environment variable with the path of the chip list, used when the parameter is not set. */
+#define LT_OSSL_PROVIDER_CONF_ENV "LT_OSSL_PROVIDER_CONF"
+/** @brief Maximal number of chips. */
+#define LT_OSSL_PROVIDER_CHIPS_MAX 8
+/** @brief Maximal length of a message signed with Ed25519, limit of EDDSA_Sign. */
+#define LT_OSSL_PROVIDER_EDDSA_MSG_LEN_MAX 4096
+/** @brief Version reported in the provider's parameters. */
+#define LT_OSSL_PROVIDER_VERSION "0.1.0"
+
+#endif  // LT_OSSL_PROVIDER_H
@@ -0,0 +1,1118 @@
+/**
+ * @file lt_ossl_provider.c
+ * @brief OpenSSL 3 provider backed by TROPIC01 chips
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include "lt_ossl_provider.h"
+
+#include <openssl/core.h>
+#include <openssl/core_dispatch.h>
+#include <openssl/core_names.h>
+#include <openssl/core_object.h>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/obj_mac.h>
+#include <openssl/params.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_logging.h"
+#include "lt_tools_conf.h"
+#include "lt_tools_session.h"
+
+/** @brief Properties of all algorithms of the provider. */
+#define LT_OSSL_PROPS "provider=" LT_OSSL_PROVIDER_NAME
+/** @brief Maximal length of a DER encoded ECDSA signature on P-256. */
+#define LT_OSSL_ECDSA_SIG_LEN_MAX (2 + 2 * (2 + 1 + TR01_ECDSA_SIGN_HASH_LEN))
+/** @brief Length of the uncompressed encoding of a P-256 point. */
+#define LT_OSSL_P256_POINT_LEN (1 + TR01_CURVE_P256_PUBKEY_LEN)
+
+/** @brief Chip with its queue of signing threads. */
+typedef struct lt_ossl_chip_t {
+    lt_tools_chip_t c;     /**< Device and the Secure Session */
+    uint8_t idx;           /**< Index in the configuration file */
+    pthread_mutex_t lock;  /**< Protects the tickets */
+    pthread_cond_t cond;   /**< Signaled when a ticket is served */
+    uint64_t ticket_next;  /**< Ticket of the next thread asking for the chip */
+    uint64_t ticket_owner; /**< Ticket of the thread using the chip */
+} lt_ossl_chip_t;
+
+/** @brief Provider context. */
+typedef struct lt_ossl_ctx_t {
+    const OSSL_CORE_HANDLE *handle; /**< Core handle */
+    OSSL_LIB_CTX *libctx;           /**< Child library context, digests are fetched from it */
+    lt_ossl_chip_t *chips;          /**< Chips */
+    uint8_t chip_cnt;               /**< Number of `chips` */
+} lt_ossl_ctx_t;
+
+/** @brief Key data of both key types. */
+typedef struct lt_ossl_key_t {
+    lt_ossl_ctx_t *ctx;                      /**< Provider context */
+    lt_ecc_curve_type_t curve;               /**< Curve, given by the key management */
+    lt_ossl_chip_t *chip;                    /**< Chip with the private key, NULL for an imported public key */
+    lt_ecc_slot_t slot;                      /**< ECC key slot with the private key */
+    bool has_pub;                            /**< `pub` is set */
+    uint8_t pub[TR01_CURVE_P256_PUBKEY_LEN]; /**< Public key as returned by lt_ecc_key_read() */
+} lt_ossl_key_t;
+
+/** @brief Signature context of both algorithms. */
+typedef struct lt_ossl_sig_t {
+    lt_ossl_ctx_t *ctx; /**< Provider context */
+    char *propq;        /**< Properties to fetch digests with */
+    lt_ossl_key_t *key; /**< Signing key */
+    char mdname[32];    /**< Digest of ECDSA, SHA256 unless set */
+    EVP_MD *md;         /**< Fetched `mdname` while a digest-sign operation runs */
+    EVP_MD_CTX *mdctx;  /**< Hash of the message being signed with EVP_DigestSign*() */
+} lt_ossl_sig_t;
+
+/** @brief Store loader context. */
+typedef struct lt_ossl_store_t {
+    lt_ossl_ctx_t *ctx; /**< Provider context */
+    unsigned long chip; /**< Chip given in the URI */
+    unsigned long slot; /**< ECC key slot given in the URI */
+    bool done;          /**< The key was loaded */
+} lt_ossl_store_t;
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Chips
+
+/** @brief Waits until all threads which asked for the chip earlier are done with it. */
+static void lt_ossl_chip_acquire(lt_ossl_chip_t *chip)
+{
+    pthread_mutex_lock(&chip->lock);
+    uint64_t ticket = chip->ticket_next++;
+    while (ticket != chip->ticket_owner) {
+        pthread_cond_wait(&chip->cond, &chip->lock);
+    }
+    pthread_mutex_unlock(&chip->lock);
+}
+
+/** @brief Passes the chip to the next thread in the queue. */
+static void lt_ossl_chip_release(lt_ossl_chip_t *chip)
+{
+    pthread_mutex_lock(&chip->lock);
+    chip->ticket_owner++;
+    pthread_cond_broadcast(&chip->cond);
+    pthread_mutex_unlock(&chip->lock);
+}
+
+/** @brief Operation executed in the Secure Session by lt_ossl_call(). */
+typedef lt_ret_t (*lt_ossl_op_t)(lt_handle_t *h, void *arg);
+
+/** @brief Runs `op` in the chip's Secure Session after the threads queued before, once more if the session broke. */
+static lt_ret_t lt_ossl_call(lt_ossl_chip_t *chip, lt_ossl_op_t op, void *arg)
+{
+    lt_ret_t ret = LT_FAIL;
+
+    lt_ossl_chip_acquire(chip);
+    for (uint8_t attempt = 0; attempt < 2; attempt++) {
+        ret = lt_tools_session_open(&chip->c.ses);
+        if (ret == LT_OK) {
+            ret = op(&chip->c.h, arg);
+            lt_tools_session_check(&chip->c.ses, ret);
+        }
+        if (!chip->c.ses.restart) {
+            break;
+        }
+        LT_LOG_WARN("Chip %u: Secure Session broken (%s)", chip->idx, lt_ret_verbose(ret));
+    }
+    lt_ossl_chip_release(chip);
+
+    if (ret != LT_OK) {
+        LT_LOG_WARN("Chip %u: command failed: %s", chip->idx, lt_ret_verbose(ret));
+    }
+    return ret;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Key management
+
+static void *lt_ossl_key_new(lt_ossl_ctx_t *ctx, const lt_ecc_curve_type_t curve)
+{
+    lt_ossl_key_t *key = OPENSSL_zalloc(sizeof(lt_ossl_key_t));
+    if (key) {
+        key->ctx = ctx;
+        key->curve = curve;
+    }
+    return key;
+}
+
+static void *lt_ossl_ec_new(void *provctx)
+{
+    return lt_ossl_key_new(provctx, TR01_CURVE_P256);
+}
+
+static void *lt_ossl_ed25519_new(void *provctx)
+{
+    return lt_ossl_key_new(provctx, TR01_CURVE_ED25519);
+}
+
+static void lt_ossl_key_free(void *keydata)
+{
+    OPENSSL_free(keydata);
+}
+
+static void *lt_ossl_key_dup(const void *keydata, int selection)
+{
+    (void)selection;
+    lt_ossl_key_t *key = OPENSSL_malloc(sizeof(lt_ossl_key_t));
+    if (key) {
+        memcpy(key, keydata, sizeof(lt_ossl_key_t));
+    }
+    return key;
+}
+
+/** @brief Takes the key the store loader passed by reference. */
+static void *lt_ossl_key_load(const void *reference, size_t reference_sz)
+{
+    if (!reference || reference_sz != sizeof(lt_ossl_key_t *)) {
+        return NULL;
+    }
+    lt_ossl_key_t **key = (lt_ossl_key_t **)reference;
+    lt_ossl_key_t *taken = *key;
+    *key = NULL;
+
+    return taken;
+}
+
+static size_t lt_ossl_key_pub_len(const lt_ossl_key_t *key)
+{
+    return key->curve == TR01_CURVE_P256 ? TR01_CURVE_P256_PUBKEY_LEN : TR01_CURVE_ED25519_PUBKEY_LEN;
+}
+
+static int lt_ossl_key_has(const void *keydata, int selection)
+{
+    const lt_ossl_key_t *key = keydata;
+
+    if (!key) {
+        return 0;
+    }
+    if ((selection & OSSL_KEYMGMT_SELECT_PUBLIC_KEY) && !key->has_pub) {
+        return 0;
+    }
+    if ((selection & OSSL_KEYMGMT_SELECT_PRIVATE_KEY) && !key->chip) {
+        return 0;
+    }
+    return 1;
+}
+
+static int lt_ossl_key_match(const void *keydata1, const void *keydata2, int selection)
+{
+    const lt_ossl_key_t *key1 = keydata1;
+    const lt_ossl_key_t *key2 = keydata2;
+
+    if (key1->curve != key2->curve) {
+        return 0;
+    }
+    if (selection & OSSL_KEYMGMT_SELECT_KEYPAIR) {
+        // Private keys never leave the chip, keys with the same public key are the same
+        return key1->has_pub && key2->has_pub && memcmp(key1->pub, key2->pub, lt_ossl_key_pub_len(key1)) == 0;
+    }
+    return 1;
+}
+
+/** @brief Encodes the public key as OpenSSL does (uncompressed point for P-256, raw for Ed25519). */
+static size_t lt_ossl_key_pub_encode(const lt_ossl_key_t *key, uint8_t *out)
+{
+    if (key->curve == TR01_CURVE_P256) {
+        out[0] = 0x04;
+        memcpy(&out[1], key->pub, TR01_CURVE_P256_PUBKEY_LEN);
+        return LT_OSSL_P256_POINT_LEN;
+    }
+    memcpy(out, key->pub, TR01_CURVE_ED25519_PUBKEY_LEN);
+    return TR01_CURVE_ED25519_PUBKEY_LEN;
+}
+
+/** @brief Imports a public key, so keys of other providers can be compared with ours. */
+static int lt_ossl_key_import(void *keydata, int selection, const OSSL_PARAM params[])
+{
+    lt_ossl_key_t *key = keydata;
+    const OSSL_PARAM *p;
+
+    if (!key || (selection & OSSL_KEYMGMT_SELECT_PRIVATE_KEY) || !(selection & OSSL_KEYMGMT_SELECT_PUBLIC_KEY)) {
+        return 0;
+    }
+    if (key->curve == TR01_CURVE_P256) {
+        p = OSSL_PARAM_locate_const(params, OSSL_PKEY_PARAM_GROUP_NAME);
+        const char *group;
+        if (p
+            && (!OSSL_PARAM_get_utf8_string_ptr(p, &group)
+                || (strcasecmp(group, SN_X9_62_prime256v1) != 0 && strcasecmp(group, "P-256") != 0))) {
+            return 0;
+        }
+    }
+
+    p = OSSL_PARAM_locate_const(params, OSSL_PKEY_PARAM_PUB_KEY);
+    const void *pub;
+    size_t pub_len;
+    if (!p || !OSSL_PARAM_get_octet_string_ptr(p, &pub, &pub_len)) {
+        return 0;
+    }
+    if (key->curve == TR01_CURVE_P256) {
+        // Only the uncompressed form is accepted, it is what OpenSSL exports
+        if (pub_len != LT_OSSL_P256_POINT_LEN || ((const uint8_t *)pub)[0] != 0x04) {
+            return 0;
+        }
+        memcpy(key->pub, (const uint8_t *)pub + 1, TR01_CURVE_P256_PUBKEY_LEN);
+    }
+    else {
+        if (pub_len != TR01_CURVE_ED25519_PUBKEY_LEN) {
+            return 0;
+        }
+        memcpy(key->pub, pub, TR01_CURVE_ED25519_PUBKEY_LEN);
+    }
+    key->has_pub = true;
+
+    return 1;
+}
+
+static int lt_ossl_key_export(void *keydata, int selection, OSSL_CALLBACK *param_cb, void *cbarg)
+{
+    lt_ossl_key_t *key = keydata;
+    uint8_t pub[LT_OSSL_P256_POINT_LEN];
+    OSSL_PARAM params[3];
+    size_t cnt = 0;
+
+    if (!key || !(selection & OSSL_KEYMGMT_SELECT_ALL)) {
+        return 0;
+    }
+    // Private keys cannot be exported. Failing also requests for the whole key makes OpenSSL use this provider's
+    // signature instead of moving a public-only copy of the key to another provider.
+    if (selection & OSSL_KEYMGMT_SELECT_PRIVATE_KEY) {
+        return 0;
+    }
+    if (key->curve == TR01_CURVE_P256 && (selection & OSSL_KEYMGMT_SELECT_ALL_PARAMETERS)) {
+        params[cnt++] = OSSL_PARAM_construct_utf8_string(OSSL_PKEY_PARAM_GROUP_NAME, SN_X9_62_prime256v1, 0);
+    }
+    if (selection & OSSL_KEYMGMT_SELECT_PUBLIC_KEY) {
+        if (!key->has_pub) {
+            return 0;
+        }
+        params[cnt++]
+            = OSSL_PARAM_construct_octet_string(OSSL_PKEY_PARAM_PUB_KEY, pub, lt_ossl_key_pub_encode(key, pub));
+    }
+    params[cnt] = OSSL_PARAM_construct_end();
+
+    return param_cb(params, cbarg);
+}
+
+static const OSSL_PARAM lt_ossl_ec_key_types[] = {
+    OSSL_PARAM_utf8_string(OSSL_PKEY_PARAM_GROUP_NAME, NULL, 0),
+    OSSL_PARAM_octet_string(OSSL_PKEY_PARAM_PUB_KEY, NULL, 0),
+    OSSL_PARAM_END,
+};
+
+static const OSSL_PARAM lt_ossl_ed25519_key_types[] = {
+    OSSL_PARAM_octet_string(OSSL_PKEY_PARAM_PUB_KEY, NULL, 0),
+    OSSL_PARAM_END,
+};
+
+static const OSSL_PARAM *lt_ossl_ec_key_types_get(int selection)
+{
+    (void)selection;
+    return lt_ossl_ec_key_types;
+}
+
+static const OSSL_PARAM *lt_ossl_ed25519_key_types_get(int selection)
+{
+    (void)selection;
+    return lt_ossl_ed25519_key_types;
+}
+
+static int lt_ossl_key_get_params(void *keydata, OSSL_PARAM params[])
+{
+    lt_ossl_key_t *key = keydata;
+    bool p256 = key->curve == TR01_CURVE_P256;
+    uint8_t pub[LT_OSSL_P256_POINT_LEN];
+    OSSL_PARAM *p;
+
+    if ((p = OSSL_PARAM_locate(params, OSSL_PKEY_PARAM_BITS)) && !OSSL_PARAM_set_int(p, 256)) {
+        return 0;
+    }
+    if ((p = OSSL_PARAM_locate(params, OSSL_PKEY_PARAM_SECURITY_BITS)) && !OSSL_PARAM_set_int(p, 128)) {
+        return 0;
+    }
+    if ((p = OSSL_PARAM_locate(params, OSSL_PKEY_PARAM_MAX_SIZE))
+        && !OSSL_PARAM_set_int(p, p256 ? LT_OSSL_ECDSA_SIG_LEN_MAX : TR01_ECDSA_EDDSA_SIGNATURE_LENGTH)) {
+        return 0;
+    }
+    if (p256) {
+        if ((p = OSSL_PARAM_locate(params, OSSL_PKEY_PARAM_GROUP_NAME))
+            && !OSSL_PARAM_set_utf8_string(p, SN_X9_62_prime256v1)) {
+            return 0;
+        }
+        if ((p = OSSL_PARAM_locate(params, OSSL_PKEY_PARAM_DEFAULT_DIGEST))
+            && !OSSL_PARAM_set_utf8_string(p, "SHA256")) {
+            return 0;
+        }
+        if ((p = OSSL_PARAM_locate(params, OSSL_PKEY_PARAM_EC_POINT_CONVERSION_FORMAT))
+            && !OSSL_PARAM_set_utf8_string(p, "uncompressed")) {
+            return 0;
+        }
+    }
+    else if ((p = OSSL_PARAM_locate(params, OSSL_PKEY_PARAM_MANDATORY_DIGEST)) && !OSSL_PARAM_set_utf8_string(p, "")) {
+        return 0;
+    }
+    if (key->has_pub) {
+        size_t pub_len = lt_ossl_key_pub_encode(key, pub);
+        if ((p = OSSL_PARAM_locate(params, OSSL_PKEY_PARAM_PUB_KEY)) && !OSSL_PARAM_set_octet_string(p, pub, pub_len)) {
+            return 0;
+        }
+        if ((p = OSSL_PARAM_locate(params, OSSL_PKEY_PARAM_ENCODED_PUBLIC_KEY))
+            && !OSSL_PARAM_set_octet_string(p, pub, pub_len)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static const OSSL_PARAM lt_ossl_ec_gettable[] = {
+    OSSL_PARAM_int(OSSL_PKEY_PARAM_BITS, NULL),
+    OSSL_PARAM_int(OSSL_PKEY_PARAM_SECURITY_BITS, NULL),
+    OSSL_PARAM_int(OSSL_PKEY_PARAM_MAX_SIZE, NULL),
+    OSSL_PARAM_utf8_string(OSSL_PKEY_PARAM_GROUP_NAME, NULL, 0),
+    OSSL_PARAM_utf8_string(OSSL_PKEY_PARAM_DEFAULT_DIGEST, NULL, 0),
+    OSSL_PARAM_utf8_string(OSSL_PKEY_PARAM_EC_POINT_CONVERSION_FORMAT, NULL, 0),
+    OSSL_PARAM_octet_string(OSSL_PKEY_PARAM_PUB_KEY, NULL, 0),
+    OSSL_PARAM_octet_string(OSSL_PKEY_PARAM_ENCODED_PUBLIC_KEY, NULL, 0),
+    OSSL_PARAM_END,
+};
+
+static const OSSL_PARAM lt_ossl_ed25519_gettable[] = {
+    OSSL_PARAM_int(OSSL_PKEY_PARAM_BITS, NULL),
+    OSSL_PARAM_int(OSSL_PKEY_PARAM_SECURITY_BITS, NULL),
+    OSSL_PARAM_int(OSSL_PKEY_PARAM_MAX_SIZE, NULL),
+    OSSL_PARAM_utf8_string(OSSL_PKEY_PARAM_MANDATORY_DIGEST, NULL, 0),
+    OSSL_PARAM_octet_string(OSSL_PKEY_PARAM_PUB_KEY, NULL, 0),
+    OSSL_PARAM_octet_string(OSSL_PKEY_PARAM_ENCODED_PUBLIC_KEY, NULL, 0),
+    OSSL_PARAM_END,
+};
+
+static const OSSL_PARAM *lt_ossl_ec_gettable_get(void *provctx)
+{
+    (void)provctx;
+    return lt_ossl_ec_gettable;
+}
+
+static const OSSL_PARAM *lt_ossl_ed25519_gettable_get(void *provctx)
+{
+    (void)provctx;
+    return lt_ossl_ed25519_gettable;
+}
+
+static const char *lt_ossl_ec_operation_name(int operation_id)
+{
+    return operation_id == OSSL_OP_SIGNATURE ? "ECDSA" : NULL;
+}
+
+static const char *lt_ossl_ed25519_operation_name(int operation_id)
+{
+    return operation_id == OSSL_OP_SIGNATURE ? "ED25519" : NULL;
+}
+
+static const OSSL_DISPATCH lt_ossl_ec_keymgmt[] = {
+    {OSSL_FUNC_KEYMGMT_NEW, (void (*)(void))lt_ossl_ec_new},
+    {OSSL_FUNC_KEYMGMT_FREE, (void (*)(void))lt_ossl_key_free},
+    {OSSL_FUNC_KEYMGMT_DUP, (void (*)(void))lt_ossl_key_dup},
+    {OSSL_FUNC_KEYMGMT_LOAD, (void (*)(void))lt_ossl_key_load},
+    {OSSL_FUNC_KEYMGMT_HAS, (void (*)(void))lt_ossl_key_has},
+    {OSSL_FUNC_KEYMGMT_MATCH, (void (*)(void))lt_ossl_key_match},
+    {OSSL_FUNC_KEYMGMT_IMPORT, (void (*)(void))lt_ossl_key_import},
+    {OSSL_FUNC_KEYMGMT_IMPORT_TYPES, (void (*)(void))lt_ossl_ec_key_types_get},
+    {OSSL_FUNC_KEYMGMT_EXPORT, (void (*)(void))lt_ossl_key_export},
+    {OSSL_FUNC_KEYMGMT_EXPORT_TYPES, (void (*)(void))lt_ossl_ec_key_types_get},
+    {OSSL_FUNC_KEYMGMT_GET_PARAMS, (void (*)(void))lt_ossl_key_get_params},
+    {OSSL_FUNC_KEYMGMT_GETTABLE_PARAMS, (void (*)(void))lt_ossl_ec_gettable_get},
+    {OSSL_FUNC_KEYMGMT_QUERY_OPERATION_NAME, (void (*)(void))lt_ossl_ec_operation_name},
+    {0, NULL},
+};
+
+static const OSSL_DISPATCH lt_ossl_ed25519_keymgmt[] = {
+    {OSSL_FUNC_KEYMGMT_NEW, (void (*)(void))lt_ossl_ed25519_new},
+    {OSSL_FUNC_KEYMGMT_FREE, (void (*)(void))lt_ossl_key_free},
+    {OSSL_FUNC_KEYMGMT_DUP, (void (*)(void))lt_ossl_key_dup},
+    {OSSL_FUNC_KEYMGMT_LOAD, (void (*)(void))lt_ossl_key_load},
+    {OSSL_FUNC_KEYMGMT_HAS, (void (*)(void))lt_ossl_key_has},
+    {OSSL_FUNC_KEYMGMT_MATCH, (void (*)(void))lt_ossl_key_match},
+    {OSSL_FUNC_KEYMGMT_IMPORT, (void (*)(void))lt_ossl_key_import},
+    {OSSL_FUNC_KEYMGMT_IMPORT_TYPES, (void (*)(void))lt_ossl_ed25519_key_types_get},
+    {OSSL_FUNC_KEYMGMT_EXPORT, (void (*)(void))lt_ossl_key_export},
+    {OSSL_FUNC_KEYMGMT_EXPORT_TYPES, (void (*)(void))lt_ossl_ed25519_key_types_get},
+    {OSSL_FUNC_KEYMGMT_GET_PARAMS, (void (*)(void))lt_ossl_key_get_params},
+    {OSSL_FUNC_KEYMGMT_GETTABLE_PARAMS, (void (*)(void))lt_ossl_ed25519_gettable_get},
+    {OSSL_FUNC_KEYMGMT_QUERY_OPERATION_NAME, (void (*)(void))lt_ossl_ed25519_operation_name},
+    {0, NULL},
+};
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Signatures
+
+/** @brief Arguments of lt_ossl_sign_op(). */
+typedef struct lt_ossl_sign_arg_t {
+    const lt_ossl_key_t *key; /**< Signing key */
+    const uint8_t *msg;       /**< Hash for ECDSA, message for EdDSA */
+    size_t msg_len;           /**< Length of `msg` */
+    uint8_t *rs;              /**< Signature */
+} lt_ossl_sign_arg_t;
+
+static lt_ret_t lt_ossl_sign_op(lt_handle_t *h, void *arg)
+{
+    lt_ossl_sign_arg_t *sign = arg;
+
+    if (sign->key->curve == TR01_CURVE_ED25519) {
+        return lt_ecc_eddsa_sign(h, sign->key->slot, sign->msg, (uint16_t)sign->msg_len, sign->rs);
+    }
+    return lt_ecc_ecdsa_sign_hash(h, sign->key->slot, sign->msg, sign->rs);
+}
+
+/** @brief Encodes a big-endian unsigned number as DER INTEGER, returns the length. */
+static size_t lt_ossl_der_int(uint8_t *out, const uint8_t *num, size_t len)
+{
+    while (len > 1 && num[0] == 0) {
+        num++;
+        len--;
+    }
+    size_t pad = num[0] & 0x80 ? 1 : 0;
+
+    out[0] = 0x02;
+    out[1] = (uint8_t)(len + pad);
+    out[2] = 0x00;
+    memcpy(&out[2 + pad], num, len);
+
+    return 2 + pad + len;
+}
+
+static void *lt_ossl_sig_new(void *provctx, const char *propq)
+{
+    lt_ossl_sig_t *sig = OPENSSL_zalloc(sizeof(lt_ossl_sig_t));
+    if (!sig) {
+        return NULL;
+    }
+    sig->ctx = provctx;
+    if (propq && !(sig->propq = OPENSSL_strdup(propq))) {
+        OPENSSL_free(sig);
+        return NULL;
+    }
+    snprintf(sig->mdname, sizeof(sig->mdname), "SHA256");
+
+    return sig;
+}
+
+static void lt_ossl_sig_free(void *ctx)
+{
+    lt_ossl_sig_t *sig = ctx;
+    if (!sig) {
+        return;
+    }
+    EVP_MD_CTX_free(sig->mdctx);
+    EVP_MD_free(sig->md);
+    lt_ossl_key_free(sig->key);
+    OPENSSL_free(sig->propq);
+    OPENSSL_free(sig);
+}
+
+static void *lt_ossl_sig_dup(void *ctx)
+{
+    const lt_ossl_sig_t *sig = ctx;
+    lt_ossl_sig_t *dup = lt_ossl_sig_new(sig->ctx, sig->propq);
+    if (!dup) {
+        return NULL;
+    }
+    memcpy(dup->mdname, sig->mdname, sizeof(dup->mdname));
+    bool ok = true;
+    if (sig->key) {
+        ok = (dup->key = lt_ossl_key_dup(sig->key, OSSL_KEYMGMT_SELECT_ALL)) != NULL;
+    }
+    if (ok && sig->md) {
+        ok = EVP_MD_up_ref(sig->md);
+        dup->md = ok ? sig->md : NULL;
+    }
+    if (ok && sig->mdctx) {
+        ok = (dup->mdctx = EVP_MD_CTX_new()) != NULL && EVP_MD_CTX_copy_ex(dup->mdctx, sig->mdctx);
+    }
+    if (!ok) {
+        lt_ossl_sig_free(dup);
+        return NULL;
+    }
+    return dup;
+}
+
+/** @brief Takes a copy of the key, which has to be ours and have the private key on a chip. */
+static int lt_ossl_sig_key_set(lt_ossl_sig_t *sig, void *keydata, const lt_ecc_curve_type_t curve)
+{
+    const lt_ossl_key_t *key = keydata;
+
+    if (!key && sig->key) {
+        // Reinitialization with the same key
+        return 1;
+    }
+    if (!key || !key->chip || key->curve != curve) {
+        return 0;
+    }
+    lt_ossl_key_free(sig->key);
+    sig->key = lt_ossl_key_dup(key, OSSL_KEYMGMT_SELECT_ALL);
+
+    return sig->key != NULL;
+}
+
+static int lt_ossl_sig_set_params(void *ctx, const OSSL_PARAM params[])
+{
+    lt_ossl_sig_t *sig = ctx;
+    const OSSL_PARAM *p = OSSL_PARAM_locate_const(params, OSSL_SIGNATURE_PARAM_DIGEST);
+    if (p) {
+        const char *mdname;
+        // The digest cannot be changed in the middle of EVP_DigestSign*()
+        if (sig->mdctx || !OSSL_PARAM_get_utf8_string_ptr(p, &mdname) || strlen(mdname) >= sizeof(sig->mdname)) {
+            return 0;
+        }
+        snprintf(sig->mdname, sizeof(sig->mdname), "%s", mdname);
+    }
+    return 1;
+}
+
+static const OSSL_PARAM lt_ossl_sig_settable[] = {
+    OSSL_PARAM_utf8_string(OSSL_SIGNATURE_PARAM_DIGEST, NULL, 0),
+    OSSL_PARAM_END,
+};
+
+static const OSSL_PARAM *lt_ossl_sig_settable_get(void *ctx, void *provctx)
+{
+    (void)ctx;
+    (void)provctx;
+    return lt_ossl_sig_settable;
+}
+
+/** @brief DER encoded AlgorithmIdentifier of ECDSA with a digest. */
+typedef struct lt_ossl_algid_t {
+    const char *mdname; /**< Digest */
+    uint8_t der[12];    /**< AlgorithmIdentifier without parameters */
+} lt_ossl_algid_t;
+
+static const lt_ossl_algid_t lt_ossl_ecdsa_algids[] = {
+    {"SHA256", {0x30, 0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x02}},
+    {"SHA384", {0x30, 0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x03}},
+    {"SHA512", {0x30, 0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x04}},
+    {"SHA224", {0x30, 0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x01}},
+};
+
+/** @brief AlgorithmIdentifier of Ed25519, OID 1.3.101.112 without parameters. */
+static const uint8_t lt_ossl_ed25519_algid[] = {0x30, 0x05, 0x06, 0x03, 0x2b, 0x65, 0x70};
+
+static int lt_ossl_ecdsa_get_params(void *ctx, OSSL_PARAM params[])
+{
+    lt_ossl_sig_t *sig = ctx;
+    OSSL_PARAM *p;
+
+    if ((p = OSSL_PARAM_locate(params, OSSL_SIGNATURE_PARAM_DIGEST)) && !OSSL_PARAM_set_utf8_string(p, sig->mdname)) {
+        return 0;
+    }
+    // Certificates and CSRs signed with the key need the AlgorithmIdentifier
+    if ((p = OSSL_PARAM_locate(params, OSSL_SIGNATURE_PARAM_ALGORITHM_ID))) {
+        EVP_MD *md = EVP_MD_fetch(sig->ctx->libctx, sig->mdname, sig->propq);
+        const lt_ossl_algid_t *algid = NULL;
+        for (size_t i = 0; md && i < sizeof(lt_ossl_ecdsa_algids) / sizeof(lt_ossl_ecdsa_algids[0]); i++) {
+            if (EVP_MD_is_a(md, lt_ossl_ecdsa_algids[i].mdname)) {
+                algid = &lt_ossl_ecdsa_algids[i];
+            }
+        }
+        EVP_MD_free(md);
+        if (!algid || !OSSL_PARAM_set_octet_string(p, algid->der, sizeof(algid->der))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int lt_ossl_ed25519_get_params(void *ctx, OSSL_PARAM params[])
+{
+    (void)ctx;
+    OSSL_PARAM *p = OSSL_PARAM_locate(params, OSSL_SIGNATURE_PARAM_ALGORITHM_ID);
+    if (p && !OSSL_PARAM_set_octet_string(p, lt_ossl_ed25519_algid, sizeof(lt_ossl_ed25519_algid))) {
+        return 0;
+    }
+    return 1;
+}
+
+static const OSSL_PARAM lt_ossl_ecdsa_gettable[] = {
+    OSSL_PARAM_utf8_string(OSSL_SIGNATURE_PARAM_DIGEST, NULL, 0),
+    OSSL_PARAM_octet_string(OSSL_SIGNATURE_PARAM_ALGORITHM_ID, NULL, 0),
+    OSSL_PARAM_END,
+};
+
+static const OSSL_PARAM lt_ossl_ed25519_sig_gettable[] = {
+    OSSL_PARAM_octet_string(OSSL_SIGNATURE_PARAM_ALGORITHM_ID, NULL, 0),
+    OSSL_PARAM_END,
+};
+
+static const OSSL_PARAM *lt_ossl_ecdsa_gettable_get(void *ctx, void *provctx)
+{
+    (void)ctx;
+    (void)provctx;
+    return lt_ossl_ecdsa_gettable;
+}
+
+static const OSSL_PARAM *lt_ossl_ed25519_sig_gettable_get(void *ctx, void *provctx)
+{
+    (void)ctx;
+    (void)provctx;
+    return lt_ossl_ed25519_sig_gettable;
+}
+
+static int lt_ossl_ecdsa_sign_init(void *ctx, void *keydata, const OSSL_PARAM params[])
+{
+    lt_ossl_sig_t *sig = ctx;
+    return lt_ossl_sig_key_set(sig, keydata, TR01_CURVE_P256) && lt_ossl_sig_set_params(sig, params);
+}
+
+/** @brief Signs a hash of any length, longer hashes are truncated to the curve order, shorter are left-padded. */
+static int lt_ossl_ecdsa_sign(void *ctx, unsigned char *out, size_t *out_len, size_t out_size,
+                              const unsigned char *tbs, size_t tbs_len)
+{
+    lt_ossl_sig_t *sig = ctx;
+    uint8_t hash[TR01_ECDSA_SIGN_HASH_LEN] = {0};
+    uint8_t rs[TR01_ECDSA_EDDSA_SIGNATURE_LENGTH];
+
+    if (!out) {
+        *out_len = LT_OSSL_ECDSA_SIG_LEN_MAX;
+        return 1;
+    }
+    if (!sig->key || out_size < LT_OSSL_ECDSA_SIG_LEN_MAX || !tbs_len) {
+        return 0;
+    }
+    if (tbs_len >= TR01_ECDSA_SIGN_HASH_LEN) {
+        memcpy(hash, tbs, TR01_ECDSA_SIGN_HASH_LEN);
+    }
+    else {
+        memcpy(&hash[TR01_ECDSA_SIGN_HASH_LEN - tbs_len], tbs, tbs_len);
+    }
+
+    lt_ossl_sign_arg_t arg = {.key = sig->key, .msg = hash, .msg_len = sizeof(hash), .rs = rs};
+    if (lt_ossl_call(sig->key->chip, lt_ossl_sign_op, &arg) != LT_OK) {
+        return 0;
+    }
+
+    size_t len = lt_ossl_der_int(&out[2], rs, TR01_ECDSA_SIGN_HASH_LEN);
+    len += lt_ossl_der_int(&out[2 + len], &rs[TR01_ECDSA_SIGN_HASH_LEN], TR01_ECDSA_SIGN_HASH_LEN);
+    out[0] = 0x30;
+    out[1] = (uint8_t)len;
+    *out_len = len + 2;
+
+    return 1;
+}
+
+static int lt_ossl_ecdsa_digest_sign_init(void *ctx, const char *mdname, void *keydata, const OSSL_PARAM params[])
+{
+    lt_ossl_sig_t *sig = ctx;
+
+    if (!lt_ossl_ecdsa_sign_init(sig, keydata, params)) {
+        return 0;
+    }
+    if (mdname && mdname[0]) {
+        if (strlen(mdname) >= sizeof(sig->mdname)) {
+            return 0;
+        }
+        snprintf(sig->mdname, sizeof(sig->mdname), "%s", mdname);
+    }
+
+    EVP_MD_free(sig->md);
+    sig->md = EVP_MD_fetch(sig->ctx->libctx, sig->mdname, sig->propq);
+    if (!sig->md) {
+        LT_LOG_ERROR("Digest %s is not available", sig->mdname);
+        return 0;
+    }
+    if (!sig->mdctx && !(sig->mdctx = EVP_MD_CTX_new())) {
+        return 0;
+    }
+    return EVP_DigestInit_ex2(sig->mdctx, sig->md, NULL);
+}
+
+static int lt_ossl_ecdsa_digest_sign_update(void *ctx, const unsigned char *data, size_t data_len)
+{
+    lt_ossl_sig_t *sig = ctx;
+    return sig->mdctx && EVP_DigestUpdate(sig->mdctx, data, data_len);
+}
+
+static int lt_ossl_ecdsa_digest_sign_final(void *ctx, unsigned char *out, size_t *out_len, size_t out_size)
+{
+    lt_ossl_sig_t *sig = ctx;
+    uint8_t hash[EVP_MAX_MD_SIZE];
+    unsigned int hash_len;
+
+    if (!sig->mdctx) {
+        return 0;
+    }
+    if (!out) {
+        *out_len = LT_OSSL_ECDSA_SIG_LEN_MAX;
+        return 1;
+    }
+    return EVP_DigestFinal_ex(sig->mdctx, hash, &hash_len)
+           && lt_ossl_ecdsa_sign(sig, out, out_len, out_size, hash, hash_len);
+}
+
+static int lt_ossl_ed25519_digest_sign_init(void *ctx, const char *mdname, void *keydata, const OSSL_PARAM params[])
+{
+    lt_ossl_sig_t *sig = ctx;
+
+    // Ed25519 hashes the message itself (PureEdDSA)
+    if (mdname && mdname[0]) {
+        return 0;
+    }
+    return lt_ossl_sig_key_set(sig, keydata, TR01_CURVE_ED25519) && lt_ossl_sig_set_params(sig, params);
+}
+
+static int lt_ossl_ed25519_digest_sign(void *ctx, unsigned char *out, size_t *out_len, size_t out_size,
+                                       const unsigned char *tbs, size_t tbs_len)
+{
+    lt_ossl_sig_t *sig = ctx;
+
+    if (!out) {
+        *out_len = TR01_ECDSA_EDDSA_SIGNATURE_LENGTH;
+        return 1;
+    }
+    if (!sig->key || out_size < TR01_ECDSA_EDDSA_SIGNATURE_LENGTH || tbs_len > LT_OSSL_PROVIDER_EDDSA_MSG_LEN_MAX) {
+        return 0;
+    }
+
+    lt_ossl_sign_arg_t arg = {.key = sig->key, .msg = tbs, .msg_len = tbs_len, .rs = out};
+    if (lt_ossl_call(sig->key->chip, lt_ossl_sign_op, &arg) != LT_OK) {
+        return 0;
+    }
+    *out_len = TR01_ECDSA_EDDSA_SIGNATURE_LENGTH;
+
+    return 1;
+}
+
+static const OSSL_DISPATCH lt_ossl_ecdsa_signature[] = {
+    {OSSL_FUNC_SIGNATURE_NEWCTX, (void (*)(void))lt_ossl_sig_new},
+    {OSSL_FUNC_SIGNATURE_FREECTX, (void (*)(void))lt_ossl_sig_free},
+    {OSSL_FUNC_SIGNATURE_DUPCTX, (void (*)(void))lt_ossl_sig_dup},
+    {OSSL_FUNC_SIGNATURE_SIGN_INIT, (void (*)(void))lt_ossl_ecdsa_sign_init},
+    {OSSL_FUNC_SIGNATURE_SIGN, (void (*)(void))lt_ossl_ecdsa_sign},
+    {OSSL_FUNC_SIGNATURE_DIGEST_SIGN_INIT, (void (*)(void))lt_ossl_ecdsa_digest_sign_init},
+    {OSSL_FUNC_SIGNATURE_DIGEST_SIGN_UPDATE, (void (*)(void))lt_ossl_ecdsa_digest_sign_update},
+    {OSSL_FUNC_SIGNATURE_DIGEST_SIGN_FINAL, (void (*)(void))lt_ossl_ecdsa_digest_sign_final},
+    {OSSL_FUNC_SIGNATURE_GET_CTX_PARAMS, (void (*)(void))lt_ossl_ecdsa_get_params},
+    {OSSL_FUNC_SIGNATURE_GETTABLE_CTX_PARAMS, (void (*)(void))lt_ossl_ecdsa_gettable_get},
+    {OSSL_FUNC_SIGNATURE_SET_CTX_PARAMS, (void (*)(void))lt_ossl_sig_set_params},
+    {OSSL_FUNC_SIGNATURE_SETTABLE_CTX_PARAMS, (void (*)(void))lt_ossl_sig_settable_get},
+    {0, NULL},
+};
+
+static const OSSL_DISPATCH lt_ossl_ed25519_signature[] = {
+    {OSSL_FUNC_SIGNATURE_NEWCTX, (void (*)(void))lt_ossl_sig_new},
+    {OSSL_FUNC_SIGNATURE_FREECTX, (void (*)(void))lt_ossl_sig_free},
+    {OSSL_FUNC_SIGNATURE_DUPCTX, (void (*)(void))lt_ossl_sig_dup},
+    {OSSL_FUNC_SIGNATURE_DIGEST_SIGN_INIT, (void (*)(void))lt_ossl_ed25519_digest_sign_init},
+    {OSSL_FUNC_SIGNATURE_DIGEST_SIGN, (void (*)(void))lt_ossl_ed25519_digest_sign},
+    {OSSL_FUNC_SIGNATURE_GET_CTX_PARAMS, (void (*)(void))lt_ossl_ed25519_get_params},
+    {OSSL_FUNC_SIGNATURE_GETTABLE_CTX_PARAMS, (void (*)(void))lt_ossl_ed25519_sig_gettable_get},
+    {0, NULL},
+};
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Store loader
+
+/** @brief Parses `slot=<n>[;chip=<n>]` after the scheme, in any order. */
+static bool lt_ossl_uri_parse(const char *uri, lt_ossl_store_t *store)
+{
+    size_t scheme_len = strlen(LT_OSSL_PROVIDER_SCHEME);
+    bool slot_set = false;
+
+    if (strncmp(uri, LT_OSSL_PROVIDER_SCHEME ":", scheme_len + 1) != 0) {
+        return false;
+    }
+    const char *p = uri + scheme_len + 1;
+    while (*p) {
+        unsigned long *value;
+        if (strncmp(p, "slot=", 5) == 0) {
+            value = &store->slot;
+            slot_set = true;
+            p += 5;
+        }
+        else if (strncmp(p, "chip=", 5) == 0) {
+            value = &store->chip;
+            p += 5;
+        }
+        else {
+            return false;
+        }
+        char *end;
+        *value = strtoul(p, &end, 10);
+        if (end == p || (*end != ';' && *end != '\0')) {
+            return false;
+        }
+        p = *end ? end + 1 : end;
+    }
+    return slot_set && store->slot <= TR01_ECC_SLOT_31;
+}
+
+static void *lt_ossl_store_open(void *provctx, const char *uri)
+{
+    lt_ossl_ctx_t *ctx = provctx;
+    lt_ossl_store_t *store = OPENSSL_zalloc(sizeof(lt_ossl_store_t));
+    if (!store) {
+        return NULL;
+    }
+    store->ctx = ctx;
+    if (!lt_ossl_uri_parse(uri, store) || store->chip >= ctx->chip_cnt) {
+        LT_LOG_ERROR("Invalid key URI %s", uri);
+        OPENSSL_free(store);
+        return NULL;
+    }
+    return store;
+}
+
+/** @brief Arguments of lt_ossl_key_read_op(). */
+typedef struct lt_ossl_key_read_arg_t {
+    lt_ossl_key_t *key;        /**< Key with `slot` set */
+    lt_ecc_curve_type_t curve; /**< Curve of the key */
+} lt_ossl_key_read_arg_t;
+
+static lt_ret_t lt_ossl_key_read_op(lt_handle_t *h, void *arg)
+{
+    lt_ossl_key_read_arg_t *read = arg;
+    lt_ecc_key_origin_t origin;
+
+    return lt_ecc_key_read(h, read->key->slot, read->key->pub, sizeof(read->key->pub), &read->curve, &origin);
+}
+
+static int lt_ossl_store_load(void *loaderctx, OSSL_CALLBACK *object_cb, void *object_cbarg,
+                              OSSL_PASSPHRASE_CALLBACK *pw_cb, void *pw_cbarg)
+{
+    (void)pw_cb;
+    (void)pw_cbarg;  // Keys are protected by the pairing key, not by a passphrase
+    lt_ossl_store_t *store = loaderctx;
+    store->done = true;
+
+    lt_ossl_key_t *key = lt_ossl_key_new(store->ctx, TR01_CURVE_P256);
+    if (!key) {
+        return 0;
+    }
+    key->chip = &store->ctx->chips[store->chip];
+    key->slot = (lt_ecc_slot_t)store->slot;
+
+    lt_ossl_key_read_arg_t read = {.key = key};
+    if (lt_ossl_call(key->chip, lt_ossl_key_read_op, &read) != LT_OK) {
+        lt_ossl_key_free(key);
+        return 0;
+    }
+    key->curve = read.curve;
+    key->has_pub = true;
+
+    int type = OSSL_OBJECT_PKEY;
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_int(OSSL_OBJECT_PARAM_TYPE, &type),
+        OSSL_PARAM_construct_utf8_string(OSSL_OBJECT_PARAM_DATA_TYPE,
+                                         key->curve == TR01_CURVE_P256 ? "EC" : "ED25519", 0),
+        OSSL_PARAM_construct_octet_string(OSSL_OBJECT_PARAM_REFERENCE, &key, sizeof(key)),
+        OSSL_PARAM_construct_end(),
+    };
+    int ret = object_cb(params, object_cbarg);
+
+    // The key management took the key, unless loading failed
+    lt_ossl_key_free(key);
+    return ret;
+}
+
+static int lt_ossl_store_eof(void *loaderctx)
+{
+    lt_ossl_store_t *store = loaderctx;
+    return store->done;
+}
+
+static int lt_ossl_store_close(void *loaderctx)
+{
+    OPENSSL_free(loaderctx);
+    return 1;
+}
+
+static int lt_ossl_store_set_params(void *loaderctx, const OSSL_PARAM params[])
+{
+    (void)loaderctx;
+    (void)params;
+    return 1;
+}
+
+static const OSSL_DISPATCH lt_ossl_store[] = {
+    {OSSL_FUNC_STORE_OPEN, (void (*)(void))lt_ossl_store_open},
+    {OSSL_FUNC_STORE_LOAD, (void (*)(void))lt_ossl_store_load},
+    {OSSL_FUNC_STORE_EOF, (void (*)(void))lt_ossl_store_eof},
+    {OSSL_FUNC_STORE_CLOSE, (void (*)(void))lt_ossl_store_close},
+    {OSSL_FUNC_STORE_SET_CTX_PARAMS, (void (*)(void))lt_ossl_store_set_params},
+    {0, NULL},
+};
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Provider
+
+static const OSSL_ALGORITHM lt_ossl_keymgmts[] = {
+    {"EC:id-ecPublicKey:1.2.840.10045.2.1", LT_OSSL_PROPS, lt_ossl_ec_keymgmt, "TROPIC01 P-256 key"},
+    {"ED25519:1.3.101.112", LT_OSSL_PROPS, lt_ossl_ed25519_keymgmt, "TROPIC01 Ed25519 key"},
+    {NULL, NULL, NULL, NULL},
+};
+
+static const OSSL_ALGORITHM lt_ossl_signatures[] = {
+    {"ECDSA", LT_OSSL_PROPS, lt_ossl_ecdsa_signature, "ECDSA with TROPIC01 keys"},
+    {"ED25519:1.3.101.112", LT_OSSL_PROPS, lt_ossl_ed25519_signature, "Ed25519 with TROPIC01 keys"},
+    {NULL, NULL, NULL, NULL},
+};
+
+static const OSSL_ALGORITHM lt_ossl_stores[] = {
+    {LT_OSSL_PROVIDER_SCHEME, LT_OSSL_PROPS, lt_ossl_store, "Keys in TROPIC01 ECC key slots"},
+    {NULL, NULL, NULL, NULL},
+};
+
+static const OSSL_ALGORITHM *lt_ossl_query(void *provctx, int operation_id, int *no_cache)
+{
+    (void)provctx;
+    *no_cache = 0;
+
+    switch (operation_id) {
+        case OSSL_OP_KEYMGMT:
+            return lt_ossl_keymgmts;
+        case OSSL_OP_SIGNATURE:
+            return lt_ossl_signatures;
+        case OSSL_OP_STORE:
+            return lt_ossl_stores;
+        default:
+            return NULL;
+    }
+}
+
+static const OSSL_PARAM lt_ossl_gettable[] = {
+    OSSL_PARAM_utf8_ptr(OSSL_PROV_PARAM_NAME, NULL, 0),
+    OSSL_PARAM_utf8_ptr(OSSL_PROV_PARAM_VERSION, NULL, 0),
+    OSSL_PARAM_utf8_ptr(OSSL_PROV_PARAM_BUILDINFO, NULL, 0),
+    OSSL_PARAM_int(OSSL_PROV_PARAM_STATUS, NULL),
+    OSSL_PARAM_END,
+};
+
+static const OSSL_PARAM *lt_ossl_gettable_get(void *provctx)
+{
+    (void)provctx;
+    return lt_ossl_gettable;
+}
+
+static int lt_ossl_get_params(void *provctx, OSSL_PARAM params[])
+{
+    (void)provctx;
+    OSSL_PARAM *p;
+
+    if ((p = OSSL_PARAM_locate(params, OSSL_PROV_PARAM_NAME)) && !OSSL_PARAM_set_utf8_ptr(p, "TROPIC01 provider")) {
+        return 0;
+    }
+    if ((p = OSSL_PARAM_locate(params, OSSL_PROV_PARAM_VERSION))
+        && !OSSL_PARAM_set_utf8_ptr(p, LT_OSSL_PROVIDER_VERSION)) {
+        return 0;
+    }
+    if ((p = OSSL_PARAM_locate(params, OSSL_PROV_PARAM_BUILDINFO)) && !OSSL_PARAM_set_utf8_ptr(p, "libtropic")) {
+        return 0;
+    }
+    if ((p = OSSL_PARAM_locate(params, OSSL_PROV_PARAM_STATUS)) && !OSSL_PARAM_set_int(p, 1)) {
+        return 0;
+    }
+    return 1;
+}
+
+static lt_tools_chip_t *lt_ossl_chip_place(void *arg, const uint8_t idx)
+{
+    lt_ossl_ctx_t *ctx = arg;
+    return &ctx->chips[idx].c;
+}
+
+static void lt_ossl_teardown(void *provctx)
+{
+    lt_ossl_ctx_t *ctx = provctx;
+
+    for (uint8_t i = 0; i < ctx->chip_cnt; i++) {
+        lt_tools_session_close(&ctx->chips[i].c.ses);
+        pthread_mutex_destroy(&ctx->chips[i].lock);
+        pthread_cond_destroy(&ctx->chips[i].cond);
+    }
+    free(ctx->chips);
+    OSSL_LIB_CTX_free(ctx->libctx);
+    free(ctx);
+}
+
+static const OSSL_DISPATCH lt_ossl_dispatch[] = {
+    {OSSL_FUNC_PROVIDER_TEARDOWN, (void (*)(void))lt_ossl_teardown},
+    {OSSL_FUNC_PROVIDER_GETTABLE_PARAMS, (void (*)(void))lt_ossl_gettable_get},
+    {OSSL_FUNC_PROVIDER_GET_PARAMS, (void (*)(void))lt_ossl_get_params},
+    {OSSL_FUNC_PROVIDER_QUERY_OPERATION, (void (*)(void))lt_ossl_query},
+    {0, NULL},
+};
+
+/** @brief Returns the path of the chip list from the provider's configuration or the environment. */
+static const char *lt_ossl_conf_path(const OSSL_CORE_HANDLE *handle, const OSSL_DISPATCH *in)
+{
+    OSSL_FUNC_core_get_params_fn *core_get_params = NULL;
+    for (; in->function_id; in++) {
+        if (in->function_id == OSSL_FUNC_CORE_GET_PARAMS) {
+            core_get_params = OSSL_FUNC_core_get_params(in);
+        }
+    }
+
+    const char *path = NULL;
+    if (core_get_params) {
+        OSSL_PARAM params[] = {
+            OSSL_PARAM_construct_utf8_ptr(LT_OSSL_PROVIDER_CONF_PARAM, (char **)&path, 0),
+            OSSL_PARAM_construct_end(),
+        };
+        if (!core_get_params(handle, params)) {
+            path = NULL;
+        }
+    }
+    return path ? path : getenv(LT_OSSL_PROVIDER_CONF_ENV);
+}
+
+int OSSL_provider_init(const OSSL_CORE_HANDLE *handle, const OSSL_DISPATCH *in, const OSSL_DISPATCH **out,
+                       void **provctx)
+{
+    const char *path = lt_ossl_conf_path(handle, in);
+    if (!path) {
+        LT_LOG_ERROR("Neither %s nor %s is set", LT_OSSL_PROVIDER_CONF_PARAM, LT_OSSL_PROVIDER_CONF_ENV);
+        return 0;
+    }
+
+    lt_ossl_ctx_t *ctx = calloc(1, sizeof(lt_ossl_ctx_t));
+    if (!ctx) {
+        return 0;
+    }
+    ctx->handle = handle;
+    ctx->chips = calloc(LT_OSSL_PROVIDER_CHIPS_MAX, sizeof(lt_ossl_chip_t));
+    ctx->libctx = OSSL_LIB_CTX_new_child(handle, in);
+    if (!ctx->chips || !ctx->libctx
+        || !lt_tools_conf_load(path, lt_ossl_chip_place, ctx, LT_OSSL_PROVIDER_CHIPS_MAX, &ctx->chip_cnt)) {
+        ctx->chip_cnt = 0;
+        lt_ossl_teardown(ctx);
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < ctx->chip_cnt; i++) {
+        lt_ossl_chip_t *chip = &ctx->chips[i];
+        chip->idx = i;
+        pthread_mutex_init(&chip->lock, NULL);
+        pthread_cond_init(&chip->cond, NULL);
+        // Sessions are started up front, so the first handshakes do not pay for it. A chip which is not available now
+        // is tried again on first use.
+        lt_ret_t ret = lt_tools_session_open(&chip->c.ses);
+        if (ret != LT_OK) {
+            LT_LOG_WARN("Chip %u: cannot start Secure Session: %s", i, lt_ret_verbose(ret));
+        }
+    }
+
+    *out = lt_ossl_dispatch;
+    *provctx = ctx;
+    return 1;
+}
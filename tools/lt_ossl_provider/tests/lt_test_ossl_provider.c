@@ -0,0 +1,412 @@
+/**
+ * @file lt_test_ossl_provider.c
+ * @brief Loads the OpenSSL provider, points it to the model and makes TLS handshakes with its keys
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // mkdtemp(), setenv()
+#endif
+
+#include <openssl/core_names.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/param_build.h>
+#include <openssl/provider.h>
+#include <openssl/sha.h>
+#include <openssl/ssl.h>
+#include <openssl/store.h>
+#include <openssl/x509.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_functional_tests.h"
+#include "libtropic_port_unix_tcp.h"
+#include "lt_ossl_provider.h"
+
+/** @brief Number of threads making handshakes at once. */
+#define LT_TEST_OSSL_THREAD_CNT 4
+/** @brief Number of handshakes made by each thread. */
+#define LT_TEST_OSSL_HANDSHAKE_CNT 8
+
+static lt_dev_unix_tcp_t device;
+static lt_handle_t h;
+static uint8_t p256_pub[TR01_CURVE_P256_PUBKEY_LEN];
+static uint8_t ed25519_pub[TR01_CURVE_ED25519_PUBKEY_LEN];
+static char dir[64];
+
+/** @brief TLS server setup used by the handshaking threads. */
+typedef struct lt_test_ossl_tls_t {
+    SSL_CTX *server;   /**< Server context with the provider's key */
+    SSL_CTX *client;   /**< Client context trusting the server's certificate */
+    int version;       /**< Protocol version of all handshakes */
+    const char *label; /**< Description printed with the results */
+} lt_test_ossl_tls_t;
+
+/** @brief Provisions keys the provider is expected to find. */
+static bool lt_test_ossl_provision(void)
+{
+    lt_ecc_curve_type_t curve;
+    lt_ecc_key_origin_t origin;
+
+    printf("Provisioning keys\n");
+    LT_TEST_TRUE(lt_init(&h) == LT_OK);
+    LT_TEST_TRUE(lt_verify_chip_and_start_secure_session(&h, sh0priv, sh0pub, TR01_PAIRING_KEY_SLOT_INDEX_0) == LT_OK);
+    lt_ecc_key_erase(&h, TR01_ECC_SLOT_0);
+    lt_ecc_key_erase(&h, TR01_ECC_SLOT_1);
+    lt_ecc_key_erase(&h, TR01_ECC_SLOT_2);
+    LT_TEST_TRUE(lt_ecc_key_generate(&h, TR01_ECC_SLOT_0, TR01_CURVE_P256) == LT_OK);
+    LT_TEST_TRUE(lt_ecc_key_generate(&h, TR01_ECC_SLOT_1, TR01_CURVE_ED25519) == LT_OK);
+    LT_TEST_TRUE(lt_ecc_key_read(&h, TR01_ECC_SLOT_0, p256_pub, sizeof(p256_pub), &curve, &origin) == LT_OK);
+    LT_TEST_TRUE(lt_ecc_key_read(&h, TR01_ECC_SLOT_1, ed25519_pub, sizeof(ed25519_pub), &curve, &origin) == LT_OK);
+    lt_session_abort(&h);
+    lt_deinit(&h);
+
+    return true;
+}
+
+static bool lt_test_ossl_file_write(const char *name, const void *data, const size_t len)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *f = fopen(path, "wb");
+    LT_TEST_TRUE(f != NULL);
+    bool ok = fwrite(data, 1, len, f) == len;
+    fclose(f);
+    return ok;
+}
+
+static void lt_test_ossl_files_remove(void)
+{
+    const char *names[] = {"sh0priv.bin", "sh0pub.bin", "lt_ossl_provider.conf"};
+    char path[128];
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        snprintf(path, sizeof(path), "%s/%s", dir, names[i]);
+        unlink(path);
+    }
+    rmdir(dir);
+}
+
+/** @brief Loads a key through the provider's store, returns NULL if there is none. */
+static EVP_PKEY *lt_test_ossl_key_load(const char *uri)
+{
+    EVP_PKEY *pkey = NULL;
+    OSSL_STORE_CTX *store = OSSL_STORE_open(uri, NULL, NULL, NULL, NULL);
+    if (!store) {
+        return NULL;
+    }
+    while (!pkey && !OSSL_STORE_eof(store)) {
+        OSSL_STORE_INFO *info = OSSL_STORE_load(store);
+        if (!info) {
+            break;
+        }
+        if (OSSL_STORE_INFO_get_type(info) == OSSL_STORE_INFO_PKEY) {
+            pkey = OSSL_STORE_INFO_get1_PKEY(info);
+        }
+        OSSL_STORE_INFO_free(info);
+    }
+    OSSL_STORE_close(store);
+
+    return pkey;
+}
+
+/** @brief Makes a public key held by the default provider, used to check the provider's signatures. */
+static EVP_PKEY *lt_test_ossl_pub_make(const bool p256)
+{
+    EVP_PKEY *pkey = NULL;
+    uint8_t point[1 + TR01_CURVE_P256_PUBKEY_LEN] = {0x04};
+
+    if (!p256) {
+        return EVP_PKEY_new_raw_public_key_ex(NULL, "ED25519", "provider=default", ed25519_pub, sizeof(ed25519_pub));
+    }
+    memcpy(&point[1], p256_pub, sizeof(p256_pub));
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_utf8_string(OSSL_PKEY_PARAM_GROUP_NAME, (char *)"prime256v1", 0),
+        OSSL_PARAM_construct_octet_string(OSSL_PKEY_PARAM_PUB_KEY, point, sizeof(point)),
+        OSSL_PARAM_construct_end(),
+    };
+    EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_from_name(NULL, "EC", "provider=default");
+    if (ctx && EVP_PKEY_fromdata_init(ctx) > 0) {
+        EVP_PKEY_fromdata(ctx, &pkey, EVP_PKEY_PUBLIC_KEY, params);
+    }
+    EVP_PKEY_CTX_free(ctx);
+
+    return pkey;
+}
+
+/** @brief Signs a message with the provider's key and verifies the signature with the default provider. */
+static bool lt_test_ossl_sign(EVP_PKEY *pkey, EVP_PKEY *pub, const EVP_MD *md, const uint8_t *msg, const size_t len)
+{
+    uint8_t sig[80];
+    size_t sig_len = sizeof(sig);
+    EVP_MD_CTX *sign_ctx = EVP_MD_CTX_new(), *verify_ctx = EVP_MD_CTX_new();
+
+    bool ok = sign_ctx && verify_ctx && EVP_DigestSignInit(sign_ctx, NULL, md, NULL, pkey) > 0
+              && EVP_DigestSign(sign_ctx, sig, &sig_len, msg, len) > 0;
+    ok = ok && EVP_DigestVerifyInit(verify_ctx, NULL, md, NULL, pub) > 0
+         && EVP_DigestVerify(verify_ctx, sig, sig_len, msg, len) == 1;
+    EVP_MD_CTX_free(sign_ctx);
+    EVP_MD_CTX_free(verify_ctx);
+    LT_TEST_TRUE(ok);
+
+    return true;
+}
+
+static bool lt_test_ossl_p256(EVP_PKEY *pkey)
+{
+    char group[32];
+    uint8_t point[1 + TR01_CURVE_P256_PUBKEY_LEN], msg[300], hash[SHA256_DIGEST_LENGTH], sig[80];
+    size_t len;
+
+    printf("P-256 key\n");
+    LT_TEST_TRUE(EVP_PKEY_is_a(pkey, "EC") && EVP_PKEY_get_bits(pkey) == 256);
+    LT_TEST_TRUE(EVP_PKEY_get_group_name(pkey, group, sizeof(group), NULL) && strcmp(group, "prime256v1") == 0);
+    LT_TEST_TRUE(EVP_PKEY_get_octet_string_param(pkey, OSSL_PKEY_PARAM_PUB_KEY, point, sizeof(point), &len));
+    LT_TEST_TRUE(len == sizeof(point) && point[0] == 0x04 && memcmp(&point[1], p256_pub, sizeof(p256_pub)) == 0);
+    EVP_PKEY *pub = lt_test_ossl_pub_make(true);
+    LT_TEST_TRUE(pub != NULL);
+    bool ok = EVP_PKEY_eq(pkey, pub) == 1;
+
+    printf("ECDSA with SHA-256 and SHA-384\n");
+    for (uint16_t i = 0; i < sizeof(msg); i++) {
+        msg[i] = (uint8_t)i;
+    }
+    ok = ok && lt_test_ossl_sign(pkey, pub, EVP_sha256(), msg, sizeof(msg));
+    ok = ok && lt_test_ossl_sign(pkey, pub, EVP_sha384(), msg, sizeof(msg));
+
+    printf("ECDSA of a hash\n");
+    SHA256(msg, sizeof(msg), hash);
+    len = sizeof(sig);
+    EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_from_pkey(NULL, pkey, NULL);
+    ok = ok && ctx && EVP_PKEY_sign_init(ctx) > 0 && EVP_PKEY_sign(ctx, sig, &len, hash, sizeof(hash)) > 0;
+    EVP_PKEY_CTX_free(ctx);
+    ctx = EVP_PKEY_CTX_new_from_pkey(NULL, pub, NULL);
+    ok = ok && ctx && EVP_PKEY_verify_init(ctx) > 0 && EVP_PKEY_verify(ctx, sig, len, hash, sizeof(hash)) == 1;
+    EVP_PKEY_CTX_free(ctx);
+    EVP_PKEY_free(pub);
+    LT_TEST_TRUE(ok);
+
+    return true;
+}
+
+static bool lt_test_ossl_ed25519(EVP_PKEY *pkey)
+{
+    uint8_t raw[TR01_CURVE_ED25519_PUBKEY_LEN], msg[LT_OSSL_PROVIDER_EDDSA_MSG_LEN_MAX + 1] = {0};
+    size_t len = sizeof(raw);
+
+    printf("Ed25519 key\n");
+    LT_TEST_TRUE(EVP_PKEY_is_a(pkey, "ED25519"));
+    LT_TEST_TRUE(EVP_PKEY_get_raw_public_key(pkey, raw, &len) && len == sizeof(raw));
+    LT_TEST_TRUE(memcmp(raw, ed25519_pub, sizeof(raw)) == 0);
+    EVP_PKEY *pub = lt_test_ossl_pub_make(false);
+    LT_TEST_TRUE(pub != NULL);
+    bool ok = EVP_PKEY_eq(pkey, pub) == 1;
+
+    printf("Ed25519 signatures\n");
+    ok = ok && lt_test_ossl_sign(pkey, pub, NULL, msg, 1);
+    ok = ok && lt_test_ossl_sign(pkey, pub, NULL, msg, LT_OSSL_PROVIDER_EDDSA_MSG_LEN_MAX);
+    EVP_PKEY_free(pub);
+    LT_TEST_TRUE(ok);
+
+    // The chip limits the message length
+    uint8_t sig[TR01_ECDSA_EDDSA_SIGNATURE_LENGTH];
+    len = sizeof(sig);
+    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+    ok = EVP_DigestSignInit(ctx, NULL, NULL, NULL, pkey) > 0 && EVP_DigestSign(ctx, sig, &len, msg, sizeof(msg)) > 0;
+    EVP_MD_CTX_free(ctx);
+    ERR_clear_error();
+    LT_TEST_TRUE(!ok);
+
+    return true;
+}
+
+/** @brief Makes a self-signed certificate of the provider's key. */
+static X509 *lt_test_ossl_cert_make(EVP_PKEY *pkey, const EVP_MD *md)
+{
+    X509 *cert = X509_new();
+    X509_NAME *name = X509_NAME_new();
+
+    bool ok = cert && name
+              && X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *)"localhost", -1, -1, 0)
+              && X509_set_version(cert, X509_VERSION_3) && ASN1_INTEGER_set(X509_get_serialNumber(cert), 1)
+              && X509_set_subject_name(cert, name) && X509_set_issuer_name(cert, name)
+              && X509_gmtime_adj(X509_getm_notBefore(cert), 0)
+              && X509_gmtime_adj(X509_getm_notAfter(cert), 24 * 60 * 60) && X509_set_pubkey(cert, pkey)
+              && X509_sign(cert, pkey, md) > 0;
+    X509_NAME_free(name);
+    // The copy is decoded again, so its public key belongs to the default provider as in certificates read from files
+    X509 *copy = ok ? X509_dup(cert) : NULL;
+    X509_free(cert);
+
+    return copy;
+}
+
+static void *lt_test_ossl_handshaker(void *arg)
+{
+    const lt_test_ossl_tls_t *tls = arg;
+    bool ok = true;
+
+    for (uint16_t i = 0; ok && i < LT_TEST_OSSL_HANDSHAKE_CNT; i++) {
+        SSL *server = SSL_new(tls->server);
+        SSL *client = SSL_new(tls->client);
+        BIO *server_bio, *client_bio;
+        ok = server && client && BIO_new_bio_pair(&server_bio, 0, &client_bio, 0);
+        if (ok) {
+            SSL_set_bio(server, server_bio, server_bio);
+            SSL_set_bio(client, client_bio, client_bio);
+            SSL_set_accept_state(server);
+            SSL_set_connect_state(client);
+        }
+        // The pair is driven from one thread, each side runs until it waits for the other one
+        int server_ret = 0, client_ret = 0;
+        for (uint8_t round = 0; ok && round < 16 && (server_ret != 1 || client_ret != 1); round++) {
+            client_ret = SSL_do_handshake(client);
+            server_ret = SSL_do_handshake(server);
+        }
+        ok = ok && server_ret == 1 && client_ret == 1 && SSL_version(client) == tls->version
+             && SSL_get_verify_result(client) == X509_V_OK;
+        SSL_free(server);
+        SSL_free(client);
+    }
+
+    return (void *)(uintptr_t)ok;
+}
+
+/** @brief Makes handshakes from several threads at once and prints their rate. */
+static bool lt_test_ossl_tls(EVP_PKEY *pkey, X509 *cert, const int version, const char *label)
+{
+    lt_test_ossl_tls_t tls = {.version = version, .label = label};
+    pthread_t threads[LT_TEST_OSSL_THREAD_CNT];
+    struct timespec start, end;
+    bool ok = true;
+
+    printf("%s: %d threads making %d handshakes each\n", label, LT_TEST_OSSL_THREAD_CNT, LT_TEST_OSSL_HANDSHAKE_CNT);
+    tls.server = SSL_CTX_new(TLS_server_method());
+    tls.client = SSL_CTX_new(TLS_client_method());
+    LT_TEST_TRUE(tls.server && tls.client);
+    ok = SSL_CTX_use_certificate(tls.server, cert) && SSL_CTX_use_PrivateKey(tls.server, pkey)
+         && SSL_CTX_check_private_key(tls.server) && SSL_CTX_set_min_proto_version(tls.client, version)
+         && SSL_CTX_set_max_proto_version(tls.client, version)
+         && X509_STORE_add_cert(SSL_CTX_get_cert_store(tls.client), cert);
+    SSL_CTX_set_verify(tls.client, SSL_VERIFY_PEER, NULL);
+    // Every handshake signs, resumption would skip the provider
+    SSL_CTX_set_session_cache_mode(tls.server, SSL_SESS_CACHE_OFF);
+    SSL_CTX_set_options(tls.server, SSL_OP_NO_TICKET);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint16_t started = 0;
+    for (; ok && started < LT_TEST_OSSL_THREAD_CNT; started++) {
+        ok = pthread_create(&threads[started], NULL, lt_test_ossl_handshaker, &tls) == 0;
+    }
+    for (uint16_t i = 0; i < started; i++) {
+        void *res;
+        pthread_join(threads[i], &res);
+        ok = ok && (bool)(uintptr_t)res;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    SSL_CTX_free(tls.server);
+    SSL_CTX_free(tls.client);
+    LT_TEST_TRUE(ok);
+
+    double secs = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%s: %.1f handshakes/s\n", label, LT_TEST_OSSL_THREAD_CNT * LT_TEST_OSSL_HANDSHAKE_CNT / secs);
+
+    return true;
+}
+
+static bool lt_test_ossl_keys(void)
+{
+    char uri[32];
+
+    snprintf(uri, sizeof(uri), "%s:slot=%d", LT_OSSL_PROVIDER_SCHEME, TR01_ECC_SLOT_2);
+    LT_TEST_TRUE(lt_test_ossl_key_load(uri) == NULL);
+    ERR_clear_error();
+    snprintf(uri, sizeof(uri), "%s:slot=%d;chip=1", LT_OSSL_PROVIDER_SCHEME, TR01_ECC_SLOT_0);
+    LT_TEST_TRUE(lt_test_ossl_key_load(uri) == NULL);
+    ERR_clear_error();
+
+    snprintf(uri, sizeof(uri), "%s:slot=%d", LT_OSSL_PROVIDER_SCHEME, TR01_ECC_SLOT_0);
+    EVP_PKEY *p256 = lt_test_ossl_key_load(uri);
+    snprintf(uri, sizeof(uri), "%s:slot=%d;chip=0", LT_OSSL_PROVIDER_SCHEME, TR01_ECC_SLOT_1);
+    EVP_PKEY *ed25519 = lt_test_ossl_key_load(uri);
+    X509 *p256_cert = NULL, *ed25519_cert = NULL;
+    bool ok = p256 && ed25519 && lt_test_ossl_p256(p256) && lt_test_ossl_ed25519(ed25519);
+
+    if (ok) {
+        printf("Self-signed certificates\n");
+        p256_cert = lt_test_ossl_cert_make(p256, EVP_sha256());
+        ed25519_cert = lt_test_ossl_cert_make(ed25519, NULL);
+        ok = p256_cert && ed25519_cert && X509_verify(p256_cert, X509_get0_pubkey(p256_cert)) == 1
+             && X509_verify(ed25519_cert, X509_get0_pubkey(ed25519_cert)) == 1;
+    }
+    ok = ok && lt_test_ossl_tls(p256, p256_cert, TLS1_2_VERSION, "TLS 1.2 ECDSA");
+    ok = ok && lt_test_ossl_tls(p256, p256_cert, TLS1_3_VERSION, "TLS 1.3 ECDSA");
+    ok = ok && lt_test_ossl_tls(ed25519, ed25519_cert, TLS1_3_VERSION, "TLS 1.3 Ed25519");
+
+    X509_free(p256_cert);
+    X509_free(ed25519_cert);
+    EVP_PKEY_free(p256);
+    EVP_PKEY_free(ed25519);
+    LT_TEST_TRUE(ok);
+
+    return true;
+}
+
+static bool lt_test_ossl_run(void)
+{
+    char conf[512];
+
+    snprintf(conf, sizeof(conf), "# Model\n127.0.0.1:%u %s/sh0priv.bin %s/sh0pub.bin 0 model\n", device.port, dir,
+             dir);
+    LT_TEST_TRUE(lt_test_ossl_file_write("sh0priv.bin", sh0priv, TR01_X25519_KEY_LEN));
+    LT_TEST_TRUE(lt_test_ossl_file_write("sh0pub.bin", sh0pub, TR01_X25519_KEY_LEN));
+    LT_TEST_TRUE(lt_test_ossl_file_write("lt_ossl_provider.conf", conf, strlen(conf)));
+    snprintf(conf, sizeof(conf), "%s/lt_ossl_provider.conf", dir);
+    setenv(LT_OSSL_PROVIDER_CONF_ENV, conf, 1);
+
+    // The default provider goes first, see lt_ossl_provider.h
+    printf("Loading %s\n", LT_TEST_OSSL_PROVIDER_MODULE);
+    OSSL_PROVIDER *deflt = OSSL_PROVIDER_load(NULL, "default");
+    OSSL_PROVIDER *prov = OSSL_PROVIDER_load(NULL, LT_TEST_OSSL_PROVIDER_MODULE);
+    LT_TEST_TRUE(deflt && prov);
+
+    bool ok = lt_test_ossl_keys();
+
+    OSSL_PROVIDER_unload(prov);
+    OSSL_PROVIDER_unload(deflt);
+    return ok;
+}
+
+int main(void)
+{
+    if (lt_unix_tcp_target_from_env(&device) != LT_OK) {
+        return EXIT_FAILURE;
+    }
+    device.rng_seed = (unsigned int)time(NULL);
+    h.l2.device = &device;
+
+    snprintf(dir, sizeof(dir), "/tmp/lt_test_ossl_provider.XXXXXX");
+    if (!mkdtemp(dir)) {
+        return EXIT_FAILURE;
+    }
+
+    bool ok = lt_test_ossl_provision() && lt_test_ossl_run();
+    lt_test_ossl_files_remove();
+
+    if (!ok) {
+        // Whatever OpenSSL queued on the failed path tells more than the failed condition alone.
+        ERR_print_errors_fp(stdout);
+    }
+    printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,46 @@
+#ifndef LT_PKCS11_H
+#define LT_PKCS11_H
+
+/**
+ * @file lt_pkcs11.h
+ * @brief PKCS#11 module backed by TROPIC01 chips
+ * @details The module is a shared library implementing PKCS#11 v2.40. Each configured chip is one slot with a token
+ * holding:
+ * - a private and a public key object (CKK_EC on P-256, CKK_EC_EDWARDS on Ed25519) per non-empty ECC key slot,
+ *   labeled `ecc_slot_<n>`, CKA_ID is the slot number (one byte),
+ * - a data object per non-empty R memory slot, labeled `r_mem_slot_<n>`, CKA_VALUE is the content of the slot.
+ *
+ * Supported mechanisms are CKM_ECDSA (the input is the SHA-256 hash), CKM_ECDSA_SHA256 and CKM_EDDSA (without
+ * parameters, messages up to LT_PKCS11_EDDSA_MSG_LEN_MAX bytes). C_GenerateRandom reads TROPIC01's random number
+ * generator. Tokens are write-protected, keys and data are provisioned with libtropic or lt_sessiond.
+ *
+ * The module keeps one Secure Session per chip, shared by all PKCS#11 sessions and threads and started on first use.
+ * Key slots and R memory slots are read on first use as well and their attributes, public keys and contents are
+ * cached until C_Finalize().
+ *
+ * Chips are listed in the file named by environment variable LT_PKCS11_CONF, one chip per line:
+ * @code
+ * # <chip> <pairing_priv_file> <pairing_pub_file> <pairing_key_slot> [<token_label>]
+ * 127.0.0.1:28992 sh0priv.bin sh0pub.bin 0 model
+ * @endcode
+ * The format is described in lt_tools_conf.h, the chip format depends on the port the module was built with
+ * (LT_TOOLS_DEV_SPEC).
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+/** @brief Environment variable with the path of the configuration file. */
+#define LT_PKCS11_CONF_ENV "LT_PKCS11_CONF"
+/** @brief Maximal number of chips (slots). */
+#define LT_PKCS11_CHIPS_MAX 8
+/** @brief Maximal number of PKCS#11 sessions open at once, over all slots. */
+#define LT_PKCS11_SESSIONS_MAX 256
+/** @brief Maximal length of a message signed with CKM_EDDSA, limit of EDDSA_Sign. */
+#define LT_PKCS11_EDDSA_MSG_LEN_MAX 4096
+/** @brief Major version reported by C_GetInfo(). */
+#define LT_PKCS11_VERSION_MAJOR 0
+/** @brief Minor version reported by C_GetInfo(). */
+#define LT_PKCS11_VERSION_MINOR 1
+
+#endif  // LT_PKCS11_H
@@ -0,0 +1,1854 @@
+/**
+ * @file lt_pkcs11.c
+ * @brief PKCS#11 module backed by TROPIC01 chips
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // strtok_r()
+#endif
+
+#include "lt_pkcs11.h"
+
+#include <p11-kit/pkcs11.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_logging.h"
+#include "lt_sha256.h"
+#include "lt_tools_conf.h"
+#include "lt_tools_session.h"
+
+/** @brief Number of ECC key slots. */
+#define LT_PKCS11_ECC_SLOT_CNT (TR01_ECC_SLOT_31 + 1)
+/** @brief Number of R memory slots. */
+#define LT_PKCS11_R_MEM_SLOT_CNT (TR01_R_MEM_DATA_SLOT_MAX + 1)
+/** @brief Number of R memory slots read at once while scanning. */
+#define LT_PKCS11_R_MEM_CHUNK 32
+/** @brief Maximal number of objects on one token. */
+#define LT_PKCS11_OBJECTS_MAX (2 * LT_PKCS11_ECC_SLOT_CNT + LT_PKCS11_R_MEM_SLOT_CNT)
+/** @brief Maximal number of attributes of one object. */
+#define LT_PKCS11_ATTRS_MAX 24
+/** @brief Length of ECDSA and EdDSA signatures. */
+#define LT_PKCS11_SIG_LEN TR01_ECDSA_EDDSA_SIGNATURE_LENGTH
+
+/** @brief Object handle: chip in bits 12+, kind in bits 10-11, slot in bits 0-9, plus one (0 is invalid). */
+#define LT_PKCS11_OBJ(chip, kind, idx) ((CK_OBJECT_HANDLE)((((chip) << 12) | ((kind) << 10) | (idx)) + 1))
+
+/** @brief Kinds of objects. */
+typedef enum lt_pkcs11_kind_t {
+    LT_PKCS11_KIND_PRIV = 0, /**< Private key in an ECC key slot */
+    LT_PKCS11_KIND_PUB,      /**< Public key in an ECC key slot */
+    LT_PKCS11_KIND_DATA      /**< R memory slot */
+} lt_pkcs11_kind_t;
+
+/** @brief Cached ECC key slot. */
+typedef struct lt_pkcs11_key_t {
+    bool present;                                     /**< Slot holds a key */
+    lt_ecc_curve_type_t curve;                        /**< Curve of the key */
+    lt_ecc_key_origin_t origin;                       /**< Origin of the key */
+    uint8_t pub[TR01_CURVE_P256_PUBKEY_LEN];          /**< Public key */
+    uint8_t ec_point[3 + TR01_CURVE_P256_PUBKEY_LEN]; /**< CKA_EC_POINT, DER encoded OCTET STRING */
+    uint8_t ec_point_len;                             /**< Length of `ec_point` */
+} lt_pkcs11_key_t;
+
+/** @brief Cached R memory slot. */
+typedef struct lt_pkcs11_data_t {
+    uint16_t size;                          /**< Size of the content, 0 for an empty slot */
+    uint8_t data[TR01_R_MEM_DATA_SIZE_MAX]; /**< Content */
+} lt_pkcs11_data_t;
+
+/** @brief Chip, one slot with one token. */
+typedef struct lt_pkcs11_chip_t {
+    uint8_t idx;                                     /**< Slot ID */
+    lt_tools_chip_t c;                               /**< Device and the Secure Session shared by all sessions */
+    pthread_mutex_t lock;                            /**< Protects everything below and the handle */
+    bool logged_in;                                  /**< C_Login() was called */
+    uint16_t session_cnt;                            /**< Open PKCS#11 sessions */
+    bool keys_scanned;                               /**< `keys` hold the content of the chip */
+    bool data_scanned;                               /**< `data` hold the content of the chip */
+    lt_pkcs11_key_t keys[LT_PKCS11_ECC_SLOT_CNT];    /**< ECC key slots */
+    lt_pkcs11_data_t data[LT_PKCS11_R_MEM_SLOT_CNT]; /**< R memory slots */
+    /** @brief Stage buffer of lt_batch_run(). */
+    uint8_t stage[LT_SIZE_OF_L3_BUFF] __attribute__((aligned(16)));
+} lt_pkcs11_chip_t;
+
+/** @brief PKCS#11 session. Used by one thread at a time, as required by PKCS#11. */
+typedef struct lt_pkcs11_session_t {
+    bool used;                         /**< Session is open */
+    lt_pkcs11_chip_t *chip;            /**< Chip of the session */
+    CK_FLAGS flags;                    /**< Flags given to C_OpenSession() */
+    bool find_active;                  /**< C_FindObjectsInit() was called */
+    CK_OBJECT_HANDLE *found;           /**< Objects matching the template */
+    CK_ULONG found_cnt;                /**< Number of `found` objects */
+    CK_ULONG found_pos;                /**< Objects already returned */
+    bool sign_active;                  /**< C_SignInit() was called */
+    CK_MECHANISM_TYPE sign_mech;       /**< Signing mechanism */
+    lt_ecc_slot_t sign_slot;           /**< Signing key */
+    struct lt_crypto_sha256_ctx_t sha; /**< Hash of the message for CKM_ECDSA_SHA256 */
+    uint8_t *msg;                      /**< Message for CKM_EDDSA, hash for CKM_ECDSA */
+    uint16_t msg_len;                  /**< Length of `msg` */
+} lt_pkcs11_session_t;
+
+/** @brief Attribute of an object. */
+typedef struct lt_pkcs11_attr_t {
+    CK_ATTRIBUTE_TYPE type; /**< Type */
+    const void *value;      /**< Value, NULL if the attribute is sensitive */
+    CK_ULONG len;           /**< Length of the value */
+} lt_pkcs11_attr_t;
+
+/** @brief Attributes of one object, built from the cache. */
+typedef struct lt_pkcs11_obj_t {
+    lt_pkcs11_attr_t attrs[LT_PKCS11_ATTRS_MAX]; /**< Attributes */
+    CK_ULONG cnt;                                /**< Number of `attrs` */
+    char label[24];                              /**< CKA_LABEL */
+    uint8_t id;                                  /**< CKA_ID */
+    CK_BBOOL local;                              /**< CKA_LOCAL, CKA_ALWAYS_SENSITIVE, CKA_NEVER_EXTRACTABLE */
+} lt_pkcs11_obj_t;
+
+/** @brief Protects the members below. */
+static pthread_mutex_t lt_pkcs11_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool lt_pkcs11_initialized;
+static lt_pkcs11_chip_t *lt_pkcs11_chips;
+static uint8_t lt_pkcs11_chip_cnt;
+static lt_pkcs11_session_t *lt_pkcs11_sessions;
+
+static const CK_BBOOL lt_pkcs11_true = CK_TRUE;
+static const CK_BBOOL lt_pkcs11_false = CK_FALSE;
+static const CK_OBJECT_CLASS lt_pkcs11_class_priv = CKO_PRIVATE_KEY;
+static const CK_OBJECT_CLASS lt_pkcs11_class_pub = CKO_PUBLIC_KEY;
+static const CK_OBJECT_CLASS lt_pkcs11_class_data = CKO_DATA;
+static const CK_KEY_TYPE lt_pkcs11_key_ec = CKK_EC;
+static const CK_KEY_TYPE lt_pkcs11_key_ed = CKK_EC_EDWARDS;
+/** @brief CKA_EC_PARAMS of P-256 keys, OID 1.2.840.10045.3.1.7. */
+static const uint8_t lt_pkcs11_p256_params[] = {0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x03, 0x01, 0x07};
+/** @brief CKA_EC_PARAMS of Ed25519 keys, OID 1.3.101.112. */
+static const uint8_t lt_pkcs11_ed25519_params[] = {0x06, 0x03, 0x2b, 0x65, 0x70};
+static const CK_MECHANISM_TYPE lt_pkcs11_mechs[] = {CKM_ECDSA, CKM_ECDSA_SHA256, CKM_EDDSA};
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Helpers
+
+/** @brief Copies a string into a fixed-length PKCS#11 field, padded with spaces. */
+static void lt_pkcs11_pad(CK_UTF8CHAR *dst, const size_t len, const char *src)
+{
+    size_t src_len = strlen(src);
+    memset(dst, ' ', len);
+    memcpy(dst, src, src_len < len ? src_len : len);
+}
+
+static CK_RV lt_pkcs11_rv(const lt_ret_t ret)
+{
+    switch (ret) {
+        case LT_OK:
+            return CKR_OK;
+        case LT_L3_ECC_INVALID_KEY:
+            return CKR_KEY_HANDLE_INVALID;
+        default:
+            LT_LOG_WARN("Chip command failed: %s", lt_ret_verbose(ret));
+            return CKR_DEVICE_ERROR;
+    }
+}
+
+/** @brief Operation executed in the Secure Session by lt_pkcs11_call(). */
+typedef lt_ret_t (*lt_pkcs11_op_t)(lt_pkcs11_chip_t *chip, void *arg);
+
+/** @brief Runs `op` in the chip's Secure Session, once more if the session broke. Called with the chip locked. */
+static lt_ret_t lt_pkcs11_call(lt_pkcs11_chip_t *chip, lt_pkcs11_op_t op, void *arg)
+{
+    lt_ret_t ret = LT_FAIL;
+
+    for (uint8_t attempt = 0; attempt < 2; attempt++) {
+        ret = lt_tools_session_open(&chip->c.ses);
+        if (ret == LT_OK) {
+            ret = op(chip, arg);
+            lt_tools_session_check(&chip->c.ses, ret);
+        }
+        if (!chip->c.ses.restart) {
+            break;
+        }
+        LT_LOG_WARN("Chip %u: Secure Session broken (%s)", chip->idx, lt_ret_verbose(ret));
+    }
+
+    return ret;
+}
+
+/** @brief Looks up an open session, the caller may use it without holding the global lock. */
+static lt_pkcs11_session_t *lt_pkcs11_session_get(const CK_SESSION_HANDLE handle, CK_RV *rv)
+{
+    lt_pkcs11_session_t *s = NULL;
+
+    pthread_mutex_lock(&lt_pkcs11_lock);
+    if (!lt_pkcs11_initialized) {
+        *rv = CKR_CRYPTOKI_NOT_INITIALIZED;
+    }
+    else if (handle == CK_INVALID_HANDLE || handle > LT_PKCS11_SESSIONS_MAX || !lt_pkcs11_sessions[handle - 1].used) {
+        *rv = CKR_SESSION_HANDLE_INVALID;
+    }
+    else {
+        s = &lt_pkcs11_sessions[handle - 1];
+        *rv = CKR_OK;
+    }
+    pthread_mutex_unlock(&lt_pkcs11_lock);
+
+    return s;
+}
+
+static CK_RV lt_pkcs11_chip_get(const CK_SLOT_ID slot, lt_pkcs11_chip_t **chip)
+{
+    CK_RV rv = CKR_OK;
+
+    pthread_mutex_lock(&lt_pkcs11_lock);
+    if (!lt_pkcs11_initialized) {
+        rv = CKR_CRYPTOKI_NOT_INITIALIZED;
+    }
+    else if (slot >= lt_pkcs11_chip_cnt) {
+        rv = CKR_SLOT_ID_INVALID;
+    }
+    else {
+        *chip = &lt_pkcs11_chips[slot];
+    }
+    pthread_mutex_unlock(&lt_pkcs11_lock);
+
+    return rv;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Cache of the chip's content
+
+static lt_ret_t lt_pkcs11_keys_scan_op(lt_pkcs11_chip_t *chip, void *arg)
+{
+    (void)arg;
+    lt_batch_cmd_t cmds[LT_PKCS11_ECC_SLOT_CNT];
+
+    for (uint8_t i = 0; i < LT_PKCS11_ECC_SLOT_CNT; i++) {
+        lt_pkcs11_key_t *key = &chip->keys[i];
+        cmds[i].id = LT_BATCH_ECC_KEY_READ;
+        cmds[i].args.ecc_key_read.slot = (lt_ecc_slot_t)i;
+        cmds[i].args.ecc_key_read.key = key->pub;
+        cmds[i].args.ecc_key_read.key_max_size = sizeof(key->pub);
+        cmds[i].args.ecc_key_read.curve = &key->curve;
+        cmds[i].args.ecc_key_read.origin = &key->origin;
+    }
+
+    lt_ret_t ret = lt_batch_run(&chip->c.h, cmds, LT_PKCS11_ECC_SLOT_CNT, chip->stage, sizeof(chip->stage), false);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    for (uint8_t i = 0; i < LT_PKCS11_ECC_SLOT_CNT; i++) {
+        lt_pkcs11_key_t *key = &chip->keys[i];
+        if (cmds[i].ret == LT_L3_ECC_INVALID_KEY) {
+            key->present = false;
+            continue;
+        }
+        if (cmds[i].ret != LT_OK) {
+            return cmds[i].ret;
+        }
+
+        key->present = true;
+        key->ec_point[0] = 0x04;  // OCTET STRING
+        if (key->curve == TR01_CURVE_P256) {
+            key->ec_point[1] = 1 + TR01_CURVE_P256_PUBKEY_LEN;
+            key->ec_point[2] = 0x04;  // Uncompressed point
+            memcpy(&key->ec_point[3], key->pub, TR01_CURVE_P256_PUBKEY_LEN);
+            key->ec_point_len = 3 + TR01_CURVE_P256_PUBKEY_LEN;
+        }
+        else {
+            key->ec_point[1] = TR01_CURVE_ED25519_PUBKEY_LEN;
+            memcpy(&key->ec_point[2], key->pub, TR01_CURVE_ED25519_PUBKEY_LEN);
+            key->ec_point_len = 2 + TR01_CURVE_ED25519_PUBKEY_LEN;
+        }
+    }
+
+    return LT_OK;
+}
+
+static lt_ret_t lt_pkcs11_data_scan_op(lt_pkcs11_chip_t *chip, void *arg)
+{
+    (void)arg;
+    lt_r_mem_data_rd_t rd[LT_PKCS11_R_MEM_CHUNK];
+
+    for (uint16_t first = 0; first < LT_PKCS11_R_MEM_SLOT_CNT; first += LT_PKCS11_R_MEM_CHUNK) {
+        for (uint16_t i = 0; i < LT_PKCS11_R_MEM_CHUNK; i++) {
+            rd[i].data = chip->data[first + i].data;
+            rd[i].data_max_size = TR01_R_MEM_DATA_SIZE_MAX;
+        }
+
+        lt_ret_t ret = lt_r_mem_data_read_range(&chip->c.h, first, LT_PKCS11_R_MEM_CHUNK, rd);
+        if (ret != LT_OK) {
+            return ret;
+        }
+
+        for (uint16_t i = 0; i < LT_PKCS11_R_MEM_CHUNK; i++) {
+            if (rd[i].ret == LT_L3_R_MEM_DATA_READ_SLOT_EMPTY) {
+                chip->data[first + i].size = 0;
+            }
+            else if (rd[i].ret == LT_OK) {
+                chip->data[first + i].size = rd[i].data_read_size;
+            }
+            else {
+                return rd[i].ret;
+            }
+        }
+    }
+
+    return LT_OK;
+}
+
+/** @brief Reads ECC key slots and/or R memory slots, unless cached. Called with the chip locked. */
+static CK_RV lt_pkcs11_scan(lt_pkcs11_chip_t *chip, const bool keys, const bool data)
+{
+    lt_ret_t ret;
+
+    if (keys && !chip->keys_scanned) {
+        ret = lt_pkcs11_call(chip, lt_pkcs11_keys_scan_op, NULL);
+        if (ret != LT_OK) {
+            return lt_pkcs11_rv(ret);
+        }
+        chip->keys_scanned = true;
+    }
+    if (data && !chip->data_scanned) {
+        ret = lt_pkcs11_call(chip, lt_pkcs11_data_scan_op, NULL);
+        if (ret != LT_OK) {
+            return lt_pkcs11_rv(ret);
+        }
+        chip->data_scanned = true;
+    }
+
+    return CKR_OK;
+}
+
+/** @brief Decodes an object handle of the chip and checks the object exists. Called with the chip locked. */
+static CK_RV lt_pkcs11_obj_find(lt_pkcs11_chip_t *chip, const CK_OBJECT_HANDLE handle, lt_pkcs11_kind_t *kind,
+                                uint16_t *idx)
+{
+    if (handle == CK_INVALID_HANDLE || ((handle - 1) >> 12) != chip->idx) {
+        return CKR_OBJECT_HANDLE_INVALID;
+    }
+    *kind = (lt_pkcs11_kind_t)(((handle - 1) >> 10) & 0x3);
+    *idx = (uint16_t)((handle - 1) & 0x3ff);
+
+    if (*kind == LT_PKCS11_KIND_DATA) {
+        if (*idx >= LT_PKCS11_R_MEM_SLOT_CNT) {
+            return CKR_OBJECT_HANDLE_INVALID;
+        }
+        CK_RV rv = lt_pkcs11_scan(chip, false, true);
+        if (rv != CKR_OK) {
+            return rv;
+        }
+        return chip->data[*idx].size ? CKR_OK : CKR_OBJECT_HANDLE_INVALID;
+    }
+
+    if (*kind > LT_PKCS11_KIND_DATA || *idx >= LT_PKCS11_ECC_SLOT_CNT) {
+        return CKR_OBJECT_HANDLE_INVALID;
+    }
+    CK_RV rv = lt_pkcs11_scan(chip, true, false);
+    if (rv != CKR_OK) {
+        return rv;
+    }
+    return chip->keys[*idx].present ? CKR_OK : CKR_OBJECT_HANDLE_INVALID;
+}
+
+static void lt_pkcs11_attr_add(lt_pkcs11_obj_t *o, const CK_ATTRIBUTE_TYPE type, const void *value, const CK_ULONG len)
+{
+    o->attrs[o->cnt].type = type;
+    o->attrs[o->cnt].value = value;
+    o->attrs[o->cnt].len = len;
+    o->cnt++;
+}
+
+/** @brief Builds attributes of an existing object. Called with the chip locked, valid until it is unlocked. */
+static void lt_pkcs11_obj_build(const lt_pkcs11_chip_t *chip, const lt_pkcs11_kind_t kind, const uint16_t idx,
+                                lt_pkcs11_obj_t *o)
+{
+    o->cnt = 0;
+    lt_pkcs11_attr_add(o, CKA_TOKEN, &lt_pkcs11_true, sizeof(CK_BBOOL));
+    lt_pkcs11_attr_add(o, CKA_PRIVATE, &lt_pkcs11_false, sizeof(CK_BBOOL));
+    lt_pkcs11_attr_add(o, CKA_MODIFIABLE, &lt_pkcs11_false, sizeof(CK_BBOOL));
+
+    if (kind == LT_PKCS11_KIND_DATA) {
+        snprintf(o->label, sizeof(o->label), "r_mem_slot_%u", idx);
+        lt_pkcs11_attr_add(o, CKA_CLASS, &lt_pkcs11_class_data, sizeof(CK_OBJECT_CLASS));
+        lt_pkcs11_attr_add(o, CKA_LABEL, o->label, strlen(o->label));
+        lt_pkcs11_attr_add(o, CKA_APPLICATION, "", 0);
+        lt_pkcs11_attr_add(o, CKA_OBJECT_ID, "", 0);
+        lt_pkcs11_attr_add(o, CKA_VALUE, chip->data[idx].data, chip->data[idx].size);
+        return;
+    }
+
+    const lt_pkcs11_key_t *key = &chip->keys[idx];
+    bool p256 = key->curve == TR01_CURVE_P256;
+    snprintf(o->label, sizeof(o->label), "ecc_slot_%u", idx);
+    o->id = (uint8_t)idx;
+    o->local = key->origin == TR01_CURVE_GENERATED ? CK_TRUE : CK_FALSE;
+
+    lt_pkcs11_attr_add(o, CKA_LABEL, o->label, strlen(o->label));
+    lt_pkcs11_attr_add(o, CKA_ID, &o->id, sizeof(o->id));
+    lt_pkcs11_attr_add(o, CKA_KEY_TYPE, p256 ? &lt_pkcs11_key_ec : &lt_pkcs11_key_ed, sizeof(CK_KEY_TYPE));
+    lt_pkcs11_attr_add(o, CKA_EC_PARAMS, p256 ? lt_pkcs11_p256_params : lt_pkcs11_ed25519_params,
+                       p256 ? sizeof(lt_pkcs11_p256_params) : sizeof(lt_pkcs11_ed25519_params));
+    lt_pkcs11_attr_add(o, CKA_EC_POINT, key->ec_point, key->ec_point_len);
+    lt_pkcs11_attr_add(o, CKA_LOCAL, &o->local, sizeof(CK_BBOOL));
+    lt_pkcs11_attr_add(o, CKA_DERIVE, &lt_pkcs11_false, sizeof(CK_BBOOL));
+
+    if (kind == LT_PKCS11_KIND_PRIV) {
+        lt_pkcs11_attr_add(o, CKA_CLASS, &lt_pkcs11_class_priv, sizeof(CK_OBJECT_CLASS));
+        lt_pkcs11_attr_add(o, CKA_SIGN, &lt_pkcs11_true, sizeof(CK_BBOOL));
+        lt_pkcs11_attr_add(o, CKA_SIGN_RECOVER, &lt_pkcs11_false, sizeof(CK_BBOOL));
+        lt_pkcs11_attr_add(o, CKA_DECRYPT, &lt_pkcs11_false, sizeof(CK_BBOOL));
+        lt_pkcs11_attr_add(o, CKA_UNWRAP, &lt_pkcs11_false, sizeof(CK_BBOOL));
+        lt_pkcs11_attr_add(o, CKA_SENSITIVE, &lt_pkcs11_true, sizeof(CK_BBOOL));
+        lt_pkcs11_attr_add(o, CKA_EXTRACTABLE, &lt_pkcs11_false, sizeof(CK_BBOOL));
+        lt_pkcs11_attr_add(o, CKA_ALWAYS_SENSITIVE, &o->local, sizeof(CK_BBOOL));
+        lt_pkcs11_attr_add(o, CKA_NEVER_EXTRACTABLE, &o->local, sizeof(CK_BBOOL));
+        lt_pkcs11_attr_add(o, CKA_ALWAYS_AUTHENTICATE, &lt_pkcs11_false, sizeof(CK_BBOOL));
+        lt_pkcs11_attr_add(o, CKA_VALUE, NULL, 0);
+    }
+    else {
+        lt_pkcs11_attr_add(o, CKA_CLASS, &lt_pkcs11_class_pub, sizeof(CK_OBJECT_CLASS));
+        lt_pkcs11_attr_add(o, CKA_VERIFY, &lt_pkcs11_true, sizeof(CK_BBOOL));
+        lt_pkcs11_attr_add(o, CKA_VERIFY_RECOVER, &lt_pkcs11_false, sizeof(CK_BBOOL));
+        lt_pkcs11_attr_add(o, CKA_ENCRYPT, &lt_pkcs11_false, sizeof(CK_BBOOL));
+        lt_pkcs11_attr_add(o, CKA_WRAP, &lt_pkcs11_false, sizeof(CK_BBOOL));
+        lt_pkcs11_attr_add(o, CKA_TRUSTED, &lt_pkcs11_false, sizeof(CK_BBOOL));
+    }
+}
+
+static const lt_pkcs11_attr_t *lt_pkcs11_attr_find(const lt_pkcs11_obj_t *o, const CK_ATTRIBUTE_TYPE type)
+{
+    for (CK_ULONG i = 0; i < o->cnt; i++) {
+        if (o->attrs[i].type == type) {
+            return &o->attrs[i];
+        }
+    }
+    return NULL;
+}
+
+static bool lt_pkcs11_obj_match(const lt_pkcs11_obj_t *o, const CK_ATTRIBUTE *templ, const CK_ULONG cnt)
+{
+    for (CK_ULONG i = 0; i < cnt; i++) {
+        const lt_pkcs11_attr_t *attr = lt_pkcs11_attr_find(o, templ[i].type);
+        if (!attr || !attr->value || attr->len != templ[i].ulValueLen
+            || (attr->len && memcmp(attr->value, templ[i].pValue, attr->len) != 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+// General purpose functions
+
+static lt_tools_chip_t *lt_pkcs11_chip_place(void *arg, const uint8_t idx)
+{
+    (void)arg;
+    return &lt_pkcs11_chips[idx].c;
+}
+
+static CK_RV lt_pkcs11_conf_load(void)
+{
+    const char *path = getenv(LT_PKCS11_CONF_ENV);
+    if (!path) {
+        LT_LOG_ERROR("%s is not set", LT_PKCS11_CONF_ENV);
+        return CKR_GENERAL_ERROR;
+    }
+    if (!lt_tools_conf_load(path, lt_pkcs11_chip_place, NULL, LT_PKCS11_CHIPS_MAX, &lt_pkcs11_chip_cnt)) {
+        lt_pkcs11_chip_cnt = 0;
+        return CKR_GENERAL_ERROR;
+    }
+    for (uint8_t i = 0; i < lt_pkcs11_chip_cnt; i++) {
+        lt_pkcs11_chips[i].idx = i;
+        pthread_mutex_init(&lt_pkcs11_chips[i].lock, NULL);
+    }
+
+    return CKR_OK;
+}
+
+/** @brief Releases everything, called with the global lock held. */
+static void lt_pkcs11_cleanup(void)
+{
+    if (lt_pkcs11_sessions) {
+        for (uint16_t i = 0; i < LT_PKCS11_SESSIONS_MAX; i++) {
+            free(lt_pkcs11_sessions[i].found);
+            free(lt_pkcs11_sessions[i].msg);
+        }
+        free(lt_pkcs11_sessions);
+        lt_pkcs11_sessions = NULL;
+    }
+    if (lt_pkcs11_chips) {
+        for (uint8_t i = 0; i < lt_pkcs11_chip_cnt; i++) {
+            lt_tools_session_close(&lt_pkcs11_chips[i].c.ses);
+            pthread_mutex_destroy(&lt_pkcs11_chips[i].lock);
+        }
+        free(lt_pkcs11_chips);
+        lt_pkcs11_chips = NULL;
+    }
+    lt_pkcs11_chip_cnt = 0;
+}
+
+CK_RV C_Initialize(CK_VOID_PTR pInitArgs)
+{
+    if (pInitArgs) {
+        CK_C_INITIALIZE_ARGS *args = (CK_C_INITIALIZE_ARGS *)pInitArgs;
+        if (args->pReserved) {
+            return CKR_ARGUMENTS_BAD;
+        }
+        bool custom = args->CreateMutex || args->DestroyMutex || args->LockMutex || args->UnlockMutex;
+        if (custom && !(args->CreateMutex && args->DestroyMutex && args->LockMutex && args->UnlockMutex)) {
+            return CKR_ARGUMENTS_BAD;
+        }
+        // Only native locking is implemented, it can be used instead of the application's mutexes if allowed
+        if (custom && !(args->flags & CKF_OS_LOCKING_OK)) {
+            return CKR_CANT_LOCK;
+        }
+    }
+
+    pthread_mutex_lock(&lt_pkcs11_lock);
+    if (lt_pkcs11_initialized) {
+        pthread_mutex_unlock(&lt_pkcs11_lock);
+        return CKR_CRYPTOKI_ALREADY_INITIALIZED;
+    }
+
+    CK_RV rv = CKR_HOST_MEMORY;
+    lt_pkcs11_chips = calloc(LT_PKCS11_CHIPS_MAX, sizeof(lt_pkcs11_chip_t));
+    lt_pkcs11_sessions = calloc(LT_PKCS11_SESSIONS_MAX, sizeof(lt_pkcs11_session_t));
+    if (lt_pkcs11_chips && lt_pkcs11_sessions) {
+        rv = lt_pkcs11_conf_load();
+    }
+    if (rv == CKR_OK) {
+        lt_pkcs11_initialized = true;
+    }
+    else {
+        lt_pkcs11_cleanup();
+    }
+    pthread_mutex_unlock(&lt_pkcs11_lock);
+
+    return rv;
+}
+
+CK_RV C_Finalize(CK_VOID_PTR pReserved)
+{
+    if (pReserved) {
+        return CKR_ARGUMENTS_BAD;
+    }
+
+    pthread_mutex_lock(&lt_pkcs11_lock);
+    if (!lt_pkcs11_initialized) {
+        pthread_mutex_unlock(&lt_pkcs11_lock);
+        return CKR_CRYPTOKI_NOT_INITIALIZED;
+    }
+    lt_pkcs11_initialized = false;
+    lt_pkcs11_cleanup();
+    pthread_mutex_unlock(&lt_pkcs11_lock);
+
+    return CKR_OK;
+}
+
+CK_RV C_GetInfo(CK_INFO_PTR pInfo)
+{
+    if (!pInfo) {
+        return CKR_ARGUMENTS_BAD;
+    }
+    pthread_mutex_lock(&lt_pkcs11_lock);
+    bool initialized = lt_pkcs11_initialized;
+    pthread_mutex_unlock(&lt_pkcs11_lock);
+    if (!initialized) {
+        return CKR_CRYPTOKI_NOT_INITIALIZED;
+    }
+
+    memset(pInfo, 0, sizeof(*pInfo));
+    pInfo->cryptokiVersion.major = CRYPTOKI_VERSION_MAJOR;
+    pInfo->cryptokiVersion.minor = CRYPTOKI_VERSION_MINOR;
+    lt_pkcs11_pad(pInfo->manufacturerID, sizeof(pInfo->manufacturerID), "Tropic Square");
+    lt_pkcs11_pad(pInfo->libraryDescription, sizeof(pInfo->libraryDescription), "libtropic PKCS#11 module");
+    pInfo->libraryVersion.major = LT_PKCS11_VERSION_MAJOR;
+    pInfo->libraryVersion.minor = LT_PKCS11_VERSION_MINOR;
+
+    return CKR_OK;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Slot and token management
+
+CK_RV C_GetSlotList(CK_BBOOL tokenPresent, CK_SLOT_ID_PTR pSlotList, CK_ULONG_PTR pulCount)
+{
+    (void)tokenPresent;  // Tokens are always present
+    if (!pulCount) {
+        return CKR_ARGUMENTS_BAD;
+    }
+
+    CK_RV rv = CKR_OK;
+    pthread_mutex_lock(&lt_pkcs11_lock);
+    if (!lt_pkcs11_initialized) {
+        rv = CKR_CRYPTOKI_NOT_INITIALIZED;
+    }
+    else if (pSlotList && *pulCount < lt_pkcs11_chip_cnt) {
+        rv = CKR_BUFFER_TOO_SMALL;
+    }
+    else if (pSlotList) {
+        for (uint8_t i = 0; i < lt_pkcs11_chip_cnt; i++) {
+            pSlotList[i] = i;
+        }
+    }
+    if (rv != CKR_CRYPTOKI_NOT_INITIALIZED) {
+        *pulCount = lt_pkcs11_chip_cnt;
+    }
+    pthread_mutex_unlock(&lt_pkcs11_lock);
+
+    return rv;
+}
+
+CK_RV C_GetSlotInfo(CK_SLOT_ID slotID, CK_SLOT_INFO_PTR pInfo)
+{
+    lt_pkcs11_chip_t *chip;
+    CK_RV rv = lt_pkcs11_chip_get(slotID, &chip);
+    if (rv != CKR_OK) {
+        return rv;
+    }
+    if (!pInfo) {
+        return CKR_ARGUMENTS_BAD;
+    }
+
+    memset(pInfo, 0, sizeof(*pInfo));
+    lt_pkcs11_pad(pInfo->slotDescription, sizeof(pInfo->slotDescription), chip->c.label);
+    lt_pkcs11_pad(pInfo->manufacturerID, sizeof(pInfo->manufacturerID), "Tropic Square");
+    pInfo->flags = CKF_TOKEN_PRESENT | CKF_HW_SLOT;
+
+    return CKR_OK;
+}
+
+CK_RV C_GetTokenInfo(CK_SLOT_ID slotID, CK_TOKEN_INFO_PTR pInfo)
+{
+    lt_pkcs11_chip_t *chip;
+    CK_RV rv = lt_pkcs11_chip_get(slotID, &chip);
+    if (rv != CKR_OK) {
+        return rv;
+    }
+    if (!pInfo) {
+        return CKR_ARGUMENTS_BAD;
+    }
+
+    char serial[17];
+    snprintf(serial, sizeof(serial), "%u", chip->idx);
+    memset(pInfo, 0, sizeof(*pInfo));
+    lt_pkcs11_pad(pInfo->label, sizeof(pInfo->label), chip->c.label);
+    lt_pkcs11_pad(pInfo->manufacturerID, sizeof(pInfo->manufacturerID), "Tropic Square");
+    lt_pkcs11_pad(pInfo->model, sizeof(pInfo->model), "TROPIC01");
+    lt_pkcs11_pad(pInfo->serialNumber, sizeof(pInfo->serialNumber), serial);
+    lt_pkcs11_pad(pInfo->utcTime, sizeof(pInfo->utcTime), "");
+    pInfo->flags = CKF_RNG | CKF_WRITE_PROTECTED | CKF_TOKEN_INITIALIZED;
+    pInfo->ulMaxSessionCount = CK_EFFECTIVELY_INFINITE;
+    pInfo->ulMaxRwSessionCount = 0;
+    pInfo->ulTotalPublicMemory = CK_UNAVAILABLE_INFORMATION;
+    pInfo->ulFreePublicMemory = CK_UNAVAILABLE_INFORMATION;
+    pInfo->ulTotalPrivateMemory = CK_UNAVAILABLE_INFORMATION;
+    pInfo->ulFreePrivateMemory = CK_UNAVAILABLE_INFORMATION;
+
+    pthread_mutex_lock(&chip->lock);
+    pInfo->ulSessionCount = chip->session_cnt;
+    pthread_mutex_unlock(&chip->lock);
+
+    return CKR_OK;
+}
+
+CK_RV C_WaitForSlotEvent(CK_FLAGS flags, CK_SLOT_ID_PTR pSlot, CK_VOID_PTR pReserved)
+{
+    (void)flags;
+    (void)pSlot;
+    (void)pReserved;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_GetMechanismList(CK_SLOT_ID slotID, CK_MECHANISM_TYPE_PTR pMechanismList, CK_ULONG_PTR pulCount)
+{
+    lt_pkcs11_chip_t *chip;
+    CK_RV rv = lt_pkcs11_chip_get(slotID, &chip);
+    if (rv != CKR_OK) {
+        return rv;
+    }
+    if (!pulCount) {
+        return CKR_ARGUMENTS_BAD;
+    }
+
+    CK_ULONG cnt = sizeof(lt_pkcs11_mechs) / sizeof(lt_pkcs11_mechs[0]);
+    if (pMechanismList) {
+        if (*pulCount < cnt) {
+            rv = CKR_BUFFER_TOO_SMALL;
+        }
+        else {
+            memcpy(pMechanismList, lt_pkcs11_mechs, sizeof(lt_pkcs11_mechs));
+        }
+    }
+    *pulCount = cnt;
+
+    return rv;
+}
+
+CK_RV C_GetMechanismInfo(CK_SLOT_ID slotID, CK_MECHANISM_TYPE type, CK_MECHANISM_INFO_PTR pInfo)
+{
+    lt_pkcs11_chip_t *chip;
+    CK_RV rv = lt_pkcs11_chip_get(slotID, &chip);
+    if (rv != CKR_OK) {
+        return rv;
+    }
+    if (!pInfo) {
+        return CKR_ARGUMENTS_BAD;
+    }
+
+    pInfo->ulMinKeySize = 256;
+    pInfo->ulMaxKeySize = 256;
+    switch (type) {
+        case CKM_ECDSA:
+        case CKM_ECDSA_SHA256:
+            pInfo->flags = CKF_HW | CKF_SIGN | CKF_EC_F_P | CKF_EC_NAMEDCURVE | CKF_EC_UNCOMPRESS;
+            return CKR_OK;
+        case CKM_EDDSA:
+            pInfo->ulMinKeySize = 255;
+            pInfo->ulMaxKeySize = 255;
+            pInfo->flags = CKF_HW | CKF_SIGN;
+            return CKR_OK;
+        default:
+            return CKR_MECHANISM_INVALID;
+    }
+}
+
+CK_RV C_InitToken(CK_SLOT_ID slotID, CK_UTF8CHAR_PTR pPin, CK_ULONG ulPinLen, CK_UTF8CHAR_PTR pLabel)
+{
+    (void)slotID;
+    (void)pPin;
+    (void)ulPinLen;
+    (void)pLabel;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_InitPIN(CK_SESSION_HANDLE hSession, CK_UTF8CHAR_PTR pPin, CK_ULONG ulPinLen)
+{
+    (void)hSession;
+    (void)pPin;
+    (void)ulPinLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_SetPIN(CK_SESSION_HANDLE hSession, CK_UTF8CHAR_PTR pOldPin, CK_ULONG ulOldLen, CK_UTF8CHAR_PTR pNewPin,
+               CK_ULONG ulNewLen)
+{
+    (void)hSession;
+    (void)pOldPin;
+    (void)ulOldLen;
+    (void)pNewPin;
+    (void)ulNewLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Session management
+
+CK_RV C_OpenSession(CK_SLOT_ID slotID, CK_FLAGS flags, CK_VOID_PTR pApplication, CK_NOTIFY Notify,
+                    CK_SESSION_HANDLE_PTR phSession)
+{
+    (void)pApplication;
+    (void)Notify;  // Callbacks are never made
+    lt_pkcs11_chip_t *chip;
+    CK_RV rv = lt_pkcs11_chip_get(slotID, &chip);
+    if (rv != CKR_OK) {
+        return rv;
+    }
+    if (!phSession) {
+        return CKR_ARGUMENTS_BAD;
+    }
+    if (!(flags & CKF_SERIAL_SESSION)) {
+        return CKR_SESSION_PARALLEL_NOT_SUPPORTED;
+    }
+    if (flags & CKF_RW_SESSION) {
+        return CKR_TOKEN_WRITE_PROTECTED;
+    }
+
+    rv = CKR_SESSION_COUNT;
+    pthread_mutex_lock(&lt_pkcs11_lock);
+    for (uint16_t i = 0; i < LT_PKCS11_SESSIONS_MAX; i++) {
+        lt_pkcs11_session_t *s = &lt_pkcs11_sessions[i];
+        if (!s->used) {
+            memset(s, 0, sizeof(*s));
+            s->used = true;
+            s->chip = chip;
+            s->flags = flags;
+            *phSession = (CK_SESSION_HANDLE)i + 1;
+            rv = CKR_OK;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&lt_pkcs11_lock);
+
+    if (rv == CKR_OK) {
+        pthread_mutex_lock(&chip->lock);
+        chip->session_cnt++;
+        pthread_mutex_unlock(&chip->lock);
+    }
+    return rv;
+}
+
+/** @brief Closes a session, called with the global lock held. */
+static void lt_pkcs11_session_close(lt_pkcs11_session_t *s)
+{
+    lt_pkcs11_chip_t *chip = s->chip;
+
+    free(s->found);
+    free(s->msg);
+    memset(s, 0, sizeof(*s));
+
+    pthread_mutex_lock(&chip->lock);
+    chip->session_cnt--;
+    if (chip->session_cnt == 0) {
+        chip->logged_in = false;
+    }
+    pthread_mutex_unlock(&chip->lock);
+}
+
+CK_RV C_CloseSession(CK_SESSION_HANDLE hSession)
+{
+    CK_RV rv = CKR_OK;
+
+    pthread_mutex_lock(&lt_pkcs11_lock);
+    if (!lt_pkcs11_initialized) {
+        rv = CKR_CRYPTOKI_NOT_INITIALIZED;
+    }
+    else if (hSession == CK_INVALID_HANDLE || hSession > LT_PKCS11_SESSIONS_MAX
+             || !lt_pkcs11_sessions[hSession - 1].used) {
+        rv = CKR_SESSION_HANDLE_INVALID;
+    }
+    else {
+        lt_pkcs11_session_close(&lt_pkcs11_sessions[hSession - 1]);
+    }
+    pthread_mutex_unlock(&lt_pkcs11_lock);
+
+    return rv;
+}
+
+CK_RV C_CloseAllSessions(CK_SLOT_ID slotID)
+{
+    lt_pkcs11_chip_t *chip;
+    CK_RV rv = lt_pkcs11_chip_get(slotID, &chip);
+    if (rv != CKR_OK) {
+        return rv;
+    }
+
+    pthread_mutex_lock(&lt_pkcs11_lock);
+    for (uint16_t i = 0; i < LT_PKCS11_SESSIONS_MAX; i++) {
+        if (lt_pkcs11_sessions[i].used && lt_pkcs11_sessions[i].chip == chip) {
+            lt_pkcs11_session_close(&lt_pkcs11_sessions[i]);
+        }
+    }
+    pthread_mutex_unlock(&lt_pkcs11_lock);
+
+    return CKR_OK;
+}
+
+CK_RV C_GetSessionInfo(CK_SESSION_HANDLE hSession, CK_SESSION_INFO_PTR pInfo)
+{
+    CK_RV rv;
+    lt_pkcs11_session_t *s = lt_pkcs11_session_get(hSession, &rv);
+    if (!s) {
+        return rv;
+    }
+    if (!pInfo) {
+        return CKR_ARGUMENTS_BAD;
+    }
+
+    pthread_mutex_lock(&s->chip->lock);
+    bool logged_in = s->chip->logged_in;
+    pthread_mutex_unlock(&s->chip->lock);
+
+    memset(pInfo, 0, sizeof(*pInfo));
+    pInfo->slotID = s->chip->idx;
+    pInfo->state = logged_in ? CKS_RO_USER_FUNCTIONS : CKS_RO_PUBLIC_SESSION;
+    pInfo->flags = s->flags;
+
+    return CKR_OK;
+}
+
+CK_RV C_GetOperationState(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pOperationState, CK_ULONG_PTR pulOperationStateLen)
+{
+    (void)hSession;
+    (void)pOperationState;
+    (void)pulOperationStateLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_SetOperationState(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pOperationState, CK_ULONG ulOperationStateLen,
+                          CK_OBJECT_HANDLE hEncryptionKey, CK_OBJECT_HANDLE hAuthenticationKey)
+{
+    (void)hSession;
+    (void)pOperationState;
+    (void)ulOperationStateLen;
+    (void)hEncryptionKey;
+    (void)hAuthenticationKey;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_Login(CK_SESSION_HANDLE hSession, CK_USER_TYPE userType, CK_UTF8CHAR_PTR pPin, CK_ULONG ulPinLen)
+{
+    (void)pPin;
+    (void)ulPinLen;  // Keys are protected by the pairing keys, the PIN is not checked
+    CK_RV rv;
+    lt_pkcs11_session_t *s = lt_pkcs11_session_get(hSession, &rv);
+    if (!s) {
+        return rv;
+    }
+    if (userType == CKU_SO) {
+        return CKR_SESSION_READ_ONLY_EXISTS;
+    }
+    if (userType != CKU_USER) {
+        return CKR_USER_TYPE_INVALID;
+    }
+
+    pthread_mutex_lock(&s->chip->lock);
+    if (s->chip->logged_in) {
+        rv = CKR_USER_ALREADY_LOGGED_IN;
+    }
+    s->chip->logged_in = true;
+    pthread_mutex_unlock(&s->chip->lock);
+
+    return rv;
+}
+
+CK_RV C_Logout(CK_SESSION_HANDLE hSession)
+{
+    CK_RV rv;
+    lt_pkcs11_session_t *s = lt_pkcs11_session_get(hSession, &rv);
+    if (!s) {
+        return rv;
+    }
+
+    pthread_mutex_lock(&s->chip->lock);
+    if (!s->chip->logged_in) {
+        rv = CKR_USER_NOT_LOGGED_IN;
+    }
+    s->chip->logged_in = false;
+    pthread_mutex_unlock(&s->chip->lock);
+
+    return rv;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Object management
+
+CK_RV C_CreateObject(CK_SESSION_HANDLE hSession, CK_ATTRIBUTE_PTR pTemplate, CK_ULONG ulCount,
+                     CK_OBJECT_HANDLE_PTR phObject)
+{
+    (void)hSession;
+    (void)pTemplate;
+    (void)ulCount;
+    (void)phObject;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_CopyObject(CK_SESSION_HANDLE hSession, CK_OBJECT_HANDLE hObject, CK_ATTRIBUTE_PTR pTemplate, CK_ULONG ulCount,
+                   CK_OBJECT_HANDLE_PTR phNewObject)
+{
+    (void)hSession;
+    (void)hObject;
+    (void)pTemplate;
+    (void)ulCount;
+    (void)phNewObject;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_DestroyObject(CK_SESSION_HANDLE hSession, CK_OBJECT_HANDLE hObject)
+{
+    (void)hSession;
+    (void)hObject;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_GetObjectSize(CK_SESSION_HANDLE hSession, CK_OBJECT_HANDLE hObject, CK_ULONG_PTR pulSize)
+{
+    CK_RV rv;
+    lt_pkcs11_session_t *s = lt_pkcs11_session_get(hSession, &rv);
+    if (!s) {
+        return rv;
+    }
+    if (!pulSize) {
+        return CKR_ARGUMENTS_BAD;
+    }
+
+    lt_pkcs11_kind_t kind;
+    uint16_t idx;
+    pthread_mutex_lock(&s->chip->lock);
+    rv = lt_pkcs11_obj_find(s->chip, hObject, &kind, &idx);
+    pthread_mutex_unlock(&s->chip->lock);
+    if (rv == CKR_OK) {
+        *pulSize = CK_UNAVAILABLE_INFORMATION;
+    }
+
+    return rv;
+}
+
+CK_RV C_GetAttributeValue(CK_SESSION_HANDLE hSession, CK_OBJECT_HANDLE hObject, CK_ATTRIBUTE_PTR pTemplate,
+                          CK_ULONG ulCount)
+{
+    CK_RV rv;
+    lt_pkcs11_session_t *s = lt_pkcs11_session_get(hSession, &rv);
+    if (!s) {
+        return rv;
+    }
+    if (!pTemplate && ulCount) {
+        return CKR_ARGUMENTS_BAD;
+    }
+
+    lt_pkcs11_kind_t kind;
+    uint16_t idx;
+    lt_pkcs11_obj_t o;
+    pthread_mutex_lock(&s->chip->lock);
+    rv = lt_pkcs11_obj_find(s->chip, hObject, &kind, &idx);
+    if (rv == CKR_OK) {
+        lt_pkcs11_obj_build(s->chip, kind, idx, &o);
+        for (CK_ULONG i = 0; i < ulCount; i++) {
+            CK_ATTRIBUTE *t = &pTemplate[i];
+            const lt_pkcs11_attr_t *attr = lt_pkcs11_attr_find(&o, t->type);
+            if (!attr) {
+                t->ulValueLen = CK_UNAVAILABLE_INFORMATION;
+                rv = CKR_ATTRIBUTE_TYPE_INVALID;
+            }
+            else if (!attr->value) {
+                t->ulValueLen = CK_UNAVAILABLE_INFORMATION;
+                rv = CKR_ATTRIBUTE_SENSITIVE;
+            }
+            else if (!t->pValue) {
+                t->ulValueLen = attr->len;
+            }
+            else if (t->ulValueLen < attr->len) {
+                t->ulValueLen = CK_UNAVAILABLE_INFORMATION;
+                rv = CKR_BUFFER_TOO_SMALL;
+            }
+            else {
+                memcpy(t->pValue, attr->value, attr->len);
+                t->ulValueLen = attr->len;
+            }
+        }
+    }
+    pthread_mutex_unlock(&s->chip->lock);
+
+    return rv;
+}
+
+CK_RV C_SetAttributeValue(CK_SESSION_HANDLE hSession, CK_OBJECT_HANDLE hObject, CK_ATTRIBUTE_PTR pTemplate,
+                          CK_ULONG ulCount)
+{
+    (void)hSession;
+    (void)hObject;
+    (void)pTemplate;
+    (void)ulCount;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_FindObjectsInit(CK_SESSION_HANDLE hSession, CK_ATTRIBUTE_PTR pTemplate, CK_ULONG ulCount)
+{
+    CK_RV rv;
+    lt_pkcs11_session_t *s = lt_pkcs11_session_get(hSession, &rv);
+    if (!s) {
+        return rv;
+    }
+    if (!pTemplate && ulCount) {
+        return CKR_ARGUMENTS_BAD;
+    }
+    if (s->find_active) {
+        return CKR_OPERATION_ACTIVE;
+    }
+
+    // Do not read slots which cannot match the requested class
+    bool keys = true, data = true;
+    for (CK_ULONG i = 0; i < ulCount; i++) {
+        if (pTemplate[i].type == CKA_CLASS && pTemplate[i].pValue
+            && pTemplate[i].ulValueLen == sizeof(CK_OBJECT_CLASS)) {
+            CK_OBJECT_CLASS cls;
+            memcpy(&cls, pTemplate[i].pValue, sizeof(cls));
+            keys = keys && (cls == CKO_PRIVATE_KEY || cls == CKO_PUBLIC_KEY);
+            data = data && cls == CKO_DATA;
+        }
+    }
+
+    s->found = calloc(LT_PKCS11_OBJECTS_MAX, sizeof(CK_OBJECT_HANDLE));
+    if (!s->found) {
+        return CKR_HOST_MEMORY;
+    }
+    s->found_cnt = 0;
+    s->found_pos = 0;
+
+    lt_pkcs11_chip_t *chip = s->chip;
+    lt_pkcs11_obj_t o;
+    pthread_mutex_lock(&chip->lock);
+    rv = lt_pkcs11_scan(chip, keys, data);
+    for (uint16_t i = 0; rv == CKR_OK && keys && i < LT_PKCS11_ECC_SLOT_CNT; i++) {
+        if (!chip->keys[i].present) {
+            continue;
+        }
+        for (uint8_t kind = LT_PKCS11_KIND_PRIV; kind <= LT_PKCS11_KIND_PUB; kind++) {
+            lt_pkcs11_obj_build(chip, (lt_pkcs11_kind_t)kind, i, &o);
+            if (lt_pkcs11_obj_match(&o, pTemplate, ulCount)) {
+                s->found[s->found_cnt++] = LT_PKCS11_OBJ(chip->idx, kind, i);
+            }
+        }
+    }
+    for (uint16_t i = 0; rv == CKR_OK && data && i < LT_PKCS11_R_MEM_SLOT_CNT; i++) {
+        if (!chip->data[i].size) {
+            continue;
+        }
+        lt_pkcs11_obj_build(chip, LT_PKCS11_KIND_DATA, i, &o);
+        if (lt_pkcs11_obj_match(&o, pTemplate, ulCount)) {
+            s->found[s->found_cnt++] = LT_PKCS11_OBJ(chip->idx, LT_PKCS11_KIND_DATA, i);
+        }
+    }
+    pthread_mutex_unlock(&chip->lock);
+
+    if (rv != CKR_OK) {
+        free(s->found);
+        s->found = NULL;
+        return rv;
+    }
+    s->find_active = true;
+
+    return CKR_OK;
+}
+
+CK_RV C_FindObjects(CK_SESSION_HANDLE hSession, CK_OBJECT_HANDLE_PTR phObject, CK_ULONG ulMaxObjectCount,
+                    CK_ULONG_PTR pulObjectCount)
+{
+    CK_RV rv;
+    lt_pkcs11_session_t *s = lt_pkcs11_session_get(hSession, &rv);
+    if (!s) {
+        return rv;
+    }
+    if (!phObject || !pulObjectCount) {
+        return CKR_ARGUMENTS_BAD;
+    }
+    if (!s->find_active) {
+        return CKR_OPERATION_NOT_INITIALIZED;
+    }
+
+    CK_ULONG cnt = s->found_cnt - s->found_pos;
+    if (cnt > ulMaxObjectCount) {
+        cnt = ulMaxObjectCount;
+    }
+    memcpy(phObject, &s->found[s->found_pos], cnt * sizeof(CK_OBJECT_HANDLE));
+    s->found_pos += cnt;
+    *pulObjectCount = cnt;
+
+    return CKR_OK;
+}
+
+CK_RV C_FindObjectsFinal(CK_SESSION_HANDLE hSession)
+{
+    CK_RV rv;
+    lt_pkcs11_session_t *s = lt_pkcs11_session_get(hSession, &rv);
+    if (!s) {
+        return rv;
+    }
+    if (!s->find_active) {
+        return CKR_OPERATION_NOT_INITIALIZED;
+    }
+
+    free(s->found);
+    s->found = NULL;
+    s->find_active = false;
+
+    return CKR_OK;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Encryption, decryption and digesting are not supported
+
+CK_RV C_EncryptInit(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism, CK_OBJECT_HANDLE hKey)
+{
+    (void)hSession;
+    (void)pMechanism;
+    (void)hKey;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_Encrypt(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pData, CK_ULONG ulDataLen, CK_BYTE_PTR pEncryptedData,
+                CK_ULONG_PTR pulEncryptedDataLen)
+{
+    (void)hSession;
+    (void)pData;
+    (void)ulDataLen;
+    (void)pEncryptedData;
+    (void)pulEncryptedDataLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_EncryptUpdate(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pPart, CK_ULONG ulPartLen, CK_BYTE_PTR pEncryptedPart,
+                      CK_ULONG_PTR pulEncryptedPartLen)
+{
+    (void)hSession;
+    (void)pPart;
+    (void)ulPartLen;
+    (void)pEncryptedPart;
+    (void)pulEncryptedPartLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_EncryptFinal(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pLastEncryptedPart, CK_ULONG_PTR pulLastEncryptedPartLen)
+{
+    (void)hSession;
+    (void)pLastEncryptedPart;
+    (void)pulLastEncryptedPartLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_DecryptInit(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism, CK_OBJECT_HANDLE hKey)
+{
+    (void)hSession;
+    (void)pMechanism;
+    (void)hKey;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_Decrypt(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pEncryptedData, CK_ULONG ulEncryptedDataLen, CK_BYTE_PTR pData,
+                CK_ULONG_PTR pulDataLen)
+{
+    (void)hSession;
+    (void)pEncryptedData;
+    (void)ulEncryptedDataLen;
+    (void)pData;
+    (void)pulDataLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_DecryptUpdate(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pEncryptedPart, CK_ULONG ulEncryptedPartLen,
+                      CK_BYTE_PTR pPart, CK_ULONG_PTR pulPartLen)
+{
+    (void)hSession;
+    (void)pEncryptedPart;
+    (void)ulEncryptedPartLen;
+    (void)pPart;
+    (void)pulPartLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_DecryptFinal(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pLastPart, CK_ULONG_PTR pulLastPartLen)
+{
+    (void)hSession;
+    (void)pLastPart;
+    (void)pulLastPartLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_DigestInit(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism)
+{
+    (void)hSession;
+    (void)pMechanism;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_Digest(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pData, CK_ULONG ulDataLen, CK_BYTE_PTR pDigest,
+               CK_ULONG_PTR pulDigestLen)
+{
+    (void)hSession;
+    (void)pData;
+    (void)ulDataLen;
+    (void)pDigest;
+    (void)pulDigestLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_DigestUpdate(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pPart, CK_ULONG ulPartLen)
+{
+    (void)hSession;
+    (void)pPart;
+    (void)ulPartLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_DigestKey(CK_SESSION_HANDLE hSession, CK_OBJECT_HANDLE hKey)
+{
+    (void)hSession;
+    (void)hKey;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_DigestFinal(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pDigest, CK_ULONG_PTR pulDigestLen)
+{
+    (void)hSession;
+    (void)pDigest;
+    (void)pulDigestLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Signing
+
+/** @brief Arguments of lt_pkcs11_sign_op(). */
+typedef struct lt_pkcs11_sign_arg_t {
+    const lt_pkcs11_session_t *s; /**< Session with the signing operation */
+    const uint8_t *hash;          /**< Hash to sign with ECDSA */
+    uint8_t *rs;                  /**< Signature */
+} lt_pkcs11_sign_arg_t;
+
+static lt_ret_t lt_pkcs11_sign_op(lt_pkcs11_chip_t *chip, void *arg)
+{
+    lt_pkcs11_sign_arg_t *sign = arg;
+    const lt_pkcs11_session_t *s = sign->s;
+
+    if (s->sign_mech == CKM_EDDSA) {
+        return lt_ecc_eddsa_sign(&chip->c.h, s->sign_slot, s->msg, s->msg_len, sign->rs);
+    }
+    return lt_ecc_ecdsa_sign_hash(&chip->c.h, s->sign_slot, sign->hash, sign->rs);
+}
+
+static void lt_pkcs11_sign_end(lt_pkcs11_session_t *s)
+{
+    s->sign_active = false;
+    s->msg_len = 0;
+}
+
+static CK_RV lt_pkcs11_sign_update(lt_pkcs11_session_t *s, const uint8_t *part, const CK_ULONG part_len)
+{
+    if (s->sign_mech == CKM_ECDSA_SHA256) {
+        lt_sha256_update(&s->sha, part, part_len);
+        return CKR_OK;
+    }
+    if (part_len > (CK_ULONG)(LT_PKCS11_EDDSA_MSG_LEN_MAX - s->msg_len)) {
+        return CKR_DATA_LEN_RANGE;
+    }
+    if (part_len) {
+        memcpy(&s->msg[s->msg_len], part, part_len);
+        s->msg_len += (uint16_t)part_len;
+    }
+    return CKR_OK;
+}
+
+static CK_RV lt_pkcs11_sign_final(lt_pkcs11_session_t *s, uint8_t *rs)
+{
+    uint8_t hash[TR01_ECDSA_SIGN_HASH_LEN] = {0};
+    lt_pkcs11_sign_arg_t arg = {.s = s, .hash = hash, .rs = rs};
+
+    if (s->sign_mech == CKM_ECDSA_SHA256) {
+        lt_sha256_finish(&s->sha, hash);
+    }
+    else if (s->sign_mech == CKM_ECDSA) {
+        // Longer hashes are truncated to the bit length of the curve order, shorter are taken as smaller numbers
+        if (s->msg_len >= TR01_ECDSA_SIGN_HASH_LEN) {
+            memcpy(hash, s->msg, TR01_ECDSA_SIGN_HASH_LEN);
+        }
+        else {
+            memcpy(&hash[TR01_ECDSA_SIGN_HASH_LEN - s->msg_len], s->msg, s->msg_len);
+        }
+    }
+
+    lt_pkcs11_chip_t *chip = s->chip;
+    pthread_mutex_lock(&chip->lock);
+    lt_ret_t ret = lt_pkcs11_call(chip, lt_pkcs11_sign_op, &arg);
+    if (ret == LT_L3_ECC_INVALID_KEY) {
+        // Key was erased behind our back
+        chip->keys[s->sign_slot].present = false;
+    }
+    pthread_mutex_unlock(&chip->lock);
+
+    return lt_pkcs11_rv(ret);
+}
+
+CK_RV C_SignInit(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism, CK_OBJECT_HANDLE hKey)
+{
+    CK_RV rv;
+    lt_pkcs11_session_t *s = lt_pkcs11_session_get(hSession, &rv);
+    if (!s) {
+        return rv;
+    }
+    if (!pMechanism) {
+        return CKR_ARGUMENTS_BAD;
+    }
+    if (s->sign_active) {
+        return CKR_OPERATION_ACTIVE;
+    }
+    if (pMechanism->mechanism != CKM_ECDSA && pMechanism->mechanism != CKM_ECDSA_SHA256
+        && pMechanism->mechanism != CKM_EDDSA) {
+        return CKR_MECHANISM_INVALID;
+    }
+    // Neither prehashed EdDSA nor contexts are supported by TROPIC01
+    if (pMechanism->pParameter || pMechanism->ulParameterLen) {
+        return CKR_MECHANISM_PARAM_INVALID;
+    }
+
+    lt_pkcs11_kind_t kind;
+    uint16_t idx;
+    lt_ecc_curve_type_t curve = TR01_CURVE_P256;
+    pthread_mutex_lock(&s->chip->lock);
+    rv = lt_pkcs11_obj_find(s->chip, hKey, &kind, &idx);
+    if (rv == CKR_OK) {
+        curve = s->chip->keys[idx].curve;
+    }
+    pthread_mutex_unlock(&s->chip->lock);
+    if (rv == CKR_OBJECT_HANDLE_INVALID || (rv == CKR_OK && kind != LT_PKCS11_KIND_PRIV)) {
+        return CKR_KEY_HANDLE_INVALID;
+    }
+    if (rv != CKR_OK) {
+        return rv;
+    }
+    if ((pMechanism->mechanism == CKM_EDDSA) != (curve == TR01_CURVE_ED25519)) {
+        return CKR_KEY_TYPE_INCONSISTENT;
+    }
+
+    if (pMechanism->mechanism == CKM_ECDSA_SHA256) {
+        lt_sha256_init(&s->sha);
+        lt_sha256_start(&s->sha);
+    }
+    else if (!s->msg) {
+        s->msg = malloc(LT_PKCS11_EDDSA_MSG_LEN_MAX);
+        if (!s->msg) {
+            return CKR_HOST_MEMORY;
+        }
+    }
+    s->sign_mech = pMechanism->mechanism;
+    s->sign_slot = (lt_ecc_slot_t)idx;
+    s->msg_len = 0;
+    s->sign_active = true;
+
+    return CKR_OK;
+}
+
+CK_RV C_Sign(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pData, CK_ULONG ulDataLen, CK_BYTE_PTR pSignature,
+             CK_ULONG_PTR pulSignatureLen)
+{
+    CK_RV rv;
+    lt_pkcs11_session_t *s = lt_pkcs11_session_get(hSession, &rv);
+    if (!s) {
+        return rv;
+    }
+    if (!s->sign_active) {
+        return CKR_OPERATION_NOT_INITIALIZED;
+    }
+    if ((!pData && ulDataLen) || !pulSignatureLen) {
+        lt_pkcs11_sign_end(s);
+        return CKR_ARGUMENTS_BAD;
+    }
+
+    // Length queries do not end the operation
+    if (!pSignature) {
+        *pulSignatureLen = LT_PKCS11_SIG_LEN;
+        return CKR_OK;
+    }
+    if (*pulSignatureLen < LT_PKCS11_SIG_LEN) {
+        *pulSignatureLen = LT_PKCS11_SIG_LEN;
+        return CKR_BUFFER_TOO_SMALL;
+    }
+
+    rv = lt_pkcs11_sign_update(s, pData, ulDataLen);
+    if (rv == CKR_OK) {
+        rv = lt_pkcs11_sign_final(s, pSignature);
+    }
+    if (rv == CKR_OK) {
+        *pulSignatureLen = LT_PKCS11_SIG_LEN;
+    }
+    lt_pkcs11_sign_end(s);
+
+    return rv;
+}
+
+CK_RV C_SignUpdate(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pPart, CK_ULONG ulPartLen)
+{
+    CK_RV rv;
+    lt_pkcs11_session_t *s = lt_pkcs11_session_get(hSession, &rv);
+    if (!s) {
+        return rv;
+    }
+    if (!s->sign_active) {
+        return CKR_OPERATION_NOT_INITIALIZED;
+    }
+    if (!pPart && ulPartLen) {
+        lt_pkcs11_sign_end(s);
+        return CKR_ARGUMENTS_BAD;
+    }
+
+    rv = lt_pkcs11_sign_update(s, pPart, ulPartLen);
+    if (rv != CKR_OK) {
+        lt_pkcs11_sign_end(s);
+    }
+
+    return rv;
+}
+
+CK_RV C_SignFinal(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pSignature, CK_ULONG_PTR pulSignatureLen)
+{
+    CK_RV rv;
+    lt_pkcs11_session_t *s = lt_pkcs11_session_get(hSession, &rv);
+    if (!s) {
+        return rv;
+    }
+    if (!s->sign_active) {
+        return CKR_OPERATION_NOT_INITIALIZED;
+    }
+    if (!pulSignatureLen) {
+        lt_pkcs11_sign_end(s);
+        return CKR_ARGUMENTS_BAD;
+    }
+
+    if (!pSignature) {
+        *pulSignatureLen = LT_PKCS11_SIG_LEN;
+        return CKR_OK;
+    }
+    if (*pulSignatureLen < LT_PKCS11_SIG_LEN) {
+        *pulSignatureLen = LT_PKCS11_SIG_LEN;
+        return CKR_BUFFER_TOO_SMALL;
+    }
+
+    rv = lt_pkcs11_sign_final(s, pSignature);
+    if (rv == CKR_OK) {
+        *pulSignatureLen = LT_PKCS11_SIG_LEN;
+    }
+    lt_pkcs11_sign_end(s);
+
+    return rv;
+}
+
+CK_RV C_SignRecoverInit(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism, CK_OBJECT_HANDLE hKey)
+{
+    (void)hSession;
+    (void)pMechanism;
+    (void)hKey;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_SignRecover(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pData, CK_ULONG ulDataLen, CK_BYTE_PTR pSignature,
+                    CK_ULONG_PTR pulSignatureLen)
+{
+    (void)hSession;
+    (void)pData;
+    (void)ulDataLen;
+    (void)pSignature;
+    (void)pulSignatureLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Verification is left to the application, public keys are available as objects
+
+CK_RV C_VerifyInit(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism, CK_OBJECT_HANDLE hKey)
+{
+    (void)hSession;
+    (void)pMechanism;
+    (void)hKey;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_Verify(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pData, CK_ULONG ulDataLen, CK_BYTE_PTR pSignature,
+               CK_ULONG ulSignatureLen)
+{
+    (void)hSession;
+    (void)pData;
+    (void)ulDataLen;
+    (void)pSignature;
+    (void)ulSignatureLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_VerifyUpdate(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pPart, CK_ULONG ulPartLen)
+{
+    (void)hSession;
+    (void)pPart;
+    (void)ulPartLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_VerifyFinal(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pSignature, CK_ULONG ulSignatureLen)
+{
+    (void)hSession;
+    (void)pSignature;
+    (void)ulSignatureLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_VerifyRecoverInit(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism, CK_OBJECT_HANDLE hKey)
+{
+    (void)hSession;
+    (void)pMechanism;
+    (void)hKey;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_VerifyRecover(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pSignature, CK_ULONG ulSignatureLen, CK_BYTE_PTR pData,
+                      CK_ULONG_PTR pulDataLen)
+{
+    (void)hSession;
+    (void)pSignature;
+    (void)ulSignatureLen;
+    (void)pData;
+    (void)pulDataLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Dual-function operations and key management are not supported
+
+CK_RV C_DigestEncryptUpdate(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pPart, CK_ULONG ulPartLen,
+                            CK_BYTE_PTR pEncryptedPart, CK_ULONG_PTR pulEncryptedPartLen)
+{
+    (void)hSession;
+    (void)pPart;
+    (void)ulPartLen;
+    (void)pEncryptedPart;
+    (void)pulEncryptedPartLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_DecryptDigestUpdate(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pEncryptedPart, CK_ULONG ulEncryptedPartLen,
+                            CK_BYTE_PTR pPart, CK_ULONG_PTR pulPartLen)
+{
+    (void)hSession;
+    (void)pEncryptedPart;
+    (void)ulEncryptedPartLen;
+    (void)pPart;
+    (void)pulPartLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_SignEncryptUpdate(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pPart, CK_ULONG ulPartLen, CK_BYTE_PTR pEncryptedPart,
+                          CK_ULONG_PTR pulEncryptedPartLen)
+{
+    (void)hSession;
+    (void)pPart;
+    (void)ulPartLen;
+    (void)pEncryptedPart;
+    (void)pulEncryptedPartLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_DecryptVerifyUpdate(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pEncryptedPart, CK_ULONG ulEncryptedPartLen,
+                            CK_BYTE_PTR pPart, CK_ULONG_PTR pulPartLen)
+{
+    (void)hSession;
+    (void)pEncryptedPart;
+    (void)ulEncryptedPartLen;
+    (void)pPart;
+    (void)pulPartLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_GenerateKey(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism, CK_ATTRIBUTE_PTR pTemplate,
+                    CK_ULONG ulCount, CK_OBJECT_HANDLE_PTR phKey)
+{
+    (void)hSession;
+    (void)pMechanism;
+    (void)pTemplate;
+    (void)ulCount;
+    (void)phKey;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_GenerateKeyPair(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism, CK_ATTRIBUTE_PTR pPublicKeyTemplate,
+                        CK_ULONG ulPublicKeyAttributeCount, CK_ATTRIBUTE_PTR pPrivateKeyTemplate,
+                        CK_ULONG ulPrivateKeyAttributeCount, CK_OBJECT_HANDLE_PTR phPublicKey,
+                        CK_OBJECT_HANDLE_PTR phPrivateKey)
+{
+    (void)hSession;
+    (void)pMechanism;
+    (void)pPublicKeyTemplate;
+    (void)ulPublicKeyAttributeCount;
+    (void)pPrivateKeyTemplate;
+    (void)ulPrivateKeyAttributeCount;
+    (void)phPublicKey;
+    (void)phPrivateKey;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_WrapKey(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism, CK_OBJECT_HANDLE hWrappingKey,
+                CK_OBJECT_HANDLE hKey, CK_BYTE_PTR pWrappedKey, CK_ULONG_PTR pulWrappedKeyLen)
+{
+    (void)hSession;
+    (void)pMechanism;
+    (void)hWrappingKey;
+    (void)hKey;
+    (void)pWrappedKey;
+    (void)pulWrappedKeyLen;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_UnwrapKey(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism, CK_OBJECT_HANDLE hUnwrappingKey,
+                  CK_BYTE_PTR pWrappedKey, CK_ULONG ulWrappedKeyLen, CK_ATTRIBUTE_PTR pTemplate,
+                  CK_ULONG ulAttributeCount, CK_OBJECT_HANDLE_PTR phKey)
+{
+    (void)hSession;
+    (void)pMechanism;
+    (void)hUnwrappingKey;
+    (void)pWrappedKey;
+    (void)ulWrappedKeyLen;
+    (void)pTemplate;
+    (void)ulAttributeCount;
+    (void)phKey;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+CK_RV C_DeriveKey(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism, CK_OBJECT_HANDLE hBaseKey,
+                  CK_ATTRIBUTE_PTR pTemplate, CK_ULONG ulAttributeCount, CK_OBJECT_HANDLE_PTR phKey)
+{
+    (void)hSession;
+    (void)pMechanism;
+    (void)hBaseKey;
+    (void)pTemplate;
+    (void)ulAttributeCount;
+    (void)phKey;
+    return CKR_FUNCTION_NOT_SUPPORTED;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Random number generation
+
+/** @brief Arguments of lt_pkcs11_random_op(). */
+typedef struct lt_pkcs11_random_arg_t {
+    uint8_t *buff; /**< Buffer for random bytes */
+    CK_ULONG len;  /**< Number of random bytes */
+} lt_pkcs11_random_arg_t;
+
+static lt_ret_t lt_pkcs11_random_op(lt_pkcs11_chip_t *chip, void *arg)
+{
+    lt_pkcs11_random_arg_t *rnd = arg;
+
+    for (CK_ULONG done = 0; done < rnd->len;) {
+        uint16_t chunk = (rnd->len - done) > TR01_RANDOM_VALUE_GET_LEN_MAX ? TR01_RANDOM_VALUE_GET_LEN_MAX
+                                                                            : (uint16_t)(rnd->len - done);
+        lt_ret_t ret = lt_random_value_get(&chip->c.h, &rnd->buff[done], chunk);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        done += chunk;
+    }
+
+    return LT_OK;
+}
+
+CK_RV C_SeedRandom(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pSeed, CK_ULONG ulSeedLen)
+{
+    CK_RV rv;
+    (void)pSeed;
+    (void)ulSeedLen;
+    if (!lt_pkcs11_session_get(hSession, &rv)) {
+        return rv;
+    }
+    return CKR_RANDOM_SEED_NOT_SUPPORTED;
+}
+
+CK_RV C_GenerateRandom(CK_SESSION_HANDLE hSession, CK_BYTE_PTR RandomData, CK_ULONG ulRandomLen)
+{
+    CK_RV rv;
+    lt_pkcs11_session_t *s = lt_pkcs11_session_get(hSession, &rv);
+    if (!s) {
+        return rv;
+    }
+    if (!RandomData && ulRandomLen) {
+        return CKR_ARGUMENTS_BAD;
+    }
+
+    lt_pkcs11_random_arg_t arg = {.buff = RandomData, .len = ulRandomLen};
+    pthread_mutex_lock(&s->chip->lock);
+    lt_ret_t ret = lt_pkcs11_call(s->chip, lt_pkcs11_random_op, &arg);
+    pthread_mutex_unlock(&s->chip->lock);
+
+    return lt_pkcs11_rv(ret);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Parallel function management
+
+CK_RV C_GetFunctionStatus(CK_SESSION_HANDLE hSession)
+{
+    (void)hSession;
+    return CKR_FUNCTION_NOT_PARALLEL;
+}
+
+CK_RV C_CancelFunction(CK_SESSION_HANDLE hSession)
+{
+    (void)hSession;
+    return CKR_FUNCTION_NOT_PARALLEL;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+
+static CK_FUNCTION_LIST lt_pkcs11_functions = {
+    .version = {CRYPTOKI_VERSION_MAJOR, CRYPTOKI_VERSION_MINOR},
+    .C_Initialize = C_Initialize,
+    .C_Finalize = C_Finalize,
+    .C_GetInfo = C_GetInfo,
+    .C_GetFunctionList = C_GetFunctionList,
+    .C_GetSlotList = C_GetSlotList,
+    .C_GetSlotInfo = C_GetSlotInfo,
+    .C_GetTokenInfo = C_GetTokenInfo,
+    .C_GetMechanismList = C_GetMechanismList,
+    .C_GetMechanismInfo = C_GetMechanismInfo,
+    .C_InitToken = C_InitToken,
+    .C_InitPIN = C_InitPIN,
+    .C_SetPIN = C_SetPIN,
+    .C_OpenSession = C_OpenSession,
+    .C_CloseSession = C_CloseSession,
+    .C_CloseAllSessions = C_CloseAllSessions,
+    .C_GetSessionInfo = C_GetSessionInfo,
+    .C_GetOperationState = C_GetOperationState,
+    .C_SetOperationState = C_SetOperationState,
+    .C_Login = C_Login,
+    .C_Logout = C_Logout,
+    .C_CreateObject = C_CreateObject,
+    .C_CopyObject = C_CopyObject,
+    .C_DestroyObject = C_DestroyObject,
+    .C_GetObjectSize = C_GetObjectSize,
+    .C_GetAttributeValue = C_GetAttributeValue,
+    .C_SetAttributeValue = C_SetAttributeValue,
+    .C_FindObjectsInit = C_FindObjectsInit,
+    .C_FindObjects = C_FindObjects,
+    .C_FindObjectsFinal = C_FindObjectsFinal,
+    .C_EncryptInit = C_EncryptInit,
+    .C_Encrypt = C_Encrypt,
+    .C_EncryptUpdate = C_EncryptUpdate,
+    .C_EncryptFinal = C_EncryptFinal,
+    .C_DecryptInit = C_DecryptInit,
+    .C_Decrypt = C_Decrypt,
+    .C_DecryptUpdate = C_DecryptUpdate,
+    .C_DecryptFinal = C_DecryptFinal,
+    .C_DigestInit = C_DigestInit,
+    .C_Digest = C_Digest,
+    .C_DigestUpdate = C_DigestUpdate,
+    .C_DigestKey = C_DigestKey,
+    .C_DigestFinal = C_DigestFinal,
+    .C_SignInit = C_SignInit,
+    .C_Sign = C_Sign,
+    .C_SignUpdate = C_SignUpdate,
+    .C_SignFinal = C_SignFinal,
+    .C_SignRecoverInit = C_SignRecoverInit,
+    .C_SignRecover = C_SignRecover,
+    .C_VerifyInit = C_VerifyInit,
+    .C_Verify = C_Verify,
+    .C_VerifyUpdate = C_VerifyUpdate,
+    .C_VerifyFinal = C_VerifyFinal,
+    .C_VerifyRecoverInit = C_VerifyRecoverInit,
+    .C_VerifyRecover = C_VerifyRecover,
+    .C_DigestEncryptUpdate = C_DigestEncryptUpdate,
+    .C_DecryptDigestUpdate = C_DecryptDigestUpdate,
+    .C_SignEncryptUpdate = C_SignEncryptUpdate,
+    .C_DecryptVerifyUpdate = C_DecryptVerifyUpdate,
+    .C_GenerateKey = C_GenerateKey,
+    .C_GenerateKeyPair = C_GenerateKeyPair,
+    .C_WrapKey = C_WrapKey,
+    .C_UnwrapKey = C_UnwrapKey,
+    .C_DeriveKey = C_DeriveKey,
+    .C_SeedRandom = C_SeedRandom,
+    .C_GenerateRandom = C_GenerateRandom,
+    .C_GetFunctionStatus = C_GetFunctionStatus,
+    .C_CancelFunction = C_CancelFunction,
+    .C_WaitForSlotEvent = C_WaitForSlotEvent,
+};
+
+CK_RV C_GetFunctionList(CK_FUNCTION_LIST_PTR_PTR ppFunctionList)
+{
+    if (!ppFunctionList) {
+        return CKR_ARGUMENTS_BAD;
+    }
+    *ppFunctionList = &lt_pkcs11_functions;
+    return CKR_OK;
+}
@@ -0,0 +1,322 @@
+/**
+ * @file lt_test_pkcs11.c
+ * @brief Loads the PKCS#11 module, points it to the model and exercises it
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // mkdtemp(), setenv()
+#endif
+
+#include <dlfcn.h>
+#include <p11-kit/pkcs11.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_functional_tests.h"
+#include "libtropic_port_unix_tcp.h"
+#include "lt_pkcs11.h"
+#include "lt_sha256.h"
+
+/** @brief Number of threads signing at once. */
+#define LT_TEST_P11_THREAD_CNT 4
+/** @brief Number of signatures made by each thread. */
+#define LT_TEST_P11_SIGN_CNT 8
+
+#define LT_TEST_P11_CHECK(expected, call)                                                                      \
+    do {                                                                                                       \
+        CK_RV rv_ = (call);                                                                                    \
+        if (rv_ != (CK_RV)(expected)) {                                                                        \
+            printf("FAIL [%4d] %s returned 0x%lx, expected 0x%lx\n", __LINE__, #call, rv_, (CK_RV)(expected)); \
+            return false;                                                                                      \
+        }                                                                                                      \
+    } while (0)
+
+static CK_FUNCTION_LIST_PTR p11;
+static lt_dev_unix_tcp_t device;
+static lt_handle_t h;
+static uint8_t p256_pub[TR01_CURVE_P256_PUBKEY_LEN];
+static uint8_t ed25519_pub[TR01_CURVE_ED25519_PUBKEY_LEN];
+static uint8_t r_mem[100];
+static char dir[64];
+/** @brief Serializes signature verification, trezor_crypto's point multiplication uses static buffers. */
+static pthread_mutex_t verify_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** @brief Provisions keys and data the module is expected to find. */
+static bool lt_test_p11_provision(void)
+{
+    lt_ecc_curve_type_t curve;
+    lt_ecc_key_origin_t origin;
+
+    for (uint16_t i = 0; i < sizeof(r_mem); i++) {
+        r_mem[i] = (uint8_t)(i * 3);
+    }
+
+    printf("Provisioning keys and data\n");
+    LT_TEST_TRUE(lt_init(&h) == LT_OK);
+    LT_TEST_TRUE(lt_verify_chip_and_start_secure_session(&h, sh0priv, sh0pub, TR01_PAIRING_KEY_SLOT_INDEX_0) == LT_OK);
+    lt_ecc_key_erase(&h, TR01_ECC_SLOT_0);
+    lt_ecc_key_erase(&h, TR01_ECC_SLOT_1);
+    lt_r_mem_data_erase(&h, 0);
+    LT_TEST_TRUE(lt_ecc_key_generate(&h, TR01_ECC_SLOT_0, TR01_CURVE_P256) == LT_OK);
+    LT_TEST_TRUE(lt_ecc_key_generate(&h, TR01_ECC_SLOT_1, TR01_CURVE_ED25519) == LT_OK);
+    LT_TEST_TRUE(lt_ecc_key_read(&h, TR01_ECC_SLOT_0, p256_pub, sizeof(p256_pub), &curve, &origin) == LT_OK);
+    LT_TEST_TRUE(lt_ecc_key_read(&h, TR01_ECC_SLOT_1, ed25519_pub, sizeof(ed25519_pub), &curve, &origin) == LT_OK);
+    LT_TEST_TRUE(lt_r_mem_data_write(&h, 0, r_mem, sizeof(r_mem)) == LT_OK);
+    lt_session_abort(&h);
+    lt_deinit(&h);
+
+    return true;
+}
+
+static bool lt_test_p11_file_write(const char *name, const void *data, const size_t len)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *f = fopen(path, "wb");
+    LT_TEST_TRUE(f != NULL);
+    bool ok = fwrite(data, 1, len, f) == len;
+    fclose(f);
+    return ok;
+}
+
+static void lt_test_p11_files_remove(void)
+{
+    const char *names[] = {"sh0priv.bin", "sh0pub.bin", "lt_pkcs11.conf"};
+    char path[128];
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        snprintf(path, sizeof(path), "%s/%s", dir, names[i]);
+        unlink(path);
+    }
+    rmdir(dir);
+}
+
+/** @brief Finds exactly one object matching class and label. */
+static bool lt_test_p11_find(const CK_SESSION_HANDLE s, CK_OBJECT_CLASS cls, const char *label, CK_OBJECT_HANDLE *obj)
+{
+    CK_ATTRIBUTE templ[] = {
+        {CKA_CLASS, &cls, sizeof(cls)},
+        {CKA_LABEL, (void *)label, strlen(label)},
+    };
+    CK_OBJECT_HANDLE objs[2];
+    CK_ULONG cnt;
+
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_FindObjectsInit(s, templ, 2));
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_FindObjects(s, objs, 2, &cnt));
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_FindObjectsFinal(s));
+    LT_TEST_TRUE(cnt == 1);
+    *obj = objs[0];
+
+    return true;
+}
+
+static bool lt_test_p11_ecdsa_sign(const CK_SESSION_HANDLE s, const CK_OBJECT_HANDLE key, const uint8_t *msg,
+                                   const uint16_t msg_len)
+{
+    CK_MECHANISM mech = {CKM_ECDSA_SHA256, NULL, 0};
+    uint8_t rs[TR01_ECDSA_EDDSA_SIGNATURE_LENGTH];
+    CK_ULONG rs_len = sizeof(rs);
+
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_SignInit(s, &mech, key));
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_Sign(s, (CK_BYTE_PTR)msg, msg_len, rs, &rs_len));
+    LT_TEST_TRUE(rs_len == sizeof(rs));
+    pthread_mutex_lock(&verify_lock);
+    lt_ret_t ret = lt_ecc_ecdsa_sig_verify(msg, msg_len, p256_pub, rs);
+    pthread_mutex_unlock(&verify_lock);
+    LT_TEST_TRUE(ret == LT_OK);
+
+    return true;
+}
+
+static bool lt_test_p11_basic(void)
+{
+    CK_SLOT_ID slot;
+    CK_ULONG cnt = 1;
+    CK_TOKEN_INFO token;
+    CK_SESSION_HANDLE s;
+    CK_OBJECT_HANDLE priv, pub, ed_priv, data;
+    uint8_t buff[512], rs[TR01_ECDSA_EDDSA_SIGNATURE_LENGTH];
+    CK_ULONG rs_len;
+
+    printf("Slots and token\n");
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_GetSlotList(CK_TRUE, &slot, &cnt));
+    LT_TEST_TRUE(cnt == 1 && slot == 0);
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_GetTokenInfo(slot, &token));
+    LT_TEST_TRUE(memcmp(token.label, "model ", 6) == 0);
+    LT_TEST_TRUE((token.flags & CKF_RNG) && (token.flags & CKF_WRITE_PROTECTED));
+    LT_TEST_P11_CHECK(CKR_TOKEN_WRITE_PROTECTED,
+                      p11->C_OpenSession(slot, CKF_SERIAL_SESSION | CKF_RW_SESSION, NULL, NULL, &s));
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_OpenSession(slot, CKF_SERIAL_SESSION, NULL, NULL, &s));
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_Login(s, CKU_USER, (CK_UTF8CHAR_PTR) "0000", 4));
+
+    printf("Key objects\n");
+    LT_TEST_TRUE(lt_test_p11_find(s, CKO_PRIVATE_KEY, "ecc_slot_0", &priv));
+    LT_TEST_TRUE(lt_test_p11_find(s, CKO_PUBLIC_KEY, "ecc_slot_0", &pub));
+    LT_TEST_TRUE(lt_test_p11_find(s, CKO_PRIVATE_KEY, "ecc_slot_1", &ed_priv));
+    CK_KEY_TYPE key_type;
+    CK_ATTRIBUTE attrs[] = {
+        {CKA_EC_POINT, buff, sizeof(buff)},
+        {CKA_KEY_TYPE, &key_type, sizeof(key_type)},
+    };
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_GetAttributeValue(s, pub, attrs, 2));
+    LT_TEST_TRUE(attrs[0].ulValueLen == 67 && buff[0] == 0x04 && buff[1] == 0x41 && buff[2] == 0x04);
+    LT_TEST_TRUE(memcmp(&buff[3], p256_pub, sizeof(p256_pub)) == 0 && key_type == CKK_EC);
+    attrs[0].ulValueLen = sizeof(buff);
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_GetAttributeValue(s, ed_priv, attrs, 2));
+    LT_TEST_TRUE(attrs[0].ulValueLen == 34 && memcmp(&buff[2], ed25519_pub, sizeof(ed25519_pub)) == 0);
+    LT_TEST_TRUE(key_type == CKK_EC_EDWARDS);
+    CK_ATTRIBUTE value = {CKA_VALUE, buff, sizeof(buff)};
+    LT_TEST_P11_CHECK(CKR_ATTRIBUTE_SENSITIVE, p11->C_GetAttributeValue(s, priv, &value, 1));
+
+    printf("CKM_ECDSA_SHA256\n");
+    for (uint16_t i = 0; i < sizeof(buff); i++) {
+        buff[i] = (uint8_t)i;
+    }
+    LT_TEST_TRUE(lt_test_p11_ecdsa_sign(s, priv, buff, sizeof(buff)));
+    CK_MECHANISM mech = {CKM_ECDSA_SHA256, NULL, 0};
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_SignInit(s, &mech, priv));
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_SignUpdate(s, buff, 100));
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_SignUpdate(s, &buff[100], sizeof(buff) - 100));
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_SignFinal(s, NULL, &rs_len));
+    LT_TEST_TRUE(rs_len == sizeof(rs));
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_SignFinal(s, rs, &rs_len));
+    LT_TEST_TRUE(lt_ecc_ecdsa_sig_verify(buff, sizeof(buff), p256_pub, rs) == LT_OK);
+
+    printf("CKM_ECDSA\n");
+    struct lt_crypto_sha256_ctx_t hctx;
+    uint8_t hash[TR01_ECDSA_SIGN_HASH_LEN];
+    lt_sha256_init(&hctx);
+    lt_sha256_start(&hctx);
+    lt_sha256_update(&hctx, buff, sizeof(buff));
+    lt_sha256_finish(&hctx, hash);
+    mech.mechanism = CKM_ECDSA;
+    rs_len = sizeof(rs);
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_SignInit(s, &mech, priv));
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_Sign(s, hash, sizeof(hash), rs, &rs_len));
+    LT_TEST_TRUE(lt_ecc_ecdsa_sig_verify(buff, sizeof(buff), p256_pub, rs) == LT_OK);
+    LT_TEST_P11_CHECK(CKR_KEY_HANDLE_INVALID, p11->C_SignInit(s, &mech, pub));
+    LT_TEST_P11_CHECK(CKR_KEY_TYPE_INCONSISTENT, p11->C_SignInit(s, &mech, ed_priv));
+
+    printf("CKM_EDDSA\n");
+    mech.mechanism = CKM_EDDSA;
+    rs_len = sizeof(rs);
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_SignInit(s, &mech, ed_priv));
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_Sign(s, buff, sizeof(buff), rs, &rs_len));
+    LT_TEST_TRUE(lt_ecc_eddsa_sig_verify(buff, sizeof(buff), ed25519_pub, rs) == LT_OK);
+
+    printf("Random numbers\n");
+    memset(buff, 0, sizeof(buff));
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_GenerateRandom(s, buff, sizeof(buff)));
+    bool nonzero = false;
+    for (uint16_t i = sizeof(buff) - 32; i < sizeof(buff); i++) {
+        nonzero = nonzero || buff[i] != 0;
+    }
+    LT_TEST_TRUE(nonzero);
+
+    printf("Data objects\n");
+    LT_TEST_TRUE(lt_test_p11_find(s, CKO_DATA, "r_mem_slot_0", &data));
+    value.ulValueLen = sizeof(buff);
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_GetAttributeValue(s, data, &value, 1));
+    LT_TEST_TRUE(value.ulValueLen == sizeof(r_mem) && memcmp(buff, r_mem, sizeof(r_mem)) == 0);
+
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_CloseSession(s));
+    return true;
+}
+
+static void *lt_test_p11_signer(void *arg)
+{
+    CK_OBJECT_HANDLE priv;
+    CK_SESSION_HANDLE s;
+    uint8_t msg[64];
+
+    if (p11->C_OpenSession(0, CKF_SERIAL_SESSION, NULL, NULL, &s) != CKR_OK) {
+        return (void *)(uintptr_t)false;
+    }
+    bool ok = lt_test_p11_find(s, CKO_PRIVATE_KEY, "ecc_slot_0", &priv);
+    for (uint16_t i = 0; ok && i < LT_TEST_P11_SIGN_CNT; i++) {
+        memset(msg, (int)((uintptr_t)arg * LT_TEST_P11_SIGN_CNT + i), sizeof(msg));
+        ok = lt_test_p11_ecdsa_sign(s, priv, msg, sizeof(msg));
+    }
+    p11->C_CloseSession(s);
+
+    return (void *)(uintptr_t)ok;
+}
+
+static bool lt_test_p11_concurrent(void)
+{
+    pthread_t threads[LT_TEST_P11_THREAD_CNT];
+    bool ok = true;
+
+    printf("%d threads signing at once\n", LT_TEST_P11_THREAD_CNT);
+    for (uintptr_t i = 0; i < LT_TEST_P11_THREAD_CNT; i++) {
+        LT_TEST_TRUE(pthread_create(&threads[i], NULL, lt_test_p11_signer, (void *)i) == 0);
+    }
+    for (uint16_t i = 0; i < LT_TEST_P11_THREAD_CNT; i++) {
+        void *res;
+        pthread_join(threads[i], &res);
+        ok = ok && (bool)(uintptr_t)res;
+    }
+
+    LT_TEST_TRUE(ok);
+    return true;
+}
+
+static bool lt_test_p11_run(void)
+{
+    char conf[512];
+    CK_C_GetFunctionList get_function_list;
+    CK_C_INITIALIZE_ARGS init_args = {.flags = CKF_OS_LOCKING_OK};
+
+    snprintf(conf, sizeof(conf), "# Model\n127.0.0.1:%u %s/sh0priv.bin %s/sh0pub.bin 0 model\n", device.port, dir,
+             dir);
+    LT_TEST_TRUE(lt_test_p11_file_write("sh0priv.bin", sh0priv, TR01_X25519_KEY_LEN));
+    LT_TEST_TRUE(lt_test_p11_file_write("sh0pub.bin", sh0pub, TR01_X25519_KEY_LEN));
+    LT_TEST_TRUE(lt_test_p11_file_write("lt_pkcs11.conf", conf, strlen(conf)));
+    snprintf(conf, sizeof(conf), "%s/lt_pkcs11.conf", dir);
+    setenv(LT_PKCS11_CONF_ENV, conf, 1);
+
+    printf("Loading %s\n", LT_TEST_PKCS11_MODULE);
+    void *module = dlopen(LT_TEST_PKCS11_MODULE, RTLD_NOW | RTLD_LOCAL);
+    LT_TEST_TRUE(module != NULL);
+    *(void **)&get_function_list = dlsym(module, "C_GetFunctionList");
+    LT_TEST_TRUE(get_function_list != NULL);
+    LT_TEST_P11_CHECK(CKR_OK, get_function_list(&p11));
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_Initialize(&init_args));
+    LT_TEST_P11_CHECK(CKR_CRYPTOKI_ALREADY_INITIALIZED, p11->C_Initialize(NULL));
+
+    bool ok = lt_test_p11_basic() && lt_test_p11_concurrent();
+
+    LT_TEST_P11_CHECK(CKR_OK, p11->C_Finalize(NULL));
+    dlclose(module);
+    return ok;
+}
+
+int main(void)
+{
+    if (lt_unix_tcp_target_from_env(&device) != LT_OK) {
+        return EXIT_FAILURE;
+    }
+    device.rng_seed = (unsigned int)time(NULL);
+    h.l2.device = &device;
+
+    snprintf(dir, sizeof(dir), "/tmp/lt_test_pkcs11.XXXXXX");
+    if (!mkdtemp(dir)) {
+        return EXIT_FAILURE;
+    }
+
+    bool ok = lt_test_p11_provision() && lt_test_p11_run();
+    lt_test_p11_files_remove();
+
+    printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
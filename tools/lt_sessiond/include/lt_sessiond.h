@@ -0,0 +1,176 @@
+#ifndef LT_SESSIOND_H
+#define LT_SESSIOND_H
+
+/**
+ * @file lt_sessiond.h
+ * @brief Session daemon owning TROPIC01 chips and serving local clients
+ * @details The daemon starts a Secure Session with each chip once and keeps it, so clients pay neither for lt_init(),
+ * reading of the certificate store nor the handshake. Clients connect to a Unix domain socket and send requests
+ * described in lt_sessiond_proto.h.
+ *
+ * Each client is matched to the first policy rule with its user ID (from the socket's peer credentials). Clients
+ * without a rule are disconnected, requests not allowed by the rule are answered with LT_SESSIOND_DENIED.
+ *
+ * Each chip has a worker thread. It takes requests from the clients' queues round-robin, one request per client at a
+ * time, and executes up to `batch_max` of them at once with lt_batch_run(), so a client flooding the daemon delays the
+ * others by at most one command per round. Requests of one client are executed in order. A client can have up to
+ * `queue_depth` requests waiting, further requests are not read from its socket until some complete.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "libtropic_common.h"
+#include "lt_sessiond_proto.h"
+#include "lt_tools_session.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Maximal number of chips served by one daemon. */
+#define LT_SESSIOND_CHIPS_MAX 8
+/** @brief Maximal number of connected clients. */
+#define LT_SESSIOND_CLIENTS_MAX 64
+/** @brief Default number of requests a client can have waiting. */
+#define LT_SESSIOND_QUEUE_DEPTH_DEFAULT 4
+/** @brief Maximal number of requests executed in one batch. */
+#define LT_SESSIOND_BATCH_MAX 16
+/** @brief Default number of requests executed in one batch. */
+#define LT_SESSIOND_BATCH_DEFAULT 8
+
+/** @brief Inclusive range of slots or indexes. */
+typedef struct lt_sessiond_range_t {
+    uint16_t first; /**< First allowed value */
+    uint16_t last;  /**< Last allowed value */
+} lt_sessiond_range_t;
+
+/** @brief Access policy of one user. */
+typedef struct lt_sessiond_rule_t {
+    bool any_uid;                              /**< Rule matches all users */
+    uid_t uid;                                 /**< User the rule matches, if not `any_uid` */
+    uint32_t ops;                              /**< Allowed operations, bit `(1 << id)` per `lt_batch_cmd_id_t` */
+    lt_sessiond_range_t chips;                 /**< Allowed chips */
+    lt_sessiond_range_t ecc_slots;             /**< Allowed ECC key slots */
+    lt_sessiond_range_t r_mem_slots;           /**< Allowed R memory slots */
+    lt_sessiond_range_t mac_and_destroy_slots; /**< Allowed MAC-and-Destroy slots */
+    lt_sessiond_range_t mcounters;             /**< Allowed monotonic counters */
+} lt_sessiond_rule_t;
+
+/** @brief Chip served by the daemon. */
+typedef struct lt_sessiond_chip_cfg_t {
+    /** @brief Device's handle with the device set up, the daemon calls lt_init() and lt_deinit(). */
+    lt_handle_t *h;
+    const uint8_t *sh_priv;     /**< Pairing private key */
+    const uint8_t *sh_pub;      /**< Pairing public key */
+    lt_pkey_index_t pkey_index; /**< Pairing key slot */
+} lt_sessiond_chip_cfg_t;
+
+/** @brief Configuration of the daemon. */
+typedef struct lt_sessiond_cfg_t {
+    const char *socket_path;         /**< Path of the Unix domain socket, an existing file is replaced */
+    lt_sessiond_chip_cfg_t *chips;   /**< Chips */
+    uint8_t chip_cnt;                /**< Number of chips (1 - LT_SESSIOND_CHIPS_MAX) */
+    const lt_sessiond_rule_t *rules; /**< Access policy, first matching rule applies */
+    uint16_t rule_cnt;               /**< Number of rules */
+    uint8_t queue_depth;             /**< Requests a client can have waiting, 0 for LT_SESSIOND_QUEUE_DEPTH_DEFAULT */
+    uint8_t batch_max;               /**< Requests executed at once (up to LT_SESSIOND_BATCH_MAX), 0 for default */
+} lt_sessiond_cfg_t;
+
+struct lt_sessiond_t;
+struct lt_sessiond_req_t;
+
+/** @brief Connected client. */
+typedef struct lt_sessiond_client_t {
+    bool used;                      /**< Slot is taken, also while requests of a closed client are executed */
+    int fd;                         /**< Socket, -1 after the client disconnected */
+    uid_t uid;                      /**< User of the client */
+    const lt_sessiond_rule_t *rule; /**< Matching rule */
+    uint8_t pending;                /**< Requests waiting or being executed */
+    uint16_t rx_len;                /**< Bytes of the current request received */
+    /** @brief Current request. */
+    uint8_t rx[sizeof(lt_sd_req_hdr_t) + LT_SD_PAYLOAD_MAX];
+    /** @brief Waiting requests, one queue per chip. */
+    struct {
+        struct lt_sessiond_req_t *head;
+        struct lt_sessiond_req_t *tail;
+    } queue[LT_SESSIOND_CHIPS_MAX];
+} lt_sessiond_client_t;
+
+/** @brief State of a chip. */
+typedef struct lt_sessiond_chip_t {
+    struct lt_sessiond_t *sd; /**< Daemon */
+    uint8_t idx;              /**< Index of the chip */
+    pthread_t thread;         /**< Worker thread */
+    bool thread_started;      /**< Worker thread is running */
+    lt_tools_session_t ses;   /**< Secure Session, used only by the worker thread after init */
+    pthread_cond_t cond;      /**< Signaled when a request is queued or the daemon stops */
+    uint16_t next_client;     /**< Client served first in the next round */
+    /** @brief Stage buffer of lt_batch_run(). */
+    uint8_t stage[LT_SIZE_OF_L3_BUFF] __attribute__((aligned(16)));
+} lt_sessiond_chip_t;
+
+/**
+ * @brief State of the daemon.
+ * @note All members are private. The structure is large, allocate it statically or on the heap.
+ */
+typedef struct lt_sessiond_t {
+    lt_sessiond_cfg_t cfg;                                 /**< Configuration */
+    int listen_fd;                                         /**< Listening socket */
+    int wake_pipe[2];                                      /**< Wakes up the event loop */
+    pthread_mutex_t lock;                                  /**< Protects queues, `done` and `stopping` */
+    bool stopping;                                         /**< Worker threads have to exit */
+    struct lt_sessiond_req_t *done_head;                   /**< Executed requests to be answered */
+    struct lt_sessiond_req_t *done_tail;                   /**< Last executed request */
+    lt_sessiond_chip_t chips[LT_SESSIOND_CHIPS_MAX];       /**< Chips */
+    lt_sessiond_client_t clients[LT_SESSIOND_CLIENTS_MAX]; /**< Clients */
+} lt_sessiond_t;
+
+/**
+ * @brief Starts Secure Sessions with all chips, opens the socket and starts worker threads.
+ *
+ * @param sd   Daemon, zeroed memory is not required
+ * @param cfg  Configuration, has to outlive the daemon
+ *
+ * @retval     LT_OK Function executed successfully
+ * @retval     other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding of
+ * returned value
+ */
+lt_ret_t lt_sessiond_init(lt_sessiond_t *sd, const lt_sessiond_cfg_t *cfg);
+
+/**
+ * @brief Serves clients until lt_sessiond_stop() is called.
+ *
+ * @param sd  Daemon
+ *
+ * @retval    LT_OK Daemon was stopped
+ * @retval    LT_FAIL Event loop failed
+ */
+lt_ret_t lt_sessiond_run(lt_sessiond_t *sd);
+
+/**
+ * @brief Makes lt_sessiond_run() return. Can be called from a signal handler or another thread.
+ *
+ * @param sd  Daemon
+ */
+void lt_sessiond_stop(lt_sessiond_t *sd);
+
+/**
+ * @brief Stops worker threads, disconnects clients, aborts Secure Sessions and removes the socket.
+ *
+ * @param sd  Daemon
+ *
+ * @retval    LT_OK Function executed successfully
+ */
+lt_ret_t lt_sessiond_deinit(lt_sessiond_t *sd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LT_SESSIOND_H
@@ -0,0 +1,168 @@
+#ifndef LT_SESSIOND_CLIENT_H
+#define LT_SESSIOND_CLIENT_H
+
+/**
+ * @file lt_sessiond_client.h
+ * @brief Client library of lt_sessiond
+ * @details Functions mirror the L3 functions of libtropic.h: the device's handle is replaced by a connection to
+ * lt_sessiond, the remaining parameters are the same. Requests are sent to the chip selected by the `chip` member of
+ * the connection. Besides the results of the commands, the functions return LT_SESSIOND_DENIED when the daemon's
+ * policy does not allow the request and LT_FAIL when the connection failed.
+ *
+ * A connection is not thread-safe, use one connection per thread.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdint.h>
+
+#include "libtropic_common.h"
+#include "lt_sessiond_proto.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Connection to lt_sessiond. */
+typedef struct lt_sd_client_t {
+    /** @public @brief Index of the chip the requests are sent to, 0 after lt_sd_connect(). */
+    uint8_t chip;
+
+    /** @private @brief Socket file descriptor. */
+    int fd;
+    /** @private @brief Tag of the last request. */
+    uint32_t tag;
+    /** @private @brief Frame buffer. */
+    uint8_t buff[sizeof(lt_sd_req_hdr_t) + LT_SD_PAYLOAD_MAX];
+} lt_sd_client_t;
+
+/**
+ * @brief Connects to lt_sessiond.
+ *
+ * @param c            Connection
+ * @param socket_path  Path to the daemon's Unix domain socket
+ *
+ * @retval             LT_OK Function executed successfully
+ * @retval             LT_FAIL Connection failed
+ */
+lt_ret_t lt_sd_connect(lt_sd_client_t *c, const char *socket_path);
+
+/**
+ * @brief Closes the connection. Requests still queued in the daemon are dropped.
+ *
+ * @param c  Connection
+ *
+ * @retval   LT_OK Function executed successfully
+ */
+lt_ret_t lt_sd_disconnect(lt_sd_client_t *c);
+
+/**
+ * @brief Reads number of chips served by the daemon.
+ *
+ * @param c         Connection
+ * @param chip_cnt  Number of chips
+ *
+ * @retval          LT_OK Function executed successfully
+ * @retval          other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding
+ * of returned value
+ */
+lt_ret_t lt_sd_chip_cnt(lt_sd_client_t *c, uint8_t *chip_cnt);
+
+/**
+ * @brief Executes any L3 command on the selected chip.
+ * @details The other functions of this header fill the command and call this one. Result is also stored into
+ * `cmd->ret`.
+ *
+ * @param c    Connection
+ * @param cmd  Command, as for lt_batch_run()
+ *
+ * @retval     LT_OK Function executed successfully
+ * @retval     other Function did not execute successully, you might use lt_ret_verbose() to get verbose encoding of
+ * returned value
+ */
+lt_ret_t lt_sd_call(lt_sd_client_t *c, lt_batch_cmd_t *cmd);
+
+/** @brief Same as lt_ping(). */
+lt_ret_t lt_sd_ping(lt_sd_client_t *c, const uint8_t *msg_out, uint8_t *msg_in, const uint16_t msg_len);
+
+/** @brief Same as lt_pairing_key_write(). */
+lt_ret_t lt_sd_pairing_key_write(lt_sd_client_t *c, const uint8_t *pairing_pub, const uint8_t slot);
+
+/** @brief Same as lt_pairing_key_read(). */
+lt_ret_t lt_sd_pairing_key_read(lt_sd_client_t *c, uint8_t *pairing_pub, const uint8_t slot);
+
+/** @brief Same as lt_pairing_key_invalidate(). */
+lt_ret_t lt_sd_pairing_key_invalidate(lt_sd_client_t *c, const uint8_t slot);
+
+/** @brief Same as lt_r_config_write(). */
+lt_ret_t lt_sd_r_config_write(lt_sd_client_t *c, const enum lt_config_obj_addr_t addr, const uint32_t obj);
+
+/** @brief Same as lt_r_config_read(). */
+lt_ret_t lt_sd_r_config_read(lt_sd_client_t *c, const enum lt_config_obj_addr_t addr, uint32_t *obj);
+
+/** @brief Same as lt_r_config_erase(). */
+lt_ret_t lt_sd_r_config_erase(lt_sd_client_t *c);
+
+/** @brief Same as lt_i_config_write(). */
+lt_ret_t lt_sd_i_config_write(lt_sd_client_t *c, const enum lt_config_obj_addr_t addr, const uint8_t bit_index);
+
+/** @brief Same as lt_i_config_read(). */
+lt_ret_t lt_sd_i_config_read(lt_sd_client_t *c, const enum lt_config_obj_addr_t addr, uint32_t *obj);
+
+/** @brief Same as lt_r_mem_data_write(). */
+lt_ret_t lt_sd_r_mem_data_write(lt_sd_client_t *c, const uint16_t udata_slot, const uint8_t *data,
+                                const uint16_t data_size);
+
+/** @brief Same as lt_r_mem_data_read(). */
+lt_ret_t lt_sd_r_mem_data_read(lt_sd_client_t *c, const uint16_t udata_slot, uint8_t *data,
+                               const uint16_t data_max_size, uint16_t *data_read_size);
+
+/** @brief Same as lt_r_mem_data_erase(). */
+lt_ret_t lt_sd_r_mem_data_erase(lt_sd_client_t *c, const uint16_t udata_slot);
+
+/** @brief Same as lt_random_value_get(). */
+lt_ret_t lt_sd_random_value_get(lt_sd_client_t *c, uint8_t *rnd_bytes, const uint16_t rnd_bytes_cnt);
+
+/** @brief Same as lt_ecc_key_generate(). */
+lt_ret_t lt_sd_ecc_key_generate(lt_sd_client_t *c, const lt_ecc_slot_t slot, const lt_ecc_curve_type_t curve);
+
+/** @brief Same as lt_ecc_key_store(). */
+lt_ret_t lt_sd_ecc_key_store(lt_sd_client_t *c, const lt_ecc_slot_t slot, const lt_ecc_curve_type_t curve,
+                             const uint8_t *key);
+
+/** @brief Same as lt_ecc_key_read(). */
+lt_ret_t lt_sd_ecc_key_read(lt_sd_client_t *c, const lt_ecc_slot_t ecc_slot, uint8_t *key, const uint8_t key_max_size,
+                            lt_ecc_curve_type_t *curve, lt_ecc_key_origin_t *origin);
+
+/** @brief Same as lt_ecc_key_erase(). */
+lt_ret_t lt_sd_ecc_key_erase(lt_sd_client_t *c, const lt_ecc_slot_t ecc_slot);
+
+/** @brief Same as lt_ecc_ecdsa_sign(), `msg_len` is limited to LT_SD_PAYLOAD_MAX - 1. */
+lt_ret_t lt_sd_ecc_ecdsa_sign(lt_sd_client_t *c, const lt_ecc_slot_t ecc_slot, const uint8_t *msg,
+                              const uint32_t msg_len, uint8_t *rs);
+
+/** @brief Same as lt_ecc_eddsa_sign(). */
+lt_ret_t lt_sd_ecc_eddsa_sign(lt_sd_client_t *c, const lt_ecc_slot_t ecc_slot, const uint8_t *msg,
+                              const uint16_t msg_len, uint8_t *rs);
+
+/** @brief Same as lt_mcounter_init(). */
+lt_ret_t lt_sd_mcounter_init(lt_sd_client_t *c, const enum lt_mcounter_index_t mcounter_index,
+                             const uint32_t mcounter_value);
+
+/** @brief Same as lt_mcounter_update(). */
+lt_ret_t lt_sd_mcounter_update(lt_sd_client_t *c, const enum lt_mcounter_index_t mcounter_index);
+
+/** @brief Same as lt_mcounter_get(). */
+lt_ret_t lt_sd_mcounter_get(lt_sd_client_t *c, const enum lt_mcounter_index_t mcounter_index,
+                            uint32_t *mcounter_value);
+
+/** @brief Same as lt_mac_and_destroy(). */
+lt_ret_t lt_sd_mac_and_destroy(lt_sd_client_t *c, const lt_mac_and_destroy_slot_t slot, const uint8_t *data_out,
+                               uint8_t *data_in);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LT_SESSIOND_CLIENT_H
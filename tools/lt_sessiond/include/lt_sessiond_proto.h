@@ -0,0 +1,156 @@
+#ifndef LT_SESSIOND_PROTO_H
+#define LT_SESSIOND_PROTO_H
+
+/**
+ * @file lt_sessiond_proto.h
+ * @brief Wire protocol between lt_sessiond and its clients
+ * @details Each request is a `lt_sd_req_hdr_t` followed by `len` bytes of payload, each response a `lt_sd_res_hdr_t`
+ * followed by `len` bytes of payload. Operations are the `lt_batch_cmd_id_t` values plus LT_SD_OP_INFO. Both ends run
+ * on the same host, so all multi-byte fields are in host byte order.
+ *
+ * Payloads of the operations (sizes in bytes, `*` is the rest of the payload):
+ *
+ *   | Operation                       | Request                       | Response                       |
+ *   |---------------------------------|-------------------------------|--------------------------------|
+ *   | LT_SD_OP_INFO                   | -                             | version (1), chip count (1)    |
+ *   | LT_BATCH_PING                   | message (*)                   | message (*)                    |
+ *   | LT_BATCH_PAIRING_KEY_WRITE      | slot (1), key (32)            | -                              |
+ *   | LT_BATCH_PAIRING_KEY_READ       | slot (1)                      | key (32)                       |
+ *   | LT_BATCH_PAIRING_KEY_INVALIDATE | slot (1)                      | -                              |
+ *   | LT_BATCH_R_CONFIG_WRITE         | address (2), object (4)       | -                              |
+ *   | LT_BATCH_R_CONFIG_READ          | address (2)                   | object (4)                     |
+ *   | LT_BATCH_R_CONFIG_ERASE         | -                             | -                              |
+ *   | LT_BATCH_I_CONFIG_WRITE         | address (2), bit index (1)    | -                              |
+ *   | LT_BATCH_I_CONFIG_READ          | address (2)                   | object (4)                     |
+ *   | LT_BATCH_R_MEM_DATA_WRITE       | slot (2), data (*)            | -                              |
+ *   | LT_BATCH_R_MEM_DATA_READ        | slot (2), maximal size (2)    | data (*)                       |
+ *   | LT_BATCH_R_MEM_DATA_ERASE       | slot (2)                      | -                              |
+ *   | LT_BATCH_RANDOM_VALUE_GET       | count (2)                     | random bytes (count)           |
+ *   | LT_BATCH_ECC_KEY_GENERATE       | slot (1), curve (1)           | -                              |
+ *   | LT_BATCH_ECC_KEY_STORE          | slot (1), curve (1), key (32) | -                              |
+ *   | LT_BATCH_ECC_KEY_READ           | slot (1), maximal size (1)    | curve (1), origin (1), key (*) |
+ *   | LT_BATCH_ECC_KEY_ERASE          | slot (1)                      | -                              |
+ *   | LT_BATCH_ECDSA_SIGN             | slot (1), message (*)         | signature (64)                 |
+ *   | LT_BATCH_EDDSA_SIGN             | slot (1), message (*)         | signature (64)                 |
+ *   | LT_BATCH_MCOUNTER_INIT          | index (1), value (4)          | -                              |
+ *   | LT_BATCH_MCOUNTER_UPDATE        | index (1)                     | -                              |
+ *   | LT_BATCH_MCOUNTER_GET           | index (1)                     | value (4)                      |
+ *   | LT_BATCH_MAC_AND_DESTROY        | slot (1), data (32)           | data (32)                      |
+ *
+ * A response with `ret` other than LT_OK has no payload.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdint.h>
+
+#include "libtropic_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Version of the protocol, returned by LT_SD_OP_INFO. */
+#define LT_SD_PROTO_VERSION 1
+/** @brief Operation returning protocol version and number of chips, other operations are `lt_batch_cmd_id_t`. */
+#define LT_SD_OP_INFO 0xFF
+/**
+ * @brief Result of a request refused by the daemon's access policy.
+ * @details Not an `lt_ret_t` value, the highest value of the `ret` byte is used so it never collides with the results
+ * of libtropic. lt_ret_verbose() does not know it.
+ */
+#define LT_SESSIOND_DENIED ((lt_ret_t)0xFF)
+/** @brief Maximal size of a payload, fits the biggest Ping message and signed message with the slot. */
+#define LT_SD_PAYLOAD_MAX (TR01_PING_LEN_MAX + 1)
+
+/** @brief Header of a request. */
+typedef struct lt_sd_req_hdr_t {
+    uint16_t len; /**< Size of the payload */
+    uint8_t op;   /**< Operation */
+    uint8_t chip; /**< Index of the chip */
+    uint32_t tag; /**< Chosen by the client, returned in the response */
+} __attribute__((packed)) lt_sd_req_hdr_t;
+
+/** @brief Header of a response. */
+typedef struct lt_sd_res_hdr_t {
+    uint16_t len; /**< Size of the payload */
+    uint8_t ret;  /**< Result, `lt_ret_t` or LT_SESSIOND_DENIED */
+    uint8_t rfu;  /**< Reserved, 0 */
+    uint32_t tag; /**< Tag of the request */
+} __attribute__((packed)) lt_sd_res_hdr_t;
+
+/** @brief Storage for the outputs of a decoded request, used by the daemon. */
+typedef struct lt_sd_out_t {
+    uint8_t data[LT_SD_PAYLOAD_MAX]; /**< Byte outputs */
+    uint32_t u32;                    /**< Config object or counter value */
+    uint16_t size;                   /**< Size of read R memory data */
+    lt_ecc_curve_type_t curve;       /**< Curve of read ECC key */
+    lt_ecc_key_origin_t origin;      /**< Origin of read ECC key */
+} lt_sd_out_t;
+
+/**
+ * @brief Serializes inputs of a command into a request payload.
+ *
+ * @param cmd      Command, `id` is the operation
+ * @param payload  Buffer with LT_SD_PAYLOAD_MAX bytes
+ * @param len      Size of the payload
+ *
+ * @retval         LT_OK Function executed successfully
+ * @retval         LT_PARAM_ERR Unknown operation, missing input or too big payload
+ */
+lt_ret_t lt_sd_req_encode(const lt_batch_cmd_t *cmd, uint8_t *payload, uint16_t *len);
+
+/**
+ * @brief Parses a request payload into a command.
+ * @details Inputs point into `payload`, outputs into `out`, so both have to outlive the command.
+ *
+ * @param op       Operation from the header
+ * @param payload  Payload
+ * @param len      Size of the payload
+ * @param cmd      Command
+ * @param out      Storage for the outputs
+ *
+ * @retval         LT_OK Function executed successfully
+ * @retval         LT_PARAM_ERR Unknown operation or malformed payload
+ */
+lt_ret_t lt_sd_req_decode(const uint8_t op, const uint8_t *payload, const uint16_t len, lt_batch_cmd_t *cmd,
+                          lt_sd_out_t *out);
+
+/**
+ * @brief Serializes outputs of an executed command into a response payload.
+ *
+ * @param cmd      Command executed with `ret` LT_OK
+ * @param payload  Buffer with LT_SD_PAYLOAD_MAX bytes
+ * @param len      Size of the payload
+ *
+ * @retval         LT_OK Function executed successfully
+ * @retval         LT_PARAM_ERR Unknown operation
+ */
+lt_ret_t lt_sd_res_encode(const lt_batch_cmd_t *cmd, uint8_t *payload, uint16_t *len);
+
+/**
+ * @brief Copies a response payload into the outputs of a command.
+ *
+ * @param payload  Payload
+ * @param len      Size of the payload
+ * @param cmd      Command the request was encoded from
+ *
+ * @retval         LT_OK Function executed successfully
+ * @retval         LT_FAIL Payload does not match the command
+ */
+lt_ret_t lt_sd_res_decode(const uint8_t *payload, const uint16_t len, lt_batch_cmd_t *cmd);
+
+/**
+ * @brief Returns name of an operation, as used in lt_sessiond policy files.
+ *
+ * @param op  Operation
+ * @return    Name of the operation, NULL for unknown operation
+ */
+const char *lt_sd_op_str(const uint8_t op);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LT_SESSIOND_PROTO_H
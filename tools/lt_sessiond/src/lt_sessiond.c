@@ -0,0 +1,659 @@
+/**
+ * @file lt_sessiond.c
+ * @brief Session daemon owning TROPIC01 chips and serving local clients
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // struct ucred, accept4(), pipe2()
+#endif
+
+#include "lt_sessiond.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_logging.h"
+#include "lt_sessiond_proto.h"
+#include "lt_tools_session.h"
+
+/** @brief How long a response can wait for a slow client before it is disconnected. */
+#define LT_SESSIOND_SEND_TIMEOUT_S 1
+
+/** @brief Request received from a client. */
+typedef struct lt_sessiond_req_t {
+    struct lt_sessiond_req_t *next;     /**< Next request in a queue or in the done list */
+    uint16_t client;                    /**< Index of the client */
+    uint32_t tag;                       /**< Tag from the request header */
+    lt_batch_cmd_t cmd;                 /**< Decoded command */
+    lt_sd_out_t out;                    /**< Outputs of the command */
+    uint8_t payload[LT_SD_PAYLOAD_MAX]; /**< Request payload, inputs of the command point here */
+} lt_sessiond_req_t;
+
+static bool lt_sessiond_in(const lt_sessiond_range_t *range, const uint32_t value)
+{
+    return (value >= range->first) && (value <= range->last);
+}
+
+static bool lt_sessiond_allowed(const lt_sessiond_rule_t *rule, const uint8_t chip, const lt_batch_cmd_t *cmd)
+{
+    if (!(rule->ops & (UINT32_C(1) << cmd->id)) || !lt_sessiond_in(&rule->chips, chip)) {
+        return false;
+    }
+
+    switch (cmd->id) {
+        case LT_BATCH_R_MEM_DATA_WRITE:
+            return lt_sessiond_in(&rule->r_mem_slots, cmd->args.r_mem_data_write.udata_slot);
+        case LT_BATCH_R_MEM_DATA_READ:
+            return lt_sessiond_in(&rule->r_mem_slots, cmd->args.r_mem_data_read.udata_slot);
+        case LT_BATCH_R_MEM_DATA_ERASE:
+            return lt_sessiond_in(&rule->r_mem_slots, cmd->args.r_mem_data_erase.udata_slot);
+        case LT_BATCH_ECC_KEY_GENERATE:
+            return lt_sessiond_in(&rule->ecc_slots, cmd->args.ecc_key_generate.slot);
+        case LT_BATCH_ECC_KEY_STORE:
+            return lt_sessiond_in(&rule->ecc_slots, cmd->args.ecc_key_store.slot);
+        case LT_BATCH_ECC_KEY_READ:
+            return lt_sessiond_in(&rule->ecc_slots, cmd->args.ecc_key_read.slot);
+        case LT_BATCH_ECC_KEY_ERASE:
+            return lt_sessiond_in(&rule->ecc_slots, cmd->args.ecc_key_erase.slot);
+        case LT_BATCH_ECDSA_SIGN:
+            return lt_sessiond_in(&rule->ecc_slots, cmd->args.ecdsa_sign.slot);
+        case LT_BATCH_EDDSA_SIGN:
+            return lt_sessiond_in(&rule->ecc_slots, cmd->args.eddsa_sign.slot);
+        case LT_BATCH_MCOUNTER_INIT:
+            return lt_sessiond_in(&rule->mcounters, cmd->args.mcounter_init.mcounter_index);
+        case LT_BATCH_MCOUNTER_UPDATE:
+            return lt_sessiond_in(&rule->mcounters, cmd->args.mcounter_update.mcounter_index);
+        case LT_BATCH_MCOUNTER_GET:
+            return lt_sessiond_in(&rule->mcounters, cmd->args.mcounter_get.mcounter_index);
+        case LT_BATCH_MAC_AND_DESTROY:
+            return lt_sessiond_in(&rule->mac_and_destroy_slots, cmd->args.mac_and_destroy.slot);
+        default:
+            return true;
+    }
+}
+
+static void lt_sessiond_wake(lt_sessiond_t *sd, const char reason)
+{
+    // Pipe is non-blocking, a full pipe already guarantees the event loop wakes up
+    ssize_t ret = write(sd->wake_pipe[1], &reason, 1);
+    (void)ret;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Worker threads
+
+static void lt_sessiond_execute(lt_sessiond_chip_t *chip, lt_sessiond_req_t **reqs, const uint16_t cnt)
+{
+    lt_handle_t *h = chip->ses.h;
+    lt_batch_cmd_t cmds[LT_SESSIOND_BATCH_MAX];
+
+    lt_ret_t ret = lt_tools_session_open(&chip->ses);
+    if (ret != LT_OK) {
+        LT_LOG_WARN("Chip %u: cannot start Secure Session: %s", chip->idx, lt_ret_verbose(ret));
+    }
+
+    for (uint16_t i = 0; i < cnt; i++) {
+        cmds[i] = reqs[i]->cmd;
+        cmds[i].ret = LT_BATCH_NOT_EXECUTED;
+    }
+
+    if (ret == LT_OK) {
+        ret = lt_batch_run(h, cmds, cnt, chip->stage, sizeof(chip->stage), false);
+        if (ret == LT_PARAM_ERR && cmds[0].ret == LT_BATCH_NOT_EXECUTED) {
+            // Batch was rejected as a whole, do not let one malformed request fail the others
+            for (uint16_t i = 0; i < cnt; i++) {
+                ret = lt_batch_run(h, &cmds[i], 1, chip->stage, sizeof(chip->stage), false);
+                if (cmds[i].ret == LT_BATCH_NOT_EXECUTED) {
+                    cmds[i].ret = ret;
+                }
+            }
+        }
+    }
+
+    for (uint16_t i = 0; i < cnt; i++) {
+        if (cmds[i].ret == LT_BATCH_NOT_EXECUTED) {
+            cmds[i].ret = (ret != LT_OK) ? ret : LT_FAIL;
+        }
+        lt_tools_session_check(&chip->ses, cmds[i].ret);
+        reqs[i]->cmd.ret = cmds[i].ret;
+    }
+}
+
+/** @brief Takes up to `batch_max` requests, one per client and round. Called with the lock held. */
+static uint16_t lt_sessiond_pick(lt_sessiond_chip_t *chip, lt_sessiond_req_t **reqs)
+{
+    lt_sessiond_t *sd = chip->sd;
+    uint16_t cnt = 0;
+    bool progress = true;
+
+    while (progress && cnt < sd->cfg.batch_max) {
+        progress = false;
+        for (uint16_t k = 0; k < LT_SESSIOND_CLIENTS_MAX && cnt < sd->cfg.batch_max; k++) {
+            uint16_t i = (uint16_t)((chip->next_client + k) % LT_SESSIOND_CLIENTS_MAX);
+            lt_sessiond_req_t *req = sd->clients[i].queue[chip->idx].head;
+            if (!req) {
+                continue;
+            }
+            sd->clients[i].queue[chip->idx].head = req->next;
+            if (!req->next) {
+                sd->clients[i].queue[chip->idx].tail = NULL;
+            }
+            req->next = NULL;
+            reqs[cnt++] = req;
+            progress = true;
+        }
+    }
+
+    // Start the next batch with the client after the first one served now
+    if (cnt > 0) {
+        chip->next_client = (uint16_t)((reqs[0]->client + 1) % LT_SESSIOND_CLIENTS_MAX);
+    }
+
+    return cnt;
+}
+
+static void *lt_sessiond_worker(void *arg)
+{
+    lt_sessiond_chip_t *chip = arg;
+    lt_sessiond_t *sd = chip->sd;
+    lt_sessiond_req_t *reqs[LT_SESSIOND_BATCH_MAX];
+
+    pthread_mutex_lock(&sd->lock);
+    while (!sd->stopping) {
+        uint16_t cnt = lt_sessiond_pick(chip, reqs);
+        if (cnt == 0) {
+            pthread_cond_wait(&chip->cond, &sd->lock);
+            continue;
+        }
+        pthread_mutex_unlock(&sd->lock);
+
+        lt_sessiond_execute(chip, reqs, cnt);
+
+        pthread_mutex_lock(&sd->lock);
+        for (uint16_t i = 0; i < cnt; i++) {
+            if (sd->done_tail) {
+                sd->done_tail->next = reqs[i];
+            }
+            else {
+                sd->done_head = reqs[i];
+            }
+            sd->done_tail = reqs[i];
+        }
+        lt_sessiond_wake(sd, 'd');
+    }
+    pthread_mutex_unlock(&sd->lock);
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Event loop
+
+static void lt_sessiond_client_close(lt_sessiond_t *sd, const uint16_t idx)
+{
+    lt_sessiond_client_t *client = &sd->clients[idx];
+
+    pthread_mutex_lock(&sd->lock);
+    for (uint8_t chip = 0; chip < LT_SESSIOND_CHIPS_MAX; chip++) {
+        lt_sessiond_req_t *req = client->queue[chip].head;
+        while (req) {
+            lt_sessiond_req_t *next = req->next;
+            free(req);
+            client->pending--;
+            req = next;
+        }
+        client->queue[chip].head = NULL;
+        client->queue[chip].tail = NULL;
+    }
+    pthread_mutex_unlock(&sd->lock);
+
+    if (client->fd >= 0) {
+        close(client->fd);
+        client->fd = -1;
+    }
+    // Requests being executed still refer to the slot, it is released when the last one is done
+    if (client->pending == 0) {
+        client->used = false;
+    }
+}
+
+static void lt_sessiond_respond(lt_sessiond_t *sd, const uint16_t idx, const uint32_t tag, const lt_ret_t ret,
+                                const uint8_t *payload, const uint16_t len)
+{
+    lt_sessiond_client_t *client = &sd->clients[idx];
+    uint8_t frame[sizeof(lt_sd_res_hdr_t) + LT_SD_PAYLOAD_MAX];
+    lt_sd_res_hdr_t hdr = {.len = len, .ret = (uint8_t)ret, .rfu = 0, .tag = tag};
+
+    memcpy(frame, &hdr, sizeof(hdr));
+    if (len) {
+        memcpy(frame + sizeof(hdr), payload, len);
+    }
+
+    size_t total = sizeof(hdr) + len;
+    size_t sent = 0;
+    while (sent < total) {
+        ssize_t n = send(client->fd, frame + sent, total - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            LT_LOG_WARN("Client %u: send failed, disconnecting", idx);
+            lt_sessiond_client_close(sd, idx);
+            return;
+        }
+        sent += (size_t)n;
+    }
+}
+
+static void lt_sessiond_done(lt_sessiond_t *sd)
+{
+    pthread_mutex_lock(&sd->lock);
+    lt_sessiond_req_t *req = sd->done_head;
+    sd->done_head = NULL;
+    sd->done_tail = NULL;
+    pthread_mutex_unlock(&sd->lock);
+
+    while (req) {
+        lt_sessiond_req_t *next = req->next;
+        lt_sessiond_client_t *client = &sd->clients[req->client];
+
+        client->pending--;
+        if (client->fd >= 0) {
+            uint8_t payload[LT_SD_PAYLOAD_MAX];
+            uint16_t len = 0;
+            lt_ret_t ret = req->cmd.ret;
+            if (ret == LT_OK && lt_sd_res_encode(&req->cmd, payload, &len) != LT_OK) {
+                ret = LT_FAIL;
+                len = 0;
+            }
+            lt_sessiond_respond(sd, req->client, req->tag, ret, payload, len);
+        }
+        else if (client->pending == 0) {
+            client->used = false;
+        }
+
+        free(req);
+        req = next;
+    }
+}
+
+static void lt_sessiond_accept(lt_sessiond_t *sd)
+{
+    int fd = accept4(sd->listen_fd, NULL, NULL, SOCK_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+
+    struct ucred cred;
+    socklen_t cred_len = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) != 0) {
+        close(fd);
+        return;
+    }
+
+    const lt_sessiond_rule_t *rule = NULL;
+    for (uint16_t i = 0; i < sd->cfg.rule_cnt; i++) {
+        if (sd->cfg.rules[i].any_uid || sd->cfg.rules[i].uid == cred.uid) {
+            rule = &sd->cfg.rules[i];
+            break;
+        }
+    }
+    if (!rule) {
+        LT_LOG_WARN("No policy rule for uid %u, connection refused", (unsigned)cred.uid);
+        close(fd);
+        return;
+    }
+
+    uint16_t idx;
+    for (idx = 0; idx < LT_SESSIOND_CLIENTS_MAX; idx++) {
+        if (!sd->clients[idx].used) {
+            break;
+        }
+    }
+    if (idx == LT_SESSIOND_CLIENTS_MAX) {
+        LT_LOG_WARN("Too many clients, connection refused");
+        close(fd);
+        return;
+    }
+
+    struct timeval timeout = {.tv_sec = LT_SESSIOND_SEND_TIMEOUT_S, .tv_usec = 0};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    lt_sessiond_client_t *client = &sd->clients[idx];
+    memset(client, 0, sizeof(*client));
+    client->used = true;
+    client->fd = fd;
+    client->uid = cred.uid;
+    client->rule = rule;
+}
+
+static void lt_sessiond_request(lt_sessiond_t *sd, const uint16_t idx)
+{
+    lt_sessiond_client_t *client = &sd->clients[idx];
+    lt_sd_req_hdr_t hdr;
+
+    memcpy(&hdr, client->rx, sizeof(hdr));
+    const uint8_t *payload = client->rx + sizeof(hdr);
+
+    if (hdr.op == LT_SD_OP_INFO) {
+        uint8_t info[2] = {LT_SD_PROTO_VERSION, sd->cfg.chip_cnt};
+        lt_sessiond_respond(sd, idx, hdr.tag, hdr.len ? LT_PARAM_ERR : LT_OK, info, hdr.len ? 0 : sizeof(info));
+        return;
+    }
+    if (hdr.chip >= sd->cfg.chip_cnt) {
+        lt_sessiond_respond(sd, idx, hdr.tag, LT_PARAM_ERR, NULL, 0);
+        return;
+    }
+
+    lt_sessiond_req_t *req = malloc(sizeof(*req));
+    if (!req) {
+        lt_sessiond_respond(sd, idx, hdr.tag, LT_FAIL, NULL, 0);
+        return;
+    }
+    memcpy(req->payload, payload, hdr.len);
+    req->next = NULL;
+    req->client = idx;
+    req->tag = hdr.tag;
+
+    lt_ret_t ret = lt_sd_req_decode(hdr.op, req->payload, hdr.len, &req->cmd, &req->out);
+    if (ret == LT_OK && !lt_sessiond_allowed(client->rule, hdr.chip, &req->cmd)) {
+        LT_LOG_WARN("Client %u (uid %u): %s on chip %u denied", idx, (unsigned)client->uid, lt_sd_op_str(hdr.op),
+                    hdr.chip);
+        ret = LT_SESSIOND_DENIED;
+    }
+    if (ret != LT_OK) {
+        free(req);
+        lt_sessiond_respond(sd, idx, hdr.tag, ret, NULL, 0);
+        return;
+    }
+
+    pthread_mutex_lock(&sd->lock);
+    if (client->queue[hdr.chip].tail) {
+        client->queue[hdr.chip].tail->next = req;
+    }
+    else {
+        client->queue[hdr.chip].head = req;
+    }
+    client->queue[hdr.chip].tail = req;
+    client->pending++;
+    pthread_cond_signal(&sd->chips[hdr.chip].cond);
+    pthread_mutex_unlock(&sd->lock);
+}
+
+static void lt_sessiond_receive(lt_sessiond_t *sd, const uint16_t idx)
+{
+    lt_sessiond_client_t *client = &sd->clients[idx];
+
+    while (client->fd >= 0 && client->pending < sd->cfg.queue_depth) {
+        size_t want = sizeof(lt_sd_req_hdr_t) - client->rx_len;
+        if (client->rx_len >= sizeof(lt_sd_req_hdr_t)) {
+            lt_sd_req_hdr_t hdr;
+            memcpy(&hdr, client->rx, sizeof(hdr));
+            want = sizeof(hdr) + hdr.len - client->rx_len;
+        }
+
+        if (want > 0) {
+            ssize_t n = recv(client->fd, client->rx + client->rx_len, want, MSG_DONTWAIT);
+            if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+                return;
+            }
+            if (n <= 0) {
+                lt_sessiond_client_close(sd, idx);
+                return;
+            }
+            client->rx_len = (uint16_t)(client->rx_len + n);
+        }
+
+        if (client->rx_len < sizeof(lt_sd_req_hdr_t)) {
+            continue;
+        }
+
+        lt_sd_req_hdr_t hdr;
+        memcpy(&hdr, client->rx, sizeof(hdr));
+        if (hdr.len > LT_SD_PAYLOAD_MAX) {
+            LT_LOG_WARN("Client %u: payload too big, disconnecting", idx);
+            lt_sessiond_client_close(sd, idx);
+            return;
+        }
+        if (client->rx_len == sizeof(hdr) + hdr.len) {
+            lt_sessiond_request(sd, idx);
+            client->rx_len = 0;
+        }
+    }
+}
+
+lt_ret_t lt_sessiond_run(lt_sessiond_t *sd)
+{
+    if (!sd) {
+        return LT_PARAM_ERR;
+    }
+
+    struct pollfd fds[2 + LT_SESSIOND_CLIENTS_MAX];
+    uint16_t fd_client[2 + LT_SESSIOND_CLIENTS_MAX];
+    bool stop = false;
+
+    while (!stop) {
+        nfds_t nfds = 0;
+        fds[nfds++] = (struct pollfd){.fd = sd->wake_pipe[0], .events = POLLIN};
+        fds[nfds++] = (struct pollfd){.fd = sd->listen_fd, .events = POLLIN};
+        for (uint16_t i = 0; i < LT_SESSIOND_CLIENTS_MAX; i++) {
+            if (sd->clients[i].used && sd->clients[i].fd >= 0) {
+                // Stop reading from clients with full queues, they wait until their requests complete
+                short events = (sd->clients[i].pending < sd->cfg.queue_depth) ? POLLIN : 0;
+                fd_client[nfds] = i;
+                fds[nfds++] = (struct pollfd){.fd = sd->clients[i].fd, .events = events};
+            }
+        }
+
+        if (poll(fds, nfds, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LT_LOG_ERROR("poll() failed: %s", strerror(errno));
+            return LT_FAIL;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            char reasons[64];
+            ssize_t n;
+            while ((n = read(sd->wake_pipe[0], reasons, sizeof(reasons))) > 0) {
+                if (memchr(reasons, 's', (size_t)n)) {
+                    stop = true;
+                }
+            }
+        }
+
+        lt_sessiond_done(sd);
+
+        if (fds[1].revents & POLLIN) {
+            lt_sessiond_accept(sd);
+        }
+
+        for (nfds_t i = 2; i < nfds; i++) {
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                uint16_t idx = fd_client[i];
+                if (fds[i].revents & POLLIN) {
+                    lt_sessiond_receive(sd, idx);
+                }
+                else if (sd->clients[idx].fd >= 0) {
+                    lt_sessiond_client_close(sd, idx);
+                }
+            }
+        }
+    }
+
+    return LT_OK;
+}
+
+void lt_sessiond_stop(lt_sessiond_t *sd)
+{
+    if (sd) {
+        lt_sessiond_wake(sd, 's');
+    }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+// Setup
+
+static lt_ret_t lt_sessiond_listen(lt_sessiond_t *sd)
+{
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    strncpy(addr.sun_path, sd->cfg.socket_path, sizeof(addr.sun_path) - 1);
+
+    sd->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sd->listen_fd < 0) {
+        LT_LOG_ERROR("socket() failed: %s", strerror(errno));
+        return LT_FAIL;
+    }
+
+    unlink(sd->cfg.socket_path);
+    if (bind(sd->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        LT_LOG_ERROR("Cannot bind %s: %s", sd->cfg.socket_path, strerror(errno));
+        return LT_FAIL;
+    }
+    // Access is controlled by the policy, not by file permissions
+    if (chmod(sd->cfg.socket_path, 0666) != 0 || listen(sd->listen_fd, 16) != 0) {
+        LT_LOG_ERROR("Cannot listen on %s: %s", sd->cfg.socket_path, strerror(errno));
+        return LT_FAIL;
+    }
+
+    return LT_OK;
+}
+
+lt_ret_t lt_sessiond_init(lt_sessiond_t *sd, const lt_sessiond_cfg_t *cfg)
+{
+    if (!sd || !cfg || !cfg->socket_path || !cfg->chips || cfg->chip_cnt == 0 || cfg->chip_cnt > LT_SESSIOND_CHIPS_MAX
+        || (cfg->rule_cnt && !cfg->rules) || cfg->batch_max > LT_SESSIOND_BATCH_MAX
+        || strlen(cfg->socket_path) >= sizeof(((struct sockaddr_un *)NULL)->sun_path)) {
+        return LT_PARAM_ERR;
+    }
+    for (uint8_t i = 0; i < cfg->chip_cnt; i++) {
+        if (!cfg->chips[i].h || !cfg->chips[i].sh_priv || !cfg->chips[i].sh_pub) {
+            return LT_PARAM_ERR;
+        }
+    }
+
+    memset(sd, 0, sizeof(*sd));
+    sd->cfg = *cfg;
+    if (sd->cfg.queue_depth == 0) {
+        sd->cfg.queue_depth = LT_SESSIOND_QUEUE_DEPTH_DEFAULT;
+    }
+    if (sd->cfg.batch_max == 0) {
+        sd->cfg.batch_max = LT_SESSIOND_BATCH_DEFAULT;
+    }
+    sd->listen_fd = -1;
+    sd->wake_pipe[0] = -1;
+    sd->wake_pipe[1] = -1;
+    pthread_mutex_init(&sd->lock, NULL);
+    for (uint8_t i = 0; i < LT_SESSIOND_CHIPS_MAX; i++) {
+        sd->chips[i].sd = sd;
+        sd->chips[i].idx = i;
+        pthread_cond_init(&sd->chips[i].cond, NULL);
+    }
+
+    lt_ret_t ret = LT_OK;
+    for (uint8_t i = 0; i < cfg->chip_cnt; i++) {
+        const lt_sessiond_chip_cfg_t *chip = &cfg->chips[i];
+        sd->chips[i].ses.h = chip->h;
+        sd->chips[i].ses.sh_priv = chip->sh_priv;
+        sd->chips[i].ses.sh_pub = chip->sh_pub;
+        sd->chips[i].ses.pkey_index = chip->pkey_index;
+
+        ret = lt_tools_session_open(&sd->chips[i].ses);
+        if (ret != LT_OK) {
+            LT_LOG_ERROR("Chip %u: cannot start Secure Session: %s", i, lt_ret_verbose(ret));
+            goto fail;
+        }
+    }
+
+    if (pipe2(sd->wake_pipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+        ret = LT_FAIL;
+        goto fail;
+    }
+
+    ret = lt_sessiond_listen(sd);
+    if (ret != LT_OK) {
+        goto fail;
+    }
+
+    for (uint8_t i = 0; i < cfg->chip_cnt; i++) {
+        if (pthread_create(&sd->chips[i].thread, NULL, lt_sessiond_worker, &sd->chips[i]) != 0) {
+            ret = LT_FAIL;
+            goto fail;
+        }
+        sd->chips[i].thread_started = true;
+    }
+
+    return LT_OK;
+
+fail:
+    lt_sessiond_deinit(sd);
+    return ret;
+}
+
+lt_ret_t lt_sessiond_deinit(lt_sessiond_t *sd)
+{
+    if (!sd) {
+        return LT_PARAM_ERR;
+    }
+
+    pthread_mutex_lock(&sd->lock);
+    sd->stopping = true;
+    for (uint8_t i = 0; i < LT_SESSIOND_CHIPS_MAX; i++) {
+        pthread_cond_broadcast(&sd->chips[i].cond);
+    }
+    pthread_mutex_unlock(&sd->lock);
+
+    for (uint8_t i = 0; i < LT_SESSIOND_CHIPS_MAX; i++) {
+        if (sd->chips[i].thread_started) {
+            pthread_join(sd->chips[i].thread, NULL);
+            sd->chips[i].thread_started = false;
+        }
+    }
+
+    // Workers are gone, answer what they finished and drop the rest
+    lt_sessiond_done(sd);
+    for (uint16_t i = 0; i < LT_SESSIOND_CLIENTS_MAX; i++) {
+        if (sd->clients[i].used) {
+            lt_sessiond_client_close(sd, i);
+        }
+        sd->clients[i].used = false;
+    }
+
+    if (sd->listen_fd >= 0) {
+        close(sd->listen_fd);
+        unlink(sd->cfg.socket_path);
+        sd->listen_fd = -1;
+    }
+    for (uint8_t i = 0; i < 2; i++) {
+        if (sd->wake_pipe[i] >= 0) {
+            close(sd->wake_pipe[i]);
+            sd->wake_pipe[i] = -1;
+        }
+    }
+
+    for (uint8_t i = 0; i < LT_SESSIOND_CHIPS_MAX; i++) {
+        lt_tools_session_close(&sd->chips[i].ses);
+        pthread_cond_destroy(&sd->chips[i].cond);
+    }
+    pthread_mutex_destroy(&sd->lock);
+
+    return LT_OK;
+}
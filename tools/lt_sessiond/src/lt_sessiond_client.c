@@ -0,0 +1,369 @@
+/**
+ * @file lt_sessiond_client.c
+ * @brief Client library of lt_sessiond
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include "lt_sessiond_client.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "libtropic_common.h"
+#include "libtropic_logging.h"
+#include "lt_sessiond_proto.h"
+
+static bool lt_sd_write_all(const int fd, const uint8_t *buff, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = send(fd, buff, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        buff += n;
+        len -= (size_t)n;
+    }
+
+    return true;
+}
+
+static bool lt_sd_read_all(const int fd, uint8_t *buff, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = recv(fd, buff, len, 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (n == 0) {
+            // Daemon closed the connection
+            return false;
+        }
+        buff += n;
+        len -= (size_t)n;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Sends the request prepared in the frame buffer and receives the response payload into the frame buffer.
+ *
+ * @retval  other Result reported by the daemon
+ * @retval  LT_FAIL Connection failed or response does not belong to the request
+ */
+static lt_ret_t lt_sd_transact(lt_sd_client_t *c, const uint8_t op, const uint16_t len, uint16_t *res_len)
+{
+    lt_sd_req_hdr_t req = {.len = len, .op = op, .chip = c->chip, .tag = ++c->tag};
+    lt_sd_res_hdr_t res;
+
+    memcpy(c->buff, &req, sizeof(req));
+    if (!lt_sd_write_all(c->fd, c->buff, sizeof(req) + len)) {
+        LT_LOG_ERROR("Could not send request to lt_sessiond: %s", strerror(errno));
+        return LT_FAIL;
+    }
+
+    if (!lt_sd_read_all(c->fd, (uint8_t *)&res, sizeof(res))) {
+        LT_LOG_ERROR("Could not receive response from lt_sessiond.");
+        return LT_FAIL;
+    }
+    if ((res.tag != req.tag) || (res.len > LT_SD_PAYLOAD_MAX)) {
+        LT_LOG_ERROR("Unexpected response from lt_sessiond.");
+        return LT_FAIL;
+    }
+    if (!lt_sd_read_all(c->fd, c->buff, res.len)) {
+        LT_LOG_ERROR("Could not receive response from lt_sessiond.");
+        return LT_FAIL;
+    }
+
+    *res_len = res.len;
+    return (lt_ret_t)res.ret;
+}
+
+lt_ret_t lt_sd_connect(lt_sd_client_t *c, const char *socket_path)
+{
+    if (!c || !socket_path) {
+        return LT_PARAM_ERR;
+    }
+
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        return LT_PARAM_ERR;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    c->chip = 0;
+    c->tag = 0;
+    c->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (c->fd < 0) {
+        LT_LOG_ERROR("Could not create socket: %s", strerror(errno));
+        return LT_FAIL;
+    }
+    if (connect(c->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        LT_LOG_ERROR("Could not connect to %s: %s", socket_path, strerror(errno));
+        close(c->fd);
+        c->fd = -1;
+        return LT_FAIL;
+    }
+
+    return LT_OK;
+}
+
+lt_ret_t lt_sd_disconnect(lt_sd_client_t *c)
+{
+    if (!c) {
+        return LT_PARAM_ERR;
+    }
+
+    if (c->fd >= 0) {
+        close(c->fd);
+        c->fd = -1;
+    }
+
+    return LT_OK;
+}
+
+lt_ret_t lt_sd_chip_cnt(lt_sd_client_t *c, uint8_t *chip_cnt)
+{
+    if (!c || (c->fd < 0) || !chip_cnt) {
+        return LT_PARAM_ERR;
+    }
+
+    uint16_t res_len;
+    lt_ret_t ret = lt_sd_transact(c, LT_SD_OP_INFO, 0, &res_len);
+    if (ret != LT_OK) {
+        return ret;
+    }
+    if ((res_len != 2) || (c->buff[0] != LT_SD_PROTO_VERSION)) {
+        LT_LOG_ERROR("Unsupported lt_sessiond protocol version.");
+        return LT_FAIL;
+    }
+
+    *chip_cnt = c->buff[1];
+    return LT_OK;
+}
+
+lt_ret_t lt_sd_call(lt_sd_client_t *c, lt_batch_cmd_t *cmd)
+{
+    if (!c || (c->fd < 0) || !cmd) {
+        return LT_PARAM_ERR;
+    }
+
+    uint16_t len, res_len;
+    lt_ret_t ret = lt_sd_req_encode(cmd, &c->buff[sizeof(lt_sd_req_hdr_t)], &len);
+    if (ret == LT_OK) {
+        ret = lt_sd_transact(c, (uint8_t)cmd->id, len, &res_len);
+    }
+    if (ret == LT_OK) {
+        ret = lt_sd_res_decode(c->buff, res_len, cmd);
+    }
+
+    cmd->ret = ret;
+    return ret;
+}
+
+lt_ret_t lt_sd_ping(lt_sd_client_t *c, const uint8_t *msg_out, uint8_t *msg_in, const uint16_t msg_len)
+{
+    if (!msg_in) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_PING, .args.ping = {msg_out, msg_in, msg_len}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_pairing_key_write(lt_sd_client_t *c, const uint8_t *pairing_pub, const uint8_t slot)
+{
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_PAIRING_KEY_WRITE, .args.pairing_key_write = {pairing_pub, slot}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_pairing_key_read(lt_sd_client_t *c, uint8_t *pairing_pub, const uint8_t slot)
+{
+    if (!pairing_pub) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_PAIRING_KEY_READ, .args.pairing_key_read = {pairing_pub, slot}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_pairing_key_invalidate(lt_sd_client_t *c, const uint8_t slot)
+{
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_PAIRING_KEY_INVALIDATE, .args.pairing_key_invalidate = {slot}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_r_config_write(lt_sd_client_t *c, const enum lt_config_obj_addr_t addr, const uint32_t obj)
+{
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_R_CONFIG_WRITE, .args.r_config_write = {addr, obj}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_r_config_read(lt_sd_client_t *c, const enum lt_config_obj_addr_t addr, uint32_t *obj)
+{
+    if (!obj) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_R_CONFIG_READ, .args.r_config_read = {addr, obj}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_r_config_erase(lt_sd_client_t *c)
+{
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_R_CONFIG_ERASE};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_i_config_write(lt_sd_client_t *c, const enum lt_config_obj_addr_t addr, const uint8_t bit_index)
+{
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_I_CONFIG_WRITE, .args.i_config_write = {addr, bit_index}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_i_config_read(lt_sd_client_t *c, const enum lt_config_obj_addr_t addr, uint32_t *obj)
+{
+    if (!obj) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_I_CONFIG_READ, .args.i_config_read = {addr, obj}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_r_mem_data_write(lt_sd_client_t *c, const uint16_t udata_slot, const uint8_t *data,
+                                const uint16_t data_size)
+{
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_R_MEM_DATA_WRITE, .args.r_mem_data_write = {udata_slot, data, data_size}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_r_mem_data_read(lt_sd_client_t *c, const uint16_t udata_slot, uint8_t *data,
+                               const uint16_t data_max_size, uint16_t *data_read_size)
+{
+    if (!data || !data_read_size) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_R_MEM_DATA_READ,
+                          .args.r_mem_data_read = {udata_slot, data, data_max_size, data_read_size}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_r_mem_data_erase(lt_sd_client_t *c, const uint16_t udata_slot)
+{
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_R_MEM_DATA_ERASE, .args.r_mem_data_erase = {udata_slot}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_random_value_get(lt_sd_client_t *c, uint8_t *rnd_bytes, const uint16_t rnd_bytes_cnt)
+{
+    if (!rnd_bytes) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_RANDOM_VALUE_GET, .args.random_value_get = {rnd_bytes, rnd_bytes_cnt}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_ecc_key_generate(lt_sd_client_t *c, const lt_ecc_slot_t slot, const lt_ecc_curve_type_t curve)
+{
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_ECC_KEY_GENERATE, .args.ecc_key_generate = {slot, curve}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_ecc_key_store(lt_sd_client_t *c, const lt_ecc_slot_t slot, const lt_ecc_curve_type_t curve,
+                             const uint8_t *key)
+{
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_ECC_KEY_STORE, .args.ecc_key_store = {slot, curve, key}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_ecc_key_read(lt_sd_client_t *c, const lt_ecc_slot_t ecc_slot, uint8_t *key, const uint8_t key_max_size,
+                            lt_ecc_curve_type_t *curve, lt_ecc_key_origin_t *origin)
+{
+    if (!key || !curve || !origin) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_batch_cmd_t cmd
+        = {.id = LT_BATCH_ECC_KEY_READ, .args.ecc_key_read = {ecc_slot, key, key_max_size, curve, origin}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_ecc_key_erase(lt_sd_client_t *c, const lt_ecc_slot_t ecc_slot)
+{
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_ECC_KEY_ERASE, .args.ecc_key_erase = {ecc_slot}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_ecc_ecdsa_sign(lt_sd_client_t *c, const lt_ecc_slot_t ecc_slot, const uint8_t *msg,
+                              const uint32_t msg_len, uint8_t *rs)
+{
+    if (!rs) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_ECDSA_SIGN, .args.ecdsa_sign = {ecc_slot, msg, msg_len, rs}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_ecc_eddsa_sign(lt_sd_client_t *c, const lt_ecc_slot_t ecc_slot, const uint8_t *msg,
+                              const uint16_t msg_len, uint8_t *rs)
+{
+    if (!rs) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_EDDSA_SIGN, .args.eddsa_sign = {ecc_slot, msg, msg_len, rs}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_mcounter_init(lt_sd_client_t *c, const enum lt_mcounter_index_t mcounter_index,
+                             const uint32_t mcounter_value)
+{
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_MCOUNTER_INIT, .args.mcounter_init = {mcounter_index, mcounter_value}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_mcounter_update(lt_sd_client_t *c, const enum lt_mcounter_index_t mcounter_index)
+{
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_MCOUNTER_UPDATE, .args.mcounter_update = {mcounter_index}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_mcounter_get(lt_sd_client_t *c, const enum lt_mcounter_index_t mcounter_index,
+                            uint32_t *mcounter_value)
+{
+    if (!mcounter_value) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_MCOUNTER_GET, .args.mcounter_get = {mcounter_index, mcounter_value}};
+    return lt_sd_call(c, &cmd);
+}
+
+lt_ret_t lt_sd_mac_and_destroy(lt_sd_client_t *c, const lt_mac_and_destroy_slot_t slot, const uint8_t *data_out,
+                               uint8_t *data_in)
+{
+    if (!data_in) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_batch_cmd_t cmd = {.id = LT_BATCH_MAC_AND_DESTROY, .args.mac_and_destroy = {slot, data_out, data_in}};
+    return lt_sd_call(c, &cmd);
+}
@@ -0,0 +1,330 @@
+/**
+ * @file lt_sessiond_main.c
+ * @brief Command line front-end of lt_sessiond
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // sigaction(), strtok_r()
+#endif
+
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "lt_sessiond.h"
+#include "lt_sessiond_proto.h"
+#include "lt_tools_dev.h"
+
+/** @brief Maximal number of rules in a policy file. */
+#define LT_SESSIOND_RULES_MAX 64
+/** @brief Maximal length of a policy file line. */
+#define LT_SESSIOND_LINE_MAX 512
+
+static lt_sessiond_t sd;
+static lt_tools_dev_t devs[LT_SESSIOND_CHIPS_MAX];
+static lt_handle_t handles[LT_SESSIOND_CHIPS_MAX];
+static lt_sessiond_chip_cfg_t chips[LT_SESSIOND_CHIPS_MAX];
+static uint8_t keys[LT_SESSIOND_CHIPS_MAX][2][TR01_X25519_KEY_LEN];
+static lt_sessiond_rule_t rules[LT_SESSIOND_RULES_MAX];
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s -s <socket> -c " LT_TOOLS_DEV_SPEC " -k <priv_file>,<pub_file>,<slot> [-c ... -k ...]\n"
+            "          [-p <policy_file>] [-q <queue_depth>] [-b <batch_max>]\n"
+            "\n"
+            "  -s  Path of the Unix domain socket\n"
+            "  -c  Chip, can be repeated\n"
+            "  -k  Pairing keys (raw 32 bytes each) and pairing key slot of the last chip\n"
+            "  -p  Policy file, by default only the daemon's user can connect and run all operations\n"
+            "  -q  Requests a client can have waiting (default %d)\n"
+            "  -b  Requests executed at once, up to %d (default %d)\n",
+            prog, LT_SESSIOND_QUEUE_DEPTH_DEFAULT, LT_SESSIOND_BATCH_MAX, LT_SESSIOND_BATCH_DEFAULT);
+}
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    lt_sessiond_stop(&sd);
+}
+
+static bool parse_uint(const char *str, const unsigned long max, unsigned long *value)
+{
+    char *end;
+    errno = 0;
+    *value = strtoul(str, &end, 0);
+    return errno == 0 && end != str && *end == '\0' && *value <= max;
+}
+
+static bool read_key(const char *path, uint8_t *key)
+{
+    if (!lt_tools_key_read(path, key)) {
+        fprintf(stderr, "Cannot read %s, expected a raw %d byte key\n", path, TR01_X25519_KEY_LEN);
+        return false;
+    }
+    return true;
+}
+
+static bool parse_keys(char *spec, const uint8_t chip)
+{
+    unsigned long slot;
+    char *priv = strtok(spec, ",");
+    char *pub = strtok(NULL, ",");
+    char *slot_str = strtok(NULL, ",");
+
+    if (!priv || !pub || !slot_str || !parse_uint(slot_str, TR01_PAIRING_KEY_SLOT_INDEX_3, &slot)) {
+        return false;
+    }
+    if (!read_key(priv, keys[chip][0]) || !read_key(pub, keys[chip][1])) {
+        return false;
+    }
+    chips[chip].sh_priv = keys[chip][0];
+    chips[chip].sh_pub = keys[chip][1];
+    chips[chip].pkey_index = (lt_pkey_index_t)slot;
+
+    return true;
+}
+
+static bool parse_range(const char *str, lt_sessiond_range_t *range)
+{
+    char buff[32];
+    unsigned long first, last;
+
+    snprintf(buff, sizeof(buff), "%s", str);
+    char *dash = strchr(buff, '-');
+    if (dash) {
+        *dash++ = '\0';
+    }
+    if (!parse_uint(buff, UINT16_MAX, &first) || !parse_uint(dash ? dash : buff, UINT16_MAX, &last) || last < first) {
+        return false;
+    }
+    range->first = (uint16_t)first;
+    range->last = (uint16_t)last;
+
+    return true;
+}
+
+static bool parse_ops(char *list, uint32_t *ops)
+{
+    for (char *op = strtok(list, ","); op; op = strtok(NULL, ",")) {
+        if (strcmp(op, "all") == 0) {
+            *ops = UINT32_MAX;
+            continue;
+        }
+        uint8_t id;
+        for (id = 0; id <= LT_BATCH_MAC_AND_DESTROY; id++) {
+            if (strcmp(op, lt_sd_op_str(id)) == 0) {
+                break;
+            }
+        }
+        if (id > LT_BATCH_MAC_AND_DESTROY) {
+            fprintf(stderr, "Unknown operation '%s'\n", op);
+            return false;
+        }
+        *ops |= UINT32_C(1) << id;
+    }
+
+    return true;
+}
+
+static void rule_defaults(lt_sessiond_rule_t *rule)
+{
+    const lt_sessiond_range_t all = {0, UINT16_MAX};
+
+    rule->chips = all;
+    rule->ecc_slots = all;
+    rule->r_mem_slots = all;
+    rule->mac_and_destroy_slots = all;
+    rule->mcounters = all;
+}
+
+/**
+ * Each non-empty line not starting with '#' is a rule:
+ *   <uid|*> <op>[,<op>...|all] [chips=a-b] [ecc=a-b] [r_mem=a-b] [mac=a-b] [mcounter=a-b]
+ */
+static int parse_policy(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    char line[LT_SESSIOND_LINE_MAX];
+    int cnt = 0;
+    int line_num = 0;
+    while (fgets(line, sizeof(line), f)) {
+        line_num++;
+        char *save;
+        char *who = strtok_r(line, " \t\r\n", &save);
+        if (!who || who[0] == '#') {
+            continue;
+        }
+        if (cnt == LT_SESSIOND_RULES_MAX) {
+            fprintf(stderr, "%s: too many rules\n", path);
+            goto fail;
+        }
+
+        lt_sessiond_rule_t *rule = &rules[cnt];
+        memset(rule, 0, sizeof(*rule));
+        rule_defaults(rule);
+
+        unsigned long uid;
+        if (strcmp(who, "*") == 0) {
+            rule->any_uid = true;
+        }
+        else if (parse_uint(who, UINT32_MAX, &uid)) {
+            rule->uid = (uid_t)uid;
+        }
+        else {
+            goto syntax;
+        }
+
+        char *ops = strtok_r(NULL, " \t\r\n", &save);
+        if (!ops || !parse_ops(ops, &rule->ops)) {
+            goto syntax;
+        }
+
+        for (char *opt = strtok_r(NULL, " \t\r\n", &save); opt; opt = strtok_r(NULL, " \t\r\n", &save)) {
+            char *value = strchr(opt, '=');
+            if (!value) {
+                goto syntax;
+            }
+            *value++ = '\0';
+
+            lt_sessiond_range_t *range;
+            if (strcmp(opt, "chips") == 0) {
+                range = &rule->chips;
+            }
+            else if (strcmp(opt, "ecc") == 0) {
+                range = &rule->ecc_slots;
+            }
+            else if (strcmp(opt, "r_mem") == 0) {
+                range = &rule->r_mem_slots;
+            }
+            else if (strcmp(opt, "mac") == 0) {
+                range = &rule->mac_and_destroy_slots;
+            }
+            else if (strcmp(opt, "mcounter") == 0) {
+                range = &rule->mcounters;
+            }
+            else {
+                goto syntax;
+            }
+            if (!parse_range(value, range)) {
+                goto syntax;
+            }
+        }
+        cnt++;
+    }
+
+    fclose(f);
+    return cnt;
+
+syntax:
+    fprintf(stderr, "%s:%d: invalid rule\n", path, line_num);
+fail:
+    fclose(f);
+    return -1;
+}
+
+int main(int argc, char **argv)
+{
+    lt_sessiond_cfg_t cfg = {.chips = chips};
+    const char *policy = NULL;
+    unsigned long value;
+    uint8_t key_cnt = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:c:k:p:q:b:h")) != -1) {
+        switch (opt) {
+            case 's':
+                cfg.socket_path = optarg;
+                break;
+            case 'c':
+                if (cfg.chip_cnt == LT_SESSIOND_CHIPS_MAX || !lt_tools_dev_parse(optarg, &devs[cfg.chip_cnt])) {
+                    fprintf(stderr, "Invalid chip '%s'\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                handles[cfg.chip_cnt].l2.device = &devs[cfg.chip_cnt];
+                chips[cfg.chip_cnt].h = &handles[cfg.chip_cnt];
+                cfg.chip_cnt++;
+                break;
+            case 'k':
+                if (key_cnt >= cfg.chip_cnt || !parse_keys(optarg, key_cnt)) {
+                    fprintf(stderr, "Invalid keys, -k has to follow its -c\n");
+                    return EXIT_FAILURE;
+                }
+                key_cnt++;
+                break;
+            case 'p':
+                policy = optarg;
+                break;
+            case 'q':
+                if (!parse_uint(optarg, UINT8_MAX, &value) || value == 0) {
+                    fprintf(stderr, "Invalid queue depth\n");
+                    return EXIT_FAILURE;
+                }
+                cfg.queue_depth = (uint8_t)value;
+                break;
+            case 'b':
+                if (!parse_uint(optarg, LT_SESSIOND_BATCH_MAX, &value) || value == 0) {
+                    fprintf(stderr, "Invalid batch size\n");
+                    return EXIT_FAILURE;
+                }
+                cfg.batch_max = (uint8_t)value;
+                break;
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (!cfg.socket_path || cfg.chip_cnt == 0 || key_cnt != cfg.chip_cnt || optind != argc) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (policy) {
+        int cnt = parse_policy(policy);
+        if (cnt < 0) {
+            return EXIT_FAILURE;
+        }
+        cfg.rule_cnt = (uint16_t)cnt;
+    }
+    else {
+        rule_defaults(&rules[0]);
+        rules[0].uid = getuid();
+        rules[0].ops = UINT32_MAX;
+        cfg.rule_cnt = 1;
+    }
+    cfg.rules = rules;
+
+    lt_ret_t ret = lt_sessiond_init(&sd, &cfg);
+    if (ret != LT_OK) {
+        fprintf(stderr, "Cannot start: %s\n", lt_ret_verbose(ret));
+        return EXIT_FAILURE;
+    }
+
+    struct sigaction sa = {.sa_handler = on_signal};
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    printf("Serving %u chip(s) on %s\n", cfg.chip_cnt, cfg.socket_path);
+    fflush(stdout);
+    ret = lt_sessiond_run(&sd);
+    lt_sessiond_deinit(&sd);
+
+    return (ret == LT_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,510 @@
+/**
+ * @file lt_sessiond_proto.c
+ * @brief Serialization of lt_sessiond requests and responses
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include "lt_sessiond_proto.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "libtropic_common.h"
+
+/** @brief Size of a signature in a response. */
+#define LT_SD_SIGNATURE_SIZE TR01_ECDSA_EDDSA_SIGNATURE_LENGTH
+/** @brief Size of a pairing key or stored private key in a request. */
+#define LT_SD_KEY_SIZE 32
+
+/** @brief Cursor over a payload, `ok` is cleared on the first access out of bounds. */
+typedef struct lt_sd_cursor_t {
+    uint8_t *wr;       /**< Payload being written, NULL when reading */
+    const uint8_t *rd; /**< Payload being read, NULL when writing */
+    uint16_t pos;      /**< Current position */
+    uint16_t size;     /**< Size of the payload */
+    bool ok;           /**< All accesses were in bounds */
+} lt_sd_cursor_t;
+
+static void lt_sd_put(lt_sd_cursor_t *c, const void *src, const size_t n)
+{
+    if (!c->ok || (n > (size_t)(c->size - c->pos)) || (!src && (n != 0))) {
+        c->ok = false;
+        return;
+    }
+    if (n != 0) {
+        memcpy(&c->wr[c->pos], src, n);
+    }
+    c->pos += (uint16_t)n;
+}
+
+static void lt_sd_put_u8(lt_sd_cursor_t *c, const uint32_t v)
+{
+    uint8_t b = (uint8_t)v;
+    lt_sd_put(c, &b, sizeof(b));
+}
+
+static void lt_sd_put_u16(lt_sd_cursor_t *c, const uint32_t v)
+{
+    uint16_t h = (uint16_t)v;
+    lt_sd_put(c, &h, sizeof(h));
+}
+
+static void lt_sd_put_u32(lt_sd_cursor_t *c, const uint32_t v)
+{
+    lt_sd_put(c, &v, sizeof(v));
+}
+
+/** @brief Returns pointer to the next `n` bytes, NULL when they are not there. */
+static const uint8_t *lt_sd_get(lt_sd_cursor_t *c, const size_t n)
+{
+    if (!c->ok || (n > (size_t)(c->size - c->pos))) {
+        c->ok = false;
+        return NULL;
+    }
+    const uint8_t *p = &c->rd[c->pos];
+    c->pos += (uint16_t)n;
+    return p;
+}
+
+static uint8_t lt_sd_get_u8(lt_sd_cursor_t *c)
+{
+    const uint8_t *p = lt_sd_get(c, sizeof(uint8_t));
+    return p ? *p : 0;
+}
+
+static uint16_t lt_sd_get_u16(lt_sd_cursor_t *c)
+{
+    uint16_t v = 0;
+    const uint8_t *p = lt_sd_get(c, sizeof(v));
+    if (p) {
+        memcpy(&v, p, sizeof(v));
+    }
+    return v;
+}
+
+static uint32_t lt_sd_get_u32(lt_sd_cursor_t *c)
+{
+    uint32_t v = 0;
+    const uint8_t *p = lt_sd_get(c, sizeof(v));
+    if (p) {
+        memcpy(&v, p, sizeof(v));
+    }
+    return v;
+}
+
+/** @brief Returns the rest of the payload. */
+static const uint8_t *lt_sd_get_rest(lt_sd_cursor_t *c, uint16_t *n)
+{
+    *n = c->ok ? (uint16_t)(c->size - c->pos) : 0;
+    return lt_sd_get(c, *n);
+}
+
+/** @brief Copies `n` bytes into `dst`, which has to be present. */
+static void lt_sd_get_to(lt_sd_cursor_t *c, void *dst, const size_t n)
+{
+    const uint8_t *p = lt_sd_get(c, n);
+    if (p && (n != 0)) {
+        if (!dst) {
+            c->ok = false;
+            return;
+        }
+        memcpy(dst, p, n);
+    }
+}
+
+static size_t lt_sd_pubkey_len(const lt_ecc_curve_type_t curve)
+{
+    return (curve == TR01_CURVE_ED25519) ? TR01_CURVE_ED25519_PUBKEY_LEN : TR01_CURVE_P256_PUBKEY_LEN;
+}
+
+lt_ret_t lt_sd_req_encode(const lt_batch_cmd_t *cmd, uint8_t *payload, uint16_t *len)
+{
+    if (!cmd || !payload || !len) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_sd_cursor_t c = {.wr = payload, .size = LT_SD_PAYLOAD_MAX, .ok = true};
+
+    switch (cmd->id) {
+        case LT_BATCH_PING:
+            lt_sd_put(&c, cmd->args.ping.msg_out, cmd->args.ping.msg_len);
+            break;
+        case LT_BATCH_PAIRING_KEY_WRITE:
+            lt_sd_put_u8(&c, cmd->args.pairing_key_write.slot);
+            lt_sd_put(&c, cmd->args.pairing_key_write.pairing_pub, LT_SD_KEY_SIZE);
+            break;
+        case LT_BATCH_PAIRING_KEY_READ:
+            lt_sd_put_u8(&c, cmd->args.pairing_key_read.slot);
+            break;
+        case LT_BATCH_PAIRING_KEY_INVALIDATE:
+            lt_sd_put_u8(&c, cmd->args.pairing_key_invalidate.slot);
+            break;
+        case LT_BATCH_R_CONFIG_WRITE:
+            lt_sd_put_u16(&c, cmd->args.r_config_write.addr);
+            lt_sd_put_u32(&c, cmd->args.r_config_write.obj);
+            break;
+        case LT_BATCH_R_CONFIG_READ:
+            lt_sd_put_u16(&c, cmd->args.r_config_read.addr);
+            break;
+        case LT_BATCH_R_CONFIG_ERASE:
+            break;
+        case LT_BATCH_I_CONFIG_WRITE:
+            lt_sd_put_u16(&c, cmd->args.i_config_write.addr);
+            lt_sd_put_u8(&c, cmd->args.i_config_write.bit_index);
+            break;
+        case LT_BATCH_I_CONFIG_READ:
+            lt_sd_put_u16(&c, cmd->args.i_config_read.addr);
+            break;
+        case LT_BATCH_R_MEM_DATA_WRITE:
+            lt_sd_put_u16(&c, cmd->args.r_mem_data_write.udata_slot);
+            lt_sd_put(&c, cmd->args.r_mem_data_write.data, cmd->args.r_mem_data_write.data_size);
+            break;
+        case LT_BATCH_R_MEM_DATA_READ:
+            lt_sd_put_u16(&c, cmd->args.r_mem_data_read.udata_slot);
+            lt_sd_put_u16(&c, cmd->args.r_mem_data_read.data_max_size);
+            break;
+        case LT_BATCH_R_MEM_DATA_ERASE:
+            lt_sd_put_u16(&c, cmd->args.r_mem_data_erase.udata_slot);
+            break;
+        case LT_BATCH_RANDOM_VALUE_GET:
+            lt_sd_put_u16(&c, cmd->args.random_value_get.rnd_bytes_cnt);
+            break;
+        case LT_BATCH_ECC_KEY_GENERATE:
+            lt_sd_put_u8(&c, cmd->args.ecc_key_generate.slot);
+            lt_sd_put_u8(&c, cmd->args.ecc_key_generate.curve);
+            break;
+        case LT_BATCH_ECC_KEY_STORE:
+            lt_sd_put_u8(&c, cmd->args.ecc_key_store.slot);
+            lt_sd_put_u8(&c, cmd->args.ecc_key_store.curve);
+            lt_sd_put(&c, cmd->args.ecc_key_store.key, LT_SD_KEY_SIZE);
+            break;
+        case LT_BATCH_ECC_KEY_READ:
+            lt_sd_put_u8(&c, cmd->args.ecc_key_read.slot);
+            lt_sd_put_u8(&c, cmd->args.ecc_key_read.key_max_size);
+            break;
+        case LT_BATCH_ECC_KEY_ERASE:
+            lt_sd_put_u8(&c, cmd->args.ecc_key_erase.slot);
+            break;
+        case LT_BATCH_ECDSA_SIGN:
+            lt_sd_put_u8(&c, cmd->args.ecdsa_sign.slot);
+            lt_sd_put(&c, cmd->args.ecdsa_sign.msg, cmd->args.ecdsa_sign.msg_len);
+            break;
+        case LT_BATCH_EDDSA_SIGN:
+            lt_sd_put_u8(&c, cmd->args.eddsa_sign.slot);
+            lt_sd_put(&c, cmd->args.eddsa_sign.msg, cmd->args.eddsa_sign.msg_len);
+            break;
+        case LT_BATCH_MCOUNTER_INIT:
+            lt_sd_put_u8(&c, cmd->args.mcounter_init.mcounter_index);
+            lt_sd_put_u32(&c, cmd->args.mcounter_init.mcounter_value);
+            break;
+        case LT_BATCH_MCOUNTER_UPDATE:
+            lt_sd_put_u8(&c, cmd->args.mcounter_update.mcounter_index);
+            break;
+        case LT_BATCH_MCOUNTER_GET:
+            lt_sd_put_u8(&c, cmd->args.mcounter_get.mcounter_index);
+            break;
+        case LT_BATCH_MAC_AND_DESTROY:
+            lt_sd_put_u8(&c, cmd->args.mac_and_destroy.slot);
+            lt_sd_put(&c, cmd->args.mac_and_destroy.data_out, TR01_MAC_AND_DESTROY_DATA_SIZE);
+            break;
+        default:
+            return LT_PARAM_ERR;
+    }
+
+    *len = c.pos;
+    return c.ok ? LT_OK : LT_PARAM_ERR;
+}
+
+lt_ret_t lt_sd_req_decode(const uint8_t op, const uint8_t *payload, const uint16_t len, lt_batch_cmd_t *cmd,
+                          lt_sd_out_t *out)
+{
+    if ((!payload && (len != 0)) || (len > LT_SD_PAYLOAD_MAX) || !cmd || !out) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_sd_cursor_t c = {.rd = payload, .size = len, .ok = true};
+    uint16_t n;
+
+    memset(cmd, 0, sizeof(*cmd));
+    cmd->id = (lt_batch_cmd_id_t)op;
+
+    switch (op) {
+        case LT_BATCH_PING:
+            cmd->args.ping.msg_out = lt_sd_get_rest(&c, &n);
+            cmd->args.ping.msg_len = n;
+            cmd->args.ping.msg_in = out->data;
+            break;
+        case LT_BATCH_PAIRING_KEY_WRITE:
+            cmd->args.pairing_key_write.slot = lt_sd_get_u8(&c);
+            cmd->args.pairing_key_write.pairing_pub = lt_sd_get(&c, LT_SD_KEY_SIZE);
+            break;
+        case LT_BATCH_PAIRING_KEY_READ:
+            cmd->args.pairing_key_read.slot = lt_sd_get_u8(&c);
+            cmd->args.pairing_key_read.pairing_pub = out->data;
+            break;
+        case LT_BATCH_PAIRING_KEY_INVALIDATE:
+            cmd->args.pairing_key_invalidate.slot = lt_sd_get_u8(&c);
+            break;
+        case LT_BATCH_R_CONFIG_WRITE:
+            cmd->args.r_config_write.addr = (enum lt_config_obj_addr_t)lt_sd_get_u16(&c);
+            cmd->args.r_config_write.obj = lt_sd_get_u32(&c);
+            break;
+        case LT_BATCH_R_CONFIG_READ:
+            cmd->args.r_config_read.addr = (enum lt_config_obj_addr_t)lt_sd_get_u16(&c);
+            cmd->args.r_config_read.obj = &out->u32;
+            break;
+        case LT_BATCH_R_CONFIG_ERASE:
+            break;
+        case LT_BATCH_I_CONFIG_WRITE:
+            cmd->args.i_config_write.addr = (enum lt_config_obj_addr_t)lt_sd_get_u16(&c);
+            cmd->args.i_config_write.bit_index = lt_sd_get_u8(&c);
+            break;
+        case LT_BATCH_I_CONFIG_READ:
+            cmd->args.i_config_read.addr = (enum lt_config_obj_addr_t)lt_sd_get_u16(&c);
+            cmd->args.i_config_read.obj = &out->u32;
+            break;
+        case LT_BATCH_R_MEM_DATA_WRITE:
+            cmd->args.r_mem_data_write.udata_slot = lt_sd_get_u16(&c);
+            cmd->args.r_mem_data_write.data = lt_sd_get_rest(&c, &n);
+            cmd->args.r_mem_data_write.data_size = n;
+            break;
+        case LT_BATCH_R_MEM_DATA_READ:
+            cmd->args.r_mem_data_read.udata_slot = lt_sd_get_u16(&c);
+            cmd->args.r_mem_data_read.data_max_size = lt_sd_get_u16(&c);
+            if (cmd->args.r_mem_data_read.data_max_size > sizeof(out->data)) {
+                cmd->args.r_mem_data_read.data_max_size = sizeof(out->data);
+            }
+            cmd->args.r_mem_data_read.data = out->data;
+            cmd->args.r_mem_data_read.data_read_size = &out->size;
+            break;
+        case LT_BATCH_R_MEM_DATA_ERASE:
+            cmd->args.r_mem_data_erase.udata_slot = lt_sd_get_u16(&c);
+            break;
+        case LT_BATCH_RANDOM_VALUE_GET:
+            cmd->args.random_value_get.rnd_bytes_cnt = lt_sd_get_u16(&c);
+            cmd->args.random_value_get.rnd_bytes = out->data;
+            // Checked here, lt_out__random_value_get() does not know the size of the output buffer
+            if (cmd->args.random_value_get.rnd_bytes_cnt > TR01_RANDOM_VALUE_GET_LEN_MAX) {
+                return LT_PARAM_ERR;
+            }
+            break;
+        case LT_BATCH_ECC_KEY_GENERATE:
+            cmd->args.ecc_key_generate.slot = (lt_ecc_slot_t)lt_sd_get_u8(&c);
+            cmd->args.ecc_key_generate.curve = (lt_ecc_curve_type_t)lt_sd_get_u8(&c);
+            break;
+        case LT_BATCH_ECC_KEY_STORE:
+            cmd->args.ecc_key_store.slot = (lt_ecc_slot_t)lt_sd_get_u8(&c);
+            cmd->args.ecc_key_store.curve = (lt_ecc_curve_type_t)lt_sd_get_u8(&c);
+            cmd->args.ecc_key_store.key = lt_sd_get(&c, LT_SD_KEY_SIZE);
+            break;
+        case LT_BATCH_ECC_KEY_READ:
+            cmd->args.ecc_key_read.slot = (lt_ecc_slot_t)lt_sd_get_u8(&c);
+            cmd->args.ecc_key_read.key_max_size = lt_sd_get_u8(&c);
+            cmd->args.ecc_key_read.key = out->data;
+            cmd->args.ecc_key_read.curve = &out->curve;
+            cmd->args.ecc_key_read.origin = &out->origin;
+            break;
+        case LT_BATCH_ECC_KEY_ERASE:
+            cmd->args.ecc_key_erase.slot = (lt_ecc_slot_t)lt_sd_get_u8(&c);
+            break;
+        case LT_BATCH_ECDSA_SIGN:
+            cmd->args.ecdsa_sign.slot = (lt_ecc_slot_t)lt_sd_get_u8(&c);
+            cmd->args.ecdsa_sign.msg = lt_sd_get_rest(&c, &n);
+            cmd->args.ecdsa_sign.msg_len = n;
+            cmd->args.ecdsa_sign.rs = out->data;
+            break;
+        case LT_BATCH_EDDSA_SIGN:
+            cmd->args.eddsa_sign.slot = (lt_ecc_slot_t)lt_sd_get_u8(&c);
+            cmd->args.eddsa_sign.msg = lt_sd_get_rest(&c, &n);
+            cmd->args.eddsa_sign.msg_len = n;
+            cmd->args.eddsa_sign.rs = out->data;
+            break;
+        case LT_BATCH_MCOUNTER_INIT:
+            cmd->args.mcounter_init.mcounter_index = (enum lt_mcounter_index_t)lt_sd_get_u8(&c);
+            cmd->args.mcounter_init.mcounter_value = lt_sd_get_u32(&c);
+            break;
+        case LT_BATCH_MCOUNTER_UPDATE:
+            cmd->args.mcounter_update.mcounter_index = (enum lt_mcounter_index_t)lt_sd_get_u8(&c);
+            break;
+        case LT_BATCH_MCOUNTER_GET:
+            cmd->args.mcounter_get.mcounter_index = (enum lt_mcounter_index_t)lt_sd_get_u8(&c);
+            cmd->args.mcounter_get.mcounter_value = &out->u32;
+            break;
+        case LT_BATCH_MAC_AND_DESTROY:
+            cmd->args.mac_and_destroy.slot = (lt_mac_and_destroy_slot_t)lt_sd_get_u8(&c);
+            cmd->args.mac_and_destroy.data_out = lt_sd_get(&c, TR01_MAC_AND_DESTROY_DATA_SIZE);
+            cmd->args.mac_and_destroy.data_in = out->data;
+            break;
+        default:
+            return LT_PARAM_ERR;
+    }
+
+    // Trailing bytes are a malformed request as well
+    return (c.ok && (c.pos == len)) ? LT_OK : LT_PARAM_ERR;
+}
+
+lt_ret_t lt_sd_res_encode(const lt_batch_cmd_t *cmd, uint8_t *payload, uint16_t *len)
+{
+    if (!cmd || !payload || !len) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_sd_cursor_t c = {.wr = payload, .size = LT_SD_PAYLOAD_MAX, .ok = true};
+
+    switch (cmd->id) {
+        case LT_BATCH_PING:
+            lt_sd_put(&c, cmd->args.ping.msg_in, cmd->args.ping.msg_len);
+            break;
+        case LT_BATCH_PAIRING_KEY_READ:
+            lt_sd_put(&c, cmd->args.pairing_key_read.pairing_pub, LT_SD_KEY_SIZE);
+            break;
+        case LT_BATCH_R_CONFIG_READ:
+            lt_sd_put_u32(&c, *cmd->args.r_config_read.obj);
+            break;
+        case LT_BATCH_I_CONFIG_READ:
+            lt_sd_put_u32(&c, *cmd->args.i_config_read.obj);
+            break;
+        case LT_BATCH_R_MEM_DATA_READ:
+            lt_sd_put(&c, cmd->args.r_mem_data_read.data, *cmd->args.r_mem_data_read.data_read_size);
+            break;
+        case LT_BATCH_RANDOM_VALUE_GET:
+            lt_sd_put(&c, cmd->args.random_value_get.rnd_bytes, cmd->args.random_value_get.rnd_bytes_cnt);
+            break;
+        case LT_BATCH_ECC_KEY_READ:
+            lt_sd_put_u8(&c, *cmd->args.ecc_key_read.curve);
+            lt_sd_put_u8(&c, *cmd->args.ecc_key_read.origin);
+            lt_sd_put(&c, cmd->args.ecc_key_read.key, lt_sd_pubkey_len(*cmd->args.ecc_key_read.curve));
+            break;
+        case LT_BATCH_ECDSA_SIGN:
+            lt_sd_put(&c, cmd->args.ecdsa_sign.rs, LT_SD_SIGNATURE_SIZE);
+            break;
+        case LT_BATCH_EDDSA_SIGN:
+            lt_sd_put(&c, cmd->args.eddsa_sign.rs, LT_SD_SIGNATURE_SIZE);
+            break;
+        case LT_BATCH_MCOUNTER_GET:
+            lt_sd_put_u32(&c, *cmd->args.mcounter_get.mcounter_value);
+            break;
+        case LT_BATCH_MAC_AND_DESTROY:
+            lt_sd_put(&c, cmd->args.mac_and_destroy.data_in, TR01_MAC_AND_DESTROY_DATA_SIZE);
+            break;
+        case LT_BATCH_PAIRING_KEY_WRITE:
+        case LT_BATCH_PAIRING_KEY_INVALIDATE:
+        case LT_BATCH_R_CONFIG_WRITE:
+        case LT_BATCH_R_CONFIG_ERASE:
+        case LT_BATCH_I_CONFIG_WRITE:
+        case LT_BATCH_R_MEM_DATA_WRITE:
+        case LT_BATCH_R_MEM_DATA_ERASE:
+        case LT_BATCH_ECC_KEY_GENERATE:
+        case LT_BATCH_ECC_KEY_STORE:
+        case LT_BATCH_ECC_KEY_ERASE:
+        case LT_BATCH_MCOUNTER_INIT:
+        case LT_BATCH_MCOUNTER_UPDATE:
+            break;
+        default:
+            return LT_PARAM_ERR;
+    }
+
+    *len = c.pos;
+    return c.ok ? LT_OK : LT_PARAM_ERR;
+}
+
+lt_ret_t lt_sd_res_decode(const uint8_t *payload, const uint16_t len, lt_batch_cmd_t *cmd)
+{
+    if ((!payload && (len != 0)) || !cmd) {
+        return LT_PARAM_ERR;
+    }
+
+    lt_sd_cursor_t c = {.rd = payload, .size = len, .ok = true};
+    size_t key_len;
+
+    switch (cmd->id) {
+        case LT_BATCH_PING:
+            lt_sd_get_to(&c, cmd->args.ping.msg_in, cmd->args.ping.msg_len);
+            break;
+        case LT_BATCH_PAIRING_KEY_READ:
+            lt_sd_get_to(&c, cmd->args.pairing_key_read.pairing_pub, LT_SD_KEY_SIZE);
+            break;
+        case LT_BATCH_R_CONFIG_READ:
+            *cmd->args.r_config_read.obj = lt_sd_get_u32(&c);
+            break;
+        case LT_BATCH_I_CONFIG_READ:
+            *cmd->args.i_config_read.obj = lt_sd_get_u32(&c);
+            break;
+        case LT_BATCH_R_MEM_DATA_READ:
+            if (len > cmd->args.r_mem_data_read.data_max_size) {
+                return LT_FAIL;
+            }
+            lt_sd_get_to(&c, cmd->args.r_mem_data_read.data, len);
+            *cmd->args.r_mem_data_read.data_read_size = len;
+            break;
+        case LT_BATCH_RANDOM_VALUE_GET:
+            lt_sd_get_to(&c, cmd->args.random_value_get.rnd_bytes, cmd->args.random_value_get.rnd_bytes_cnt);
+            break;
+        case LT_BATCH_ECC_KEY_READ:
+            *cmd->args.ecc_key_read.curve = (lt_ecc_curve_type_t)lt_sd_get_u8(&c);
+            *cmd->args.ecc_key_read.origin = (lt_ecc_key_origin_t)lt_sd_get_u8(&c);
+            key_len = lt_sd_pubkey_len(*cmd->args.ecc_key_read.curve);
+            if (key_len > cmd->args.ecc_key_read.key_max_size) {
+                return LT_FAIL;
+            }
+            lt_sd_get_to(&c, cmd->args.ecc_key_read.key, key_len);
+            break;
+        case LT_BATCH_ECDSA_SIGN:
+            lt_sd_get_to(&c, cmd->args.ecdsa_sign.rs, LT_SD_SIGNATURE_SIZE);
+            break;
+        case LT_BATCH_EDDSA_SIGN:
+            lt_sd_get_to(&c, cmd->args.eddsa_sign.rs, LT_SD_SIGNATURE_SIZE);
+            break;
+        case LT_BATCH_MCOUNTER_GET:
+            *cmd->args.mcounter_get.mcounter_value = lt_sd_get_u32(&c);
+            break;
+        case LT_BATCH_MAC_AND_DESTROY:
+            lt_sd_get_to(&c, cmd->args.mac_and_destroy.data_in, TR01_MAC_AND_DESTROY_DATA_SIZE);
+            break;
+        default:
+            break;
+    }
+
+    return (c.ok && (c.pos == len)) ? LT_OK : LT_FAIL;
+}
+
+/** @brief Names of operations, indexed by `lt_batch_cmd_id_t`, same as the libtropic.h functions without `lt_`. */
+static const char *lt_sd_op_strs[] = {"ping",
+                                      "pairing_key_write",
+                                      "pairing_key_read",
+                                      "pairing_key_invalidate",
+                                      "r_config_write",
+                                      "r_config_read",
+                                      "r_config_erase",
+                                      "i_config_write",
+                                      "i_config_read",
+                                      "r_mem_data_write",
+                                      "r_mem_data_read",
+                                      "r_mem_data_erase",
+                                      "random_value_get",
+                                      "ecc_key_generate",
+                                      "ecc_key_store",
+                                      "ecc_key_read",
+                                      "ecc_key_erase",
+                                      "ecc_ecdsa_sign",
+                                      "ecc_eddsa_sign",
+                                      "mcounter_init",
+                                      "mcounter_update",
+                                      "mcounter_get",
+                                      "mac_and_destroy"};
+
+const char *lt_sd_op_str(const uint8_t op)
+{
+    if (op == LT_SD_OP_INFO) {
+        return "info";
+    }
+    if (op < sizeof(lt_sd_op_strs) / sizeof(lt_sd_op_strs[0])) {
+        return lt_sd_op_strs[op];
+    }
+
+    return NULL;
+}
@@ -0,0 +1,208 @@
+/**
+ * @file lt_test_sessiond.c
+ * @brief Runs lt_sessiond against the model and exercises it through the client library
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_functional_tests.h"
+#include "libtropic_port_unix_tcp.h"
+#include "lt_sessiond.h"
+#include "lt_sessiond_client.h"
+
+/** @brief Number of clients running at once. */
+#define LT_TEST_SD_CLIENT_CNT 4
+/** @brief Number of Pings sent by each client. */
+#define LT_TEST_SD_PING_CNT 16
+
+#define LT_TEST_SD_CHECK(expected, call)                                                              \
+    do {                                                                                              \
+        lt_ret_t ret_ = (call);                                                                       \
+        if (ret_ != (expected)) {                                                                     \
+            printf("FAIL [%4d] %s returned %s, expected %s\n", __LINE__, #call, lt_ret_verbose(ret_), \
+                   lt_ret_verbose(expected));                                                         \
+            return false;                                                                             \
+        }                                                                                             \
+    } while (0)
+
+static lt_sessiond_t sd;
+static char socket_path[64];
+
+static void *lt_test_sd_run(void *arg)
+{
+    (void)arg;
+    lt_sessiond_run(&sd);
+    return NULL;
+}
+
+static bool lt_test_sd_basic(void)
+{
+    lt_sd_client_t c;
+    uint8_t buff[TR01_PING_LEN_MAX];
+    uint8_t data[TR01_R_MEM_DATA_SIZE_MAX];
+    uint8_t key[TR01_CURVE_P256_PUBKEY_LEN];
+    uint8_t rs[TR01_ECDSA_EDDSA_SIGNATURE_LENGTH];
+    uint8_t chip_cnt;
+    uint16_t read_size;
+    lt_ecc_curve_type_t curve;
+    lt_ecc_key_origin_t origin;
+
+    LT_TEST_SD_CHECK(LT_OK, lt_sd_connect(&c, socket_path));
+    LT_TEST_SD_CHECK(LT_OK, lt_sd_chip_cnt(&c, &chip_cnt));
+    LT_TEST_TRUE(chip_cnt == 1);
+
+    printf("Ping with the longest message\n");
+    for (uint16_t i = 0; i < TR01_PING_LEN_MAX; i++) {
+        buff[i] = (uint8_t)(i * 7);
+    }
+    uint8_t *ping_in = malloc(TR01_PING_LEN_MAX);
+    LT_TEST_TRUE(ping_in != NULL);
+    lt_ret_t ret = lt_sd_ping(&c, buff, ping_in, TR01_PING_LEN_MAX);
+    bool same = memcmp(buff, ping_in, TR01_PING_LEN_MAX) == 0;
+    free(ping_in);
+    LT_TEST_SD_CHECK(LT_OK, ret);
+    LT_TEST_TRUE(same);
+
+    printf("Random_Value_Get\n");
+    LT_TEST_SD_CHECK(LT_OK, lt_sd_random_value_get(&c, buff, TR01_RANDOM_VALUE_GET_LEN_MAX));
+
+    printf("R memory write, read and erase\n");
+    for (uint16_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)i;
+    }
+    LT_TEST_SD_CHECK(LT_OK, lt_sd_r_mem_data_erase(&c, 0));
+    LT_TEST_SD_CHECK(LT_OK, lt_sd_r_mem_data_write(&c, 0, data, 100));
+    LT_TEST_SD_CHECK(LT_OK, lt_sd_r_mem_data_read(&c, 0, buff, sizeof(data), &read_size));
+    LT_TEST_TRUE(read_size == 100 && memcmp(buff, data, 100) == 0);
+    LT_TEST_SD_CHECK(LT_OK, lt_sd_r_mem_data_erase(&c, 0));
+    LT_TEST_SD_CHECK(LT_L3_R_MEM_DATA_READ_SLOT_EMPTY, lt_sd_r_mem_data_read(&c, 0, buff, sizeof(data), &read_size));
+
+    printf("ECC key generate, read, sign and erase\n");
+    LT_TEST_SD_CHECK(LT_OK, lt_sd_ecc_key_erase(&c, TR01_ECC_SLOT_0));
+    LT_TEST_SD_CHECK(LT_OK, lt_sd_ecc_key_generate(&c, TR01_ECC_SLOT_0, TR01_CURVE_P256));
+    LT_TEST_SD_CHECK(LT_OK, lt_sd_ecc_key_read(&c, TR01_ECC_SLOT_0, key, sizeof(key), &curve, &origin));
+    LT_TEST_TRUE(curve == TR01_CURVE_P256 && origin == TR01_CURVE_GENERATED);
+    LT_TEST_SD_CHECK(LT_OK, lt_sd_ecc_ecdsa_sign(&c, TR01_ECC_SLOT_0, data, 32, rs));
+    LT_TEST_SD_CHECK(LT_OK, lt_sd_ecc_key_erase(&c, TR01_ECC_SLOT_0));
+    LT_TEST_SD_CHECK(LT_L3_ECC_INVALID_KEY, lt_sd_ecc_ecdsa_sign(&c, TR01_ECC_SLOT_0, data, 32, rs));
+
+    printf("Policy\n");
+    LT_TEST_SD_CHECK(LT_SESSIOND_DENIED, lt_sd_r_mem_data_erase(&c, 100));
+    LT_TEST_SD_CHECK(LT_SESSIOND_DENIED, lt_sd_ecc_key_erase(&c, TR01_ECC_SLOT_31));
+    LT_TEST_SD_CHECK(LT_SESSIOND_DENIED, lt_sd_pairing_key_invalidate(&c, TR01_PAIRING_KEY_SLOT_INDEX_3));
+    c.chip = 1;
+    LT_TEST_SD_CHECK(LT_PARAM_ERR, lt_sd_ping(&c, buff, buff, 1));
+    c.chip = 0;
+    LT_TEST_SD_CHECK(LT_OK, lt_sd_ping(&c, buff, buff, 1));
+
+    LT_TEST_SD_CHECK(LT_OK, lt_sd_disconnect(&c));
+    return true;
+}
+
+static void *lt_test_sd_client(void *arg)
+{
+    uint16_t slot = (uint16_t)(uintptr_t)arg;
+    uint8_t out[64], in[64];
+    uint16_t read_size;
+    lt_sd_client_t c;
+
+    if (lt_sd_connect(&c, socket_path) != LT_OK) {
+        return (void *)(uintptr_t)false;
+    }
+
+    bool ok = true;
+    for (uint16_t i = 0; ok && i < LT_TEST_SD_PING_CNT; i++) {
+        memset(out, (int)(slot * LT_TEST_SD_PING_CNT + i), sizeof(out));
+        ok = lt_sd_ping(&c, out, in, sizeof(out)) == LT_OK && memcmp(out, in, sizeof(out)) == 0;
+    }
+    // Each client uses its own slot, so the results do not depend on the order the daemon executes them
+    ok = ok && lt_sd_r_mem_data_erase(&c, slot) == LT_OK;
+    ok = ok && lt_sd_r_mem_data_write(&c, slot, out, sizeof(out)) == LT_OK;
+    ok = ok && lt_sd_r_mem_data_read(&c, slot, in, sizeof(in), &read_size) == LT_OK;
+    ok = ok && read_size == sizeof(out) && memcmp(out, in, sizeof(out)) == 0;
+    ok = ok && lt_sd_r_mem_data_erase(&c, slot) == LT_OK;
+
+    lt_sd_disconnect(&c);
+    return (void *)(uintptr_t)ok;
+}
+
+static bool lt_test_sd_concurrent(void)
+{
+    pthread_t threads[LT_TEST_SD_CLIENT_CNT];
+    bool ok = true;
+
+    printf("%d clients at once\n", LT_TEST_SD_CLIENT_CNT);
+    for (uintptr_t i = 0; i < LT_TEST_SD_CLIENT_CNT; i++) {
+        LT_TEST_TRUE(pthread_create(&threads[i], NULL, lt_test_sd_client, (void *)(i + 1)) == 0);
+    }
+    for (uint16_t i = 0; i < LT_TEST_SD_CLIENT_CNT; i++) {
+        void *res;
+        pthread_join(threads[i], &res);
+        ok = ok && (bool)(uintptr_t)res;
+    }
+
+    LT_TEST_TRUE(ok);
+    return true;
+}
+
+int main(void)
+{
+    lt_dev_unix_tcp_t device = {0};
+    lt_handle_t h = {0};
+
+    if (lt_unix_tcp_target_from_env(&device) != LT_OK) {
+        return EXIT_FAILURE;
+    }
+    device.rng_seed = (unsigned int)time(NULL);
+    h.l2.device = &device;
+
+    lt_sessiond_chip_cfg_t chip = {
+        .h = &h, .sh_priv = sh0priv, .sh_pub = sh0pub, .pkey_index = TR01_PAIRING_KEY_SLOT_INDEX_0};
+    lt_sessiond_rule_t rule = {
+        .uid = getuid(),
+        .ops = UINT32_MAX & ~(UINT32_C(1) << LT_BATCH_PAIRING_KEY_WRITE)
+               & ~(UINT32_C(1) << LT_BATCH_PAIRING_KEY_INVALIDATE),
+        .chips = {0, 0},
+        .ecc_slots = {TR01_ECC_SLOT_0, TR01_ECC_SLOT_7},
+        .r_mem_slots = {0, 15},
+        .mac_and_destroy_slots = {0, 0},
+        .mcounters = {0, 0},
+    };
+    snprintf(socket_path, sizeof(socket_path), "/tmp/lt_test_sessiond.%d.sock", (int)getpid());
+    lt_sessiond_cfg_t cfg = {
+        .socket_path = socket_path, .chips = &chip, .chip_cnt = 1, .rules = &rule, .rule_cnt = 1, .batch_max = 4};
+
+    printf("Starting lt_sessiond\n");
+    lt_ret_t ret = lt_sessiond_init(&sd, &cfg);
+    if (ret != LT_OK) {
+        printf("FAIL lt_sessiond_init() returned %s\n", lt_ret_verbose(ret));
+        return EXIT_FAILURE;
+    }
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, lt_test_sd_run, NULL) != 0) {
+        lt_sessiond_deinit(&sd);
+        return EXIT_FAILURE;
+    }
+
+    bool ok = lt_test_sd_basic() && lt_test_sd_concurrent();
+
+    lt_sessiond_stop(&sd);
+    pthread_join(thread, NULL);
+    lt_sessiond_deinit(&sd);
+
+    printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,467 @@
+/**
+ * @file lt_bench.c
+ * @brief End-to-end benchmark of libtropic commands, printing ops/s and latency percentiles of each workload as JSON.
+ * @details Usage: lt_bench [-n <ops>] [-u <warmup>] [-w <workload>[,<workload>...]] [-o <file>] [-d <chip>] [-l]
+ *
+ * Every workload repeats one command (Ping of several lengths, each signature type, Random_Value_Get, R memory write
+ * and read, configuration read, Secure Session start and reading of the Certificate Store) `-n` times after `-u`
+ * unmeasured runs. Workloads needing a key or written R memory prepare them outside of the measured time in slots
+ * listed below, which have to be empty, and erase them afterwards.
+ *
+ * The port is selected at build time (LT_BENCH_PORT in tropic01_model/CMakeLists.txt): the emulator with LT_EMULATOR,
+ * otherwise the TCP port talking to the model or lt_emu_server (LT_MODEL_ADDR and LT_MODEL_PORT), or a chip connected
+ * over SPI or the USB dongle. `-d` gives the chip in the format of the tools (LT_TOOLS_DEV_SPEC). With LT_VIRTUAL_TIME,
+ * waits of libtropic take no real time, so the latency is the measured time plus the time waited on the virtual clock.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_examples.h"
+#include "libtropic_logging.h"
+#ifdef LT_EMULATOR
+#include "libtropic_port_emulator.h"
+
+extern const lt_emu_cfg_t lt_emu_model_cfg;
+#else
+#include "lt_tools_dev.h"
+#endif
+
+/** @brief Default number of measured operations of each workload. */
+#define LT_BENCH_OPS 100
+/** @brief Default number of unmeasured operations before the measured ones. */
+#define LT_BENCH_WARMUP 2
+/** @brief Upper limit of `-n`, bounds the memory for latencies. */
+#define LT_BENCH_OPS_MAX 100000
+/** @brief ECC slot with the P256 key of the ECDSA workloads. */
+#define LT_BENCH_ECC_SLOT_P256 TR01_ECC_SLOT_30
+/** @brief ECC slot with the Ed25519 key of the EdDSA workload. */
+#define LT_BENCH_ECC_SLOT_ED25519 TR01_ECC_SLOT_31
+/** @brief R memory slot of the R memory workloads. */
+#define LT_BENCH_R_MEM_SLOT TR01_R_MEM_DATA_SLOT_MAX
+
+/** @brief Workload, `op` is measured, `setup`, `prepare` and `teardown` are not. */
+typedef struct lt_bench_workload_t {
+    const char *name;
+    /** Length of the message, random value or R memory data */
+    uint16_t len;
+    /** Called once before the first operation, NULL if not needed */
+    lt_ret_t (*setup)(const struct lt_bench_workload_t *w);
+    /** Called before each operation but the first one, NULL if not needed */
+    lt_ret_t (*prepare)(const struct lt_bench_workload_t *w);
+    lt_ret_t (*op)(const struct lt_bench_workload_t *w);
+    /** Called after the last operation, also when the workload failed, NULL if not needed */
+    lt_ret_t (*teardown)(const struct lt_bench_workload_t *w);
+} lt_bench_workload_t;
+
+static lt_handle_t h;
+#ifdef LT_EMULATOR
+static lt_dev_emulator_t device;
+/** @brief Name of the port in the results. */
+static const char *port_name = "emulator";
+#else
+static lt_tools_dev_t device;
+static const char *port_name = LT_BENCH_PORT_NAME;
+#endif
+static uint8_t msg[TR01_PING_LEN_MAX], msg_in[TR01_PING_LEN_MAX];
+static uint8_t cert_buffs[LT_NUM_CERTIFICATES][TR01_L2_GET_INFO_REQ_CERT_SIZE_SINGLE];
+static struct lt_cert_store_t cert_store;
+static uint8_t stpub[TR01_STPUB_LEN];
+static uint64_t *latencies_us;
+
+static uint64_t lt_bench_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static int lt_bench_cmp_u64(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/** @brief Nearest-rank percentile of sorted latencies. */
+static uint64_t lt_bench_percentile(const uint64_t *sorted, const uint32_t cnt, const uint32_t p)
+{
+    const uint64_t rank = ((uint64_t)cnt * p + 99) / 100;
+    return sorted[(rank > 0) ? rank - 1 : 0];
+}
+
+static lt_ret_t lt_bench_ping(const lt_bench_workload_t *w)
+{
+    lt_ret_t ret = lt_ping(&h, msg, msg_in, w->len);
+    if ((ret == LT_OK) && memcmp(msg, msg_in, w->len)) {
+        LT_LOG_ERROR("Pinged message differs");
+        return LT_FAIL;
+    }
+
+    return ret;
+}
+
+static lt_ret_t lt_bench_key_generate(const lt_ecc_slot_t slot, const lt_ecc_curve_type_t curve)
+{
+    lt_ret_t ret = lt_ecc_key_generate(&h, slot, curve);
+    if (ret != LT_OK) {
+        LT_LOG_ERROR("Failed to generate a key in ECC slot %d, is it empty?", (int)slot);
+    }
+
+    return ret;
+}
+
+static lt_ret_t lt_bench_key_generate_p256(const lt_bench_workload_t *w)
+{
+    (void)w;
+    return lt_bench_key_generate(LT_BENCH_ECC_SLOT_P256, TR01_CURVE_P256);
+}
+
+static lt_ret_t lt_bench_key_generate_ed25519(const lt_bench_workload_t *w)
+{
+    (void)w;
+    return lt_bench_key_generate(LT_BENCH_ECC_SLOT_ED25519, TR01_CURVE_ED25519);
+}
+
+static lt_ret_t lt_bench_key_erase_p256(const lt_bench_workload_t *w)
+{
+    (void)w;
+    return lt_ecc_key_erase(&h, LT_BENCH_ECC_SLOT_P256);
+}
+
+static lt_ret_t lt_bench_key_erase_ed25519(const lt_bench_workload_t *w)
+{
+    (void)w;
+    return lt_ecc_key_erase(&h, LT_BENCH_ECC_SLOT_ED25519);
+}
+
+static lt_ret_t lt_bench_ecdsa_sign(const lt_bench_workload_t *w)
+{
+    uint8_t rs[TR01_ECDSA_EDDSA_SIGNATURE_LENGTH];
+    return lt_ecc_ecdsa_sign(&h, LT_BENCH_ECC_SLOT_P256, msg, w->len, rs);
+}
+
+static lt_ret_t lt_bench_ecdsa_sign_hash(const lt_bench_workload_t *w)
+{
+    uint8_t rs[TR01_ECDSA_EDDSA_SIGNATURE_LENGTH];
+    (void)w;
+    return lt_ecc_ecdsa_sign_hash(&h, LT_BENCH_ECC_SLOT_P256, msg, rs);
+}
+
+static lt_ret_t lt_bench_eddsa_sign(const lt_bench_workload_t *w)
+{
+    uint8_t rs[TR01_ECDSA_EDDSA_SIGNATURE_LENGTH];
+    return lt_ecc_eddsa_sign(&h, LT_BENCH_ECC_SLOT_ED25519, msg, w->len, rs);
+}
+
+static lt_ret_t lt_bench_random(const lt_bench_workload_t *w)
+{
+    return lt_random_value_get(&h, msg_in, w->len);
+}
+
+static lt_ret_t lt_bench_r_mem_write(const lt_bench_workload_t *w)
+{
+    lt_ret_t ret = lt_r_mem_data_write(&h, LT_BENCH_R_MEM_SLOT, msg, w->len);
+    if (ret != LT_OK) {
+        LT_LOG_ERROR("Failed to write R memory slot %d, is it empty?", LT_BENCH_R_MEM_SLOT);
+    }
+
+    return ret;
+}
+
+static lt_ret_t lt_bench_r_mem_erase(const lt_bench_workload_t *w)
+{
+    (void)w;
+    return lt_r_mem_data_erase(&h, LT_BENCH_R_MEM_SLOT);
+}
+
+static lt_ret_t lt_bench_r_mem_read(const lt_bench_workload_t *w)
+{
+    uint16_t read_size;
+    lt_ret_t ret = lt_r_mem_data_read(&h, LT_BENCH_R_MEM_SLOT, msg_in, sizeof(msg_in), &read_size);
+    if ((ret == LT_OK) && ((read_size != w->len) || memcmp(msg, msg_in, w->len))) {
+        LT_LOG_ERROR("Read R memory data differ");
+        return LT_FAIL;
+    }
+
+    return ret;
+}
+
+static lt_ret_t lt_bench_r_config_read(const lt_bench_workload_t *w)
+{
+    uint32_t obj;
+    (void)w;
+    return lt_r_config_read(&h, TR01_CFG_START_UP_ADDR, &obj);
+}
+
+static lt_ret_t lt_bench_i_config_read(const lt_bench_workload_t *w)
+{
+    uint32_t obj;
+    (void)w;
+    return lt_i_config_read(&h, TR01_CFG_START_UP_ADDR, &obj);
+}
+
+static lt_ret_t lt_bench_cert_store_read(const lt_bench_workload_t *w)
+{
+    (void)w;
+    for (int i = 0; i < LT_NUM_CERTIFICATES; i++) {
+        cert_store.certs[i] = cert_buffs[i];
+        cert_store.buf_len[i] = TR01_L2_GET_INFO_REQ_CERT_SIZE_SINGLE;
+    }
+
+    return lt_get_info_cert_store(&h, &cert_store);
+}
+
+/** @brief Reads STPUB for the Secure Session starts. */
+static lt_ret_t lt_bench_stpub_get(const lt_bench_workload_t *w)
+{
+    lt_ret_t ret = lt_bench_cert_store_read(w);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    return lt_get_st_pub(&cert_store, stpub);
+}
+
+static lt_ret_t lt_bench_session_start(const lt_bench_workload_t *w)
+{
+    (void)w;
+    return lt_session_start(&h, stpub, TR01_PAIRING_KEY_SLOT_INDEX_0, sh0priv, sh0pub);
+}
+
+static const lt_bench_workload_t workloads[] = {
+    {"ping_16", 16, NULL, NULL, lt_bench_ping, NULL},
+    {"ping_256", 256, NULL, NULL, lt_bench_ping, NULL},
+    {"ping_1024", 1024, NULL, NULL, lt_bench_ping, NULL},
+    {"ping_4096", TR01_PING_LEN_MAX, NULL, NULL, lt_bench_ping, NULL},
+    {"ecdsa_sign", 32, lt_bench_key_generate_p256, NULL, lt_bench_ecdsa_sign, lt_bench_key_erase_p256},
+    {"ecdsa_sign_hash", 32, lt_bench_key_generate_p256, NULL, lt_bench_ecdsa_sign_hash, lt_bench_key_erase_p256},
+    {"eddsa_sign", 64, lt_bench_key_generate_ed25519, NULL, lt_bench_eddsa_sign, lt_bench_key_erase_ed25519},
+    {"random_32", 32, NULL, NULL, lt_bench_random, NULL},
+    {"random_255", TR01_RANDOM_VALUE_GET_LEN_MAX, NULL, NULL, lt_bench_random, NULL},
+    {"r_mem_write", TR01_R_MEM_DATA_SIZE_MAX, NULL, lt_bench_r_mem_erase, lt_bench_r_mem_write, lt_bench_r_mem_erase},
+    {"r_mem_read", TR01_R_MEM_DATA_SIZE_MAX, lt_bench_r_mem_write, NULL, lt_bench_r_mem_read, lt_bench_r_mem_erase},
+    {"r_config_read", 0, NULL, NULL, lt_bench_r_config_read, NULL},
+    {"i_config_read", 0, NULL, NULL, lt_bench_i_config_read, NULL},
+    {"session_start", 0, lt_bench_stpub_get, NULL, lt_bench_session_start, NULL},
+    {"cert_store_read", 0, NULL, NULL, lt_bench_cert_store_read, NULL},
+};
+
+#define LT_BENCH_WORKLOAD_CNT (sizeof(workloads) / sizeof(workloads[0]))
+
+/** @brief Runs `warmup` + `ops` operations of a workload and prints its JSON object. */
+static lt_ret_t lt_bench_run(FILE *out, const lt_bench_workload_t *w, const uint32_t warmup, const uint32_t ops,
+                             const bool first)
+{
+    lt_ret_t ret = LT_OK;
+    uint64_t total_us = 0;
+
+    fprintf(stderr, "%s\n", w->name);
+    if (w->setup) {
+        ret = w->setup(w);
+    }
+    for (uint32_t i = 0; (ret == LT_OK) && (i < warmup + ops); i++) {
+        if ((i > 0) && w->prepare) {
+            ret = w->prepare(w);
+            if (ret != LT_OK) {
+                break;
+            }
+        }
+
+        const uint64_t elapsed_ms = h.l2.clock.elapsed_ms, start = lt_bench_now_us();
+        ret = w->op(w);
+        uint64_t latency_us = lt_bench_now_us() - start;
+        if (h.l2.clock.is_virtual) {
+            latency_us += (h.l2.clock.elapsed_ms - elapsed_ms) * 1000u;
+        }
+        if (i >= warmup) {
+            latencies_us[i - warmup] = latency_us;
+            total_us += latency_us;
+        }
+    }
+    if (ret != LT_OK) {
+        LT_LOG_ERROR("Workload %s failed, ret=%s", w->name, lt_ret_verbose(ret));
+    }
+    if (w->teardown && (w->teardown(w) != LT_OK)) {
+        LT_LOG_ERROR("Cleanup of workload %s failed", w->name);
+        ret = LT_FAIL;
+    }
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    qsort(latencies_us, ops, sizeof(latencies_us[0]), lt_bench_cmp_u64);
+    fprintf(out,
+            "%s\n    {\"name\": \"%s\", \"len\": %u, \"ops\": %" PRIu32 ", \"ops_per_s\": %.1f, \"latency_us\": "
+            "{\"mean\": %" PRIu64 ", \"p50\": %" PRIu64 ", \"p90\": %" PRIu64 ", \"p99\": %" PRIu64
+            ", \"max\": %" PRIu64 "}}",
+            first ? "" : ",", w->name, (unsigned)w->len, ops, total_us ? ops * 1e6 / (double)total_us : 0.0,
+            total_us / ops, lt_bench_percentile(latencies_us, ops, 50), lt_bench_percentile(latencies_us, ops, 90),
+            lt_bench_percentile(latencies_us, ops, 99), latencies_us[ops - 1]);
+
+    return LT_OK;
+}
+
+static void lt_bench_usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-n <ops>] [-u <warmup>] [-w <workload>[,<workload>...]] [-o <file>] [-d <chip>] [-l]\n"
+            "  -n  measured operations of each workload (default %d)\n"
+            "  -u  unmeasured operations before them (default %d)\n"
+            "  -w  workloads to run (default all, see -l)\n"
+            "  -o  file to write the JSON results to (default stdout)\n"
+#ifndef LT_EMULATOR
+            "  -d  chip as " LT_TOOLS_DEV_SPEC
+#ifdef LT_TOOLS_PORT_TCP
+            " (default LT_MODEL_ADDR:LT_MODEL_PORT)"
+#endif
+            "\n"
+#endif
+            "  -l  list the workloads\n",
+            prog, LT_BENCH_OPS, LT_BENCH_WARMUP);
+}
+
+/** @brief Marks workloads listed in `list` as selected, returns false on an unknown name. */
+static bool lt_bench_select(char *list, bool *selected)
+{
+    for (char *name = strtok(list, ","); name; name = strtok(NULL, ",")) {
+        size_t i = 0;
+        while ((i < LT_BENCH_WORKLOAD_CNT) && strcmp(name, workloads[i].name)) {
+            i++;
+        }
+        if (i == LT_BENCH_WORKLOAD_CNT) {
+            fprintf(stderr, "Unknown workload %s\n", name);
+            return false;
+        }
+        selected[i] = true;
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long ops = LT_BENCH_OPS, warmup = LT_BENCH_WARMUP;
+    bool selected[LT_BENCH_WORKLOAD_CNT] = {false}, select_all = true;
+    const char *out_path = NULL;
+    char *chip = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:u:w:o:d:lh")) != -1) {
+        switch (opt) {
+            case 'n':
+                ops = strtoul(optarg, NULL, 10);
+                break;
+            case 'u':
+                warmup = strtoul(optarg, NULL, 10);
+                break;
+            case 'w':
+                select_all = false;
+                if (!lt_bench_select(optarg, selected)) {
+                    return 1;
+                }
+                break;
+            case 'o':
+                out_path = optarg;
+                break;
+            case 'd':
+                chip = optarg;
+                break;
+            case 'l':
+                for (size_t i = 0; i < LT_BENCH_WORKLOAD_CNT; i++) {
+                    printf("%s\n", workloads[i].name);
+                }
+                return 0;
+            default:
+                lt_bench_usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if ((ops == 0) || (ops > LT_BENCH_OPS_MAX) || (warmup > LT_BENCH_OPS_MAX)) {
+        fprintf(stderr, "Number of operations must be 1 to %d\n", LT_BENCH_OPS_MAX);
+        return 1;
+    }
+
+#if LT_SEPARATE_L3_BUFF
+    static uint8_t l3_buffer[LT_SIZE_OF_L3_BUFF] __attribute__((aligned(16)));
+    h.l3.buff = l3_buffer;
+    h.l3.buff_len = sizeof(l3_buffer);
+#endif
+#ifdef LT_EMULATOR
+    if (chip) {
+        fprintf(stderr, "-d is not supported with the emulator\n");
+        return 1;
+    }
+    device.cfg = &lt_emu_model_cfg;
+#elif defined(LT_TOOLS_PORT_TCP)
+    if (chip ? !lt_tools_dev_parse(chip, &device) : (lt_unix_tcp_target_from_env(&device) != LT_OK)) {
+        fprintf(stderr, "Invalid chip, expected " LT_TOOLS_DEV_SPEC "\n");
+        return 1;
+    }
+#else
+    if (!chip || !lt_tools_dev_parse(chip, &device)) {
+        fprintf(stderr, "Invalid chip, expected -d " LT_TOOLS_DEV_SPEC "\n");
+        return 1;
+    }
+#endif
+    device.rng_seed = (unsigned int)time(NULL);
+    h.l2.device = &device;
+#ifdef LT_VIRTUAL_TIME
+    h.l2.clock.is_virtual = true;
+#endif
+
+    FILE *out = out_path ? fopen(out_path, "w") : stdout;
+    latencies_us = calloc(ops, sizeof(latencies_us[0]));
+    if (!out || !latencies_us) {
+        fprintf(stderr, "Cannot open %s\n", out_path ? out_path : "output");
+        free(latencies_us);
+        return 1;
+    }
+    for (size_t i = 0; i < sizeof(msg); i++) {
+        msg[i] = (uint8_t)i;
+    }
+
+    lt_ret_t ret = lt_init(&h);
+    if (ret != LT_OK) {
+        LT_LOG_ERROR("lt_init() failed, ret=%s", lt_ret_verbose(ret));
+        goto cleanup;
+    }
+    ret = lt_verify_chip_and_start_secure_session(&h, sh0priv, sh0pub, TR01_PAIRING_KEY_SLOT_INDEX_0);
+    if (ret != LT_OK) {
+        LT_LOG_ERROR("Failed to start Secure Session, ret=%s", lt_ret_verbose(ret));
+        goto deinit;
+    }
+
+    fprintf(out,
+            "{\n  \"benchmark\": \"lt_bench\",\n  \"libtropic\": \"%s\",\n  \"port\": \"%s\",\n"
+            "  \"virtual_time\": %s,\n  \"warmup\": %lu,\n  \"workloads\": [",
+            LT_BENCH_LIBTROPIC_VERSION, port_name, h.l2.clock.is_virtual ? "true" : "false", warmup);
+    bool first = true;
+    for (size_t i = 0; (ret == LT_OK) && (i < LT_BENCH_WORKLOAD_CNT); i++) {
+        if (select_all || selected[i]) {
+            ret = lt_bench_run(out, &workloads[i], (uint32_t)warmup, (uint32_t)ops, first);
+            first = false;
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    lt_session_abort(&h);
+deinit:
+    lt_deinit(&h);
+cleanup:
+    free(latencies_us);
+    if (out_path) {
+        fclose(out);
+    }
+
+    return (ret == LT_OK) ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+/**
+ * @file lt_bench_fault.c
+ * @brief Measures throughput and latency of libtropic as functions of the rate of injected bus faults.
+ * @details Every fault type of hal/port/fault/ is swept over several rates, with two workloads: Get_Info of the chip
+ * ID (L2 request, recovered by Resend_Req) and Ping with a chunked result (L3 command in a Secure Session). Failed
+ * pings start the session again, outside of the measured time. With LT_VIRTUAL_TIME, waits of libtropic take no real
+ * time, so the latency is the measured time plus the time waited on the virtual clock.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_examples.h"
+#include "libtropic_logging.h"
+#include "libtropic_port_fault.h"
+#ifdef LT_EMULATOR
+#include "libtropic_port_emulator.h"
+
+extern const lt_emu_cfg_t lt_emu_model_cfg;
+#else
+#include "libtropic_port_unix_tcp.h"
+#endif
+
+/** @brief Number of operations measured for each rate. */
+#define LT_BENCH_OPS 200
+/** @brief Length of the pinged message, 4 L2 chunks of the result. */
+#define LT_BENCH_PING_LEN 512
+/** @brief Length of busy streaks. */
+#define LT_BENCH_BUSY_STREAK 4
+/** @brief Number of rates swept for each fault. */
+#define LT_BENCH_RATE_CNT 4
+
+/** @brief Fault swept over rates, in LT_PORT_FAULT_RATE_SCALE units. */
+typedef struct lt_bench_sweep_t {
+    const char *name;
+    lt_port_fault_type_t type;
+    uint32_t rates[LT_BENCH_RATE_CNT];
+} lt_bench_sweep_t;
+
+static const lt_bench_sweep_t sweeps[] = {
+    {"bit flip / byte", LT_PORT_FAULT_BIT_FLIP, {0, 100, 1000, 5000}},
+    {"truncated frame", LT_PORT_FAULT_TRUNCATE, {0, 10000, 50000, 200000}},
+    {"no response", LT_PORT_FAULT_NO_RESPONSE, {0, 10000, 100000, 300000}},
+    {"busy streak", LT_PORT_FAULT_BUSY, {0, 10000, 100000, 300000}},
+    {"alarm", LT_PORT_FAULT_ALARM, {0, 1000, 10000, 50000}},
+    {"transport error", LT_PORT_FAULT_TRANSPORT, {0, 1000, 10000, 50000}},
+};
+
+static lt_handle_t h;
+static lt_dev_fault_t fault;
+#ifdef LT_EMULATOR
+static lt_dev_emulator_t inner;
+#else
+static lt_dev_unix_tcp_t inner;
+#endif
+static uint64_t latencies_us[LT_BENCH_OPS];
+
+static uint64_t lt_bench_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static int lt_bench_cmp_u64(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/** @brief Runs one operation of the workload, returns its result and whether LT_OK came with wrong data. */
+static lt_ret_t lt_bench_op(const bool ping, bool *wrong)
+{
+    static struct lt_chip_id_t chip_id, chip_id_ref;
+    static bool chip_id_ref_valid;
+    static uint8_t msg[LT_BENCH_PING_LEN], msg_in[LT_BENCH_PING_LEN];
+    lt_ret_t ret;
+
+    if (ping) {
+        ret = lt_ping(&h, msg, msg_in, sizeof(msg));
+        *wrong = (ret == LT_OK) && memcmp(msg, msg_in, sizeof(msg));
+    }
+    else {
+        ret = lt_get_info_chip_id(&h, &chip_id);
+        // The first sweep starts without faults
+        if ((ret == LT_OK) && !chip_id_ref_valid) {
+            chip_id_ref = chip_id;
+            chip_id_ref_valid = true;
+        }
+        *wrong = (ret == LT_OK) && memcmp(&chip_id, &chip_id_ref, sizeof(chip_id));
+    }
+
+    return ret;
+}
+
+/** @brief Starts the Secure Session without faults. */
+static lt_ret_t lt_bench_session(void)
+{
+    uint32_t rates[LT_PORT_FAULT_TYPE_CNT];
+
+    memcpy(rates, fault.rate, sizeof(rates));
+    memset(fault.rate, 0, sizeof(fault.rate));
+    lt_ret_t ret = lt_verify_chip_and_start_secure_session(&h, sh0priv, sh0pub, TR01_PAIRING_KEY_SLOT_INDEX_0);
+    memcpy(fault.rate, rates, sizeof(rates));
+
+    return ret;
+}
+
+/** @brief Measures LT_BENCH_OPS operations at the current rates and prints one row. */
+static lt_ret_t lt_bench_run(const bool ping, const uint32_t rate)
+{
+    unsigned ok = 0;
+    uint64_t total_us = 0;
+
+    for (int i = 0; i < LT_BENCH_OPS; i++) {
+        const uint64_t elapsed_ms = h.l2.clock.elapsed_ms, start = lt_bench_now_us();
+        bool wrong;
+        lt_ret_t ret = lt_bench_op(ping, &wrong);
+        latencies_us[i] = lt_bench_now_us() - start;
+        if (h.l2.clock.is_virtual) {
+            latencies_us[i] += (h.l2.clock.elapsed_ms - elapsed_ms) * 1000u;
+        }
+        total_us += latencies_us[i];
+
+        if (wrong) {
+            LT_LOG_ERROR("Wrong data returned with LT_OK");
+            return LT_FAIL;
+        }
+        if (ret == LT_OK) {
+            ok++;
+        }
+        else if (ping && (lt_bench_session() != LT_OK)) {
+            LT_LOG_ERROR("Failed to start Secure Session again");
+            return LT_FAIL;
+        }
+    }
+
+    qsort(latencies_us, LT_BENCH_OPS, sizeof(latencies_us[0]), lt_bench_cmp_u64);
+    printf("  %-9s %8" PRIu32 " %7.1f %% %9.0f %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64 "\n",
+           ping ? "ping" : "get_info", rate, 100.0 * ok / LT_BENCH_OPS, ok * 1e6 / (double)total_us,
+           latencies_us[LT_BENCH_OPS / 2], latencies_us[LT_BENCH_OPS * 9 / 10], latencies_us[LT_BENCH_OPS * 99 / 100],
+           latencies_us[LT_BENCH_OPS - 1]);
+
+    return LT_OK;
+}
+
+int main(void)
+{
+#if LT_SEPARATE_L3_BUFF
+    static uint8_t l3_buffer[LT_SIZE_OF_L3_BUFF] __attribute__((aligned(16)));
+    h.l3.buff = l3_buffer;
+    h.l3.buff_len = sizeof(l3_buffer);
+#endif
+#ifdef LT_EMULATOR
+    inner.cfg = &lt_emu_model_cfg;
+#else
+    if (lt_unix_tcp_target_from_env(&inner) != LT_OK) {
+        return 1;
+    }
+#endif
+    inner.rng_seed = (unsigned int)time(NULL);
+    fault.inner = &inner;
+    fault.seed = (uint32_t)inner.rng_seed;
+    fault.busy_streak_len = LT_BENCH_BUSY_STREAK;
+    h.l2.device = &fault;
+#ifdef LT_VIRTUAL_TIME
+    h.l2.clock.is_virtual = true;
+#endif
+
+    lt_ret_t ret = lt_init(&h);
+    if (ret != LT_OK) {
+        LT_LOG_ERROR("lt_init() failed, ret=%s", lt_ret_verbose(ret));
+        return 1;
+    }
+    ret = lt_bench_session();
+    if (ret != LT_OK) {
+        LT_LOG_ERROR("Failed to start Secure Session, ret=%s", lt_ret_verbose(ret));
+        lt_deinit(&h);
+        return 1;
+    }
+
+    printf("%d operations per rate, seed %u, ping of %d bytes, rates per %u\n", LT_BENCH_OPS, inner.rng_seed,
+           LT_BENCH_PING_LEN, (unsigned)LT_PORT_FAULT_RATE_SCALE);
+    for (size_t s = 0; (ret == LT_OK) && (s < sizeof(sweeps) / sizeof(sweeps[0])); s++) {
+        printf("%s\n  %-9s %8s %9s %9s %9s %9s %9s %9s\n", sweeps[s].name, "workload", "rate", "success", "ops/s",
+               "p50 us", "p90 us", "p99 us", "max us");
+        for (int r = 0; (ret == LT_OK) && (r < LT_BENCH_RATE_CNT); r++) {
+            for (int ping = 0; (ret == LT_OK) && (ping < 2); ping++) {
+                fault.rate[sweeps[s].type] = sweeps[s].rates[r];
+                ret = lt_bench_run(ping, sweeps[s].rates[r]);
+                fault.rate[sweeps[s].type] = 0;
+            }
+        }
+    }
+
+    lt_session_abort(&h);
+    lt_deinit(&h);
+
+    return (ret == LT_OK) ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file lt_bench_fleet_update.c
+ * @brief Compares time needed to update firmware of several TROPIC01 Model instances one by one and in parallel.
+ * @details Usage: lt_bench_fleet_update <cpu.bin> <spect.bin> <port> [<port> ...]
+ *
+ * Every port is a separate model instance listening on 127.0.0.1. Target versions are not set, so all banks are
+ * written in both runs.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_fleet.h"
+#include "libtropic_logging.h"
+#include "libtropic_port_unix_fleet.h"
+#include "libtropic_port_unix_fw_file.h"
+#include "libtropic_port_unix_tcp.h"
+
+/** @brief Maximal number of model instances. */
+#define LT_BENCH_CHIP_CNT_MAX 16
+
+static lt_handle_t handles[LT_BENCH_CHIP_CNT_MAX];
+static lt_dev_unix_tcp_t devices[LT_BENCH_CHIP_CNT_MAX];
+static lt_fleet_chip_t chips[LT_BENCH_CHIP_CNT_MAX];
+#if LT_SEPARATE_L3_BUFF
+static uint8_t l3_buffers[LT_BENCH_CHIP_CNT_MAX][LT_SIZE_OF_L3_BUFF] __attribute__((aligned(16)));
+#endif
+
+static uint64_t lt_bench_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static void lt_bench_status(void *ctx, const lt_fleet_chip_t *chip)
+{
+    LT_UNUSED(ctx);
+    int idx = (int)(chip - chips);
+
+    if (chip->stage == LT_FLEET_FAILED) {
+        printf("  chip %d (port %d): FAILED in %s, ret=%s\n", idx, (int)devices[idx].port,
+               lt_fleet_stage_str(chip->failed_stage), lt_ret_verbose(chip->ret));
+    }
+    else {
+        printf("  chip %d (port %d): %s\n", idx, (int)devices[idx].port, lt_fleet_stage_str(chip->stage));
+    }
+}
+
+static lt_ret_t lt_bench_run(const lt_fleet_t *fleet, const uint16_t chip_cnt, const uint16_t max_parallel,
+                             uint64_t *duration_us)
+{
+    for (uint16_t i = 0; i < chip_cnt; i++) {
+        memset(&chips[i], 0, sizeof(chips[i]));
+        chips[i].h = &handles[i];
+    }
+
+    uint64_t start = lt_bench_now_us();
+    lt_ret_t ret = lt_unix_fleet_update(fleet, chips, chip_cnt, max_parallel);
+    *duration_us = lt_bench_now_us() - start;
+
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    if ((argc < 4) || (argc - 3 > LT_BENCH_CHIP_CNT_MAX)) {
+        fprintf(stderr, "Usage: %s <cpu.bin> <spect.bin> <port> [<port> ...] (up to %d ports)\n", argv[0],
+                LT_BENCH_CHIP_CNT_MAX);
+        return 1;
+    }
+
+    lt_unix_fw_file_t cpu_file, spect_file;
+    lt_fleet_t fleet;
+    memset(&fleet, 0, sizeof(fleet));
+    fleet.retries = 1;
+    fleet.status = lt_bench_status;
+
+    if (lt_unix_fw_file_open(&cpu_file, argv[1], &fleet.cpu.stream) != LT_OK) {
+        return 1;
+    }
+    if (lt_unix_fw_file_open(&spect_file, argv[2], &fleet.spect.stream) != LT_OK) {
+        lt_unix_fw_file_close(&cpu_file);
+        return 1;
+    }
+
+    uint16_t chip_cnt = 0;
+    lt_ret_t ret = LT_OK;
+    for (int i = 3; i < argc; i++, chip_cnt++) {
+        devices[chip_cnt].addr = inet_addr("127.0.0.1");
+        devices[chip_cnt].port = (in_port_t)atoi(argv[i]);
+        devices[chip_cnt].rng_seed = (unsigned int)time(NULL) + chip_cnt;
+        handles[chip_cnt].l2.device = &devices[chip_cnt];
+#if LT_SEPARATE_L3_BUFF
+        handles[chip_cnt].l3.buff = l3_buffers[chip_cnt];
+        handles[chip_cnt].l3.buff_len = sizeof(l3_buffers[chip_cnt]);
+#endif
+        ret = lt_init(&handles[chip_cnt]);
+        if (ret != LT_OK) {
+            LT_LOG_ERROR("lt_init() failed for port %s, ret=%s", argv[i], lt_ret_verbose(ret));
+            goto cleanup;
+        }
+    }
+
+    uint64_t serial_us, parallel_us;
+    printf("One by one:\n");
+    ret = lt_bench_run(&fleet, chip_cnt, 1, &serial_us);
+    if (ret != LT_OK) {
+        LT_LOG_ERROR("Fleet update failed, ret=%s", lt_ret_verbose(ret));
+        goto cleanup;
+    }
+
+    printf("In parallel:\n");
+    ret = lt_bench_run(&fleet, chip_cnt, 0, &parallel_us);
+    if (ret != LT_OK) {
+        LT_LOG_ERROR("Fleet update failed, ret=%s", lt_ret_verbose(ret));
+        goto cleanup;
+    }
+
+    printf("Firmware update of %d chips:\n", (int)chip_cnt);
+    printf("  one by one:  %" PRIu64 " us\n", serial_us);
+    printf("  in parallel: %" PRIu64 " us\n", parallel_us);
+
+cleanup:
+    for (uint16_t i = 0; i < chip_cnt; i++) {
+        lt_deinit(&handles[i]);
+    }
+    lt_unix_fw_file_close(&spect_file);
+    lt_unix_fw_file_close(&cpu_file);
+
+    return (ret == LT_OK) ? 0 : 1;
+}
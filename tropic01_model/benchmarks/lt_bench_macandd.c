@@ -0,0 +1,161 @@
+/**
+ * @file lt_bench_macandd.c
+ * @brief Measures latency of MAC-and-Destroy PIN setup and PIN check.
+ * @details Setup done by lt_macandd_setup() is compared with the same MAC_And_Destroy commands sent one by one, as done
+ * by the original example. Each measurement is averaged over `LT_BENCH_LOOPS` runs.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_examples.h"
+#include "libtropic_logging.h"
+#include "libtropic_macandd.h"
+#include "libtropic_port_unix_tcp.h"
+
+/** @brief R memory slot used for the record. */
+#define LT_BENCH_R_MEM_SLOT 511
+/** @brief Number of PIN entry attempts. */
+#define LT_BENCH_ROUNDS LT_MACANDD_ROUNDS_MAX
+/** @brief Number of runs of each measurement. */
+#define LT_BENCH_LOOPS 5
+
+static const uint8_t pin[] = {1, 2, 3, 4}, pin_wrong[] = {4, 3, 2, 1};
+static const uint8_t add[]
+    = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+
+static uint64_t lt_bench_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+/** @brief Sends the MAC_And_Destroy commands of lt_macandd_setup() one by one, without any host-side work. */
+static lt_ret_t lt_bench_setup_sequential(lt_handle_t *h, const uint8_t *u, const uint8_t *v)
+{
+    uint8_t ignore[TR01_MAC_AND_DESTROY_DATA_SIZE];
+
+    for (uint8_t i = 0; i < LT_BENCH_ROUNDS; i++) {
+        lt_ret_t ret = lt_mac_and_destroy(h, i, u, ignore);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        ret = lt_mac_and_destroy(h, i, v, ignore);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        ret = lt_mac_and_destroy(h, i, u, ignore);
+        if (ret != LT_OK) {
+            return ret;
+        }
+    }
+
+    return LT_OK;
+}
+
+int main(void)
+{
+    lt_handle_t h = {0};
+#if LT_SEPARATE_L3_BUFF
+    uint8_t l3_buffer[LT_SIZE_OF_L3_BUFF] __attribute__((aligned(16))) = {0};
+    h.l3.buff = l3_buffer;
+    h.l3.buff_len = sizeof(l3_buffer);
+#endif
+    lt_dev_unix_tcp_t device;
+    if (lt_unix_tcp_target_from_env(&device) != LT_OK) {
+        return 1;
+    }
+    device.rng_seed = (unsigned int)time(NULL);
+    h.l2.device = &device;
+
+    lt_ret_t ret = lt_init(&h);
+    if (ret != LT_OK) {
+        LT_LOG_ERROR("lt_init() failed, ret=%s", lt_ret_verbose(ret));
+        return 1;
+    }
+
+    ret = lt_verify_chip_and_start_secure_session(&h, sh0priv, sh0pub, TR01_PAIRING_KEY_SLOT_INDEX_0);
+    if (ret != LT_OK) {
+        LT_LOG_ERROR("Failed to start Secure Session, ret=%s", lt_ret_verbose(ret));
+        lt_deinit(&h);
+        return 1;
+    }
+
+    uint8_t master_secret[LT_MACANDD_SECRET_SIZE], key[LT_MACANDD_KEY_SIZE];
+    // Random slot initialization and PIN values for the command-by-command setup
+    uint8_t u[TR01_MAC_AND_DESTROY_DATA_SIZE], v[TR01_MAC_AND_DESTROY_DATA_SIZE];
+    uint64_t seq_us = 0, setup_us = 0, wrong_us = 0, correct_us = 0, start;
+
+    ret = lt_random_fill(&h, master_secret, sizeof(master_secret));
+    if (ret == LT_OK) {
+        ret = lt_random_fill(&h, u, sizeof(u));
+    }
+    if (ret == LT_OK) {
+        ret = lt_random_fill(&h, v, sizeof(v));
+    }
+    if (ret != LT_OK) {
+        LT_LOG_ERROR("Failed to get random bytes, ret=%s", lt_ret_verbose(ret));
+        goto cleanup;
+    }
+
+    for (int loop = 0; loop < LT_BENCH_LOOPS; loop++) {
+        start = lt_bench_now_us();
+        ret = lt_bench_setup_sequential(&h, u, v);
+        seq_us += lt_bench_now_us() - start;
+        if (ret != LT_OK) {
+            LT_LOG_ERROR("Sequential setup failed, ret=%s", lt_ret_verbose(ret));
+            goto cleanup;
+        }
+
+        start = lt_bench_now_us();
+        ret = lt_macandd_setup(&h, LT_BENCH_R_MEM_SLOT, TR01_MAC_AND_DESTROY_SLOT_0, LT_BENCH_ROUNDS, master_secret, pin,
+                               sizeof(pin), add, sizeof(add), key);
+        setup_us += lt_bench_now_us() - start;
+        if (ret != LT_OK) {
+            LT_LOG_ERROR("lt_macandd_setup() failed, ret=%s", lt_ret_verbose(ret));
+            goto cleanup;
+        }
+
+        start = lt_bench_now_us();
+        ret = lt_macandd_check(&h, LT_BENCH_R_MEM_SLOT, pin_wrong, sizeof(pin_wrong), add, sizeof(add), key);
+        wrong_us += lt_bench_now_us() - start;
+        if (ret != LT_MACANDD_WRONG_PIN) {
+            LT_LOG_ERROR("lt_macandd_check() with wrong PIN returned %s", lt_ret_verbose(ret));
+            ret = LT_FAIL;
+            goto cleanup;
+        }
+
+        // Restores the slot consumed by the wrong attempt
+        start = lt_bench_now_us();
+        ret = lt_macandd_check(&h, LT_BENCH_R_MEM_SLOT, pin, sizeof(pin), add, sizeof(add), key);
+        correct_us += lt_bench_now_us() - start;
+        if (ret != LT_OK) {
+            LT_LOG_ERROR("lt_macandd_check() with correct PIN failed, ret=%s", lt_ret_verbose(ret));
+            goto cleanup;
+        }
+    }
+
+    printf("MAC-and-Destroy PIN, %d rounds (average of %d runs):\n", (int)LT_BENCH_ROUNDS, LT_BENCH_LOOPS);
+    printf("  setup, command by command (no host work): %" PRIu64 " us\n", seq_us / LT_BENCH_LOOPS);
+    printf("  lt_macandd_setup():                        %" PRIu64 " us\n", setup_us / LT_BENCH_LOOPS);
+    printf("  lt_macandd_check(), wrong PIN:             %" PRIu64 " us\n", wrong_us / LT_BENCH_LOOPS);
+    printf("  lt_macandd_check(), correct PIN:           %" PRIu64 " us\n", correct_us / LT_BENCH_LOOPS);
+
+cleanup:
+    if (lt_r_mem_data_erase(&h, LT_BENCH_R_MEM_SLOT) != LT_OK) {
+        LT_LOG_ERROR("Failed to erase slot.");
+        ret = LT_FAIL;
+    }
+    lt_session_abort(&h);
+    lt_deinit(&h);
+
+    return (ret == LT_OK) ? 0 : 1;
+}
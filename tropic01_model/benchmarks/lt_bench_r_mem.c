@@ -0,0 +1,169 @@
+/**
+ * @file lt_bench_r_mem.c
+ * @brief Compares time needed to read the whole User Partition of R memory slot by slot and using the pipelined
+ * lt_r_mem_data_read_range().
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_examples.h"
+#include "libtropic_logging.h"
+#include "libtropic_port_unix_tcp.h"
+
+/** @brief Number of slots in the User Partition. */
+#define LT_BENCH_SLOT_CNT (TR01_R_MEM_DATA_SLOT_MAX + 1)
+
+/** @brief Number of slots processed by one ranged call, so the scatter buffers fit on the stack. */
+#define LT_BENCH_CHUNK_SLOT_CNT 16
+
+static uint64_t lt_bench_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static lt_ret_t lt_bench_fill_slots(lt_handle_t *h)
+{
+    uint8_t data[LT_BENCH_CHUNK_SLOT_CNT][TR01_R_MEM_DATA_SIZE_MAX];
+    lt_r_mem_data_wr_t wr[LT_BENCH_CHUNK_SLOT_CNT];
+    lt_ret_t ret;
+
+    ret = lt_r_mem_data_erase_range(h, 0, LT_BENCH_SLOT_CNT, NULL);
+    if (ret != LT_OK) {
+        return ret;
+    }
+
+    for (uint16_t first = 0; first < LT_BENCH_SLOT_CNT; first += LT_BENCH_CHUNK_SLOT_CNT) {
+        for (uint16_t i = 0; i < LT_BENCH_CHUNK_SLOT_CNT; i++) {
+            memset(data[i], (int)(first + i), sizeof(data[i]));
+            wr[i].slot = first + i;
+            wr[i].data = data[i];
+            wr[i].data_size = TR01_R_MEM_DATA_SIZE_MAX;
+        }
+        ret = lt_r_mem_data_write_vec(h, wr, LT_BENCH_CHUNK_SLOT_CNT);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        for (uint16_t i = 0; i < LT_BENCH_CHUNK_SLOT_CNT; i++) {
+            if (wr[i].ret != LT_OK) {
+                return wr[i].ret;
+            }
+        }
+    }
+
+    return LT_OK;
+}
+
+static lt_ret_t lt_bench_read_sequential(lt_handle_t *h)
+{
+    uint8_t data[TR01_R_MEM_DATA_SIZE_MAX];
+    uint16_t read_size;
+
+    for (uint16_t i = 0; i < LT_BENCH_SLOT_CNT; i++) {
+        lt_ret_t ret = lt_r_mem_data_read(h, i, data, sizeof(data), &read_size);
+        if (ret != LT_OK) {
+            return ret;
+        }
+    }
+
+    return LT_OK;
+}
+
+static lt_ret_t lt_bench_read_range(lt_handle_t *h)
+{
+    uint8_t data[LT_BENCH_CHUNK_SLOT_CNT][TR01_R_MEM_DATA_SIZE_MAX];
+    lt_r_mem_data_rd_t rd[LT_BENCH_CHUNK_SLOT_CNT];
+
+    for (uint16_t i = 0; i < LT_BENCH_CHUNK_SLOT_CNT; i++) {
+        rd[i].data = data[i];
+        rd[i].data_max_size = TR01_R_MEM_DATA_SIZE_MAX;
+    }
+
+    for (uint16_t first = 0; first < LT_BENCH_SLOT_CNT; first += LT_BENCH_CHUNK_SLOT_CNT) {
+        lt_ret_t ret = lt_r_mem_data_read_range(h, first, LT_BENCH_CHUNK_SLOT_CNT, rd);
+        if (ret != LT_OK) {
+            return ret;
+        }
+        for (uint16_t i = 0; i < LT_BENCH_CHUNK_SLOT_CNT; i++) {
+            if (rd[i].ret != LT_OK) {
+                return rd[i].ret;
+            }
+        }
+    }
+
+    return LT_OK;
+}
+
+int main(void)
+{
+    lt_handle_t h = {0};
+#if LT_SEPARATE_L3_BUFF
+    uint8_t l3_buffer[LT_SIZE_OF_L3_BUFF] __attribute__((aligned(16))) = {0};
+    h.l3.buff = l3_buffer;
+    h.l3.buff_len = sizeof(l3_buffer);
+#endif
+    lt_dev_unix_tcp_t device;
+    if (lt_unix_tcp_target_from_env(&device) != LT_OK) {
+        return 1;
+    }
+    device.rng_seed = (unsigned int)time(NULL);
+    h.l2.device = &device;
+
+    lt_ret_t ret = lt_init(&h);
+    if (ret != LT_OK) {
+        LT_LOG_ERROR("lt_init() failed, ret=%s", lt_ret_verbose(ret));
+        return 1;
+    }
+
+    ret = lt_verify_chip_and_start_secure_session(&h, sh0priv, sh0pub, TR01_PAIRING_KEY_SLOT_INDEX_0);
+    if (ret != LT_OK) {
+        LT_LOG_ERROR("Failed to start Secure Session, ret=%s", lt_ret_verbose(ret));
+        lt_deinit(&h);
+        return 1;
+    }
+
+    ret = lt_bench_fill_slots(&h);
+    if (ret != LT_OK) {
+        LT_LOG_ERROR("Failed to fill slots, ret=%s", lt_ret_verbose(ret));
+        goto cleanup;
+    }
+
+    uint64_t start = lt_bench_now_us();
+    ret = lt_bench_read_sequential(&h);
+    uint64_t seq_us = lt_bench_now_us() - start;
+    if (ret != LT_OK) {
+        LT_LOG_ERROR("Sequential read failed, ret=%s", lt_ret_verbose(ret));
+        goto cleanup;
+    }
+
+    start = lt_bench_now_us();
+    ret = lt_bench_read_range(&h);
+    uint64_t range_us = lt_bench_now_us() - start;
+    if (ret != LT_OK) {
+        LT_LOG_ERROR("Ranged read failed, ret=%s", lt_ret_verbose(ret));
+        goto cleanup;
+    }
+
+    printf("Whole User Partition read (%d slots x %d B):\n", (int)LT_BENCH_SLOT_CNT, (int)TR01_R_MEM_DATA_SIZE_MAX);
+    printf("  lt_r_mem_data_read():       %" PRIu64 " us\n", seq_us);
+    printf("  lt_r_mem_data_read_range(): %" PRIu64 " us\n", range_us);
+
+cleanup:
+    if (lt_r_mem_data_erase_range(&h, 0, LT_BENCH_SLOT_CNT, NULL) != LT_OK) {
+        LT_LOG_ERROR("Failed to erase slots.");
+        ret = LT_FAIL;
+    }
+    lt_session_abort(&h);
+    lt_deinit(&h);
+
+    return (ret == LT_OK) ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file lt_bench_trace.c
+ * @brief Measures host CPU time libtropic spends on a workload, by replaying a trace recorded by hal/port/trace/.
+ * @details lt_bench_trace_record records the workload against the emulator (or the model over TCP without
+ * LT_EMULATOR). lt_bench_trace_replay replays a trace of the workload LT_BENCH_REPLAYS times from memory and reports
+ * the CPU time of each replay; the trace may also come from real hardware. The replay does no I/O and no delays, so the
+ * numbers do not depend on the chip or the bus and regressions show up directly. Both take the trace file as an
+ * optional argument (lt_bench_trace.bin by default). They are separate executables, because each port defines its own
+ * lt_port_* functions.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // fmemopen()
+#endif
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_examples.h"
+#include "libtropic_logging.h"
+#include "libtropic_port_trace.h"
+#ifdef LT_BENCH_TRACE_RECORD
+#ifdef LT_EMULATOR
+#include "libtropic_port_emulator.h"
+
+extern const lt_emu_cfg_t lt_emu_model_cfg;
+#else
+#include "libtropic_port_unix_tcp.h"
+#endif
+#endif
+
+/** @brief Number of replays of the trace. */
+#define LT_BENCH_REPLAYS 200
+/** @brief Number of pings of each length in the workload. */
+#define LT_BENCH_PINGS 20
+/** @brief Default trace file. */
+#define LT_BENCH_TRACE_PATH "lt_bench_trace.bin"
+
+static lt_handle_t h;
+
+/** @brief Runs the workload: Secure Session, pings of several lengths, signatures and R-memory accesses. */
+static lt_ret_t lt_bench_workload(void)
+{
+    static const uint16_t ping_lens[] = {16, 256, TR01_PING_LEN_MAX};
+    static uint8_t msg[TR01_PING_LEN_MAX], msg_in[TR01_PING_LEN_MAX];
+    const uint8_t hash[32] = {0};
+    uint8_t rs[64], r_mem[TR01_R_MEM_DATA_SIZE_MAX];
+    uint16_t r_mem_len;
+
+    lt_ret_t ret = lt_init(&h);
+    if (ret != LT_OK) {
+        return ret;
+    }
+    ret = lt_verify_chip_and_start_secure_session(&h, sh0priv, sh0pub, TR01_PAIRING_KEY_SLOT_INDEX_0);
+    for (size_t l = 0; (ret == LT_OK) && (l < sizeof(ping_lens) / sizeof(ping_lens[0])); l++) {
+        for (int i = 0; (ret == LT_OK) && (i < LT_BENCH_PINGS); i++) {
+            ret = lt_ping(&h, msg, msg_in, ping_lens[l]);
+        }
+    }
+    if (ret == LT_OK) {
+        ret = lt_ecc_key_generate(&h, TR01_ECC_SLOT_0, TR01_CURVE_P256);
+    }
+    for (int i = 0; (ret == LT_OK) && (i < LT_BENCH_PINGS); i++) {
+        ret = lt_ecc_ecdsa_sign(&h, TR01_ECC_SLOT_0, hash, sizeof(hash), rs);
+    }
+    if (ret == LT_OK) {
+        ret = lt_ecc_key_erase(&h, TR01_ECC_SLOT_0);
+    }
+    if (ret == LT_OK) {
+        memset(r_mem, 0x5a, sizeof(r_mem));
+        ret = lt_r_mem_data_write(&h, 0, r_mem, sizeof(r_mem));
+    }
+    for (int i = 0; (ret == LT_OK) && (i < LT_BENCH_PINGS); i++) {
+        ret = lt_r_mem_data_read(&h, 0, r_mem, sizeof(r_mem), &r_mem_len);
+    }
+    if (ret == LT_OK) {
+        ret = lt_r_mem_data_erase(&h, 0);
+    }
+    if (ret == LT_OK) {
+        ret = lt_session_abort(&h);
+    }
+
+    lt_ret_t ret_deinit = lt_deinit(&h);
+
+    return (ret == LT_OK) ? ret_deinit : ret;
+}
+
+#ifdef LT_BENCH_TRACE_RECORD
+static int lt_bench_main(const char *path)
+{
+#ifdef LT_EMULATOR
+    static lt_dev_emulator_t inner;
+    inner.cfg = &lt_emu_model_cfg;
+#else
+    static lt_dev_unix_tcp_t inner;
+    if (lt_unix_tcp_target_from_env(&inner) != LT_OK) {
+        return 1;
+    }
+#endif
+    static lt_dev_trace_record_t record;
+
+    inner.rng_seed = (unsigned int)time(NULL);
+    record.inner = &inner;
+    record.file = fopen(path, "wb");
+    if (!record.file) {
+        LT_LOG_ERROR("Cannot open %s", path);
+        return 1;
+    }
+    h.l2.device = &record;
+
+    lt_ret_t ret = lt_bench_workload();
+    fclose(record.file);
+    if ((ret != LT_OK) || record.write_err) {
+        LT_LOG_ERROR("Recording failed, ret=%s", lt_ret_verbose(ret));
+        return 1;
+    }
+    printf("Workload recorded to %s\n", path);
+
+    return 0;
+}
+#else
+static int lt_bench_cmp_u64(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t lt_bench_cpu_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static int lt_bench_main(const char *path)
+{
+    static lt_dev_trace_replay_t replay;
+    static uint64_t cpu_us[LT_BENCH_REPLAYS];
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        LT_LOG_ERROR("Cannot open %s", path);
+        return 1;
+    }
+
+    // The trace is replayed from memory, so the replay measures libtropic and not the file system
+    static char trace[1 << 20];
+    size_t trace_len = fread(trace, 1, sizeof(trace), file);
+    fclose(file);
+
+    for (int i = 0; i < LT_BENCH_REPLAYS; i++) {
+        memset(&replay, 0, sizeof(replay));
+        replay.file = fmemopen(trace, trace_len, "rb");
+        h.l2.device = &replay;
+
+        const uint64_t start = lt_bench_cpu_us();
+        lt_ret_t ret = lt_bench_workload();
+        cpu_us[i] = lt_bench_cpu_us() - start;
+        fclose(replay.file);
+
+        if ((ret != LT_OK) || replay.mismatch) {
+            LT_LOG_ERROR("Replay of %s failed, ret=%s", path, lt_ret_verbose(ret));
+            return 1;
+        }
+    }
+
+    qsort(cpu_us, LT_BENCH_REPLAYS, sizeof(cpu_us[0]), lt_bench_cmp_u64);
+    printf("%s: %u records, %" PRIu64 " us recorded, %d replays\n", path, (unsigned)replay.records, replay.trace_us,
+           LT_BENCH_REPLAYS);
+    printf("host CPU time per replay: p50 %" PRIu64 " us, p90 %" PRIu64 " us, p99 %" PRIu64 " us, max %" PRIu64
+           " us\n",
+           cpu_us[LT_BENCH_REPLAYS / 2], cpu_us[LT_BENCH_REPLAYS * 9 / 10], cpu_us[LT_BENCH_REPLAYS * 99 / 100],
+           cpu_us[LT_BENCH_REPLAYS - 1]);
+
+    return 0;
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+#if LT_SEPARATE_L3_BUFF
+    static uint8_t l3_buffer[LT_SIZE_OF_L3_BUFF] __attribute__((aligned(16)));
+    h.l3.buff = l3_buffer;
+    h.l3.buff_len = sizeof(l3_buffer);
+#endif
+
+    return lt_bench_main((argc > 1) ? argv[1] : LT_BENCH_TRACE_PATH);
+}
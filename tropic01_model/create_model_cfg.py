@@ -31,6 +31,54 @@ def parse_and_complete_chip_id(pkg_yml: dict) -> bytes:
     res += 24 * b'\xff'  # Padding
     return res
 
+def c_bytes(data: bytes, indent: str) -> str:
+    """Format bytes as lines of a C array initializer."""
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append(indent + ", ".join(f"0x{b:02x}" for b in data[i:i + 16]) + ",")
+    return "\n".join(lines)
+
+def write_emulator_cfg(path: pathlib.Path, model_cfg: dict, pkg_name: str) -> None:
+    """Write the model configuration as a C source file with lt_emu_cfg_t for the in-process emulator."""
+    pairing_keys = []
+    pairing_key_states = []
+    for slot in range(4):
+        key = model_cfg["i_pairing_keys"].get(slot)
+        pairing_keys.append(key["value"] if key else 32 * b'\x00')
+        pairing_key_states.append("LT_EMU_PAIRING_KEY_WRITTEN" if key else "LT_EMU_PAIRING_KEY_EMPTY")
+
+    src = f"""// Generated by create_model_cfg.py from {pkg_name}, do not edit.
+
+#include "libtropic_port_emulator.h"
+
+extern const lt_emu_cfg_t lt_emu_model_cfg;
+
+static const uint8_t lt_emu_model_cert_store[] = {{
+{c_bytes(model_cfg["x509_certificate"], "    ")}
+}};
+
+const lt_emu_cfg_t lt_emu_model_cfg = {{
+    .cert_store = lt_emu_model_cert_store,
+    .cert_store_len = sizeof(lt_emu_model_cert_store),
+    .chip_id = {{
+{c_bytes(model_cfg["chip_id"], "        ")}
+    }},
+    .s_t_priv = {{
+{c_bytes(model_cfg["s_t_priv"], "        ")}
+    }},
+    .s_t_pub = {{
+{c_bytes(model_cfg["s_t_pub"], "        ")}
+    }},
+    .pairing_keys = {{
+"""
+    for key in pairing_keys:
+        src += f"        {{\n{c_bytes(key, '            ')}\n        }},\n"
+    src += f"""    }},
+    .pairing_key_state = {{{", ".join(pairing_key_states)}}},
+}};
+"""
+    path.write_text(src)
+
 
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(
@@ -52,10 +100,17 @@ if __name__ == "__main__":
         default="model_cfg.yml"
     )
 
+    parser.add_argument(
+        "--emulator-cfg",
+        help="Path to the C source file where to put the same configuration for the in-process emulator.",
+        type=pathlib.Path
+    )
+
     # Parse and save arguments
     args = parser.parse_args()
     pkg_dir_path: pathlib.Path = args.pkg_dir
     model_cfg_path: pathlib.Path = args.model_cfg
+    emulator_cfg_path: pathlib.Path = args.emulator_cfg
 
     # Load batch package YAML
     with pkg_dir_path.joinpath("tropic01_lab_batch_package.yml").open("r") as f:
@@ -133,4 +188,7 @@ if __name__ == "__main__":
 
     # Generate the model configuration YAML
     with model_cfg_path.open("w") as f:
-        yaml.dump(model_cfg, f, default_flow_style=False)
\ No newline at end of file
+        yaml.dump(model_cfg, f, default_flow_style=False)
+
+    if emulator_cfg_path:
+        write_emulator_cfg(emulator_cfg_path, model_cfg, pkg_dir_path.name)
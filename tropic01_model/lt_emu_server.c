@@ -0,0 +1,185 @@
+/**
+ * @file lt_emu_server.c
+ * @brief Serves the emulated TROPIC01 (hal/port/emulator) over the TCP protocol of the model server.
+ * @details Usage: lt_emu_server [-a <address>] [-p <port>] [-s <seed>]
+ *
+ * Executables built with the TCP port (hal/port/unix) talk to it as to `model_server tcp`, so tests and tools using
+ * TCP run without the model installed. Clients are served one after another; the chip is provisioned at start and
+ * keeps its state between clients until the server exits, like the model. Every server is a separate chip, so the
+ * model test runner starts one per test on its own port.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "libtropic_common.h"
+#include "libtropic_port_unix_tcp.h"
+#include "lt_emu_chip.h"
+#include "lt_l1.h"
+
+// Provisioning of the emulated chip, generated by create_model_cfg.py
+extern const lt_emu_cfg_t lt_emu_model_cfg;
+
+/** @brief State of the served chip. */
+typedef struct lt_emu_server_t {
+    lt_emu_chip_t chip;
+    /** Chip select is driven low */
+    bool csn_low;
+    /** Bytes sent by the host since chip select went low */
+    uint8_t mosi[TR01_L1_LEN_MAX];
+    /** Number of bytes transferred since chip select went low */
+    uint16_t pos;
+} lt_emu_server_t;
+
+/** @brief Too big for the stack. */
+static lt_emu_server_t server;
+
+/** @brief Reads exactly `len` bytes, returns false when the client disconnected. */
+static bool lt_emu_server_recv(const int fd, uint8_t *buff, const size_t len)
+{
+    for (size_t done = 0; done < len;) {
+        ssize_t n = recv(fd, buff + done, len - done, 0);
+        if (n <= 0) {
+            return false;
+        }
+        done += (size_t)n;
+    }
+
+    return true;
+}
+
+/** @brief Full duplex: every byte sent by the host is replaced with the byte of the chip. */
+static void lt_emu_server_transfer(uint8_t *data, const uint16_t len)
+{
+    for (uint16_t i = 0; (i < len) && (server.pos < TR01_L1_LEN_MAX); i++, server.pos++) {
+        server.mosi[server.pos] = data[i];
+
+        if (server.pos == 0) {
+            data[i] = lt_emu_chip_status(&server.chip);
+            continue;
+        }
+        const uint8_t *rsp = lt_emu_chip_response(&server.chip);
+        data[i] = (rsp && (server.mosi[0] == TR01_L1_GET_RESPONSE_REQ_ID)) ? rsp[server.pos - 1] : 0xff;
+    }
+}
+
+/**
+ * @brief Handles one request of the model's protocol.
+ *
+ * @param msg     Request, replaced with the response
+ * @return        Length of the response payload
+ */
+static uint16_t lt_emu_server_handle(lt_unix_tcp_buffer_t *msg)
+{
+    switch ((lt_unix_tcp_tag_t)msg->tag) {
+        case LT_UNIX_TCP_TAG_SPI_DRIVE_CSN_LOW:
+            server.csn_low = true;
+            server.pos = 0;
+            return 0;
+        case LT_UNIX_TCP_TAG_SPI_DRIVE_CSN_HIGH:
+            if (server.csn_low) {
+                server.csn_low = false;
+                lt_emu_chip_end(&server.chip, server.mosi, server.pos);
+            }
+            return 0;
+        case LT_UNIX_TCP_TAG_SPI_SEND:
+            lt_emu_server_transfer(msg->payload, msg->len);
+            return msg->len;
+        case LT_UNIX_TCP_TAG_POWER_ON:
+        case LT_UNIX_TCP_TAG_POWER_OFF:
+        case LT_UNIX_TCP_TAG_WAIT:
+            // The emulated chip is always powered and answers at once
+            return 0;
+        case LT_UNIX_TCP_TAG_RESET_TARGET:
+            msg->tag = LT_UNIX_TCP_TAG_UNSUPPORTED;
+            return 0;
+        default:
+            msg->tag = LT_UNIX_TCP_TAG_INVALID;
+            return 0;
+    }
+}
+
+/** @brief Serves one client until it disconnects. */
+static void lt_emu_server_serve(const int fd)
+{
+    static lt_unix_tcp_buffer_t msg;
+
+    server.csn_low = false;
+    while (lt_emu_server_recv(fd, msg.buff, LT_UNIX_TCP_TAG_AND_LENGTH_SIZE)) {
+        if ((msg.len > LT_UNIX_TCP_MAX_PAYLOAD_LEN) || !lt_emu_server_recv(fd, msg.payload, msg.len)) {
+            return;
+        }
+        msg.len = lt_emu_server_handle(&msg);
+        if (send(fd, msg.buff, LT_UNIX_TCP_TAG_AND_LENGTH_SIZE + msg.len, 0) < 0) {
+            return;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *addr = LT_UNIX_TCP_DEFAULT_ADDR;
+    unsigned long port = LT_UNIX_TCP_DEFAULT_PORT;
+    unsigned int seed = (unsigned int)time(NULL);
+    int opt;
+
+    while ((opt = getopt(argc, argv, "a:p:s:")) != -1) {
+        switch (opt) {
+            case 'a':
+                addr = optarg;
+                break;
+            case 'p':
+                port = strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                seed = (unsigned int)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-a <address>] [-p <port>] [-s <seed>]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    struct sockaddr_in sa = {.sin_family = AF_INET, .sin_port = htons((uint16_t)port)};
+    if ((port == 0) || (port > UINT16_MAX) || (inet_pton(AF_INET, addr, &sa.sin_addr) != 1)) {
+        fprintf(stderr, "Invalid address %s:%lu\n", addr, port);
+        return EXIT_FAILURE;
+    }
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    const int one = 1;
+    if ((listen_fd < 0) || setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one))
+        || bind(listen_fd, (struct sockaddr *)&sa, sizeof(sa)) || listen(listen_fd, 1)) {
+        fprintf(stderr, "Cannot listen on %s:%lu: %s\n", addr, port, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    lt_emu_chip_init(&server.chip, &lt_emu_model_cfg, (const uint8_t *)&seed, sizeof(seed));
+    printf("Emulated TROPIC01 listening on %s:%lu, seed=%u\n", addr, port, seed);
+    fflush(stdout);
+
+    for (;;) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "accept() failed: %s\n", strerror(errno));
+            return EXIT_FAILURE;
+        }
+        lt_emu_server_serve(fd);
+        close(fd);
+    }
+}
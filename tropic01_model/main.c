@@ -5,7 +5,6 @@
  * @license For the license see file LICENSE.txt file in the root directory of this source tree.
  */
 
-#include <arpa/inet.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -14,7 +13,14 @@
 #include "libtropic_functional_tests.h"
 #include "libtropic_logging.h"
 #include "libtropic_port.h"
+#ifdef LT_EMULATOR
+#include "libtropic_port_emulator.h"
+
+// Provisioning of the emulated chip, generated by create_model_cfg.py
+extern const lt_emu_cfg_t lt_emu_model_cfg;
+#else
 #include "libtropic_port_unix_tcp.h"
+#endif
 
 int main(void)
 {
@@ -31,11 +37,23 @@ int main(void)
     __lt_handle__.l3.buff_len = sizeof(l3_buffer);
 #endif
     // Initialize device before handing handle to the test.
+#ifdef LT_EMULATOR
+    // Too big for the stack and has to be zeroed
+    static lt_dev_emulator_t device;
+    device.cfg = &lt_emu_model_cfg;
+#else
     lt_dev_unix_tcp_t device;
-    device.addr = inet_addr("127.0.0.1");
-    device.port = 28992;
+    // Several model instances can run at once, LT_MODEL_PORT selects the one for this process
+    if (lt_unix_tcp_target_from_env(&device) != LT_OK) {
+        return 1;
+    }
+#endif
     device.rng_seed = (unsigned int)time(NULL);
     __lt_handle__.l2.device = &device;
+#ifdef LT_VIRTUAL_TIME
+    // Neither the model nor the emulator needs real time to pass
+    __lt_handle__.l2.clock.is_virtual = true;
+#endif
 
     LT_LOG_INFO("RNG initialized with seed=%u\n", device.rng_seed);
 
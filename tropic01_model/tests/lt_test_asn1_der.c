@@ -0,0 +1,148 @@
+/**
+ * @file lt_test_asn1_der.c
+ * @brief Malformed input to the ASN1 DER cursor in src/lt_asn1_der.c.
+ * @details Checks that truncated elements, elements exceeding their parent, lengths not in the shortest form and
+ * deeply nested elements are rejected or walked without reading outside of the stream.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "libtropic_common.h"
+#include "libtropic_functional_tests.h"
+#include "lt_asn1_der.h"
+
+/** @brief Depth of the nested SEQUENCEs. */
+#define LT_TEST_DER_DEPTH 1000
+/** @brief Size of one SEQUENCE header with a 2 byte long form length. */
+#define LT_TEST_DER_HDR_LEN 4
+
+/** @brief Reads the only element of a stream, returns the result of lt_asn1der_next(). */
+static lt_ret_t lt_test_der_next(const uint8_t *der, const uint32_t len, lt_asn1der_tlv_t *tlv)
+{
+    lt_asn1der_cursor_t cur;
+
+    lt_asn1der_cursor_init(&cur, der, len);
+
+    return lt_asn1der_next(&cur, tlv);
+}
+
+static bool lt_test_der_truncated(void)
+{
+    static const uint8_t tag_only[] = {0x30};
+    static const uint8_t short_value[] = {0x04, 0x05, 0x01, 0x02};
+    static const uint8_t short_len[] = {0x04, 0x82, 0x01};
+    lt_asn1der_tlv_t tlv;
+
+    printf("Truncated elements\n");
+    LT_TEST_TRUE(lt_test_der_next(tag_only, 0, &tlv) == LT_CERT_ITEM_NOT_FOUND);
+    LT_TEST_TRUE(lt_test_der_next(tag_only, sizeof(tag_only), &tlv) == LT_CERT_STORE_INVALID);
+    LT_TEST_TRUE(lt_test_der_next(short_value, sizeof(short_value), &tlv) == LT_CERT_STORE_INVALID);
+    LT_TEST_TRUE(lt_test_der_next(short_len, sizeof(short_len), &tlv) == LT_CERT_STORE_INVALID);
+
+    return true;
+}
+
+static bool lt_test_der_parent_overflow(void)
+{
+    // SEQUENCE of 3 bytes holding an OCTET STRING of 4 bytes, the stream continues past the SEQUENCE
+    static const uint8_t der[] = {0x30, 0x03, 0x04, 0x04, 0xaa, 0xbb, 0xcc, 0xdd};
+    lt_asn1der_cursor_t cur, inner;
+    lt_asn1der_tlv_t tlv;
+
+    printf("Element exceeding its parent\n");
+    lt_asn1der_cursor_init(&cur, der, sizeof(der));
+    LT_TEST_TRUE(lt_asn1der_next(&cur, &tlv) == LT_OK);
+    LT_TEST_TRUE(tlv.value.len == 3);
+    lt_asn1der_enter(&cur, &tlv, &inner);
+    LT_TEST_TRUE(lt_asn1der_next(&inner, &tlv) == LT_CERT_STORE_INVALID);
+
+    return true;
+}
+
+static bool lt_test_der_lengths(void)
+{
+    static const uint8_t long_small[] = {0x04, 0x81, 0x05, 1, 2, 3, 4, 5};
+    static const uint8_t long_zero[] = {0x04, 0x81, 0x00};
+    // Fit the stream, so only the encoding of their length rejects or accepts them
+    static const uint8_t leading_zero[4 + 0x80] = {0x04, 0x82, 0x00, 0x80};
+    static const uint8_t indefinite[] = {0x30, 0x80, 0x00, 0x00};
+    static const uint8_t too_long[] = {0x04, 0x85, 0x01, 0x00, 0x00, 0x00, 0x00};
+    static const uint8_t long_min[3 + 0x80] = {0x04, 0x81, 0x80};
+    static const uint8_t short_max[2 + 0x7f] = {0x04, 0x7f};
+    lt_asn1der_tlv_t tlv;
+
+    printf("Lengths not in the shortest form\n");
+    LT_TEST_TRUE(lt_test_der_next(long_small, sizeof(long_small), &tlv) == LT_CERT_STORE_INVALID);
+    LT_TEST_TRUE(lt_test_der_next(long_zero, sizeof(long_zero), &tlv) == LT_CERT_STORE_INVALID);
+    LT_TEST_TRUE(lt_test_der_next(leading_zero, sizeof(leading_zero), &tlv) == LT_CERT_STORE_INVALID);
+    LT_TEST_TRUE(lt_test_der_next(indefinite, sizeof(indefinite), &tlv) == LT_CERT_STORE_INVALID);
+    LT_TEST_TRUE(lt_test_der_next(too_long, sizeof(too_long), &tlv) == LT_CERT_UNSUPPORTED);
+
+    printf("Lengths in the shortest form\n");
+    LT_TEST_TRUE(lt_test_der_next(long_min, sizeof(long_min), &tlv) == LT_OK);
+    LT_TEST_TRUE((tlv.value.len == 0x80) && (tlv.raw.len == sizeof(long_min)));
+    LT_TEST_TRUE(lt_test_der_next(short_max, sizeof(short_max), &tlv) == LT_OK);
+    LT_TEST_TRUE((tlv.value.len == 0x7f) && (tlv.raw.len == sizeof(short_max)));
+
+    return true;
+}
+
+static bool lt_test_der_nesting(void)
+{
+    static uint8_t der[LT_TEST_DER_DEPTH * LT_TEST_DER_HDR_LEN];
+    lt_asn1der_cursor_t cur, inner;
+    lt_asn1der_tlv_t tlv;
+    lt_asn1der_cert_t cert;
+
+    // Built from the innermost empty SEQUENCE outwards, each length in the shortest form
+    uint32_t start = sizeof(der);
+    for (uint32_t i = 0; i < LT_TEST_DER_DEPTH; i++) {
+        const uint32_t len = (uint32_t)sizeof(der) - start;
+        der[--start] = (uint8_t)len;
+        if (len >= 0x100) {
+            der[--start] = (uint8_t)(len >> 8);
+            der[--start] = 0x82;
+        }
+        else if (len >= 0x80) {
+            der[--start] = 0x81;
+        }
+        der[--start] = LT_ASN1DER_SEQUENCE;
+    }
+
+    printf("Excessive nesting\n");
+    // As a certificate it is rejected where the serial number is expected
+    LT_TEST_TRUE(lt_asn1der_parse_cert(&der[start], sizeof(der) - start, &cert) == LT_CERT_STORE_INVALID);
+
+    // The cursor needs no stack to descend, every level ends where its parent does
+    lt_asn1der_cursor_init(&cur, &der[start], sizeof(der) - start);
+    uint32_t depth = 0;
+    while (lt_asn1der_next(&cur, &tlv) == LT_OK) {
+        LT_TEST_TRUE(tlv.tag == LT_ASN1DER_SEQUENCE);
+        LT_TEST_TRUE(tlv.value.ptr + tlv.value.len == der + sizeof(der));
+        lt_asn1der_enter(&cur, &tlv, &inner);
+        cur = inner;
+        depth++;
+    }
+    LT_TEST_TRUE(depth == LT_TEST_DER_DEPTH);
+
+    return true;
+}
+
+int main(void)
+{
+    // Disable buffering on stdout and stderr (problem in GitHub CI)
+    setvbuf(stdout, NULL, _IONBF, 0);
+    setvbuf(stderr, NULL, _IONBF, 0);
+
+    bool ok = lt_test_der_truncated() && lt_test_der_parent_overflow() && lt_test_der_lengths()
+              && lt_test_der_nesting();
+
+    printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,178 @@
+/**
+ * @file lt_test_fleet_update.c
+ * @brief Fleet firmware update of several emulated chips in parallel, with per-chip transport faults.
+ * @details Every chip is an emulator wrapped by its own fault injecting port. lt_unix_fleet_update() updates all of
+ * them at once: a chip without faults and a chip whose transfer is cut once are updated, a chip whose transfer is cut
+ * more times than the fleet retries fails in LT_FLEET_UPDATE_CPU and keeps booting its old firmware, and a chip
+ * updated before is reported up to date.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_fleet.h"
+#include "libtropic_functional_tests.h"
+#include "libtropic_macros.h"
+#include "libtropic_port_emulator.h"
+#include "libtropic_port_fault.h"
+#include "libtropic_port_unix_fleet.h"
+#include "lt_test_fw_image.h"
+
+extern const lt_emu_cfg_t lt_emu_model_cfg;
+
+/** @brief Transactions of an image transfer between two cuts, less than the transfer of one image takes. */
+#define LT_TEST_FLEET_CUT_SPACING 10
+
+/** @brief Chips of the fleet, by what happens to them. */
+enum {
+    LT_TEST_FLEET_CHIP_OK = 0,
+    LT_TEST_FLEET_CHIP_RESUMED,
+    LT_TEST_FLEET_CHIP_FAILED,
+    LT_TEST_FLEET_CHIP_UP_TO_DATE,
+    LT_TEST_FLEET_CHIP_CNT
+};
+
+static lt_handle_t handles[LT_TEST_FLEET_CHIP_CNT];
+static lt_dev_emulator_t emulators[LT_TEST_FLEET_CHIP_CNT];
+static lt_dev_fault_t faults[LT_TEST_FLEET_CHIP_CNT];
+static lt_fleet_chip_t chips[LT_TEST_FLEET_CHIP_CNT];
+#if LT_SEPARATE_L3_BUFF
+static uint8_t l3_buffers[LT_TEST_FLEET_CHIP_CNT][LT_SIZE_OF_L3_BUFF] __attribute__((aligned(16)));
+#endif
+static lt_test_fw_image_t cpu_image, spect_image;
+
+/** @brief Number of times the RISC-V image transfer of each chip is cut. */
+static const uint8_t cut_cnt[LT_TEST_FLEET_CHIP_CNT] = {0, 1, 2, 0};
+/** @brief Transport faults cutting the transfers, scheduled by lt_test_fleet_status(). */
+static lt_port_fault_event_t cuts[LT_TEST_FLEET_CHIP_CNT][2];
+/** @brief Last stage each chip reported through the status callback. */
+static lt_fleet_stage_t reported[LT_TEST_FLEET_CHIP_CNT];
+
+/** @brief Records the stage of a chip and cuts the transfers of its first RISC-V image. */
+static void lt_test_fleet_status(void *ctx, const lt_fleet_chip_t *chip)
+{
+    LT_UNUSED(ctx);
+    int idx = (int)(chip - chips);
+    lt_dev_fault_t *fault = &faults[idx];
+
+    if (chip->stage == LT_FLEET_FAILED) {
+        printf("  chip %d: FAILED in %s, ret=%s\n", idx, lt_fleet_stage_str(chip->failed_stage),
+               lt_ret_verbose(chip->ret));
+    }
+    else {
+        printf("  chip %d: %s\n", idx, lt_fleet_stage_str(chip->stage));
+    }
+    reported[idx] = chip->stage;
+
+    if ((chip->stage == LT_FLEET_UPDATE_CPU) && (chip->written_cnt == 0) && cut_cnt[idx]) {
+        for (uint8_t i = 0; i < cut_cnt[idx]; i++) {
+            cuts[idx][i].transaction = fault->stats.transactions + (uint32_t)(i + 1) * LT_TEST_FLEET_CUT_SPACING;
+            cuts[idx][i].type = LT_PORT_FAULT_TRANSPORT;
+        }
+        fault->schedule = cuts[idx];
+        fault->schedule_len = cut_cnt[idx];
+        fault->schedule_pos = 0;
+    }
+}
+
+static bool lt_test_fleet_update(void)
+{
+    lt_fleet_t fleet;
+    uint32_t version;
+
+    memset(&fleet, 0, sizeof(fleet));
+    lt_test_fw_image_build(&cpu_image, LT_TEST_FW_IMAGE_TYPE_CPU, LT_TEST_FW_IMAGE_VERSION_NEW,
+                           LT_TEST_FW_IMAGE_FW_LEN);
+    lt_test_fw_image_stream(&cpu_image, &fleet.cpu.stream);
+    fleet.cpu.version = LT_TEST_FW_IMAGE_VERSION_NEW;
+    lt_test_fw_image_build(&spect_image, LT_TEST_FW_IMAGE_TYPE_SPECT, LT_TEST_FW_IMAGE_VERSION_NEW,
+                           LT_TEST_FW_IMAGE_FW_LEN);
+    lt_test_fw_image_stream(&spect_image, &fleet.spect.stream);
+    fleet.spect.version = LT_TEST_FW_IMAGE_VERSION_NEW;
+    fleet.retries = 1;
+    fleet.status = lt_test_fleet_status;
+
+    for (int i = 0; i < LT_TEST_FLEET_CHIP_CNT; i++) {
+        memset(&chips[i], 0, sizeof(chips[i]));
+        chips[i].h = &handles[i];
+    }
+
+    printf("Chip updated before the fleet\n");
+    lt_fleet_chip_t *up_to_date = &chips[LT_TEST_FLEET_CHIP_UP_TO_DATE];
+    LT_TEST_TRUE(lt_fleet_update_chip(&fleet, up_to_date) == LT_OK);
+    LT_TEST_TRUE(up_to_date->stage == LT_FLEET_DONE);
+
+    printf("Fleet\n");
+    LT_TEST_TRUE(lt_unix_fleet_update(&fleet, chips, LT_TEST_FLEET_CHIP_CNT, 0) == LT_FAIL);
+    for (int i = 0; i < LT_TEST_FLEET_CHIP_CNT; i++) {
+        LT_TEST_TRUE(reported[i] == chips[i].stage);
+        LT_TEST_TRUE(faults[i].stats.injected[LT_PORT_FAULT_TRANSPORT] == cut_cnt[i]);
+    }
+
+    // All four banks are written, the verification in lt_fleet_update_chip() checked the running versions
+    for (int i = LT_TEST_FLEET_CHIP_OK; i <= LT_TEST_FLEET_CHIP_RESUMED; i++) {
+        LT_TEST_TRUE(chips[i].stage == LT_FLEET_DONE);
+        LT_TEST_TRUE(chips[i].ret == LT_OK);
+        LT_TEST_TRUE(chips[i].written_cnt == 4);
+        LT_TEST_TRUE(lt_test_fw_image_running_version(&handles[i], true, &version) == LT_OK);
+        LT_TEST_TRUE(version == LT_TEST_FW_IMAGE_VERSION_NEW);
+        LT_TEST_TRUE(lt_test_fw_image_running_version(&handles[i], false, &version) == LT_OK);
+        LT_TEST_TRUE(version == LT_TEST_FW_IMAGE_VERSION_NEW);
+    }
+
+    LT_TEST_TRUE(up_to_date->stage == LT_FLEET_UP_TO_DATE);
+    LT_TEST_TRUE(up_to_date->ret == LT_OK);
+    LT_TEST_TRUE(up_to_date->written_cnt == 0);
+
+    // The chip is left in Maintenance mode, its cut bank is not booted
+    lt_fleet_chip_t *failed = &chips[LT_TEST_FLEET_CHIP_FAILED];
+    LT_TEST_TRUE(failed->stage == LT_FLEET_FAILED);
+    LT_TEST_TRUE(failed->failed_stage == LT_FLEET_UPDATE_CPU);
+    LT_TEST_TRUE(failed->ret == LT_L1_SPI_ERROR);
+    LT_TEST_TRUE(failed->written_cnt == 0);
+    LT_TEST_TRUE(lt_reboot(failed->h, TR01_REBOOT) == LT_OK);
+    LT_TEST_TRUE(lt_test_fw_image_running_version(failed->h, true, &version) == LT_OK);
+    LT_TEST_TRUE(version == LT_TEST_FW_IMAGE_VERSION_OLD);
+
+    return true;
+}
+
+int main(void)
+{
+    // Disable buffering on stdout and stderr (problem in GitHub CI)
+    setvbuf(stdout, NULL, _IONBF, 0);
+    setvbuf(stderr, NULL, _IONBF, 0);
+
+    int initialized = 0;
+    bool ok = true;
+    while (ok && (initialized < LT_TEST_FLEET_CHIP_CNT)) {
+        int i = initialized;
+#if LT_SEPARATE_L3_BUFF
+        handles[i].l3.buff = l3_buffers[i];
+        handles[i].l3.buff_len = sizeof(l3_buffers[i]);
+#endif
+        emulators[i].cfg = &lt_emu_model_cfg;
+        emulators[i].rng_seed = LT_TEST_SEED + i;
+        faults[i].inner = &emulators[i];
+        faults[i].seed = LT_TEST_SEED + i;
+        handles[i].l2.device = &faults[i];
+        ok = (lt_init(&handles[i]) == LT_OK);
+        initialized += ok;
+    }
+
+    ok = ok && lt_test_fleet_update();
+    for (int i = 0; i < initialized; i++) {
+        lt_deinit(&handles[i]);
+    }
+
+    printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file lt_test_fw_image.c
+ * @author Tropic Square s.r.o.
+ * @brief Firmware update images built in memory for tests running against the emulator.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include "lt_test_fw_image.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "libtropic.h"
+
+#ifdef ABAB
+/** @brief Offset of the bank header in the image, it follows the signature. */
+#define LT_TEST_FW_IMAGE_HEADER_OFFSET 0x200
+/** @brief Offset of the firmware in the image. */
+#define LT_TEST_FW_IMAGE_BODY_OFFSET 0x400
+#elif ACAB
+/** @brief Length of the Mutable_FW_Update_Req at the start of the image, without its length byte. */
+#define LT_TEST_FW_IMAGE_REQ_LEN 0x68
+/** @brief Firmware bytes in one Mutable_FW_Update_Data chunk, as in the released images. */
+#define LT_TEST_FW_IMAGE_CHUNK_LEN 216
+/** @brief Length of the hash of the next chunk. */
+#define LT_TEST_FW_IMAGE_HASH_LEN 32
+#else
+#error "Undefined silicon revision. Please define either ABAB or ACAB."
+#endif
+
+static void lt_test_fw_image_put_u32(uint8_t *p, const uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static lt_ret_t lt_test_fw_image_read(void *ctx, const uint32_t offset, uint8_t *buf, const uint16_t len)
+{
+    const lt_test_fw_image_t *image = ctx;
+
+    if (offset + len > image->size) {
+        return LT_PARAM_ERR;
+    }
+    memcpy(buf, image->data + offset, len);
+
+    return LT_OK;
+}
+
+void lt_test_fw_image_build(lt_test_fw_image_t *image, const uint8_t type, const uint32_t version,
+                            const uint16_t fw_len)
+{
+    memset(image, 0, sizeof(*image));
+
+#ifdef ABAB
+    // Signature, header, padding up to the firmware
+    memset(image->data, 0x5a, LT_TEST_FW_IMAGE_HEADER_OFFSET);
+    memset(image->data + LT_TEST_FW_IMAGE_HEADER_OFFSET, 0xff,
+           LT_TEST_FW_IMAGE_BODY_OFFSET - LT_TEST_FW_IMAGE_HEADER_OFFSET);
+    struct lt_header_boot_v1_t *header = (struct lt_header_boot_v1_t *)(image->data + LT_TEST_FW_IMAGE_HEADER_OFFSET);
+    memset(header, 0, sizeof(*header));
+    lt_test_fw_image_put_u32(header->type, type);
+    lt_test_fw_image_put_u32(header->version, version);
+    lt_test_fw_image_put_u32(header->size, fw_len);
+    for (uint16_t i = 0; i < fw_len; i++) {
+        image->data[LT_TEST_FW_IMAGE_BODY_OFFSET + i] = (uint8_t)(i * 7 + type);
+    }
+    image->size = LT_TEST_FW_IMAGE_BODY_OFFSET + fw_len;
+#else
+    // Length byte and Mutable_FW_Update_Req: signature, hash, type, padding, header version and version
+    uint8_t *p = image->data;
+    *p++ = LT_TEST_FW_IMAGE_REQ_LEN;
+    memset(p, 0x5a, 64 + LT_TEST_FW_IMAGE_HASH_LEN);
+    p += 64 + LT_TEST_FW_IMAGE_HASH_LEN;
+    *p++ = type;
+    *p++ = 0;
+    *p++ = 0;
+    *p++ = 1;
+    lt_test_fw_image_put_u32(p, version);
+    p += sizeof(uint32_t);
+
+    // Mutable_FW_Update_Data chunks, each with length byte, hash of the next chunk and offset
+    for (uint16_t offset = 0; offset < fw_len; offset += LT_TEST_FW_IMAGE_CHUNK_LEN) {
+        uint16_t len = (fw_len - offset < LT_TEST_FW_IMAGE_CHUNK_LEN) ? fw_len - offset : LT_TEST_FW_IMAGE_CHUNK_LEN;
+        bool last = (offset + len == fw_len);
+        *p++ = (uint8_t)(LT_TEST_FW_IMAGE_HASH_LEN + sizeof(uint16_t) + len);
+        memset(p, last ? 0 : 0xa5, LT_TEST_FW_IMAGE_HASH_LEN);
+        p += LT_TEST_FW_IMAGE_HASH_LEN;
+        *p++ = (uint8_t)offset;
+        *p++ = (uint8_t)(offset >> 8);
+        for (uint16_t i = 0; i < len; i++) {
+            *p++ = (uint8_t)((offset + i) * 7 + type);
+        }
+    }
+    image->size = (uint32_t)(p - image->data);
+#endif
+}
+
+void lt_test_fw_image_stream(lt_test_fw_image_t *image, lt_fw_update_stream_t *stream)
+{
+    memset(stream, 0, sizeof(*stream));
+    stream->read = lt_test_fw_image_read;
+    stream->ctx = image;
+    stream->image_size = image->size;
+}
+
+lt_ret_t lt_test_fw_image_running_version(lt_handle_t *h, const bool cpu, uint32_t *version)
+{
+    uint8_t ver[TR01_L2_GET_INFO_RISCV_FW_SIZE];
+
+    lt_ret_t ret = cpu ? lt_get_info_riscv_fw_ver(h, ver) : lt_get_info_spect_fw_ver(h, ver);
+    *version = (uint32_t)ver[0] | ((uint32_t)ver[1] << 8) | ((uint32_t)ver[2] << 16) | ((uint32_t)ver[3] << 24);
+
+    return ret;
+}
@@ -0,0 +1,68 @@
+#ifndef LT_TEST_FW_IMAGE_H
+#define LT_TEST_FW_IMAGE_H
+
+/**
+ * @file lt_test_fw_image.h
+ * @author Tropic Square s.r.o.
+ * @brief Firmware update images built in memory for tests running against the emulator.
+ * @details Images have the layout of the files in TROPIC01_fw_update_files for the silicon revision, but their
+ * signatures and hashes are not valid, the emulator does not check them.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "libtropic_common.h"
+
+/** @brief Firmware type of RISC-V images. */
+#define LT_TEST_FW_IMAGE_TYPE_CPU 1
+/** @brief Firmware type of SPECT images. */
+#define LT_TEST_FW_IMAGE_TYPE_SPECT 2
+/** @brief Maximal size of a built image. */
+#define LT_TEST_FW_IMAGE_SIZE_MAX 8192
+/** @brief Version of the firmware the emulated chip leaves production with, 1.0.0. */
+#define LT_TEST_FW_IMAGE_VERSION_OLD 0x01000000
+/** @brief Version of the images the tests write, 1.2.0. */
+#define LT_TEST_FW_IMAGE_VERSION_NEW 0x01020000
+/** @brief Length of the firmware in the images the tests write. */
+#define LT_TEST_FW_IMAGE_FW_LEN 4000
+
+/** @brief Image held in memory, also the context of lt_test_fw_image_read(). */
+typedef struct lt_test_fw_image_t {
+    uint8_t data[LT_TEST_FW_IMAGE_SIZE_MAX];
+    uint32_t size;
+} lt_test_fw_image_t;
+
+/**
+ * @brief Builds an image of firmware with the given version.
+ *
+ * @param image    Built image
+ * @param type     LT_TEST_FW_IMAGE_TYPE_CPU or LT_TEST_FW_IMAGE_TYPE_SPECT
+ * @param version  Version as Get_Info returns it, e.g. 0x01000200 for 1.2.0
+ * @param fw_len   Length of the firmware in the image, the image with its headers must fit into
+ * LT_TEST_FW_IMAGE_SIZE_MAX
+ */
+void lt_test_fw_image_build(lt_test_fw_image_t *image, const uint8_t type, const uint32_t version,
+                            const uint16_t fw_len);
+
+/**
+ * @brief Initializes a stream reading the image.
+ *
+ * @param image   Image
+ * @param stream  Stream, its optional callbacks are not set
+ */
+void lt_test_fw_image_stream(lt_test_fw_image_t *image, lt_fw_update_stream_t *stream);
+
+/**
+ * @brief Reads version of the running firmware, the chip has to run the application.
+ *
+ * @param h        Handle of the chip
+ * @param cpu      true for the RISC-V firmware, false for the SPECT firmware
+ * @param version  Version as Get_Info returns it
+ * @return         Result of the Get_Info request
+ */
+lt_ret_t lt_test_fw_image_running_version(lt_handle_t *h, const bool cpu, uint32_t *version);
+
+#endif  // LT_TEST_FW_IMAGE_H
@@ -0,0 +1,184 @@
+/**
+ * @file lt_test_fw_update_stream.c
+ * @brief Streamed firmware update cut by a transport fault and resumed, against the emulator.
+ * @details The transfer of lt_do_mutable_fw_update_stream() is cut by a fault injected by hal/port/fault/ once a
+ * number of chunks was acknowledged. An image left cut must not be booted, the chip keeps running the firmware of the
+ * other bank. An image resumed from `acked_offset` must end up in the bank header and, after a reboot, as the running
+ * firmware version.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_functional_tests.h"
+#include "libtropic_macros.h"
+#include "libtropic_port_emulator.h"
+#include "libtropic_port_fault.h"
+#include "lt_test_fw_image.h"
+
+extern const lt_emu_cfg_t lt_emu_model_cfg;
+
+/** @brief Number of chunks acknowledged before the transfer is cut. */
+#define LT_TEST_FUS_CUT_CHUNKS 10
+
+static lt_handle_t h;
+static lt_dev_emulator_t emulator;
+static lt_dev_fault_t fault;
+static lt_test_fw_image_t image;
+
+/** @brief Transport fault cutting the transfer, scheduled by lt_test_fus_progress(). */
+static lt_port_fault_event_t cut;
+/** @brief Number of acknowledged chunks the transfer is cut after, 0 to let it finish. */
+static uint32_t cut_chunks;
+
+/** @brief Cuts the transfer in the request following the chunk acknowledged as `cut_chunks`-th. */
+static void lt_test_fus_progress(void *ctx, const lt_fw_update_progress_t *progress)
+{
+    LT_UNUSED(ctx);
+
+    if (cut_chunks && (progress->acked_chunks == cut_chunks)) {
+        cut.transaction = fault.stats.transactions;
+        cut.type = LT_PORT_FAULT_TRANSPORT;
+        fault.schedule = &cut;
+        fault.schedule_len = 1;
+        fault.schedule_pos = 0;
+    }
+}
+
+/** @brief Reads version of firmware in a bank, 0 for an empty bank. */
+static lt_ret_t lt_test_fus_bank_version(const lt_bank_id_t bank_id, uint32_t *version)
+{
+    uint8_t header[TR01_L2_GET_INFO_FW_HEADER_SIZE];
+    uint16_t header_size;
+
+    lt_ret_t ret = lt_get_info_fw_bank(&h, bank_id, header, sizeof(header), &header_size);
+    if (ret != LT_OK) {
+        return ret;
+    }
+    if (header_size == TR01_L2_GET_INFO_FW_HEADER_SIZE_BOOT_V1) {
+        const struct lt_header_boot_v1_t *p_h = (const struct lt_header_boot_v1_t *)header;
+        *version = (uint32_t)p_h->version[0] | ((uint32_t)p_h->version[1] << 8) | ((uint32_t)p_h->version[2] << 16)
+                   | ((uint32_t)p_h->version[3] << 24);
+    }
+    else if (header_size == TR01_L2_GET_INFO_FW_HEADER_SIZE_BOOT_V2) {
+        struct lt_header_boot_v2_t p_h;
+        memcpy(&p_h, header, sizeof(p_h));
+        *version = p_h.ver;
+    }
+    else {
+        *version = 0;
+    }
+
+    return LT_OK;
+}
+
+/** @brief Starts the transfer of the image and cuts it after LT_TEST_FUS_CUT_CHUNKS acknowledged chunks. */
+static bool lt_test_fus_cut(const lt_fw_update_stream_t *stream, const lt_bank_id_t bank_id,
+                            lt_fw_update_progress_t *progress)
+{
+    cut_chunks = LT_TEST_FUS_CUT_CHUNKS;
+    memset(progress, 0, sizeof(*progress));
+    LT_TEST_TRUE(lt_do_mutable_fw_update_stream(&h, stream, bank_id, progress) == LT_L1_SPI_ERROR);
+    cut_chunks = 0;
+    fault.schedule = NULL;
+
+    LT_TEST_TRUE(fault.stats.injected[LT_PORT_FAULT_TRANSPORT] == 1);
+    LT_TEST_TRUE(progress->acked_chunks == LT_TEST_FUS_CUT_CHUNKS);
+    LT_TEST_TRUE((progress->acked_offset > 0) && (progress->acked_offset < stream->image_size));
+    fault.stats.injected[LT_PORT_FAULT_TRANSPORT] = 0;
+
+    return true;
+}
+
+/** @brief Image left cut is not booted, the chip runs the firmware of the other bank. */
+static bool lt_test_fus_cut_not_booted(void)
+{
+    lt_fw_update_stream_t stream;
+    lt_fw_update_progress_t progress;
+    uint32_t version;
+
+    printf("Cut image is not booted\n");
+    lt_test_fw_image_build(&image, LT_TEST_FW_IMAGE_TYPE_SPECT, LT_TEST_FW_IMAGE_VERSION_NEW, LT_TEST_FW_IMAGE_FW_LEN);
+    lt_test_fw_image_stream(&image, &stream);
+    stream.progress = lt_test_fus_progress;
+
+    LT_TEST_TRUE(lt_reboot(&h, TR01_MAINTENANCE_REBOOT) == LT_OK);
+    LT_TEST_TRUE(lt_test_fus_cut(&stream, TR01_FW_BANK_SPECT1, &progress));
+    LT_TEST_TRUE(lt_test_fus_bank_version(TR01_FW_BANK_SPECT2, &version) == LT_OK);
+    LT_TEST_TRUE(version == LT_TEST_FW_IMAGE_VERSION_OLD);
+
+    LT_TEST_TRUE(lt_reboot(&h, TR01_REBOOT) == LT_OK);
+    LT_TEST_TRUE(lt_test_fw_image_running_version(&h, false, &version) == LT_OK);
+    LT_TEST_TRUE(version == LT_TEST_FW_IMAGE_VERSION_OLD);
+
+    return true;
+}
+
+/** @brief Image resumed from the last acknowledged chunk is written whole and booted. */
+static bool lt_test_fus_resume(void)
+{
+    lt_fw_update_stream_t stream;
+    lt_fw_update_progress_t progress;
+    uint32_t version;
+
+    printf("Cut image resumed from the last acknowledged chunk\n");
+    lt_test_fw_image_build(&image, LT_TEST_FW_IMAGE_TYPE_CPU, LT_TEST_FW_IMAGE_VERSION_NEW, LT_TEST_FW_IMAGE_FW_LEN);
+    lt_test_fw_image_stream(&image, &stream);
+    stream.progress = lt_test_fus_progress;
+
+    LT_TEST_TRUE(lt_reboot(&h, TR01_MAINTENANCE_REBOOT) == LT_OK);
+    LT_TEST_TRUE(lt_test_fus_cut(&stream, TR01_FW_BANK_FW1, &progress));
+
+    uint32_t acked_chunks = progress.acked_chunks;
+    LT_TEST_TRUE(lt_do_mutable_fw_update_stream(&h, &stream, TR01_FW_BANK_FW1, &progress) == LT_OK);
+    LT_TEST_TRUE(progress.acked_offset == stream.image_size);
+    LT_TEST_TRUE(progress.acked_chunks > acked_chunks);
+
+    // On ACAB the chip picks the bank itself: FW1 when both banks hold the same version
+    LT_TEST_TRUE(lt_test_fus_bank_version(TR01_FW_BANK_FW1, &version) == LT_OK);
+    LT_TEST_TRUE(version == LT_TEST_FW_IMAGE_VERSION_NEW);
+    LT_TEST_TRUE(lt_test_fus_bank_version(TR01_FW_BANK_FW2, &version) == LT_OK);
+    LT_TEST_TRUE(version == LT_TEST_FW_IMAGE_VERSION_OLD);
+
+    LT_TEST_TRUE(lt_reboot(&h, TR01_REBOOT) == LT_OK);
+    LT_TEST_TRUE(lt_test_fw_image_running_version(&h, true, &version) == LT_OK);
+    LT_TEST_TRUE(version == LT_TEST_FW_IMAGE_VERSION_NEW);
+
+    return true;
+}
+
+int main(void)
+{
+    // Disable buffering on stdout and stderr (problem in GitHub CI)
+    setvbuf(stdout, NULL, _IONBF, 0);
+    setvbuf(stderr, NULL, _IONBF, 0);
+
+#if LT_SEPARATE_L3_BUFF
+    static uint8_t l3_buffer[LT_SIZE_OF_L3_BUFF] __attribute__((aligned(16)));
+    h.l3.buff = l3_buffer;
+    h.l3.buff_len = sizeof(l3_buffer);
+#endif
+    emulator.cfg = &lt_emu_model_cfg;
+    emulator.rng_seed = LT_TEST_SEED;
+    fault.inner = &emulator;
+    fault.seed = LT_TEST_SEED;
+    h.l2.device = &fault;
+
+    if (lt_init(&h) != LT_OK) {
+        printf("FAILED\n");
+        return EXIT_FAILURE;
+    }
+    bool ok = lt_test_fus_cut_not_booted() && lt_test_fus_resume();
+    lt_deinit(&h);
+
+    printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
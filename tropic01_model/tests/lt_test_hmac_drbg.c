@@ -0,0 +1,173 @@
+/**
+ * @file lt_test_hmac_drbg.c
+ * @brief Known-answer tests of the HMAC_DRBG (SHA256) in src/lt_hmac_drbg.c.
+ * @details Each vector is run the way the NIST CAVP tests run: instantiate, optionally reseed, generate and discard
+ * 128 bytes, generate 128 bytes and compare them. The vectors without additional input and personalization string are
+ * taken from the CAVP HMAC_DRBG response files (SHA-256, PredictionResistance = False). The vectors with additional
+ * input and personalization string were generated by OpenSSL's HMAC-DRBG (SHA256) and cross-checked with an
+ * independent implementation of NIST SP 800-90A, section 10.1.2.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "lt_hmac_drbg.h"
+#include "lt_hmac_sha256.h"
+
+/** @brief Number of bytes generated by each generate call of a vector. */
+#define LT_TEST_DRBG_OUT_LEN 128
+
+/** @brief One known-answer vector, hex strings, NULL for an absent input. */
+typedef struct lt_test_drbg_vector_t {
+    const char *name;
+    const char *entropy;
+    const char *nonce;
+    const char *pers;
+    const char *entropy_reseed;
+    const char *addin_reseed;
+    const char *addin1;
+    const char *addin2;
+    const char *out;
+} lt_test_drbg_vector_t;
+
+static const lt_test_drbg_vector_t vectors[] = {
+    {
+        .name = "CAVP, reseed",
+        .entropy = "06032cd5eed33f39265f49ecb142c511da9aff2af71203bffaf34a9ca5bd9c0d",
+        .nonce = "0e66f71edc43e42a45ad3c6fc6cdc4df",
+        .entropy_reseed = "01920a4e669ed3a85ae8a33b35a74ad7fb2a6bb4cf395ce00334a9c9a5a5d552",
+        .out = "76fc79fe9b50beccc991a11b5635783a83536add03c157fb30645e611c2898bb2b1bc215000209208cd506cb28da2a51"
+               "bdb03826aaf2bd2335d576d519160842e7158ad0949d1a9ec3e66ea1b1a064b005de914eac2e9d4f2d72a8616a802254"
+               "22918250ff66a41bd2f864a6a38cc5b6499dc43f7f2bd09e1e0f8f5885935124",
+    },
+    {
+        .name = "CAVP, no reseed",
+        .entropy = "ca851911349384bffe89de1cbdc46e6831e44d34a4fb935ee285dd14b71a7488",
+        .nonce = "659ba96c601dc69fc902940805ec0ca8",
+        .out = "e528e9abf2dece54d47c7e75e5fe302149f817ea9fb4bee6f4199697d04d5b89d54fbb978a15b5c443c9ec21036d2460"
+               "b6f73ebad0dc2aba6e624abf07745bc107694bb7547bb0995f70de25d6b29e2d3011bb19d27676c07162c8b5ccde0668"
+               "961df86803482cb37ed6d5c0bb8d50cf1f50d476aa0458bdaba806f48be9dcb8",
+    },
+    {
+        .name = "personalization string and additional input, no reseed",
+        .entropy = "ffae2aba8a0c7b163a12bccbd190907c4f8f2d8ecd1b5c25fcbfc9086d3e3cd9",
+        .nonce = "bbc461832623d52dad922c3c05ecf6da",
+        .pers = "55943e9bc86e076d438aa88150fdfcedc3a80c8146176c34f65d58a5892afdce",
+        .addin1 = "dd7bd4d263b4bea7afc62c0ee3ddd084dbf78f60d3f780490360bee3fb19ce94",
+        .addin2 = "01894cdbb7fe4ec3bb0f2d015ae63fb7df0c01c7375c992e5a84376696fa5828",
+        .out = "22327c32e7cf87d5b5f2aec2fa6ceb8fc4987c7fbede8e7fcc2b3b2be8acd5d87690f0a3f5dc368d576377822a1cef53"
+               "a28759d2259dafc197acac3657849278840e3baed3afb0a5438e5c4f9d3dd4402cd76f82f8913e22ce89d260ae1db0e6"
+               "d7240901b5bdb0c579fdb165430c4cd364aee410328a5e87c58fe24cd78959ba",
+    },
+    {
+        .name = "personalization string and additional input, reseed",
+        .entropy = "d28b4017b32ae011eda81b94ee4edcbf5b4f1746a1ef677c0646244b1e98d395",
+        .nonce = "e682026c86b7876a859d91a419bb6a8d",
+        .pers = "10402c9e0ae67722bfd844322c3ef29640c1fa36591883dc3d7f2432638d4f86",
+        .entropy_reseed = "72503d2e39da893755f6999e6f54539e28bb1d96940e1231826cabf12a6bd399",
+        .addin_reseed = "6d8823710efbd3d8d63624c066fec1d9eb673a9e43741cf85b23516900ccbbe8",
+        .addin1 = "f7c761ad8fae7436855a65c1a8b4c88fc86f615993588ac919f83aacb7de94e5",
+        .addin2 = "41449e7688d942529bbca81cb46606c43dd30af1b10d74fd3aefb33c35c5cf4c",
+        .out = "4a543cbc48e749acf803bfa5678909e77953032bb1e3f55ba27aa5b0653cbf5d5cf52b108554e14b8c2482cae685d768"
+               "8a5f7f44fcc73893c464e60350c6b2c7eecc19c0ea760989293427df4aa7b690cba7c7f3279e45e56097c650ea521931"
+               "cde82cb56205e492e6873cc1912179563b7c4b781c920c9bef944882399ba121",
+    },
+    {
+        .name = "additional input, reseed",
+        .entropy = "1db596fa8b6878babc8aeff208f8929371b3909a8b14205344cab3e0c3382758",
+        .nonce = "308dc51b4ac2d50a2843990be3514d63",
+        .entropy_reseed = "fb73046284578e058d6c625063ac9df7ed8d3a01fbc2d3c8ccbec78d9eb95aaf",
+        .addin_reseed = "cb099d563305892e400e7b54afc4ac0f95abced8242d66b805f55d9238a98826",
+        .addin1 = "3fed0190ce4dc43c93423ba6546e62362fa51966f0ba14adc9502925af591917",
+        .addin2 = "18c3b59ef55f860c05e4860c784f88c98c5e24aa543725f12a04ee13193077ac",
+        .out = "1fa632748dfbe73e1c352d1cab7e5b01d599ee9972368bb3954fa0b16c7a5e95260cf2903a9d129f912186b6e1be5369"
+               "07f1711f9277a49416d521bcf798485e7cb90bd092b940a0562d2deb94102b346281335ef7db341f26aaed4bc6cd7a96"
+               "d2d02d27e3c13d532c8a2e9f9b824e10fc4b23437f6d71fd89fc7d39759ad67c",
+    },
+};
+
+/** @brief Largest input of the vectors in bytes. */
+#define LT_TEST_DRBG_IN_LEN_MAX 64
+
+/** @brief Decodes a hex string, returns its length in bytes, 0 for NULL. */
+static size_t lt_test_drbg_unhex(const char *hex, uint8_t *out, const size_t out_len)
+{
+    size_t len = 0;
+
+    if (!hex) {
+        return 0;
+    }
+    for (; hex[2 * len] && hex[2 * len + 1] && (len < out_len); len++) {
+        unsigned int byte;
+        sscanf(&hex[2 * len], "%2x", &byte);
+        out[len] = (uint8_t)byte;
+    }
+
+    return len;
+}
+
+static bool lt_test_drbg_run(const lt_test_drbg_vector_t *vec)
+{
+    uint8_t key[LT_HMAC_SHA256_HASH_LEN], v[LT_HMAC_SHA256_HASH_LEN];
+    uint8_t entropy[LT_TEST_DRBG_IN_LEN_MAX], nonce[LT_TEST_DRBG_IN_LEN_MAX], pers[LT_TEST_DRBG_IN_LEN_MAX];
+    uint8_t addin1[LT_TEST_DRBG_IN_LEN_MAX], addin2[LT_TEST_DRBG_IN_LEN_MAX];
+    uint8_t out[LT_TEST_DRBG_OUT_LEN], expected[LT_TEST_DRBG_OUT_LEN];
+
+    size_t entropy_len = lt_test_drbg_unhex(vec->entropy, entropy, sizeof(entropy));
+    size_t nonce_len = lt_test_drbg_unhex(vec->nonce, nonce, sizeof(nonce));
+    size_t pers_len = lt_test_drbg_unhex(vec->pers, pers, sizeof(pers));
+    size_t addin1_len = lt_test_drbg_unhex(vec->addin1, addin1, sizeof(addin1));
+    size_t addin2_len = lt_test_drbg_unhex(vec->addin2, addin2, sizeof(addin2));
+    lt_test_drbg_unhex(vec->out, expected, sizeof(expected));
+
+    lt_hmac_drbg_instantiate(key, v, entropy, entropy_len, nonce, nonce_len, vec->pers ? pers : NULL, pers_len);
+    if (vec->entropy_reseed) {
+        uint8_t addin_reseed[LT_TEST_DRBG_IN_LEN_MAX];
+        size_t addin_reseed_len = lt_test_drbg_unhex(vec->addin_reseed, addin_reseed, sizeof(addin_reseed));
+
+        entropy_len = lt_test_drbg_unhex(vec->entropy_reseed, entropy, sizeof(entropy));
+        lt_hmac_drbg_reseed(key, v, entropy, entropy_len, vec->addin_reseed ? addin_reseed : NULL, addin_reseed_len);
+    }
+    lt_hmac_drbg_generate(key, v, vec->addin1 ? addin1 : NULL, addin1_len, out, sizeof(out));
+    lt_hmac_drbg_generate(key, v, vec->addin2 ? addin2 : NULL, addin2_len, out, sizeof(out));
+
+    return memcmp(out, expected, sizeof(out)) == 0;
+}
+
+/** @brief Output shorter than a block must be the beginning of that block. */
+static bool lt_test_drbg_short(void)
+{
+    uint8_t key_a[LT_HMAC_SHA256_HASH_LEN], v_a[LT_HMAC_SHA256_HASH_LEN];
+    uint8_t key_b[LT_HMAC_SHA256_HASH_LEN], v_b[LT_HMAC_SHA256_HASH_LEN];
+    uint8_t entropy[LT_HMAC_SHA256_HASH_LEN] = {0};
+    uint8_t out_a[LT_HMAC_SHA256_HASH_LEN], out_b[LT_HMAC_SHA256_HASH_LEN];
+
+    lt_hmac_drbg_instantiate(key_a, v_a, entropy, sizeof(entropy), NULL, 0, NULL, 0);
+    lt_hmac_drbg_instantiate(key_b, v_b, entropy, sizeof(entropy), NULL, 0, NULL, 0);
+    lt_hmac_drbg_generate(key_a, v_a, NULL, 0, out_a, 5);
+    lt_hmac_drbg_generate(key_b, v_b, NULL, 0, out_b, sizeof(out_b));
+
+    return memcmp(out_a, out_b, 5) == 0;
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+        bool ok = lt_test_drbg_run(&vectors[i]);
+        printf("%s %s\n", ok ? "PASS" : "FAIL", vectors[i].name);
+        failed += !ok;
+    }
+
+    bool ok = lt_test_drbg_short();
+    printf("%s output shorter than a block\n", ok ? "PASS" : "FAIL");
+    failed += !ok;
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,268 @@
+/**
+ * @file lt_test_port_fault.c
+ * @brief Recovery of L1 and L2 from bus faults injected by hal/port/fault/ into the emulator.
+ * @details Scripted faults check each recovery path on its own: lt_l2_receive() resending a corrupted or truncated
+ * response up to three times, lt_l1_read() polling through busy and "no response" CHIP_STATUS, alarm detection and
+ * transport errors being reported. Random faults then check that chunked L3 results survive the faults L1 recovers
+ * from, and that corrupted frames never give a caller wrong data with LT_OK.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_functional_tests.h"
+#include "libtropic_port_emulator.h"
+#include "libtropic_port_fault.h"
+
+extern const lt_emu_cfg_t lt_emu_model_cfg;
+
+/** @brief Number of Get_Info requests under random bit flips. */
+#define LT_TEST_PF_GET_INFO_CNT 300
+/** @brief Number of pings under random bit flips. */
+#define LT_TEST_PF_PING_CNT 100
+/** @brief Busy streak long enough to exhaust all reads of lt_l1_read(). */
+#define LT_TEST_PF_BUSY_EXHAUST 64
+/** @brief Number of slots erased by the pipeline cut by a transport fault. */
+#define LT_TEST_PF_PIPELINE_SLOT_CNT 4
+/** @brief Number of transactions of the pipeline a transport fault is tried at. */
+#define LT_TEST_PF_PIPELINE_CUT_CNT 16
+
+static lt_handle_t h;
+static lt_dev_emulator_t emulator;
+static lt_dev_fault_t fault;
+static struct lt_chip_id_t chip_id_ref;
+
+/** @brief Chip ID was returned with LT_OK but differs from the one read without faults. */
+static bool wrong_data;
+
+/** @brief Reads the chip ID with the given faults scheduled relative to the transaction the request is written in. */
+static lt_ret_t lt_test_pf_get_info(lt_port_fault_event_t *events, const size_t events_len)
+{
+    struct lt_chip_id_t chip_id;
+
+    for (size_t i = 0; i < events_len; i++) {
+        events[i].transaction += fault.stats.transactions;
+    }
+    fault.schedule = events;
+    fault.schedule_len = events_len;
+    fault.schedule_pos = 0;
+
+    lt_ret_t ret = lt_get_info_chip_id(&h, &chip_id);
+    fault.schedule = NULL;
+    if ((ret == LT_OK) && memcmp(&chip_id, &chip_id_ref, sizeof(chip_id))) {
+        printf("Chip ID read with LT_OK differs\n");
+        wrong_data = true;
+    }
+
+    return ret;
+}
+
+/** @brief Each recovery path hit by one scripted fault: the request is transaction 0, its response transaction 1. */
+static bool lt_test_pf_scripted(void)
+{
+    printf("Scripted faults\n");
+    uint32_t transactions = fault.stats.transactions;
+    LT_TEST_TRUE(lt_get_info_chip_id(&h, &chip_id_ref) == LT_OK);
+    LT_TEST_TRUE(fault.stats.transactions - transactions == 2);
+
+    lt_port_fault_event_t flip[] = {{1, LT_PORT_FAULT_BIT_FLIP, 10}};
+    LT_TEST_TRUE(lt_test_pf_get_info(flip, 1) == LT_OK);
+    LT_TEST_TRUE(fault.stats.injected[LT_PORT_FAULT_BIT_FLIP] == 1);
+
+    lt_port_fault_event_t truncate[] = {{1, LT_PORT_FAULT_TRUNCATE, 20}};
+    LT_TEST_TRUE(lt_test_pf_get_info(truncate, 1) == LT_OK);
+    LT_TEST_TRUE(fault.stats.injected[LT_PORT_FAULT_TRUNCATE] == 1);
+
+    // Resends are transactions 2 - 3, 4 - 5 and 6 - 7
+    lt_port_fault_event_t flip_3[] = {
+        {1, LT_PORT_FAULT_BIT_FLIP, 10}, {3, LT_PORT_FAULT_BIT_FLIP, 5}, {5, LT_PORT_FAULT_BIT_FLIP, 40}};
+    LT_TEST_TRUE(lt_test_pf_get_info(flip_3, 3) == LT_OK);
+    lt_port_fault_event_t flip_4[] = {{1, LT_PORT_FAULT_BIT_FLIP, 10},
+                                      {3, LT_PORT_FAULT_BIT_FLIP, 5},
+                                      {5, LT_PORT_FAULT_BIT_FLIP, 40},
+                                      {7, LT_PORT_FAULT_BIT_FLIP, 100}};
+    LT_TEST_TRUE(lt_test_pf_get_info(flip_4, 4) == LT_L2_IN_CRC_ERR);
+
+    uint64_t delay_ms = fault.stats.delay_ms;
+    lt_port_fault_event_t no_response[] = {{1, LT_PORT_FAULT_NO_RESPONSE, 0}, {2, LT_PORT_FAULT_NO_RESPONSE, 0}};
+    LT_TEST_TRUE(lt_test_pf_get_info(no_response, 2) == LT_OK);
+    LT_TEST_TRUE(fault.stats.delay_ms > delay_ms);
+
+    lt_port_fault_event_t busy[] = {{1, LT_PORT_FAULT_BUSY, 5}};
+    LT_TEST_TRUE(lt_test_pf_get_info(busy, 1) == LT_OK);
+    lt_port_fault_event_t busy_exhaust[] = {{1, LT_PORT_FAULT_BUSY, LT_TEST_PF_BUSY_EXHAUST}};
+    LT_TEST_TRUE(lt_test_pf_get_info(busy_exhaust, 1) == LT_L1_CHIP_BUSY);
+    // Rest of the streak is polled through
+    LT_TEST_TRUE(lt_test_pf_get_info(NULL, 0) == LT_OK);
+
+    lt_port_fault_event_t alarm[] = {{1, LT_PORT_FAULT_ALARM, 0}};
+    LT_TEST_TRUE(lt_test_pf_get_info(alarm, 1) == LT_L1_CHIP_ALARM_MODE);
+
+    lt_port_fault_event_t transport[] = {{0, LT_PORT_FAULT_TRANSPORT, 0}};
+    LT_TEST_TRUE(lt_test_pf_get_info(transport, 1) == LT_L1_SPI_ERROR);
+    lt_port_fault_event_t transport_rsp[] = {{1, LT_PORT_FAULT_TRANSPORT, 0}};
+    LT_TEST_TRUE(lt_test_pf_get_info(transport_rsp, 1) == LT_L1_SPI_ERROR);
+
+    // With a virtual clock, polling advances the clock and still reaches the ports, which return at once
+    delay_ms = fault.stats.delay_ms;
+    uint64_t elapsed_ms = h.l2.clock.elapsed_ms;
+    h.l2.clock.is_virtual = true;
+    lt_port_fault_event_t no_response_virtual[] = {{1, LT_PORT_FAULT_NO_RESPONSE, 0}};
+    LT_TEST_TRUE(lt_test_pf_get_info(no_response_virtual, 1) == LT_OK);
+    h.l2.clock.is_virtual = false;
+    LT_TEST_TRUE(fault.stats.delay_ms - delay_ms == h.l2.clock.elapsed_ms - elapsed_ms);
+    LT_TEST_TRUE(h.l2.clock.elapsed_ms > elapsed_ms);
+
+    // The chip and the host are still in sync
+    LT_TEST_TRUE(lt_test_pf_get_info(NULL, 0) == LT_OK);
+
+    return true;
+}
+
+/** @brief Chunked L3 results under faults lt_l1_read() recovers from, the Secure Session must survive all of them. */
+static bool lt_test_pf_chunks(void)
+{
+    uint8_t msg[TR01_PING_LEN_MAX], msg_in[sizeof(msg)];
+
+    printf("Chunked results under busy and no-response faults\n");
+    for (uint16_t i = 0; i < sizeof(msg); i++) {
+        msg[i] = (uint8_t)(i * 13);
+    }
+    LT_TEST_TRUE(lt_verify_chip_and_start_secure_session(&h, sh0priv, sh0pub, TR01_PAIRING_KEY_SLOT_INDEX_0) == LT_OK);
+
+    memset(&fault.stats, 0, sizeof(fault.stats));
+    fault.rate[LT_PORT_FAULT_NO_RESPONSE] = 300000;
+    fault.rate[LT_PORT_FAULT_BUSY] = 200000;
+    fault.busy_streak_len = 3;
+    for (int i = 0; i < 8; i++) {
+        memset(msg_in, 0, sizeof(msg_in));
+        LT_TEST_TRUE(lt_ping(&h, msg, msg_in, sizeof(msg)) == LT_OK);
+        LT_TEST_TRUE(memcmp(msg, msg_in, sizeof(msg)) == 0);
+    }
+    fault.rate[LT_PORT_FAULT_NO_RESPONSE] = 0;
+    fault.rate[LT_PORT_FAULT_BUSY] = 0;
+    LT_TEST_TRUE(fault.stats.injected[LT_PORT_FAULT_NO_RESPONSE] > 0);
+    LT_TEST_TRUE(fault.stats.injected[LT_PORT_FAULT_BUSY] > 0);
+
+    lt_session_abort(&h);
+
+    return true;
+}
+
+/** @brief Pipelined commands cut by a transport fault, the command the fault hit must report it. */
+static bool lt_test_pf_pipeline(void)
+{
+    lt_ret_t results[LT_TEST_PF_PIPELINE_SLOT_CNT];
+    int hit = 0;
+
+    printf("Pipelined commands cut by transport faults\n");
+    for (uint32_t cut = 0; cut < LT_TEST_PF_PIPELINE_CUT_CNT; cut++) {
+        LT_TEST_TRUE(lt_verify_chip_and_start_secure_session(&h, sh0priv, sh0pub, TR01_PAIRING_KEY_SLOT_INDEX_0)
+                     == LT_OK);
+        lt_port_fault_event_t transport = {.transaction = fault.stats.transactions + cut,
+                                           .type = LT_PORT_FAULT_TRANSPORT};
+        fault.schedule = &transport;
+        fault.schedule_len = 1;
+        fault.schedule_pos = 0;
+
+        lt_ret_t ret = lt_r_mem_data_erase_range(&h, 0, LT_TEST_PF_PIPELINE_SLOT_CNT, results);
+        fault.schedule = NULL;
+        lt_session_abort(&h);
+        if (ret == LT_OK) {
+            continue;
+        }
+
+        bool reported = false;
+        for (int i = 0; i < LT_TEST_PF_PIPELINE_SLOT_CNT; i++) {
+            reported |= (results[i] == ret);
+        }
+        LT_TEST_TRUE(reported);
+        hit++;
+    }
+    LT_TEST_TRUE(hit > 0);
+
+    return true;
+}
+
+/** @brief Random bit flips may fail requests, but must never give wrong data with LT_OK. */
+static bool lt_test_pf_random_flips(void)
+{
+    uint8_t msg[256], msg_in[sizeof(msg)];
+    int ok = 0;
+
+    printf("Random bit flips\n");
+    memset(&fault.stats, 0, sizeof(fault.stats));
+    fault.rate[LT_PORT_FAULT_BIT_FLIP] = 2000;
+    for (int i = 0; i < LT_TEST_PF_GET_INFO_CNT; i++) {
+        ok += (lt_test_pf_get_info(NULL, 0) == LT_OK);
+        LT_TEST_TRUE(!wrong_data);
+    }
+    printf("  Get_Info: %d of %d OK, %u bits flipped\n", ok, LT_TEST_PF_GET_INFO_CNT,
+           (unsigned)fault.stats.injected[LT_PORT_FAULT_BIT_FLIP]);
+    LT_TEST_TRUE(ok > 0);
+
+    // A failed L3 result leaves the IVs out of sync, the session is started again
+    ok = 0;
+    bool session = false;
+    fault.rate[LT_PORT_FAULT_BIT_FLIP] = 200;
+    for (int i = 0; i < LT_TEST_PF_PING_CNT; i++) {
+        if (!session) {
+            session = lt_verify_chip_and_start_secure_session(&h, sh0priv, sh0pub, TR01_PAIRING_KEY_SLOT_INDEX_0)
+                      == LT_OK;
+            continue;
+        }
+        memset(msg, i, sizeof(msg));
+        memset(msg_in, 0, sizeof(msg_in));
+        lt_ret_t ret = lt_ping(&h, msg, msg_in, sizeof(msg));
+        if (ret == LT_OK) {
+            LT_TEST_TRUE(memcmp(msg, msg_in, sizeof(msg)) == 0);
+            ok++;
+        }
+        else {
+            session = false;
+        }
+    }
+    fault.rate[LT_PORT_FAULT_BIT_FLIP] = 0;
+    printf("  Ping: %d OK\n", ok);
+    LT_TEST_TRUE(ok > 0);
+    lt_session_abort(&h);
+
+    return true;
+}
+
+int main(void)
+{
+    // Disable buffering on stdout and stderr (problem in GitHub CI)
+    setvbuf(stdout, NULL, _IONBF, 0);
+    setvbuf(stderr, NULL, _IONBF, 0);
+
+#if LT_SEPARATE_L3_BUFF
+    static uint8_t l3_buffer[LT_SIZE_OF_L3_BUFF] __attribute__((aligned(16)));
+    h.l3.buff = l3_buffer;
+    h.l3.buff_len = sizeof(l3_buffer);
+#endif
+    emulator.cfg = &lt_emu_model_cfg;
+    emulator.rng_seed = LT_TEST_SEED;
+    fault.inner = &emulator;
+    fault.seed = LT_TEST_SEED;
+    h.l2.device = &fault;
+
+    if (lt_init(&h) != LT_OK) {
+        printf("FAILED\n");
+        return EXIT_FAILURE;
+    }
+    bool ok = lt_test_pf_scripted() && lt_test_pf_chunks() && lt_test_pf_pipeline()
+              && lt_test_pf_random_flips();
+    lt_deinit(&h);
+
+    printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
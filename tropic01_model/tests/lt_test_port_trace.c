@@ -0,0 +1,175 @@
+/**
+ * @file lt_test_port_trace.c
+ * @brief Recording a workload on the emulator with hal/port/trace/ and replaying it without the emulator.
+ * @details Built twice. With LT_TEST_TRACE_RECORD, the workload runs on the emulator wrapped by the recording port,
+ * which writes the trace to the file given as the argument, and the results of the workload are written next to it
+ * (".out" appended). Without it, the workload runs on the replaying port, which must give the same results and use up
+ * the whole trace. The workload is then replayed once more with a different ping message, which must be detected.
+ * Both run with a virtual clock, whose waits must still be recorded and replayed.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_functional_tests.h"
+#include "libtropic_port_trace.h"
+#ifdef LT_TEST_TRACE_RECORD
+#include "libtropic_port_emulator.h"
+
+extern const lt_emu_cfg_t lt_emu_model_cfg;
+#endif
+
+/** @brief Length of the pinged message, several L2 chunks of the result. */
+#define LT_TEST_PT_PING_LEN 600
+/** @brief User data slot written and read by the workload. */
+#define LT_TEST_PT_R_MEM_SLOT 7
+
+/** @brief Results of the workload, compared between the recording and the replay. */
+typedef struct lt_test_pt_out_t {
+    struct lt_chip_id_t chip_id;
+    uint8_t ping[LT_TEST_PT_PING_LEN];
+    uint8_t random[32];
+    uint8_t ecdsa_rs[64];
+    uint8_t eddsa_rs[64];
+    uint8_t r_mem[64];
+    uint16_t r_mem_len;
+} lt_test_pt_out_t;
+
+static lt_handle_t h;
+static lt_test_pt_out_t out;
+
+/** @brief Runs the workload, with altered set the pinged message differs from the recorded one. */
+static bool lt_test_pt_workload(const bool altered)
+{
+    static uint8_t msg[LT_TEST_PT_PING_LEN];
+    const uint8_t hash[32] = {1, 2, 3, 4};
+    const uint8_t r_mem[sizeof(out.r_mem)] = {0xde, 0xad, 0xbe, 0xef};
+
+    for (uint16_t i = 0; i < sizeof(msg); i++) {
+        msg[i] = (uint8_t)(i * 7);
+    }
+    msg[0] ^= altered;
+    memset(&out, 0, sizeof(out));
+    h.l2.clock.is_virtual = true;
+    h.l2.clock.elapsed_ms = 0;
+
+    LT_TEST_TRUE(lt_init(&h) == LT_OK);
+    LT_TEST_TRUE(lt_get_info_chip_id(&h, &out.chip_id) == LT_OK);
+    // Polls for the chip after the reboot, so the trace has delays
+    LT_TEST_TRUE(lt_reboot(&h, TR01_REBOOT) == LT_OK);
+    LT_TEST_TRUE(h.l2.clock.elapsed_ms > 0);
+    LT_TEST_TRUE(lt_verify_chip_and_start_secure_session(&h, sh0priv, sh0pub, TR01_PAIRING_KEY_SLOT_INDEX_0) == LT_OK);
+    LT_TEST_TRUE(lt_ping(&h, msg, out.ping, sizeof(msg)) == LT_OK);
+    LT_TEST_TRUE(memcmp(msg, out.ping, sizeof(msg)) == 0);
+    LT_TEST_TRUE(lt_random_value_get(&h, out.random, sizeof(out.random)) == LT_OK);
+
+    LT_TEST_TRUE(lt_ecc_key_generate(&h, TR01_ECC_SLOT_0, TR01_CURVE_P256) == LT_OK);
+    LT_TEST_TRUE(lt_ecc_ecdsa_sign(&h, TR01_ECC_SLOT_0, hash, sizeof(hash), out.ecdsa_rs) == LT_OK);
+    LT_TEST_TRUE(lt_ecc_key_erase(&h, TR01_ECC_SLOT_0) == LT_OK);
+    LT_TEST_TRUE(lt_ecc_key_generate(&h, TR01_ECC_SLOT_1, TR01_CURVE_ED25519) == LT_OK);
+    LT_TEST_TRUE(lt_ecc_eddsa_sign(&h, TR01_ECC_SLOT_1, hash, sizeof(hash), out.eddsa_rs) == LT_OK);
+    LT_TEST_TRUE(lt_ecc_key_erase(&h, TR01_ECC_SLOT_1) == LT_OK);
+
+    LT_TEST_TRUE(lt_r_mem_data_write(&h, LT_TEST_PT_R_MEM_SLOT, r_mem, sizeof(r_mem)) == LT_OK);
+    LT_TEST_TRUE(lt_r_mem_data_read(&h, LT_TEST_PT_R_MEM_SLOT, out.r_mem, sizeof(out.r_mem), &out.r_mem_len) == LT_OK);
+    LT_TEST_TRUE(lt_r_mem_data_erase(&h, LT_TEST_PT_R_MEM_SLOT) == LT_OK);
+
+    LT_TEST_TRUE(lt_session_abort(&h) == LT_OK);
+    LT_TEST_TRUE(lt_deinit(&h) == LT_OK);
+
+    return true;
+}
+
+#ifdef LT_TEST_TRACE_RECORD
+static bool lt_test_pt_run(FILE *trace, FILE *out_file)
+{
+    static lt_dev_emulator_t emulator;
+    static lt_dev_trace_record_t record;
+
+    emulator.cfg = &lt_emu_model_cfg;
+    emulator.rng_seed = LT_TEST_SEED;
+    record.inner = &emulator;
+    record.file = trace;
+    h.l2.device = &record;
+
+    printf("Recording the workload\n");
+    LT_TEST_TRUE(lt_test_pt_workload(false));
+    LT_TEST_TRUE(!record.write_err);
+    LT_TEST_TRUE(fwrite(&out, sizeof(out), 1, out_file) == 1);
+
+    return true;
+}
+#else
+static bool lt_test_pt_run(FILE *trace, FILE *out_file)
+{
+    static lt_dev_trace_replay_t replay;
+    lt_test_pt_out_t out_rec;
+
+    LT_TEST_TRUE(fread(&out_rec, sizeof(out_rec), 1, out_file) == 1);
+    replay.file = trace;
+    h.l2.device = &replay;
+
+    printf("Replaying the workload\n");
+    LT_TEST_TRUE(lt_test_pt_workload(false));
+    LT_TEST_TRUE(!replay.mismatch);
+    LT_TEST_TRUE(fgetc(trace) == EOF);
+    LT_TEST_TRUE(memcmp(&out, &out_rec, sizeof(out)) == 0);
+    LT_TEST_TRUE(replay.delay_ms == h.l2.clock.elapsed_ms);
+    printf("  %u records, %llu us recorded, %llu ms of delays\n", (unsigned)replay.records,
+           (unsigned long long)replay.trace_us, (unsigned long long)replay.delay_ms);
+
+    printf("Replaying the workload with a different ping message\n");
+    rewind(trace);
+    memset(&replay, 0, sizeof(replay));
+    replay.file = trace;
+    LT_TEST_TRUE(!lt_test_pt_workload(true));
+    LT_TEST_TRUE(replay.mismatch);
+
+    return true;
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    // Disable buffering on stdout and stderr (problem in GitHub CI)
+    setvbuf(stdout, NULL, _IONBF, 0);
+    setvbuf(stderr, NULL, _IONBF, 0);
+
+    if (argc != 2) {
+        printf("Usage: %s TRACE_FILE\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+#if LT_SEPARATE_L3_BUFF
+    static uint8_t l3_buffer[LT_SIZE_OF_L3_BUFF] __attribute__((aligned(16)));
+    h.l3.buff = l3_buffer;
+    h.l3.buff_len = sizeof(l3_buffer);
+#endif
+
+#ifdef LT_TEST_TRACE_RECORD
+    const char *mode = "wb";
+#else
+    const char *mode = "rb";
+#endif
+    char out_path[512];
+    snprintf(out_path, sizeof(out_path), "%s.out", argv[1]);
+    FILE *trace = fopen(argv[1], mode), *out_file = fopen(out_path, mode);
+    bool ok = trace && out_file && lt_test_pt_run(trace, out_file);
+    if (trace) {
+        fclose(trace);
+    }
+    if (out_file) {
+        fclose(out_file);
+    }
+
+    printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,252 @@
+/**
+ * @file lt_test_thread_safe.c
+ * @brief Stress test of LT_THREAD_SAFE: many threads call libtropic through one handle at once.
+ * @details Each thread mixes Ping, EdDSA signing, random numbers, monotonic counter reads and R memory reads of a
+ * shared slot with an atomic erase-write-read sequence of its own slot done under lt_handle_lock(). A single lost or
+ * corrupted frame breaks the Secure Session, so all threads checking their results also checks the locking. Two more
+ * threads meanwhile check the PIN of one MAC-and-Destroy record, a check getting between the steps of another one
+ * would destroy the slot the other one uses and fail it.
+ * @author Tropic Square s.r.o.
+ *
+ * @license For the license see file LICENSE.txt file in the root directory of this source tree.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "libtropic.h"
+#include "libtropic_common.h"
+#include "libtropic_functional_tests.h"
+#include "libtropic_macandd.h"
+#ifdef LT_EMULATOR
+#include "libtropic_port_emulator.h"
+
+extern const lt_emu_cfg_t lt_emu_model_cfg;
+#else
+#include "libtropic_port_unix_tcp.h"
+#endif
+
+#if !LT_THREAD_SAFE
+#error "lt_test_thread_safe requires libtropic built with LT_THREAD_SAFE"
+#endif
+
+/** @brief Number of threads sharing the handle. */
+#define LT_TEST_TS_THREAD_CNT 8
+/** @brief Number of rounds of operations done by each thread. */
+#define LT_TEST_TS_ROUNDS 16
+/** @brief R memory slot read by all threads. */
+#define LT_TEST_TS_SHARED_SLOT 0
+/** @brief First R memory slot owned by a thread, thread `i` uses slot `LT_TEST_TS_OWN_SLOT + i`. */
+#define LT_TEST_TS_OWN_SLOT 1
+/** @brief Monotonic counter read by all threads. */
+#define LT_TEST_TS_MCOUNTER TR01_MCOUNTER_INDEX_0
+/** @brief Value of the monotonic counter. */
+#define LT_TEST_TS_MCOUNTER_VALUE 1000
+/** @brief R memory slot with the MAC-and-Destroy record, after the slots owned by threads. */
+#define LT_TEST_TS_MACANDD_R_MEM_SLOT (LT_TEST_TS_OWN_SLOT + LT_TEST_TS_THREAD_CNT)
+/** @brief First MAC-and-Destroy slot used by the record. */
+#define LT_TEST_TS_MACANDD_FIRST_SLOT TR01_MAC_AND_DESTROY_SLOT_0
+/** @brief Number of PIN entry attempts. */
+#define LT_TEST_TS_MACANDD_ROUNDS 3
+/** @brief Number of threads checking the PIN, they have ids from LT_TEST_TS_THREAD_CNT on. */
+#define LT_TEST_TS_MACANDD_THREAD_CNT 2
+
+static lt_handle_t h;
+#ifdef LT_EMULATOR
+static lt_dev_emulator_t device;
+#else
+static lt_dev_unix_tcp_t device;
+#endif
+static uint8_t ed25519_pub[TR01_CURVE_ED25519_PUBKEY_LEN];
+static uint8_t shared_data[TR01_R_MEM_DATA_SIZE_MAX];
+static const uint8_t macandd_pin[] = {1, 2, 3, 4};
+static uint8_t macandd_key[LT_MACANDD_KEY_SIZE];
+/** @brief Serializes signature verification, trezor_crypto uses static buffers. */
+static pthread_mutex_t verify_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** @brief Provisions the key, counter and shared slot the threads use. */
+static bool lt_test_ts_provision(void)
+{
+    lt_ecc_curve_type_t curve;
+    lt_ecc_key_origin_t origin;
+
+    printf("Provisioning\n");
+    for (uint16_t i = 0; i < sizeof(shared_data); i++) {
+        shared_data[i] = (uint8_t)(i * 7);
+    }
+    lt_ecc_key_erase(&h, TR01_ECC_SLOT_0);
+    LT_TEST_TRUE(lt_ecc_key_generate(&h, TR01_ECC_SLOT_0, TR01_CURVE_ED25519) == LT_OK);
+    LT_TEST_TRUE(lt_ecc_key_read(&h, TR01_ECC_SLOT_0, ed25519_pub, sizeof(ed25519_pub), &curve, &origin) == LT_OK);
+    LT_TEST_TRUE(lt_mcounter_init(&h, LT_TEST_TS_MCOUNTER, LT_TEST_TS_MCOUNTER_VALUE) == LT_OK);
+    lt_r_mem_data_erase(&h, LT_TEST_TS_SHARED_SLOT);
+    LT_TEST_TRUE(lt_r_mem_data_write(&h, LT_TEST_TS_SHARED_SLOT, shared_data, sizeof(shared_data)) == LT_OK);
+
+    uint8_t master_secret[LT_MACANDD_SECRET_SIZE];
+    memset(master_secret, 0x5a, sizeof(master_secret));
+    LT_TEST_TRUE(lt_macandd_setup(&h, LT_TEST_TS_MACANDD_R_MEM_SLOT, LT_TEST_TS_MACANDD_FIRST_SLOT,
+                                  LT_TEST_TS_MACANDD_ROUNDS, master_secret, macandd_pin, sizeof(macandd_pin), NULL, 0,
+                                  macandd_key)
+                 == LT_OK);
+
+    return true;
+}
+
+/** @brief Erases, writes and reads back the thread's own slot without other threads' commands in between. */
+static bool lt_test_ts_own_slot(const unsigned id, const uint16_t round)
+{
+    uint8_t data[32], read[sizeof(data)];
+    uint16_t read_size;
+    const uint16_t slot = (uint16_t)(LT_TEST_TS_OWN_SLOT + id);
+
+    memset(data, (int)(id * LT_TEST_TS_ROUNDS + round), sizeof(data));
+    LT_TEST_TRUE(lt_handle_lock(&h) == LT_OK);
+    lt_ret_t ret = lt_r_mem_data_erase(&h, slot);
+    if (ret == LT_OK) {
+        ret = lt_r_mem_data_write(&h, slot, data, sizeof(data));
+    }
+    if (ret == LT_OK) {
+        ret = lt_r_mem_data_read(&h, slot, read, sizeof(read), &read_size);
+    }
+    LT_TEST_TRUE(lt_handle_unlock(&h) == LT_OK);
+    LT_TEST_TRUE(ret == LT_OK);
+    LT_TEST_TRUE(read_size == sizeof(data) && memcmp(read, data, sizeof(data)) == 0);
+
+    return true;
+}
+
+static bool lt_test_ts_round(const unsigned id, const uint16_t round)
+{
+    uint8_t msg[64], msg_in[sizeof(msg)], rs[TR01_ECDSA_EDDSA_SIGNATURE_LENGTH], rnd[TR01_RANDOM_VALUE_GET_LEN_MAX];
+    uint8_t data[TR01_R_MEM_DATA_SIZE_MAX];
+    uint16_t data_size;
+    uint32_t mcounter;
+
+    for (uint16_t i = 0; i < sizeof(msg); i++) {
+        msg[i] = (uint8_t)(id * 31 + round + i);
+    }
+    LT_TEST_TRUE(lt_ping(&h, msg, msg_in, sizeof(msg)) == LT_OK);
+    LT_TEST_TRUE(memcmp(msg, msg_in, sizeof(msg)) == 0);
+
+    LT_TEST_TRUE(lt_ecc_eddsa_sign(&h, TR01_ECC_SLOT_0, msg, sizeof(msg), rs) == LT_OK);
+    pthread_mutex_lock(&verify_lock);
+    lt_ret_t ret = lt_ecc_eddsa_sig_verify(msg, sizeof(msg), ed25519_pub, rs);
+    pthread_mutex_unlock(&verify_lock);
+    LT_TEST_TRUE(ret == LT_OK);
+
+    LT_TEST_TRUE(lt_random_value_get(&h, rnd, (uint16_t)(1 + (id * 17 + round) % sizeof(rnd))) == LT_OK);
+    LT_TEST_TRUE(lt_mcounter_get(&h, LT_TEST_TS_MCOUNTER, &mcounter) == LT_OK);
+    LT_TEST_TRUE(mcounter == LT_TEST_TS_MCOUNTER_VALUE);
+
+    LT_TEST_TRUE(lt_r_mem_data_read(&h, LT_TEST_TS_SHARED_SLOT, data, sizeof(data), &data_size) == LT_OK);
+    LT_TEST_TRUE(data_size == sizeof(shared_data) && memcmp(data, shared_data, sizeof(data)) == 0);
+
+    return lt_test_ts_own_slot(id, round);
+}
+
+/** @brief Checks the PIN, the released key and that no attempt was lost. */
+static bool lt_test_ts_macandd(void)
+{
+    uint8_t key[LT_MACANDD_KEY_SIZE], attempts;
+
+    LT_TEST_TRUE(
+        lt_macandd_check(&h, LT_TEST_TS_MACANDD_R_MEM_SLOT, macandd_pin, sizeof(macandd_pin), NULL, 0, key) == LT_OK);
+    LT_TEST_TRUE(memcmp(key, macandd_key, sizeof(key)) == 0);
+    LT_TEST_TRUE(lt_macandd_attempts_get(&h, LT_TEST_TS_MACANDD_R_MEM_SLOT, &attempts, NULL) == LT_OK);
+    LT_TEST_TRUE(attempts == LT_TEST_TS_MACANDD_ROUNDS);
+
+    return true;
+}
+
+static void *lt_test_ts_thread(void *arg)
+{
+    const unsigned id = (unsigned)(uintptr_t)arg;
+    bool ok = true;
+
+    for (uint16_t round = 0; ok && round < LT_TEST_TS_ROUNDS; round++) {
+        ok = (id >= LT_TEST_TS_THREAD_CNT) ? lt_test_ts_macandd() : lt_test_ts_round(id, round);
+        if (!ok) {
+            printf("FAIL thread %u in round %u\n", id, round);
+        }
+    }
+
+    return (void *)(uintptr_t)ok;
+}
+
+static bool lt_test_ts_run(void)
+{
+    pthread_t threads[LT_TEST_TS_THREAD_CNT + LT_TEST_TS_MACANDD_THREAD_CNT];
+    struct timespec start, end;
+    bool ok = true;
+
+    printf("%d threads and %d MAC-and-Destroy threads sharing one handle, %d rounds each\n", LT_TEST_TS_THREAD_CNT,
+           LT_TEST_TS_MACANDD_THREAD_CNT, LT_TEST_TS_ROUNDS);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    unsigned started = 0;
+    for (; started < LT_TEST_TS_THREAD_CNT + LT_TEST_TS_MACANDD_THREAD_CNT; started++) {
+        if (pthread_create(&threads[started], NULL, lt_test_ts_thread, (void *)(uintptr_t)started) != 0) {
+            ok = false;
+            break;
+        }
+    }
+    for (unsigned i = 0; i < started; i++) {
+        void *res;
+        pthread_join(threads[i], &res);
+        ok = ok && (bool)(uintptr_t)res;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    LT_TEST_TRUE(ok);
+
+    // Every round of the other threads sends 8 L3 commands
+    double secs = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%.0f L3 commands/s\n", LT_TEST_TS_THREAD_CNT * LT_TEST_TS_ROUNDS * 8 / secs);
+
+    // The session survived, a desynchronized one would fail here
+    uint8_t ping[4] = {1, 2, 3, 4}, pong[sizeof(ping)];
+    LT_TEST_TRUE(lt_ping(&h, ping, pong, sizeof(ping)) == LT_OK && memcmp(ping, pong, sizeof(ping)) == 0);
+
+    return true;
+}
+
+int main(void)
+{
+#if LT_SEPARATE_L3_BUFF
+    static uint8_t l3_buffer[LT_SIZE_OF_L3_BUFF] __attribute__((aligned(16)));
+    h.l3.buff = l3_buffer;
+    h.l3.buff_len = sizeof(l3_buffer);
+#endif
+#ifdef LT_EMULATOR
+    device.cfg = &lt_emu_model_cfg;
+#else
+    if (lt_unix_tcp_target_from_env(&device) != LT_OK) {
+        return EXIT_FAILURE;
+    }
+#endif
+    device.rng_seed = (unsigned int)time(NULL);
+    h.l2.device = &device;
+#ifdef LT_VIRTUAL_TIME
+    h.l2.clock.is_virtual = true;
+#endif
+
+    if (lt_init(&h) != LT_OK) {
+        printf("FAILED\n");
+        return EXIT_FAILURE;
+    }
+    bool ok = lt_verify_chip_and_start_secure_session(&h, sh0priv, sh0pub, TR01_PAIRING_KEY_SLOT_INDEX_0) == LT_OK;
+    ok = ok && lt_test_ts_provision() && lt_test_ts_run();
+
+    for (unsigned i = 0; ok && i < LT_TEST_TS_THREAD_CNT; i++) {
+        lt_r_mem_data_erase(&h, (uint16_t)(LT_TEST_TS_OWN_SLOT + i));
+    }
+    lt_r_mem_data_erase(&h, LT_TEST_TS_SHARED_SLOT);
+    lt_r_mem_data_erase(&h, LT_TEST_TS_MACANDD_R_MEM_SLOT);
+    lt_session_abort(&h);
+    lt_deinit(&h);
+
+    printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}